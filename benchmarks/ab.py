@@ -0,0 +1,188 @@
+#!/usr/bin/env python
+"""Side-by-side A/B comparison of two collector configurations.
+
+Usage: ab.py [--julia-a PATH] [--julia-b PATH]
+             [--env-a "VAR=VAL ..."] [--env-b "VAR=VAL ..."]
+             [--seconds N] [--json FILE]
+
+Runs the benchmark suite - benchmarks/driver.jl (throughput, pause
+percentiles, peak RSS per workload), tests/gc_bench/GCBench.jl (wall
+time), tests/gc_bench/RemsetBench.jl (barrier cost), and the in-runtime
+microbenchmarks (benchmarks/microbench.jl, benchmarks/ffibench.jl) -
+under configuration A and configuration B and prints one report with
+both columns and the delta.
+
+A configuration is a julia binary plus extra environment (NEPTUNE_*
+knobs). This tree carries no build switch back to the stock collector -
+gc.c was converted to the Neptune shims in place - so comparing against
+stock Julia means pointing --julia-b at an upstream binary built
+elsewhere; comparing Neptune tuning decisions only needs --env-b.
+
+Typically run through `make benchmark-ab` (see the top-level Makefile).
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def parse_env(spec):
+    env = {}
+    for item in spec.split():
+        if "=" not in item:
+            sys.exit("ab.py: malformed env entry %r (want VAR=VAL)" % item)
+        k, v = item.split("=", 1)
+        env[k] = v
+    return env
+
+
+def run(julia, extra_env, args, cwd=ROOT):
+    env = dict(os.environ)
+    env.update(extra_env)
+    cmd = [julia] + args
+    try:
+        out = subprocess.check_output(cmd, env=env, cwd=cwd,
+                                      stderr=subprocess.STDOUT)
+    except subprocess.CalledProcessError as e:
+        print("ab.py: %s failed:\n%s" % (" ".join(cmd), e.output.decode()),
+              file=sys.stderr)
+        return None
+    return out.decode()
+
+
+def run_config(julia, extra_env, seconds):
+    """Run the whole suite under one configuration."""
+    cfg = {"julia": julia, "env": extra_env, "driver": {},
+           "gcbench_s": None, "remset": {}, "microbench": {}}
+
+    out = run(julia, extra_env, ["benchmarks/driver.jl", str(seconds)])
+    if out is not None:
+        # the driver prints a single JSON object as its last line
+        for line in out.splitlines():
+            line = line.strip()
+            if line.startswith("{"):
+                for b in json.loads(line)["benchmarks"]:
+                    cfg["driver"][b["name"]] = b
+
+    t0 = time.time()
+    if run(julia, extra_env, ["tests/gc_bench/GCBench.jl"]) is not None:
+        cfg["gcbench_s"] = time.time() - t0
+
+    out = run(julia, extra_env, ["tests/gc_bench/RemsetBench.jl"])
+    if out is not None:
+        for line in out.splitlines():
+            m = re.match(r"(store into old|store into young|barrier cost)"
+                         r"\s*:\s*([0-9.]+) ns/store", line)
+            if m:
+                cfg["remset"][m.group(1)] = float(m.group(2))
+
+    # per-op lines from the in-runtime microbenchmarks; ffibench prints
+    # a warmed-up second pass, so later lines overwrite the cold ones
+    for script in ("benchmarks/microbench.jl", "benchmarks/ffibench.jl"):
+        out = run(julia, extra_env, [script])
+        if out is None:
+            continue
+        for line in out.splitlines():
+            m = re.match(r"(?:Neptune microbench|FFI bench):\s+(.*?)\s+"
+                         r"([0-9.]+) (ns/op|cycles/call)", line)
+            if m:
+                cfg["microbench"]["%s (%s)" % (m.group(1), m.group(3))] = \
+                    float(m.group(2))
+    return cfg
+
+
+def fmt(v, unit=""):
+    if v is None:
+        return "-"
+    if isinstance(v, float):
+        return "%.1f%s" % (v, unit)
+    return "%d%s" % (v, unit)
+
+
+def delta(a, b, lower_is_better=False):
+    if not a or b is None:
+        return "-"
+    d = (b - a) / float(a) * 100.0
+    mark = ""
+    if abs(d) >= 2.0:
+        better = (d < 0) == lower_is_better
+        mark = " +" if better else " -"
+    return "%+.1f%%%s" % (d, mark)
+
+
+def row(name, a, b, unit="", lower_is_better=False):
+    print("  %-32s %14s %14s %10s" %
+          (name, fmt(a, unit), fmt(b, unit), delta(a, b, lower_is_better)))
+
+
+def report(a, b):
+    print("A: %s %s" % (a["julia"],
+                        " ".join("%s=%s" % kv for kv in sorted(a["env"].items()))))
+    print("B: %s %s" % (b["julia"],
+                        " ".join("%s=%s" % kv for kv in sorted(b["env"].items()))))
+    print("(deltas are B vs A; +/- flags mark changes past 2%)")
+
+    for name in sorted(set(a["driver"]) | set(b["driver"])):
+        ra, rb = a["driver"].get(name, {}), b["driver"].get(name, {})
+        print("\nworkload %s:" % name)
+        row("ops/s", ra.get("ops_per_sec"), rb.get("ops_per_sec"))
+        row("alloc MB/s", scale(ra.get("alloc_bytes_per_sec"), 1e-6),
+            scale(rb.get("alloc_bytes_per_sec"), 1e-6))
+        row("pause p50 (us)", scale(ra.get("pause_p50_ns"), 1e-3),
+            scale(rb.get("pause_p50_ns"), 1e-3), lower_is_better=True)
+        row("pause p99 (us)", scale(ra.get("pause_p99_ns"), 1e-3),
+            scale(rb.get("pause_p99_ns"), 1e-3), lower_is_better=True)
+        row("pause max (us)", scale(ra.get("pause_max_ns"), 1e-3),
+            scale(rb.get("pause_max_ns"), 1e-3), lower_is_better=True)
+        row("peak RSS (MB)", scale(ra.get("peak_rss_bytes"), 1e-6),
+            scale(rb.get("peak_rss_bytes"), 1e-6), lower_is_better=True)
+
+    print("\nGCBench wall time:")
+    row("seconds", a["gcbench_s"], b["gcbench_s"], lower_is_better=True)
+
+    if a["remset"] or b["remset"]:
+        print("\nwrite barrier (RemsetBench):")
+        for name in sorted(set(a["remset"]) | set(b["remset"])):
+            row(name, a["remset"].get(name), b["remset"].get(name),
+                lower_is_better=True)
+
+    if a["microbench"] or b["microbench"]:
+        print("\nmicrobenchmarks:")
+        for name in sorted(set(a["microbench"]) | set(b["microbench"])):
+            row(name, a["microbench"].get(name), b["microbench"].get(name),
+                lower_is_better=True)
+
+
+def scale(v, k):
+    return None if v is None else v * k
+
+
+def main():
+    p = argparse.ArgumentParser()
+    p.add_argument("--julia-a", default=os.path.join(ROOT, "bin", "julia"))
+    p.add_argument("--julia-b", default=os.path.join(ROOT, "bin", "julia"))
+    p.add_argument("--env-a", default="")
+    p.add_argument("--env-b", default="")
+    p.add_argument("--seconds", type=float, default=10.0)
+    p.add_argument("--json", help="also dump both raw result sets here")
+    args = p.parse_args()
+
+    a = run_config(args.julia_a, parse_env(args.env_a), args.seconds)
+    b = run_config(args.julia_b, parse_env(args.env_b), args.seconds)
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"a": a, "b": b}, f, indent=2)
+    report(a, b)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,170 @@
+# GC benchmark driver with machine-readable output.
+#
+# Runs a suite of GC-bound workloads, each in a fresh julia process so
+# the pause statistics and RSS of one workload cannot leak into the
+# next, and prints a single JSON object on stdout for before/after
+# comparisons:
+#
+#   julia benchmarks/driver.jl [seconds-per-workload]   (default 10)
+#
+# Each workload runs for the given wall time after a short warmup.
+# Per workload the JSON carries operation throughput, allocation rate
+# (from Base.gc_num()), GC time, pause count, pause p50/p99 (the
+# percentile estimates the collector keeps in gc_num) and the maximum
+# pause (neptune_pause_max_ns), plus peak RSS from /proc.
+#
+# `driver.jl --worker <name> <seconds>` is the internal per-process
+# entry point; it prints one "RESULT: {...}" line the driver collects.
+
+type Box
+    val
+end
+
+# rapid churn of small boxed objects; the generational case
+function churn_shortlived(deadline)
+    ops = 0
+    box = Box(0)
+    while time_ns() < deadline
+        for i = 1:1000
+            box = Box(i)
+        end
+        ops += 1000
+    end
+    ops + box.val
+end
+
+# large arrays cycling through a live window; exercises big_alloc and
+# malloc'd array tracking
+function churn_largearray(deadline)
+    ops = 0
+    window = Vector{Vector{Float64}}(8)
+    while time_ns() < deadline
+        window[ops % 8 + 1] = rand(Float64, 100_000)
+        ops += 1
+    end
+    ops
+end
+
+function make_tree(depth)
+    depth == 0 ? Box(0) : Box((make_tree(depth - 1), make_tree(depth - 1)))
+end
+
+# deep pointer graphs built and dropped whole; stresses the mark stack
+function churn_deepgraph(deadline)
+    ops = 0
+    tree = Box(0)
+    while time_ns() < deadline
+        tree = make_tree(14)
+        ops += 1
+    end
+    ops + (tree === tree ? 0 : 1)
+end
+
+# every object carries a finalizer; stresses the finalizer tables and
+# the post-mark finalizer scan
+function churn_finalizers(deadline)
+    ops = 0
+    while time_ns() < deadline
+        for i = 1:1000
+            x = Box(i)
+            finalizer(x, identity)
+        end
+        ops += 1000
+    end
+    ops
+end
+
+# the short-lived churn on every thread at once; run with
+# JULIA_NUM_THREADS > 1 (the driver sets 4 unless overridden)
+function churn_multithread(deadline)
+    nt = Threads.nthreads()
+    counts = zeros(Int, nt)
+    Threads.@threads for t = 1:nt
+        box = Box(0)
+        while time_ns() < deadline
+            for i = 1:1000
+                box = Box(i)
+            end
+            counts[Threads.threadid()] += 1000
+        end
+    end
+    sum(counts)
+end
+
+const WORKLOADS = [
+    "shortlived"  => churn_shortlived,
+    "largearray"  => churn_largearray,
+    "deepgraph"   => churn_deepgraph,
+    "finalizers"  => churn_finalizers,
+    "multithread" => churn_multithread,
+]
+
+function peak_rss()
+    if is_linux()
+        for line in eachline("/proc/self/status")
+            if startswith(line, "VmHWM:")
+                return parse(Int, split(line)[2]) * 1024
+            end
+        end
+    end
+    0
+end
+
+jsonnum(x) = isa(x, AbstractFloat) ? string(round(x, 3)) : string(x)
+
+function run_worker(name, secs)
+    f = Dict(WORKLOADS)[name]
+    # warmup: compile the workload and let the heap reach steady state
+    f(time_ns() + UInt64(500_000_000))
+    gc()
+    n0 = Base.gc_num()
+    t0 = time_ns()
+    ops = f(t0 + UInt64(round(secs * 1e9)))
+    dt = (time_ns() - t0) / 1e9
+    n1 = Base.gc_num()
+    allocd = Base.gc_total_bytes(n1) - Base.gc_total_bytes(n0)
+    fields = String[
+        "\"name\": \"$name\"",
+        "\"seconds\": $(jsonnum(dt))",
+        "\"ops\": $ops",
+        "\"ops_per_sec\": $(jsonnum(ops / dt))",
+        "\"alloc_bytes\": $allocd",
+        "\"alloc_bytes_per_sec\": $(jsonnum(allocd / dt))",
+        "\"gc_time_ns\": $(n1.total_time - n0.total_time)",
+        "\"pauses\": $(n1.pause - n0.pause)",
+        "\"pause_p50_ns\": $(n1.pause_p50)",
+        "\"pause_p99_ns\": $(n1.pause_p99)",
+        "\"pause_max_ns\": $(ccall(:neptune_pause_max_ns, UInt64, ()))",
+        "\"peak_rss_bytes\": $(peak_rss())",
+    ]
+    println("RESULT: {", join(fields, ", "), "}")
+end
+
+function main()
+    if length(ARGS) >= 3 && ARGS[1] == "--worker"
+        run_worker(ARGS[2], parse(Float64, ARGS[3]))
+        return
+    end
+    secs = isempty(ARGS) ? 10.0 : parse(Float64, ARGS[1])
+    results = String[]
+    for (name, _) in WORKLOADS
+        cmd = `$(Base.julia_cmd()) $(@__FILE__) --worker $name $secs`
+        if name == "multithread"
+            env = copy(ENV)
+            env["JULIA_NUM_THREADS"] = get(ENV, "JULIA_NUM_THREADS", "4")
+            cmd = setenv(cmd, env)
+        end
+        out = readstring(cmd)
+        found = false
+        for line in split(out, '\n')
+            if startswith(line, "RESULT: ")
+                push!(results, String(line[9:end]))
+                found = true
+            end
+        end
+        found || warn("workload $name produced no result")
+    end
+    println("{\"benchmarks\": [", join(results, ", "), "]}")
+end
+
+main()
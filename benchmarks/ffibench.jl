@@ -0,0 +1,129 @@
+# Cycle-level microbenchmarks of FFI round-trip cost: plain ccall,
+# ccall whose arguments force a GC frame, runtime-resolved ccall (the
+# jl_load_and_lookup path codegen takes when the library is not a
+# compile-time constant), cfunction callbacks, and the Neptune GC
+# entry points the runtime crosses hottest (see the ffi_* counters in
+# neptune_tl_stats_t). Results print as cycles/call lines on stdout so
+# FFI-related optimizations can demonstrate their effect.
+#
+#   julia benchmarks/ffibench.jl
+
+const ITERS = 1_000_000
+
+# raw TSC; on every x86_64 we run on readcyclecounter lowers to rdtsc
+rdtsc() = Base.llvmcall(
+    ("declare i64 @llvm.readcyclecounter()",
+     """
+     %c = call i64 @llvm.readcyclecounter()
+     ret i64 %c
+     """), UInt64, Tuple{})
+
+function report(name, cycles, iters)
+    @printf("FFI bench: %-28s %8.1f cycles/call (%d calls)\n",
+            name, cycles / iters, iters)
+end
+
+# Each benchmark is @noinline and loops inside one function so the
+# call under test is the loop body; accumulating into `acc` keeps LLVM
+# from hoisting or discarding it.
+
+@noinline function bench_plain()
+    acc = Cint(0)
+    t0 = rdtsc()
+    for i = 1:ITERS
+        acc += ccall(:jl_ver_major, Cint, ())
+    end
+    report("plain ccall", rdtsc() - t0, ITERS)
+    acc
+end
+
+@noinline function bench_gcframe(x)
+    acc = UInt(0)
+    t0 = rdtsc()
+    for i = 1:ITERS
+        # the Any argument is rooted across the call, so codegen
+        # builds and pushes a GC frame around this ccall
+        acc += reinterpret(UInt, ccall(:jl_typeof, Ptr{Void}, (Any,), x))
+    end
+    report("ccall with GC frame", rdtsc() - t0, ITERS)
+    acc
+end
+
+# non-const global, so ccall cannot burn the pointer into the code and
+# resolves through jl_load_and_lookup instead
+libm_name = "libm"
+
+@noinline function bench_runtime_resolved()
+    acc = 0.0
+    t0 = rdtsc()
+    for i = 1:ITERS
+        acc += ccall((:cos, libm_name), Float64, (Float64,), 0.5)
+    end
+    report("runtime-resolved ccall", rdtsc() - t0, ITERS)
+    acc
+end
+
+callback(x::Cint) = x + Cint(1)
+
+@noinline function bench_cfunction(fptr)
+    acc = Cint(0)
+    t0 = rdtsc()
+    for i = 1:ITERS
+        acc += ccall(fptr, Cint, (Cint,), Cint(i % 1000))
+    end
+    report("cfunction callback", rdtsc() - t0, ITERS)
+    acc
+end
+
+@noinline function bench_gc_entry()
+    # the cheapest C-side GC entry point: reads a few counters
+    acc = Int64(0)
+    t0 = rdtsc()
+    for i = 1:ITERS
+        acc += ccall(:jl_gc_total_bytes, Int64, ())
+    end
+    report("GC entry (jl_gc_total_bytes)", rdtsc() - t0, ITERS)
+
+    # straight through the C shim into Rust
+    acc2 = UInt(0)
+    t0 = rdtsc()
+    for i = 1:ITERS
+        acc2 += ccall(:neptune_current_pg_count, Csize_t, ())
+    end
+    report("GC entry (C -> Rust)", rdtsc() - t0, ITERS)
+    acc + acc2
+end
+
+@noinline function bench_write_barrier(old)
+    # stores into an old container cross neptune_queue_root; this
+    # measures store + barrier, the form the crossing takes in real
+    # code
+    t0 = rdtsc()
+    for i = 1:ITERS
+        old[1] = (i, i)
+    end
+    report("write barrier store", rdtsc() - t0, ITERS)
+    old[1]
+end
+
+function main()
+    # warm up codegen and the runtime-resolution cache miss
+    x = Any[1]
+    fptr = cfunction(callback, Cint, (Cint,))
+    bench_plain(); bench_gcframe(x); bench_runtime_resolved()
+    bench_cfunction(fptr); bench_gc_entry()
+
+    println("--- warmed up ---")
+    bench_plain()
+    bench_gcframe(x)
+    bench_runtime_resolved()
+    bench_cfunction(fptr)
+    bench_gc_entry()
+
+    # promote the container so the barrier actually fires
+    old = Vector{Any}(1); old[1] = 0
+    gc(); gc()
+    bench_write_barrier(old)
+end
+
+main()
@@ -0,0 +1,10 @@
+# Cycle-level microbenchmarks of the allocator hot paths: pool and
+# big allocation, page alloc/free, the write barrier slow path, and
+# the concurrent stack (single-threaded and contended). They run
+# inside this live runtime via neptune_microbench so freelists, page
+# metadata and remsets are in their steady-state shape; results print
+# as ns/op lines on stdout.
+#
+#   julia benchmarks/microbench.jl
+
+ccall(:neptune_microbench, Void, ())
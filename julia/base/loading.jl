@@ -148,6 +148,16 @@ function find_all_in_cache_path(mod::Symbol)
     return paths
 end
 
+# advisory read-ahead for the cache files of a module `require` is about
+# to load, so their disk I/O overlaps the deserialization of whatever
+# loads first; called from read_verify_mod_list in dump.c
+function _prefetch_from_cache_path(mod::Symbol)
+    for path in find_all_in_cache_path(mod)
+        ccall(:jl_prefetch_file, Void, (Cstring,), path)
+    end
+    nothing
+end
+
 # these return either the array of modules loaded from the path / content given
 # or an Exception that describes why it couldn't be loaded
 function _include_from_serialized(content::Vector{UInt8})
@@ -49,8 +49,9 @@ simd_outer_range(r) = 0:0
 # Construct user-level element from original range, outer loop index j, and inner loop index i.
 @inline simd_index(r,j::Int,i) = (@inbounds ret = r[i+1]; ret)
 
-# Compile Expr x in context of @simd.
-function compile(x)
+# Compile Expr x in context of @simd. ivdep asserts that no memory
+# reference in the loop body overlaps with any other.
+function compile(x, ivdep::Bool)
     (isa(x, Expr) && x.head == :for) || throw(SimdError("for loop expected"))
     length(x.args) == 2 || throw(SimdError("1D for loop expected"))
     check_body!(x)
@@ -72,7 +73,7 @@ function compile(x)
                                 local $var = Base.simd_index($r,$j,$i)
                                 $(x.args[2])        # Body of loop
                                 $i += 1
-                                $(Expr(:simdloop))  # Mark loop as SIMD loop
+                                $(Expr(:simdloop, ivdep))  # Mark loop as SIMD loop
                             end
                         end
                         # Set index to last value just like a regular for loop would
@@ -86,7 +87,17 @@ function compile(x)
 end
 
 macro simd(forloop)
-    esc(compile(forloop))
+    esc(compile(forloop, false))
+end
+
+# `@simd ivdep for ...` additionally promises that no iteration reads or
+# writes a memory location written by another iteration, and that no two
+# memory references in the body overlap. This is a strong assertion; use
+# it only on kernels (e.g. gather/scatter stencils) where the automatic
+# dependence checks defeat vectorization.
+macro simd(ivdep::Symbol, forloop)
+    ivdep === :ivdep || throw(SimdError("expected ivdep as the first argument to @simd"))
+    esc(compile(forloop, true))
 end
 
 end # module SimdLoop
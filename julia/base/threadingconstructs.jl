@@ -26,6 +26,20 @@ function _threadsfor(iter,lbody)
         function $fun()
             tid = threadid()
             r = $(esc(range))
+            if ccall(:jl_threading_dynamic, Cint, ()) != 0
+                # work-stealing schedule (JULIA_THREADS_DYNAMIC): claim
+                # chunks of the iteration space until it is drained
+                lo = Ref{Int64}(0)
+                hi = Ref{Int64}(0)
+                while ccall(:jl_threading_next_chunk, Cint,
+                            (Int16, Ref{Int64}, Ref{Int64}), tid-1, lo, hi) != 0
+                    for i = (Int(lo[])+1):Int(hi[])
+                        local $(esc(lidx)) = Base.unsafe_getindex(r,i)
+                        $(esc(lbody))
+                    end
+                end
+                return
+            end
             # divide loop iterations among threads
             len, rem = divrem(length(r), nthreads())
             # not enough iterations for all the threads?
@@ -54,6 +68,11 @@ function _threadsfor(iter,lbody)
                 $(esc(lbody))
             end
         end
+        if ccall(:jl_threading_dynamic, Cint, ()) != 0
+            # the master carves up the iteration space before forking
+            ccall(:jl_threading_start_ranges, Void, (Int64,),
+                  length($(esc(range))))
+        end
         ccall(:jl_threading_run, Ref{Void}, (Any,), $fun)
     end
 end
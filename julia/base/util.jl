@@ -29,6 +29,16 @@ struct GC_Num
     collect     ::Csize_t # GC internal
     pause       ::Cint
     full_sweep  ::Cint
+    mark_rate   ::UInt64 # bytes marked per second, last cycle
+    pages_swept ::UInt64 # pool pages visited by the sweep
+    promoted    ::UInt64 # bytes promoted to the old generation
+    barriers    ::UInt64 # write barrier activations
+    pause_p50   ::UInt64 # pause-time percentile estimates, ns
+    pause_p90   ::UInt64
+    pause_p99   ::UInt64
+    arr_grows   ::UInt64 # array buffer enlargements
+    arr_copied  ::UInt64 # bytes moved servicing those enlargements
+    big_hugepage_bytes::UInt64 # big-object bytes on hugepage-advised chunks
 end
 
 gc_num() = ccall(:jl_gc_num, GC_Num, ())
@@ -0,0 +1,145 @@
+# This file is a part of Julia. License is MIT: http://julialang.org/license
+
+# Annotate JIT-compiled code with perf cycle samples.
+#
+# The jitdump written by the runtime (JULIA_PERF_JITDUMP=1, see
+# src/debuginfo.cpp) records the name, load address and machine code of
+# every emitted function, so samples can be mapped back to individual
+# instructions offline. Typical use:
+#
+#   JULIA_PERF_JITDUMP=1 perf record -k mono -o perf.data ./julia script.jl
+#   perf script -i perf.data -F ip > samples.txt
+#   ./julia contrib/perf_annotate.jl /tmp/jit-<pid>.dump samples.txt
+#
+# Output is one block per sampled function, hottest first, with the
+# disassembly of each instruction prefixed by its sample count and the
+# share of all JIT samples it accounts for.
+
+const JITDUMP_MAGIC = 0x4A695444 % UInt32  # "JiTD"
+const JITDUMP_CODE_LOAD = UInt32(0)
+
+struct CodeLoad
+    name::String
+    addr::UInt64
+    code::Vector{UInt8}
+end
+
+function read_jitdump(fname)
+    funcs = CodeLoad[]
+    open(fname) do f
+        magic = read(f, UInt32)
+        magic == JITDUMP_MAGIC || error("$fname is not a perf jitdump file")
+        read(f, UInt32)  # version
+        total_size = read(f, UInt32)
+        seek(f, total_size)
+        while !eof(f)
+            id = read(f, UInt32)
+            total_size = read(f, UInt32)
+            read(f, UInt64)  # timestamp
+            payload = Int(total_size) - 16
+            if id == JITDUMP_CODE_LOAD
+                read(f, UInt32)  # pid
+                read(f, UInt32)  # tid
+                read(f, UInt64)  # vma
+                code_addr = read(f, UInt64)
+                code_size = read(f, UInt64)
+                read(f, UInt64)  # code_index
+                namelen = payload - 40 - Int(code_size)
+                name = String(read(f, UInt8, namelen)[1:end-1])
+                push!(funcs, CodeLoad(name, code_addr, read(f, UInt8, code_size)))
+            else
+                skip(f, payload)
+            end
+        end
+    end
+    return funcs
+end
+
+function read_samples(fname)
+    counts = Dict{UInt64,Int}()
+    for line in eachline(fname)
+        m = match(r"([0-9a-fA-F]+)\s*$", line)
+        m === nothing && continue
+        ip = parse(UInt64, m.captures[1], 16)
+        counts[ip] = get(counts, ip, 0) + 1
+    end
+    return counts
+end
+
+# attribute each sampled ip to the function containing it; a later
+# code_load at the same address supersedes an earlier one, matching how
+# perf resolves reused JIT memory
+function aggregate(funcs, samples)
+    by_addr = Dict{UInt64,Int}()
+    for (i, f) in enumerate(funcs)
+        by_addr[f.addr] = i
+    end
+    addrs = sort!(collect(keys(by_addr)))
+    func_counts = zeros(Int, length(funcs))
+    for (ip, n) in samples
+        j = searchsortedlast(addrs, ip)
+        j == 0 && continue
+        i = by_addr[addrs[j]]
+        if ip < funcs[i].addr + length(funcs[i].code)
+            func_counts[i] += n
+        end
+    end
+    return func_counts
+end
+
+function annotate(f::CodeLoad, samples, fcount, total, dc)
+    @printf("\n%8d %5.1f%%  %s\n", fcount, 100 * fcount / total, f.name)
+    outbuf = Vector{UInt8}(256)
+    pos = 1
+    while pos <= length(f.code)
+        ip = f.addr + pos - 1
+        n = ccall(:jl_LLVMDisasmInstruction, Csize_t,
+                  (Ptr{Void}, Ptr{UInt8}, UInt64, UInt64, Ptr{UInt8}, Csize_t),
+                  dc, pointer(f.code, pos), length(f.code) - pos + 1,
+                  ip, outbuf, length(outbuf))
+        if n == 0
+            text = @sprintf("\t.byte 0x%02x", f.code[pos])
+            n = 1
+        else
+            text = unsafe_string(pointer(outbuf))
+        end
+        count = 0
+        for k = 0:Int(n)-1
+            count += get(samples, ip + k, 0)
+        end
+        if count > 0
+            @printf("%8d %5.1f%%  %#x:%s\n", count, 100 * count / total, ip, text)
+        else
+            @printf("%15s  %#x:%s\n", "", ip, text)
+        end
+        pos += Int(n)
+    end
+end
+
+function main()
+    if length(ARGS) != 2
+        println(STDERR, "usage: julia perf_annotate.jl <jitdump> <samples>")
+        println(STDERR, "  <samples> is the output of `perf script -F ip`")
+        exit(1)
+    end
+    funcs = read_jitdump(ARGS[1])
+    samples = read_samples(ARGS[2])
+    func_counts = aggregate(funcs, samples)
+    total = sum(values(samples))
+    total == 0 && error("no samples in $(ARGS[2])")
+    # the disassembler lives in the runtime, which has already
+    # initialized the native target for us
+    dc = ccall(:jl_LLVMCreateDisasm, Ptr{Void},
+               (Cstring, Ptr{Void}, Cint, Ptr{Void}, Ptr{Void}),
+               Sys.MACHINE, C_NULL, 0, C_NULL, C_NULL)
+    dc == C_NULL && error("could not create a disassembler for $(Sys.MACHINE)")
+    jit_total = sum(func_counts)
+    @printf("%d samples, %d (%.1f%%) in JIT code\n",
+            total, jit_total, 100 * jit_total / total)
+    for i in sortperm(func_counts, rev=true)
+        func_counts[i] == 0 && break
+        annotate(funcs[i], samples, func_counts[i], total, dc)
+    end
+end
+
+main()
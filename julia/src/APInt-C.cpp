@@ -48,6 +48,48 @@ inline uint64_t RoundUpToAlignment(uint64_t Value, uint64_t Align, uint64_t Skew
     else \
         memcpy(p##r, a.getRawData(), RoundUpToAlignment(numbits, host_char_bit) / host_char_bit); \
 
+/* Native fast paths for the common case of at most 128 bits.
+ *
+ * Every runtime integer intrinsic funnels through APInt, which heap-walks a
+ * part array even for Int128/UInt128 -- by far the dominant widths that ever
+ * reach these entry points, since codegen handles <= 64 bits inline. When the
+ * compiler provides __int128, load the operands into native registers
+ * instead and fall back to APInt only above 128 bits. Like CREATE/ASSIGN,
+ * the raw memory accesses assume little-endian. */
+#ifdef __SIZEOF_INT128__
+#define LLVM_NATIVE_INT128 1
+
+static inline unsigned __int128 mask128(unsigned numbits)
+{
+    return ~(unsigned __int128)0 >> (128 - numbits);
+}
+
+/* zero-extend `numbits` (<= 128) of little-endian data at `p` */
+static inline unsigned __int128 load_u128(unsigned numbits, const integerPart *p)
+{
+    unsigned __int128 v = 0;
+    memcpy(&v, p, RoundUpToAlignment(numbits, host_char_bit) / host_char_bit);
+    return v & mask128(numbits);
+}
+
+/* sign-extend `numbits` (<= 128) of little-endian data at `p` */
+static inline __int128 load_s128(unsigned numbits, const integerPart *p)
+{
+    unsigned __int128 v = load_u128(numbits, p);
+    if (numbits < 128 && (v >> (numbits - 1)) != 0)
+        v |= ~mask128(numbits);
+    return (__int128)v;
+}
+
+/* store the low `numbits` of `v`, zeroing the excess bits of a partial
+ * byte the same way ASSIGN does for the APInt path */
+static inline void store_128(unsigned numbits, integerPart *pr, unsigned __int128 v)
+{
+    v &= mask128(numbits);
+    memcpy(pr, &v, RoundUpToAlignment(numbits, host_char_bit) / host_char_bit);
+}
+#endif
+
 extern "C" JL_DLLEXPORT
 void LLVMNeg(unsigned numbits, integerPart *pa, integerPart *pr) {
     APInt z(numbits, 0);
@@ -58,6 +100,12 @@ void LLVMNeg(unsigned numbits, integerPart *pa, integerPart *pr) {
 
 extern "C" JL_DLLEXPORT
 void LLVMAdd(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr) {
+#ifdef LLVM_NATIVE_INT128
+    if (numbits <= 128) {
+        store_128(numbits, pr, load_u128(numbits, pa) + load_u128(numbits, pb));
+        return;
+    }
+#endif
     CREATE(a)
     CREATE(b)
     a += b;
@@ -66,6 +114,12 @@ void LLVMAdd(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr
 
 extern "C" JL_DLLEXPORT
 void LLVMSub(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr) {
+#ifdef LLVM_NATIVE_INT128
+    if (numbits <= 128) {
+        store_128(numbits, pr, load_u128(numbits, pa) - load_u128(numbits, pb));
+        return;
+    }
+#endif
     CREATE(a)
     CREATE(b)
     a -= b;
@@ -74,6 +128,12 @@ void LLVMSub(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr
 
 extern "C" JL_DLLEXPORT
 void LLVMMul(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr) {
+#ifdef LLVM_NATIVE_INT128
+    if (numbits <= 128) {
+        store_128(numbits, pr, load_u128(numbits, pa) * load_u128(numbits, pb));
+        return;
+    }
+#endif
     CREATE(a)
     CREATE(b)
     a *= b;
@@ -82,6 +142,18 @@ void LLVMMul(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr
 
 extern "C" JL_DLLEXPORT
 void LLVMSDiv(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr) {
+#ifdef LLVM_NATIVE_INT128
+    if (numbits <= 128) {
+        __int128 a128 = load_s128(numbits, pa);
+        __int128 b128 = load_s128(numbits, pb);
+        // native division of INT_MIN by -1 traps and division by zero is
+        // undefined, so leave those two cases to the APInt path below
+        if (b128 != 0 && !(b128 == -1 && (unsigned __int128)a128 == (unsigned __int128)1 << (numbits - 1))) {
+            store_128(numbits, pr, (unsigned __int128)(a128 / b128));
+            return;
+        }
+    }
+#endif
     CREATE(a)
     CREATE(b)
     a = a.sdiv(b);
@@ -90,6 +162,15 @@ void LLVMSDiv(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *p
 
 extern "C" JL_DLLEXPORT
 void LLVMUDiv(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr) {
+#ifdef LLVM_NATIVE_INT128
+    if (numbits <= 128) {
+        unsigned __int128 b128 = load_u128(numbits, pb);
+        if (b128 != 0) { // leave division by zero to the APInt path below
+            store_128(numbits, pr, load_u128(numbits, pa) / b128);
+            return;
+        }
+    }
+#endif
     CREATE(a)
     CREATE(b)
     a = a.udiv(b);
@@ -180,6 +261,17 @@ void LLVMXor(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr
 
 extern "C" JL_DLLEXPORT
 void LLVMShl(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr) {
+#ifdef LLVM_NATIVE_INT128
+    if (numbits <= 128) {
+        unsigned __int128 amt = load_u128(numbits, pb);
+        // match APInt: shifting by the full width or more gives zero
+        if (amt >= numbits)
+            store_128(numbits, pr, 0);
+        else
+            store_128(numbits, pr, load_u128(numbits, pa) << (unsigned)amt);
+        return;
+    }
+#endif
     CREATE(a)
     CREATE(b)
     a = a.shl(b);
@@ -188,6 +280,17 @@ void LLVMShl(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr
 
 extern "C" JL_DLLEXPORT
 void LLVMLShr(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr) {
+#ifdef LLVM_NATIVE_INT128
+    if (numbits <= 128) {
+        unsigned __int128 amt = load_u128(numbits, pb);
+        // match APInt: shifting by the full width or more gives zero
+        if (amt >= numbits)
+            store_128(numbits, pr, 0);
+        else
+            store_128(numbits, pr, load_u128(numbits, pa) >> (unsigned)amt);
+        return;
+    }
+#endif
     CREATE(a)
     CREATE(b)
     a = a.lshr(b);
@@ -195,6 +298,18 @@ void LLVMLShr(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *p
 }
 extern "C" JL_DLLEXPORT
 void LLVMAShr(unsigned numbits, integerPart *pa, integerPart *pb, integerPart *pr) {
+#ifdef LLVM_NATIVE_INT128
+    if (numbits <= 128) {
+        unsigned __int128 amt = load_u128(numbits, pb);
+        __int128 a128 = load_s128(numbits, pa);
+        // match APInt: shifting by the full width or more fills with the sign
+        if (amt >= numbits)
+            store_128(numbits, pr, a128 < 0 ? ~(unsigned __int128)0 : 0);
+        else
+            store_128(numbits, pr, (unsigned __int128)(a128 >> (unsigned)amt));
+        return;
+    }
+#endif
     CREATE(a)
     CREATE(b)
     a = a.ashr(b);
@@ -181,11 +181,31 @@ Type *isHFAorHVA(jl_datatype_t *dt, size_t &nele) const
     size_t dsz = jl_datatype_size(dt);
     if (dsz > 64 || !dt->layout || dt->layout->npointers || dt->layout->haspadding)
         return NULL;
+    // Memoized per datatype, like the x86-64 classification: the answer
+    // depends only on the immutable layout and this runs for every
+    // argument of every emitted ccall/cfunction. Lookups are lock-free;
+    // insertions are serialized by the codegen lock.
+    struct HFAEntry {
+        Type *type;
+        size_t nele;
+    };
+    static cptrhash_t hfa_cache;
+    if (hfa_cache.table == NULL)
+        cptrhash_new(&hfa_cache, 512);
+    void *cached = cptrhash_get(&hfa_cache, dt);
+    if (cached != HT_NOTFOUND) {
+        HFAEntry *ent = (HFAEntry*)cached;
+        nele = ent->nele;
+        return ent->type;
+    }
     nele = 0;
     ElementType eltype;
-    if (isHFAorHVA(dt, dsz, nele, eltype))
-        return eltype.type;
-    return NULL;
+    Type *ret = isHFAorHVA(dt, dsz, nele, eltype) ? eltype.type : NULL;
+    HFAEntry *ent = (HFAEntry*)malloc(sizeof(HFAEntry));
+    ent->type = ret;
+    ent->nele = nele;
+    cptrhash_put(&hfa_cache, dt, ent);
+    return ret;
 }
 
 bool needPassByRef(jl_datatype_t *dt, AttrBuilder &ab) override
@@ -163,8 +163,23 @@ void classifyType(Classification& accum, jl_datatype_t *dt, uint64_t offset) con
 
 Classification classify(jl_datatype_t *dt) const
 {
+    // The classification depends only on the datatype layout, which is
+    // immutable once computed, so memoize it: every ccall/cfunction
+    // emission classifies each argument up to three times (sret check,
+    // register assignment, type rewrite), re-walking the same handful
+    // of struct types over and over in FFI-dense modules. Lookups are
+    // lock-free; insertions are serialized by the codegen lock.
+    static cptrhash_t classify_cache;
+    if (classify_cache.table == NULL)
+        cptrhash_new(&classify_cache, 512);
+    void *cached = cptrhash_get(&classify_cache, dt);
+    if (cached != HT_NOTFOUND)
+        return *(Classification*)cached;
     Classification cl;
     classifyType(cl, dt, 0);
+    Classification *entry = (Classification*)malloc(sizeof(Classification));
+    *entry = cl;
+    cptrhash_put(&classify_cache, dt, entry);
     return cl;
 }
 
@@ -20,6 +20,79 @@ extern "C" {
 
 #define JL_ARRAY_ALIGN(jl_value, nbytes) LLT_ALIGN(jl_value, nbytes)
 
+// bulk copy/fill kernels ------------------------------------------------------
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Copies clearly past the last-level cache gain nothing from landing in
+// it: regular stores evict useful lines and pay a read-for-ownership on
+// every one. Above this (conservative LLC-sized) threshold we switch to
+// non-temporal stores when both sides are 16-byte aligned, which
+// fresh array buffers always are.
+#define JL_ARRAY_NT_THRESHOLD (4 * 1024 * 1024)
+
+static void jl_array_memcpy(void *dst, const void *src, size_t nb)
+{
+#if defined(__SSE2__)
+    if (nb >= JL_ARRAY_NT_THRESHOLD &&
+        (((uintptr_t)dst | (uintptr_t)src) & 15) == 0) {
+        char *d = (char*)dst;
+        const char *s = (const char*)src;
+        size_t i, nvec = nb & ~(size_t)63;
+        for (i = 0; i < nvec; i += 64) {
+            __m128i x0 = _mm_load_si128((const __m128i*)(s + i));
+            __m128i x1 = _mm_load_si128((const __m128i*)(s + i + 16));
+            __m128i x2 = _mm_load_si128((const __m128i*)(s + i + 32));
+            __m128i x3 = _mm_load_si128((const __m128i*)(s + i + 48));
+            _mm_stream_si128((__m128i*)(d + i), x0);
+            _mm_stream_si128((__m128i*)(d + i + 16), x1);
+            _mm_stream_si128((__m128i*)(d + i + 32), x2);
+            _mm_stream_si128((__m128i*)(d + i + 48), x3);
+        }
+        _mm_sfence();
+        if (nb > nvec)
+            memcpy(d + nvec, s + nvec, nb - nvec);
+        return;
+    }
+#endif
+    memcpy(dst, src, nb);
+}
+
+// memmove that streams when the spans turn out not to overlap, which is
+// the common case for the grow/del shifts (fresh buffer, or shifting
+// by more than the moved span)
+static void jl_array_memmove(void *dst, const void *src, size_t nb)
+{
+    if ((char*)dst + nb <= (const char*)src ||
+        (const char*)src + nb <= (char*)dst)
+        jl_array_memcpy(dst, src, nb);
+    else
+        memmove(dst, src, nb);
+}
+
+// Fill `n` elements of `elsz` bytes at `dst` with the pattern at
+// `elt`. The obvious loop degenerates to byte stores for odd element
+// sizes; laying the pattern down once and doubling it with bulk copies
+// runs every element size at copy speed, including the streaming path
+// for fills past the LLC. Exported for use from Base via ccall.
+JL_DLLEXPORT void jl_array_fill_pattern(void *dst, const void *elt,
+                                        size_t elsz, size_t n)
+{
+    char *d = (char*)dst;
+    size_t nb = n * elsz;
+    size_t done = elsz;
+    if (n == 0 || elsz == 0)
+        return;
+    memcpy(d, elt, elsz);
+    while (done < nb - done) {
+        jl_array_memcpy(d + done, d, done);
+        done *= 2;
+    }
+    jl_array_memcpy(d + done, d, nb - done);
+}
+
 // array constructors ---------------------------------------------------------
 
 static inline int store_unboxed(jl_value_t *el_type) // jl_isbits
@@ -155,6 +228,46 @@ jl_array_t *jl_new_array_for_deserialization(jl_value_t *atype, uint32_t ndims,
     return _new_array_(atype, ndims, dims, isunboxed, elsz);
 }
 
+// build an array header over element data that lives in a permanently
+// mapped copy-on-write buffer (the system-image deserializer). The data
+// is neither owned nor freed by the GC (how == 0) and might not be
+// aligned to the element size. The type is NULL; the caller sets it once
+// it has been deserialized, like jl_new_array_for_deserialization.
+jl_array_t *jl_map_array_for_deserialization(uint32_t ndims, size_t *dims,
+                                             int elsz, void *data)
+{
+    jl_ptls_t ptls = jl_get_ptls_states();
+    size_t i, nel = 1;
+    for (i = 0; i < ndims; i++)
+        nel *= dims[i];
+    int ndimwords = jl_array_ndimwords(ndims);
+    int tsz = JL_ARRAY_ALIGN(sizeof(jl_array_t) + ndimwords*sizeof(size_t), JL_CACHE_BYTE_ALIGNMENT);
+    jl_array_t *a = (jl_array_t*)jl_gc_alloc(ptls, tsz, NULL);
+    // No allocation or safepoint allowed after this
+    a->flags.pooled = tsz <= GC_MAX_SZCLASS;
+    a->flags.how = 0;
+    a->data = data;
+#ifdef STORE_ARRAY_LEN
+    a->length = nel;
+#endif
+    a->flags.ndims = ndims;
+    a->flags.ptrarray = 0;
+    a->elsize = elsz;
+    a->flags.isshared = 1;
+    a->flags.isaligned = 0;
+    a->offset = 0;
+    if (ndims == 1) {
+        a->nrows = nel;
+        a->maxsize = nel;
+    }
+    else {
+        size_t *adims = &a->nrows;
+        for (i = 0; i < ndims; i++)
+            adims[i] = dims[i];
+    }
+    return a;
+}
+
 #ifndef NDEBUG
 static inline int is_ntuple_long(jl_value_t *v)
 {
@@ -410,7 +523,12 @@ JL_DLLEXPORT jl_value_t *jl_array_to_string(jl_array_t *a)
 
 JL_DLLEXPORT jl_value_t *jl_pchar_to_string(const char *str, size_t len)
 {
-    jl_value_t *s = jl_gc_alloc(jl_get_ptls_states(), sizeof(size_t)+len+1, jl_string_type);
+    // hot in parsers: short strings come out of the thread's bump span
+    // without a runtime call (jl_gc_alloc_inline), and the copy is left
+    // to memcpy, which the compiler already lowers to vector moves for
+    // the small fixed-size cases that matter here
+    jl_value_t *s = jl_gc_alloc_inline(jl_get_ptls_states(),
+                                       sizeof(size_t) + len + 1, jl_string_type);
     *(size_t*)s = len;
     memcpy((char*)s + sizeof(size_t), str, len);
     ((char*)s + sizeof(size_t))[len] = 0;
@@ -419,7 +537,8 @@ JL_DLLEXPORT jl_value_t *jl_pchar_to_string(const char *str, size_t len)
 
 JL_DLLEXPORT jl_value_t *jl_alloc_string(size_t len)
 {
-    jl_value_t *s = jl_gc_alloc(jl_get_ptls_states(), sizeof(size_t)+len+1, jl_string_type);
+    jl_value_t *s = jl_gc_alloc_inline(jl_get_ptls_states(),
+                                       sizeof(size_t) + len + 1, jl_string_type);
     *(size_t*)s = len;
     ((char*)s + sizeof(size_t))[len] = 0;
     return s;
@@ -610,6 +729,9 @@ static int NOINLINE array_resize_buffer(jl_array_t *a, size_t newlen)
            "Race condition detected: recursive resizing on the same array.");
     a->flags.isshared = 0;
     a->maxsize = newlen;
+    // the live data either moves to the new buffer or is shuffled by
+    // realloc; either way it is (at most) oldlen elements of traffic
+    jl_gc_count_array_grow(oldlen * elsz);
     return newbuf;
 }
 
@@ -645,6 +767,65 @@ static size_t limit_overallocation(jl_array_t *a, size_t alen, size_t newlen, si
     return newlen;
 }
 
+// Growth schedule for the resize paths below.  The classic schedule
+// doubles the capacity on every enlargement; JULIA_ARRAY_GROWTH selects
+// a different amortization constant (the percentage of the current
+// capacity added per enlargement), trading peak memory against
+// realloc/copy frequency.
+static int jl_array_growth_pct = 0; // 0 until first use
+
+static void NOINLINE jl_array_growth_init(void)
+{
+    int pct = DEFAULT_ARRAY_GROWTH;
+    char *cp = getenv(ARRAY_GROWTH_NAME);
+    if (cp) {
+        char *endp;
+        long v = strtol(cp, &endp, 10);
+        if (endp != cp && *endp == '\0' && v >= 10 && v <= 400)
+            pct = (int)v;
+        else
+            jl_printf(JL_STDERR,
+                      "WARNING: ignoring %s=%s (expected a percentage in 10..400)\n",
+                      ARRAY_GROWTH_NAME, cp);
+    }
+    jl_array_growth_pct = pct;
+}
+
+// next capacity (in elements) after `len` under the configured schedule
+STATIC_INLINE size_t jl_array_next_len(size_t len)
+{
+    size_t inc;
+    if (__unlikely(jl_array_growth_pct == 0))
+        jl_array_growth_init();
+    inc = len * jl_array_growth_pct / 100;
+    return len + (inc < 4 ? 4 : inc);
+}
+
+// The pooled buffer allocator hands back a full size class regardless of
+// the request, so round the capacity up until the class is full: the
+// slack becomes usable elements instead of internal fragmentation.  This
+// runs after limit_overallocation and can exceed the cap by at most the
+// tail of one size class, which the pool would have consumed anyway.
+STATIC_INLINE size_t jl_array_round_szclass(jl_array_t *a, size_t newlen)
+{
+    size_t es = a->elsize;
+    size_t nul = (es == 1 ? 1 : 0); // terminating NUL, see array_resize_buffer
+    if (es == 0 || a->flags.how == 2 || a->flags.how == 3)
+        return newlen;
+    size_t nbytes = newlen * es + nul;
+    size_t allocsz = nbytes + sizeof(jl_taggedvalue_t);
+    if (allocsz > GC_MAX_SZCLASS ||
+#ifdef _P64
+        nbytes >= MALLOC_THRESH
+#else
+        es > 4
+#endif
+        )
+        return newlen;
+    size_t classb = jl_gc_sizeclasses[jl_gc_szclass(allocsz)];
+    return (classb - sizeof(jl_taggedvalue_t) - nul) / es;
+}
+
 STATIC_INLINE void jl_array_grow_at_beg(jl_array_t *a, size_t idx, size_t inc,
                                         size_t n)
 {
@@ -668,17 +849,18 @@ STATIC_INLINE void jl_array_grow_at_beg(jl_array_t *a, size_t idx, size_t inc,
         newdata = data - nbinc;
         a->offset -= inc;
         if (idx > 0) {
-            memmove(newdata, data, idx * elsz);
+            jl_array_memmove(newdata, data, idx * elsz);
         }
     }
     else {
         size_t oldoffsnb = a->offset * elsz;
         size_t nb1 = idx * elsz;
         if (inc > (a->maxsize - n) / 2 - (a->maxsize - n) / 20) {
-            size_t newlen = a->maxsize == 0 ? inc * 2 : a->maxsize * 2;
+            size_t newlen = a->maxsize == 0 ? inc * 2 : jl_array_next_len(a->maxsize);
             while (n + 2 * inc > newlen - a->offset)
-                newlen *= 2;
+                newlen = jl_array_next_len(newlen);
             newlen = limit_overallocation(a, n, newlen, 2 * inc);
+            newlen = jl_array_round_szclass(a, newlen);
             size_t newoffset = (newlen - newnrows) / 2;
             if (!array_resize_buffer(a, newlen))
                 data = (char*)a->data + oldoffsnb;
@@ -686,10 +868,10 @@ STATIC_INLINE void jl_array_grow_at_beg(jl_array_t *a, size_t idx, size_t inc,
             // We could use memcpy if resizing allocates a new buffer,
             // hopefully it's not a particularly important optimization.
             if (idx > 0 && newdata < data)
-                memmove(newdata, data, nb1);
-            memmove(newdata + nbinc + nb1, data + nb1, n * elsz - nb1);
+                jl_array_memmove(newdata, data, nb1);
+            jl_array_memmove(newdata + nbinc + nb1, data + nb1, n * elsz - nb1);
             if (idx > 0 && newdata > data)
-                memmove(newdata, data, nb1);
+                jl_array_memmove(newdata, data, nb1);
             a->offset = newoffset;
         }
         else {
@@ -698,10 +880,10 @@ STATIC_INLINE void jl_array_grow_at_beg(jl_array_t *a, size_t idx, size_t inc,
             // We could use memcpy if resizing allocates a new buffer,
             // hopefully it's not a particularly important optimization.
             if (idx > 0 && newdata < data)
-                memmove(newdata, data, nb1);
-            memmove(newdata + nbinc + nb1, data + nb1, n * elsz - nb1);
+                jl_array_memmove(newdata, data, nb1);
+            jl_array_memmove(newdata + nbinc + nb1, data + nb1, n * elsz - nb1);
             if (idx > 0 && newdata > data)
-                memmove(newdata, data, nb1);
+                jl_array_memmove(newdata, data, nb1);
         }
     }
 #ifdef STORE_ARRAY_LEN
@@ -734,26 +916,27 @@ STATIC_INLINE void jl_array_grow_at_end(jl_array_t *a, size_t idx,
     if (__unlikely((n + inc) > a->maxsize - a->offset)) {
         size_t nb1 = idx * elsz;
         size_t nbinc = inc * elsz;
-        size_t newlen = a->maxsize == 0 ? (inc < 4 ? 4 : inc) : a->maxsize * 2;
+        size_t newlen = a->maxsize == 0 ? (inc < 4 ? 4 : inc) : jl_array_next_len(a->maxsize);
         while ((n + inc) > newlen - a->offset)
-            newlen *= 2;
+            newlen = jl_array_next_len(newlen);
         newlen = limit_overallocation(a, n, newlen, inc);
+        newlen = jl_array_round_szclass(a, newlen);
         int newbuf = array_resize_buffer(a, newlen);
         char *newdata = (char*)a->data + a->offset * elsz;
         if (newbuf) {
-            memcpy(newdata, data, nb1);
+            jl_array_memcpy(newdata, data, nb1);
             if (has_gap) {
-                memcpy(newdata + nb1 + nbinc, data + nb1, n * elsz - nb1);
+                jl_array_memcpy(newdata + nb1 + nbinc, data + nb1, n * elsz - nb1);
             }
         }
         else if (has_gap) {
-            memmove(newdata + nb1 + nbinc, newdata + nb1, n * elsz - nb1);
+            jl_array_memmove(newdata + nb1 + nbinc, newdata + nb1, n * elsz - nb1);
         }
         a->data = data = newdata;
     }
     else if (has_gap) {
         size_t nb1 = idx * elsz;
-        memmove(data + nb1 + inc * elsz, data + nb1, n * elsz - nb1);
+        jl_array_memmove(data + nb1 + inc * elsz, data + nb1, n * elsz - nb1);
     }
     size_t newnrows = n + inc;
 #ifdef STORE_ARRAY_LEN
@@ -916,7 +1099,7 @@ JL_DLLEXPORT jl_array_t *jl_array_copy(jl_array_t *ary)
     size_t elsz = ary->elsize;
     jl_array_t *new_ary = _new_array_(jl_typeof(ary), jl_array_ndims(ary),
                                       &ary->nrows, !ary->flags.ptrarray, elsz);
-    memcpy(new_ary->data, ary->data, jl_array_len(ary) * elsz);
+    jl_array_memcpy(new_ary->data, ary->data, jl_array_len(ary) * elsz);
     return new_ary;
 }
 
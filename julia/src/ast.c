@@ -61,6 +61,15 @@ static uint8_t flisp_system_image[] = {
 #include <julia_flisp.boot.inc>
 };
 
+// binary flisp image, compiled from flisp_system_image by the first
+// context to boot and reused by every later one (each concurrent parse
+// task boots its own context, so this pays off within a process too).
+// JULIA_FLISP_CACHE names a file to mmap it from across processes; a
+// missing, torn or stale cache is ignored and rewritten.
+static char *flisp_bin_image = NULL;
+static size_t flisp_bin_image_len = 0;
+static ios_t flisp_bin_image_map; // keeps a cache mapping alive
+
 typedef struct _jl_ast_context_list_t {
     struct _jl_ast_context_list_t *next;
     struct _jl_ast_context_list_t **prev;
@@ -150,8 +159,8 @@ value_t fl_defined_julia_global(fl_context_t *fl_ctx, value_t *args, uint32_t na
         type_error(fl_ctx, "defined-julia-global", "symbol", args[0]);
     if (!mod)
         return fl_ctx->F;
-    jl_binding_t *b = (jl_binding_t*)ptrhash_get(&mod->bindings, sym);
-    return (b != HT_NOTFOUND && b->owner == mod) ? fl_ctx->T : fl_ctx->F;
+    jl_binding_t *b = jl_get_module_binding(mod, sym);
+    return (b != NULL && b->owner == mod) ? fl_ctx->T : fl_ctx->F;
 }
 
 value_t fl_current_julia_module(fl_context_t *fl_ctx, value_t *args, uint32_t nargs)
@@ -256,14 +265,76 @@ static const builtinspec_t julia_flisp_ast_ext[] = {
 static int jl_parse_deperror(fl_context_t *fl_ctx, int err);
 static int jl_parse_depwarn_(fl_context_t *fl_ctx, int warn);
 
+// There should be no GC allocation while holding this lock
+static jl_mutex_t flisp_lock;
+
+// compile the textual system image into the binary boot format, or map
+// a previously compiled copy from the JULIA_FLISP_CACHE file. The cache
+// header ties the blob to the exact text image it was compiled from, so
+// a cache surviving a rebuild just falls back to recompiling; any blob
+// that fails to load makes the boot fall back to the text image.
+static void jl_build_flisp_bin_image(fl_context_t *fl_ctx)
+{
+    const char *cache = getenv("JULIA_FLISP_CACHE");
+    uint64_t hdr[2] = { memhash((char*)flisp_system_image,
+                                sizeof(flisp_system_image)),
+                        sizeof(flisp_system_image) };
+    if (cache != NULL) {
+        if (ios_file_mmap(&flisp_bin_image_map, cache) != NULL) {
+            if ((size_t)flisp_bin_image_map.size >= sizeof(hdr) &&
+                !memcmp(flisp_bin_image_map.buf, hdr, sizeof(hdr))) {
+                flisp_bin_image = flisp_bin_image_map.buf + sizeof(hdr);
+                flisp_bin_image_len = (size_t)flisp_bin_image_map.size - sizeof(hdr);
+                return;
+            }
+            ios_close(&flisp_bin_image_map); // stale cache
+        }
+    }
+    ios_t blob;
+    ios_mem(&blob, 1 << 20);
+    if (fl_dump_system_image_bin(fl_ctx, &blob, (char*)flisp_system_image,
+                                 sizeof(flisp_system_image))) {
+        ios_close(&blob);
+        return; // keep booting from the text image
+    }
+    size_t len;
+    char *buf = ios_take_buffer(&blob, &len);
+    if (buf == NULL)
+        return;
+    len--; // ios_take_buffer counts its terminating NUL
+    if (cache != NULL) {
+        // a concurrent writer can tear the file, but a torn cache fails
+        // the header check next time and is simply rewritten
+        ios_t cf;
+        if (ios_file(&cf, cache, 1, 1, 1, 1) != NULL) {
+            ios_write(&cf, (char*)hdr, sizeof(hdr));
+            ios_write(&cf, buf, len);
+            ios_close(&cf);
+        }
+    }
+    flisp_bin_image_len = len;
+    flisp_bin_image = buf; // process-lifetime, never freed
+}
+
 static void jl_init_ast_ctx(jl_ast_context_t *ast_ctx)
 {
     fl_context_t *fl_ctx = &ast_ctx->fl;
     fl_init(fl_ctx, 4*1024*1024);
 
-    if (fl_load_system_image_str(fl_ctx, (char*)flisp_system_image,
-                                 sizeof(flisp_system_image))) {
-        jl_error("fatal error loading system image");
+    if (flisp_bin_image == NULL) {
+        JL_LOCK_NOGC(&flisp_lock);
+        if (flisp_bin_image == NULL)
+            jl_build_flisp_bin_image(fl_ctx);
+        JL_UNLOCK_NOGC(&flisp_lock);
+    }
+    if (flisp_bin_image == NULL ||
+        fl_load_system_image_bin(fl_ctx, flisp_bin_image,
+                                 flisp_bin_image_len)) {
+        flisp_bin_image = NULL; // don't retry a bad blob
+        if (fl_load_system_image_str(fl_ctx, (char*)flisp_system_image,
+                                     sizeof(flisp_system_image))) {
+            jl_error("fatal error loading system image");
+        }
     }
 
     fl_applyn(fl_ctx, 0, symbol_value(symbol(fl_ctx, "__init_globals")));
@@ -284,8 +355,6 @@ static void jl_init_ast_ctx(jl_ast_context_t *ast_ctx)
         jl_parse_depwarn_(fl_ctx, (int)jl_options.depwarn);
 }
 
-// There should be no GC allocation while holding this lock
-static jl_mutex_t flisp_lock;
 static jl_ast_context_list_t *jl_ast_ctx_using = NULL;
 static jl_ast_context_list_t *jl_ast_ctx_freed = NULL;
 
@@ -803,6 +872,142 @@ JL_DLLEXPORT jl_value_t *jl_parse_string(const char *str, size_t len,
     return result;
 }
 
+// --- persisted parse cache ---------------------------------------------------
+// Parsing is a pure function of the file contents, so the surface AST can be
+// reused across processes: when JULIA_PARSE_CACHE is set, the parsed form of
+// an included file is persisted next to it as "<file>.jlast", printed readably
+// by flisp (the same mechanism that round-trips the frontend in flisp.boot)
+// and keyed on a hash of the contents mixed with the build id. Lowering is
+// deliberately NOT cached: jl-expand-to-thunk runs macro expansion, so the
+// lowered form depends on what has been evaluated, not just on the file text.
+// All cache reads and writes are best effort; the parser is always the
+// fallback and a stale or unwritable cache is silently ignored.
+
+static const char jl_parse_cache_magic[] = "jlast01\n";
+
+static int jl_parse_cache_enabled(void)
+{
+    static int enabled = -1;
+    if (enabled == -1) {
+        const char *env = getenv("JULIA_PARSE_CACHE");
+        enabled = (env && *env && strcmp(env, "0"));
+    }
+    return enabled;
+}
+
+static char *jl_parse_cache_name(const char *fname, size_t len)
+{
+    char *cname = (char*)malloc(len + sizeof(".jlast"));
+    if (cname != NULL) {
+        memcpy(cname, fname, len);
+        memcpy(cname + len, ".jlast", sizeof(".jlast"));
+    }
+    return cname;
+}
+
+static uint64_t jl_parse_cache_key(const char *content, size_t contentlen)
+{
+    const char *commit = jl_git_commit();
+    return memhash_seed(content, contentlen, memhash32(commit, strlen(commit)));
+}
+
+// return the cached surface AST for `content`, or F on any mismatch or error
+static value_t jl_parse_cache_load(fl_context_t *fl_ctx, const char *fname, size_t len,
+                                   const char *content, size_t contentlen)
+{
+    value_t ast = fl_ctx->F;
+    char *cname = jl_parse_cache_name(fname, len);
+    if (cname == NULL)
+        return ast;
+    ios_t f;
+    if (ios_file(&f, cname, 1, 0, 0, 0) == NULL) {
+        free(cname);
+        return ast;
+    }
+    free(cname);
+    char magic[sizeof(jl_parse_cache_magic)];
+    uint64_t key;
+    if (ios_read(&f, magic, sizeof(magic)) == sizeof(magic) &&
+        memcmp(magic, jl_parse_cache_magic, sizeof(magic)) == 0 &&
+        ios_read(&f, (char*)&key, sizeof(key)) == sizeof(key) &&
+        key == jl_parse_cache_key(content, contentlen)) {
+        int64_t pos = ios_pos(&f);
+        int64_t end = ios_seek_end(&f);
+        size_t n = (size_t)(end - pos);
+        char *text = (char*)malloc(n);
+        if (text != NULL) {
+            ios_seek(&f, pos);
+            if (ios_readall(&f, text, n) == n) {
+                // need try/catch to reset GC handle stack in case of error
+                FL_TRY_EXTERN(fl_ctx) {
+                    value_t port = fl_applyn(fl_ctx, 0, symbol_value(symbol(fl_ctx, "buffer")));
+                    fl_gc_handle(fl_ctx, &port);
+                    value_t str = cvalue_static_cstrn(fl_ctx, text, n);
+                    fl_applyn(fl_ctx, 2, symbol_value(symbol(fl_ctx, "io.write")), port, str);
+                    fl_applyn(fl_ctx, 2, symbol_value(symbol(fl_ctx, "io.seek")), port, fixnum(0));
+                    ast = fl_applyn(fl_ctx, 1, symbol_value(symbol(fl_ctx, "read")), port);
+                    fl_free_gc_handles(fl_ctx, 1);
+                    if (!iscons(ast) || car_(ast) != symbol(fl_ctx, "toplevel"))
+                        ast = fl_ctx->F; // truncated or foreign cache
+                }
+                FL_CATCH_EXTERN(fl_ctx) {
+                    ast = fl_ctx->F; // unreadable cache; fall back to the parser
+                }
+            }
+            free(text);
+        }
+    }
+    ios_close(&f);
+    return ast;
+}
+
+static void jl_parse_cache_store(fl_context_t *fl_ctx, const char *fname, size_t len,
+                                 const char *content, size_t contentlen, value_t ast)
+{
+    value_t printed = fl_ctx->F;
+    FL_TRY_EXTERN(fl_ctx) {
+        value_t port = fl_applyn(fl_ctx, 0, symbol_value(symbol(fl_ctx, "buffer")));
+        fl_gc_handle(fl_ctx, &port);
+        fl_applyn(fl_ctx, 2, symbol_value(symbol(fl_ctx, "write")), ast, port);
+        // only persist the printed form if it reads back identically
+        fl_applyn(fl_ctx, 2, symbol_value(symbol(fl_ctx, "io.seek")), port, fixnum(0));
+        value_t reread = fl_applyn(fl_ctx, 1, symbol_value(symbol(fl_ctx, "read")), port);
+        fl_gc_handle(fl_ctx, &reread);
+        if (fl_applyn(fl_ctx, 2, symbol_value(symbol(fl_ctx, "equal?")), ast, reread) != fl_ctx->F)
+            printed = fl_applyn(fl_ctx, 1, symbol_value(symbol(fl_ctx, "io.tostring!")), port);
+        fl_free_gc_handles(fl_ctx, 2);
+    }
+    FL_CATCH_EXTERN(fl_ctx) {
+        printed = fl_ctx->F;
+    }
+    if (printed == fl_ctx->F || !fl_isstring(fl_ctx, printed))
+        return;
+    char *cname = jl_parse_cache_name(fname, len);
+    if (cname == NULL)
+        return;
+    char *tmpname = (char*)malloc(len + sizeof(".jlast.XXXXXX"));
+    if (tmpname == NULL) {
+        free(cname);
+        return;
+    }
+    memcpy(tmpname, fname, len);
+    memcpy(tmpname + len, ".jlast.XXXXXX", sizeof(".jlast.XXXXXX"));
+    ios_t f;
+    if (ios_mkstemp(&f, tmpname) != NULL) {
+        uint64_t key = jl_parse_cache_key(content, contentlen);
+        ios_write(&f, jl_parse_cache_magic, sizeof(jl_parse_cache_magic));
+        ios_write(&f, (char*)&key, sizeof(key));
+        // no flisp allocation between here and the write: `printed` cannot move
+        ios_write(&f, (char*)cvalue_data(printed), cv_len((cvalue_t*)ptr(printed)));
+        int err = ios_flush(&f) != 0 || f.errcode;
+        ios_close(&f);
+        if (err || jl_fs_rename(tmpname, cname) < 0)
+            jl_fs_unlink(tmpname);
+    }
+    free(tmpname);
+    free(cname);
+}
+
 // parse and eval a whole file, possibly reading from a string (`content`)
 jl_value_t *jl_parse_eval_all(const char *fname,
                               const char *content, size_t contentlen)
@@ -826,7 +1031,29 @@ jl_value_t *jl_parse_eval_all(const char *fname,
     else {
         JL_TIMING(PARSING);
         assert(memchr(fname, 0, len) == NULL); // was checked already in jl_load
-        ast = fl_applyn(fl_ctx, 1, symbol_value(symbol(fl_ctx, "jl-parse-file")), f);
+        ast = fl_ctx->F;
+        ios_t srcf;
+        if (jl_parse_cache_enabled() && ios_file_mmap(&srcf, fname) != NULL) {
+            if (srcf.mmapped) {
+                const char *text = srcf.buf;
+                size_t textlen = (size_t)srcf.size;
+                ast = jl_parse_cache_load(fl_ctx, fname, len, text, textlen);
+                if (ast == fl_ctx->F) {
+                    value_t t = cvalue_static_cstrn(fl_ctx, text, textlen);
+                    fl_gc_handle(fl_ctx, &t);
+                    ast = fl_applyn(fl_ctx, 2, symbol_value(symbol(fl_ctx, "jl-parse-string-stream")), t, f);
+                    fl_free_gc_handles(fl_ctx, 1);
+                    if (ast != fl_ctx->F) {
+                        fl_gc_handle(fl_ctx, &ast);
+                        jl_parse_cache_store(fl_ctx, fname, len, text, textlen, ast);
+                        fl_free_gc_handles(fl_ctx, 1);
+                    }
+                }
+            }
+            ios_close(&srcf);
+        }
+        if (ast == fl_ctx->F)
+            ast = fl_applyn(fl_ctx, 1, symbol_value(symbol(fl_ctx, "jl-parse-file")), f);
     }
     fl_free_gc_handles(fl_ctx, 1);
     if (ast == fl_ctx->F) {
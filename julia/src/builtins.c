@@ -21,6 +21,9 @@
 #include <unistd.h>
 #endif
 #include <ctype.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "julia.h"
 #include "julia_internal.h"
 #include "builtin_proto.h"
@@ -32,6 +35,16 @@ extern "C" {
 
 // egal and object_id ---------------------------------------------------------
 
+#if defined(__SSE2__)
+static int bits_equal_16(const char *a, const char *b)
+{
+    // unaligned loads: a flat struct is only as aligned as its widest field
+    __m128i xa = _mm_loadu_si128((const __m128i*)a);
+    __m128i xb = _mm_loadu_si128((const __m128i*)b);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(xa, xb)) == 0xffff;
+}
+#endif
+
 static int bits_equal(void *a, void *b, int sz)
 {
     switch (sz) {
@@ -39,7 +52,32 @@ static int bits_equal(void *a, void *b, int sz)
     case 2:  return *(int16_t*)a == *(int16_t*)b;
     case 4:  return *(int32_t*)a == *(int32_t*)b;
     case 8:  return *(int64_t*)a == *(int64_t*)b;
-    default: return memcmp(a, b, sz)==0;
+#if defined(__SSE2__)
+    case 16: return bits_equal_16((char*)a, (char*)b);
+#endif
+    default:
+        if (sz > 8 && sz < 16) {
+            // two overlapping 8-byte compares cover sizes 9..15
+            uint64_t a0, a1, b0, b1;
+            memcpy(&a0, a, 8);
+            memcpy(&b0, b, 8);
+            memcpy(&a1, (char*)a + sz - 8, 8);
+            memcpy(&b1, (char*)b + sz - 8, 8);
+            return (a0 == b0) & (a1 == b1);
+        }
+#if defined(__SSE2__)
+        if (sz > 16) {
+            // 16 bytes at a time, with an overlapping load for the tail
+            const char *pa = (const char*)a, *pb = (const char*)b;
+            int i;
+            for (i = 0; i + 16 <= sz; i += 16) {
+                if (!bits_equal_16(pa + i, pb + i))
+                    return 0;
+            }
+            return i == sz || bits_equal_16(pa + sz - 16, pb + sz - 16);
+        }
+#endif
+        return memcmp(a, b, sz)==0;
     }
 }
 
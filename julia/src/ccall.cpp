@@ -200,6 +200,37 @@ static Value *runtime_sym_lookup(PointerType *funcptype, const char *f_lib,
                               runtime_lib);
 }
 
+// Cache of symbols resolved for JIT (non-imaging) emission. FFI-dense
+// modules emit thousands of ccall/cglobal sites naming the same handful
+// of symbols, and each emission otherwise pays the library-map lock plus
+// a dlsym walk. Codegen runs under the codegen lock, so a plain map
+// suffices. Failed lookups are not cached: the user may legitimately
+// dlopen the missing library and try again.
+static std::map<std::pair<std::string, std::string>, void*> resolved_sym_cache;
+
+static void *jl_dlsym_cached(const char *f_lib, const char *f_name)
+{
+    std::string libkey;
+#ifdef _OS_WINDOWS_
+    // the exe/dl handles are passed as tag values, not names
+    if ((intptr_t)f_lib == 1)
+        libkey = "@exe";
+    else if ((intptr_t)f_lib == 2)
+        libkey = "@dl";
+    else
+#endif
+    if (f_lib != NULL)
+        libkey = f_lib;
+    auto key = std::make_pair(libkey, std::string(f_name));
+    auto it = resolved_sym_cache.find(key);
+    if (it != resolved_sym_cache.end())
+        return it->second;
+    void *symaddr = jl_dlsym_e(jl_get_library(f_lib), f_name);
+    if (symaddr)
+        resolved_sym_cache[key] = symaddr;
+    return symaddr;
+}
+
 // Map from distinct callee's to its GOT entry.
 // In principle the attribute, function type and calling convention
 // don't need to be part of the key but it seems impossible to forward
@@ -808,7 +839,7 @@ static jl_cgval_t emit_cglobal(jl_value_t **args, size_t nargs, jl_codectx_t *ct
             res = runtime_sym_lookup((PointerType*)lrt, sym.f_lib, sym.f_name, ctx->f);
         }
         else {
-            void *symaddr = jl_dlsym_e(jl_get_library(sym.f_lib), sym.f_name);
+            void *symaddr = jl_dlsym_cached(sym.f_lib, sym.f_name);
             if (symaddr == NULL) {
                 std::stringstream msg;
                 msg << "cglobal: could not find symbol ";
@@ -1420,23 +1451,31 @@ std::string generate_func_sig()
 }
 };
 
-static std::pair<CallingConv::ID, bool> convert_cconv(jl_sym_t *lhd)
+// (calling convention, is llvmcall, is gc_safe)
+static std::tuple<CallingConv::ID, bool, bool> convert_cconv(jl_sym_t *lhd)
 {
     // check for calling convention specifier
     if (lhd == jl_symbol("stdcall")) {
-        return std::make_pair(CallingConv::X86_StdCall, false);
+        return std::make_tuple(CallingConv::X86_StdCall, false, false);
     }
     else if (lhd == jl_symbol("cdecl")) {
-        return std::make_pair(CallingConv::C, false);
+        return std::make_tuple(CallingConv::C, false, false);
     }
     else if (lhd == jl_symbol("fastcall")) {
-        return std::make_pair(CallingConv::X86_FastCall, false);
+        return std::make_tuple(CallingConv::X86_FastCall, false, false);
     }
     else if (lhd == jl_symbol("thiscall")) {
-        return std::make_pair(CallingConv::X86_ThisCall, false);
+        return std::make_tuple(CallingConv::X86_ThisCall, false, false);
     }
     else if (lhd == jl_symbol("llvmcall")) {
-        return std::make_pair(CallingConv::C, true);
+        return std::make_tuple(CallingConv::C, true, false);
+    }
+    else if (lhd == jl_symbol("gc_safe")) {
+        // not a calling convention: the callee may block (I/O, locks,
+        // long computations that never touch the julia heap), so run it
+        // in the GC-safe state where a collection proceeds without
+        // waiting for this thread
+        return std::make_tuple(CallingConv::C, false, true);
     }
     jl_errorf("ccall: invalid calling convention %s", jl_symbol_name(lhd));
 }
@@ -1501,10 +1540,11 @@ static jl_cgval_t emit_ccall(jl_value_t **args, size_t nargs, jl_codectx_t *ctx)
 
     CallingConv::ID cc = CallingConv::C;
     bool llvmcall = false;
+    bool gc_safe = false;
     if (nargs % 2 == 0) {
         jl_value_t *last = args[nargs];
         JL_TYPECHK(ccall, expr, last);
-        std::tie(cc, llvmcall) = convert_cconv(((jl_expr_t*)last)->head);
+        std::tie(cc, llvmcall, gc_safe) = convert_cconv(((jl_expr_t*)last)->head);
         nargs -= 1;
     }
 
@@ -2003,7 +2043,7 @@ jl_cgval_t function_sig_t::emit_a_ccall(
                 llvmf = emit_plt(functype, attributes, cc, symarg.f_lib, symarg.f_name);
         }
         else {
-            void *symaddr = jl_dlsym_e(jl_get_library(symarg.f_lib), symarg.f_name);
+            void *symaddr = jl_dlsym_cached(symarg.f_lib, symarg.f_name);
             if (symaddr == NULL) {
                 std::stringstream msg;
                 msg << "ccall: could not find function ";
@@ -2027,6 +2067,24 @@ jl_cgval_t function_sig_t::emit_a_ccall(
     // Mark GC use before **and** after the ccall to make sure the arguments
     // are alive during the ccall even if the function called is `noreturn`.
     mark_gc_uses(gc_uses);
+    // A gc_safe call publishes JL_GC_STATE_SAFE for its duration so a
+    // collection proceeds without waiting for this thread; the collector
+    // may scan our stack meanwhile, so flush pending gc roots first. The
+    // default (un-annotated) path stays free of state transitions.
+    Value *gc_state_addr = NULL;
+    if (gc_safe) {
+        builder.CreateCall(prepare_call(gcroot_flush_func));
+        gc_state_addr = builder.CreateGEP(
+                emit_bitcast(ctx->ptlsStates, T_pint8),
+                ConstantInt::get(T_size, offsetof(jl_tls_states_t, gc_state)));
+        StoreInst *enter = builder.CreateAlignedStore(
+                ConstantInt::get(T_int8, JL_GC_STATE_SAFE), gc_state_addr, 1);
+#if JL_LLVM_VERSION >= 30900
+        enter->setAtomic(AtomicOrdering::Release);
+#else
+        enter->setAtomic(Release);
+#endif
+    }
     // the actual call
     Value *ret = builder.CreateCall(prepare_call(llvmf),
                                     ArrayRef<Value*>(&argvals[0], nargs + sret));
@@ -2034,6 +2092,21 @@ jl_cgval_t function_sig_t::emit_a_ccall(
 
     if (cc != CallingConv::C)
         ((CallInst*)ret)->setCallingConv(cc);
+    if (gc_safe) {
+        // back to the managed state, then take the safepoint the
+        // collector may have armed while we were away (same sequence as
+        // jl_gc_state_set + jl_gc_safepoint_ in julia_threads.h)
+        StoreInst *leave = builder.CreateAlignedStore(
+                ConstantInt::get(T_int8, 0), gc_state_addr, 1);
+#if JL_LLVM_VERSION >= 30900
+        leave->setAtomic(AtomicOrdering::Release);
+#else
+        leave->setAtomic(Release);
+#endif
+        emit_signal_fence();
+        builder.CreateLoad(ctx->signalPage, true);
+        emit_signal_fence();
+    }
     if (!sret)
         result = ret;
     if (needStackRestore) {
@@ -65,6 +65,42 @@ static void unmap_page(void *ptr, size_t size)
 #endif // _OS_WINDOWS_
 }
 
+#ifdef _OS_LINUX_
+// Size of a transparent hugepage on x86. Code slabs are sized and
+// aligned to this so the kernel can back them with 2MB mappings,
+// keeping the iTLB footprint of jitted code down.
+static constexpr size_t hugepage_size = 2 * 1024 * 1024;
+
+// Map an anonymous block aligned to (and a multiple of) the hugepage
+// size and ask the kernel to back it with transparent hugepages.
+// The alignment is done by over-mapping and trimming since mmap makes
+// no alignment promise beyond the page size.
+static void *map_hugepage_block(size_t size)
+{
+    assert(size % hugepage_size == 0);
+    char *mem = (char*)mmap(nullptr, size + hugepage_size,
+                            PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+        return map_anon_page(size);
+    char *aligned = (char*)LLT_ALIGN(uintptr_t(mem), hugepage_size);
+    if (aligned != mem)
+        munmap(mem, aligned - mem);
+    if (size_t tail = hugepage_size - (aligned - mem))
+        munmap(aligned + size, tail);
+#  ifdef MADV_HUGEPAGE
+    madvise(aligned, size, MADV_HUGEPAGE);
+#  endif
+    return aligned;
+}
+
+static size_t get_code_block_size(size_t size)
+{
+    return (size > hugepage_size ? LLT_ALIGN(size, hugepage_size) :
+            hugepage_size);
+}
+#endif // _OS_LINUX_
+
 #ifdef _OS_WINDOWS_
 enum class Prot : int {
     RW = PAGE_READWRITE,
@@ -545,7 +581,8 @@ protected:
         if (!(block.state & SplitPtrBlock::WRInit)) {
             block.wr_ptr = (uintptr_t)create_shared_map(block.total,
                                                         block.wr_ptr);
-            block.state |= SplitPtrBlock::WRInit;
+            // the fresh view is already mapped RW
+            block.state |= SplitPtrBlock::WRInit | SplitPtrBlock::WRReady;
         }
         if (!(block.state & SplitPtrBlock::WRReady)) {
             protect_page((void*)block.wr_ptr, block.total, Prot::RW);
@@ -588,11 +625,19 @@ protected:
             assert(block.state & SplitPtrBlock::WRInit);
             assert(block.state & SplitPtrBlock::WRReady);
             if (reset) {
+                // the slab is full: drop the write view for good
                 unmap_page((void*)block.wr_ptr, block.total);
             }
             else {
-                protect_page((void*)block.wr_ptr, block.total, Prot::RO);
-                block.state = SplitPtrBlock::WRInit;
+                // Keep the write view RW between finalizations instead of
+                // bouncing it RO and back: a slab takes allocations from
+                // many emitted objects before it fills, and re-protecting
+                // it around every object cost an mprotect pair per
+                // emission (tens of thousands of calls during warmup).
+                // The view is a separate non-executable mapping whose
+                // address never leaves the memory manager, so the runtime
+                // mapping still obeys W^X.
+                block.state = SplitPtrBlock::WRInit | SplitPtrBlock::WRReady;
             }
         }
     }
@@ -637,7 +682,15 @@ protected:
     SplitPtrBlock alloc_block(size_t size) override
     {
         SplitPtrBlock new_block;
-        new_block.reset(map_anon_page(size), size);
+        if (exec) {
+            // code lives in hugepage-backed slabs; data blocks stay on
+            // normal pages since they are smaller and sparsely touched
+            size = get_code_block_size(size);
+            new_block.reset(map_hugepage_block(size), size);
+        }
+        else {
+            new_block.reset(map_anon_page(size), size);
+        }
         return new_block;
     }
     void finalize_block(SplitPtrBlock &block, bool reset)
@@ -694,6 +747,14 @@ public:
 };
 #endif // _OS_LINUX_
 
+// When set (via jl_set_code_hot), code sections are allocated from a
+// dedicated slab so that functions identified as hot (e.g. by the
+// sampling profiler) are packed together on shared hugepages instead of
+// interleaving with cold code. The driver forcing their recompilation
+// brackets emission with jl_set_code_hot(1) / jl_set_code_hot(0);
+// emission runs under the codegen lock, so a plain flag suffices.
+static int code_alloc_hot = 0;
+
 class RTDyldMemoryManagerJL : public SectionMemoryManager {
     struct EHFrame {
         uint8_t *addr;
@@ -705,6 +766,7 @@ class RTDyldMemoryManagerJL : public SectionMemoryManager {
     RWAllocator rw_alloc;
     std::unique_ptr<ROAllocator<false>> ro_alloc;
     std::unique_ptr<ROAllocator<true>> exe_alloc;
+    std::unique_ptr<ROAllocator<true>> hot_exec_alloc;
     bool code_allocated;
 
 public:
@@ -714,17 +776,20 @@ public:
           rw_alloc(),
           ro_alloc(),
           exe_alloc(),
+          hot_exec_alloc(),
           code_allocated(false)
     {
 #ifdef _OS_LINUX_
         if (!ro_alloc && init_self_mem() != -1) {
             ro_alloc.reset(new SelfMemAllocator<false>());
             exe_alloc.reset(new SelfMemAllocator<true>());
+            hot_exec_alloc.reset(new SelfMemAllocator<true>());
         }
 #endif
         if (!ro_alloc && init_shared_map() != -1) {
             ro_alloc.reset(new DualMapAllocator<false>());
             exe_alloc.reset(new DualMapAllocator<true>());
+            hot_exec_alloc.reset(new DualMapAllocator<true>());
         }
     }
     ~RTDyldMemoryManagerJL() override
@@ -763,6 +828,7 @@ public:
             return;
         mapAddresses(Dyld, ro_alloc);
         mapAddresses(Dyld, exe_alloc);
+        mapAddresses(Dyld, hot_exec_alloc);
     }
 #ifdef _OS_WINDOWS_
     template <typename Alloc>
@@ -783,6 +849,8 @@ public:
             return ptr;
         if (void *ptr = lookupWriteAddressFor(rt_addr, exe_alloc))
             return ptr;
+        if (void *ptr = lookupWriteAddressFor(rt_addr, hot_exec_alloc))
+            return ptr;
         return rt_addr;
     }
 #endif // _OS_WINDOWS_
@@ -796,8 +864,10 @@ uint8_t *RTDyldMemoryManagerJL::allocateCodeSection(uintptr_t Size,
     // allocating more than one code section can confuse libunwind.
     assert(!code_allocated);
     code_allocated = true;
-    if (exe_alloc)
-        return (uint8_t*)exe_alloc->alloc(Size, Alignment);
+    if (exe_alloc) {
+        auto &alloc = code_alloc_hot ? hot_exec_alloc : exe_alloc;
+        return (uint8_t*)alloc->alloc(Size, Alignment);
+    }
     return SectionMemoryManager::allocateCodeSection(Size, Alignment, SectionID,
                                                      SectionName);
 }
@@ -837,6 +907,7 @@ bool RTDyldMemoryManagerJL::finalizeMemory(std::string *ErrMsg)
         ro_alloc->finalize();
         assert(exe_alloc);
         exe_alloc->finalize();
+        hot_exec_alloc->finalize();
         for (auto &frame: pending_eh)
             register_eh_frames(frame.addr, frame.size);
         pending_eh.clear();
@@ -865,6 +936,8 @@ void RTDyldMemoryManagerJL::deregisterEHFrames(uint8_t *Addr,
                                                size_t Size)
 {
     deregister_eh_frames((uint8_t*)LoadAddr, Size);
+    // any symbolicated frames pointing into this object are now stale
+    jl_flush_frame_cache();
 }
 
 }
@@ -884,8 +957,21 @@ void *lookupWriteAddressFor(RTDyldMemoryManager *memmgr, void *rt_addr)
 }
 #endif
 
+// Route subsequent code-section allocations to the hot slab (see
+// code_alloc_hot above). Called via ccall by whatever drives
+// profile-guided recompilation.
+extern "C" JL_DLLEXPORT void jl_set_code_hot(int hot)
+{
+    code_alloc_hot = hot;
+}
+
 #else // JL_LLVM_VERSION >= 30700
 typedef SectionMemoryManager RTDyldMemoryManagerJL;
+
+extern "C" JL_DLLEXPORT void jl_set_code_hot(int hot)
+{
+    (void)hot;
+}
 #endif // JL_LLVM_VERSION >= 30700
 
 RTDyldMemoryManager* createRTDyldMemoryManager()
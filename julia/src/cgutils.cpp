@@ -1877,6 +1877,44 @@ static Value *as_value(Type *to, const jl_cgval_t &v)
     return emit_unbox(to, v, v.typ);
 }
 
+// emit an inline probe of one of the small-value box caches in datatype.c,
+// calling the out-of-line boxing function only on a miss. `offset` biases
+// the value into the cache index range (NBOX_C/2 for the signed caches).
+static Value *emit_cached_box(Value *v, GlobalVariable *cache, int offset,
+                              Function *boxfunc, bool issigned, jl_codectx_t *ctx)
+{
+    Type *et = v->getType();
+    Value *idx = v;
+    if (offset != 0)
+        idx = builder.CreateAdd(v, ConstantInt::get(et, offset));
+    // an unsigned compare also rejects values that wrapped negative above
+    Value *inrange = builder.CreateICmpULT(idx, ConstantInt::get(et, NBOX_C));
+    BasicBlock *hitBB = BasicBlock::Create(jl_LLVMContext, "box_cache", ctx->f);
+    BasicBlock *missBB = BasicBlock::Create(jl_LLVMContext, "box_alloc", ctx->f);
+    BasicBlock *postBB = BasicBlock::Create(jl_LLVMContext, "post_box", ctx->f);
+    builder.CreateCondBr(inrange, hitBB, missBB);
+    builder.SetInsertPoint(hitBB);
+    GlobalVariable *gv = prepare_global(cache);
+    Value *idxs[] = { ConstantInt::get(T_size, 0),
+                      builder.CreateZExtOrTrunc(idx, T_size) };
+#if JL_LLVM_VERSION >= 30700
+    Value *slot = builder.CreateInBoundsGEP(gv->getValueType(), gv, makeArrayRef(idxs));
+#else
+    Value *slot = builder.CreateInBoundsGEP(gv, makeArrayRef(idxs));
+#endif
+    Value *hit = tbaa_decorate(tbaa_const, builder.CreateLoad(slot));
+    builder.CreateBr(postBB);
+    builder.SetInsertPoint(missBB);
+    Value *miss = issigned ? call_with_signed(boxfunc, v)
+                           : call_with_unsigned(boxfunc, v);
+    builder.CreateBr(postBB);
+    builder.SetInsertPoint(postBB);
+    PHINode *box = builder.CreatePHI(T_pjlvalue, 2);
+    box->addIncoming(hit, hitBB);
+    box->addIncoming(miss, missBB);
+    return box;
+}
+
 // some types have special boxing functions with small-value caches
 static Value *_boxed_special(const jl_cgval_t &vinfo, Type *t, jl_codectx_t *ctx)
 {
@@ -1904,9 +1942,11 @@ static Value *_boxed_special(const jl_cgval_t &vinfo, Type *t, jl_codectx_t *ctx
     else if (jb == jl_int16_type)
         box = call_with_signed(box_int16_func, as_value(t, vinfo));
     else if (jb == jl_int32_type)
-        box = call_with_signed(box_int32_func, as_value(t, vinfo));
+        box = emit_cached_box(as_value(t, vinfo), jlboxedint32cache_var, NBOX_C/2,
+                              box_int32_func, true, ctx);
     else if (jb == jl_int64_type)
-        box = call_with_signed(box_int64_func, as_value(t, vinfo));
+        box = emit_cached_box(as_value(t, vinfo), jlboxedint64cache_var, NBOX_C/2,
+                              box_int64_func, true, ctx);
     else if (jb == jl_float32_type)
         box = builder.CreateCall(prepare_call(box_float32_func), as_value(t, vinfo));
     //if (jb == jl_float64_type)
@@ -1921,7 +1961,8 @@ static Value *_boxed_special(const jl_cgval_t &vinfo, Type *t, jl_codectx_t *ctx
     else if (jb == jl_uint64_type)
         box = call_with_unsigned(box_uint64_func, as_value(t, vinfo));
     else if (jb == jl_char_type)
-        box = call_with_unsigned(box_char_func, as_value(t, vinfo));
+        box = emit_cached_box(as_value(t, vinfo), jlboxedcharcache_var, 0,
+                              box_char_func, false, ctx);
     else if (jb == jl_ssavalue_type) {
         unsigned zero = 0;
         Value *v = as_value(t, vinfo);
@@ -2161,20 +2202,61 @@ static Value *emit_allocobj(jl_codectx_t *ctx, size_t static_size, Value *jt)
     JL_FEAT_REQUIRE(ctx, runtime);
 
     int osize;
-    int offset = jl_gc_classify_pools(static_size, &osize);
+    int klass = jl_gc_classify_pools(static_size, &osize);
     Value *ptls_ptr = emit_bitcast(ctx->ptlsStates, T_pint8);
     Value *v;
-    if (offset < 0) {
+    if (klass < 0) {
         Value *args[] = {ptls_ptr,
                          ConstantInt::get(T_size, static_size + sizeof(void*))};
         v = builder.CreateCall(prepare_call(jlalloc_big_func),
                                ArrayRef<Value*>(args, 2));
     }
     else {
-        Value *pool_offs = ConstantInt::get(T_int32, offset);
+        // inline bump-pointer fast path: allocate from the per-thread
+        // span of free cells that neptune publishes in jl_tls_states_t
+        // (gc_pool_cur/gc_pool_end), calling into the Rust slow path
+        // only when the span is exhausted. The span cells are already
+        // charged to the allocation counter and have cleared tags, so
+        // bumping the cursor is all that is needed here. The pool
+        // index comes from jl_gc_classify_pools so it is the same one
+        // the slow path installs the span under.
+        size_t stride = LLT_ALIGN(osize + sizeof(jl_taggedvalue_t),
+                                  JL_SMALL_BYTE_ALIGNMENT);
+        Value *cur_slot = emit_bitcast(builder.CreateConstGEP1_32(ptls_ptr,
+            offsetof(jl_tls_states_t, gc_pool_cur) + sizeof(char*) * klass),
+            T_ppint8);
+        Value *end_slot = emit_bitcast(builder.CreateConstGEP1_32(ptls_ptr,
+            offsetof(jl_tls_states_t, gc_pool_end) + sizeof(char*) * klass),
+            T_ppint8);
+        Value *cur = builder.CreateLoad(cur_slot);
+        Value *next = builder.CreateGEP(cur, ConstantInt::get(T_size, stride));
+        Value *has_space = builder.CreateICmpULE(next,
+                                                 builder.CreateLoad(end_slot));
+
+        BasicBlock *fastBB = BasicBlock::Create(jl_LLVMContext, "alloc_fast", ctx->f);
+        BasicBlock *slowBB = BasicBlock::Create(jl_LLVMContext, "alloc_slow", ctx->f);
+        BasicBlock *contBB = BasicBlock::Create(jl_LLVMContext, "alloc_cont");
+        builder.CreateCondBr(has_space, fastBB, slowBB);
+
+        builder.SetInsertPoint(fastBB);
+        builder.CreateStore(next, cur_slot);
+        Value *vfast = emit_bitcast(builder.CreateGEP(cur,
+            ConstantInt::get(T_size, sizeof(jl_taggedvalue_t))), T_pjlvalue);
+        builder.CreateBr(contBB);
+
+        builder.SetInsertPoint(slowBB);
+        Value *pool_offs = ConstantInt::get(T_int32, klass);
         Value *args[] = {ptls_ptr, pool_offs, ConstantInt::get(T_int32, osize)};
-        v = builder.CreateCall(prepare_call(jlalloc_pool_func),
-                               ArrayRef<Value*>(args, 3));
+        Value *vslow = builder.CreateCall(prepare_call(jlalloc_pool_func),
+                                          ArrayRef<Value*>(args, 3));
+        builder.CreateBr(contBB);
+
+        ctx->f->getBasicBlockList().push_back(contBB);
+        builder.SetInsertPoint(contBB);
+        PHINode *phi = builder.CreatePHI(T_pjlvalue, 2);
+        phi->addIncoming(vfast, fastBB);
+        phi->addIncoming(vslow, slowBB);
+        v = phi;
     }
     tbaa_decorate(tbaa_tag, builder.CreateStore(jt, emit_typeptr_addr(v)));
     return v;
@@ -2187,20 +2269,25 @@ static void emit_write_barrier(jl_codectx_t *ctx, Value *parent, Value *ptr)
     Value *parent_type = tbaa_decorate(tbaa_tag, builder.CreateLoad(parenttag));
     Value *parent_bits = builder.CreateAnd(parent_type, 3);
 
-    // the branch hint does not seem to make it to the generated code
+    // most stores hit young parents, so the barrier call is cold; a
+    // plain "unlikely" hint never made it into the generated code, but
+    // branch weights do, and they keep the call path laid out off the
+    // straight line
+    MDBuilder mdbuilder(jl_LLVMContext);
+    MDNode *wb_cold = mdbuilder.createBranchWeights(1, 1000);
     Value *parent_old_marked = builder.CreateICmpEQ(parent_bits,
                                                     ConstantInt::get(T_size, 3));
 
     BasicBlock *cont = BasicBlock::Create(jl_LLVMContext, "cont");
     BasicBlock *barrier_may_trigger = BasicBlock::Create(jl_LLVMContext, "wb_may_trigger", ctx->f);
     BasicBlock *barrier_trigger = BasicBlock::Create(jl_LLVMContext, "wb_trigger", ctx->f);
-    builder.CreateCondBr(parent_old_marked, barrier_may_trigger, cont);
+    builder.CreateCondBr(parent_old_marked, barrier_may_trigger, cont, wb_cold);
 
     builder.SetInsertPoint(barrier_may_trigger);
     Value *ptr_mark_bit = builder.CreateAnd(tbaa_decorate(tbaa_tag,
         builder.CreateLoad(emit_bitcast(emit_typeptr_addr(ptr), T_psize))), 1);
     Value *ptr_not_marked = builder.CreateICmpEQ(ptr_mark_bit, ConstantInt::get(T_size, 0));
-    builder.CreateCondBr(ptr_not_marked, barrier_trigger, cont);
+    builder.CreateCondBr(ptr_not_marked, barrier_trigger, cont, wb_cold);
     builder.SetInsertPoint(barrier_trigger);
     builder.CreateCall(prepare_call(queuerootfun), emit_bitcast(parent, T_pjlvalue));
     builder.CreateBr(cont);
@@ -2264,6 +2351,8 @@ static jl_cgval_t emit_new_struct(jl_value_t *ty, size_t nargs, jl_value_t **arg
     assert(nargs>0);
     jl_datatype_t *sty = (jl_datatype_t*)ty;
     size_t nf = jl_datatype_nfields(sty);
+    bool stackalloc = ctx->stackalloc_hint;
+    ctx->stackalloc_hint = false; // don't let the hint leak into field exprs
     if (nf > 0) {
         if (jl_isbits(sty)) {
             Type *lt = julia_type_to_llvm(ty);
@@ -2315,6 +2404,43 @@ static jl_cgval_t emit_new_struct(jl_value_t *ty, size_t nargs, jl_value_t **arg
             else
                 return mark_julia_slot(strct, ty, NULL, tbaa_stack);
         }
+        if (stackalloc && !sty->mutabl && jl_datatype_size(sty) > 0) {
+            // proven by simple_escape_analysis to stay within this frame
+            // and to be consumed only by direct field loads, so the heap
+            // box (and its write barriers) can be elided in favor of an
+            // alloca. the GC does not scan allocas: every pointer field is
+            // additionally stored into a gc frame slot, which keeps the
+            // field values live for the rest of the frame (the collector
+            // does not move objects, so the alloca copies stay valid)
+            AllocaInst *strct = emit_static_alloca(T_int8, jl_datatype_size(sty), ctx);
+            strct->setAlignment(sty->layout->alignment);
+            jl_cgval_t strctinfo = mark_julia_slot(strct, ty, NULL, tbaa_stack);
+            for (size_t i = 0; i < nf; i++) {
+                if (jl_field_isptr(sty, i)) {
+                    tbaa_decorate(tbaa_stack, builder.CreateStore(V_null,
+                            emit_bitcast(builder.CreateGEP(strct,
+                                    ConstantInt::get(T_size, jl_field_offset(sty, i))),
+                                T_ppjlvalue)));
+                }
+            }
+            for (size_t i = 1; i < nargs; i++) {
+                jl_cgval_t rhs = emit_expr(args[i], ctx);
+                if (rhs.isboxed)
+                    emit_typecheck(rhs, jl_svecref(sty->types, i - 1), "new", ctx);
+                if (jl_field_isptr(sty, i - 1)) {
+                    Value *fval = boxed(rhs, ctx, false);
+                    tbaa_decorate(tbaa_stack, builder.CreateStore(fval,
+                            emit_bitcast(builder.CreateGEP(strct,
+                                    ConstantInt::get(T_size, jl_field_offset(sty, i - 1))),
+                                T_ppjlvalue)));
+                    builder.CreateStore(fval, emit_local_root(ctx));
+                }
+                else {
+                    emit_setfield(sty, strctinfo, i - 1, rhs, ctx, false, false);
+                }
+            }
+            return strctinfo;
+        }
         Value *f1 = NULL;
         size_t j = 0;
         if (nf > 0 && jl_field_isptr(sty, 0) && nargs>1) {
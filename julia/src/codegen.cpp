@@ -108,7 +108,7 @@
 
 using namespace llvm;
 namespace llvm {
-    extern bool annotateSimdLoop(BasicBlock *latch);
+    extern bool annotateSimdLoop(BasicBlock *latch, bool ivdep);
 }
 
 #if defined(_OS_WINDOWS_) && !defined(NOMINMAX)
@@ -360,6 +360,7 @@ static Function *jlcopyast_func;
 static Function *jltuple_func;
 static Function *jlnsvec_func;
 static Function *jlapplygeneric_func;
+static Function *jlapplygenericpic_func;
 static Function *jlinvoke_func;
 static Function *jlapply2va_func;
 static Function *jlgetfield_func;
@@ -387,6 +388,9 @@ static Function *box_uint64_func;
 static Function *box_float32_func;
 static Function *box_float64_func;
 static Function *box_ssavalue_func;
+static GlobalVariable *jlboxedint32cache_var;
+static GlobalVariable *jlboxedint64cache_var;
+static GlobalVariable *jlboxedcharcache_var;
 static Function *box8_func;
 static Function *box16_func;
 static Function *box32_func;
@@ -591,6 +595,10 @@ public:
     std::vector<jl_varinfo_t> slots;
     std::vector<jl_cgval_t> SAvalues;
     std::vector<bool> ssavalue_assigned;
+    std::vector<bool> ssavalue_escapes;
+    // set while emitting the rhs of an assignment to a non-escaping
+    // ssavalue; consumed (and cleared) by emit_new_struct
+    bool stackalloc_hint{false};
     std::map<int, jl_arrayvar_t> *arrayvars;
     jl_module_t *module;
     jl_method_instance_t *linfo;
@@ -1121,6 +1129,197 @@ void jl_dump_compiles(void *s)
     dump_compiles_stream = (JL_STREAM*)s;
 }
 
+#if defined(USE_ORCJIT)
+// Tiered JIT: per-method edge counters recorded by the tier-0 code, so
+// the hot-tier recompile can hand LLVM real branch weights. The arrays
+// are never freed: tier-0 code linked directly into callers can keep
+// running (and counting) after the tier-up swap. Guarded by codegen_lock.
+static std::map<jl_method_instance_t*, uint32_t*> tier0_branch_counts;
+
+// count the conditional branches of `target` in emission order; this is
+// the key both sides of the tier boundary use to pair counters with
+// branches, valid because emit_function is deterministic for a given
+// method instance and neither pass runs on optimized IR
+static size_t jl_count_cond_branches(Function *target)
+{
+    size_t n = 0;
+    for (Function::iterator BB = target->begin(), BE = target->end(); BB != BE; ++BB) {
+        BranchInst *br = dyn_cast<BranchInst>(BB->getTerminator());
+        if (br && br->isConditional())
+            n++;
+    }
+    return n;
+}
+
+// instrument every conditional branch of freshly emitted tier-0 code
+// with a taken/not-taken counter pair: a select between two constant
+// slot addresses, a load, an add and a store per execution
+static void jl_insert_tier0_branch_counters(Function *target, jl_method_instance_t *li)
+{
+    size_t nbr = jl_count_cond_branches(target);
+    if (nbr == 0)
+        return;
+    uint32_t *counts = (uint32_t*)calloc(1 + 2 * nbr, sizeof(uint32_t));
+    if (counts == NULL)
+        return;
+    counts[0] = (uint32_t)nbr;
+    tier0_branch_counts[li] = counts; // replacing an entry leaks it, see above
+    size_t i = 0;
+    for (Function::iterator BB = target->begin(), BE = target->end(); BB != BE; ++BB) {
+        BranchInst *br = dyn_cast<BranchInst>(BB->getTerminator());
+        if (!br || !br->isConditional())
+            continue;
+        Constant *tslot = ConstantExpr::getIntToPtr(
+                ConstantInt::get(T_size, (uintptr_t)&counts[1 + 2 * i]), T_pint32);
+        Constant *fslot = ConstantExpr::getIntToPtr(
+                ConstantInt::get(T_size, (uintptr_t)&counts[2 + 2 * i]), T_pint32);
+        IRBuilder<> irb(br);
+        Value *slot = irb.CreateSelect(br->getCondition(), tslot, fslot);
+        irb.CreateStore(irb.CreateAdd(irb.CreateLoad(slot),
+                                      ConstantInt::get(T_int32, 1)), slot);
+        i++;
+    }
+}
+
+// Called on the re-emitted IR during a tier-up recompile: attach the
+// counts the tier-0 code gathered as branch-weight metadata so the
+// optimizer lays hot paths out contiguously. If inlining or a world
+// difference changed the branch structure since tier 0, the count check
+// fails and the function just compiles without weights.
+static void jl_attach_tier0_branch_weights(Function *target, jl_method_instance_t *li)
+{
+    if (!target || target->isDeclaration())
+        return;
+    std::map<jl_method_instance_t*, uint32_t*>::iterator it =
+        tier0_branch_counts.find(li);
+    if (it == tier0_branch_counts.end())
+        return;
+    uint32_t *counts = it->second;
+    if ((size_t)counts[0] != jl_count_cond_branches(target))
+        return;
+    MDBuilder MDB(jl_LLVMContext);
+    size_t i = 0;
+    for (Function::iterator BB = target->begin(), BE = target->end(); BB != BE; ++BB) {
+        BranchInst *br = dyn_cast<BranchInst>(BB->getTerminator());
+        if (!br || !br->isConditional())
+            continue;
+        uint32_t t = counts[1 + 2 * i];
+        uint32_t f = counts[2 + 2 * i];
+        if (t | f) {
+            // +1 keeps never-seen edges representable as merely cold
+            br->setMetadata(LLVMContext::MD_prof,
+                            MDB.createBranchWeights(t + 1, f + 1));
+        }
+        i++;
+    }
+}
+
+// Tiered JIT: prepend an entry counter to freshly emitted tier-0 code so
+// jl_trigger_tier_up can recompile the method through the full pipeline
+// once it proves hot. The inserted prologue costs a load, an add, a
+// store and a never-taken branch per entry.
+static void jl_insert_tier0_counter(Module *m, Function *target, jl_method_instance_t *li)
+{
+    if (!target || target->isDeclaration())
+        return;
+    // tiny bodies have next to nothing to gain from a second pass at
+    // full optimization; leave them on the tier-0 pipeline for good
+    size_t ninst = 0;
+    for (Function::iterator BB = target->begin(), BE = target->end(); BB != BE; ++BB)
+        ninst += BB->size();
+    if (ninst < 20)
+        return;
+    // this method can tier up, so also record where its branches go;
+    // must run before the prologue below adds a branch of its own
+    jl_insert_tier0_branch_counters(target, li);
+    GlobalVariable *counter = new GlobalVariable(*m, T_int32, false,
+            GlobalVariable::PrivateLinkage, ConstantInt::get(T_int32, 0),
+            target->getName().str() + ".tier0_count");
+    Value *trigger = m->getOrInsertFunction("jl_trigger_tier_up",
+            FunctionType::get(T_void, ArrayRef<Type*>(T_pint8), false));
+    BasicBlock *body = &target->getEntryBlock();
+    BasicBlock *entry = BasicBlock::Create(jl_LLVMContext, "tier0.count", target, body);
+    BasicBlock *hot = BasicBlock::Create(jl_LLVMContext, "tier0.hot", target, body);
+    IRBuilder<> irb(entry);
+    Value *n = irb.CreateAdd(irb.CreateLoad(counter), ConstantInt::get(T_int32, 1));
+    irb.CreateStore(n, counter);
+    irb.CreateCondBr(
+            irb.CreateICmpEQ(n, ConstantInt::get(T_int32, jl_tier_up_threshold())),
+            hot, body);
+    irb.SetInsertPoint(hot);
+    irb.CreateCall(trigger, ConstantExpr::getIntToPtr(
+            ConstantInt::get(T_size, (uintptr_t)li), T_pint8));
+    irb.CreateBr(body);
+}
+
+// IR template cache (JULIA_IR_TEMPLATE_CACHE): heavily parameterized code
+// compiles thousands of sibling specializations of the same method whose
+// emitted IR is identical because it only depends on the layout of the
+// argument types, not on the types themselves. Key each freshly emitted
+// module's text (with the unique function names normalized out) by its
+// method; when a sibling reproduces an earlier template byte for byte,
+// point its declarations at the template's code instead of optimizing
+// and MC-compiling the same IR again. Lowering itself still runs — the
+// emitted text is what proves two specializations equivalent, and any
+// spec-dependent constant (a type literal, a method-instance pointer, a
+// direct call to a different callee specialization) shows up in the text
+// and defeats the match. The cache retains the template text for the life
+// of the process, which is why this is opt-in. Protected by codegen_lock.
+static int jl_ir_template_cache_enabled(void)
+{
+    static int enabled = -1;
+    if (enabled == -1) {
+        const char *cache = getenv("JULIA_IR_TEMPLATE_CACHE");
+        enabled = cache && strcmp(cache, "0");
+    }
+    return enabled;
+}
+
+static void jl_ir_template_normalize(std::string &text, StringRef name, const char *repl)
+{
+    if (name.empty())
+        return;
+    size_t pos = 0;
+    while ((pos = text.find(name.str(), pos)) != std::string::npos) {
+        text.replace(pos, name.size(), repl);
+        pos += strlen(repl);
+    }
+}
+
+// returns true (and rewrites *decls to the template's declarations) if an
+// identical template already exists; otherwise records *decls as the
+// template for this IR and returns false
+static bool jl_ir_template_lookup(Module *m, jl_method_instance_t *li, jl_llvm_functions_t *decls)
+{
+    static StringMap<jl_llvm_functions_t> ir_template_cache;
+    Function *f = (Function*)decls->functionObject;
+    Function *specf = (Function*)decls->specFunctionObject;
+    if (!f)
+        return false;
+    std::string key;
+    raw_string_ostream key_stream(key);
+    key_stream << "; method " << (void*)li->def << "\n";
+    m->print(key_stream, NULL);
+    key_stream.flush();
+    // the fresh names embed globalUnique and also appear in the debug-info
+    // metadata, so scrub them textually rather than renaming the functions
+    if (specf)
+        jl_ir_template_normalize(key, specf->getName(), "julia_ir_template_specf");
+    jl_ir_template_normalize(key, f->getName(), "julia_ir_template_f");
+    StringMap<jl_llvm_functions_t>::iterator it = ir_template_cache.find(key);
+    if (it == ir_template_cache.end()) {
+        ir_template_cache[key] = *decls;
+        return false;
+    }
+    // this specialization's own (unparented) declarations are now unused
+    delete f;
+    if (specf)
+        delete specf;
+    *decls = it->second;
+    return true;
+}
+#endif
+
 // --- entry point ---
 //static int n_emit=0;
 static std::unique_ptr<Module> emit_function(
@@ -1162,7 +1361,23 @@ jl_llvm_functions_t jl_compile_linfo(jl_method_instance_t **pli, jl_code_info_t
         }
     }
 
-    JL_GC_PUSH1(&src);
+    // Decompress the AST before taking the codegen lock when we can
+    // already see which blob will be needed. jl_uncompress_ast only
+    // synchronizes on the method's own writelock, so threads warming up
+    // unrelated methods decompress in parallel instead of serializing
+    // here; the re-checks below (under the lock) still decide whether
+    // the result is actually used.
+    jl_code_info_t *unc_src = NULL;
+    jl_value_t *unc_from = NULL;
+    JL_GC_PUSH2(&src, &unc_src);
+    if (li->def != NULL) {
+        unc_from = src ? (jl_value_t*)src : li->inferred;
+        if (unc_from != NULL && unc_from != jl_nothing &&
+            jl_typeis(unc_from, jl_array_uint8_type))
+            unc_src = jl_uncompress_ast(li->def, (jl_array_t*)unc_from);
+        else
+            unc_from = NULL;
+    }
     JL_LOCK(&codegen_lock);
     decls = li->functionObjectsDecls;
 
@@ -1188,7 +1403,9 @@ jl_llvm_functions_t jl_compile_linfo(jl_method_instance_t **pli, jl_code_info_t
             // see if it is inferred
             src = (jl_code_info_t*)li->inferred;
             if (src) {
-                if ((jl_value_t*)src != jl_nothing)
+                if ((jl_value_t*)src == unc_from)
+                    src = unc_src; // decompressed before taking the lock
+                else if ((jl_value_t*)src != jl_nothing)
                     src = jl_uncompress_ast(li->def, (jl_array_t*)src);
                 if (!jl_is_code_info(src)) {
                     src = jl_type_infer(pli, world, 0);
@@ -1208,7 +1425,9 @@ jl_llvm_functions_t jl_compile_linfo(jl_method_instance_t **pli, jl_code_info_t
             goto locked_out;
         }
         else {
-            if ((jl_value_t*)src != jl_nothing)
+            if ((jl_value_t*)src == unc_from)
+                src = unc_src; // decompressed before taking the lock
+            else if ((jl_value_t*)src != jl_nothing)
                 src = jl_uncompress_ast(li->def, (jl_array_t*)src);
         }
         assert(jl_is_code_info(src));
@@ -1252,7 +1471,33 @@ jl_llvm_functions_t jl_compile_linfo(jl_method_instance_t **pli, jl_code_info_t
         Function *f = (Function*)decls.functionObject;
         Function *specf = (Function*)decls.specFunctionObject;
 
-        if (JL_HOOK_TEST(params, module_activation)) {
+#if defined(USE_ORCJIT)
+        if (m && jl_ir_template_cache_enabled() && !imaging_mode && world &&
+            li->def && params == &jl_default_cgparams &&
+            jl_ir_template_lookup(m.get(), li, &decls)) {
+            // identical to an earlier sibling specialization: share its
+            // code and drop this module before it reaches the backend.
+            // (backtraces through the shared code name the template's
+            // method instance.)
+            li->functionObjectsDecls = decls;
+            f = (Function*)decls.functionObject;
+            specf = (Function*)decls.specFunctionObject;
+            m.reset();
+        }
+
+        if (m && jl_ExecutionEngine->usingTieredJIT() &&
+            !imaging_mode && li->def && params == &jl_default_cgparams) {
+            if (!jl_tier_up_in_progress)
+                jl_insert_tier0_counter(m.get(), specf ? specf : f, li);
+            else
+                jl_attach_tier0_branch_weights(specf ? specf : f, li);
+        }
+#endif
+
+        if (!m) {
+            // nothing new to hand to the execution engine
+        }
+        else if (JL_HOOK_TEST(params, module_activation)) {
             JL_HOOK_CALL(params, module_activation, 1, jl_box_voidpointer(wrap(m.release())));
         } else {
             // Step 4. Prepare debug info to receive this function
@@ -1481,8 +1726,24 @@ jl_generic_fptr_t jl_generate_fptr(jl_method_instance_t *li, void *_F, size_t wo
         }
     }
     assert(F);
-    fptr.fptr = (jl_fptr_t)getAddressForFunction(F);
     fptr.jlcall_api = jl_jlcall_api(F);
+#if defined(USE_ORCJIT)
+    if (jl_ExecutionEngine->usingAsyncLink()) {
+        // hand the compiled object to the link worker while holding the
+        // lock, then drop it while waiting for this function's address
+        // so that other threads can keep running codegen in the meantime
+        jl_finalize_function(F);
+        std::string fname = F->getName().str();
+        JL_UNLOCK(&codegen_lock); // Might GC
+        fptr.fptr = (jl_fptr_t)jl_ExecutionEngine->getFunctionAddress(fname);
+        jl_callback_triggered_linfos();
+        JL_LOCK(&codegen_lock);
+    }
+    else
+#endif
+    {
+        fptr.fptr = (jl_fptr_t)getAddressForFunction(F);
+    }
     assert(fptr.fptr != NULL);
     // decide if the fptr should be cached somewhere also
     if (li->functionObjectsDecls.functionObject == F) {
@@ -1516,6 +1777,57 @@ jl_generic_fptr_t jl_generate_fptr(jl_method_instance_t *li, void *_F, size_t wo
     return fptr;
 }
 
+#if defined(USE_ORCJIT)
+// Called from tier-0 compiled code once its entry counter reaches
+// jl_tier_up_threshold(): regenerate the method through the full
+// optimization pipeline and swap the new code in. Dynamic dispatch picks
+// up the new fptr; call sites that were linked directly against the
+// tier-0 specsig code keep it, which is correct, just slower.
+extern "C" JL_DLLEXPORT void jl_trigger_tier_up(jl_method_instance_t *li)
+{
+    if (li->def == NULL)
+        return;
+    JL_LOCK(&codegen_lock);
+    if (jl_tier_up_in_progress) {
+        // a tier-up compile is already running (possibly this very one,
+        // re-entered because the recompile executed the tier-0 code)
+        JL_UNLOCK(&codegen_lock);
+        return;
+    }
+    jl_tier_up_in_progress = 1;
+    // The counter prologue runs before the function body sets up its GC
+    // frame, so the caller's arguments may be live only in registers
+    // here; defer collection for the duration of the recompile.
+    int gc_state = jl_gc_enable(0);
+    jl_llvm_functions_t olddecls = li->functionObjectsDecls;
+    li->functionObjectsDecls.functionObject = NULL;
+    li->functionObjectsDecls.specFunctionObject = NULL;
+    JL_TRY {
+        jl_llvm_functions_t decls = jl_compile_linfo(&li, NULL, li->min_world, &jl_default_cgparams);
+        Function *F = (Function*)decls.functionObject;
+        jl_fptr_t fptr = NULL;
+        if (F != NULL && jl_can_finalize_function(F))
+            fptr = (jl_fptr_t)getAddressForFunction(F);
+        if (fptr != NULL) {
+            // single word stores: a racing caller either keeps the
+            // tier-0 pointer or takes the new one, both of which work
+            li->jlcall_api = jl_jlcall_api(F);
+            li->fptr = fptr;
+        }
+        else {
+            li->functionObjectsDecls = olddecls;
+        }
+    }
+    JL_CATCH {
+        // compilation failed; keep running the tier-0 code
+        li->functionObjectsDecls = olddecls;
+    }
+    jl_gc_enable(gc_state);
+    jl_tier_up_in_progress = 0;
+    JL_UNLOCK(&codegen_lock); // Might GC
+}
+#endif
+
 static Function *jl_cfunction_object(jl_function_t *f, jl_value_t *rt, jl_tupletype_t *argt);
 // get the address of a C-callable entry point for a function
 extern "C" JL_DLLEXPORT
@@ -2265,8 +2577,55 @@ static bool expr_is_symbol(jl_value_t *e)
     return (jl_is_symbol(e) || jl_is_globalref(e));
 }
 
+// whether a `getfield(strct, fld)` call will be emitted as a direct field
+// load (emit_getfield_knownidx); such a use keeps an ssavalue container
+// inside the current frame. mirrors the conditions in emit_builtin_call
+// and emit_getfield under which the generic (boxing) fallback is avoided.
+static bool getfield_is_direct(jl_value_t *strct, jl_value_t *fld, jl_codectx_t *ctx)
+{
+    jl_value_t *stt = expr_type(strct, ctx);
+    if (!jl_is_datatype(stt) || !jl_is_leaf_type(stt))
+        return false;
+    jl_datatype_t *dt = (jl_datatype_t*)stt;
+    if (jl_is_quotenode(fld) && jl_is_symbol(jl_fieldref(fld, 0))) {
+        return jl_is_structtype(dt) && dt != jl_module_type && dt->uid != 0 &&
+            jl_field_index(dt, (jl_sym_t*)jl_fieldref(fld, 0), 0) != -1;
+    }
+    if (jl_is_long(fld) && (jl_is_structtype(dt) || jl_is_tuple_type(dt)) &&
+        dt != jl_module_type) {
+        ssize_t idx = jl_unbox_long(fld);
+        return idx >= 1 && idx <= (ssize_t)jl_datatype_nfields(dt);
+    }
+    return false;
+}
+
+// whether this expression is a construction that emit_expr will hand to
+// emit_new_struct (so a stackalloc_hint set for it cannot leak into a
+// nested expression)
+static bool expr_constructs_leaf(jl_value_t *r, jl_codectx_t *ctx)
+{
+    if (!jl_is_expr(r))
+        return false;
+    jl_expr_t *e = (jl_expr_t*)r;
+    size_t nargs = jl_array_dim0(e->args);
+    if (e->head == new_sym) {
+        jl_value_t *ty = expr_type(jl_exprarg(e, 0), ctx);
+        return jl_is_type_type(ty) && jl_is_datatype(jl_tparam0(ty)) &&
+            jl_is_leaf_type(jl_tparam0(ty));
+    }
+    if (e->head == call_sym && nargs > 1 && ctx->source->inferred &&
+        expr_is_symbol(jl_exprarg(e, 0)) &&
+        static_eval(jl_exprarg(e, 0), ctx, false) == jl_builtin_tuple) {
+        jl_value_t *rt = expr_type(r, ctx);
+        return jl_is_tuple_type(rt) && jl_is_leaf_type(rt) &&
+            nargs - 1 == jl_datatype_nfields(rt);
+    }
+    return false;
+}
+
 // a very simple, conservative escape analysis that is sufficient for
-// eliding allocation of varargs tuples.
+// eliding allocation of varargs tuples and of non-escaping ssavalue
+// tuple/immutable constructions.
 // "esc" means "in escaping context"
 static void simple_escape_analysis(jl_value_t *expr, bool esc, jl_codectx_t *ctx)
 {
@@ -2277,9 +2636,10 @@ static void simple_escape_analysis(jl_value_t *expr, bool esc, jl_codectx_t *ctx
         if (e->head == call_sym || e->head == new_sym) {
             int alen = jl_array_dim0(e->args);
             jl_value_t *f = jl_exprarg(e,0);
+            jl_value_t *fv = NULL;
             simple_escape_analysis(f, esc, ctx);
             if (expr_is_symbol(f)) {
-                if (jl_value_t *fv = static_eval(f, ctx, false)) {
+                if ((fv = static_eval(f, ctx, false))) {
                     if (jl_typeis(fv, jl_intrinsic_type)) {
                         esc = false;
                     }
@@ -2295,7 +2655,14 @@ static void simple_escape_analysis(jl_value_t *expr, bool esc, jl_codectx_t *ctx
             }
 
             for (i = 1; i < (size_t)alen; i++) {
-                simple_escape_analysis(jl_exprarg(e,i), esc, ctx);
+                jl_value_t *a = jl_exprarg(e,i);
+                // a direct field load does not let its container escape;
+                // ssavalues with only such uses can be built on the stack
+                if (i == 1 && fv == jl_builtin_getfield && alen == 3 &&
+                    jl_is_ssavalue(a) &&
+                    getfield_is_direct(a, jl_exprarg(e,2), ctx))
+                    continue;
+                simple_escape_analysis(a, esc, ctx);
             }
         }
         else if (e->head == foreigncall_sym) {
@@ -2332,6 +2699,12 @@ static void simple_escape_analysis(jl_value_t *expr, bool esc, jl_codectx_t *ctx
         vi.escapes |= esc;
         vi.used = true;
     }
+    else if (jl_is_ssavalue(expr)) {
+        // any use other than the direct getfield recognized above is
+        // treated as escaping, regardless of `esc`: a stack-allocated
+        // construction must never be boxed
+        ctx->ssavalue_escapes.at(((jl_ssavalue_t*)expr)->id) = true;
+    }
 }
 
 // --- gc root utils ---
@@ -3426,13 +3799,32 @@ static jl_cgval_t emit_call(jl_expr_t *ex, jl_codectx_t *ctx)
     }
     // put into argument space
     Value *myargs = make_jlcall(makeArrayRef(largs, nargs), ctx);
+    Value *callval;
+    if (!imaging_mode) {
+        // give the site its own inline cache; most dynamic sites dispatch
+        // to the same couple of concrete signatures every time. (in
+        // imaging mode the cache would have to survive serialization, so
+        // those sites keep the plain entry point.)
+        jl_value_t *pic = jl_new_callsite_cache();
 #if JL_LLVM_VERSION >= 30700
-    Value *callval = builder.CreateCall(prepare_call(jlapplygeneric_func),
-                                 {myargs, ConstantInt::get(T_int32, nargs)});
+        callval = builder.CreateCall(prepare_call(jlapplygenericpic_func),
+                                     {literal_pointer_val(pic), myargs,
+                                      ConstantInt::get(T_int32, nargs)});
 #else
-    Value *callval = builder.CreateCall2(prepare_call(jlapplygeneric_func),
-                                  myargs, ConstantInt::get(T_int32, nargs));
+        callval = builder.CreateCall3(prepare_call(jlapplygenericpic_func),
+                                      literal_pointer_val(pic), myargs,
+                                      ConstantInt::get(T_int32, nargs));
 #endif
+    }
+    else {
+#if JL_LLVM_VERSION >= 30700
+        callval = builder.CreateCall(prepare_call(jlapplygeneric_func),
+                                     {myargs, ConstantInt::get(T_int32, nargs)});
+#else
+        callval = builder.CreateCall2(prepare_call(jlapplygeneric_func),
+                                      myargs, ConstantInt::get(T_int32, nargs));
+#endif
+    }
     result = mark_julia_type(callval, true, expr_type(expr, ctx), ctx);
 
     JL_GC_POP();
@@ -3699,7 +4091,13 @@ static void emit_assignment(jl_value_t *l, jl_value_t *r, jl_codectx_t *ctx)
         ssize_t idx = ((jl_ssavalue_t*)l)->id;
         assert(idx >= 0);
         assert(!ctx->ssavalue_assigned.at(idx));
+        // if the constructed value provably stays within this frame, let
+        // emit_new_struct build it on the stack instead of the heap
+        if ((size_t)idx < ctx->ssavalue_escapes.size() &&
+            !ctx->ssavalue_escapes.at(idx) && expr_constructs_leaf(r, ctx))
+            ctx->stackalloc_hint = true;
         jl_cgval_t slot = emit_expr(r, ctx); // slot could be a jl_value_t (unboxed) or jl_value_t* (ispointer)
+        ctx->stackalloc_hint = false;
         if (slot.isboxed || slot.TIndex) {
             // see if inference suggested a different type for the ssavalue than the expression
             // e.g. sometimes the information is inconsistent after inlining getfield on a Tuple
@@ -4194,7 +4592,9 @@ static jl_cgval_t emit_expr(jl_value_t *expr, jl_codectx_t *ctx)
         return mark_julia_type(builder.CreateCall(prepare_call(jlcopyast_func), boxed(ast, ctx)), true, ast.typ, ctx);
     }
     else if (head == simdloop_sym) {
-        llvm::annotateSimdLoop(builder.GetInsertBlock());
+        // `Expr(:simdloop, true)` is emitted by `@simd ivdep`
+        bool ivdep = jl_expr_nargs(ex) > 0 && args[0] == jl_true;
+        llvm::annotateSimdLoop(builder.GetInsertBlock(), ivdep);
         return jl_cgval_t();
     }
     else if (head == goto_ifnot_sym) {
@@ -5162,6 +5562,7 @@ static std::unique_ptr<Module> emit_function(
 
     // create SAvalue locations for SSAValue objects
     ctx.ssavalue_assigned.assign(n_ssavalues, false);
+    ctx.ssavalue_escapes.assign(n_ssavalues, false);
     ctx.SAvalues.assign(n_ssavalues, jl_cgval_t());
 
     // step 3. some variable analysis
@@ -6752,6 +7153,15 @@ static void init_julia_llvm_env(Module *m)
                                            "jl_apply_generic", m);
     add_named_global(jlapplygeneric_func, &jl_apply_generic);
 
+    std::vector<Type *> agpicargs(0);
+    agpicargs.push_back(T_pjlvalue);
+    agpicargs.push_back(T_ppjlvalue);
+    agpicargs.push_back(T_uint32);
+    jlapplygenericpic_func = Function::Create(FunctionType::get(T_pjlvalue, agpicargs, false),
+                                              Function::ExternalLinkage,
+                                              "jl_apply_generic_pic", m);
+    add_named_global(jlapplygenericpic_func, &jl_apply_generic_pic);
+
     std::vector<Type *> invokeargs(0);
     invokeargs.push_back(T_pjlvalue);
     invokeargs.push_back(T_ppjlvalue);
@@ -7381,6 +7791,24 @@ extern "C" void jl_init_codegen(void)
     BOX_F(char,char);
     UBOX_F(ssavalue,size);
 
+    // the small-value box caches probed inline by _boxed_special
+    ArrayType *t_boxcache = ArrayType::get(T_pjlvalue, NBOX_C);
+    jlboxedint32cache_var =
+        new GlobalVariable(*m, t_boxcache,
+                           true, GlobalVariable::ExternalLinkage,
+                           NULL, "jl_boxed_int32_cache");
+    add_named_global(jlboxedint32cache_var, (void*)&jl_boxed_int32_cache);
+    jlboxedint64cache_var =
+        new GlobalVariable(*m, t_boxcache,
+                           true, GlobalVariable::ExternalLinkage,
+                           NULL, "jl_boxed_int64_cache");
+    add_named_global(jlboxedint64cache_var, (void*)&jl_boxed_int64_cache);
+    jlboxedcharcache_var =
+        new GlobalVariable(*m, t_boxcache,
+                           true, GlobalVariable::ExternalLinkage,
+                           NULL, "jl_boxed_char_cache");
+    add_named_global(jlboxedcharcache_var, (void*)&jl_boxed_char_cache);
+
     box8_func  = boxfunc_llvm(ft2arg(T_pjlvalue, T_pjlvalue, T_int8),
                               "jl_box8", &jl_box8, m);
     box16_func = boxfunc_llvm(ft2arg(T_pjlvalue, T_pjlvalue, T_int16),
@@ -90,6 +90,51 @@ jl_datatype_t *jl_new_uninitialized_datatype(void)
     return t;
 }
 
+// Layout descriptors are immutable and permanently allocated, so
+// structurally identical instantiations of a parametric type can share
+// one. jl_get_layout hash-conses them below: the thousandth MyStruct{T}
+// whose fields lay out the same way reuses the descriptor (and the
+// offset/alignment work) of the first.
+static jl_datatype_layout_t **layout_cache = NULL;
+static size_t layout_cache_sz = 0;
+static size_t layout_cache_count = 0;
+static jl_mutex_t layout_cache_lock;
+
+static size_t layout_nbytes(const jl_datatype_layout_t *l)
+{
+    return sizeof(jl_datatype_layout_t) +
+        l->nfields * jl_fielddesc_size(l->fielddesc_type);
+}
+
+// find `l` in the cache, or claim the slot where it belongs
+static jl_datatype_layout_t **layout_cache_bp(const jl_datatype_layout_t *l)
+{
+    size_t nb = layout_nbytes(l);
+    size_t i = memhash32((const char*)l, nb) & (layout_cache_sz - 1);
+    while (1) {
+        jl_datatype_layout_t *c = layout_cache[i];
+        if (c == NULL)
+            return &layout_cache[i];
+        if (layout_nbytes(c) == nb && memcmp(c, l, nb) == 0)
+            return &layout_cache[i];
+        i = (i + 1) & (layout_cache_sz - 1);
+    }
+}
+
+static void layout_cache_rehash(void)
+{
+    jl_datatype_layout_t **old = layout_cache;
+    size_t oldsz = layout_cache_sz;
+    layout_cache_sz = oldsz ? oldsz * 2 : 512;
+    layout_cache = (jl_datatype_layout_t**)calloc(layout_cache_sz,
+                                                  sizeof(jl_datatype_layout_t*));
+    for (size_t i = 0; i < oldsz; i++) {
+        if (old[i])
+            *layout_cache_bp(old[i]) = old[i];
+    }
+    free(old);
+}
+
 static jl_datatype_layout_t *jl_get_layout(uint32_t nfields,
                                            uint32_t alignment,
                                            int haspadding,
@@ -118,10 +163,15 @@ static jl_datatype_layout_t *jl_get_layout(uint32_t nfields,
         }
     }
 
-    // allocate a new descriptor
+    // build the candidate descriptor in scratch space first so it can be
+    // checked against the cache before committing permanent memory
     uint32_t fielddesc_size = jl_fielddesc_size(fielddesc_type);
-    jl_datatype_layout_t *flddesc =
-        (jl_datatype_layout_t*)jl_gc_perm_alloc(sizeof(jl_datatype_layout_t) + nfields * fielddesc_size);
+    size_t nbytes = sizeof(jl_datatype_layout_t) + nfields * fielddesc_size;
+    jl_datatype_layout_t *flddesc;
+    if (nbytes < jl_page_size)
+        flddesc = (jl_datatype_layout_t*)alloca(nbytes);
+    else
+        flddesc = (jl_datatype_layout_t*)malloc(nbytes);
     flddesc->nfields = nfields;
     flddesc->alignment = alignment;
     flddesc->haspadding = haspadding;
@@ -158,7 +208,23 @@ static jl_datatype_layout_t *jl_get_layout(uint32_t nfields,
         npointers = npointers >> 1;
     }
     flddesc->npointers = npointers | (nexp << 16);
-    return flddesc;
+
+    // hash-cons: reuse an identical descriptor if one already exists
+    JL_LOCK_NOGC(&layout_cache_lock);
+    if (layout_cache_count * 4 >= layout_cache_sz * 3)
+        layout_cache_rehash();
+    jl_datatype_layout_t **bp = layout_cache_bp(flddesc);
+    jl_datatype_layout_t *ret = *bp;
+    if (ret == NULL) {
+        ret = (jl_datatype_layout_t*)jl_gc_perm_alloc(nbytes);
+        memcpy(ret, flddesc, nbytes);
+        *bp = ret;
+        layout_cache_count++;
+    }
+    JL_UNLOCK_NOGC(&layout_cache_lock);
+    if (nbytes >= jl_page_size)
+        free(flddesc);
+    return ret;
 }
 
 // Determine if homogeneous tuple with fields of type t will have
@@ -491,52 +557,100 @@ UNBOX_FUNC(voidpointer, void*)
     }
 BOX_FUNC(float32, float,  jl_box, 1)
 BOX_FUNC(voidpointer, void*,  jl_box, 1)
+
+// Float64 gets a small cache of its own: the integral values 0.0 through
+// NBOX_F64-1.0, plus the special values arithmetic produces constantly
+// (NaN and the infinities). Entries are matched on the exact bit pattern,
+// never by `==`: jl_egal compares bits, so -0.0 must not share 0.0's box
+// and only the canonical NaN encoding may hit the cache.
+#ifndef NBOX_F64
+#define NBOX_F64 256
+#endif
+static jl_value_t *boxed_float64_cache[NBOX_F64];
+static jl_value_t *boxed_float64_specials[3]; // NaN, Inf, -Inf
+
+JL_DLLEXPORT jl_value_t *jl_box_float64(double x)
+{
+    jl_ptls_t ptls = jl_get_ptls_states();
+    uint64_t bits;
+    jl_value_t *cached = NULL;
+    memcpy(&bits, &x, sizeof(bits));
+    if (!(bits >> 63) && x < NBOX_F64) { // the sign bit rules out -0.0
+        int64_t i = (int64_t)x;          // NaN already failed the comparison
+        if ((double)i == x)
+            cached = boxed_float64_cache[i];
+    }
+    else if (bits == 0x7ff8000000000000ull) { // canonical NaN only
+        cached = boxed_float64_specials[0];
+    }
+    else if (bits == 0x7ff0000000000000ull) {
+        cached = boxed_float64_specials[1];
+    }
+    else if (bits == 0xfff0000000000000ull) {
+        cached = boxed_float64_specials[2];
+    }
+    // the cache is empty until jl_init_box_caches (boot.jl lowering boxes
+    // floats before that), so a NULL entry just means allocate
+    if (cached)
+        return cached;
 #ifdef _P64
-BOX_FUNC(float64, double, jl_box, 1)
+    jl_value_t *v = jl_gc_alloc(ptls, 1 * sizeof(void*), jl_float64_type);
 #else
-BOX_FUNC(float64, double, jl_box, 2)
+    jl_value_t *v = jl_gc_alloc(ptls, 2 * sizeof(void*), jl_float64_type);
 #endif
+    *(double*)jl_data_ptr(v) = x;
+    return v;
+}
 
-#define NBOX_C 1024
-
-#define SIBOX_FUNC(typ,c_type,nw)\
-    static jl_value_t *boxed_##typ##_cache[NBOX_C];             \
+// NBOX_C is defined (and overridable) in julia_internal.h. The caches for
+// Int32, Int64 and Char are probed inline by codegen, so those arrays are
+// exported; the rest stay private to this file.
+static jl_value_t *boxed_int16_cache[NBOX_C];
+JL_DLLEXPORT jl_value_t *jl_boxed_int32_cache[NBOX_C];
+JL_DLLEXPORT jl_value_t *jl_boxed_int64_cache[NBOX_C];
+static jl_value_t *boxed_uint16_cache[NBOX_C];
+static jl_value_t *boxed_uint32_cache[NBOX_C];
+JL_DLLEXPORT jl_value_t *jl_boxed_char_cache[NBOX_C];
+static jl_value_t *boxed_ssavalue_cache[NBOX_C];
+static jl_value_t *boxed_slotnumber_cache[NBOX_C];
+static jl_value_t *boxed_uint64_cache[NBOX_C];
+
+#define SIBOX_FUNC(typ,c_type,nw,cache)                         \
     JL_DLLEXPORT jl_value_t *jl_box_##typ(c_type x)             \
     {                                                           \
         jl_ptls_t ptls = jl_get_ptls_states();                  \
         c_type idx = x+NBOX_C/2;                                \
         if ((u##c_type)idx < (u##c_type)NBOX_C)                 \
-            return boxed_##typ##_cache[idx];                    \
+            return cache[idx];                                  \
         jl_value_t *v = jl_gc_alloc(ptls, nw * sizeof(void*),   \
                                     jl_##typ##_type);           \
         *(c_type*)jl_data_ptr(v) = x;                           \
         return v;                                               \
     }
-#define UIBOX_FUNC(typ,c_type,nw)                               \
-    static jl_value_t *boxed_##typ##_cache[NBOX_C];             \
+#define UIBOX_FUNC(typ,c_type,nw,cache)                         \
     JL_DLLEXPORT jl_value_t *jl_box_##typ(c_type x)             \
     {                                                           \
         jl_ptls_t ptls = jl_get_ptls_states();                  \
         if (x < NBOX_C)                                         \
-            return boxed_##typ##_cache[x];                      \
+            return cache[x];                                    \
         jl_value_t *v = jl_gc_alloc(ptls, nw * sizeof(void*),   \
                                     jl_##typ##_type);           \
         *(c_type*)jl_data_ptr(v) = x;                           \
         return v;                                               \
     }
-SIBOX_FUNC(int16,  int16_t, 1)
-SIBOX_FUNC(int32,  int32_t, 1)
-UIBOX_FUNC(uint16, uint16_t, 1)
-UIBOX_FUNC(uint32, uint32_t, 1)
-UIBOX_FUNC(char,   uint32_t, 1)
-UIBOX_FUNC(ssavalue, size_t, 1)
-UIBOX_FUNC(slotnumber, size_t, 1)
+SIBOX_FUNC(int16,  int16_t, 1, boxed_int16_cache)
+SIBOX_FUNC(int32,  int32_t, 1, jl_boxed_int32_cache)
+UIBOX_FUNC(uint16, uint16_t, 1, boxed_uint16_cache)
+UIBOX_FUNC(uint32, uint32_t, 1, boxed_uint32_cache)
+UIBOX_FUNC(char,   uint32_t, 1, jl_boxed_char_cache)
+UIBOX_FUNC(ssavalue, size_t, 1, boxed_ssavalue_cache)
+UIBOX_FUNC(slotnumber, size_t, 1, boxed_slotnumber_cache)
 #ifdef _P64
-SIBOX_FUNC(int64,  int64_t, 1)
-UIBOX_FUNC(uint64, uint64_t, 1)
+SIBOX_FUNC(int64,  int64_t, 1, jl_boxed_int64_cache)
+UIBOX_FUNC(uint64, uint64_t, 1, boxed_uint64_cache)
 #else
-SIBOX_FUNC(int64,  int64_t, 2)
-UIBOX_FUNC(uint64, uint64_t, 2)
+SIBOX_FUNC(int64,  int64_t, 2, jl_boxed_int64_cache)
+UIBOX_FUNC(uint64, uint64_t, 2, boxed_uint64_cache)
 #endif
 
 static jl_value_t *boxed_int8_cache[256];
@@ -554,8 +668,8 @@ void jl_init_int32_int64_cache(void)
 {
     int64_t i;
     for(i=0; i < NBOX_C; i++) {
-        boxed_int32_cache[i]  = jl_box32(jl_int32_type, i-NBOX_C/2);
-        boxed_int64_cache[i]  = jl_box64(jl_int64_type, i-NBOX_C/2);
+        jl_boxed_int32_cache[i]  = jl_box32(jl_int32_type, i-NBOX_C/2);
+        jl_boxed_int64_cache[i]  = jl_box64(jl_int64_type, i-NBOX_C/2);
 #ifdef _P64
         boxed_ssavalue_cache[i] = jl_box64(jl_ssavalue_type, i);
         boxed_slotnumber_cache[i] = jl_box64(jl_slotnumber_type, i);
@@ -579,9 +693,18 @@ void jl_init_box_caches(void)
         boxed_int16_cache[i]  = jl_box16(jl_int16_type, i-NBOX_C/2);
         boxed_uint16_cache[i] = jl_box16(jl_uint16_type, i);
         boxed_uint32_cache[i] = jl_box32(jl_uint32_type, i);
-        boxed_char_cache[i]   = jl_box32(jl_char_type, i);
+        jl_boxed_char_cache[i] = jl_box32(jl_char_type, i);
         boxed_uint64_cache[i] = jl_box64(jl_uint64_type, i);
     }
+    for(i=0; i < NBOX_F64; i++) {
+        double d = (double)i;
+        int64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        boxed_float64_cache[i] = jl_box64(jl_float64_type, bits);
+    }
+    boxed_float64_specials[0] = jl_box64(jl_float64_type, 0x7ff8000000000000ll);
+    boxed_float64_specials[1] = jl_box64(jl_float64_type, 0x7ff0000000000000ll);
+    boxed_float64_specials[2] = jl_box64(jl_float64_type, (int64_t)0xfff0000000000000ull);
 }
 
 void jl_mark_box_caches(jl_ptls_t ptls)
@@ -593,15 +716,21 @@ void jl_mark_box_caches(jl_ptls_t ptls)
     }
     for(i=0; i < NBOX_C; i++) {
         jl_gc_setmark(ptls, boxed_int16_cache[i]);
-        jl_gc_setmark(ptls, boxed_int32_cache[i]);
-        jl_gc_setmark(ptls, boxed_int64_cache[i]);
+        jl_gc_setmark(ptls, jl_boxed_int32_cache[i]);
+        jl_gc_setmark(ptls, jl_boxed_int64_cache[i]);
         jl_gc_setmark(ptls, boxed_uint16_cache[i]);
         jl_gc_setmark(ptls, boxed_uint32_cache[i]);
-        jl_gc_setmark(ptls, boxed_char_cache[i]);
+        jl_gc_setmark(ptls, jl_boxed_char_cache[i]);
         jl_gc_setmark(ptls, boxed_uint64_cache[i]);
         jl_gc_setmark(ptls, boxed_ssavalue_cache[i]);
         jl_gc_setmark(ptls, boxed_slotnumber_cache[i]);
     }
+    for(i=0; i < NBOX_F64; i++) {
+        jl_gc_setmark(ptls, boxed_float64_cache[i]);
+    }
+    for(i=0; i < 3; i++) {
+        jl_gc_setmark(ptls, boxed_float64_specials[i]);
+    }
 }
 
 JL_DLLEXPORT jl_value_t *jl_box_bool(int8_t x)
@@ -45,11 +45,18 @@ using namespace llvm;
 #  define UNW_LOCAL_ONLY
 #  include <libunwind.h>
 #  include <link.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  include <fcntl.h>
+#  include <time.h>
+#  include <elf.h>
 #endif
 
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <list>
 #include <map>
 #include <vector>
 #include <set>
@@ -71,9 +78,13 @@ typedef object::SymbolRef SymRef;
 // and cannot have any interaction with the julia runtime
 static uv_rwlock_t threadsafe;
 
+// protects the symbolicated-frame cache further down in this file
+static uv_mutex_t frame_cache_lock;
+
 extern "C" void jl_init_debuginfo()
 {
     uv_rwlock_init(&threadsafe);
+    uv_mutex_init(&frame_cache_lock);
 }
 
 // --- storing and accessing source location metadata ---
@@ -93,6 +104,13 @@ struct ObjectInfo {
 #if JL_LLVM_VERSION >= 30700
     DIContext *context;
 #endif
+#if JL_LLVM_VERSION >= 30800
+    // load-address mapping retained so `context` can be built lazily on
+    // the first backtrace that hits this object (see jl_DI_for_fptr);
+    // most processes never take one, so parsing DWARF at emission time
+    // was pure overhead on every JIT compile
+    const LoadedObjectInfo *L;
+#endif
 #if defined(_OS_DARWIN_) && JL_LLVM_VERSION < 30700
     const char *name;
 #endif
@@ -118,9 +136,141 @@ static std::string mangle(const std::string &Name, const DataLayout &DL)
 }
 void jl_add_linfo_in_flight(StringRef name, jl_method_instance_t *linfo, const DataLayout &DL)
 {
+    // the emission notifications that consume this map can run on the
+    // async JIT link worker, so the insert has to take the lock too
+    uv_rwlock_wrlock(&threadsafe);
     linfo_in_flight[mangle(name, DL)] = linfo;
+    uv_rwlock_wrunlock(&threadsafe);
+}
+
+#ifdef _OS_LINUX_
+// --- perf profiler interface ---
+//
+// With JULIA_PERF_JITDUMP set we append every emitted function to
+// /tmp/jit-<pid>.dump in perf's jitdump format (see
+// tools/perf/Documentation/jitdump-specification.txt), so that
+// `perf record -k mono` followed by `perf inject --jit` can annotate
+// and disassemble JIT'd frames. JULIA_PERF_MAP additionally (or
+// alone) writes the simple /tmp/perf-<pid>.map symbol table, which
+// gives names but no disassembly. contrib/perf_annotate.jl renders
+// per-instruction sample counts from the dump without perf inject.
+
+#define JITDUMP_MAGIC 0x4A695444 // "JiTD"
+#define JITDUMP_VERSION 1
+#define JITDUMP_CODE_LOAD 0
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t total_size;
+    uint32_t elf_mach;
+    uint32_t pad1;
+    uint32_t pid;
+    uint64_t timestamp;
+    uint64_t flags;
+} jitdump_header_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t total_size;
+    uint64_t timestamp;
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t vma;
+    uint64_t code_addr;
+    uint64_t code_size;
+    uint64_t code_index;
+} jitdump_code_load_t;
+
+static FILE *perf_map_file = NULL;
+static FILE *jitdump_file = NULL;
+static uint64_t jitdump_code_index = 0;
+
+static uint64_t perf_timestamp(void)
+{
+    // must match the clock passed to `perf record -k`
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
 }
 
+static void jl_perf_jit_init(void)
+{
+    static int initialized = 0;
+    if (initialized)
+        return;
+    initialized = 1;
+    char path[64];
+    const char *jitdump = getenv("JULIA_PERF_JITDUMP");
+    const char *map = getenv("JULIA_PERF_MAP");
+    if (jitdump && *jitdump && strcmp(jitdump, "0")) {
+        snprintf(path, sizeof(path), "/tmp/jit-%d.dump", (int)getpid());
+        int fd = open(path, O_CREAT | O_TRUNC | O_RDWR, 0666);
+        if (fd != -1) {
+            // perf inject locates the dump through an executable mapping
+            // of the file in the recorded stream; keep it mapped for the
+            // life of the process
+            long pgsz = sysconf(_SC_PAGESIZE);
+            (void)mmap(NULL, pgsz, PROT_READ | PROT_EXEC, MAP_PRIVATE, fd, 0);
+            jitdump_file = fdopen(fd, "w");
+        }
+        if (jitdump_file) {
+            jitdump_header_t header;
+            memset(&header, 0, sizeof(header));
+            header.magic = JITDUMP_MAGIC;
+            header.version = JITDUMP_VERSION;
+            header.total_size = sizeof(header);
+#if defined(_CPU_X86_64_)
+            header.elf_mach = EM_X86_64;
+#elif defined(_CPU_X86_)
+            header.elf_mach = EM_386;
+#elif defined(_CPU_AARCH64_)
+            header.elf_mach = EM_AARCH64;
+#elif defined(_CPU_ARM_)
+            header.elf_mach = EM_ARM;
+#endif
+            header.pid = (uint32_t)getpid();
+            header.timestamp = perf_timestamp();
+            fwrite(&header, sizeof(header), 1, jitdump_file);
+            fflush(jitdump_file);
+        }
+    }
+    if (map && *map && strcmp(map, "0")) {
+        snprintf(path, sizeof(path), "/tmp/perf-%d.map", (int)getpid());
+        perf_map_file = fopen(path, "w");
+    }
+}
+
+// GC safe. The caller holds the debuginfo write lock, which also
+// serializes the file writes.
+static void jl_perf_note_code(const char *name, uint64_t addr, uint64_t size)
+{
+    jl_perf_jit_init();
+    if (perf_map_file) {
+        fprintf(perf_map_file, "%llx %llx %s\n",
+                (unsigned long long)addr, (unsigned long long)size, name);
+        fflush(perf_map_file);
+    }
+    if (jitdump_file) {
+        size_t namelen = strlen(name) + 1;
+        jitdump_code_load_t rec;
+        rec.id = JITDUMP_CODE_LOAD;
+        rec.total_size = (uint32_t)(sizeof(rec) + namelen + size);
+        rec.timestamp = perf_timestamp();
+        rec.pid = (uint32_t)getpid();
+        rec.tid = (uint32_t)syscall(SYS_gettid);
+        rec.vma = addr;
+        rec.code_addr = addr;
+        rec.code_size = size;
+        rec.code_index = jitdump_code_index++;
+        fwrite(&rec, sizeof(rec), 1, jitdump_file);
+        fwrite(name, namelen, 1, jitdump_file);
+        fwrite((const void*)(uintptr_t)addr, (size_t)size, 1, jitdump_file);
+        fflush(jitdump_file);
+    }
+}
+#endif // _OS_LINUX_
+
 #if defined(_OS_WINDOWS_)
 static void create_PRUNTIME_FUNCTION(uint8_t *Code, size_t Size, StringRef fnname,
                                      uint8_t *Section, size_t Allocated, uint8_t *UnwindData)
@@ -219,7 +369,12 @@ void jl_callback_triggered_linfos(void)
     if (triggered_linfos.empty())
         return;
     if (jl_linfo_tracer) {
+        // the vector is filled under this lock by the emission
+        // notification, possibly from the async JIT link worker; drop
+        // the lock again before running arbitrary tracer code
+        uv_rwlock_wrlock(&threadsafe);
         std::vector<jl_method_instance_t*> to_process(std::move(triggered_linfos));
+        uv_rwlock_wrunlock(&threadsafe);
         for (jl_method_instance_t *linfo : to_process)
             jl_call_tracer(jl_linfo_tracer, (jl_value_t*)linfo);
     }
@@ -282,13 +437,86 @@ public:
 #endif // ifndef USE_MCJIT
 
 #ifdef USE_MCJIT
+    // Lock-free snapshot of `linfomap` for lookups that must not block
+    // (the profiler reads it from signal context): a flat array of POD
+    // entries sorted by descending start address, published under a
+    // sequence counter. The writer (NotifyObjectEmitted, holding the
+    // write lock) bumps the counter to an odd value, rebuilds the table,
+    // and bumps it again; readers retry on an odd or changed counter and
+    // only compare integers before validating, so a torn read is never
+    // dereferenced. Outgrown tables go on a retired list instead of
+    // being freed, since a handler may still be scanning one; doubling
+    // growth bounds the waste at about one extra copy of the live table.
+    struct LinfoEntry {
+        size_t addr;
+        size_t size;
+        jl_method_instance_t *linfo;
+    };
+private:
+    LinfoEntry *linfotab{nullptr};
+    size_t linfotab_len{0};
+    size_t linfotab_cap{0};
+    volatile size_t linfotab_seq{0};
+    SmallVector<LinfoEntry*, 4> linfotab_retired;
+
+    // must be called with the write lock held
+    void rebuildLinfoTab(void)
+    {
+        size_t n = linfomap.size();
+        if (n == linfotab_len)
+            return;
+        jl_atomic_store_release(&linfotab_seq, linfotab_seq + 1);
+        if (n > linfotab_cap) {
+            size_t newcap = linfotab_cap ? linfotab_cap * 2 : 512;
+            while (newcap < n)
+                newcap *= 2;
+            LinfoEntry *newtab = (LinfoEntry*)malloc(newcap * sizeof(LinfoEntry));
+            if (linfotab)
+                linfotab_retired.push_back(linfotab);
+            linfotab = newtab;
+            linfotab_cap = newcap;
+        }
+        size_t i = 0;
+        for (auto &ent : linfomap) {
+            linfotab[i].addr = ent.first;
+            linfotab[i].size = ent.second.first;
+            linfotab[i].linfo = ent.second.second;
+            i++;
+        }
+        linfotab_len = n;
+        jl_atomic_store_release(&linfotab_seq, linfotab_seq + 1);
+    }
+
+public:
+    // Address-to-method-instance lookup that never blocks, so it is safe
+    // from the profiler's signal handler even when the interrupted thread
+    // holds the write lock. Gives up (returns NULL, losing one sample's
+    // attribution) instead of spinning if an update stays in flight,
+    // since the writer may be the interrupted thread itself.
     jl_method_instance_t *lookupLinfo(size_t pointer)
     {
-        auto linfo = linfomap.lower_bound(pointer);
-        if (linfo != linfomap.end() && pointer < linfo->first + linfo->second.first)
-            return linfo->second.second;
-        else
-            return NULL;
+        for (int retry = 0; retry < 16; retry++) {
+            size_t seq = jl_atomic_load_acquire(&linfotab_seq);
+            if (seq & 1)
+                continue;
+            LinfoEntry *tab = linfotab;
+            size_t len = linfotab_len;
+            jl_method_instance_t *ret = NULL;
+            // find the first entry with addr <= pointer
+            size_t lo = 0, hi = len;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (tab[mid].addr > pointer)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            if (lo < len && pointer < tab[lo].addr + tab[lo].size)
+                ret = tab[lo].linfo;
+            if (jl_atomic_load_acquire(&linfotab_seq) == seq)
+                return ret;
+        }
+        return NULL;
     }
 #if JL_LLVM_VERSION >= 30600
 
@@ -525,6 +753,10 @@ public:
             StringRef sName = sNameOrError.get();
             uint64_t SectionSize = Section->getSize();
             size_t Size = sym_size.second;
+#if defined(_OS_LINUX_)
+            if (Size > 0)
+                jl_perf_note_code(sName.str().c_str(), Addr, Size);
+#endif
 #if defined(_OS_WINDOWS_)
             if (SectionAddrCheck)
                 assert(SectionAddrCheck == SectionLoadAddr);
@@ -559,7 +791,15 @@ public:
                 ObjectInfo tmp = {&debugObj,
                     (size_t)SectionSize,
                     (ptrdiff_t)(SectionAddr - SectionLoadAddr),
+#if JL_LLVM_VERSION >= 30800
+                    // parsing the DWARF is the expensive part of this
+                    // hook; keep only the map insertion on the emission
+                    // path and build the context on first use
+                    nullptr,
+                    L.clone().release(),
+#else
                     new DWARFContextInMemory(debugObj, &L),
+#endif
                     };
                 objectmap[SectionLoadAddr] = tmp;
                 first = false;
@@ -618,6 +858,9 @@ public:
             create_PRUNTIME_FUNCTION(
                    (uint8_t*)(uintptr_t)Addr, (size_t)Size, sName,
                    (uint8_t*)(uintptr_t)SectionLoadAddr, (size_t)SectionSize, UnwindData);
+#elif defined(_OS_LINUX_)
+            if (Size > 0)
+                jl_perf_note_code(sName.str().c_str(), Addr, Size);
 #endif
             StringMap<jl_method_instance_t*>::iterator linfo_it = linfo_in_flight.find(sName);
             jl_method_instance_t *linfo = NULL;
@@ -668,6 +911,7 @@ public:
         }
 #endif
 #endif
+        rebuildLinfoTab();
         uv_rwlock_wrunlock(&threadsafe);
         jl_gc_safe_leave(ptls, gc_state);
     }
@@ -1455,7 +1699,23 @@ int jl_DI_for_fptr(uint64_t fptr, uint64_t *symsize, int64_t *slide, int64_t *se
             *section_slide = fit->second.slide;
         *object = fit->second.object;
         if (context) {
-#if JL_LLVM_VERSION >= 30700
+#if JL_LLVM_VERSION >= 30800
+            if (!fit->second.context) {
+                // First backtrace to hit this object: parse its debug
+                // info now. Upgrade to the write lock for the
+                // construction and re-check after reacquiring, since
+                // another reader may have built it in the window.
+                // (Map iterators stay valid; entries are never erased.)
+                uv_rwlock_rdunlock(&threadsafe);
+                uv_rwlock_wrlock(&threadsafe);
+                if (!fit->second.context)
+                    fit->second.context = new DWARFContextInMemory(
+                        *fit->second.object, fit->second.L);
+                uv_rwlock_wrunlock(&threadsafe);
+                uv_rwlock_rdlock(&threadsafe);
+            }
+            *context = fit->second.context;
+#elif JL_LLVM_VERSION >= 30700
             *context = fit->second.context;
 #else
             *context = DIContext::getDWARFContext(*fit->second.object);
@@ -1520,7 +1780,104 @@ JL_DLLEXPORT uint64_t jl_get_section_start(uint64_t fptr)
 #endif
 
 // Set *name and *filename to either NULL or malloc'd string
-int jl_getFunctionInfo(jl_frame_t **frames_out, size_t pointer, int skipC, int noInline)
+// --- cache of symbolicated frames ---
+
+// Exception-heavy code symbolicates the same addresses over and over,
+// and every lookup above re-runs the DWARF inline-frame resolution.
+// Cache the fully resolved frame vectors keyed by (address, flags),
+// LRU-evicted and flushed when object code is deregistered. Entries are
+// deep-copied in both directions since callers free the strings they
+// receive. Guarded by its own mutex rather than `threadsafe` because
+// hits update the LRU list too; like the lookups themselves this can
+// run on an unmanaged thread, so no TLS and no GC allocation here.
+
+#define FRAME_CACHE_MAX_ENTRIES 1024
+
+typedef std::pair<size_t, int> frame_cache_key_t;
+struct frame_cache_entry_t {
+    frame_cache_key_t key;
+    jl_frame_t *frames;
+    int n;
+};
+static std::list<frame_cache_entry_t> frame_cache_lru;
+static std::map<frame_cache_key_t, std::list<frame_cache_entry_t>::iterator>
+    frame_cache;
+
+static jl_frame_t *copy_frames(const jl_frame_t *frames, int n)
+{
+    jl_frame_t *copy = (jl_frame_t*)malloc(sizeof(jl_frame_t) * n);
+    memcpy(copy, frames, sizeof(jl_frame_t) * n);
+    for (int i = 0; i < n; i++) {
+        if (frames[i].func_name)
+            copy[i].func_name = strdup(frames[i].func_name);
+        if (frames[i].file_name)
+            copy[i].file_name = strdup(frames[i].file_name);
+    }
+    return copy;
+}
+
+static void free_frames(jl_frame_t *frames, int n)
+{
+    for (int i = 0; i < n; i++) {
+        free(frames[i].func_name);
+        free(frames[i].file_name);
+    }
+    free(frames);
+}
+
+static int frame_cache_lookup(jl_frame_t **frames_out, size_t pointer,
+                              int skipC, int noInline)
+{
+    frame_cache_key_t key(pointer, (skipC != 0) | ((noInline != 0) << 1));
+    int n = 0;
+    uv_mutex_lock(&frame_cache_lock);
+    auto it = frame_cache.find(key);
+    if (it != frame_cache.end()) {
+        frame_cache_lru.splice(frame_cache_lru.begin(), frame_cache_lru,
+                               it->second);
+        n = it->second->n;
+        *frames_out = copy_frames(it->second->frames, n);
+    }
+    uv_mutex_unlock(&frame_cache_lock);
+    return n;
+}
+
+static void frame_cache_store(jl_frame_t *frames, int n, size_t pointer,
+                              int skipC, int noInline)
+{
+    if (n <= 0)
+        return;
+    frame_cache_key_t key(pointer, (skipC != 0) | ((noInline != 0) << 1));
+    uv_mutex_lock(&frame_cache_lock);
+    if (frame_cache.find(key) == frame_cache.end()) {
+        if (frame_cache.size() >= FRAME_CACHE_MAX_ENTRIES) {
+            frame_cache_entry_t &old = frame_cache_lru.back();
+            frame_cache.erase(old.key);
+            free_frames(old.frames, old.n);
+            frame_cache_lru.pop_back();
+        }
+        frame_cache_entry_t ent = { key, copy_frames(frames, n), n };
+        frame_cache_lru.push_front(ent);
+        frame_cache[key] = frame_cache_lru.begin();
+    }
+    uv_mutex_unlock(&frame_cache_lock);
+}
+
+// cached resolutions are only valid while the object they point into
+// stays loaded; called whenever an object's eh frames are deregistered
+// (cgmemmgr.cpp), the one unload notification this runtime has
+void jl_flush_frame_cache(void)
+{
+    uv_mutex_lock(&frame_cache_lock);
+    for (std::list<frame_cache_entry_t>::iterator it = frame_cache_lru.begin();
+         it != frame_cache_lru.end(); ++it)
+        free_frames(it->frames, it->n);
+    frame_cache_lru.clear();
+    frame_cache.clear();
+    uv_mutex_unlock(&frame_cache_lock);
+}
+
+static int jl_getFunctionInfo_(jl_frame_t **frames_out, size_t pointer, int skipC, int noInline)
 {
     // This function is not allowed to reference any TLS variables if noInline
     // since it can be called from an unmanaged thread on OSX.
@@ -1629,6 +1986,16 @@ int jl_getFunctionInfo(jl_frame_t **frames_out, size_t pointer, int skipC, int n
     return jl_getDylibFunctionInfo(frames_out, pointer, skipC, noInline);
 }
 
+int jl_getFunctionInfo(jl_frame_t **frames_out, size_t pointer, int skipC, int noInline)
+{
+    int n = frame_cache_lookup(frames_out, pointer, skipC, noInline);
+    if (n > 0)
+        return n;
+    n = jl_getFunctionInfo_(frames_out, pointer, skipC, noInline);
+    frame_cache_store(*frames_out, n, pointer, skipC, noInline);
+    return n;
+}
+
 extern "C" jl_method_instance_t *jl_gdblookuplinfo(void *p)
 {
 #ifndef USE_MCJIT
@@ -74,18 +74,21 @@ static void JL_NORETURN jl_dlerror(const char *fmt, const char *sym)
     jl_errorf(fmt, sym, reason);
 }
 
+static void jl_dlsym_cache_flush(void);
+
 JL_DLLEXPORT void *jl_dlopen(const char *filename, unsigned flags)
 {
+    void *handle;
 #if defined(_OS_WINDOWS_)
     needsSymRefreshModuleList = 1;
     size_t len = MultiByteToWideChar(CP_UTF8, 0, filename, -1, NULL, 0);
     if (!len) return NULL;
     WCHAR *wfilename = (WCHAR*)alloca(len * sizeof(WCHAR));
     if (!MultiByteToWideChar(CP_UTF8, 0, filename, -1, wfilename, len)) return NULL;
-    return LoadLibraryExW(wfilename, NULL, LOAD_WITH_ALTERED_SEARCH_PATH);
+    handle = LoadLibraryExW(wfilename, NULL, LOAD_WITH_ALTERED_SEARCH_PATH);
 #else
     dlerror(); /* Reset error status. */
-    return dlopen(filename,
+    handle = dlopen(filename,
                   (flags & JL_RTLD_NOW ? RTLD_NOW : RTLD_LAZY)
                   | JL_RTLD(flags, LOCAL)
                   | JL_RTLD(flags, GLOBAL)
@@ -103,16 +106,23 @@ JL_DLLEXPORT void *jl_dlopen(const char *filename, unsigned flags)
 #endif
                   );
 #endif
+    if (handle != NULL) {
+        // the new library can change what any handle resolves, most notably
+        // the cached negative lookups against RTLD_DEFAULT
+        jl_dlsym_cache_flush();
+    }
+    return handle;
 }
 
 JL_DLLEXPORT int jl_dlclose(void *handle)
 {
+    if (!handle)
+        return -1;
+    jl_dlsym_cache_flush(); // drop cached addresses into the closed library
 #ifdef _OS_WINDOWS_
-    if (!handle) return -1;
     return FreeLibrary((HMODULE) handle);
 #else
     dlerror(); /* Reset error status. */
-    if (!handle) return -1;
     return dlclose(handle);
 #endif
 }
@@ -216,14 +226,63 @@ JL_DLLEXPORT void *jl_load_dynamic_library(const char *modname, unsigned flags)
     return jl_load_dynamic_library_(modname, flags, 1);
 }
 
+// --- cached symbol resolution ------------------------------------------------
+// Resolved addresses are remembered per (handle, symbol), including failed
+// lookups: probing an optional symbol repeatedly then costs two hash hits
+// instead of a loader walk, and negative dlsym calls are particularly slow
+// under glibc. Symbol names are interned through jl_symbol so the inner
+// tables can be keyed on pointers. Cached results (notably the negative
+// ones) are only invalidated by loader-state changes, so jl_dlopen and
+// jl_dlclose flush the cache.
+
+static swtable_t dlsym_cache; // handle -> swtable of jl_sym_t* -> address
+static int dlsym_cache_initialized = 0;
+static jl_mutex_t dlsym_cache_lock = {0, 0};
+// sentinel for a cached failed lookup (HT_NOTFOUND means "not cached")
+#define DLSYM_CACHE_MISSING ((void*)(uintptr_t)2)
+
+static void jl_dlsym_cache_flush(void)
+{
+    JL_LOCK_NOGC(&dlsym_cache_lock);
+    if (dlsym_cache_initialized) {
+        // keep the per-handle tables allocated; reused handles simply start
+        // with an empty table again
+        for (size_t i = 0; i < dlsym_cache.size; i += 2) {
+            swtable_t *tab = (swtable_t*)dlsym_cache.table[i + 1];
+            if (tab != HT_NOTFOUND)
+                swtable_reset(tab, 0);
+        }
+    }
+    JL_UNLOCK_NOGC(&dlsym_cache_lock);
+}
+
 JL_DLLEXPORT void *jl_dlsym_e(void *handle, const char *symbol)
 {
+    jl_sym_t *sym = jl_symbol(symbol);
+    JL_LOCK_NOGC(&dlsym_cache_lock);
+    if (!dlsym_cache_initialized) {
+        swtable_new(&dlsym_cache, 0);
+        dlsym_cache_initialized = 1;
+    }
+    swtable_t *tab = (swtable_t*)swptrhash_get(&dlsym_cache, handle);
+    if (tab == (swtable_t*)HT_NOTFOUND) {
+        tab = (swtable_t*)malloc(sizeof(swtable_t));
+        swtable_new(tab, 0);
+        swptrhash_put(&dlsym_cache, handle, tab);
+    }
+    void *ptr = swptrhash_get(tab, (void*)sym);
+    JL_UNLOCK_NOGC(&dlsym_cache_lock);
+    if (ptr != HT_NOTFOUND)
+        return ptr == DLSYM_CACHE_MISSING ? NULL : ptr;
 #ifdef _OS_WINDOWS_
-    void *ptr = GetProcAddress((HMODULE) handle, symbol);
+    ptr = GetProcAddress((HMODULE) handle, symbol);
 #else
     dlerror(); /* Reset error status. */
-    void *ptr = dlsym(handle, symbol);
+    ptr = dlsym(handle, symbol);
 #endif
+    JL_LOCK_NOGC(&dlsym_cache_lock);
+    swptrhash_put(tab, (void*)sym, ptr != NULL ? ptr : DLSYM_CACHE_MISSING);
+    JL_UNLOCK_NOGC(&dlsym_cache_lock);
     return ptr;
 }
 
@@ -29,23 +29,50 @@ extern "C" {
 // TODO: handle finalizers
 
 // hash of definitions for predefined tagged object
-static htable_t ser_tag;
+static swtable_t ser_tag;
 // array of definitions for the predefined tagged object types
 // (reverse of ser_tag)
 static jl_value_t *deser_tag[256];
 // hash of some common symbols, encoded as CommonSym_tag plus 1 byte
-static htable_t common_symbol_tag;
+static swtable_t common_symbol_tag;
 static jl_value_t *deser_symbols[256];
 
+// hash of less common symbols, encoded as CommonSym3_tag plus 2 bytes
+static swtable_t common_symbol3_tag;
+static jl_value_t **deser_symbols3;
+static size_t n_deser_symbols3;
+
+/// symbol frequency profiling (JULIA_SYMTAB_PROFILE=file): count every
+// symbol that crosses the serializer in either direction, and append
+// "count name" lines to the file at exit; gen_sysimg_symtab.jl turns
+// those profiles into the common_symbols*.inc tables above
+static htable_t symtab_profile;
+static int symtab_profile_enabled = 0;
+
+static void profile_symbol(jl_value_t *v)
+{
+    void **bp = ptrhash_bp(&symtab_profile, v);
+    if (*bp == HT_NOTFOUND)
+        *bp = (void*)(intptr_t)1;
+    else
+        *bp = (void*)((intptr_t)*bp + 1);
+}
+
 // table of all objects that have been deserialized, indexed by pos
 // (the order in the serializer stream) in MODE_MODULE, the low
 // bit is reserved for flagging certain entries and pos is
 // left shift by 1
 // (not used in MODE_AST)
-static htable_t backref_table;
+static swtable_t backref_table;
 int backref_table_numel;
 static arraylist_t backref_list;
 
+// content hash -> first string serialized with that spelling; later
+// equal-content strings are aliased onto that string's backref slot so
+// each distinct spelling is written once per image
+// (not used in MODE_AST; reset together with backref_table)
+static swtable_t string_dedup_table;
+
 // list of (jl_value_t **loc, size_t pos) entries
 // for anything that was flagged by the deserializer for later
 // type-rewriting of some sort
@@ -67,7 +94,7 @@ static jl_array_t *serializer_worklist;
 jl_array_t *jl_module_init_order;
 
 // hash of definitions for predefined function pointers
-static htable_t fptr_to_id;
+static swtable_t fptr_to_id;
 // array of definitions for the predefined function pointers
 // (reverse of fptr_to_id)
 static const jl_fptr_t id_to_fptrs[] = {
@@ -91,6 +118,7 @@ static const intptr_t Array1d_tag      = 30;
 static const intptr_t Singleton_tag    = 31;
 static const intptr_t CommonSym_tag    = 32;
 static const intptr_t NearbyGlobal_tag = 33;  // a GlobalRef pointing to tree_enclosing_module
+static const intptr_t CommonSym3_tag   = 34;
 static const intptr_t Null_tag         = 253;
 static const intptr_t ShortBackRef_tag = 254;
 static const intptr_t BackRef_tag      = 255;
@@ -181,7 +209,7 @@ static uint16_t read_uint16(ios_t *s)
 
 static void writetag(ios_t *s, void *v)
 {
-    write_uint8(s, (uint8_t)(intptr_t)ptrhash_get(&ser_tag, v));
+    write_uint8(s, (uint8_t)(intptr_t)swptrhash_get(&ser_tag, v));
 }
 
 static void write_as_tag(ios_t *s, uint8_t tag)
@@ -205,6 +233,12 @@ static jl_value_t *jl_deserialize_value(jl_serializer_state *s, jl_value_t **loc
 static jl_value_t ***sysimg_gvars = NULL;
 static void **sysimg_fvars = NULL;
 
+// set while restoring a system or package image from a copy-on-write file
+// mapping (or decompressed buffer) that stays resident for the life of the
+// process; lets the deserializer alias bulk array data in the stream
+// instead of copying it, so pages that are never touched never leave disk
+static int ji_stream_resident = 0;
+
 #ifdef HAVE_CPUID
 extern void jl_cpuid(int32_t CPUInfo[4], int32_t InfoType);
 #endif
@@ -238,6 +272,14 @@ static int jl_load_sysimg_so(void)
                                                    "jl_ptls_states_getter_idx");
         *sysimg_gvars[tls_getter_idx - 1] =
             (jl_value_t*)jl_get_ptls_states_getter();
+        // a sysimg built with JULIA_SYSIMG_STATIC_TLS addresses the TLS
+        // block of the generating executable directly (see llvm-ptls.cpp);
+        // refuse to run it if our static TLS layout does not match
+        size_t *sysimg_tls_offset = (size_t*)jl_dlsym_e(jl_sysimg_handle,
+                                                        "jl_sysimg_tls_offset");
+        if (sysimg_tls_offset && *sysimg_tls_offset != (size_t)jl_tls_offset)
+            jl_error("Julia and the system image were compiled for different thread-local storage layouts.\n"
+                     "Please delete or regenerate sys.{so,dll,dylib}.");
 #endif
         const char *cpu_target = (const char*)jl_dlsym(jl_sysimg_handle, "jl_sysimg_cpu_target");
         if (strcmp(cpu_target,jl_options.cpu_target) != 0)
@@ -299,8 +341,13 @@ static void jl_serialize_gv(jl_serializer_state *s, jl_value_t *v)
 
 static void jl_serialize_globalvals(jl_serializer_state *s)
 {
-    size_t i, len = backref_table.size;
-    void **p = backref_table.table;
+    size_t i, len;
+    void **p;
+    // the backref table is big enough to rehash incrementally; park no
+    // entries in the old arrays while we walk table[] directly
+    swtable_rehash_finish(&backref_table);
+    len = backref_table.size;
+    p = backref_table.table;
     for(i=0; i < len; i+=2) {
         char *offs = (char*)p[i+1];
         if (offs != HT_NOTFOUND) {
@@ -328,7 +375,7 @@ static void jl_serialize_gv_syms(jl_serializer_state *s, jl_sym_t *v)
 {
     // since symbols are static, they might not have had a
     // reference anywhere in the code image other than here
-    void *bp = ptrhash_get(&backref_table, v);
+    void *bp = swptrhash_get(&backref_table, v);
     if (bp == HT_NOTFOUND) {
         int32_t gv = jl_get_llvm_gv((jl_value_t*)v);
         if (gv != 0) {
@@ -350,7 +397,7 @@ static void jl_serialize_gv_others(jl_serializer_state *s)
     int32_t i;
     for (i = -512; i < 512; i++) {
         jl_value_t *v32 = jl_box_int32(i);
-        void *bp32 = ptrhash_get(&backref_table, v32);
+        void *bp32 = swptrhash_get(&backref_table, v32);
         if (bp32 == HT_NOTFOUND) {
             int32_t gv32 = jl_get_llvm_gv(v32);
             if (gv32 != 0) {
@@ -361,7 +408,7 @@ static void jl_serialize_gv_others(jl_serializer_state *s)
     }
     for (i = -512; i < 512; i++) {
         jl_value_t *v64 = jl_box_int64(i);
-        void *bp64 = ptrhash_get(&backref_table, v64);
+        void *bp64 = swptrhash_get(&backref_table, v64);
         if (bp64 == HT_NOTFOUND) {
             int32_t gv64 = jl_get_llvm_gv(v64);
             if (gv64 != 0) {
@@ -463,7 +510,7 @@ static void jl_update_all_fptrs(void)
 
 static uint16_t jl_fptr_id(void *fptr)
 {
-    void **pbp = ptrhash_bp(&fptr_to_id, fptr);
+    void **pbp = swptrhash_bp(&fptr_to_id, fptr);
     if (*pbp == HT_NOTFOUND || fptr == NULL)
         return 1;
     else
@@ -563,7 +610,7 @@ static void jl_serialize_datatype(jl_serializer_state *s, jl_datatype_t *dt)
         else {
             // this'll need a uid and unique-ing later
             // flag this in the backref table as special
-            uintptr_t *bp = (uintptr_t*)ptrhash_bp(&backref_table, dt);
+            uintptr_t *bp = (uintptr_t*)swptrhash_bp(&backref_table, dt);
             assert(*bp != (uintptr_t)HT_NOTFOUND);
             *bp |= 1;
             tag = 10;
@@ -720,6 +767,31 @@ static int literal_val_id(jl_serializer_state *s, jl_value_t *v)
     return jl_array_len(s->tree_literal_values) - 1;
 }
 
+// Strings are immutable but (unlike symbols) not interned, so equal
+// spellings reach the serializer as distinct objects and the
+// identity-keyed backref table writes every copy in full. Substitute
+// the first string seen with the same bytes before the backref lookup:
+// duplicates then serialize as a 2- or 5-byte backref to the first
+// copy and the deserializer needs no changes -- the copies simply
+// share one object, as interning would give. A hash collision between
+// different spellings just forfeits the dedup for that string.
+// (MODE_AST already gets this through jl_egal in literal_val_id.)
+static jl_value_t *jl_dedup_string(jl_value_t *v)
+{
+    uintptr_t h = memhash(jl_string_data(v), jl_string_len(v));
+    void **bp = swptrhash_bp(&string_dedup_table, (void*)(h | 1));
+    jl_value_t *first = (jl_value_t*)*bp;
+    if (first == (jl_value_t*)HT_NOTFOUND) {
+        *bp = v;
+        return v;
+    }
+    if (first != v &&
+        jl_string_len(first) == jl_string_len(v) &&
+        !memcmp(jl_string_data(first), jl_string_data(v), jl_string_len(v)))
+        return first;
+    return v;
+}
+
 static void jl_serialize_value_(jl_serializer_state *s, jl_value_t *v, int as_literal)
 {
     if (v == NULL) {
@@ -727,18 +799,27 @@ static void jl_serialize_value_(jl_serializer_state *s, jl_value_t *v, int as_li
         return;
     }
 
-    void **bp = ptrhash_bp(&ser_tag, v);
+    if (symtab_profile_enabled && jl_is_symbol(v))
+        profile_symbol(v);
+
+    void **bp = swptrhash_bp(&ser_tag, v);
     if (*bp != HT_NOTFOUND) {
         write_as_tag(s->s, (uint8_t)(intptr_t)*bp);
         return;
     }
     if (jl_is_symbol(v)) {
-        void *idx = ptrhash_get(&common_symbol_tag, v);
+        void *idx = swptrhash_get(&common_symbol_tag, v);
         if (idx != HT_NOTFOUND) {
             writetag(s->s, (jl_value_t*)CommonSym_tag);
             write_uint8(s->s, (uint8_t)(size_t)idx);
             return;
         }
+        idx = swptrhash_get(&common_symbol3_tag, v);
+        if (idx != HT_NOTFOUND) {
+            writetag(s->s, (jl_value_t*)CommonSym3_tag);
+            write_uint16(s->s, (uint16_t)((size_t)idx - 2));
+            return;
+        }
     }
 
     if (s->mode == MODE_AST) {
@@ -752,7 +833,9 @@ static void jl_serialize_value_(jl_serializer_state *s, jl_value_t *v, int as_li
         }
     }
     else {
-        bp = ptrhash_bp(&backref_table, v);
+        if (jl_typeis(v, jl_string_type))
+            v = jl_dedup_string(v);
+        bp = swptrhash_bp(&backref_table, v);
         if (*bp != HT_NOTFOUND) {
             uintptr_t pos = (char*)*bp - (char*)HT_NOTFOUND - 1;
             if (pos < 65536) {
@@ -794,7 +877,7 @@ static void jl_serialize_value_(jl_serializer_state *s, jl_value_t *v, int as_li
         }
         if (s->mode == MODE_MODULE)
             pos <<= 1;
-        ptrhash_put(&backref_table, v, (char*)HT_NOTFOUND + pos + 1);
+        swptrhash_put(&backref_table, v, (char*)HT_NOTFOUND + pos + 1);
     }
 
     size_t i;
@@ -902,7 +985,7 @@ static void jl_serialize_value_(jl_serializer_state *s, jl_value_t *v, int as_li
             internal = module_in_worklist(m->module);
             if (!internal) {
                 // flag this in the backref table as special
-                uintptr_t *bp = (uintptr_t*)ptrhash_bp(&backref_table, v);
+                uintptr_t *bp = (uintptr_t*)swptrhash_bp(&backref_table, v);
                 assert(*bp != (uintptr_t)HT_NOTFOUND);
                 *bp |= 1;
             }
@@ -963,7 +1046,7 @@ static void jl_serialize_value_(jl_serializer_state *s, jl_value_t *v, int as_li
             }
             if (!internal) {
                 // also flag this in the backref table as special
-                uintptr_t *bp = (uintptr_t*)ptrhash_bp(&backref_table, v);
+                uintptr_t *bp = (uintptr_t*)swptrhash_bp(&backref_table, v);
                 assert(*bp != (uintptr_t)HT_NOTFOUND);
                 *bp |= 1;
             }
@@ -1058,7 +1141,7 @@ static void jl_serialize_value_(jl_serializer_state *s, jl_value_t *v, int as_li
                 if (s->mode == MODE_MODULE && !type_in_worklist(t)) {
                     // also flag this in the backref table as special
                     // if it might not be unique (is external)
-                    uintptr_t *bp = (uintptr_t*)ptrhash_bp(&backref_table, v);
+                    uintptr_t *bp = (uintptr_t*)swptrhash_bp(&backref_table, v);
                     assert(*bp != (uintptr_t)HT_NOTFOUND);
                     *bp |= 1;
                 }
@@ -1202,6 +1285,39 @@ static void jl_serialize_methtable_from_mod(jl_serializer_state *s, jl_typename_
     jl_typemap_visitor(tn->mt->defs, jl_serialize_methcache_from_mod, (void*)s);
 }
 
+struct dispatch_cache_closure {
+    jl_serializer_state *s;
+    jl_typename_t *tn;
+};
+
+static int jl_serialize_dispatch_cache_entry(jl_typemap_entry_t *ml, void *closure)
+{
+    struct dispatch_cache_closure *c = (struct dispatch_cache_closure*)closure;
+    jl_value_t *fv = ml->func.value;
+    if (ml->max_world != ~(size_t)0 || fv == NULL || !jl_is_method_instance(fv))
+        return 1;
+    jl_method_instance_t *linfo = (jl_method_instance_t*)fv;
+    if (!linfo->def || !module_in_worklist(linfo->def->module))
+        return 1;
+    // pack the components of the entry so the restore side can re-insert it
+    // through jl_method_table_insert_cached with a fresh world age
+    jl_svec_t *rec = jl_svec(4, (jl_value_t*)ml->sig,
+                             ml->simplesig ? (jl_value_t*)ml->simplesig : jl_nothing,
+                             (jl_value_t*)ml->guardsigs,
+                             (jl_value_t*)linfo);
+    jl_serialize_value(c->s, (jl_value_t*)rec);
+    jl_serialize_value(c->s, (jl_value_t*)c->tn);
+    return 1;
+}
+
+// serialize the populated dispatch-cache entries that this worklist added to
+// an external method table, so the next process can start with warm caches
+static void jl_serialize_dispatch_cache_from_mod(jl_serializer_state *s, jl_typename_t *tn)
+{
+    struct dispatch_cache_closure closure = { s, tn };
+    jl_typemap_visitor(tn->mt->cache, jl_serialize_dispatch_cache_entry, (void*)&closure);
+}
+
 static void jl_serialize_lambdas_from_mod(jl_serializer_state *s, jl_module_t *m)
 {
     if (module_in_worklist(m))
@@ -1222,6 +1338,7 @@ static void jl_serialize_lambdas_from_mod(jl_serializer_state *s, jl_module_t *m
                                 (mt != jl_type_type_mt || tn == jl_type_typename)) {
                             jl_serialize_methtable_from_mod(s, tn);
                             jl_serialize_missing_backedges_to_mod(s, mt);
+                            jl_serialize_dispatch_cache_from_mod(s, tn);
                         }
                     }
                 }
@@ -1499,6 +1616,8 @@ static jl_value_t *jl_deserialize_value(jl_serializer_state *s, jl_value_t **loc
         tag = read_uint8(s->s);
         jl_value_t *v = deser_tag[tag];
         assert(v != NULL);
+        if (symtab_profile_enabled && jl_is_symbol(v))
+            profile_symbol(v);
         return v;
     }
     if (tag == BackRef_tag || tag == ShortBackRef_tag) {
@@ -1523,6 +1642,8 @@ static jl_value_t *jl_deserialize_value(jl_serializer_state *s, jl_value_t **loc
 
     jl_value_t *vtag = deser_tag[tag];
     if (tag >= VALUE_TAGS) {
+        if (symtab_profile_enabled && jl_is_symbol(vtag))
+            profile_symbol(vtag);
         return vtag;
     }
     else if (vtag == (jl_value_t*)LiteralVal_tag) {
@@ -1564,6 +1685,8 @@ static jl_value_t *jl_deserialize_value_symbol(jl_serializer_state *s, jl_value_
     jl_value_t *sym = (jl_value_t*)jl_symbol(name);
     if (len >= 256)
         free(name);
+    if (symtab_profile_enabled)
+        profile_symbol(sym);
     if (usetable)
         arraylist_push(&backref_list, sym);
     return sym;
@@ -1593,12 +1716,34 @@ static jl_value_t *jl_deserialize_value_array(jl_serializer_state *s, jl_value_t
     for (i = 0; i < ndims; i++) {
         dims[i] = jl_unbox_long(jl_deserialize_value(s, NULL));
     }
-    jl_array_t *a = jl_new_array_for_deserialization((jl_value_t*)NULL, ndims, dims, isunboxed, elsize);
+    jl_array_t *a = NULL;
+    int aliased = 0;
+    if (ji_stream_resident &&
+            (s->mode == MODE_SYSTEM_IMAGE || s->mode == MODE_MODULE) &&
+            isunboxed && elsize > 1) { // elsize == 1 needs its writable NUL byte
+        size_t nel = 1, tot;
+        for (i = 0; i < ndims; i++)
+            nel *= dims[i];
+        tot = nel * elsize;
+        // alias large payloads in the mapping: the pages stay file-backed
+        // (copy-on-write) and are only faulted in if the array is touched
+        if (tot >= 512 && ios_readprep(s->s, tot) >= tot) {
+            a = jl_map_array_for_deserialization(ndims, dims, elsize,
+                                                 s->s->buf + s->s->bpos);
+            ios_skip(s->s, tot);
+            aliased = 1;
+        }
+    }
+    if (!a)
+        a = jl_new_array_for_deserialization((jl_value_t*)NULL, ndims, dims, isunboxed, elsize);
     if (usetable)
         backref_list.items[pos] = a;
     jl_value_t *aty = jl_deserialize_value(s, &jl_astaggedvalue(a)->type);
     jl_set_typeof(a, aty);
-    if (!a->flags.ptrarray) {
+    if (aliased) {
+        // data already points into the mapping
+    }
+    else if (!a->flags.ptrarray) {
         size_t tot = jl_array_len(a) * a->elsize;
         ios_read(s->s, (char*)jl_array_data(a), tot);
     }
@@ -1831,7 +1976,7 @@ static jl_value_t *jl_deserialize_value_module(jl_serializer_state *s)
     }
     size_t i = m->usings.len;
     size_t ni = read_int32(s->s);
-    arraylist_grow(&m->usings, ni);
+    small_arraylist_grow(&m->usings, ni);
     ni += i;
     while (i < ni) {
         m->usings.items[i] = jl_deserialize_value(s, (jl_value_t**)&m->usings.items[i]);
@@ -1993,7 +2138,16 @@ static jl_value_t *jl_deserialize_value_(jl_serializer_state *s, jl_value_t *vta
         return jl_deserialize_value_svec(s, vtag);
     }
     else if (vtag == (jl_value_t*)CommonSym_tag) {
-        return deser_symbols[read_uint8(s->s)];
+        jl_value_t *sym = deser_symbols[read_uint8(s->s)];
+        if (symtab_profile_enabled)
+            profile_symbol(sym);
+        return sym;
+    }
+    else if (vtag == (jl_value_t*)CommonSym3_tag) {
+        jl_value_t *sym = deser_symbols3[read_uint16(s->s)];
+        if (symtab_profile_enabled)
+            profile_symbol(sym);
+        return sym;
     }
     else if (vtag == (jl_value_t*)jl_symbol_type ||
              vtag == (jl_value_t*)LongSymbol_tag) {
@@ -2120,6 +2274,15 @@ static void jl_deserialize_methods_from_mod(jl_serializer_state *s, linkedlist_t
 
 static void jl_insert_methods(linkedlist_t *list)
 {
+    // batch consecutive definitions that target the same method table so
+    // gf.c runs its ambiguity analysis and invalidation once over each
+    // batch instead of once per method; a generic function's methods are
+    // serialized together, so these runs are long for method-heavy
+    // packages
+    arraylist_t meths, stypes;
+    arraylist_new(&meths, 0);
+    arraylist_new(&stypes, 0);
+    jl_methtable_t *mt = NULL;
     while (list) {
         size_t i;
         for (i = 0; i < list->count; i++) {
@@ -2127,11 +2290,24 @@ static void jl_insert_methods(linkedlist_t *list)
                 jl_method_t *meth = list->def[i].meth;
                 jl_datatype_t *gf = jl_first_argument_datatype((jl_value_t*)meth->sig);
                 assert(jl_is_datatype(gf) && gf->name->mt);
-                jl_method_table_insert(gf->name->mt, meth, list->def[i].simpletype);
+                if (gf->name->mt != mt && meths.len > 0) {
+                    jl_method_table_insert_batch(mt, (jl_method_t**)meths.items,
+                                                 (jl_tupletype_t**)stypes.items, meths.len);
+                    meths.len = 0;
+                    stypes.len = 0;
+                }
+                mt = gf->name->mt;
+                arraylist_push(&meths, meth);
+                arraylist_push(&stypes, list->def[i].simpletype);
             }
         }
         list = list->next;
     }
+    if (meths.len > 0)
+        jl_method_table_insert_batch(mt, (jl_method_t**)meths.items,
+                                     (jl_tupletype_t**)stypes.items, meths.len);
+    arraylist_free(&meths);
+    arraylist_free(&stypes);
 }
 
 static void jl_insert_backedges(linkedlist_t *list)
@@ -2139,7 +2315,7 @@ static void jl_insert_backedges(linkedlist_t *list)
     while (list) {
         size_t i;
         for (i = 0; i < list->count; i++) {
-            if (!jl_is_method(list->def[i].meth)) {
+            if (!jl_is_method(list->def[i].meth) && !jl_is_svec((jl_value_t*)list->def[i].meth)) {
                 jl_method_instance_t *caller = list->def[i].caller;
                 assert(jl_is_method_instance(caller));
                 jl_value_t *callee = list->def[i].callee;
@@ -2157,6 +2333,36 @@ static void jl_insert_backedges(linkedlist_t *list)
     }
 }
 
+static void jl_insert_dispatch_cache(linkedlist_t *list)
+{
+    while (list) {
+        size_t i;
+        for (i = 0; i < list->count; i++) {
+            if (jl_is_svec((jl_value_t*)list->def[i].meth)) {
+                jl_svec_t *rec = (jl_svec_t*)list->def[i].meth;
+                jl_typename_t *tn = (jl_typename_t*)list->def[i].simpletype;
+                jl_methtable_t *mt = tn->mt;
+                if (mt == NULL || (jl_value_t*)mt == jl_nothing)
+                    continue;
+                jl_tupletype_t *sig = (jl_tupletype_t*)jl_svecref(rec, 0);
+                jl_value_t *simplesig = jl_svecref(rec, 1);
+                jl_svec_t *guardsigs = (jl_svec_t*)jl_svecref(rec, 2);
+                jl_method_instance_t *linfo = (jl_method_instance_t*)jl_svecref(rec, 3);
+                // drop the entry unless its method is still reachable through
+                // mt in the current world (it may have been replaced since the
+                // cache file was written)
+                if (!linfo->def ||
+                    jl_methtable_lookup(mt, linfo->def->sig, jl_world_counter) != (jl_value_t*)linfo->def)
+                    continue;
+                jl_method_table_insert_cached(mt, sig,
+                        simplesig == jl_nothing ? NULL : (jl_tupletype_t*)simplesig,
+                        guardsigs, linfo, jl_world_counter);
+            }
+        }
+        list = list->next;
+    }
+}
+
 
 static void free_linkedlist(linkedlist_t *list)
 {
@@ -2173,6 +2379,39 @@ static jl_value_t *read_verify_mod_list(ios_t *s)
         return jl_get_exceptionf(jl_errorexception_type,
                 "Main module uuid state is invalid for module deserialization.");
     }
+    // advisory pass: the loop below require()s each missing module in
+    // turn, and on a cold cache every one of those loads stalls opening
+    // its own .ji file. Scan the whole list first and kick off kernel
+    // read-ahead for the cache files of every module that isn't loaded
+    // yet, so their I/O runs while the earlier ones deserialize.
+    {
+        static jl_value_t *prefetch_func = NULL;
+        if (!prefetch_func && jl_base_module)
+            prefetch_func = jl_get_global(jl_base_module,
+                                          jl_symbol("_prefetch_from_cache_path"));
+        int64_t pos = ios_pos(s);
+        size_t len;
+        while ((len = read_int32(s))) {
+            char *name = (char*)alloca(len + 1);
+            ios_read(s, name, len);
+            name[len] = '\0';
+            (void)read_uint64(s); // uuid; checked by the loop below
+            jl_sym_t *sym = jl_symbol(name);
+            if (prefetch_func &&
+                (!jl_binding_resolved_p(jl_main_module, sym) ||
+                 !jl_get_global(jl_main_module, sym))) {
+                jl_value_t *args[2] = {prefetch_func, (jl_value_t*)sym};
+                JL_TRY {
+                    jl_apply(args, 2);
+                }
+                JL_CATCH {
+                    // read-ahead is best effort; the require below will
+                    // surface any real problem with this module
+                }
+            }
+        }
+        ios_seek(s, pos);
+    }
     while (1) {
         size_t len = read_int32(s);
         if (len == 0)
@@ -2246,7 +2485,7 @@ static void jl_finalize_serializer(jl_serializer_state *s)
         l = jl_array_len(jl_module_init_order);
         for (i = 0; i < l; i++) {
             // verify that all these modules were saved
-            assert(ptrhash_get(&backref_table, jl_array_ptr_ref(jl_module_init_order, i)) != HT_NOTFOUND);
+            assert(swptrhash_get(&backref_table, jl_array_ptr_ref(jl_module_init_order, i)) != HT_NOTFOUND);
         }
     }
     jl_serialize_value(s, jl_module_init_order);
@@ -2361,11 +2600,11 @@ static void jl_prune_type_cache(jl_svec_t *cache)
         jl_value_t *ti = jl_svecref(cache, i);
         if (ti == NULL)
             break;
-        if (ptrhash_get(&backref_table, ti) != HT_NOTFOUND || jl_get_llvm_gv(ti) != 0)
+        if (swptrhash_get(&backref_table, ti) != HT_NOTFOUND || jl_get_llvm_gv(ti) != 0)
             jl_svecset(cache, ins++, ti);
         else if (jl_is_datatype(ti)) {
             jl_value_t *singleton = ((jl_datatype_t*)ti)->instance;
-            if (singleton && (ptrhash_get(&backref_table, singleton) != HT_NOTFOUND || jl_get_llvm_gv(singleton) != 0))
+            if (singleton && (swptrhash_get(&backref_table, singleton) != HT_NOTFOUND || jl_get_llvm_gv(singleton) != 0))
                 jl_svecset(cache, ins++, ti);
         }
     }
@@ -2380,7 +2619,8 @@ static void jl_save_system_image_to_stream(ios_t *f)
     jl_gc_collect(0); // incremental (sweep finalizers)
     JL_TIMING(SYSIMG_DUMP);
     int en = jl_gc_enable(0);
-    htable_reset(&backref_table, 250000);
+    swtable_reset(&backref_table, 250000);
+    swtable_reset(&string_dedup_table, 10000);
     arraylist_new(&reinit_list, 0);
     backref_table_numel = 0;
     jl_serializer_state s = {
@@ -2437,12 +2677,160 @@ static void jl_save_system_image_to_stream(ios_t *f)
     write_int32(f, jl_world_counter);
     jl_finalize_serializer(&s); // done with f and s
 
-    htable_reset(&backref_table, 0);
+    swtable_reset(&backref_table, 0);
+    swtable_reset(&string_dedup_table, 0);
     arraylist_free(&reinit_list);
 
     jl_gc_enable(en);
 }
 
+// Optional LZ4 container for .ji images (JULIA_SYSIMG_COMPRESS=1 when
+// saving; restore auto-detects). The serialized stream is cut into
+// fixed-size blocks compressed independently, so restore can hand the
+// blocks to worker threads: a magic word and the raw image size, then
+// per block the raw and compressed lengths followed by the compressed
+// bytes. A block that does not shrink is stored verbatim, signalled by
+// equal lengths.
+#define SYSIMG_LZ4_MAGIC 0x345a4c4au // "JLZ4"
+#define SYSIMG_LZ4_BLOCK (1 << 20)
+
+// container fields are written in host order (the image itself is not
+// endian-portable either) so the decoder can read them in place
+static void sysimg_lz4_write32(ios_t *f, uint32_t v)
+{
+    ios_write(f, (char*)&v, sizeof(v));
+}
+
+static void jl_sysimg_write_lz4(ios_t *f, const char *buf, size_t len)
+{
+    char *cbuf = (char*)malloc(SYSIMG_LZ4_BLOCK);
+    size_t pos = 0;
+    uint64_t rawlen = len;
+    sysimg_lz4_write32(f, SYSIMG_LZ4_MAGIC);
+    ios_write(f, (char*)&rawlen, sizeof(rawlen));
+    while (pos < len) {
+        size_t raw = len - pos < SYSIMG_LZ4_BLOCK ? len - pos : SYSIMG_LZ4_BLOCK;
+        size_t csz = lz4_compress(buf + pos, raw, cbuf, raw - 1);
+        sysimg_lz4_write32(f, (uint32_t)raw);
+        if (csz == 0) {
+            // incompressible; store the block as-is
+            sysimg_lz4_write32(f, (uint32_t)raw);
+            ios_write(f, buf + pos, raw);
+        }
+        else {
+            sysimg_lz4_write32(f, (uint32_t)csz);
+            ios_write(f, cbuf, csz);
+        }
+        pos += raw;
+    }
+    free(cbuf);
+}
+
+typedef struct {
+    const char *src;
+    char *dst;
+    const uint64_t *src_off;
+    const uint64_t *dst_off;
+    const uint32_t *clen;
+    const uint32_t *rlen;
+    size_t nblocks;
+    size_t stride;
+    size_t first;
+    int ok;
+} jl_sysimg_lz4_task_t;
+
+static void jl_sysimg_lz4_worker(void *arg)
+{
+    jl_sysimg_lz4_task_t *t = (jl_sysimg_lz4_task_t*)arg;
+    size_t i;
+    for (i = t->first; i < t->nblocks; i += t->stride) {
+        if (t->clen[i] == t->rlen[i])
+            memcpy(t->dst + t->dst_off[i], t->src + t->src_off[i], t->rlen[i]);
+        else if (lz4_decompress(t->src + t->src_off[i], t->clen[i],
+                                t->dst + t->dst_off[i], t->rlen[i]) != t->rlen[i])
+            t->ok = 0;
+    }
+}
+
+// number of decode threads; blocks are independent so this is just a
+// question of how much of the (memory-bound) copy we want in flight
+#define SYSIMG_LZ4_NTHREADS 4
+
+static char *jl_sysimg_decompress(const char *src, size_t len, size_t *plen)
+{
+    uint64_t rawlen;
+    size_t nmax, nblocks = 0;
+    uint64_t spos = 12, dpos = 0;
+    uint64_t *src_off, *dst_off;
+    uint32_t *clen, *rlen;
+    if (len < 12)
+        jl_error("system image file is truncated");
+    memcpy(&rawlen, src + 4, sizeof(rawlen));
+    nmax = (size_t)(rawlen / SYSIMG_LZ4_BLOCK) + 2;
+    src_off = (uint64_t*)malloc(nmax * sizeof(uint64_t));
+    dst_off = (uint64_t*)malloc(nmax * sizeof(uint64_t));
+    clen = (uint32_t*)malloc(nmax * sizeof(uint32_t));
+    rlen = (uint32_t*)malloc(nmax * sizeof(uint32_t));
+    while (dpos < rawlen) {
+        uint32_t r, c;
+        if (spos + 8 > len || nblocks >= nmax)
+            jl_error("system image file is corrupt");
+        memcpy(&r, src + spos, sizeof(r));
+        memcpy(&c, src + spos + 4, sizeof(c));
+        spos += 8;
+        if (r == 0 || r > SYSIMG_LZ4_BLOCK || c > r ||
+            spos + c > len || dpos + r > rawlen)
+            jl_error("system image file is corrupt");
+        src_off[nblocks] = spos;
+        dst_off[nblocks] = dpos;
+        clen[nblocks] = c;
+        rlen[nblocks] = r;
+        nblocks++;
+        spos += c;
+        dpos += r;
+    }
+    char *img = (char*)malloc((size_t)rawlen);
+    size_t nt = nblocks < SYSIMG_LZ4_NTHREADS ? nblocks : SYSIMG_LZ4_NTHREADS;
+    jl_sysimg_lz4_task_t tasks[SYSIMG_LZ4_NTHREADS];
+    uv_thread_t threads[SYSIMG_LZ4_NTHREADS];
+    size_t i, started = 0;
+    for (i = 0; i < nt; i++) {
+        tasks[i].src = src;
+        tasks[i].dst = img;
+        tasks[i].src_off = src_off;
+        tasks[i].dst_off = dst_off;
+        tasks[i].clen = clen;
+        tasks[i].rlen = rlen;
+        tasks[i].nblocks = nblocks;
+        tasks[i].stride = nt;
+        tasks[i].first = i;
+        tasks[i].ok = 1;
+    }
+    // this thread decodes slice 0; extras run on helpers (and their
+    // slices fall to us if thread creation fails)
+    for (i = 1; i < nt; i++) {
+        if (uv_thread_create(&threads[i], jl_sysimg_lz4_worker, &tasks[i]) != 0)
+            break;
+        started++;
+    }
+    for (; i < nt; i++)
+        jl_sysimg_lz4_worker(&tasks[i]);
+    jl_sysimg_lz4_worker(&tasks[0]);
+    for (i = 1; i <= started; i++)
+        uv_thread_join(&threads[i]);
+    int ok = 1;
+    for (i = 0; i < nt; i++)
+        ok &= tasks[i].ok;
+    free(src_off);
+    free(dst_off);
+    free(clen);
+    free(rlen);
+    if (!ok)
+        jl_error("system image file is corrupt");
+    *plen = (size_t)rawlen;
+    return img;
+}
+
 JL_DLLEXPORT void jl_save_system_image(const char *fname)
 {
     ios_t f;
@@ -2450,7 +2838,18 @@ JL_DLLEXPORT void jl_save_system_image(const char *fname)
         jl_errorf("cannot open system image file \"%s\" for writing", fname);
     }
     JL_SIGATOMIC_BEGIN();
-    jl_save_system_image_to_stream(&f);
+    const char *compress = getenv(SYSIMG_COMPRESS_NAME);
+    if (compress ? atoi(compress) : DEFAULT_SYSIMG_COMPRESS) {
+        // serialize to memory first; blocks need the whole stream
+        ios_t t;
+        ios_mem(&t, 1000000);
+        jl_save_system_image_to_stream(&t);
+        jl_sysimg_write_lz4(&f, t.buf, (size_t)t.size);
+        ios_close(&t);
+    }
+    else {
+        jl_save_system_image_to_stream(&f);
+    }
     ios_close(&f);
     JL_SIGATOMIC_END();
 }
@@ -2567,6 +2966,29 @@ static void jl_restore_system_image_from_stream(ios_t *f)
     jl_update_all_fptrs();
 }
 
+// The sections of the serialized image are not independently decodable:
+// the stream encodes cross-section references as positions in the shared
+// backref list, so the decode itself must stay on one thread. What can run
+// concurrently is the dominant cold-start cost for mmapped images --
+// faulting the file into memory. A helper thread walks the mapping ahead
+// of the decoder so its reads hit resident pages instead of taking demand
+// faults, overlapping disk latency with deserialization work.
+typedef struct {
+    const char *buf;
+    size_t len;
+} jl_sysimg_prefetch_t;
+
+static void jl_sysimg_prefetch_thread(void *arg)
+{
+    jl_sysimg_prefetch_t *pf = (jl_sysimg_prefetch_t*)arg;
+    size_t ps = jl_page_size ? jl_page_size : 4096;
+    volatile char sink = 0;
+    size_t i;
+    for (i = 0; i < pf->len; i += ps)
+        sink += pf->buf[i];
+    (void)sink;
+}
+
 JL_DLLEXPORT void jl_restore_system_image(const char *fname)
 {
     char *dot = (char*) strrchr(fname, '.');
@@ -2582,10 +3004,63 @@ JL_DLLEXPORT void jl_restore_system_image(const char *fname)
     }
     else {
         ios_t f;
-        if (ios_file(&f, fname, 1, 0, 0, 0) == NULL)
+        // mmap the image so deserialization reads straight from the page
+        // cache instead of copying it through the ios buffer
+        // copy-on-write so deserialized arrays can alias the mapping and
+        // mutations dirty private pages instead of faulting
+        if (ios_file_mmap_cow(&f, fname) == NULL)
             jl_errorf("System image file \"%s\" not found.", fname);
+        // LZ4 container? decode it (in parallel, the blocks are
+        // independent) and deserialize from the decompressed image
+        uint32_t magic = 0;
+        if (ios_readall(&f, (char*)&magic, sizeof(magic)) == sizeof(magic) &&
+            magic == SYSIMG_LZ4_MAGIC) {
+            char *cdata = NULL;
+            const char *src = f.buf;
+            size_t len = (size_t)f.size;
+            if (!f.mmapped) {
+                // mmap fell back to a plain file; slurp it instead
+                len = (size_t)ios_seek_end(&f);
+                ios_seek(&f, 0);
+                cdata = (char*)malloc(len);
+                if (ios_readall(&f, cdata, len) != len)
+                    jl_error("system image file is truncated");
+                src = cdata;
+            }
+            size_t rawlen;
+            char *img = jl_sysimg_decompress(src, len, &rawlen);
+            free(cdata);
+            ios_close(&f);
+            ios_t imgf;
+            ios_static_buffer(&imgf, img, rawlen);
+            JL_SIGATOMIC_BEGIN();
+            // the decompressed image is never freed: restored arrays may
+            // alias it, just like the mmapped stream below
+            ji_stream_resident = 1;
+            jl_restore_system_image_from_stream(&imgf);
+            ji_stream_resident = 0;
+            ios_close(&imgf);
+            JL_SIGATOMIC_END();
+            return;
+        }
+        ios_seek(&f, 0);
+        uv_thread_t prefetch;
+        jl_sysimg_prefetch_t pf = { f.buf, (size_t)f.size };
+        int prefetching = f.mmapped &&
+            uv_thread_create(&prefetch, jl_sysimg_prefetch_thread, &pf) == 0;
         JL_SIGATOMIC_BEGIN();
+        ji_stream_resident = f.mmapped;
         jl_restore_system_image_from_stream(&f);
+        ji_stream_resident = 0;
+        if (prefetching)
+            uv_thread_join(&prefetch);
+        if (f.mmapped) {
+            // restored arrays alias the mapping, so it must outlive this
+            // stream: suppress the munmap in ios_close and keep the pages
+            // (still file-backed until written) for the life of the process
+            f.mmapped = 0;
+            f.buf = NULL;
+        }
         ios_close(&f);
         JL_SIGATOMIC_END();
     }
@@ -2794,8 +3269,9 @@ JL_DLLEXPORT int jl_save_incremental(const char *fname, jl_array_t *worklist)
                         // best to keep it early (before any actual initialization)
 
     arraylist_new(&reinit_list, 0);
-    htable_new(&backref_table, 5000);
-    ptrhash_put(&backref_table, jl_main_module, (char*)HT_NOTFOUND + 1);
+    swtable_new(&backref_table, 5000);
+    swtable_reset(&string_dedup_table, 1000);
+    swptrhash_put(&backref_table, jl_main_module, (char*)HT_NOTFOUND + 1);
     backref_table_numel = 1;
     jl_idtable_type = jl_base_module ? jl_get_global(jl_base_module, jl_symbol("ObjectIdDict")) : NULL;
 
@@ -2812,7 +3288,8 @@ JL_DLLEXPORT int jl_save_incremental(const char *fname, jl_array_t *worklist)
     serializer_worklist = NULL;
 
     jl_gc_enable(en);
-    htable_reset(&backref_table, 0);
+    swtable_reset(&backref_table, 0);
+    swtable_reset(&string_dedup_table, 0);
     arraylist_free(&reinit_list);
     ios_close(&f);
 
@@ -3096,6 +3573,7 @@ static jl_value_t *_jl_restore_incremental(ios_t *f)
 
     int en = jl_gc_enable(0);
     ++jl_world_counter; // reserve a world age for the deserialization
+    ji_stream_resident = f->mmapped;
     jl_serializer_state s = {
         f, MODE_MODULE,
         NULL, NULL,
@@ -3121,6 +3599,7 @@ static jl_value_t *_jl_restore_incremental(ios_t *f)
     jl_insert_methods(&external_methods); // hook up methods of external generic functions (needs to be after recache types)
     jl_recache_other(); // make all of the other objects identities correct (needs to be after insert methods)
     jl_insert_backedges(&external_methods); // restore external backedges (needs to be after recache other)
+    jl_insert_dispatch_cache(&external_methods); // re-warm external dispatch caches (needs the methods in place)
     free_linkedlist(external_methods.next);
     serializer_worklist = NULL;
 
@@ -3128,6 +3607,14 @@ static jl_value_t *_jl_restore_incremental(ios_t *f)
     jl_gc_enable(en);
     arraylist_free(&flagref_list);
     arraylist_free(&backref_list);
+    ji_stream_resident = 0;
+    if (f->mmapped) {
+        // restored arrays alias the mapping (see ji_stream_resident), so
+        // suppress the munmap in ios_close and keep the pages for the
+        // life of the process, like the system image path
+        f->mmapped = 0;
+        f->buf = NULL;
+    }
     ios_close(f);
 
     if (tracee_list) {
@@ -3153,7 +3640,9 @@ JL_DLLEXPORT jl_value_t *jl_restore_incremental_from_buf(const char *buf, size_t
 JL_DLLEXPORT jl_value_t *jl_restore_incremental(const char *fname)
 {
     ios_t f;
-    if (ios_file(&f, fname, 1, 0, 0, 0) == NULL) {
+    // map the cache copy-on-write so deserialization reads in place and
+    // bulk array data can alias the mapping instead of being copied
+    if (ios_file_mmap_cow(&f, fname) == NULL) {
         return jl_get_exceptionf(jl_errorexception_type,
             "Cache file \"%s\" not found.\n", fname);
     }
@@ -3165,10 +3654,11 @@ JL_DLLEXPORT jl_value_t *jl_restore_incremental(const char *fname)
 void jl_init_serializer(void)
 {
     jl_ptls_t ptls = jl_get_ptls_states();
-    htable_new(&ser_tag, 0);
-    htable_new(&common_symbol_tag, 0);
-    htable_new(&fptr_to_id, sizeof(id_to_fptrs)/sizeof(*id_to_fptrs));
-    htable_new(&backref_table, 0);
+    swtable_new(&ser_tag, 0);
+    swtable_new(&common_symbol_tag, 0);
+    swtable_new(&fptr_to_id, sizeof(id_to_fptrs)/sizeof(*id_to_fptrs));
+    swtable_new(&backref_table, 0);
+    swtable_new(&string_dedup_table, 0);
 
     void *tags[] = { jl_symbol_type, jl_ssavalue_type, jl_datatype_type, jl_slotnumber_type,
                      jl_simplevector_type, jl_array_type, jl_typedslot_type,
@@ -3178,6 +3668,7 @@ void jl_init_serializer(void)
                      (void*)Int32_tag, (void*)Array1d_tag, (void*)Singleton_tag,
                      jl_module_type, jl_tvar_type, jl_method_instance_type, jl_method_type,
                      (void*)CommonSym_tag, (void*)NearbyGlobal_tag, jl_globalref_type,
+                     (void*)CommonSym3_tag,
                      // everything above here represents a class of object rather than only a literal
 
                      jl_emptysvec, jl_emptytuple, jl_false, jl_true, jl_nothing, jl_any_type,
@@ -3253,29 +3744,53 @@ void jl_init_serializer(void)
         NULL
     };
 
+    // third tier: symbols common enough in profiled workloads to be worth
+    // a 3-byte encoding. empty unless gen_sysimg_symtab.jl has been run
+    // with runtime profiles (see the notes in that script).
+    void *common_symbols3[] = {
+        #include "common_symbols3.inc"
+        NULL
+    };
+
     intptr_t i=2;
     while (tags[i-2] != NULL) {
-        ptrhash_put(&ser_tag, tags[i-2], (void*)i);
+        swptrhash_put(&ser_tag, tags[i-2], (void*)i);
         deser_tag[i] = (jl_value_t*)tags[i-2];
         i += 1;
     }
     assert(i <= Null_tag);
-    VALUE_TAGS = (intptr_t)ptrhash_get(&ser_tag, jl_emptysvec);
+    VALUE_TAGS = (intptr_t)swptrhash_get(&ser_tag, jl_emptysvec);
 
     i=2;
     while (id_to_fptrs[i] != NULL) {
-        ptrhash_put(&fptr_to_id, (void*)id_to_fptrs[i], (void*)i);
+        swptrhash_put(&fptr_to_id, (void*)id_to_fptrs[i], (void*)i);
         i += 1;
     }
 
     i=2;
     while (common_symbols[i-2] != NULL) {
-        ptrhash_put(&common_symbol_tag, common_symbols[i-2], (void*)i);
+        swptrhash_put(&common_symbol_tag, common_symbols[i-2], (void*)i);
         deser_symbols[i] = (jl_value_t*)common_symbols[i-2];
         i += 1;
     }
     assert(i <= 256);
 
+    n_deser_symbols3 = sizeof(common_symbols3)/sizeof(void*) - 1;
+    assert(n_deser_symbols3 <= 65536);
+    swtable_new(&common_symbol3_tag, n_deser_symbols3);
+    deser_symbols3 = (jl_value_t**)malloc(n_deser_symbols3 * sizeof(jl_value_t*));
+    for (i = 0; i < (intptr_t)n_deser_symbols3; i++) {
+        // a tier-2 entry always wins over a stale tier-3 duplicate
+        if (swptrhash_get(&common_symbol_tag, common_symbols3[i]) == HT_NOTFOUND)
+            swptrhash_put(&common_symbol3_tag, common_symbols3[i], (void*)(i + 2));
+        deser_symbols3[i] = (jl_value_t*)common_symbols3[i];
+    }
+
+    if (getenv("JULIA_SYMTAB_PROFILE")) {
+        htable_new(&symtab_profile, 4096);
+        symtab_profile_enabled = 1;
+    }
+
     arraylist_new(&builtin_typenames, 0);
     arraylist_push(&builtin_typenames, jl_array_typename);
     arraylist_push(&builtin_typenames, ((jl_datatype_t*)jl_ref_type->body)->name);
@@ -3287,6 +3802,26 @@ void jl_init_serializer(void)
     arraylist_push(&builtin_typenames, jl_vararg_typename);
 }
 
+// append the collected symbol frequencies ("count name" per line) to the
+// file named by JULIA_SYMTAB_PROFILE; called from jl_atexit_hook
+JL_DLLEXPORT void jl_dump_symtab_profile(void)
+{
+    if (!symtab_profile_enabled)
+        return;
+    ios_t f;
+    if (ios_file(&f, getenv("JULIA_SYMTAB_PROFILE"), 0, 1, 1, 0) == NULL)
+        return;
+    ios_seek_end(&f);
+    size_t i;
+    void **table = symtab_profile.table;
+    for (i = 1; i < symtab_profile.size; i += 2) {
+        if (table[i] != HT_NOTFOUND)
+            ios_printf(&f, "%ld %s\n", (long)(intptr_t)table[i],
+                       jl_symbol_name((jl_sym_t*)table[i-1]));
+    }
+    ios_close(&f);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,410 @@
+/*
+  binary boot images
+
+  fl_load_system_image parses the image as printed text, so every
+  context pays for lexing the whole file and re-interning every symbol
+  occurrence before the parser is usable. The routines here compile
+  that text into a compact binary form once and rebuild the value graph
+  with a linear decode afterwards. The format is position independent:
+  symbols are stored by name on first use and by backreference index
+  after that, builtins by opcode, and shared structure through the same
+  backreference scheme, so a blob written by one process loads in any
+  later process of the same build. Value kinds the format does not
+  model (tables, boxed numbers, gensyms, ...) fall back to their
+  printed text and go through fl_read_sexpr at load time; the system
+  image only contains a handful of those.
+*/
+
+#define BOOT_IMAGE_MAGIC   0x69626c66u // "flbi"
+#define BOOT_IMAGE_VERSION 1
+#define BOOT_IMAGE_HDR_SZ  8
+
+enum {
+    BI_NIL = 0, BI_T, BI_F, BI_FIXNUM, BI_BUILTIN, BI_SYM, BI_CONS,
+    BI_VECTOR, BI_FUNCTION, BI_STRING, BI_TEXT, BI_BACKREF
+};
+
+static void bi_write_uint(ios_t *f, uint64_t n)
+{
+    while (n > 0x7f) {
+        ios_putc((int)(n & 0x7f) | 0x80, f);
+        n >>= 7;
+    }
+    ios_putc((int)n, f);
+}
+
+static void bi_dump_value(fl_context_t *fl_ctx, ios_t *f, value_t v,
+                          htable_t *seen, size_t *nseen, ios_t *scratch)
+{
+    while (1) {
+        if (v == fl_ctx->NIL) {
+            ios_putc(BI_NIL, f);
+            return;
+        }
+        if (v == fl_ctx->T) {
+            ios_putc(BI_T, f);
+            return;
+        }
+        if (v == fl_ctx->F) {
+            ios_putc(BI_F, f);
+            return;
+        }
+        if (isfixnum(v)) {
+            fixnum_t n = numval(v);
+            ios_putc(BI_FIXNUM, f);
+            bi_write_uint(f, ((uint64_t)n << 1) ^
+                             (uint64_t)(n >> (8*sizeof(n)-1)));
+            return;
+        }
+        if (isbuiltin(v)) {
+            ios_putc(BI_BUILTIN, f);
+            bi_write_uint(f, uintval(v));
+            return;
+        }
+        void **bp = ptrhash_bp(seen, (void*)v);
+        if (*bp != HT_NOTFOUND) {
+            ios_putc(BI_BACKREF, f);
+            bi_write_uint(f, (uintptr_t)*bp - 1);
+            return;
+        }
+        *bp = (void*)(uintptr_t)(++(*nseen));
+        if (iscons(v)) {
+            // keep the list spine iterative; toplevel image lists are
+            // far longer than the C stack is deep
+            ios_putc(BI_CONS, f);
+            bi_dump_value(fl_ctx, f, car_(v), seen, nseen, scratch);
+            v = cdr_(v);
+            continue;
+        }
+        if (issymbol(v) && !isgensym(fl_ctx, v)) {
+            char *name = symbol_name(fl_ctx, v);
+            size_t n = strlen(name);
+            ios_putc(BI_SYM, f);
+            bi_write_uint(f, n);
+            ios_write(f, name, n);
+            return;
+        }
+        if (isvector(v)) {
+            size_t i, n = vector_size(v);
+            ios_putc(BI_VECTOR, f);
+            bi_write_uint(f, n);
+            for (i = 0; i < n; i++)
+                bi_dump_value(fl_ctx, f, vector_elt(v, i), seen, nseen,
+                              scratch);
+            return;
+        }
+        if (isclosure(v)) {
+            function_t *fn = (function_t*)ptr(v);
+            ios_putc(BI_FUNCTION, f);
+            bi_dump_value(fl_ctx, f, fn->bcode, seen, nseen, scratch);
+            bi_dump_value(fl_ctx, f, fn->vals, seen, nseen, scratch);
+            bi_dump_value(fl_ctx, f, fn->env, seen, nseen, scratch);
+            bi_dump_value(fl_ctx, f, fn->name, seen, nseen, scratch);
+            return;
+        }
+        if (fl_isstring(fl_ctx, v)) {
+            cvalue_t *cv = (cvalue_t*)ptr(v);
+            ios_putc(BI_STRING, f);
+            bi_write_uint(f, cv_len(cv));
+            ios_write(f, (char*)cv_data(cv), cv_len(cv));
+            return;
+        }
+        // no binary form: embed the printed text and re-read it at
+        // load time. fl_print does not allocate from the lisp heap, so
+        // the address-keyed seen table stays valid across it.
+        ios_seek(scratch, 0);
+        fl_print(fl_ctx, scratch, v);
+        ios_putc(BI_TEXT, f);
+        bi_write_uint(f, (size_t)scratch->bpos);
+        ios_write(f, scratch->buf, (size_t)scratch->bpos);
+        return;
+    }
+}
+
+int fl_dump_system_image_bin(fl_context_t *fl_ctx, ios_t *out,
+                             char *str, size_t len)
+{
+    uint32_t magic = BOOT_IMAGE_MAGIC;
+    uint16_t nops = (uint16_t)N_OPCODES;
+    htable_t seen;
+    ios_t scratch;
+    value_t img, saver, savep;
+    int err = 0;
+
+    ios_write(out, (char*)&magic, 4);
+    ios_putc(BOOT_IMAGE_VERSION, out);
+    ios_putc((int)sizeof(value_t), out);
+    ios_write(out, (char*)&nops, 2);
+
+    img = cvalue(fl_ctx, fl_ctx->iostreamtype, sizeof(ios_t));
+    ios_static_buffer(value2c(ios_t*, img), str, len);
+    fl_gc_handle(fl_ctx, &img);
+
+    saver = symbol_value(fl_ctx->printreadablysym);
+    savep = symbol_value(fl_ctx->printprettysym);
+    set(fl_ctx->printreadablysym, fl_ctx->T);
+    set(fl_ctx->printprettysym, fl_ctx->F);
+
+    htable_new(&seen, 2048);
+    ios_mem(&scratch, 256);
+    FL_TRY(fl_ctx) {
+        while (1) {
+            value_t e = fl_read_sexpr(fl_ctx, img);
+            if (ios_eof(value2c(ios_t*, img)))
+                break;
+            // backreference indexes restart at every toplevel value:
+            // the reads in between can run the collector and move
+            // objects, which would invalidate the address-keyed table
+            htable_reset(&seen, 2048);
+            size_t nseen = 0;
+            bi_dump_value(fl_ctx, out, e, &seen, &nseen, &scratch);
+        }
+    }
+    FL_CATCH(fl_ctx) {
+        err = 1;
+    }
+    ios_close(&scratch);
+    htable_free(&seen);
+    set(fl_ctx->printreadablysym, saver);
+    set(fl_ctx->printprettysym, savep);
+    ios_close(value2c(ios_t*, img));
+    fl_free_gc_handles(fl_ctx, 1);
+    return err;
+}
+
+typedef struct {
+    ios_t *f;
+    value_t brefs; // vector of backref targets (gc-rooted by the loader)
+    size_t nbrefs;
+} bi_reader_t;
+
+static int bi_getc(fl_context_t *fl_ctx, bi_reader_t *st)
+{
+    int c = ios_getc(st->f);
+    if (c == IOS_EOF)
+        lerror(fl_ctx, fl_ctx->IOError, "boot image: truncated");
+    return c;
+}
+
+static uint64_t bi_read_uint(fl_context_t *fl_ctx, bi_reader_t *st)
+{
+    uint64_t n = 0;
+    int c, shift = 0;
+    do {
+        if (shift > 63)
+            lerror(fl_ctx, fl_ctx->IOError, "boot image: bad varint");
+        c = bi_getc(fl_ctx, st);
+        n |= (uint64_t)(c & 0x7f) << shift;
+        shift += 7;
+    } while (c & 0x80);
+    return n;
+}
+
+static size_t bi_register(fl_context_t *fl_ctx, bi_reader_t *st, value_t v)
+{
+    if (st->brefs == fl_ctx->NIL || st->nbrefs == vector_size(st->brefs)) {
+        size_t i, n = (st->brefs == fl_ctx->NIL) ? 0 : vector_size(st->brefs);
+        value_t nv;
+        fl_gc_handle(fl_ctx, &v);
+        nv = alloc_vector(fl_ctx, n ? n * 2 : 512, 1);
+        fl_free_gc_handles(fl_ctx, 1);
+        for (i = 0; i < n; i++)
+            vector_elt(nv, i) = vector_elt(st->brefs, i);
+        st->brefs = nv;
+    }
+    vector_elt(st->brefs, st->nbrefs) = v;
+    return st->nbrefs++;
+}
+
+static value_t bi_read_value(fl_context_t *fl_ctx, bi_reader_t *st);
+
+static value_t bi_read_tagged(fl_context_t *fl_ctx, bi_reader_t *st, int tag)
+{
+    switch (tag) {
+    case BI_NIL: return fl_ctx->NIL;
+    case BI_T:   return fl_ctx->T;
+    case BI_F:   return fl_ctx->F;
+    case BI_FIXNUM: {
+        uint64_t z = bi_read_uint(fl_ctx, st);
+        return fixnum((fixnum_t)(z >> 1) ^ -(fixnum_t)(z & 1));
+    }
+    case BI_BUILTIN: {
+        uint64_t n = bi_read_uint(fl_ctx, st);
+        if (n > OP_ASET)
+            lerror(fl_ctx, fl_ctx->IOError, "boot image: bad builtin");
+        return builtin(n);
+    }
+    case BI_BACKREF: {
+        uint64_t n = bi_read_uint(fl_ctx, st);
+        if (n >= st->nbrefs)
+            lerror(fl_ctx, fl_ctx->IOError, "boot image: bad backref");
+        return vector_elt(st->brefs, n);
+    }
+    case BI_SYM: {
+        char buf[256], *name = buf;
+        size_t n = bi_read_uint(fl_ctx, st);
+        value_t v;
+        if (n + 1 > sizeof(buf))
+            name = (char*)malloc(n + 1);
+        if (name == NULL || ios_read(st->f, name, n) != n) {
+            if (name != buf)
+                free(name);
+            lerror(fl_ctx, fl_ctx->IOError, "boot image: truncated");
+        }
+        name[n] = '\0';
+        v = symbol(fl_ctx, name);
+        if (name != buf)
+            free(name);
+        bi_register(fl_ctx, st, v);
+        return v;
+    }
+    case BI_CONS: {
+        // rebuild the list spine iteratively, mirroring the dumper.
+        // conses move when a child decode collects, so always reload
+        // them from the rooted backref vector.
+        size_t first = bi_register(fl_ctx, st,
+                                   fl_cons(fl_ctx, fl_ctx->NIL, fl_ctx->NIL));
+        size_t idx = first;
+        while (1) {
+            value_t c = bi_read_value(fl_ctx, st);
+            car_(vector_elt(st->brefs, idx)) = c;
+            tag = bi_getc(fl_ctx, st);
+            if (tag != BI_CONS) {
+                c = bi_read_tagged(fl_ctx, st, tag);
+                cdr_(vector_elt(st->brefs, idx)) = c;
+                break;
+            }
+            size_t nxt = bi_register(fl_ctx, st,
+                                     fl_cons(fl_ctx, fl_ctx->NIL,
+                                             fl_ctx->NIL));
+            cdr_(vector_elt(st->brefs, idx)) = vector_elt(st->brefs, nxt);
+            idx = nxt;
+        }
+        return vector_elt(st->brefs, first);
+    }
+    case BI_VECTOR: {
+        size_t i, n = bi_read_uint(fl_ctx, st);
+        size_t idx = bi_register(fl_ctx, st, alloc_vector(fl_ctx, n, 1));
+        for (i = 0; i < n; i++) {
+            value_t c = bi_read_value(fl_ctx, st);
+            vector_elt(vector_elt(st->brefs, idx), i) = c;
+        }
+        return vector_elt(st->brefs, idx);
+    }
+    case BI_FUNCTION: {
+        function_t *fn = (function_t*)alloc_words(fl_ctx, 4);
+        size_t idx;
+        value_t c, fv;
+        fn->bcode = fn->vals = fn->env = fn->name = fl_ctx->NIL;
+        idx = bi_register(fl_ctx, st, tagptr(fn, TAG_FUNCTION));
+        c = bi_read_value(fl_ctx, st);
+        ((function_t*)ptr(vector_elt(st->brefs, idx)))->bcode = c;
+        c = bi_read_value(fl_ctx, st);
+        ((function_t*)ptr(vector_elt(st->brefs, idx)))->vals = c;
+        c = bi_read_value(fl_ctx, st);
+        ((function_t*)ptr(vector_elt(st->brefs, idx)))->env = c;
+        c = bi_read_value(fl_ctx, st);
+        ((function_t*)ptr(vector_elt(st->brefs, idx)))->name = c;
+        fv = vector_elt(st->brefs, idx);
+        fn = (function_t*)ptr(fv);
+        if (!fl_isstring(fl_ctx, fn->bcode) || !isvector(fn->vals))
+            lerror(fl_ctx, fl_ctx->IOError, "boot image: bad function");
+        // the dumped bytecode already has its opcodes normalized and
+        // maxstack filled in by fl_function; only the pin is redone
+        cv_pin(fl_ctx, (cvalue_t*)ptr(fn->bcode));
+        return fv;
+    }
+    case BI_STRING: {
+        size_t n = bi_read_uint(fl_ctx, st);
+        size_t idx = bi_register(fl_ctx, st, cvalue_string(fl_ctx, n));
+        value_t v = vector_elt(st->brefs, idx);
+        if (ios_read(st->f, (char*)cv_data((cvalue_t*)ptr(v)), n) != n)
+            lerror(fl_ctx, fl_ctx->IOError, "boot image: truncated");
+        return v;
+    }
+    case BI_TEXT: {
+        size_t n = bi_read_uint(fl_ctx, st);
+        size_t idx = bi_register(fl_ctx, st, fl_ctx->NIL);
+        value_t img, v;
+        if (st->f->bpos + n > st->f->size)
+            lerror(fl_ctx, fl_ctx->IOError, "boot image: truncated");
+        img = cvalue(fl_ctx, fl_ctx->iostreamtype, sizeof(ios_t));
+        ios_static_buffer(value2c(ios_t*, img),
+                          st->f->buf + st->f->bpos, n);
+        fl_gc_handle(fl_ctx, &img);
+        v = fl_read_sexpr(fl_ctx, img);
+        fl_free_gc_handles(fl_ctx, 1);
+        ios_skip(st->f, (int64_t)n);
+        vector_elt(st->brefs, idx) = v;
+        return v;
+    }
+    default:
+        lerror(fl_ctx, fl_ctx->IOError, "boot image: bad tag");
+    }
+}
+
+static value_t bi_read_value(fl_context_t *fl_ctx, bi_reader_t *st)
+{
+    return bi_read_tagged(fl_ctx, st, bi_getc(fl_ctx, st));
+}
+
+// binary counterpart of fl_load_system_image_str; returns nonzero if
+// the blob is not a loadable image for this build (callers fall back
+// to the text image)
+int fl_load_system_image_bin(fl_context_t *fl_ctx, char *str, size_t len)
+{
+    bi_reader_t st;
+    symbol_t *sym;
+    uint32_t magic;
+    uint16_t nops;
+    ios_t f;
+    int saveSP;
+
+    if (len < BOOT_IMAGE_HDR_SZ)
+        return 1;
+    memcpy(&magic, str, 4);
+    memcpy(&nops, str + 6, 2);
+    if (magic != BOOT_IMAGE_MAGIC || str[4] != BOOT_IMAGE_VERSION ||
+        str[5] != (char)sizeof(value_t) || nops != (uint16_t)N_OPCODES)
+        return 1;
+
+    ios_static_buffer(&f, str + BOOT_IMAGE_HDR_SZ, len - BOOT_IMAGE_HDR_SZ);
+    st.f = &f;
+    st.brefs = fl_ctx->NIL;
+    st.nbrefs = 0;
+    fl_gc_handle(fl_ctx, &st.brefs);
+    saveSP = fl_ctx->SP;
+    FL_TRY(fl_ctx) {
+        while (!ios_eof(&f)) {
+            st.nbrefs = 0; // fresh backref space per toplevel value
+            value_t e = bi_read_value(fl_ctx, &st);
+            if (isfunction(e)) {
+                // stage 0 format: series of thunks
+                PUSH(fl_ctx, e);
+                (void)_applyn(fl_ctx, 0);
+                fl_ctx->SP = saveSP;
+            }
+            else {
+                // stage 1 format: list alternating symbol/value
+                while (iscons(e)) {
+                    sym = tosymbol(fl_ctx, car_(e), "bootstrap");
+                    e = cdr_(e);
+                    (void)tocons(fl_ctx, e, "bootstrap");
+                    sym->binding = car_(e);
+                    e = cdr_(e);
+                }
+                break;
+            }
+        }
+    }
+    FL_CATCH(fl_ctx) {
+        fl_free_gc_handles(fl_ctx, 1);
+        ios_puts("fatal error loading boot image:\n", ios_stderr);
+        fl_print(fl_ctx, ios_stderr, fl_ctx->lasterror);
+        ios_putc('\n', ios_stderr);
+        return 1;
+    }
+    fl_free_gc_handles(fl_ctx, 1);
+    ios_close(&f);
+    return 0;
+}
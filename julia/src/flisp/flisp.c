@@ -811,6 +811,10 @@ int fl_isnumber(fl_context_t *fl_ctx, value_t v)
 
 #include "equal.c"
 
+// boot image -----------------------------------------------------------------
+
+#include "bootimage.c"
+
 // eval -----------------------------------------------------------------------
 
 #define list(fl_ctx, a,n) _list(fl_ctx, (a), (n), 0)
@@ -374,6 +374,9 @@ value_t cvalue_wchar(fl_context_t *fl_ctx, value_t *args, uint32_t nargs);
 void fl_init(fl_context_t *fl_ctx, size_t initial_heapsize);
 int fl_load_system_image(fl_context_t *fl_ctx, value_t ios);
 int fl_load_system_image_str(fl_context_t *fl_ctx, char* str, size_t len);
+// compile the text image to / boot from the binary format (bootimage.c)
+int fl_dump_system_image_bin(fl_context_t *fl_ctx, ios_t *out, char *str, size_t len);
+int fl_load_system_image_bin(fl_context_t *fl_ctx, char *str, size_t len);
 
 /* julia extensions */
 JL_DLLEXPORT int jl_id_char(uint32_t wc);
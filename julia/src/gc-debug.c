@@ -134,7 +134,7 @@ static void clear_mark(int bits)
             if (line) {
                 for (int j = 0; j < 32; j++) {
                     if ((line >> j) & 1) {
-                        jl_gc_pagemeta_t *pg = page_metadata(region->pages[pg_i*32 + j].data + GC_PAGE_OFFSET);
+                        jl_gc_pagemeta_cold_t *pg = page_metadata_cold(region->pages[pg_i*32 + j].data + GC_PAGE_OFFSET);
                         jl_ptls_t ptls2 = jl_all_tls_states[pg->thread_n];
                         jl_gc_pool_t *pool = &ptls2->heap.norm_pools[pg->pool_n];
                         pv = (jl_taggedvalue_t*)(pg->data + GC_PAGE_OFFSET);
@@ -270,7 +270,7 @@ void gc_verify_tags(void)
                     assert(pg->osize == p->osize);
                     if (gc_page_data(next) != allocating) {
                         // when not currently allocating on this page, fl_begin_offset should be correct
-                        assert(next == page_pfl_beg(pg));
+                        assert(next == page_pfl_beg(gc_page_data(next), pg));
                     }
                 }
                 last = next;
@@ -293,12 +293,13 @@ void gc_verify_tags(void)
                     if ((line >> j) & 1) {
                         // for all pages in use
                         jl_gc_pagemeta_t *pg = &region->meta[pg_i*32 + j];
-                        int p_n = pg->pool_n;
-                        int t_n = pg->thread_n;
+                        jl_gc_pagemeta_cold_t *pgcold = &region->meta_cold[pg_i*32 + j];
+                        int p_n = pgcold->pool_n;
+                        int t_n = pgcold->thread_n;
                         jl_ptls_t ptls2 = jl_all_tls_states[t_n];
                         jl_gc_pool_t *p = &ptls2->heap.norm_pools[p_n];
                         int osize = pg->osize;
-                        char *data = pg->data;
+                        char *data = pgcold->data;
                         char *page_begin = data + GC_PAGE_OFFSET;
                         jl_taggedvalue_t *v = (jl_taggedvalue_t*)page_begin;
                         char *lim = data + GC_PAGE_SZ - osize;
@@ -326,9 +327,9 @@ void gc_verify_tags(void)
                                 assert(page_metadata(next)->osize == osize);
                                 freelist_zerod = 0;
                             }
-                            else if (pg->fl_begin_offset != (uint16_t)-1) {
+                            else if (pg->fl_begin_offset != (jl_gc_pgoff_t)-1) {
                                 // part of free list exists on this page
-                                next = page_pfl_beg(pg);
+                                next = page_pfl_beg(data, pg);
                                 freelist_zerod = 0;
                             }
                             assert(halfpages || next);
@@ -547,6 +548,89 @@ void gc_debug_print_status(void)
 }
 #endif
 
+// deterministic GC-trigger record/replay
+//
+// JULIA_GC_RECORD=<file> logs the cumulative allocation count at every
+// collection to <file>, one decimal number per line. JULIA_GC_REPLAY=<file>
+// loads such a file and forces collections at exactly those counts while
+// suppressing the pacing heuristic in maybe_collect, so a production
+// run's collection timing can be reproduced in the lab. The counters
+// piggyback on the pacing counter (gc_num.allocd), so recording costs
+// nothing on the allocation path and one buffered write per collection.
+// Windows where the GC is disabled move allocations into
+// deferred_alloc and can make the two runs drift; keep them out of
+// runs meant to be replayed.
+
+int gc_replay_active = 0;
+static FILE *gc_record_stream = NULL;
+static uint64_t *gc_replay_triggers = NULL;
+static size_t gc_replay_len = 0;
+static size_t gc_replay_next = 0;
+// allocation bytes retired by past collection epochs; the live epoch
+// contributes gc_num.interval + gc_num.allocd on top of this
+static uint64_t gc_replay_retired = 0;
+
+void gc_record_replay_init(void)
+{
+    char *env = getenv("JULIA_GC_RECORD");
+    if (env && *env) {
+        gc_record_stream = fopen(env, "w");
+        if (!gc_record_stream)
+            jl_safe_printf("GC record: cannot open %s\n", env);
+    }
+    env = getenv("JULIA_GC_REPLAY");
+    if (!env || !*env)
+        return;
+    FILE *f = fopen(env, "r");
+    if (!f) {
+        jl_safe_printf("GC replay: cannot open %s\n", env);
+        return;
+    }
+    size_t cap = 1024;
+    gc_replay_triggers = (uint64_t*)malloc(cap * sizeof(uint64_t));
+    unsigned long long v;
+    while (gc_replay_triggers && fscanf(f, "%llu", &v) == 1) {
+        if (gc_replay_len == cap) {
+            cap *= 2;
+            gc_replay_triggers =
+                (uint64_t*)realloc(gc_replay_triggers, cap * sizeof(uint64_t));
+            if (!gc_replay_triggers)
+                break;
+        }
+        gc_replay_triggers[gc_replay_len++] = v;
+    }
+    fclose(f);
+    gc_replay_active = gc_replay_triggers && gc_replay_len > 0;
+}
+
+// cumulative allocation count, comparable between the recording and
+// the replaying run
+static uint64_t gc_replay_now(void)
+{
+    return gc_replay_retired +
+        (uint64_t)(gc_num.allocd + (int64_t)gc_num.interval);
+}
+
+int gc_replay_should_collect(void)
+{
+    return gc_replay_next < gc_replay_len &&
+        gc_replay_now() >= gc_replay_triggers[gc_replay_next];
+}
+
+// called on entry to jl_gc_collect, before the pacing counter is re-armed
+void gc_record_note_collect(void)
+{
+    uint64_t now = gc_replay_now();
+    if (gc_record_stream) {
+        fprintf(gc_record_stream, "%" PRIu64 "\n", now);
+        fflush(gc_record_stream);
+    }
+    if (gc_replay_active && gc_replay_next < gc_replay_len &&
+        now >= gc_replay_triggers[gc_replay_next])
+        gc_replay_next++;
+    gc_replay_retired = now;
+}
+
 #ifdef OBJPROFILE
 static htable_t obj_counts[3];
 static htable_t obj_sizes[3];
@@ -813,10 +897,9 @@ void gc_time_mark_pause(int64_t t0, int64_t scanned_bytes,
 {
     int64_t last_remset_len = 0;
     int64_t remset_nptr = 0;
-    for (int t_i = 0;t_i < jl_n_threads;t_i++) {
-        jl_ptls_t ptls2 = jl_all_tls_states[t_i];
-        last_remset_len += neptune_last_remset_len(ptls2);
-        remset_nptr = neptune_remset_nptr(ptls2);
+    for (int t_i = 0;t_i < (int)jl_gc_stats->nthreads;t_i++) {
+        last_remset_len += jl_gc_stats->tl[t_i].last_remset_len;
+        remset_nptr += jl_gc_stats->tl[t_i].remset_nptr;
     }
     jl_printf(JL_STDOUT, "GC mark pause %.2f ms | "
               "scanned %" PRId64 " kB = %" PRId64 " + %" PRId64 " | "
@@ -847,6 +930,7 @@ void gc_time_sweep_pause(uint64_t gc_end_t, int64_t actual_allocd,
 
 void gc_debug_init(void)
 {
+    gc_record_replay_init();
 #ifdef GC_DEBUG_ENV
     char *env = getenv("JULIA_GC_NO_GENERATIONAL");
     if (env && strcmp(env, "0") != 0)
@@ -881,35 +965,44 @@ void gc_debug_init(void)
 // GC summary stats
 
 #ifdef MEMPROFILE
-// TODO repair this and possibly merge with `gc_count_pool`
-static size_t pool_stats(jl_gc_pool_t *p, size_t *pwaste, size_t *np,
-                         size_t *pnold)
+// TODO: possibly merge with `gc_count_pool`
+// the pools no longer keep a page list, so find this pool's pages by
+// walking the regions and matching the owner ids in the cold metadata
+static size_t pool_stats(int t_n, int p_n, jl_gc_pool_t *p,
+                         size_t *pwaste, size_t *np, size_t *pnold)
 {
     jl_taggedvalue_t *v;
-    jl_gc_pagemeta_t *pg = p->pages;
     size_t osize = p->osize;
     size_t nused=0, nfree=0, npgs=0, nold = 0;
 
-    while (pg != NULL) {
-        npgs++;
-        v = (jl_taggedvalue_t*)(pg->data + GC_PAGE_OFFSET);
-        char *lim = (char*)v + GC_PAGE_SZ - GC_PAGE_OFFSET - osize;
-        int i = 0;
-        while ((char*)v <= lim) {
-            if (!gc_marked(v->bits.gc)) {
-                nfree++;
-            }
-            else {
-                nused++;
-                if (v->bits.gc == GC_OLD_MARKED) {
-                    nold++;
+    for (int region_i = 0; region_i < REGION_COUNT; region_i++) {
+        region_t *region = neptune_get_region(region_i);
+        uint32_t pg_cnt = neptune_get_pgcnt(region);
+        if (!pg_cnt)
+            continue; // region shrinking can leave holes in the table
+        uint32_t *allocmap = neptune_get_allocmap(region);
+        jl_gc_pagemeta_cold_t *cold = neptune_get_pagemeta_cold(region);
+        for (uint32_t pg_i = 0; pg_i < pg_cnt; pg_i++) {
+            if (!(allocmap[pg_i / 32] & (uint32_t)(1 << (pg_i % 32))))
+                continue;
+            if (cold[pg_i].thread_n != t_n || cold[pg_i].pool_n != p_n)
+                continue;
+            npgs++;
+            v = (jl_taggedvalue_t*)(cold[pg_i].data + GC_PAGE_OFFSET);
+            char *lim = (char*)v + GC_PAGE_SZ - GC_PAGE_OFFSET - osize;
+            while ((char*)v <= lim) {
+                if (!gc_marked(v->bits.gc)) {
+                    nfree++;
                 }
+                else {
+                    nused++;
+                    if (v->bits.gc == GC_OLD_MARKED) {
+                        nold++;
+                    }
+                }
+                v = (jl_taggedvalue_t*)((char*)v + osize);
             }
-            v = (jl_taggedvalue_t*)((char*)v + osize);
-            i++;
         }
-        jl_gc_pagemeta_t *nextpg = NULL;
-        pg = nextpg;
     }
     *pwaste = npgs * GC_PAGE_SZ - (nused * p->osize);
     *np = npgs;
@@ -934,7 +1027,7 @@ void gc_stats_all_pool(void)
     for (int i = 0; i < JL_GC_N_POOLS; i++) {
         for (int t_i = 0;t_i < jl_n_threads;t_i++) {
             jl_ptls_t ptls2 = jl_all_tls_states[t_i];
-            size_t b = pool_stats(&ptls2->heap.norm_pools[i], &w, &np, &nol);
+            size_t b = pool_stats(t_i, i, &ptls2->heap.norm_pools[i], &w, &np, &nol);
             nb += b;
             no += (b / ptls2->heap.norm_pools[i].osize);
             tw += w;
@@ -987,10 +1080,10 @@ void gc_stats_big_obj(void)
 static int64_t poolobj_sizes[4];
 static int64_t empty_pages;
 
-static void gc_count_pool_page(jl_gc_pagemeta_t *pg)
+static void gc_count_pool_page(jl_gc_pagemeta_t *pg, jl_gc_pagemeta_cold_t *pgcold)
 {
     int osize = pg->osize;
-    char *data = pg->data;
+    char *data = pgcold->data;
     jl_taggedvalue_t *v = (jl_taggedvalue_t*)(data + GC_PAGE_OFFSET);
     char *lim = (char*)v + GC_PAGE_SZ - GC_PAGE_OFFSET - osize;
     int has_live = 0;
@@ -1008,15 +1101,13 @@ static void gc_count_pool_page(jl_gc_pagemeta_t *pg)
 
 static void gc_count_pool_region(region_t *region)
 {
-    for (int pg_i = 0; pg_i < neptune_get_pgcnt(region) / 32; pg_i++) {
-        uint32_t line = neptune_get_allocmap(region)[pg_i];
-        if (line) {
-            for (int j = 0; j < 32; j++) {
-                if ((line >> j) & 1) {
-                    gc_count_pool_page(&(neptune_get_pagemeta(region)[pg_i*32 + j]));
-                }
-            }
-        }
+    uint32_t *allocmap = neptune_get_allocmap(region);
+    // the original loop only visited full allocmap words
+    uint64_t npages = (uint64_t)(neptune_get_pgcnt(region) / 32) * 32;
+    for (int64_t pg_i = bitvector_next(allocmap, 0, npages); pg_i >= 0;
+         pg_i = bitvector_next(allocmap, pg_i + 1, npages)) {
+        gc_count_pool_page(&(neptune_get_pagemeta(region)[pg_i]),
+                           &(neptune_get_pagemeta_cold(region)[pg_i]));
     }
 }
 
@@ -1026,8 +1117,8 @@ void gc_count_pool(void)
     empty_pages = 0;
     for (int i = 0; i < REGION_COUNT; i++) {
         region_t * region = neptune_get_region(i);
-        if (neptune_get_pgcnt(region) == 0) // TODO: FIX
-            break;
+        if (neptune_get_pgcnt(region) == 0) // region shrinking can leave holes
+            continue;
         gc_count_pool_region(region);
     }
     jl_safe_printf("****** Pool stat: ******\n");
@@ -2,11 +2,73 @@
 
 #include "gc.h"
 #include "neptune.h"
+#ifndef _OS_WINDOWS_
+#include <sched.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// --- static tracepoints -----------------------------------------------------
+// USDT/SDT probes under the "neptune" provider. The Rust collector
+// calls these thin shims at collection boundaries, phase transitions
+// and the allocation slow paths, so bpftrace and SystemTap can attach
+// to stable probe notes instead of mangled Rust symbols that change
+// each build. An unarmed probe site is a single nop; without
+// <sys/sdt.h> on the build host the shims compile to empty calls.
+#if defined(_OS_LINUX_) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define HAVE_SDT 1
+#endif
+#endif
+#ifndef HAVE_SDT
+#define DTRACE_PROBE1(provider, probe, p1) do ; while (0)
+#define DTRACE_PROBE2(provider, probe, p1, p2) do ; while (0)
+#endif
+
+JL_DLLEXPORT void neptune_probe_gc_begin(int full)
+{
+    // collection boundaries double as refresh points for the cached
+    // coarse clock (see jl_hrtime_coarse in sys.c)
+    jl_hrtime_coarse_refresh();
+    DTRACE_PROBE1(neptune, gc_begin, full);
+}
+JL_DLLEXPORT void neptune_probe_mark_end(uint64_t ns)
+{
+    DTRACE_PROBE1(neptune, mark_end, ns);
+}
+JL_DLLEXPORT void neptune_probe_sweep_begin(int full)
+{
+    DTRACE_PROBE1(neptune, sweep_begin, full);
+}
+JL_DLLEXPORT void neptune_probe_sweep_end(uint64_t ns)
+{
+    DTRACE_PROBE1(neptune, sweep_end, ns);
+}
+JL_DLLEXPORT void neptune_probe_gc_end(uint64_t pause_ns, int full)
+{
+    jl_hrtime_coarse_refresh();
+    DTRACE_PROBE2(neptune, gc_end, pause_ns, full);
+}
+JL_DLLEXPORT void neptune_probe_page_alloc(void *page)
+{
+    DTRACE_PROBE1(neptune, page_alloc, page);
+}
+JL_DLLEXPORT void neptune_probe_page_free(void *page)
+{
+    DTRACE_PROBE1(neptune, page_free, page);
+}
+JL_DLLEXPORT void neptune_probe_promoted(uint64_t bytes)
+{
+    DTRACE_PROBE1(neptune, promoted, bytes);
+}
+JL_DLLEXPORT void neptune_probe_big_alloc(size_t bytes)
+{
+    DTRACE_PROBE1(neptune, big_alloc, bytes);
+}
+
 // Protect all access to `finalizer_list_marked` and `to_finalize`.
 // For accessing `ptls->finalizers`, the lock is needed if a thread
 // is going to realloc the buffer (of its own list) or accessing the
@@ -45,7 +107,12 @@ static jl_mutex_t finalizers_lock;
  * finalizers in unmanaged (GC safe) mode.
  */
 
-jl_gc_num_t gc_num = {0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+jl_gc_num_t gc_num = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+
+// shared GC stats block owned by the Rust collector (see neptune.h);
+// valid once jl_gc_init has run. Exported so tooling (cglobal from
+// Julia, external scrapers) can read the per-thread sub-blocks.
+JL_DLLEXPORT const neptune_stats_t *jl_gc_stats = NULL;
 size_t last_long_collect_interval;
 
 // List of marked big objects.  Not per-thread.  Accessed only by master thread.
@@ -62,18 +129,79 @@ arraylist_t to_finalize;
 #define should_timeout() 0
 
 #ifdef JULIA_ENABLE_THREADING
+// The inline allocation fast path emitted by codegen only checks the
+// bump limit (gc_pool_end), so a thread bump-allocating in a tight
+// loop would not poll the safepoint page until its span ran out. The
+// collector therefore revokes every thread's bump limits when it
+// starts a rendezvous: the next inline allocation fails its limit
+// check, falls into jl_gc_pool_alloc, and parks on the safepoint
+// there. The real limits are stashed so they can be restored when the
+// world restarts without a sweep having refreshed the spans (a sweep
+// nulls gc_pool_cur, which is how we tell the two cases apart).
+static char **revoked_pool_end = NULL; // jl_n_threads rows of JL_GC_N_POOLS
+
+void jl_gc_revoke_bump_limits(void)
+{
+    if (!revoked_pool_end)
+        revoked_pool_end = (char**)calloc(jl_n_threads * JL_GC_N_POOLS,
+                                          sizeof(char*));
+    for (int i = 0;i < jl_n_threads;i++) {
+        jl_ptls_t ptls2 = jl_all_tls_states[i];
+        for (int p = 0;p < JL_GC_N_POOLS;p++) {
+            revoked_pool_end[i * JL_GC_N_POOLS + p] = ptls2->gc_pool_end[p];
+            ptls2->gc_pool_end[p] = NULL;
+        }
+    }
+}
+
+void jl_gc_restore_bump_limits(void)
+{
+    if (!revoked_pool_end)
+        return;
+    for (int i = 0;i < jl_n_threads;i++) {
+        jl_ptls_t ptls2 = jl_all_tls_states[i];
+        for (int p = 0;p < JL_GC_N_POOLS;p++) {
+            // the owning thread may have bumped gc_pool_cur past our
+            // read of it before parking, but never past the old limit,
+            // so restoring the limit is always safe if the span is
+            // still installed
+            if (ptls2->gc_pool_cur[p] != NULL)
+                ptls2->gc_pool_end[p] = revoked_pool_end[i * JL_GC_N_POOLS + p];
+            revoked_pool_end[i * JL_GC_N_POOLS + p] = NULL;
+        }
+    }
+}
+
+// How long the collector spins on a mutator's gc_state before yielding
+// the CPU to it. gc_state is a per-thread byte, so unlike
+// jl_safepoint_wait_gc there is no 32-bit word to sleep on with a
+// futex; yielding is the best we can do and is what the straggler
+// needs anyway to reach its safepoint.
+#define GC_WAIT_SPIN_LIMIT 1024
 static void jl_gc_wait_for_the_world(void)
 {
+    // make the inline allocation fast path fail so allocating threads
+    // reach the safepoint in jl_gc_pool_alloc
+    jl_gc_revoke_bump_limits();
     for (int i = 0;i < jl_n_threads;i++) {
         jl_ptls_t ptls2 = jl_all_tls_states[i];
-        // FIXME: The acquire load pairs with the release stores
-        // in the signal handler of safepoint so we are sure that
-        // all the stores on those threads are visible. However,
-        // we're currently not using atomic stores in mutator threads.
-        // We should either use atomic store release there too or use signals
-        // to flush the memory operations on those threads.
+        uint32_t spins = 0;
+        // The acquire load pairs with the release stores mutators make
+        // in jl_gc_state_set and the signal handler makes in
+        // jl_set_gc_and_wait, so once a thread reads as parked all of
+        // its preceding heap stores are visible here. The plain load
+        // in front skips the fence while the thread is still running.
         while (!ptls2->gc_state || !jl_atomic_load_acquire(&ptls2->gc_state)) {
-            jl_cpu_pause(); // yield?
+            if (spins++ < GC_WAIT_SPIN_LIMIT) {
+                jl_cpu_pause();
+            }
+            else {
+#ifdef _OS_WINDOWS_
+                SwitchToThread();
+#else
+                sched_yield();
+#endif
+            }
         }
     }
 }
@@ -410,6 +538,28 @@ int prev_sweep_full = 1;
 int64_t live_bytes = 0;
 int64_t promoted_bytes = 0;
 
+// Hard heap limit (--gc-heap-limit); 0 means none. Collections
+// escalate instead of just failing: at 90% of the limit a trigger is
+// upgraded to a full collection, at 95% the sweep also returns parked
+// pages to the kernel, and only when the heap still exceeds the limit
+// after that last resort does the allocation fail with the usual
+// OutOfMemoryError - still a better failure mode than the OOM killer.
+// The pacing interval is clamped into the remaining headroom after
+// every collection, so the escalating triggers fire before the cap is
+// breached rather than after.
+static uint64_t heap_limit = 0;
+#define GC_LIMIT_MIN_INTERVAL (1 << 20)
+
+// current footprint: the live estimate plus the bytes allocated into
+// the running epoch (allocd counts up from -interval, plus whatever
+// still sits in the per-thread counters)
+static uint64_t gc_heap_usage(void)
+{
+    int64_t usage = live_bytes + gc_num.allocd + (int64_t)gc_num.interval +
+        neptune_pending_allocd();
+    return usage > 0 ? (uint64_t)usage : 0;
+}
+
 int64_t last_full_live_ub = 0;
 int64_t last_full_live_est = 0;
 // upper bound and estimated live object sizes
@@ -441,10 +591,52 @@ void gc_update_heap_size(int64_t sz_ub, int64_t sz_est)
     last_full_live_est = sz_est;
 }
 
+// seqlock-published runtime stats (see gc.h). Only collections write
+// the block, so publishing is free for mutators; scrapers spin on the
+// sequence word instead of stopping the world.
+JL_DLLEXPORT jl_gc_stats_pub_t jl_gc_stats_pub;
+
+void gc_stats_publish(void)
+{
+    uint64_t seq = jl_gc_stats_pub.seq;
+    // odd sequence marks the block as mid-update; the seq_cst store
+    // keeps the data stores below from moving above it
+    jl_atomic_store(&jl_gc_stats_pub.seq, seq + 1);
+    jl_gc_stats_pub.timestamp = jl_hrtime_fast();
+    memcpy(&jl_gc_stats_pub.num, &gc_num, sizeof(gc_num));
+    jl_gc_stats_pub.live_bytes = live_bytes;
+    jl_gc_stats_pub.pg_count = neptune_current_pg_count();
+    // release: the data stores above are visible before the block is
+    // marked consistent again
+    jl_atomic_store_release(&jl_gc_stats_pub.seq, seq + 2);
+}
+
+JL_DLLEXPORT void jl_gc_stats_read(jl_gc_stats_pub_t *out)
+{
+    uint64_t s0, s1;
+    do {
+        s0 = jl_atomic_load_acquire(&jl_gc_stats_pub.seq);
+        memcpy(out, &jl_gc_stats_pub, sizeof(*out));
+        // seq_cst load so the copy above cannot drift past the re-check
+        s1 = jl_atomic_load(&jl_gc_stats_pub.seq);
+    } while ((s0 & 1) || s0 != s1);
+    out->seq = s1;
+}
+
 #define should_collect() (__unlikely(gc_num.allocd>0))
 
 static inline int maybe_collect(jl_ptls_t ptls)
 {
+    if (__unlikely(gc_replay_active)) {
+        // replaying a recorded schedule: only the recorded trigger
+        // points, not the pacing heuristic, may start a collection
+        if (gc_replay_should_collect()) {
+            jl_gc_collect(0);
+            return 1;
+        }
+        jl_gc_safepoint_(ptls);
+        return 0;
+    }
     if (should_collect() || gc_debug_check_other()) {
         jl_gc_collect(0);
         return 1;
@@ -481,9 +673,17 @@ void jl_gc_count_allocd(size_t sz)
     gc_num.allocd += sz;
 }
 
+void jl_gc_count_array_grow(size_t bytes_copied)
+{
+    // This is **NOT** a GC safe point.
+    gc_num.arr_grows++;
+    gc_num.arr_copied += bytes_copied;
+}
+
 void jl_gc_reset_alloc_count(void)
 {
-    live_bytes += (gc_num.deferred_alloc + (gc_num.allocd + gc_num.interval));
+    live_bytes += (gc_num.deferred_alloc + (gc_num.allocd + gc_num.interval) +
+                   neptune_take_pending_allocd());
     gc_num.allocd = -(int64_t)gc_num.interval;
     gc_num.deferred_alloc = 0;
 }
@@ -492,6 +692,10 @@ void jl_gc_reset_alloc_count(void)
 JL_DLLEXPORT jl_value_t *jl_gc_pool_alloc(jl_ptls_t ptls, int pool_offset,
                                           int osize)
 {
+    // A pending rendezvous revokes the bump limits, which is what
+    // funnels inline fast-path allocations here; park before grabbing
+    // a fresh span so the limit check doubles as the safepoint check.
+    jl_gc_safepoint_(ptls);
     // Use neptune's pool allocator
     return neptune_pool_alloc(ptls->tl_gcs, osize + sizeof(jl_taggedvalue_t));
 }
@@ -503,9 +707,11 @@ int jl_gc_classify_pools(size_t sz, int *osize)
     size_t allocsz = sz + sizeof(jl_taggedvalue_t);
     int klass = jl_gc_szclass(allocsz);
     *osize = jl_gc_sizeclasses[klass];
-    // ACHTUNG: dirty hack
-    // Note: resulting offset is _never used because of how our pool allocation works
-    return 0; // (int)(intptr_t)(&((jl_ptls_t)0)->heap.norm_pools[klass]);
+    // return the pool index so the inline fast paths bump the same
+    // gc_pool_cur/gc_pool_end span the slow path installs; re-deriving
+    // the index from *osize would land one class up (and read past the
+    // end of neptune_szclass_table for the largest class)
+    return klass;
 }
 
 // sweep phase
@@ -513,9 +719,28 @@ int jl_gc_classify_pools(size_t sz, int *osize)
 int64_t lazy_freed_pages = 0;
 
 JL_DLLEXPORT void jl_gc_queue_root(jl_value_t *ptr)
+{
+    // out-of-line entry point for codegen and C callers; the barrier
+    // itself (jl_gc_wb in julia.h) appends to the log inline
+    jl_gc_log_root(ptr);
+}
+
+// hand the thread's write-barrier log to the GC in one call and reset it
+JL_DLLEXPORT void jl_gc_flush_wb_log(void)
 {
     jl_ptls_t ptls = jl_get_ptls_states();
-    neptune_queue_root(ptls->tl_gcs, ptr);
+    if (ptls->gc_wb_log_len == 0)
+        return;
+    neptune_queue_roots(ptls->tl_gcs, ptls->gc_wb_log, ptls->gc_wb_log_len);
+    ptls->gc_wb_log_len = 0;
+}
+
+// out-of-line slow path of the concurrent-marking barrier: mark the
+// stored pointer and queue it for the background marker
+JL_DLLEXPORT void jl_gc_shade(jl_value_t *ptr)
+{
+    jl_ptls_t ptls = jl_get_ptls_states();
+    neptune_shade(ptls->tl_gcs, ptr);
 }
 
 void gc_queue_binding(jl_binding_t *bnd)
@@ -532,6 +757,7 @@ void visit_mark_stack(jl_ptls_t ptls)
 extern jl_array_t *jl_module_init_order;
 extern jl_typemap_entry_t *call_cache[N_CALL_CACHE];
 extern jl_array_t *jl_all_methods;
+extern jl_array_t *jl_typemap_retired;
 
 // collector entry point and control
 static volatile uint32_t jl_gc_disable_counter = 0;
@@ -566,7 +792,7 @@ JL_DLLEXPORT int64_t jl_gc_total_bytes(void)
 {
     // Sync this logic with `base/util.jl:GC_Diff`
     return (gc_num.total_allocd + gc_num.deferred_alloc +
-            gc_num.allocd + gc_num.interval);
+            gc_num.allocd + gc_num.interval + neptune_pending_allocd());
 }
 JL_DLLEXPORT uint64_t jl_gc_total_hrtime(void)
 {
@@ -601,14 +827,29 @@ JL_DLLEXPORT void jl_gc_collect(int full)
 {
     jl_ptls_t ptls = jl_get_ptls_states();
     if (jl_gc_disable_counter) {
-        gc_num.deferred_alloc += (gc_num.allocd + gc_num.interval);
+        gc_num.deferred_alloc += (gc_num.allocd + gc_num.interval) +
+            neptune_take_pending_allocd();
         gc_num.allocd = -(int64_t)gc_num.interval;
         return;
     }
     gc_debug_print();
+    gc_record_note_collect();
+
+    // heap-limit escalation: upgrade to a full collection near the
+    // cap, and ask the sweep for parked-page return right below it
+    int limit_last_resort = 0;
+    if (__unlikely(heap_limit)) {
+        uint64_t usage = gc_heap_usage();
+        if (usage >= heap_limit / 100 * 90)
+            full = 1;
+        if (usage >= heap_limit / 100 * 95) {
+            limit_last_resort = 1;
+            neptune_request_page_return();
+        }
+    }
 
     int8_t old_state = jl_gc_state(ptls);
-    ptls->gc_state = JL_GC_STATE_WAITING;
+    jl_atomic_store_release(&ptls->gc_state, JL_GC_STATE_WAITING);
     // `jl_safepoint_start_gc()` makes sure only one thread can
     // run the GC.
     if (!jl_safepoint_start_gc()) {
@@ -627,7 +868,38 @@ JL_DLLEXPORT void jl_gc_collect(int full)
     //       now that the threads have all stopped and reached a safe point
     if (!jl_gc_disable_counter) {
         JL_LOCK_NOGC(&finalizers_lock);
-        if (neptune_gc_collect(ptls->tl_gcs, full)) {
+        // With concurrent marking a collection spans several entries
+        // into this function: the first pause queues the roots and
+        // restarts the world, later entries just defer until the
+        // background marker is done, and the final pause rescans and
+        // sweeps. Full collections (and cycles started before a full
+        // request) still run the stop-the-world path below.
+        int conc = neptune_concurrent_mark_enabled() &&
+            (neptune_gc_concurrent_state() != 0 || !full);
+        if (conc && neptune_gc_concurrent_state() == 0) {
+            neptune_gc_mark_initial(ptls->tl_gcs);
+            // re-arm the allocation interval (shared and per-thread) so
+            // mutators don't immediately re-trigger the GC while
+            // marking runs
+            gc_num.deferred_alloc += (gc_num.allocd + gc_num.interval) +
+                neptune_take_pending_allocd();
+            gc_num.allocd = -(int64_t)gc_num.interval;
+        }
+        else if (conc && neptune_gc_concurrent_state() == 1) {
+            // marker still running; give it more time
+            gc_num.deferred_alloc += (gc_num.allocd + gc_num.interval) +
+                neptune_take_pending_allocd();
+            gc_num.allocd = -(int64_t)gc_num.interval;
+        }
+        else if (conc) {
+            if (neptune_gc_collect_final(ptls->tl_gcs)) {
+                jl_gc_mark_ptrfree(ptls);
+                int ret = neptune_gc_collect(ptls->tl_gcs, 0);
+                (void)ret;
+                assert(!ret);
+            }
+        }
+        else if (neptune_gc_collect(ptls->tl_gcs, full)) {
           // TODO: determine what to needs to change in the rest of this block
             jl_gc_mark_ptrfree(ptls);
             int ret = neptune_gc_collect(ptls->tl_gcs, 0);
@@ -641,6 +913,31 @@ JL_DLLEXPORT void jl_gc_collect(int full)
     jl_safepoint_end_gc();
     jl_gc_state_set(ptls, old_state, JL_GC_STATE_WAITING);
 
+    // refresh the scraper-visible stats block while the numbers from
+    // this cycle are still coherent
+    gc_stats_publish();
+
+    if (__unlikely(heap_limit)) {
+        // re-clamp the pacing interval into the remaining headroom so
+        // the next trigger fires (and escalates) before the cap
+        uint64_t used = live_bytes > 0 ? (uint64_t)live_bytes : 0;
+        uint64_t headroom =
+            heap_limit > used ? (heap_limit - used) / 2 : GC_LIMIT_MIN_INTERVAL;
+        if (headroom < GC_LIMIT_MIN_INTERVAL)
+            headroom = GC_LIMIT_MIN_INTERVAL;
+        if (gc_num.interval > headroom) {
+            // the per-thread pacing counters were re-armed with the old
+            // interval inside the collection; they pick the clamped one
+            // up at the next pause, which the escalation margins cover
+            gc_num.allocd += (int64_t)(gc_num.interval - headroom);
+            gc_num.interval = headroom;
+        }
+        // even a full collection with page return could not get back
+        // under the limit: fail the allocation that triggered us
+        if (limit_last_resort && gc_heap_usage() > heap_limit)
+            jl_throw(jl_memory_exception);
+    }
+
     // Only disable finalizers on current thread
     // Doing this on all threads is racy (it's impossible to check
     // or wait for finalizers on other threads without dead lock).
@@ -654,9 +951,9 @@ JL_DLLEXPORT void jl_gc_collect(int full)
 
 void mark_all_roots(jl_ptls_t ptls)
 {
-    for (size_t i = 0; i < jl_n_threads; i++)
-      neptune_mark_thread_local(ptls->tl_gcs, jl_all_tls_states[i]->tl_gcs);
-    neptune_mark_roots(ptls);
+    // one crossing for the whole pass; the per-thread loop (and the
+    // cache syncing it feeds) runs entirely on the Rust side
+    neptune_mark_all_roots(ptls->tl_gcs);
     jl_gc_mark_ptrfree(ptls);
 }
 
@@ -673,14 +970,55 @@ void jl_mk_thread_heap(jl_ptls_t ptls)
     arraylist_new(&ptls->finalizers, 0);
 }
 
+#ifdef _OS_LINUX_
+// buffer pointer -> mapped length for mmap-backed array buffers (see
+// ARRAY_MMAP_THRESH below); mmap'd buffers are rare so a small
+// lock-protected table is plenty. Declared here because jl_gc_init
+// sets the table up.
+static htable_t mmap_buffers;
+static jl_mutex_t mmap_buffers_lock = {0, 0};
+#endif
+
 // System-wide initializations
 void jl_gc_init(void)
 {
+    // the page size is a build-time parameter on both sides
+    // (GC_PAGE_LG2 / the page_64k and page_256k cargo features);
+    // refuse to run with a mismatched pair of builds
+    if (neptune_page_lg2() != GC_PAGE_LG2) {
+        jl_printf(JL_STDERR,
+                  "fatal: GC page size mismatch: libjulia built for 2^%d-byte "
+                  "pages, libneptune for 2^%d\n",
+                  GC_PAGE_LG2, neptune_page_lg2());
+        abort();
+    }
+    // hand the command-line GC tuning (jloptions.c) to the Rust side
+    // before the page manager is built: the page-return policy is
+    // consulted when the page manager is constructed
+    neptune_gc_opts_t gc_opts;
+    memset(&gc_opts, 0, sizeof(gc_opts));
+    // NUMA placement policy for the GC's region memory
+    gc_opts.numa_policy = NEPTUNE_NUMA_DEFAULT;
+    const char *numa = getenv("NEPTUNE_NUMA");
+    if (numa && !strcmp(numa, "local"))
+        gc_opts.numa_policy = NEPTUNE_NUMA_LOCAL;
+    else if (numa && !strcmp(numa, "interleave"))
+        gc_opts.numa_policy = NEPTUNE_NUMA_INTERLEAVE;
+    gc_opts.nthreads = jl_options.gc_threads;
+    gc_opts.heap_init = jl_options.gc_heap_init;
+    gc_opts.heap_max = jl_options.gc_heap_max;
+    gc_opts.pause_target_ms = jl_options.gc_pause_target;
+    gc_opts.page_return = jl_options.gc_page_return;
+    neptune_init_gc(&gc_opts, &jl_gc_stats);
+
     jl_gc_init_page();
     gc_debug_init();
 
     arraylist_new(&finalizer_list_marked, 0);
     arraylist_new(&to_finalize, 0);
+#ifdef _OS_LINUX_
+    htable_new(&mmap_buffers, 0);
+#endif
 
     gc_num.interval = default_collect_interval;
     last_long_collect_interval = default_collect_interval;
@@ -693,7 +1031,28 @@ void jl_gc_init(void)
         max_collect_interval = maxmem;
 #endif
 
-    neptune_init_gc();
+    // command-line overrides of the collection pacing; these counters
+    // live on the C side, so they are applied here rather than passed on
+    // to the Rust collector
+    if (jl_options.gc_heap_init) {
+        gc_num.interval = jl_options.gc_heap_init;
+        last_long_collect_interval = jl_options.gc_heap_init;
+        gc_num.allocd = -(int64_t)jl_options.gc_heap_init;
+    }
+    if (jl_options.gc_heap_max)
+        max_collect_interval = jl_options.gc_heap_max;
+    if (jl_options.gc_heap_limit) {
+        heap_limit = jl_options.gc_heap_limit;
+        // start pacing inside the cap so the escalation ladder gets a
+        // chance to run before the first allocation can breach it
+        if (gc_num.interval > heap_limit / 2) {
+            gc_num.interval = heap_limit / 2;
+            gc_num.allocd = -(int64_t)gc_num.interval;
+        }
+    }
+
+    // scrapers may attach before the first collection
+    gc_stats_publish();
 }
 
 JL_DLLEXPORT void *jl_gc_counted_malloc(size_t sz)
@@ -788,6 +1147,133 @@ JL_DLLEXPORT void *jl_realloc(void *p, size_t sz)
     return (void *)(pnew + 2);
 }
 
+// Pool of freed array data buffers, recycled by the sweep. Our numeric
+// pipelines create and drop millions of mid-sized arrays and glibc
+// malloc contention shows up in every profile, so buffers of the common
+// sizes bypass malloc entirely. Buckets are powers of two from 4KB up;
+// anything larger goes straight back to the system.
+#define BUFFER_POOL_BUCKETS 10   // 4KB .. 2MB
+#define BUFFER_POOL_BUCKET_CAP 16
+typedef struct {
+    void *buf;
+    size_t sz;
+} cached_buffer_t;
+static cached_buffer_t buffer_pool[BUFFER_POOL_BUCKETS][BUFFER_POOL_BUCKET_CAP];
+static int buffer_pool_len[BUFFER_POOL_BUCKETS];
+static jl_mutex_t buffer_pool_lock = {0, 0};
+
+static int buffer_pool_bucket(size_t sz)
+{
+    if (sz > ((size_t)4096 << (BUFFER_POOL_BUCKETS - 1)))
+        return -1;
+    int b = 0;
+    while (((size_t)4096 << b) < sz)
+        b++;
+    return b;
+}
+
+static void *buffer_pool_take(size_t allocsz)
+{
+    int b = buffer_pool_bucket(allocsz);
+    if (b < 0)
+        return NULL;
+    void *buf = NULL;
+    JL_LOCK_NOGC(&buffer_pool_lock);
+    for (; b < BUFFER_POOL_BUCKETS && buf == NULL; b++) {
+        for (int i = 0; i < buffer_pool_len[b]; i++) {
+            if (buffer_pool[b][i].sz >= allocsz) {
+                buf = buffer_pool[b][i].buf;
+                buffer_pool[b][i] = buffer_pool[b][--buffer_pool_len[b]];
+                break;
+            }
+        }
+    }
+    JL_UNLOCK_NOGC(&buffer_pool_lock);
+    return buf;
+}
+
+#ifdef _OS_LINUX_
+// Array buffers at or above this size are mmap-backed so that growing
+// them is an mremap (a page-table update) instead of a realloc+memcpy.
+// Append-heavy workloads repeatedly double multi-GB buffers, and the
+// copies dominate jl_array_grow_end there.
+#define ARRAY_MMAP_THRESH (64 * 1024 * 1024)
+// (the mmap_buffers table lives above jl_gc_init, which initializes it)
+
+static void *array_buffer_mmap(size_t allocsz)
+{
+    size_t maplen = LLT_ALIGN(allocsz, jl_page_size);
+    void *b = mmap(NULL, maplen, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (b == MAP_FAILED)
+        jl_throw(jl_memory_exception);
+    JL_LOCK_NOGC(&mmap_buffers_lock);
+    ptrhash_put(&mmap_buffers, b, (void*)maplen);
+    JL_UNLOCK_NOGC(&mmap_buffers_lock);
+    return b;
+}
+
+// mapped length of `d` if it is one of ours, 0 otherwise
+static size_t array_buffer_maplen(void *d)
+{
+    JL_LOCK_NOGC(&mmap_buffers_lock);
+    void *len = ptrhash_get(&mmap_buffers, d);
+    JL_UNLOCK_NOGC(&mmap_buffers_lock);
+    return len == HT_NOTFOUND ? 0 : (size_t)len;
+}
+
+static void *array_buffer_mremap(void *d, size_t oldmaplen, size_t allocsz)
+{
+    size_t maplen = LLT_ALIGN(allocsz, jl_page_size);
+    void *b = mremap(d, oldmaplen, maplen, MREMAP_MAYMOVE);
+    if (b == MAP_FAILED)
+        jl_throw(jl_memory_exception);
+    JL_LOCK_NOGC(&mmap_buffers_lock);
+    ptrhash_remove(&mmap_buffers, d);
+    ptrhash_put(&mmap_buffers, b, (void*)maplen);
+    JL_UNLOCK_NOGC(&mmap_buffers_lock);
+    return b;
+}
+
+// returns 1 if `d` was mmap-backed and has been unmapped
+static int array_buffer_munmap(void *d)
+{
+    JL_LOCK_NOGC(&mmap_buffers_lock);
+    void *len = ptrhash_get(&mmap_buffers, d);
+    if (len != HT_NOTFOUND)
+        ptrhash_remove(&mmap_buffers, d);
+    JL_UNLOCK_NOGC(&mmap_buffers_lock);
+    if (len == HT_NOTFOUND)
+        return 0;
+    munmap(d, (size_t)len);
+    return 1;
+}
+#endif
+
+// called from neptune's sweep instead of free(3) for dead array buffers
+JL_DLLEXPORT void np_cache_array_buffer(void *d, size_t sz)
+{
+#ifdef _OS_LINUX_
+    if (array_buffer_munmap(d))
+        return;
+#endif
+    // sz is the usable size; the real allocation is at least the
+    // cache-aligned value, be conservative and record the usable one
+    int b = buffer_pool_bucket(sz);
+    if (b >= 0) {
+        JL_LOCK_NOGC(&buffer_pool_lock);
+        if (buffer_pool_len[b] < BUFFER_POOL_BUCKET_CAP) {
+            buffer_pool[b][buffer_pool_len[b]].buf = d;
+            buffer_pool[b][buffer_pool_len[b]].sz = sz;
+            buffer_pool_len[b]++;
+            d = NULL;
+        }
+        JL_UNLOCK_NOGC(&buffer_pool_lock);
+    }
+    if (d != NULL)
+        free(d);
+}
+
 JL_DLLEXPORT void *jl_gc_managed_malloc(size_t sz)
 {
     jl_ptls_t ptls = jl_get_ptls_states();
@@ -797,7 +1283,13 @@ JL_DLLEXPORT void *jl_gc_managed_malloc(size_t sz)
         jl_throw(jl_memory_exception);
     gc_num.allocd += allocsz;
     gc_num.malloc++;
-    void *b = malloc_cache_align(allocsz);
+#ifdef _OS_LINUX_
+    if (allocsz >= ARRAY_MMAP_THRESH)
+        return array_buffer_mmap(allocsz);
+#endif
+    void *b = buffer_pool_take(allocsz);
+    if (b == NULL)
+        b = malloc_cache_align(allocsz);
     if (b == NULL)
         jl_throw(jl_memory_exception);
     return b;
@@ -824,6 +1316,22 @@ static void *gc_managed_realloc_(jl_ptls_t ptls, void *d, size_t sz, size_t olds
     gc_num.realloc++;
 
     void *b;
+#ifdef _OS_LINUX_
+    size_t maplen = array_buffer_maplen(d);
+    if (maplen) {
+        // already mmap-backed: grow (or shrink) in place, no copy
+        return array_buffer_mremap(d, maplen, allocsz);
+    }
+    if (allocsz >= ARRAY_MMAP_THRESH && jl_is_array(owner)) {
+        // crossing the threshold: migrate to an mmap'd buffer; this is
+        // the last copy this buffer will ever see. Strings (bigval
+        // headers) stay on the malloc path since the GC frees those.
+        b = array_buffer_mmap(allocsz);
+        memcpy(b, d, oldsz < allocsz ? oldsz : allocsz);
+        free(d);
+        return b;
+    }
+#endif
     if (isaligned)
         b = realloc_cache_align(d, allocsz, oldsz);
     else
@@ -921,16 +1429,52 @@ void *jl_gc_perm_alloc_nolock(size_t sz)
     return p;
 }
 
+// report batched perm bytes to the GC at this granularity; package load
+// does hundreds of thousands of perm allocations and we don't want to
+// cross into the GC runtime for each one
+#define GC_PERM_BATCH (64 * 1024)
+
 // **NOT** a safepoint
+// Allocates from a per-thread bump arena, so no lock is taken. The
+// global pool (jl_gc_perm_alloc_nolock + gc_perm_lock) remains for
+// callers that already hold `gc_perm_lock`.
 void *jl_gc_perm_alloc(size_t sz)
 {
 #ifndef MEMDEBUG
     if (__unlikely(sz > GC_PERM_POOL_LIMIT))
 #endif
         return malloc(sz);
-    JL_LOCK_NOGC(&gc_perm_lock);
-    void *p = jl_gc_perm_alloc_nolock(sz);
-    JL_UNLOCK_NOGC(&gc_perm_lock);
+    jl_ptls_t ptls = jl_get_ptls_states();
+    sz = LLT_ALIGN(sz, JL_SMALL_BYTE_ALIGNMENT);
+    if (__unlikely(sz > ptls->gc_perm_size)) {
+#ifdef _OS_WINDOWS_
+        void *pool = VirtualAlloc(NULL,
+                                  GC_PERM_POOL_SIZE + JL_SMALL_BYTE_ALIGNMENT,
+                                  MEM_COMMIT, PAGE_READWRITE);
+        if (__unlikely(pool == NULL))
+            return NULL;
+        pool = (void*)LLT_ALIGN((uintptr_t)pool, JL_SMALL_BYTE_ALIGNMENT);
+#else
+        void *pool = mmap(0, GC_PERM_POOL_SIZE, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (__unlikely(pool == MAP_FAILED))
+            return NULL;
+#endif
+        ptls->gc_perm_pool = (char*)pool;
+        ptls->gc_perm_size = GC_PERM_POOL_SIZE;
+    }
+    assert(((uintptr_t)ptls->gc_perm_pool) % JL_SMALL_BYTE_ALIGNMENT == 0);
+    void *p = ptls->gc_perm_pool;
+    ptls->gc_perm_size -= sz;
+    ptls->gc_perm_pool += sz;
+    // batch the byte-count report instead of crossing into the GC
+    // runtime on every allocation
+    ptls->gc_perm_allocd += sz;
+    if (__unlikely(ptls->gc_perm_allocd >= GC_PERM_BATCH) &&
+        ptls->tl_gcs != NULL) {
+        neptune_log_perm_scanned_bytes(ptls->tl_gcs, ptls->gc_perm_allocd);
+        ptls->gc_perm_allocd = 0;
+    }
     return p;
 }
 
@@ -30,10 +30,24 @@
 extern "C" {
 #endif
 
-#define GC_PAGE_LG2 14 // log2(size of a page)
-#define GC_PAGE_SZ (1 << GC_PAGE_LG2) // 16k
+// log2(size of a page); build-time selectable for large-page
+// experiments: pass -DGC_PAGE_LG2=16 (64k) or 18 (256k) and build the
+// Rust half with the matching page_64k/page_256k cargo feature.
+// jl_gc_init cross-checks the two halves via neptune_page_lg2.
+#ifndef GC_PAGE_LG2
+#define GC_PAGE_LG2 14 // 16k
+#endif
+#define GC_PAGE_SZ (1 << GC_PAGE_LG2)
 #define GC_PAGE_OFFSET (JL_SMALL_BYTE_ALIGNMENT - (sizeof(jl_taggedvalue_t) % JL_SMALL_BYTE_ALIGNMENT))
 
+// in-page offsets stored in page metadata; 16 bits cover pages up to
+// 64k (keep in sync with PgOff in neptune/src/gc.rs)
+#if GC_PAGE_LG2 > 16
+typedef uint32_t jl_gc_pgoff_t;
+#else
+typedef uint16_t jl_gc_pgoff_t;
+#endif
+
 // 8G * 32768 = 2^48
 // It's really unlikely that we'll actually allocate that much though...
 #define REGION_COUNT 32768
@@ -76,6 +90,18 @@ typedef struct {
     size_t      interval;
     int         pause;
     int         full_sweep;
+    // neptune extensions (filled in by the Rust collector); new fields
+    // go at the end so the offsets above stay stable
+    uint64_t    mark_rate;   // bytes marked per second, last cycle
+    uint64_t    pages_swept; // pool pages visited by the sweep
+    uint64_t    promoted;    // bytes promoted to the old generation
+    uint64_t    barriers;    // write barrier (queue_root) activations
+    uint64_t    pause_p50;   // pause-time percentile estimates, ns
+    uint64_t    pause_p90;
+    uint64_t    pause_p99;
+    uint64_t    arr_grows;   // array buffer enlargements (jl_array_grow_*)
+    uint64_t    arr_copied;  // bytes moved servicing those enlargements
+    uint64_t    big_hugepage_bytes; // big-object bytes on hugepage-advised chunks
 } jl_gc_num_t;
 
 // layout for big (>2k) objects
@@ -111,10 +137,9 @@ typedef struct _mallocarray_t {
     struct _mallocarray_t *next;
 } mallocarray_t;
 
-// pool page metadata
+// pool page metadata, hot half: the fields the sweep touches for every
+// live page, packed two entries per cache line so region walks stream
 typedef struct {
-    // index of pool that owns this page
-    uint8_t pool_n;
     // Whether any cell in the page is marked
     // This bit is set before sweeping iff there are live cells in the page.
     // Note that before marking or after sweeping there can be live
@@ -132,6 +157,8 @@ typedef struct {
     // still be old dead objects in the page and `nold` and `prev_nold`
     // should be used to determine if the page needs to be swept.
     uint8_t has_young;
+    uint8_t in_freelist;      // page is parked in the page manager's freelist
+    uint8_t needs_sweep;      // page has a pending lazy sweep
     // number of old objects in this page
     uint16_t nold;
     // number of old objects in this page during the previous full sweep
@@ -140,13 +167,23 @@ typedef struct {
     // invalid if pool that owns this page is allocating objects from this page.
     uint16_t nfree;
     uint16_t osize; // size of each object in this page
-    uint16_t fl_begin_offset; // offset of first free object in this page
-    uint16_t fl_end_offset;   // offset of last free object in this page
-    uint16_t thread_n;        // thread id of the heap that owns this page
-    char *data;
+    jl_gc_pgoff_t fl_begin_offset; // offset of first free object in this page
+    jl_gc_pgoff_t fl_end_offset;   // offset of last free object in this page
     uint8_t *ages;
+    // NB: the authoritative layout is PageMeta in neptune/src/gc2.rs,
+    // which additionally carries a side mark bitmap after the ages.
 } jl_gc_pagemeta_t;
 
+// pool page metadata, cold half: set when a page is handed to a pool
+// and read only when a page's owner or data pointer is needed. Lives
+// in a side table parallel to the hot array (PageMetaCold in
+// neptune/src/gc2.rs).
+typedef struct {
+    char *data;        // start of the page's data
+    uint16_t thread_n; // thread id of the heap that owns this page
+    uint8_t pool_n;    // index of pool that owns this page
+} jl_gc_pagemeta_cold_t;
+
 typedef struct {
     char data[GC_PAGE_SZ];
 } jl_gc_page_t
@@ -164,6 +201,7 @@ region_t * neptune_get_region(size_t i);
 jl_gc_page_t * neptune_get_pages(region_t * region);
 uint32_t * neptune_get_allocmap(region_t * region);
 jl_gc_pagemeta_t * neptune_get_pagemeta(region_t * region);
+jl_gc_pagemeta_cold_t * neptune_get_pagemeta_cold(region_t * region);
 uint32_t neptune_get_lb(region_t * region);
 uint32_t neptune_get_ub(region_t * region);
 void neptune_set_lb(region_t * region, uint32_t lb);
@@ -188,14 +226,15 @@ STATIC_INLINE char *gc_page_data(void *x)
     return (char*)(((uintptr_t)x >> GC_PAGE_LG2) << GC_PAGE_LG2);
 }
 
-STATIC_INLINE jl_taggedvalue_t *page_pfl_beg(jl_gc_pagemeta_t *p)
+// the page data pointer lives in the cold metadata, so callers pass it in
+STATIC_INLINE jl_taggedvalue_t *page_pfl_beg(char *data, jl_gc_pagemeta_t *p)
 {
-    return (jl_taggedvalue_t*)(p->data + p->fl_begin_offset);
+    return (jl_taggedvalue_t*)(data + p->fl_begin_offset);
 }
 
-STATIC_INLINE jl_taggedvalue_t *page_pfl_end(jl_gc_pagemeta_t *p)
+STATIC_INLINE jl_taggedvalue_t *page_pfl_end(char *data, jl_gc_pagemeta_t *p)
 {
-    return (jl_taggedvalue_t*)(p->data + p->fl_end_offset);
+    return (jl_taggedvalue_t*)(data + p->fl_end_offset);
 }
 
 STATIC_INLINE int page_index(region_t *region, void *data)
@@ -247,6 +286,21 @@ STATIC_INLINE jl_gc_pagemeta_t *page_metadata(void *_data)
     return NULL;
 }
 
+STATIC_INLINE jl_gc_pagemeta_cold_t *page_metadata_cold(void *_data)
+{
+    uintptr_t data = ((uintptr_t)_data) - 1;
+    region_t *region = neptune_get_region(0);
+    for (int i = 0; i < REGION_COUNT && neptune_get_pages(region); i++) {
+        region = neptune_get_region(i);
+        uintptr_t begin = (uintptr_t)neptune_get_pages(region)->data;
+        uintptr_t offset = data - begin;
+        if (offset < neptune_get_pgcnt(region) * sizeof(jl_gc_page_t)) {
+            return &(neptune_get_pagemeta_cold(region)[offset >> GC_PAGE_LG2]);
+        }
+    }
+    return NULL;
+}
+
 STATIC_INLINE void gc_big_object_unlink(const bigval_t *hdr)
 {
     *hdr->prev = hdr->next;
@@ -268,6 +322,33 @@ void mark_all_roots(jl_ptls_t ptls);
 void gc_mark_object_list(jl_ptls_t ptls, arraylist_t *list, size_t start);
 void visit_mark_stack(jl_ptls_t ptls);
 void gc_debug_init(void);
+
+// seqlock-published runtime stats for metrics scrapers
+//
+// gc_stats_publish refreshes this block at the end of every collection
+// (and once at init). Readers - an in-process scraper thread via
+// jl_gc_stats_read, or an external process reading the exported symbol
+// out of shared memory - copy the block and retry while `seq` is odd
+// or changed across the copy; mutators never touch the seqlock.
+typedef struct {
+    uint64_t seq;        // odd while the writer is mid-update
+    uint64_t timestamp;  // uv_hrtime() of the snapshot
+    jl_gc_num_t num;     // allocation and pause counters
+    int64_t live_bytes;  // C-side live-heap estimate
+    uint64_t pg_count;   // pool pages currently allocated (Rust side)
+} jl_gc_stats_pub_t;
+JL_DLLEXPORT extern jl_gc_stats_pub_t jl_gc_stats_pub;
+void gc_stats_publish(void);
+JL_DLLEXPORT void jl_gc_stats_read(jl_gc_stats_pub_t *out);
+
+// deterministic GC-trigger record/replay (gc-debug.c): JULIA_GC_RECORD
+// logs the cumulative allocation count of every collection,
+// JULIA_GC_REPLAY forces collections at the recorded counts instead of
+// the pacing heuristic
+extern int gc_replay_active;
+void gc_record_replay_init(void);
+int gc_replay_should_collect(void);
+void gc_record_note_collect(void);
 void jl_mark_box_caches(jl_ptls_t ptls);
 
 // GC pages
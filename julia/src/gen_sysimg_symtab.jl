@@ -1,27 +1,82 @@
 # This file is a part of Julia. License is MIT: http://julialang.org/license
 
-# script to generate tables of common symbols from a system image
-# steps to rerun this:
+# script to generate tables of common symbols, either from a system image
+# or from runtime symbol-frequency profiles.
+#
+# sysimg mode (the original flow):
 #   1. empty the contents of common_symbols*.inc
 #   2. modify dump.c to write and read a '\0' after every symbol name
 #   3. build sys.ji
 #   4. cd src && ../julia gen_sysimg_symtab.jl ../usr/lib/julia/sys.ji
+#
+# profile mode:
+#   1. run representative workloads with JULIA_SYMTAB_PROFILE=/path/to/prof
+#      (each run appends "count name" lines to that file at exit)
+#   2. cd src && ../julia gen_sysimg_symtab.jl --profile prof [prof2 ...]
+#   3. optionally pass --tier3=N to size the third-tier table (default 2048)
+#
+# the first 63 symbols get 1-byte encodings, the next 252 get 2-byte
+# encodings, and the remaining tier-3 symbols get 3-byte encodings.
 
-fname = ARGS[1]
-
-io,_ = open(pipeline(`strings -n 3 $fname`,
-                     `tr -d "() \t+-"`,
-                     `grep -v '^$'`,  # rm empty lines
-                     `grep -v '\\'`,  # avoid backslashes
-                     `sort`, `uniq -c`, `sort -g -r`,
-                     `head -n 315`))  # 63 + 252
+function outputline(io, name, count)
+    println(io, "jl_symbol(\"", name, "\"),")
+end
 
-function outputline(io, line)
-    row = split(line, " ", keep=false)
-    println(io, "jl_symbol(\"", row[2], "\"),")
+function writetables(entries, ntier3)
+    open("common_symbols1.inc", "w") do f
+        foreach(e->outputline(f, e...), take(entries, 63))
+    end
+    open("common_symbols2.inc", "w") do f
+        foreach(e->outputline(f, e...), take(drop(entries, 63), 252))
+    end
+    # sysimg mode has no tier-3 data; leave the existing table alone
+    if ntier3 > 0
+        open("common_symbols3.inc", "w") do f
+            foreach(e->outputline(f, e...), take(drop(entries, 315), ntier3))
+        end
+    end
 end
 
-lines = eachline(io)
+# names that would break the generated C string literals, or that the
+# sysimg mode's strings(1) heuristic can't distinguish from line noise
+badname(name) = isempty(name) || contains(name, "\\") || contains(name, "\"") ||
+                any(isspace, name) || contains(name, "(") || contains(name, ")")
+
+if !isempty(ARGS) && ARGS[1] == "--profile"
+    ntier3 = 2048
+    files = String[]
+    for arg in ARGS[2:end]
+        if startswith(arg, "--tier3=")
+            ntier3 = parse(Int, arg[9:end])
+        else
+            push!(files, arg)
+        end
+    end
+    counts = Dict{String,Int}()
+    for fname in files
+        for line in eachline(fname)
+            row = split(line, " ", keep=false)
+            length(row) == 2 || continue
+            name = String(row[2])
+            badname(name) && continue
+            counts[name] = get(counts, name, 0) + parse(Int, row[1])
+        end
+    end
+    entries = sort!(collect(counts), by=e->e[2], rev=true)
+    writetables(map(e->(e[1], e[2]), entries), ntier3)
+else
+    fname = ARGS[1]
 
-open(f->foreach(l->outputline(f,l), take(lines,63)), "common_symbols1.inc", "w")
-open(f->foreach(l->outputline(f,l), lines), "common_symbols2.inc", "w")
+    io,_ = open(pipeline(`strings -n 3 $fname`,
+                         `tr -d "() \t+-"`,
+                         `grep -v '^$'`,  # rm empty lines
+                         `grep -v '\\'`,  # avoid backslashes
+                         `sort`, `uniq -c`, `sort -g -r`,
+                         `head -n 315`))  # 63 + 252; sysimg mode has no tier 3
+
+    entries = map(eachline(io)) do line
+        row = split(line, " ", keep=false)
+        (String(row[2]), parse(Int, row[1]))
+    end
+    writetables(entries, 0)
+end
@@ -1103,6 +1103,10 @@ struct ambiguous_matches_env {
     jl_typemap_entry_t *newentry;
     jl_value_t *shadowed;
     int after;
+    // batched insertion: entries of the same batch inserted after
+    // newentry, masked out here because their own pass analyzes the pair
+    jl_typemap_entry_t *const *skip;
+    size_t nskip;
 };
 const int eager_ambiguity_printing = 0;
 static int check_ambiguous_visitor(jl_typemap_entry_t *oldentry, struct typemap_intersection_env *closure0)
@@ -1112,6 +1116,11 @@ static int check_ambiguous_visitor(jl_typemap_entry_t *oldentry, struct typemap_
         closure->after = 1;
         return 1;
     }
+    size_t i;
+    for (i = 0; i < closure->nskip; i++) {
+        if (oldentry == closure->skip[i])
+            return 1;
+    }
     union jl_typemap_t map = closure->defs;
     jl_tupletype_t *type = (jl_tupletype_t*)closure->match.type;
     jl_method_t *m = closure->newentry->func.method;
@@ -1178,7 +1187,8 @@ static int check_ambiguous_visitor(jl_typemap_entry_t *oldentry, struct typemap_
     return 1;
 }
 
-static jl_value_t *check_ambiguous_matches(union jl_typemap_t defs, jl_typemap_entry_t *newentry)
+static jl_value_t *check_ambiguous_matches(union jl_typemap_t defs, jl_typemap_entry_t *newentry,
+                                           jl_typemap_entry_t *const *skip, size_t nskip)
 {
     jl_tupletype_t *type = newentry->sig;
     jl_tupletype_t *ttypes = (jl_tupletype_t*)jl_unwrap_unionall((jl_value_t*)type);
@@ -1201,6 +1211,8 @@ static jl_value_t *check_ambiguous_matches(union jl_typemap_t defs, jl_typemap_e
     env.newentry = newentry;
     env.shadowed = NULL;
     env.after = 0;
+    env.skip = skip;
+    env.nskip = nskip;
     JL_GC_PUSH3(&env.match.env, &env.match.ti, &env.shadowed);
     jl_typemap_intersection_visitor(defs, 0, &env.match);
     JL_GC_POP();
@@ -1362,26 +1374,30 @@ JL_DLLEXPORT void jl_method_table_add_backedge(jl_methtable_t *mt, jl_value_t *t
     JL_UNLOCK(&mt->writelock);
 }
 
-JL_DLLEXPORT void jl_method_table_insert(jl_methtable_t *mt, jl_method_t *method, jl_tupletype_t *simpletype)
+// the post-insertion half of method-table insertion: ambiguity analysis,
+// method-table backedge invalidation, and invalidation of the cached
+// specializations the new definition shadows. `oldvalue` is the
+// exact-signature method the entry replaced, if any (as returned by
+// jl_typemap_insert). Batched insertion masks the later members of its
+// batch via skip/nskip so every overlapping pair is analyzed exactly
+// once, by its later-inserted member - the same orientation eager
+// per-method insertion records. The caller holds mt->writelock.
+static void method_table_check_entry(jl_methtable_t *mt, jl_typemap_entry_t *newentry,
+                                     jl_value_t *oldvalue,
+                                     jl_typemap_entry_t *const *skip, size_t nskip)
 {
-    assert(jl_is_method(method));
-    assert(jl_is_mtable(mt));
+    jl_method_t *method = newentry->func.method;
     jl_value_t *type = method->sig;
-    jl_value_t *oldvalue = NULL;
     struct invalidate_conflicting_env env;
     env.invalidated = 0;
     env.max_world = method->min_world - 1;
     JL_GC_PUSH1(&oldvalue);
-    JL_LOCK(&mt->writelock);
-    jl_typemap_entry_t *newentry = jl_typemap_insert(&mt->defs, (jl_value_t*)mt,
-            (jl_tupletype_t*)type, simpletype, jl_emptysvec, (jl_value_t*)method, 0, &method_defs,
-            method->min_world, method->max_world, &oldvalue);
     if (oldvalue) {
         method->ambig = ((jl_method_t*)oldvalue)->ambig;
         method_overwrite(newentry, (jl_method_t*)oldvalue);
     }
     else {
-        oldvalue = check_ambiguous_matches(mt->defs, newentry);
+        oldvalue = check_ambiguous_matches(mt->defs, newentry, skip, nskip);
         if (mt->backedges) {
             jl_value_t **backedges = (jl_value_t**)jl_array_data(mt->backedges);
             size_t i, na = jl_array_len(mt->backedges);
@@ -1438,11 +1454,84 @@ JL_DLLEXPORT void jl_method_table_insert(jl_methtable_t *mt, jl_method_t *method
         jl_static_show(JL_STDOUT, (jl_value_t*)type);
         jl_uv_puts(JL_STDOUT, "\n", 1);
     }
-    update_max_args(mt, type);
+    JL_GC_POP();
+}
+
+JL_DLLEXPORT void jl_method_table_insert(jl_methtable_t *mt, jl_method_t *method, jl_tupletype_t *simpletype)
+{
+    assert(jl_is_method(method));
+    assert(jl_is_mtable(mt));
+    jl_value_t *oldvalue = NULL;
+    JL_GC_PUSH1(&oldvalue);
+    JL_LOCK(&mt->writelock);
+    jl_typemap_entry_t *newentry = jl_typemap_insert(&mt->defs, (jl_value_t*)mt,
+            (jl_tupletype_t*)method->sig, simpletype, jl_emptysvec, (jl_value_t*)method, 0, &method_defs,
+            method->min_world, method->max_world, &oldvalue);
+    method_table_check_entry(mt, newentry, oldvalue, NULL, 0);
+    update_max_args(mt, method->sig);
     JL_UNLOCK(&mt->writelock);
     JL_GC_POP();
 }
 
+// batched insertion for the loader (dump.c): make every definition of
+// the batch visible in the typemap first, then run the ambiguity
+// analysis and invalidation passes over the settled table, holding the
+// table lock once instead of once per method. Deserialized methods all
+// carry the same min_world, so the batch invalidates exactly the set of
+// entries eager per-method insertion would have invalidated.
+JL_DLLEXPORT void jl_method_table_insert_batch(jl_methtable_t *mt, jl_method_t **methods,
+                                               jl_tupletype_t **simpletypes, size_t n)
+{
+    assert(jl_is_mtable(mt));
+    if (n == 0)
+        return;
+    if (n == 1) {
+        jl_method_table_insert(mt, methods[0], simpletypes ? simpletypes[0] : NULL);
+        return;
+    }
+    jl_typemap_entry_t **entries = (jl_typemap_entry_t**)malloc(n * sizeof(jl_typemap_entry_t*));
+    jl_array_t *oldvalues = NULL;
+    jl_value_t *oldvalue = NULL;
+    JL_GC_PUSH2(&oldvalues, &oldvalue);
+    oldvalues = jl_alloc_vec_any(n);
+    JL_LOCK(&mt->writelock);
+    size_t i;
+    for (i = 0; i < n; i++) {
+        jl_method_t *method = methods[i];
+        assert(jl_is_method(method));
+        // the new entries are rooted through mt->defs from here on
+        entries[i] = jl_typemap_insert(&mt->defs, (jl_value_t*)mt,
+                (jl_tupletype_t*)method->sig, simpletypes ? simpletypes[i] : NULL,
+                jl_emptysvec, (jl_value_t*)method, 0, &method_defs,
+                method->min_world, method->max_world, &oldvalue);
+        jl_array_ptr_set(oldvalues, i, oldvalue);
+        oldvalue = NULL;
+        update_max_args(mt, method->sig);
+    }
+    for (i = 0; i < n; i++) {
+        method_table_check_entry(mt, entries[i], jl_array_ptr_ref(oldvalues, i),
+                                 &entries[i + 1], n - i - 1);
+    }
+    JL_UNLOCK(&mt->writelock);
+    JL_GC_POP();
+    free(entries);
+}
+
+// re-populate one dispatch-cache entry from a precompile file (dump.c).
+// the caller has already verified that linfo's method is still present in
+// mt for the current world; the entry becomes valid from min_world on.
+JL_DLLEXPORT void jl_method_table_insert_cached(jl_methtable_t *mt, jl_tupletype_t *type,
+                                                jl_tupletype_t *simpletype, jl_svec_t *guardsigs,
+                                                jl_method_instance_t *linfo, size_t min_world)
+{
+    JL_LOCK(&mt->writelock);
+    jl_typemap_insert(&mt->cache, (jl_value_t*)mt, type, simpletype, guardsigs,
+                      (jl_value_t*)linfo, jl_cachearg_offset(mt), &lambda_cache,
+                      min_world, linfo->max_world, NULL);
+    update_max_args(mt, type);
+    JL_UNLOCK(&mt->writelock);
+}
+
 void JL_NORETURN jl_method_error_bare(jl_function_t *f, jl_value_t *args, size_t world)
 {
     if (jl_methoderror_type) {
@@ -1843,7 +1932,9 @@ STATIC_INLINE jl_method_instance_t *jl_lookup_generic_(jl_value_t **args, uint32
     int i;
     // check each cache entry to see if it matches
     for (i = 0; i < 4; i++) {
-        entry = call_cache[cache_idx[i]];
+        // acquire pairs with the release store below, so an entry found
+        // here is fully visible even if another thread cached it
+        entry = jl_atomic_load_acquire(&call_cache[cache_idx[i]]);
         if (entry && nargs == jl_svec_len(entry->sig->parameters) &&
             sig_match_fast(args, jl_svec_data(entry->sig->parameters), 0, nargs) &&
             world >= entry->min_world && world <= entry->max_world) {
@@ -1859,7 +1950,7 @@ STATIC_INLINE jl_method_instance_t *jl_lookup_generic_(jl_value_t **args, uint32
         if (entry && entry->isleafsig && entry->simplesig == (void*)jl_nothing && entry->guardsigs == jl_emptysvec) {
             // put the entry into the cache if it's valid for a leaftype lookup,
             // using pick_which to slightly randomize where it ends up
-            call_cache[cache_idx[++pick_which[cache_idx[0]] & 3]] = entry;
+            jl_atomic_store_release(&call_cache[cache_idx[++pick_which[cache_idx[0]] & 3]], entry);
         }
     }
 
@@ -1914,6 +2005,64 @@ JL_DLLEXPORT jl_value_t *jl_apply_generic(jl_value_t **args, uint32_t nargs)
     return verify_type(res);
 }
 
+// --- per-call-site inline caches ---
+
+// codegen gives each dynamic call site it cannot devirtualize a small
+// private cache of the typemap entries it last dispatched to (see
+// emit_call in codegen.cpp). most such sites see the same couple of
+// concrete signatures over and over, so probing these before the full
+// lookup skips the hashing and collisions of the shared call_cache.
+// the registry keeps every cache rooted across method compilation.
+#define N_PIC_ENTRIES 3
+
+jl_array_t *jl_callsite_caches = NULL;
+
+JL_DLLEXPORT jl_value_t *jl_new_callsite_cache(void)
+{
+    // only called from codegen, under the codegen lock
+    jl_array_t *pic = jl_alloc_vec_any(N_PIC_ENTRIES);
+    JL_GC_PUSH1(&pic);
+    if (jl_callsite_caches == NULL)
+        jl_callsite_caches = jl_alloc_vec_any(0);
+    jl_array_ptr_1d_push(jl_callsite_caches, (jl_value_t*)pic);
+    JL_GC_POP();
+    return (jl_value_t*)pic;
+}
+
+JL_DLLEXPORT jl_value_t *jl_apply_generic_pic(jl_value_t *pic, jl_value_t **args, uint32_t nargs)
+{
+    size_t world = jl_get_ptls_states()->world_age;
+    jl_typemap_entry_t **entries = (jl_typemap_entry_t**)jl_array_data(pic);
+    jl_typemap_entry_t *entry;
+    int i;
+    for (i = 0; i < N_PIC_ENTRIES; i++) {
+        entry = jl_atomic_load_acquire(&entries[i]);
+        if (entry && nargs == jl_svec_len(entry->sig->parameters) &&
+            sig_match_fast(args, jl_svec_data(entry->sig->parameters), 0, nargs) &&
+            world >= entry->min_world && world <= entry->max_world) {
+            jl_value_t *res = jl_call_method_internal(entry->func.linfo, args, nargs);
+            return verify_type(res);
+        }
+    }
+    // probe the method-table cache once so a leafsig hit can be remembered
+    // here; anything else goes through the ordinary lookup
+    jl_methtable_t *mt = jl_gf_mtable(args[0]);
+    {
+        JL_TIMING(METHOD_LOOKUP_FAST);
+        entry = jl_typemap_assoc_exact(mt->cache, args, nargs, jl_cachearg_offset(mt), world);
+    }
+    if (entry == NULL)
+        return jl_apply_generic(args, nargs);
+    if (entry->isleafsig && entry->simplesig == (void*)jl_nothing && entry->guardsigs == jl_emptysvec) {
+        // rotate the victim so the 2-3 hot signatures of a site can coexist
+        static uint8_t pic_victim;
+        jl_atomic_store_release(&entries[pic_victim++ % N_PIC_ENTRIES], entry);
+        jl_gc_wb(pic, entry);
+    }
+    jl_value_t *res = jl_call_method_internal(entry->func.linfo, args, nargs);
+    return verify_type(res);
+}
+
 JL_DLLEXPORT jl_value_t *jl_gf_invoke_lookup(jl_datatype_t *types, size_t world)
 {
     jl_methtable_t *mt = ((jl_datatype_t*)jl_tparam0(types))->name->mt;
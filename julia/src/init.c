@@ -202,6 +202,7 @@ JL_DLLEXPORT void jl_atexit_hook(int exitcode)
         jl_write_coverage_data();
     if (jl_options.malloc_log)
         jl_write_malloc_log();
+    jl_dump_symtab_profile();
     if (jl_base_module) {
         jl_value_t *f = jl_get_global(jl_base_module, jl_symbol("_atexit"));
         if (f != NULL) {
@@ -380,6 +381,14 @@ static void *init_stdio_handle(uv_file fd,int readable)
 
 void init_stdio(void)
 {   //order must be 2,1,0
+    // deferred to the first time a stream is asked for (jl_st*_stream in
+    // sys.c): until then jl_printf output goes through the raw file
+    // descriptor fallback in jl_uv_puts, and batch runs that never touch
+    // stdio skip the libuv handle setup entirely
+    static int stdio_initialized = 0;
+    if (stdio_initialized)
+        return;
+    stdio_initialized = 1;
     JL_STDERR = (uv_stream_t*)init_stdio_handle(STDERR_FILENO,0);
     JL_STDOUT = (uv_stream_t*)init_stdio_handle(STDOUT_FILENO,0);
     JL_STDIN  = (uv_stream_t*)init_stdio_handle(STDIN_FILENO,1);
@@ -525,6 +534,7 @@ void _julia_init(JL_IMAGE_SEARCH rel)
     jl_ptls_t ptls = jl_get_ptls_states();
     jl_safepoint_init();
     libsupport_init();
+    jl_init_hrtime();
     ios_set_io_wait_func = jl_set_io_wait;
     jl_io_loop = uv_default_loop(); // this loop will internal events (spawning process etc.),
                                     // best to call this first, since it also initializes libuv
@@ -585,7 +595,9 @@ void _julia_init(JL_IMAGE_SEARCH rel)
 
 
 #if defined(__linux__)
-    int ncores = jl_cpu_cores();
+    // skipped under --minimal-init: short-lived batch workers neither
+    // want the syscall nor a widened affinity mask
+    int ncores = jl_options.minimal_init ? 1 : jl_cpu_cores();
     if (ncores > 1) {
         cpu_set_t cpumask;
         CPU_ZERO(&cpumask);
@@ -613,8 +625,10 @@ void _julia_init(JL_IMAGE_SEARCH rel)
     jl_root_task->timing_stack = jl_root_timing;
 #endif
 
-    init_stdio();
-    // libuv stdio cleanup depends on jl_init_tasks() because JL_TRY is used in jl_atexit_hook()
+    // the libuv stdio streams are built lazily, on the first
+    // jl_st*_stream call (Base's reinit_stdio triggers this when it
+    // runs); the first use must stay after jl_init_tasks() because
+    // libuv stdio cleanup uses JL_TRY in jl_atexit_hook()
 
     if ((jl_options.outputo || jl_options.outputbc) &&
         (jl_options.code_coverage || jl_options.malloc_log)) {
@@ -695,8 +709,10 @@ void _julia_init(JL_IMAGE_SEARCH rel)
         jl_all_tls_states[t]->root_task->current_module = ptls->current_module;
     }
 
-    // This needs to be after jl_start_threads
-    if (jl_options.handle_signals == JL_OPTIONS_HANDLE_SIGNALS_ON)
+    // This needs to be after jl_start_threads; with --minimal-init the
+    // handlers are deferred to jl_ensure_signal_handlers()
+    if (jl_options.handle_signals == JL_OPTIONS_HANDLE_SIGNALS_ON &&
+        !jl_options.minimal_init)
         jl_install_default_signal_handlers();
 
     jl_gc_enable(1);
@@ -713,7 +729,8 @@ void _julia_init(JL_IMAGE_SEARCH rel)
         JL_GC_POP();
     }
 
-    if (jl_options.handle_signals == JL_OPTIONS_HANDLE_SIGNALS_ON)
+    if (jl_options.handle_signals == JL_OPTIONS_HANDLE_SIGNALS_ON &&
+        !jl_options.minimal_init)
         jl_install_sigint_handler();
 }
 
@@ -588,7 +588,9 @@ static jl_value_t *eval_body(jl_array_t *stmts, interpreter_state *s, int start,
             }
             else if (head == enter_sym) {
                 jl_enter_handler(&__eh);
-                if (!jl_setjmp(__eh.eh_ctx,1)) {
+                // sigmask is invariant during normal execution (JL_TRY
+                // relies on this too), so don't pay sigprocmask here
+                if (!jl_setjmp(__eh.eh_ctx,0)) {
                     return eval_body(stmts, s, i + 1, toplevel);
                 }
                 else {
@@ -632,6 +634,618 @@ static jl_value_t *eval_body(jl_array_t *stmts, interpreter_state *s, int start,
     return NULL;
 }
 
+// --- bytecode interpreter tier ---
+//
+// Recursive tree-walking pays a C call and a chain of type tests per AST
+// node, which dominates the time spent in top-level and --compile=min
+// code. With JULIA_INTERP_BYTECODE set, method bodies and top-level
+// thunks are first flattened into a compact stack bytecode and run by a
+// computed-goto dispatch loop. Expression forms without an opcode fall
+// back to `eval` on the original AST node, and a body that cannot be
+// compiled at all runs through eval_body as before, so the observable
+// behavior (including error messages) is unchanged.
+
+#if defined(__GNUC__)
+#define BC_COMPUTED_GOTO
+#endif
+
+enum bc_opcode {
+    BC_LOAD_CONST,   // pool idx: push a constant
+    BC_LOAD_SLOT,    // 0-based slot: push, or throw UndefVarError
+    BC_LOAD_SSA,     // 0-based ssavalue: push
+    BC_LOAD_GLOBAL,  // pool idx (GlobalRef or Symbol): push, or throw
+    BC_LOAD_SPARAM,  // 1-based static parameter number: push
+    BC_LOAD_EXC,     // push the exception in transit
+    BC_STORE_SLOT,   // 0-based slot: pop into it
+    BC_STORE_SSA,    // 0-based ssavalue: pop into it
+    BC_STORE_GLOBAL, // pool idx (GlobalRef or Symbol): pop and assign
+    BC_NEWVAR,       // 0-based slot: clear it
+    BC_POP,          // drop the top of the stack
+    BC_CALL,         // nargs: pop nargs, push jl_apply_generic of them
+    BC_INVOKE,       // nargs, pool idx of the method instance
+    BC_NEW,          // nargs (type first): pop and construct
+    BC_GOTO,         // code offset
+    BC_GOTO_IFNOT,   // code offset: pop, branch if false
+    BC_RETURN,       // pop the result and return it
+    BC_ENTER,        // code offset of the catch block
+    BC_LEAVE,        // number of handlers to pop
+    BC_EVAL,         // pool idx: push eval() of the stored AST node
+    BC_TOPLEVEL,     // pool idx: push jl_toplevel_eval of the stored expr
+    BC_LINE,         // line number (toplevel only)
+    BC_WORLD,        // refresh the world age (toplevel only)
+    BC_NORETURN,     // fell off the end of the body
+    BC_NUM_OPS
+};
+
+typedef struct {
+    uint32_t *code;
+    size_t ncode;
+    size_t maxcode;
+    jl_array_t *pool;    // must be rooted by the caller
+    uint32_t maxstack;
+    // compile-time state
+    int depth;
+    int maxdepth;
+    int ok;
+} bc_t;
+
+static int bc_enabled(void)
+{
+    static int enabled = -1;
+    if (enabled == -1) {
+        const char *bc = getenv("JULIA_INTERP_BYTECODE");
+        enabled = bc && strcmp(bc, "0");
+    }
+    return enabled;
+}
+
+static void bc_emit(bc_t *bc, uint32_t word)
+{
+    if (bc->ncode == bc->maxcode) {
+        bc->maxcode = bc->maxcode ? bc->maxcode * 2 : 64;
+        bc->code = (uint32_t*)realloc(bc->code, bc->maxcode * sizeof(uint32_t));
+    }
+    bc->code[bc->ncode++] = word;
+}
+
+static uint32_t bc_poolidx(bc_t *bc, jl_value_t *v)
+{
+    jl_array_ptr_1d_push(bc->pool, v);
+    return (uint32_t)(jl_array_len(bc->pool) - 1);
+}
+
+static void bc_adjust_stack(bc_t *bc, int pop, int push)
+{
+    bc->depth += push - pop;
+    if (bc->depth > bc->maxdepth)
+        bc->maxdepth = bc->depth;
+}
+
+// compile `e` to code that pushes its value; always succeeds, since
+// anything without an opcode becomes BC_EVAL of the node itself
+static void bc_compile_operand(bc_t *bc, jl_value_t *e, jl_code_info_t *src)
+{
+    if (jl_is_ssavalue(e)) {
+        ssize_t id = ((jl_ssavalue_t*)e)->id;
+        if (id >= 0 && id < jl_source_nssavalues(src)) {
+            bc_emit(bc, BC_LOAD_SSA);
+            bc_emit(bc, (uint32_t)id);
+        }
+        else {
+            // let eval raise the invalid-SSAValue error
+            bc_emit(bc, BC_EVAL);
+            bc_emit(bc, bc_poolidx(bc, e));
+        }
+        bc_adjust_stack(bc, 0, 1);
+        return;
+    }
+    if (jl_is_slot(e)) {
+        ssize_t n = jl_slot_number(e);
+        if (n >= 1 && n <= jl_source_nslots(src)) {
+            bc_emit(bc, BC_LOAD_SLOT);
+            bc_emit(bc, (uint32_t)(n - 1));
+        }
+        else {
+            bc_emit(bc, BC_EVAL);
+            bc_emit(bc, bc_poolidx(bc, e));
+        }
+        bc_adjust_stack(bc, 0, 1);
+        return;
+    }
+    if (jl_is_globalref(e) || jl_is_symbol(e)) {
+        bc_emit(bc, BC_LOAD_GLOBAL);
+        bc_emit(bc, bc_poolidx(bc, e));
+        bc_adjust_stack(bc, 0, 1);
+        return;
+    }
+    if (jl_is_quotenode(e)) {
+        bc_emit(bc, BC_LOAD_CONST);
+        bc_emit(bc, bc_poolidx(bc, jl_fieldref(e, 0)));
+        bc_adjust_stack(bc, 0, 1);
+        return;
+    }
+    if (jl_is_expr(e)) {
+        jl_expr_t *ex = (jl_expr_t*)e;
+        jl_value_t **args = (jl_value_t**)jl_array_data(ex->args);
+        size_t i, nargs = jl_array_len(ex->args);
+        if (ex->head == call_sym) {
+            for (i = 0; i < nargs; i++)
+                bc_compile_operand(bc, args[i], src);
+            bc_emit(bc, BC_CALL);
+            bc_emit(bc, (uint32_t)nargs);
+            bc_adjust_stack(bc, nargs, 1);
+            return;
+        }
+        if (ex->head == invoke_sym && nargs > 0 && jl_is_method_instance(args[0])) {
+            for (i = 1; i < nargs; i++)
+                bc_compile_operand(bc, args[i], src);
+            bc_emit(bc, BC_INVOKE);
+            bc_emit(bc, (uint32_t)(nargs - 1));
+            bc_emit(bc, bc_poolidx(bc, args[0]));
+            bc_adjust_stack(bc, nargs - 1, 1);
+            return;
+        }
+        if (ex->head == new_sym) {
+            for (i = 0; i < nargs; i++)
+                bc_compile_operand(bc, args[i], src);
+            bc_emit(bc, BC_NEW);
+            bc_emit(bc, (uint32_t)nargs);
+            bc_adjust_stack(bc, nargs, 1);
+            return;
+        }
+        if (ex->head == static_parameter_sym && nargs == 1 && jl_is_long(args[0])) {
+            bc_emit(bc, BC_LOAD_SPARAM);
+            bc_emit(bc, (uint32_t)jl_unbox_long(args[0]));
+            bc_adjust_stack(bc, 0, 1);
+            return;
+        }
+        if (ex->head == exc_sym) {
+            bc_emit(bc, BC_LOAD_EXC);
+            bc_adjust_stack(bc, 0, 1);
+            return;
+        }
+        if (ex->head == inert_sym && nargs == 1) {
+            bc_emit(bc, BC_LOAD_CONST);
+            bc_emit(bc, bc_poolidx(bc, args[0]));
+            bc_adjust_stack(bc, 0, 1);
+            return;
+        }
+        if (ex->head == boundscheck_sym || ex->head == inbounds_sym ||
+            ex->head == fastmath_sym || ex->head == simdloop_sym ||
+            ex->head == meta_sym) {
+            bc_emit(bc, BC_LOAD_CONST);
+            bc_emit(bc, bc_poolidx(bc, jl_nothing));
+            bc_adjust_stack(bc, 0, 1);
+            return;
+        }
+        // method/const/typedef/copyast/... : evaluate the node generically
+        bc_emit(bc, BC_EVAL);
+        bc_emit(bc, bc_poolidx(bc, e));
+        bc_adjust_stack(bc, 0, 1);
+        return;
+    }
+    bc_emit(bc, BC_LOAD_CONST);
+    bc_emit(bc, bc_poolidx(bc, e));
+    bc_adjust_stack(bc, 0, 1);
+}
+
+// emit a jump operand that refers to the (0-based) statement `target`,
+// to be patched once all statement offsets are known
+static void bc_emit_jump(bc_t *bc, size_t target, size_t ns,
+                         size_t **fixups, size_t *nfixups, size_t *maxfixups)
+{
+    if (target > ns) {
+        bc->ok = 0;
+        bc_emit(bc, 0);
+        return;
+    }
+    if (*nfixups == *maxfixups) {
+        *maxfixups = *maxfixups ? *maxfixups * 2 : 16;
+        *fixups = (size_t*)realloc(*fixups, *maxfixups * sizeof(size_t));
+    }
+    (*fixups)[(*nfixups)++] = bc->ncode;
+    bc_emit(bc, (uint32_t)target);
+}
+
+static int bc_compile(bc_t *bc, jl_array_t *stmts, jl_code_info_t *src, int toplevel)
+{
+    size_t i, ns = jl_array_len(stmts);
+    size_t *stmt_pc = (size_t*)malloc((ns + 1) * sizeof(size_t));
+    size_t *fixups = NULL, nfixups = 0, maxfixups = 0;
+    for (i = 0; i < ns && bc->ok; i++) {
+        stmt_pc[i] = bc->ncode;
+        assert(bc->depth == 0);
+        if (toplevel)
+            bc_emit(bc, BC_WORLD);
+        jl_value_t *stmt = jl_array_ptr_ref(stmts, i);
+        if (jl_is_gotonode(stmt)) {
+            bc_emit(bc, BC_GOTO);
+            bc_emit_jump(bc, jl_gotonode_label(stmt) - 1, ns,
+                         &fixups, &nfixups, &maxfixups);
+        }
+        else if (jl_is_labelnode(stmt)) {
+            // labels only mark statement positions
+        }
+        else if (jl_is_linenode(stmt)) {
+            if (toplevel) {
+                bc_emit(bc, BC_LINE);
+                bc_emit(bc, (uint32_t)jl_linenode_line(stmt));
+            }
+        }
+        else if (jl_is_newvarnode(stmt)) {
+            jl_value_t *var = jl_fieldref(stmt, 0);
+            ssize_t n = jl_is_slot(var) ? jl_slot_number(var) : -1;
+            if (n < 1 || n > jl_source_nslots(src)) {
+                bc->ok = 0;
+                break;
+            }
+            bc_emit(bc, BC_NEWVAR);
+            bc_emit(bc, (uint32_t)(n - 1));
+        }
+        else if (jl_is_expr(stmt)) {
+            jl_expr_t *ex = (jl_expr_t*)stmt;
+            jl_sym_t *head = ex->head;
+            if (head == return_sym) {
+                jl_value_t *retex = jl_exprarg(stmt, 0);
+                if (toplevel && jl_is_toplevel_only_expr(retex)) {
+                    bc_emit(bc, BC_TOPLEVEL);
+                    bc_emit(bc, bc_poolidx(bc, retex));
+                    bc_adjust_stack(bc, 0, 1);
+                }
+                else {
+                    bc_compile_operand(bc, retex, src);
+                }
+                bc_emit(bc, BC_RETURN);
+                bc_adjust_stack(bc, 1, 0);
+            }
+            else if (head == assign_sym) {
+                jl_value_t *sym = jl_exprarg(stmt, 0);
+                bc_compile_operand(bc, jl_exprarg(stmt, 1), src);
+                if (jl_is_ssavalue(sym)) {
+                    ssize_t genid = ((jl_ssavalue_t*)sym)->id;
+                    if (genid < 0 || genid >= jl_source_nssavalues(src)) {
+                        bc->ok = 0;
+                        break;
+                    }
+                    bc_emit(bc, BC_STORE_SSA);
+                    bc_emit(bc, (uint32_t)genid);
+                }
+                else if (jl_is_slot(sym)) {
+                    ssize_t n = jl_slot_number(sym);
+                    if (n < 1 || n > jl_source_nslots(src)) {
+                        bc->ok = 0;
+                        break;
+                    }
+                    bc_emit(bc, BC_STORE_SLOT);
+                    bc_emit(bc, (uint32_t)(n - 1));
+                }
+                else if (jl_is_globalref(sym) || jl_is_symbol(sym)) {
+                    bc_emit(bc, BC_STORE_GLOBAL);
+                    bc_emit(bc, bc_poolidx(bc, sym));
+                }
+                else {
+                    bc->ok = 0;
+                    break;
+                }
+                bc_adjust_stack(bc, 1, 0);
+            }
+            else if (head == goto_ifnot_sym) {
+                jl_value_t *target = jl_exprarg(stmt, 1);
+                if (!jl_is_long(target)) {
+                    bc->ok = 0;
+                    break;
+                }
+                bc_compile_operand(bc, jl_exprarg(stmt, 0), src);
+                bc_emit(bc, BC_GOTO_IFNOT);
+                bc_emit_jump(bc, jl_unbox_long(target) - 1, ns,
+                             &fixups, &nfixups, &maxfixups);
+                bc_adjust_stack(bc, 1, 0);
+            }
+            else if (head == line_sym) {
+                if (toplevel && jl_expr_nargs(ex) > 0 && jl_is_long(jl_exprarg(stmt, 0))) {
+                    bc_emit(bc, BC_LINE);
+                    bc_emit(bc, (uint32_t)jl_unbox_long(jl_exprarg(stmt, 0)));
+                }
+            }
+            else if (head == enter_sym) {
+                jl_value_t *catchpc = jl_exprarg(stmt, 0);
+                if (!jl_is_long(catchpc)) {
+                    bc->ok = 0;
+                    break;
+                }
+                bc_emit(bc, BC_ENTER);
+                bc_emit_jump(bc, jl_unbox_long(catchpc) - 1, ns,
+                             &fixups, &nfixups, &maxfixups);
+            }
+            else if (head == leave_sym) {
+                jl_value_t *n = jl_exprarg(stmt, 0);
+                if (!jl_is_long(n)) {
+                    bc->ok = 0;
+                    break;
+                }
+                bc_emit(bc, BC_LEAVE);
+                bc_emit(bc, (uint32_t)jl_unbox_long(n));
+            }
+            else if (toplevel && jl_is_toplevel_only_expr(stmt)) {
+                bc_emit(bc, BC_TOPLEVEL);
+                bc_emit(bc, bc_poolidx(bc, stmt));
+                bc_emit(bc, BC_POP);
+            }
+            else {
+                bc_compile_operand(bc, stmt, src);
+                bc_emit(bc, BC_POP);
+                bc_adjust_stack(bc, 1, 0);
+            }
+        }
+        else {
+            bc_compile_operand(bc, stmt, src);
+            bc_emit(bc, BC_POP);
+            bc_adjust_stack(bc, 1, 0);
+        }
+    }
+    stmt_pc[ns] = bc->ncode;
+    bc_emit(bc, BC_NORETURN);
+    if (bc->ok) {
+        for (i = 0; i < nfixups; i++)
+            bc->code[fixups[i]] = (uint32_t)stmt_pc[bc->code[fixups[i]]];
+    }
+    free(stmt_pc);
+    free(fixups);
+    return bc->ok;
+}
+
+#ifdef BC_COMPUTED_GOTO
+#define BC_LABEL(op) L_##op
+#define BC_NEXT() goto *bc_dispatch[code[pc]]
+#else
+#define BC_LABEL(op) case BC_##op
+#define BC_NEXT() continue
+#endif
+
+static jl_value_t *bc_run(bc_t *bc, interpreter_state *s, size_t pc, int toplevel)
+{
+    jl_ptls_t ptls = jl_get_ptls_states();
+    uint32_t *code = bc->code;
+    size_t nslots = jl_source_nslots(s->src);
+    jl_value_t *res = NULL;
+    jl_value_t **stack;
+    size_t sp = 0;
+    JL_GC_PUSHARGS(stack, bc->maxstack);
+#ifdef BC_COMPUTED_GOTO
+    static void *bc_dispatch[BC_NUM_OPS] = {
+        &&L_LOAD_CONST, &&L_LOAD_SLOT, &&L_LOAD_SSA, &&L_LOAD_GLOBAL,
+        &&L_LOAD_SPARAM, &&L_LOAD_EXC, &&L_STORE_SLOT, &&L_STORE_SSA,
+        &&L_STORE_GLOBAL, &&L_NEWVAR, &&L_POP, &&L_CALL, &&L_INVOKE,
+        &&L_NEW, &&L_GOTO, &&L_GOTO_IFNOT, &&L_RETURN, &&L_ENTER,
+        &&L_LEAVE, &&L_EVAL, &&L_TOPLEVEL, &&L_LINE, &&L_WORLD,
+        &&L_NORETURN
+    };
+    BC_NEXT();
+#else
+    while (1) {
+        switch (code[pc]) {
+#endif
+    BC_LABEL(LOAD_CONST): {
+        stack[sp++] = jl_array_ptr_ref(bc->pool, code[pc + 1]);
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(LOAD_SLOT): {
+        jl_value_t *v = s->locals[code[pc + 1]];
+        if (v == NULL)
+            jl_undefined_var_error((jl_sym_t*)jl_array_ptr_ref(s->src->slotnames, code[pc + 1]));
+        stack[sp++] = v;
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(LOAD_SSA): {
+        stack[sp++] = s->locals[nslots + code[pc + 1]];
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(LOAD_GLOBAL): {
+        jl_value_t *ref = jl_array_ptr_ref(bc->pool, code[pc + 1]);
+        jl_sym_t *sym;
+        jl_module_t *m;
+        if (jl_is_globalref(ref)) {
+            m = jl_globalref_mod(ref);
+            sym = jl_globalref_name(ref);
+        }
+        else {
+            m = s->module;
+            sym = (jl_sym_t*)ref;
+        }
+        jl_value_t *v = jl_get_global(m, sym);
+        if (v == NULL)
+            jl_undefined_var_error(sym);
+        stack[sp++] = v;
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(LOAD_SPARAM): {
+        size_t n = code[pc + 1];
+        if (!s->sparam_vals || n > jl_svec_len(s->sparam_vals))
+            jl_error("could not determine static parameter value");
+        stack[sp++] = jl_svecref(s->sparam_vals, n - 1);
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(LOAD_EXC): {
+        stack[sp++] = ptls->exception_in_transit;
+        pc += 1;
+        BC_NEXT();
+    }
+    BC_LABEL(STORE_SLOT): {
+        s->locals[code[pc + 1]] = stack[--sp];
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(STORE_SSA): {
+        s->locals[nslots + code[pc + 1]] = stack[--sp];
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(STORE_GLOBAL): {
+        jl_value_t *ref = jl_array_ptr_ref(bc->pool, code[pc + 1]);
+        jl_sym_t *sym;
+        jl_module_t *m;
+        if (jl_is_globalref(ref)) {
+            m = jl_globalref_mod(ref);
+            sym = jl_globalref_name(ref);
+        }
+        else {
+            m = s->module;
+            sym = (jl_sym_t*)ref;
+        }
+        // the rhs stays rooted in the stack frame during the assignment
+        jl_binding_t *b = jl_get_binding_wr(m, sym);
+        jl_checked_assignment(b, stack[--sp]);
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(NEWVAR): {
+        s->locals[code[pc + 1]] = NULL;
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(POP): {
+        sp--;
+        pc += 1;
+        BC_NEXT();
+    }
+    BC_LABEL(CALL): {
+        size_t n = code[pc + 1];
+        jl_value_t *v = jl_apply_generic(&stack[sp - n], n);
+        sp -= n;
+        stack[sp++] = v;
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(INVOKE): {
+        size_t n = code[pc + 1];
+        jl_method_instance_t *meth =
+            (jl_method_instance_t*)jl_array_ptr_ref(bc->pool, code[pc + 2]);
+        assert(jl_is_method_instance(meth) && !meth->inInference);
+        jl_value_t *v = jl_call_method_internal(meth, &stack[sp - n], n);
+        sp -= n;
+        stack[sp++] = v;
+        pc += 3;
+        BC_NEXT();
+    }
+    BC_LABEL(NEW): {
+        size_t n = code[pc + 1];
+        jl_value_t *thetype = stack[sp - n];
+        assert(jl_is_structtype(thetype));
+        jl_value_t *v = jl_new_struct_uninit((jl_datatype_t*)thetype);
+        stack[sp - n] = v; // keeps the new object rooted
+        for (size_t i = 1; i < n; i++)
+            jl_set_nth_field(v, i - 1, stack[sp - n + i]);
+        sp -= n - 1;
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(GOTO): {
+        pc = code[pc + 1];
+        BC_NEXT();
+    }
+    BC_LABEL(GOTO_IFNOT): {
+        jl_value_t *cond = stack[--sp];
+        if (cond == jl_false) {
+            pc = code[pc + 1];
+        }
+        else if (cond != jl_true) {
+            jl_type_error_rt("toplevel", "if", (jl_value_t*)jl_bool_type, cond);
+        }
+        else {
+            pc += 2;
+        }
+        BC_NEXT();
+    }
+    BC_LABEL(RETURN): {
+        res = stack[--sp];
+        goto bc_done;
+    }
+    BC_LABEL(ENTER): {
+        // mirror eval_body: run the protected region in a recursive
+        // frame so each handler has its own setjmp context. pc and sp
+        // are not modified between the setjmp and a longjmp here.
+        jl_handler_t __eh;
+        jl_enter_handler(&__eh);
+        // as in eval_body: the sigmask never changes, skip sigprocmask
+        if (!jl_setjmp(__eh.eh_ctx, 0)) {
+            res = bc_run(bc, s, pc + 2, toplevel);
+            goto bc_done;
+        }
+        else {
+#ifdef _OS_WINDOWS_
+            if (ptls->exception_in_transit == jl_stackovf_exception)
+                _resetstkoflw();
+#endif
+            sp = 0;
+            pc = code[pc + 1];
+            BC_NEXT();
+        }
+    }
+    BC_LABEL(LEAVE): {
+        jl_pop_handler(code[pc + 1]);
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(EVAL): {
+        stack[sp++] = eval(jl_array_ptr_ref(bc->pool, code[pc + 1]), s);
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(TOPLEVEL): {
+        stack[sp++] = jl_toplevel_eval(jl_array_ptr_ref(bc->pool, code[pc + 1]));
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(LINE): {
+        jl_lineno = code[pc + 1];
+        pc += 2;
+        BC_NEXT();
+    }
+    BC_LABEL(WORLD): {
+        ptls->world_age = jl_world_counter;
+        pc += 1;
+        BC_NEXT();
+    }
+    BC_LABEL(NORETURN): {
+        jl_error("`body` expression must terminate in `return`. Use `block` instead.");
+    }
+#ifndef BC_COMPUTED_GOTO
+        default:
+            abort();
+        }
+    }
+#endif
+bc_done:
+    JL_GC_POP();
+    return res;
+}
+
+// returns NULL if the body could not be compiled; the caller then falls
+// back to eval_body
+static jl_value_t *bc_interpret_body(jl_array_t *stmts, interpreter_state *s, int toplevel)
+{
+    bc_t bc;
+    memset(&bc, 0, sizeof(bc));
+    jl_value_t *r = NULL;
+    jl_array_t *pool = jl_alloc_vec_any(0);
+    JL_GC_PUSH1(&pool);
+    bc.pool = pool;
+    bc.ok = 1;
+    bc.maxdepth = 1;
+    if (bc_compile(&bc, stmts, s->src, toplevel)) {
+        bc.maxstack = bc.maxdepth;
+        r = bc_run(&bc, s, 0, toplevel);
+    }
+    free(bc.code);
+    JL_GC_POP();
+    return r;
+}
+
 jl_value_t *jl_interpret_call(jl_method_instance_t *lam, jl_value_t **args, uint32_t nargs)
 {
     if (lam->jlcall_api == 2)
@@ -674,7 +1288,11 @@ jl_value_t *jl_interpret_call(jl_method_instance_t *lam, jl_value_t **args, uint
         else
             s.locals[i] = args[i];
     }
-    jl_value_t *r = eval_body(stmts, &s, 0, 0);
+    jl_value_t *r = NULL;
+    if (bc_enabled())
+        r = bc_interpret_body(stmts, &s, 0);
+    if (r == NULL)
+        r = eval_body(stmts, &s, 0, 0);
     JL_GC_POP();
     return r;
 }
@@ -692,7 +1310,11 @@ jl_value_t *jl_interpret_toplevel_thunk(jl_code_info_t *src)
     s.module = ptls->current_module;
     s.sparam_vals = jl_emptysvec;
     size_t last_age = jl_get_ptls_states()->world_age;
-    jl_value_t *r = eval_body(stmts, &s, 0, 1);
+    jl_value_t *r = NULL;
+    if (bc_enabled())
+        r = bc_interpret_body(stmts, &s, 1);
+    if (r == NULL)
+        r = eval_body(stmts, &s, 0, 1);
     jl_get_ptls_states()->world_age = last_age;
     JL_GC_POP();
     return r;
@@ -744,6 +744,144 @@ struct math_builder {
 static Value *emit_untyped_intrinsic(intrinsic f, Value **argvalues, size_t nargs,
                                      jl_codectx_t *ctx, jl_datatype_t **newtyp, jl_value_t *xtyp);
 
+// if `ty` is a leaf tuple type of 2 to 16 identical primitive types
+// (possibly wrapped in VecElement), return the element type, else NULL
+static jl_value_t *tuple_intrinsic_eltype(jl_value_t *ty)
+{
+    if (!jl_is_tuple_type(ty) || !jl_is_leaf_type(ty))
+        return NULL;
+    size_t nele = jl_nparams(ty);
+    if (nele < 2 || nele > 16)
+        return NULL;
+    for (size_t i = 1; i < nele; i++) {
+        if (jl_tparam(ty, i) != jl_tparam(ty, 0))
+            return NULL;
+    }
+    jl_value_t *ety = jl_tparam(ty, 0);
+    if (jl_is_vecelement_type(ety))
+        ety = jl_tparam0(ety);
+    if (!jl_is_primitivetype(ety))
+        return NULL;
+    return ety;
+}
+
+// elementwise intrinsics that are valid on LLVM vector operands: closed over
+// the operand type, no control flow, and cannot raise (which excludes the
+// checked and division families as well as sqrt_llvm's domain test)
+static bool intrinsic_vectorizable(intrinsic f)
+{
+    switch (f) {
+    case neg_int:
+    case add_int:
+    case sub_int:
+    case mul_int:
+    case and_int:
+    case or_int:
+    case xor_int:
+    case neg_float:
+    case add_float:
+    case sub_float:
+    case mul_float:
+    case div_float:
+    case neg_float_fast:
+    case add_float_fast:
+    case sub_float_fast:
+    case mul_float_fast:
+    case div_float_fast:
+    case fma_float:
+    case muladd_float:
+    case abs_float:
+    case ceil_llvm:
+    case floor_llvm:
+    case trunc_llvm:
+    case rint_llvm:
+    case sqrt_llvm_fast:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// reinterpret a homogeneous tuple value as an LLVM vector
+static Value *tuple_to_vector(VectorType *vt, const jl_cgval_t &x, jl_codectx_t *ctx)
+{
+    if (x.ispointer() && !x.constant) {
+        // the memory layouts agree, so load straight through a vector-typed
+        // pointer (the load inherits the tuple's smaller alignment)
+        return emit_unbox(vt, x, x.typ);
+    }
+    Value *agg = x.constant ? julia_const_to_llvm(x.constant) : x.V;
+    if (agg->getType()->isVectorTy()) {
+        // VecElement tuples are already vectors
+        if (agg->getType() != vt)
+            agg = builder.CreateBitCast(agg, vt);
+        return agg;
+    }
+    Value *vec = UndefValue::get(vt);
+    for (unsigned i = 0; i < vt->getNumElements(); i++) {
+        Value *el = builder.CreateExtractValue(agg, makeArrayRef(i));
+        if (el->getType() != vt->getElementType())
+            el = builder.CreateBitCast(el, vt->getElementType());
+        vec = builder.CreateInsertElement(vec, el, ConstantInt::get(T_int32, i));
+    }
+    return vec;
+}
+
+// convert a vector back to the tuple's native LLVM representation
+static Value *vector_to_tuple(Type *tt, Value *vec)
+{
+    if (tt->isVectorTy())
+        return vec->getType() == tt ? vec : builder.CreateBitCast(vec, tt);
+    ArrayType *at = cast<ArrayType>(tt);
+    Value *agg = UndefValue::get(at);
+    for (unsigned i = 0; i < at->getNumElements(); i++) {
+        Value *el = builder.CreateExtractElement(vec, ConstantInt::get(T_int32, i));
+        if (el->getType() != at->getElementType())
+            el = builder.CreateBitCast(el, at->getElementType());
+        agg = builder.CreateInsertValue(agg, el, makeArrayRef(i));
+    }
+    return agg;
+}
+
+// Emit elementwise arithmetic intrinsics over homogeneous bits-tuples as
+// LLVM vector operations. Code that uses NTuple{4,Float64}-style tuples as
+// geometric vectors then compiles directly to SIMD arithmetic instead of
+// either hitting the boxing runtime fallback or waiting for the SLP
+// vectorizer to reassemble scalar sequences.
+static jl_cgval_t emit_tuple_intrinsic(intrinsic f, const jl_cgval_t *argv, size_t nargs,
+                                       jl_codectx_t *ctx)
+{
+    const jl_cgval_t &xinfo = argv[0];
+    jl_value_t *ety = tuple_intrinsic_eltype(xinfo.typ);
+    if (!ety || !intrinsic_vectorizable(f))
+        return emit_runtime_call(f, argv, nargs, ctx);
+    for (size_t i = 1; i < nargs; ++i) {
+        if (argv[i].typ != xinfo.typ)
+            return emit_runtime_call(f, argv, nargs, ctx);
+    }
+    Type *elt = bitstype_to_llvm(ety);
+    if (float_func[f])
+        elt = FLOATT(elt);
+    else
+        elt = INTT(elt);
+    if (!elt || elt == T_int1)
+        return emit_runtime_call(f, argv, nargs, ctx);
+    VectorType *vt = VectorType::get(elt, jl_nparams(xinfo.typ));
+
+    Value **argvalues = (Value**)alloca(sizeof(Value*) * nargs);
+    for (size_t i = 0; i < nargs; ++i) {
+        argvalues[i] = tuple_to_vector(vt, argv[i], ctx);
+    }
+
+    jl_value_t *newtyp = NULL;
+    Value *r = emit_untyped_intrinsic(f, argvalues, nargs, ctx, (jl_datatype_t**)&newtyp, xinfo.typ);
+    assert(newtyp == NULL); // the vectorizable intrinsics are all type-preserving
+    bool isboxed;
+    Type *tt = julia_type_to_llvm(xinfo.typ, &isboxed);
+    assert(!isboxed);
+    return mark_julia_type(vector_to_tuple(tt, r), false, xinfo.typ, ctx);
+}
+
 static jl_cgval_t emit_intrinsic(intrinsic f, jl_value_t **args, size_t nargs,
                                  jl_codectx_t *ctx)
 {
@@ -858,7 +996,7 @@ static jl_cgval_t emit_intrinsic(intrinsic f, jl_value_t **args, size_t nargs,
 
         // verify argument types
         if (!jl_is_primitivetype(xinfo.typ))
-            return emit_runtime_call(f, argv, nargs, ctx);
+            return emit_tuple_intrinsic(f, argv, nargs, ctx);
         Type *xtyp = bitstype_to_llvm(xinfo.typ);
         if (float_func[f])
             xtyp = FLOATT(xtyp);
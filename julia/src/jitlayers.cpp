@@ -67,9 +67,14 @@ namespace llvm {
 
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/FormattedStream.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/Path.h>
 #include <llvm/ADT/StringMap.h>
 #include <llvm/ADT/StringSet.h>
 #include <llvm/ADT/SmallSet.h>
+#include <llvm/ADT/SmallPtrSet.h>
 #include "fix_llvm_assert.h"
 
 using namespace llvm;
@@ -104,12 +109,65 @@ void jl_init_jit(Type *T_pjlvalue_)
 
 // Except for parts of this file which were copied from LLVM, under the UIUC license (marked below).
 
+// Function multiversioning (JULIA_MULTIVERSIONING): clone @simd-loop
+// functions for AVX2 during optimization and bind each function's symbol
+// to the widest clone the executing host supports when the object is
+// linked (see DebugObjectRegistrar below).
+static bool jl_multiversioning_enabled(void)
+{
+    static int enabled = -1;
+    if (enabled == -1) {
+        const char *mv = getenv("JULIA_MULTIVERSIONING");
+        enabled = mv && strcmp(mv, "0");
+    }
+    return enabled;
+}
+
+// Whether this host can run the ".avx2" clones emitted by
+// createMultiVersioningPass; keep in sync with llvm-multiversioning.cpp.
+static bool jl_host_has_avx2(void)
+{
+    static int supported = -1;
+    if (supported == -1) {
+        StringMap<bool> features;
+        supported = 0;
+        if (sys::getHostCPUFeatures(features))
+            supported = features.lookup("avx2") && features.lookup("fma") &&
+                        features.lookup("bmi2");
+    }
+    return supported;
+}
+
+int jl_tier_up_in_progress = 0;
+
+// entry count at which tier-0 code requests a full recompile
+unsigned jl_tier_up_threshold(void)
+{
+    static int threshold = -1;
+    if (threshold == -1) {
+        const char *env = getenv("JULIA_TIER_UP_THRESHOLD");
+        threshold = env ? atoi(env) : 0;
+        if (threshold <= 0)
+            threshold = 1000;
+    }
+    return threshold;
+}
+
 // this defines the set of optimization passes defined for Julia at various optimization levels
 #if JL_LLVM_VERSION >= 30700
 void addOptimizationPasses(legacy::PassManager *PM)
 #else
 void addOptimizationPasses(PassManager *PM)
 #endif
+{
+    addOptimizationPasses(PM, jl_options.opt_level);
+}
+
+#if JL_LLVM_VERSION >= 30700
+void addOptimizationPasses(legacy::PassManager *PM, int opt_level)
+#else
+void addOptimizationPasses(PassManager *PM, int opt_level)
+#endif
 {
     PM->add(createLowerGCFramePass());
 #ifdef JL_DEBUG_BUILD
@@ -126,7 +184,7 @@ void addOptimizationPasses(PassManager *PM)
 #if defined(JL_MSAN_ENABLED)
     PM->add(llvm::createMemorySanitizerPass(true));
 #endif
-    if (jl_options.opt_level == 0) {
+    if (opt_level == 0) {
         PM->add(createCFGSimplificationPass()); // Clean up disgusting code
         PM->add(createMemCpyOptPass()); // Remove memcpy / form memset
         PM->add(createLowerPTLSPass(imaging_mode));
@@ -147,7 +205,7 @@ void addOptimizationPasses(PassManager *PM)
 #else
     PM->add(createTypeBasedAliasAnalysisPass());
 #endif
-    if (jl_options.opt_level >= 3) {
+    if (opt_level >= 3) {
 #if JL_LLVM_VERSION >= 30800
         PM->add(createBasicAAWrapperPass());
 #else
@@ -205,6 +263,8 @@ void addOptimizationPasses(PassManager *PM)
 #endif
     // LoopRotate strips metadata from terminator, so run LowerSIMD afterwards
     PM->add(createLowerSimdLoopPass());        // Annotate loop marked with "simdloop" as LLVM parallel loop
+    if (jl_multiversioning_enabled() && !imaging_mode)
+        PM->add(createMultiVersioningPass());  // Clone freshly annotated functions for wider ISAs
     PM->add(createLICMPass());                 // Hoist loop invariants
     PM->add(createLoopUnswitchPass());         // Unswitch loops.
     // Subsequent passes not stripping metadata from terminator
@@ -249,14 +309,14 @@ void addOptimizationPasses(PassManager *PM)
     PM->add(createJumpThreadingPass());         // Thread jumps
 
 #if JL_LLVM_VERSION >= 30500
-    if (jl_options.opt_level >= 3) {
+    if (opt_level >= 3) {
         PM->add(createSLPVectorizerPass());     // Vectorize straight-line code
     }
 #endif
 
     PM->add(createAggressiveDCEPass());         // Delete dead instructions
 #if JL_LLVM_VERSION >= 30500
-    if (jl_options.opt_level >= 3)
+    if (opt_level >= 3)
         PM->add(createInstructionCombiningPass());   // Clean up after SLP loop vectorizer
     PM->add(createLoopVectorizePass());         // Vectorize loops
     PM->add(createInstructionCombiningPass());  // Clean up after loop vectorizer
@@ -352,6 +412,21 @@ static uint64_t resolve_atomic(const char *name)
 }
 #endif
 
+// whether `name` is an IR-level function the JIT has compiled but not
+// yet linked (defined with module_for_fname below)
+static bool jl_is_pending_jit_function(StringRef name);
+#ifdef JL_HAVE_LAZY_JIT
+static void jl_finalize_function_by_name(StringRef F);
+
+// Jumped to by a compile callback stub when ORC cannot resolve it;
+// there is no frame worth returning to at that point.
+extern "C" void jl_lazy_jit_fatal(void)
+{
+    jl_safe_printf("fatal: lazy JIT compile callback failed\n");
+    abort();
+}
+#endif
+
 // Custom object emission notification handler for the JuliaOJIT
 extern JITEventListener *CreateJuliaJITEventListener();
 JuliaOJIT::DebugObjectRegistrar::DebugObjectRegistrar(JuliaOJIT &JIT)
@@ -409,6 +484,7 @@ void JuliaOJIT::DebugObjectRegistrar::operator()(RTDyldObjectLinkingLayerBase::O
 
         // record all of the exported symbols defined in this object
         // in the primary hash table for the enclosing JIT
+        SmallVector<std::pair<std::string, void*>, 4> VersionedSyms;
         for (auto &Symbol : Object->symbols()) {
             auto Flags = Symbol.getFlags();
             if (Flags & object::BasicSymbolRef::SF_Undefined)
@@ -423,7 +499,28 @@ void JuliaOJIT::DebugObjectRegistrar::operator()(RTDyldObjectLinkingLayerBase::O
             // note: calling getAddress here eagerly finalizes H
             // as an alternative, we could store the JITSymbol instead
             // (which would present a lazy-initializer functor interface instead)
-            JIT.LocalSymbolTable[Name] = (void*)(uintptr_t)Sym.getAddress();
+            void *addr = (void*)(uintptr_t)Sym.getAddress();
+#ifdef JL_HAVE_ASYNC_JIT_LINK
+            // taken after getAddress: finalization re-enters findSymbol
+            // through the resolver, which locks this itself
+            std::lock_guard<std::mutex> lock(JIT.LinkLock);
+#endif
+            JIT.LocalSymbolTable[Name] = addr;
+            if (jl_multiversioning_enabled() && Name.endswith(".avx2"))
+                VersionedSyms.push_back(std::make_pair(Name.str(), addr));
+        }
+        // resolve the ISA dispatch: when the host can run a function's
+        // AVX2 clone, publish the clone's address under the base name,
+        // so every later lookup binds straight to the wide version
+        if (jl_host_has_avx2()) {
+            for (size_t i = 0; i < VersionedSyms.size(); i++) {
+                StringRef Base = StringRef(VersionedSyms[i].first)
+                                     .drop_back(strlen(".avx2"));
+#ifdef JL_HAVE_ASYNC_JIT_LINK
+                std::lock_guard<std::mutex> lock(JIT.LinkLock);
+#endif
+                JIT.LocalSymbolTable[Base] = VersionedSyms[i].second;
+            }
         }
     }
 }
@@ -456,32 +553,7 @@ JuliaOJIT::JuliaOJIT(TargetMachine &TM)
     CompileLayer(
             ObjectLayer,
             [this](Module &M) {
-                JL_TIMING(LLVM_OPT);
-                PM.run(M);
-                std::unique_ptr<MemoryBuffer> ObjBuffer(
-                    new ObjectMemoryBuffer(std::move(ObjBufferSV)));
-                auto Obj = object::ObjectFile::createObjectFile(ObjBuffer->getMemBufferRef());
-
-                if (!Obj) {
-#if JL_LLVM_VERSION >= 50000
-                    M.print(llvm::dbgs(), nullptr, false, true);
-#else
-                    M.dump();
-#endif
-#if JL_LLVM_VERSION >= 30900
-                    std::string Buf;
-                    raw_string_ostream OS(Buf);
-                    logAllUnhandledErrors(Obj.takeError(), OS, "");
-                    OS.flush();
-                    llvm::report_fatal_error("FATAL: Unable to compile LLVM Module: '" + Buf + "'\n"
-                        "The module's content was printed above. Please file a bug report");
-#else
-                    llvm::report_fatal_error("FATAL: Unable to compile LLVM Module.\n"
-                        "The module's content was printed above. Please file a bug report");
-#endif
-                }
-
-                return OwningObj(std::move(*Obj), std::move(ObjBuffer));
+                return compileModule(M);
             }
         )
 {
@@ -501,10 +573,268 @@ JuliaOJIT::JuliaOJIT(TargetMachine &TM)
     std::string *ErrorStr = nullptr;
     if (sys::DynamicLibrary::LoadLibraryPermanently(nullptr, ErrorStr))
         report_fatal_error("FATAL: unable to dlopen self\n" + *ErrorStr);
+
+#ifdef JL_HAVE_LAZY_JIT
+    const char *lazy_jit = getenv("JULIA_LAZY_JIT");
+    if (lazy_jit && strcmp(lazy_jit, "0") && !jl_generating_output()) {
+        // Note: the callback manager has no internal locking in this
+        // LLVM; stub creation happens under the codegen lock, but two
+        // threads taking first calls into distinct unlinked functions
+        // at the same instant can race inside ORC. The CLI startup
+        // workloads this mode targets are single threaded.
+        CCMgr = orc::createLocalCompileCallbackManager(
+            TM.getTargetTriple(),
+            (orc::TargetAddress)(uintptr_t)&jl_lazy_jit_fatal);
+        if (CCMgr)
+            LazyJIT = true;
+    }
+#endif
+#ifdef JL_HAVE_ASYNC_JIT_LINK
+    const char *async_jit = getenv("JULIA_ASYNC_JIT");
+    if (async_jit && strcmp(async_jit, "0") && !jl_generating_output() &&
+        !usingLazyJIT()) { // lazy mode needs links on the locked thread
+        AsyncLink = true;
+        std::thread Worker([this] { linkWorkerLoop(); });
+        LinkWorkerId = Worker.get_id();
+        Worker.detach();
+    }
+#endif
+#ifdef JL_HAVE_JIT_CACHE
+    const char *jit_cache = getenv("JULIA_JIT_CACHE");
+    if (jit_cache && jit_cache[0] && !jl_generating_output() &&
+        // lazy mode leaves modules open (pending callee declarations)
+        // and async mode links off the codegen thread; both defeat the
+        // rename-and-republish step in addModule, so the cache requires
+        // plain synchronous linking
+        !usingLazyJIT() && !usingAsyncLink()) {
+        ObjCacheDir = jit_cache;
+        sys::fs::create_directories(ObjCacheDir);
+    }
+#endif
+#ifdef JL_HAVE_TIERED_JIT
+    const char *tiered = getenv("JULIA_TIERED_JIT");
+    if (tiered && strcmp(tiered, "0") && !jl_generating_output() &&
+        // compileModule picks the pipeline from which compile is
+        // currently running, which only lines up when compilation and
+        // linking stay synchronous on the locked thread
+        !usingLazyJIT() && !usingAsyncLink()) {
+        addOptimizationPasses(&PM0, 0);
+        if (TM.addPassesToEmitMC(PM0, Ctx0, ObjStream))
+            llvm_unreachable("Target does not support MC emission.");
+        TieredJIT = true;
+    }
+#endif
+}
+
+// Run the optimization pipeline over M and emit it to an in-memory
+// object file. The passes create constants and types in the shared
+// jl_LLVMContext, so the caller must hold the codegen lock.
+JuliaOJIT::OwningObj JuliaOJIT::compileModule(Module &M)
+{
+    JL_TIMING(LLVM_OPT);
+#ifdef JL_HAVE_JIT_CACHE
+    bool cache = CacheEligible;
+    CacheEligible = false;
+    SmallString<256> CachePath;
+    if (cache) {
+        objCachePath(M, CachePath);
+        // memory-map the cached object; RuntimeDyld copies the sections
+        // it needs into the executable mapping during linking, so the
+        // file pages stay read-only and shareable between processes
+        auto Cached = MemoryBuffer::getFile(CachePath.str(), -1, false);
+        if (Cached) {
+            auto CachedObj = object::ObjectFile::createObjectFile(
+                (*Cached)->getMemBufferRef());
+            if (CachedObj)
+                return OwningObj(std::move(*CachedObj), std::move(*Cached));
+            // truncated or incompatible entry: drop it and recompile
+            consumeError(CachedObj.takeError());
+            sys::fs::remove(CachePath.str());
+        }
+    }
+#endif
+#ifdef JL_HAVE_TIERED_JIT
+    // hot recompiles take the full pipeline; everything else starts out
+    // through the cheap tier-0 pipeline and earns its way back here
+    if (TieredJIT && !jl_tier_up_in_progress)
+        PM0.run(M);
+    else
+        PM.run(M);
+#else
+    PM.run(M);
+#endif
+    std::unique_ptr<MemoryBuffer> ObjBuffer(
+        new ObjectMemoryBuffer(std::move(ObjBufferSV)));
+    auto Obj = object::ObjectFile::createObjectFile(ObjBuffer->getMemBufferRef());
+
+    if (!Obj) {
+#if JL_LLVM_VERSION >= 50000
+        M.print(llvm::dbgs(), nullptr, false, true);
+#else
+        M.dump();
+#endif
+#if JL_LLVM_VERSION >= 30900
+        std::string Buf;
+        raw_string_ostream OS(Buf);
+        logAllUnhandledErrors(Obj.takeError(), OS, "");
+        OS.flush();
+        llvm::report_fatal_error("FATAL: Unable to compile LLVM Module: '" + Buf + "'\n"
+            "The module's content was printed above. Please file a bug report");
+#else
+        llvm::report_fatal_error("FATAL: Unable to compile LLVM Module.\n"
+            "The module's content was printed above. Please file a bug report");
+#endif
+    }
+
+#ifdef JL_HAVE_JIT_CACHE
+    if (cache)
+        writeObjCacheEntry(CachePath.str(), ObjBuffer->getBuffer());
+#endif
+    return OwningObj(std::move(*Obj), std::move(ObjBuffer));
+}
+
+#ifdef JL_HAVE_JIT_CACHE
+// Whether C (transitively) contains an inttoptr of an absolute address,
+// i.e. a pointer into this process baked into the IR as an integer.
+// Objects compiled from such IR are only valid in the emitting process.
+static bool embedsRawPointer(const Constant *C,
+                             SmallPtrSetImpl<const Constant*> &Seen)
+{
+    if (!Seen.insert(C).second)
+        return false;
+    if (const ConstantExpr *CE = dyn_cast<ConstantExpr>(C)) {
+        if (CE->getOpcode() == Instruction::IntToPtr)
+            return true;
+    }
+    for (unsigned i = 0, e = C->getNumOperands(); i != e; ++i) {
+        if (const Constant *Op = dyn_cast<Constant>(C->getOperand(i))) {
+            if (embedsRawPointer(Op, Seen))
+                return true;
+        }
+    }
+    return false;
+}
+
+// Whether the object emitted from M would be valid in another process.
+// jl_merge_recursive has already pulled the statically dispatched callee
+// tree into M, so any remaining declaration should name the runtime or
+// libc; a declaration that resolves through LocalSymbolTable instead
+// references earlier JIT output, whose names carry a process-unique
+// counter and would never match across runs.
+bool JuliaOJIT::objCacheSafe(Module &M)
+{
+    SmallPtrSet<const Constant*, 64> Seen;
+    for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I) {
+        Function *F = &*I;
+        if (F->isDeclaration()) {
+            if (!isIntrinsicFunction(F) &&
+                LocalSymbolTable.find(getMangledName(F)) != LocalSymbolTable.end())
+                return false;
+            continue;
+        }
+        for (Function::iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB) {
+            for (BasicBlock::iterator It = BB->begin(), IE = BB->end(); It != IE; ++It) {
+                for (User::op_iterator Op = It->op_begin(), OE = It->op_end(); Op != OE; ++Op) {
+                    if (const Constant *C = dyn_cast<Constant>(*Op)) {
+                        if (embedsRawPointer(C, Seen))
+                            return false;
+                    }
+                }
+            }
+        }
+    }
+    for (Module::global_iterator I = M.global_begin(), E = M.global_end(); I != E; ++I) {
+        GlobalVariable *G = &*I;
+        if (G->isDeclaration()) {
+            if (LocalSymbolTable.find(getMangledName(G)) != LocalSymbolTable.end())
+                return false;
+        }
+        else if (G->hasInitializer() && embedsRawPointer(G->getInitializer(), Seen)) {
+            return false;
+        }
+    }
+    return true;
 }
 
+// Cache key: target configuration plus the textual IR before
+// optimization. The pass manager fuses optimization and MC emission, so
+// the optimized IR is never observable separately; hashing the input IR
+// is equivalent as long as the pipeline and the target stay fixed, and
+// both are part of the key.
+void JuliaOJIT::objCachePath(Module &M, SmallVectorImpl<char> &Path)
+{
+    std::string Ir;
+    raw_string_ostream IrOS(Ir);
+    M.print(IrOS, nullptr);
+    IrOS.flush();
+    MD5 Hash;
+    MD5::MD5Result R;
+    Hash.update(TM.getTargetTriple().str());
+    Hash.update(TM.getTargetCPU());
+    Hash.update(TM.getTargetFeatureString());
+    Hash.update(Ir);
+    Hash.final(R);
+    SmallString<32> Hex;
+    MD5::stringifyResult(R, Hex);
+    Path.clear();
+    sys::path::append(Path, ObjCacheDir, Twine(Hex) + ".o");
+}
+
+void JuliaOJIT::writeObjCacheEntry(StringRef Path, StringRef Bytes)
+{
+    // write to a temporary and rename into place so that concurrent
+    // processes sharing the directory never observe a partial entry;
+    // every failure just means this entry is not cached
+    int FD;
+    SmallString<256> Tmp;
+    if (sys::fs::createUniqueFile(Twine(Path) + ".tmp.%%%%%%", FD, Tmp))
+        return;
+    {
+        raw_fd_ostream OS(FD, /*shouldClose*/ true);
+        OS << Bytes;
+    }
+    if (sys::fs::rename(Tmp, Path))
+        sys::fs::remove(Tmp);
+}
+#endif
+
+#ifdef JL_HAVE_ASYNC_JIT_LINK
+void JuliaOJIT::linkWorkerLoop(void)
+{
+    // This thread is invisible to the runtime: it is not in the thread
+    // list the collector stops, so it must stay permanently GC-safe.
+    // With gc_state preset, the jl_gc_safe_enter/leave pairs in the
+    // debuginfo callbacks become no-ops and never load the safepoint
+    // page (which this thread does not have).
+    jl_get_ptls_states()->gc_state = JL_GC_STATE_SAFE;
+    std::unique_lock<std::mutex> lk(LinkLock);
+    while (1) {
+        while (LinkQueue.empty())
+            LinkCV.wait(lk);
+        PendingLink L = std::move(LinkQueue.front());
+        LinkQueue.pop_front();
+        lk.unlock();
+        // Link outside the lock; the registrar and the resolver take it
+        // for individual table operations as needed
+        std::vector<std::unique_ptr<OwningObj>> ObjSet;
+        ObjSet.push_back(std::move(L.Obj));
+        auto H = ObjectLayer.addObjectSet(std::move(ObjSet), MemMgr,
+                                          std::move(L.Resolver));
+        ObjectLayer.emitAndFinalize(H);
+        lk.lock();
+        for (size_t i = 0; i < L.Names.size(); i++)
+            PendingSymbols.erase(L.Names[i]);
+        LinkCV.notify_all();
+    }
+}
+#endif
+
 void JuliaOJIT::addGlobalMapping(StringRef Name, uint64_t Addr)
 {
+#ifdef JL_HAVE_ASYNC_JIT_LINK
+    // the link worker reads this table through the resolver
+    std::lock_guard<std::mutex> lock(LinkLock);
+#endif
     bool successful = GlobalSymbolTable.insert(std::make_pair(Name, (void*)Addr)).second;
     (void)successful;
     assert(successful);
@@ -541,6 +871,9 @@ void JuliaOJIT::addModule(std::unique_ptr<Module> M)
                 F->eraseFromParent();
             else if (!(isIntrinsicFunction(F) ||
                        findUnmangledSymbol(F->getName()) ||
+                       // lazy mode: unlinked callees resolve to stubs
+                       (usingLazyJIT() &&
+                        jl_is_pending_jit_function(F->getName())) ||
                        SectionMemoryManager::getSymbolAddressInProcess(
                            getMangledName(F->getName())))) {
                 std::cerr << "FATAL ERROR: "
@@ -569,6 +902,16 @@ void JuliaOJIT::addModule(std::unique_ptr<Module> M)
                                                            Sym.getFlags());
 #endif
                         }
+#ifdef JL_HAVE_LAZY_JIT
+                        // Step 1.5: the symbol may be a Julia function
+                        // that is compiled but deliberately left
+                        // unlinked; bind the call site to a stub that
+                        // compiles it on first execution
+                        if (usingLazyJIT()) {
+                            if (uint64_t addr = lazyStubForPending(Name))
+                                return JL_SymbolInfo(addr, JITSymbolFlags::Exported);
+                        }
+#endif
                         // Step 2: Search the program symbols
                         if (uint64_t addr = SectionMemoryManager::getSymbolAddressInProcess(Name))
                             return JL_SymbolInfo(addr, JITSymbolFlags::Exported);
@@ -581,6 +924,69 @@ void JuliaOJIT::addModule(std::unique_ptr<Module> M)
                       },
                       [](const std::string &S) { return nullptr; }
                     );
+#ifdef JL_HAVE_ASYNC_JIT_LINK
+    if (AsyncLink) {
+        // Compile here (the optimizer and MC emission need the codegen
+        // lock the caller holds), but queue the object for the link
+        // worker; findSymbol blocks until the worker publishes the
+        // addresses of the names recorded below.
+        PendingLink L;
+        L.Resolver = std::move(Resolver);
+        for (Module::iterator I = M->begin(), E = M->end(); I != E; ++I) {
+            Function *F = &*I;
+            if (!F->isDeclaration() && !F->hasLocalLinkage())
+                L.Names.push_back(getMangledName(F));
+        }
+        for (Module::global_iterator I = M->global_begin(), E = M->global_end(); I != E; ++I) {
+            GlobalVariable *G = &*I;
+            if (!G->isDeclaration() && !G->hasLocalLinkage())
+                L.Names.push_back(getMangledName(G));
+        }
+        for (Module::alias_iterator I = M->alias_begin(), E = M->alias_end(); I != E; ++I) {
+            GlobalAlias *GA = &*I;
+            if (!GA->hasLocalLinkage())
+                L.Names.push_back(getMangledName(GA));
+        }
+        L.Obj.reset(new OwningObj(compileModule(*M)));
+        std::unique_lock<std::mutex> lk(LinkLock);
+        for (size_t i = 0; i < L.Names.size(); i++)
+            PendingSymbols.insert(L.Names[i]);
+        LinkQueue.push_back(std::move(L));
+        lk.unlock();
+        LinkCV.notify_all();
+        return;
+    }
+#endif
+#ifdef JL_HAVE_JIT_CACHE
+    // The specialized function names embed a process-unique counter, so
+    // neither the IR hash nor the symbols of a cached object would ever
+    // match across runs. Rename the defined globals to their position in
+    // the module before hashing and compiling, then republish the real
+    // names below once the object (fresh or cached) is linked.
+    std::vector<std::pair<std::string, std::string>> CacheRenames;
+    if (!ObjCacheDir.empty() && objCacheSafe(*M)) {
+        unsigned n = 0;
+        auto canonicalize = [&](GlobalValue *GV) {
+            std::string real = GV->getName().str();
+            std::string canon = ("jlcached." + Twine(n++)).str();
+            GV->setName(canon);
+            CacheRenames.push_back(std::make_pair(real, canon));
+        };
+        for (Module::iterator I = M->begin(), E = M->end(); I != E; ++I) {
+            if (!I->isDeclaration())
+                canonicalize(&*I);
+        }
+        for (Module::global_iterator I = M->global_begin(), E = M->global_end(); I != E; ++I) {
+            if (!I->isDeclaration())
+                canonicalize(&*I);
+        }
+        M->setModuleIdentifier("jlcached");
+#if JL_LLVM_VERSION >= 30900
+        M->setSourceFileName("jlcached");
+#endif
+        CacheEligible = true;
+    }
+#endif
     SmallVector<std::unique_ptr<Module>,1> Ms;
     Ms.push_back(std::move(M));
     auto modset = CompileLayer.addModuleSet(std::move(Ms), MemMgr,
@@ -588,6 +994,16 @@ void JuliaOJIT::addModule(std::unique_ptr<Module> M)
     // Force LLVM to emit the module so that we can register the symbols
     // in our lookup table.
     CompileLayer.emitAndFinalize(modset);
+#ifdef JL_HAVE_JIT_CACHE
+    // The registrar recorded the canonical names; alias the real ones
+    // to the same addresses so lookups by Julia-side name still work
+    for (size_t i = 0; i < CacheRenames.size(); i++) {
+        SymbolTableT::iterator pos =
+            LocalSymbolTable.find(getMangledName(CacheRenames[i].second));
+        if (pos != LocalSymbolTable.end())
+            LocalSymbolTable[getMangledName(CacheRenames[i].first)] = pos->second;
+    }
+#endif
 }
 
 void JuliaOJIT::removeModule(ModuleHandleT H)
@@ -598,6 +1014,25 @@ void JuliaOJIT::removeModule(ModuleHandleT H)
 JL_JITSymbol JuliaOJIT::findSymbol(const std::string &Name, bool ExportedSymbolsOnly)
 {
     void *Addr = nullptr;
+#ifdef JL_HAVE_ASYNC_JIT_LINK
+    std::unique_lock<std::mutex> lk(LinkLock, std::defer_lock);
+    if (AsyncLink) {
+        lk.lock();
+        if (std::this_thread::get_id() != LinkWorkerId &&
+            PendingSymbols.find(Name) != PendingSymbols.end()) {
+            // The object defining this symbol is still queued. Block on
+            // it alone (not on the whole queue), and do so in a GC-safe
+            // region so a collection elsewhere is not held up. The
+            // worker itself never waits: its resolver only looks up
+            // names from objects it already linked.
+            jl_ptls_t ptls = jl_get_ptls_states();
+            int8_t gc_state = jl_gc_safe_enter(ptls);
+            while (PendingSymbols.find(Name) != PendingSymbols.end())
+                LinkCV.wait(lk);
+            jl_gc_safe_leave(ptls, gc_state);
+        }
+    }
+#endif
     if (ExportedSymbolsOnly) {
         // Step 1: Check against list of known external globals
         Addr = getPointerToGlobalIfAvailable(Name);
@@ -792,6 +1227,11 @@ static void jl_merge_module(Module *dest, std::unique_ptr<Module> src)
 static StringMap<Module*> module_for_fname;
 static void jl_merge_recursive(Module *m, Module *collector);
 
+static bool jl_is_pending_jit_function(StringRef name)
+{
+    return module_for_fname.lookup(name) != NULL;
+}
+
 #if defined(USE_MCJIT) || defined(USE_ORCJIT)
 static void jl_add_to_ee(std::unique_ptr<Module> m)
 {
@@ -821,6 +1261,52 @@ void jl_finalize_function(Function *F)
         jl_add_to_ee(std::move(m));
     }
 }
+
+#ifdef JL_HAVE_LAZY_JIT
+// same as above, for when all we have is the IR-level name (the
+// compile callback of a lazy stub)
+static void jl_finalize_function_by_name(StringRef F)
+{
+    std::unique_ptr<Module> m(module_for_fname.lookup(F));
+    if (m) {
+        jl_merge_recursive(m.get(), m.get());
+        jl_add_to_ee(std::move(m));
+    }
+}
+
+// Return (creating it if needed) the address of a compile callback stub
+// for the mangled symbol `Name`, or 0 if it does not belong to a pending
+// JIT function. Runs under the codegen lock: in lazy mode links happen
+// on the requesting thread, so the resolver does too.
+uint64_t JuliaOJIT::lazyStubForPending(const std::string &Name)
+{
+    StringRef fname(Name);
+    if (DL.getGlobalPrefix() && !fname.empty() &&
+        fname.front() == DL.getGlobalPrefix())
+        fname = fname.drop_front();
+    if (!jl_is_pending_jit_function(fname))
+        return 0;
+    StringMap<uint64_t>::iterator it = LazyStubs.find(Name);
+    if (it != LazyStubs.end())
+        return it->second;
+    auto CCInfo = CCMgr->getCompileCallback();
+    std::string unmangled = fname.str();
+    CCInfo.setCompileAction([this, unmangled]() -> orc::TargetAddress {
+        // first execution of the stub: link the module that defines the
+        // function (plus anything it needs), then patch the stub over
+        // to the real entry point. Idempotent if two threads race here.
+        JL_LOCK(&codegen_lock);
+        jl_finalize_function_by_name(unmangled);
+        uint64_t addr = getFunctionAddress(unmangled);
+        JL_UNLOCK(&codegen_lock);
+        assert(addr && "lazy JIT stub could not resolve its function");
+        return (orc::TargetAddress)addr;
+    });
+    uint64_t addr = (uint64_t)CCInfo.getAddress();
+    LazyStubs[Name] = addr;
+    return addr;
+}
+#endif
 #else
 static bool jl_try_finalize(Module *m)
 {
@@ -862,6 +1348,12 @@ static void jl_merge_recursive(Module *m, Module *collector)
         }
     }
 
+#ifdef JL_HAVE_LAZY_JIT
+    // in lazy mode, leave callees parked in module_for_fname; the JIT
+    // resolver binds their call sites to compile-on-first-call stubs
+    if (jl_ExecutionEngine && jl_ExecutionEngine->usingLazyJIT())
+        return;
+#endif
     for (const auto F : to_finalize) {
         jl_finalize_function(F, collector);
     }
@@ -1111,6 +1603,18 @@ static void jl_gen_llvm_globaldata(llvm::Module *mod, ValueToValueMapTy &VMap,
                                  GlobalVariable::ExternalLinkage,
                                  ConstantInt::get(T_size, jltls_states_func_idx),
                                  "jl_ptls_states_getter_idx"));
+    // under JULIA_SYSIMG_STATIC_TLS the sysimg code addresses the TLS
+    // block of this executable directly (see llvm-ptls.cpp); record the
+    // offset it was baked with so the loader can reject the image if the
+    // executable's TLS layout ever moves
+    if (jl_sysimg_static_tls()) {
+        addComdat(new GlobalVariable(*mod,
+                                     T_size,
+                                     true,
+                                     GlobalVariable::ExternalLinkage,
+                                     ConstantInt::get(T_size, (size_t)jl_tls_offset),
+                                     "jl_sysimg_tls_offset"));
+    }
 #endif
 
     Constant *feature_string = ConstantDataArray::getString(jl_LLVMContext, jl_options.cpu_target);
@@ -6,9 +6,17 @@
 #include <llvm/IR/Value.h>
 
 #include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <llvm/ADT/StringSet.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #if defined(USE_ORCJIT)
 #include "llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
 #include "llvm/ExecutionEngine/Orc/LambdaResolver.h"
 #include "llvm/ExecutionEngine/Orc/LazyEmittingLayer.h"
 #if JL_LLVM_VERSION >= 50000
@@ -61,8 +69,10 @@ typedef struct {Value *gv; int32_t index;} jl_value_llvm; // uses 1-based indexi
 
 #if JL_LLVM_VERSION >= 30700
 void addOptimizationPasses(legacy::PassManager *PM);
+void addOptimizationPasses(legacy::PassManager *PM, int opt_level);
 #else
 void addOptimizationPasses(PassManager *PM);
+void addOptimizationPasses(PassManager *PM, int opt_level);
 #endif
 void* jl_emit_and_add_to_shadow(GlobalVariable *gv, void *gvarinit = NULL);
 GlobalVariable *jl_emit_sysimg_slot(Module *m, Type *typ, const char *name,
@@ -159,15 +169,50 @@ static inline void add_named_global(GlobalValue *gv, T *addr, bool dllimport = t
 
 void jl_init_jit(Type *T_pjlvalue_);
 #ifdef USE_ORCJIT
+// Background object linking (JULIA_ASYNC_JIT): the optimizer and MC
+// emission share jl_LLVMContext with codegen and have to stay under the
+// codegen lock, but RuntimeDyld only sees the finished object bytes, so
+// linking and finalization can run on a worker thread while other
+// threads keep compiling. Needs per-thread TLS for the worker's GC
+// state, hence the threading requirement.
+#if defined(JULIA_ENABLE_THREADING) && JL_LLVM_VERSION >= 30900
+#define JL_HAVE_ASYNC_JIT_LINK
+#endif
+// Lazy callee linking (JULIA_LAZY_JIT): normally finalizing a function
+// drags its whole statically-dispatched callee tree into the object and
+// compiles it up front; in lazy mode unlinked callees resolve to ORC
+// compile callback stubs that compile on first execution and patch
+// themselves. The callback ABI support and manager interface moved
+// around after 3.9, so this is pinned to the LLVM we actually build.
+#if JL_LLVM_VERSION >= 30900 && JL_LLVM_VERSION < 40000 && defined(_CPU_X86_64_)
+#define JL_HAVE_LAZY_JIT
+#endif
+// Persistent object cache (JULIA_JIT_CACHE=dir): reuse emitted object
+// files across processes, for modules whose bits are provably process
+// independent (no raw pointers baked into the IR, no references to
+// process-uniquely named JIT symbols).
+#if JL_LLVM_VERSION >= 30900
+#define JL_HAVE_JIT_CACHE
+#endif
+// Tiered compilation (JULIA_TIERED_JIT): run first-time compiles
+// through a minimal pipeline to cut warmup latency, count entries into
+// the emitted code, and recompile a method through the full pipeline
+// once it has proven hot (JULIA_TIER_UP_THRESHOLD entries, default
+// 1000). The pipeline choice in compileModule keys off which compile
+// is currently running, so this requires synchronous in-process
+// linking and is mutually exclusive with the lazy and async modes.
+#define JL_HAVE_TIERED_JIT
 #if JL_LLVM_VERSION >= 40000
 typedef JITSymbol JL_JITSymbol;
 // The type that is similar to SymbolInfo on LLVM 4.0 is actually
 // `JITEvaluatedSymbol`. However, we only use this type when a JITSymbol
 // is expected.
 typedef JITSymbol JL_SymbolInfo;
+typedef JITSymbolResolver JL_SymbolResolver;
 #else
 typedef orc::JITSymbol JL_JITSymbol;
 typedef RuntimeDyld::SymbolInfo JL_SymbolInfo;
+typedef RuntimeDyld::SymbolResolver JL_SymbolResolver;
 #endif
 #if JL_LLVM_VERSION >= 50000
 using orc::RTDyldObjectLinkingLayerBase;
@@ -217,9 +262,49 @@ public:
     void RegisterJITEventListener(JITEventListener *L);
     const DataLayout& getDataLayout() const;
     const Triple& getTargetTriple() const;
+    bool usingAsyncLink() const {
+#ifdef JL_HAVE_ASYNC_JIT_LINK
+        return AsyncLink;
+#else
+        return false;
+#endif
+    }
+    bool usingLazyJIT() const {
+#ifdef JL_HAVE_LAZY_JIT
+        return LazyJIT;
+#else
+        return false;
+#endif
+    }
+    bool usingTieredJIT() const {
+#ifdef JL_HAVE_TIERED_JIT
+        return TieredJIT;
+#else
+        return false;
+#endif
+    }
 private:
     std::string getMangledName(const std::string &Name);
     std::string getMangledName(const GlobalValue *GV);
+    OwningObj compileModule(Module &M);
+#ifdef JL_HAVE_JIT_CACHE
+    bool objCacheSafe(Module &M);
+    void objCachePath(Module &M, SmallVectorImpl<char> &Path);
+    void writeObjCacheEntry(StringRef Path, StringRef Bytes);
+#endif
+#ifdef JL_HAVE_LAZY_JIT
+    uint64_t lazyStubForPending(const std::string &Name);
+#endif
+#ifdef JL_HAVE_ASYNC_JIT_LINK
+    // A compiled object waiting for the link worker, together with the
+    // names it will define so findSymbol knows what to wait for
+    struct PendingLink {
+        std::unique_ptr<OwningObj> Obj;
+        std::unique_ptr<JL_SymbolResolver> Resolver;
+        std::vector<std::string> Names;
+    };
+    void linkWorkerLoop(void);
+#endif
 
     TargetMachine &TM;
     const DataLayout DL;
@@ -234,6 +319,38 @@ private:
     CompileLayerT CompileLayer;
     SymbolTableT GlobalSymbolTable;
     SymbolTableT LocalSymbolTable;
+#ifdef JL_HAVE_JIT_CACHE
+    // on-disk object cache directory (empty = disabled); CacheEligible
+    // is set by addModule for the module it is about to hand to the
+    // compile layer, under the codegen lock
+    std::string ObjCacheDir;
+    bool CacheEligible = false;
+#endif
+#ifdef JL_HAVE_TIERED_JIT
+    // tier-0 pipeline (optimization level 0 plus MC emission into the
+    // shared ObjStream); only populated when TieredJIT is enabled
+    legacy::PassManager PM0;
+    MCContext *Ctx0;
+    bool TieredJIT = false;
+#endif
+#ifdef JL_HAVE_LAZY_JIT
+    // compile-on-first-call stubs, keyed by mangled symbol name; all
+    // access is under the codegen lock (lazy mode implies sync linking)
+    bool LazyJIT = false;
+    std::unique_ptr<orc::JITCompileCallbackManager> CCMgr;
+    StringMap<uint64_t> LazyStubs;
+#endif
+#ifdef JL_HAVE_ASYNC_JIT_LINK
+    // LinkLock guards the symbol tables, the queue and the pending set;
+    // the worker takes it only for queue/table operations, never across
+    // a whole link, so findSymbol waiters make progress
+    bool AsyncLink = false;
+    std::thread::id LinkWorkerId;
+    std::mutex LinkLock;
+    std::condition_variable LinkCV;
+    std::deque<PendingLink> LinkQueue;
+    StringSet<> PendingSymbols;
+#endif
 };
 extern JuliaOJIT *jl_ExecutionEngine;
 #else
@@ -247,6 +364,14 @@ JL_DLLEXPORT extern LLVMContext &jl_LLVMContext;
 
 Pass *createLowerPTLSPass(bool imaging_mode);
 Pass *createLowerGCFramePass();
+Pass *createMultiVersioningPass();
+// whether sysimg code addresses thread-local state directly (llvm-ptls.cpp)
+bool jl_sysimg_static_tls(void);
+// tiered JIT: nonzero while a hot method is being recompiled through the
+// full pipeline (all access is under the codegen lock)
+extern int jl_tier_up_in_progress;
+// entry count at which tier-0 code requests recompilation
+unsigned jl_tier_up_threshold(void);
 // Whether the Function is an llvm or julia intrinsic.
 static inline bool isIntrinsicFunction(Function *F)
 {
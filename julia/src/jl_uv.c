@@ -175,8 +175,16 @@ static void jl_proc_exit_cleanup(uv_process_t *process, int64_t exit_status, int
     uv_close((uv_handle_t*)process, (uv_close_cb)&free);
 }
 
+static void jl_uv_wbatch_drain(uv_handle_t *handle);
+
 JL_DLLEXPORT void jl_close_uv(uv_handle_t *handle)
 {
+    if (handle->type == UV_NAMED_PIPE || handle->type == UV_TCP ||
+        handle->type == UV_TTY) {
+        // queue any batched output ahead of the shutdown request
+        jl_uv_wbatch_drain(handle);
+    }
+
     if (handle->type == UV_PROCESS && ((uv_process_t*)handle)->pid != 0) {
         // take ownership of this handle,
         // so we can waitpid for the resource to exit and avoid leaving zombies
@@ -233,6 +241,7 @@ JL_DLLEXPORT void jl_close_uv(uv_handle_t *handle)
 
 JL_DLLEXPORT void jl_forceclose_uv(uv_handle_t *handle)
 {
+    jl_uv_wbatch_drain(handle); // queued ahead of the close, or canceled by it
     uv_close(handle, &jl_uv_closeHandle);
 }
 
@@ -404,14 +413,138 @@ JL_DLLEXPORT int jl_fs_close(int handle)
     return ret;
 }
 
+// --- batched stream writes ---------------------------------------------------
+// Consecutive writes to the same libuv stream within one event-loop tick are
+// coalesced into a single write request: each write appends to a per-stream
+// pending buffer, and a uv_prepare hook (which runs once per loop iteration,
+// just before the loop would block) submits the accumulated bytes as one
+// uv_write. Line-oriented output thus costs one syscall per tick instead of
+// one per line. Caller write requests are notified from the completion of
+// the batched write, preserving the backpressure behavior of plain uv_write.
+
+typedef struct jl_uv_wbatch_s {
+    uv_stream_t *stream;
+    ios_t buf;        // pending bytes (growing mem stream)
+    arraylist_t reqs; // (uv_write_t*, uv_write_cb) pairs awaiting completion
+    struct jl_uv_wbatch_s *next;
+} jl_uv_wbatch_t;
+
+static jl_uv_wbatch_t *wbatch_pending = NULL; // batches open in this tick
+static uv_prepare_t wbatch_prepare;
+static int wbatch_prepare_started = 0;
+
+// flush a batch early once this much is pending
+#define WBATCH_MAX_PENDING (1 << 16)
+
+static void jl_uv_wbatch_writecb(uv_write_t *req, int status)
+{
+    jl_uv_wbatch_t *b = (jl_uv_wbatch_t*)req->data;
+    if (status < 0) {
+        jl_safe_printf("jl_uv_wbatch_writecb() ERROR: %s %s\n",
+                       uv_strerror(status), uv_err_name(status));
+    }
+    for (size_t i = 0; i < b->reqs.len; i += 2) {
+        uv_write_t *uvw = (uv_write_t*)b->reqs.items[i];
+        uv_write_cb cb = (uv_write_cb)b->reqs.items[i + 1];
+        if (cb)
+            cb(uvw, status);
+    }
+    arraylist_free(&b->reqs);
+    ios_close(&b->buf);
+    free(b);
+    free(req);
+}
+
+static void jl_uv_wbatch_flush(jl_uv_wbatch_t *b)
+{
+    jl_uv_wbatch_t **p = &wbatch_pending;
+    while (*p != b)
+        p = &(*p)->next;
+    *p = b->next;
+    uv_write_t *req = (uv_write_t*)malloc(sizeof(uv_write_t));
+    req->data = b;
+    uv_buf_t buf[1];
+    // the mem stream buffer stays put until ios_close in the completion cb
+    buf[0].base = b->buf.buf;
+    buf[0].len = (size_t)b->buf.size;
+    int status = uv_write(req, b->stream, buf, 1, jl_uv_wbatch_writecb);
+    if (status < 0)
+        jl_uv_wbatch_writecb(req, status);
+}
+
+static void jl_uv_wbatch_tick(uv_prepare_t *t)
+{
+    (void)t;
+    JL_SIGATOMIC_BEGIN();
+    while (wbatch_pending)
+        jl_uv_wbatch_flush(wbatch_pending);
+    JL_SIGATOMIC_END();
+}
+
+// find or open the pending batch for `stream`; returns NULL if the stream
+// cannot be batched and the caller should write directly
+static jl_uv_wbatch_t *jl_uv_wbatch_get(uv_stream_t *stream)
+{
+    if (jl_io_loop == NULL || !uv_is_writable(stream) ||
+        uv_is_closing((uv_handle_t*)stream))
+        return NULL;
+    if (!wbatch_prepare_started) {
+        if (uv_prepare_init(jl_io_loop, &wbatch_prepare))
+            return NULL;
+        uv_prepare_start(&wbatch_prepare, jl_uv_wbatch_tick);
+        // the flush hook must not keep an otherwise idle loop alive
+        uv_unref((uv_handle_t*)&wbatch_prepare);
+        wbatch_prepare_started = 1;
+    }
+    jl_uv_wbatch_t *b = wbatch_pending;
+    while (b && b->stream != stream)
+        b = b->next;
+    if (b == NULL) {
+        b = (jl_uv_wbatch_t*)malloc(sizeof(jl_uv_wbatch_t));
+        if (b == NULL)
+            return NULL;
+        b->stream = stream;
+        ios_mem(&b->buf, 0);
+        arraylist_new(&b->reqs, 0);
+        b->next = wbatch_pending;
+        wbatch_pending = b;
+    }
+    return b;
+}
+
+// flush any bytes pending for `stream` ahead of shutdown/close so they are
+// queued before the shutdown request
+static void jl_uv_wbatch_drain(uv_handle_t *handle)
+{
+    jl_uv_wbatch_t *b = wbatch_pending;
+    while (b && (uv_handle_t*)b->stream != handle)
+        b = b->next;
+    if (b)
+        jl_uv_wbatch_flush(b);
+}
+
 JL_DLLEXPORT int jl_uv_write(uv_stream_t *stream, const char *data, size_t n,
                              uv_write_t *uvw, void *writecb)
 {
-    uv_buf_t buf[1];
-    buf[0].base = (char*)data;
-    buf[0].len = n;
     JL_SIGATOMIC_BEGIN();
-    int err = uv_write(uvw,stream,buf,1,(uv_write_cb)writecb);
+    jl_uv_wbatch_t *b = jl_uv_wbatch_get(stream);
+    int err = 0;
+    if (b) {
+        ios_write(&b->buf, data, n);
+        // uv_write would have recorded the handle; callers reach it through
+        // jl_uv_write_handle
+        uvw->handle = stream;
+        arraylist_push(&b->reqs, (void*)uvw);
+        arraylist_push(&b->reqs, writecb);
+        if (b->buf.size >= WBATCH_MAX_PENDING)
+            jl_uv_wbatch_flush(b);
+    }
+    else {
+        uv_buf_t buf[1];
+        buf[0].base = (char*)data;
+        buf[0].len = n;
+        err = uv_write(uvw,stream,buf,1,(uv_write_cb)writecb);
+    }
     JL_SIGATOMIC_END();
     return err;
 }
@@ -456,6 +589,15 @@ JL_DLLEXPORT void jl_uv_puts(uv_stream_t *stream, const char *str, size_t n)
     }
     else {
         // Write to libuv stream...
+        JL_SIGATOMIC_BEGIN();
+        jl_uv_wbatch_t *b = jl_uv_wbatch_get(stream);
+        if (b) {
+            ios_write(&b->buf, str, n);
+            if (b->buf.size >= WBATCH_MAX_PENDING)
+                jl_uv_wbatch_flush(b);
+            JL_SIGATOMIC_END();
+            return;
+        }
         uv_write_t *req = (uv_write_t*)malloc(sizeof(uv_write_t)+n);
         char *data = (char*)(req+1);
         memcpy(data,str,n);
@@ -463,7 +605,6 @@ JL_DLLEXPORT void jl_uv_puts(uv_stream_t *stream, const char *str, size_t n)
         buf[0].base = data;
         buf[0].len = n;
         req->data = NULL;
-        JL_SIGATOMIC_BEGIN();
         int status = uv_write(req, stream, buf, 1, (uv_write_cb)jl_uv_writecb);
         JL_SIGATOMIC_END();
         if (status < 0) {
@@ -70,7 +70,14 @@ jl_options_t jl_options = { 0,    // quiet
                             NULL, // output-o
                             NULL, // output-ji
                             0, // incremental
-                            0 // image_file_specified
+                            0, // image_file_specified
+                            0, // minimal_init
+                            0, // gc_threads
+                            0, // gc_heap_init
+                            0, // gc_heap_max
+                            0, // gc_pause_target
+                            JL_OPTIONS_GC_PAGE_RETURN_DEFAULT,
+                            0, // gc_heap_limit
 };
 
 static const char usage[] = "julia [switches] -- [programfile] [args...]\n";
@@ -84,7 +91,9 @@ static const char opts[]  =
     " --compilecache={yes|no}   Enable/disable incremental precompilation of modules\n"
     " -H, --home <dir>          Set location of `julia` executable\n"
     " --startup-file={yes|no}   Load ~/.juliarc.jl\n"
-    " --handle-signals={yes|no} Enable or disable Julia's default signal handlers\n\n"
+    " --handle-signals={yes|no} Enable or disable Julia's default signal handlers\n"
+    " --minimal-init={yes|no}   Defer signal-handler and stdio-stream setup to first use;\n"
+    "                           shaves startup latency for batch and embedded uses\n\n"
 
     // actions
     " -e, --eval <expr>         Evaluate <expr>\n"
@@ -133,8 +142,41 @@ static const char opts[]  =
     "                           Count executions of source lines (omitting setting is equivalent to \"user\")\n"
     " --track-allocation={none|user|all}, --track-allocation\n"
     "                           Count bytes allocated by each source line\n\n"
+
+    // garbage collector options
+    " --gc-threads=<n>          Use <n> threads for parallel marking and sweeping\n"
+    " --gc-heap-init=<size>     Initial heap growth before a collection is triggered,\n"
+    "                           in bytes with an optional K/M/G suffix\n"
+    " --gc-heap-max=<size>      Upper bound on the growth between collections\n"
+    " --gc-pause-target=<ms>    Pace collections toward pauses of <ms> milliseconds\n"
+    " --gc-page-return={keep|lazy}\n"
+    "                           Keep freed GC pages committed for reuse, or let the\n"
+    "                           kernel reclaim them lazily under memory pressure\n"
+    " --gc-heap-limit=<size>    Hard cap on the GC heap; collections escalate to\n"
+    "                           full with page return before an allocation fails\n\n"
 ;
 
+// parse a byte count with an optional K/M/G suffix (e.g. "512M");
+// returns 0 on malformed input
+static int jl_parse_size_arg(const char *arg, uint64_t *out)
+{
+    char *endptr;
+    errno = 0;
+    unsigned long long sz = strtoull(arg, &endptr, 10);
+    if (errno != 0 || endptr == arg)
+        return 0;
+    switch (*endptr) {
+    case 'k': case 'K': sz <<= 10; endptr++; break;
+    case 'm': case 'M': sz <<= 20; endptr++; break;
+    case 'g': case 'G': sz <<= 30; endptr++; break;
+    default: break;
+    }
+    if (*endptr != 0 || sz == 0)
+        return 0;
+    *out = (uint64_t)sz;
+    return 1;
+}
+
 JL_DLLEXPORT void jl_parse_opts(int *argcp, char ***argvp)
 {
     enum { opt_machinefile = 300,
@@ -157,7 +199,14 @@ JL_DLLEXPORT void jl_parse_opts(int *argcp, char ***argvp)
            opt_output_ji,
            opt_use_precompiled,
            opt_use_compilecache,
-           opt_incremental
+           opt_incremental,
+           opt_minimal_init,
+           opt_gc_threads,
+           opt_gc_heap_init,
+           opt_gc_heap_max,
+           opt_gc_pause_target,
+           opt_gc_page_return,
+           opt_gc_heap_limit
     };
     static const char* const shortopts = "+vhqH:e:E:L:J:C:ip:O:g:";
     static const struct option longopts[] = {
@@ -194,6 +243,13 @@ JL_DLLEXPORT void jl_parse_opts(int *argcp, char ***argvp)
         { "polly",           required_argument, 0, opt_polly },
         { "math-mode",       required_argument, 0, opt_math_mode },
         { "handle-signals",  required_argument, 0, opt_handle_signals },
+        { "minimal-init",    required_argument, 0, opt_minimal_init },
+        { "gc-threads",      required_argument, 0, opt_gc_threads },
+        { "gc-heap-init",    required_argument, 0, opt_gc_heap_init },
+        { "gc-heap-max",     required_argument, 0, opt_gc_heap_max },
+        { "gc-pause-target", required_argument, 0, opt_gc_pause_target },
+        { "gc-page-return",  required_argument, 0, opt_gc_page_return },
+        { "gc-heap-limit",   required_argument, 0, opt_gc_heap_limit },
         // hidden command line options
         { "worker",          required_argument, 0, opt_worker },
         { "bind-to",         required_argument, 0, opt_bind_to },
@@ -502,6 +558,50 @@ restart_switch:
             else
                 jl_errorf("julia: invalid argument to --handle-signals (%s)", optarg);
             break;
+        case opt_minimal_init:
+            if (!strcmp(optarg,"yes"))
+                jl_options.minimal_init = 1;
+            else if (!strcmp(optarg,"no"))
+                jl_options.minimal_init = 0;
+            else
+                jl_errorf("julia: invalid argument to --minimal-init={yes|no} (%s)", optarg);
+            break;
+        case opt_gc_threads: {
+            errno = 0;
+            long nthreads = strtol(optarg, &endptr, 10);
+            if (errno != 0 || optarg == endptr || *endptr != 0 || nthreads < 1 || nthreads >= INT_MAX)
+                jl_errorf("julia: --gc-threads=<n> must be an integer >= 1");
+            jl_options.gc_threads = (int32_t)nthreads;
+            break;
+        }
+        case opt_gc_heap_init:
+            if (!jl_parse_size_arg(optarg, &jl_options.gc_heap_init))
+                jl_errorf("julia: invalid argument to --gc-heap-init=<size> (%s)", optarg);
+            break;
+        case opt_gc_heap_max:
+            if (!jl_parse_size_arg(optarg, &jl_options.gc_heap_max))
+                jl_errorf("julia: invalid argument to --gc-heap-max=<size> (%s)", optarg);
+            break;
+        case opt_gc_pause_target: {
+            errno = 0;
+            long ms = strtol(optarg, &endptr, 10);
+            if (errno != 0 || optarg == endptr || *endptr != 0 || ms < 1 || ms >= INT_MAX)
+                jl_errorf("julia: --gc-pause-target=<ms> must be an integer >= 1");
+            jl_options.gc_pause_target = (int32_t)ms;
+            break;
+        }
+        case opt_gc_page_return:
+            if (!strcmp(optarg,"keep"))
+                jl_options.gc_page_return = JL_OPTIONS_GC_PAGE_RETURN_KEEP;
+            else if (!strcmp(optarg,"lazy"))
+                jl_options.gc_page_return = JL_OPTIONS_GC_PAGE_RETURN_LAZY;
+            else
+                jl_errorf("julia: invalid argument to --gc-page-return={keep|lazy} (%s)", optarg);
+            break;
+        case opt_gc_heap_limit:
+            if (!jl_parse_size_arg(optarg, &jl_options.gc_heap_limit))
+                jl_errorf("julia: invalid argument to --gc-heap-limit=<size> (%s)", optarg);
+            break;
         default:
             jl_errorf("julia: unhandled option -- %c\n"
                       "This is a bug, please report it.", c);
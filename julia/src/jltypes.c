@@ -658,10 +658,12 @@ static void cache_insert_type(jl_value_t *type, ssize_t insert_at, int ordered)
     if (n==0 || jl_svecref(cache,n-1) != NULL) {
         jl_svec_t *nc = jl_alloc_svec(n < 8 ? 8 : (n*3)>>1);
         memcpy(jl_svec_data(nc), jl_svec_data(cache), sizeof(void*) * n);
+        // publish the grown cache only after its contents are in
+        // place, for the lock-free readers in inst_datatype
         if (ordered)
-            ((jl_datatype_t*)type)->name->cache = nc;
+            jl_atomic_store_release(&((jl_datatype_t*)type)->name->cache, nc);
         else
-            ((jl_datatype_t*)type)->name->linearcache = nc;
+            jl_atomic_store_release(&((jl_datatype_t*)type)->name->linearcache, nc);
         jl_gc_wb(((jl_datatype_t*)type)->name, nc);
         cache = nc;
         n = jl_svec_len(nc);
@@ -970,9 +972,15 @@ static jl_value_t *inst_datatype(jl_datatype_t *dt, jl_svec_t *p, jl_value_t **i
     jl_typestack_t top;
     jl_typename_t *tn = dt->name;
     int istuple = (tn == jl_tuple_typename);
-    // check type cache
+    // check type cache. The first lookup runs without the lock: cache
+    // entries are only ever NULL or fully-constructed types, and a hit
+    // must pass typekey_eq on the entry it lands on, so a concurrent
+    // insert shifting the ordered cache under us can at worst turn a
+    // hit into a miss - and misses are re-checked under the lock before
+    // instantiating. Repeated instantiations of an existing type (the
+    // overwhelmingly common case under parallel codegen and dispatch)
+    // therefore never serialize on typecache_lock.
     if (cacheable) {
-        JL_LOCK(&typecache_lock); // Might GC
         size_t i;
         for(i=0; i < ntp; i++) {
             jl_value_t *pi = iparams[i];
@@ -983,7 +991,8 @@ static jl_value_t *inst_datatype(jl_datatype_t *dt, jl_svec_t *p, jl_value_t **i
                 if (!((jl_datatype_t*)pi)->abstract)
                     continue;
             }
-            // normalize types equal to wrappers
+            // normalize types equal to wrappers; only rewrites our
+            // caller's iparams, so this is safe without the lock
             jl_value_t *tw = extract_wrapper(pi);
             if (tw && tw != pi && (tn != jl_type_typename || jl_typeof(pi) == jl_typeof(tw)) &&
                 jl_types_equal(pi, tw)) {
@@ -992,6 +1001,10 @@ static jl_value_t *inst_datatype(jl_datatype_t *dt, jl_svec_t *p, jl_value_t **i
             }
         }
         jl_value_t *lkup = (jl_value_t*)lookup_type(tn, iparams, ntp);
+        if (lkup != NULL)
+            return lkup;
+        JL_LOCK(&typecache_lock); // Might GC
+        lkup = (jl_value_t*)lookup_type(tn, iparams, ntp);
         if (lkup != NULL) {
             JL_UNLOCK(&typecache_lock); // Might GC
             return lkup;
@@ -2021,7 +2021,7 @@
                   (expand-fuse-broadcast '() `(|.| ,(undotop f) (tuple ,@(cddr e)))))
                  ((and (eq? f 'ccall) (length> e 4))
                   (let* ((cconv (cadddr e))
-                         (have-cconv (memq cconv '(cdecl stdcall fastcall thiscall llvmcall)))
+                         (have-cconv (memq cconv '(cdecl stdcall fastcall thiscall llvmcall gc_safe)))
                          (after-cconv (if have-cconv (cddddr e) (cdddr e)))
                          (name (caddr e))
                          (RT   (car after-cconv))
@@ -3315,7 +3315,7 @@ f(x) = yt(x)
     ;; from the current function.
     (define (compile e break-labels value tail)
       (if (or (not (pair? e)) (memq (car e) '(null ssavalue quote inert top core copyast the_exception $
-                                                   globalref outerref cdecl stdcall fastcall thiscall llvmcall)))
+                                                   globalref outerref cdecl stdcall fastcall thiscall llvmcall gc_safe)))
           (let ((e1 (if (and arg-map (symbol? e))
                         (get arg-map e e)
                         e)))
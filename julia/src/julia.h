@@ -403,10 +403,15 @@ typedef struct _jl_module_t {
     jl_sym_t *name;
     struct _jl_module_t *parent;
     htable_t bindings;
-    arraylist_t usings;  // modules with all bindings potentially imported
+    small_arraylist_t usings;  // modules with all bindings potentially imported
     uint8_t istopmod;
     uint64_t uuid;
     uint32_t counter;
+    // writers of `bindings` and `usings` serialize on this lock; binding
+    // lookup is lock-free and validates itself against rehash_gen instead
+    // (see module.c)
+    jl_mutex_t lock;
+    uint32_t rehash_gen;
 } jl_module_t;
 
 // one Type-to-Value entry
@@ -650,20 +655,51 @@ JL_DLLEXPORT void jl_clear_malloc_data(void);
 // GC write barriers
 JL_DLLEXPORT void jl_gc_queue_root(jl_value_t *root); // root isa jl_value_t*
 
+JL_DLLEXPORT void jl_gc_flush_wb_log(void);
+JL_DLLEXPORT void jl_gc_shade(jl_value_t *ptr);
+// nonzero while the collector is marking concurrently with the
+// mutators (defined in the neptune staticlib)
+extern uint8_t neptune_mark_active;
+
+// Do NOT put a safepoint here
+STATIC_INLINE void jl_gc_log_root(void *parent)
+{
+    jl_ptls_t ptls = jl_get_ptls_states();
+    // GC_MARKED doubles as the "already remembered" bit: anything not
+    // GC_OLD_MARKED is either young or already logged, and logging it
+    // again would only put a duplicate in the remset. jl_gc_wb checks
+    // this before calling, but direct jl_gc_queue_root callers don't.
+    if (jl_astaggedvalue(parent)->bits.gc != 3)
+        return;
+    // Drop the object back to GC_MARKED right away so further stores
+    // into it before the log is flushed don't log it again. This is
+    // what queueing it in the remembered set would do anyway.
+    jl_astaggedvalue(parent)->bits.gc = 1;
+    ptls->gc_wb_log[ptls->gc_wb_log_len++] = (jl_value_t*)parent;
+    if (__unlikely(ptls->gc_wb_log_len == JL_GC_WB_LOG_SZ))
+        jl_gc_flush_wb_log();
+}
+
 // Do NOT put a safepoint here
 STATIC_INLINE void jl_gc_wb(void *parent, void *ptr)
 {
     // parent and ptr isa jl_value_t*
     if (__unlikely(jl_astaggedvalue(parent)->bits.gc == 3 &&
                    (jl_astaggedvalue(ptr)->bits.gc & 1) == 0))
-        jl_gc_queue_root((jl_value_t*)parent);
+        jl_gc_log_root(parent);
+    // while marking runs concurrently, a pointer stored into an
+    // already-marked object could otherwise be missed by the markers
+    else if (__unlikely(neptune_mark_active &&
+                        (jl_astaggedvalue(parent)->bits.gc & 1) &&
+                        (jl_astaggedvalue(ptr)->bits.gc & 1) == 0))
+        jl_gc_shade((jl_value_t*)ptr);
 }
 
 STATIC_INLINE void jl_gc_wb_back(void *ptr) // ptr isa jl_value_t*
 {
     // if ptr is old
     if (__unlikely(jl_astaggedvalue(ptr)->bits.gc == 3)) {
-        jl_gc_queue_root((jl_value_t*)ptr);
+        jl_gc_log_root(ptr);
     }
 }
 
@@ -1195,6 +1231,8 @@ JL_DLLEXPORT void jl_array_del_beg(jl_array_t *a, size_t dec);
 JL_DLLEXPORT void jl_array_sizehint(jl_array_t *a, size_t sz);
 JL_DLLEXPORT void jl_array_ptr_1d_push(jl_array_t *a, jl_value_t *item);
 JL_DLLEXPORT void jl_array_ptr_1d_push2(jl_array_t *a, jl_value_t *b, jl_value_t *c);
+JL_DLLEXPORT void jl_array_ptr_copy(jl_array_t *dest, void **dest_p,
+                                    jl_array_t *src, void **src_p, ssize_t n);
 JL_DLLEXPORT jl_value_t *jl_apply_array_type(jl_value_t *type, size_t dim);
 // property access
 JL_DLLEXPORT void *jl_array_ptr(jl_array_t *a);
@@ -1223,6 +1261,8 @@ JL_DLLEXPORT jl_binding_t *jl_get_binding_for_method_def(jl_module_t *m,
 JL_DLLEXPORT int jl_boundp(jl_module_t *m, jl_sym_t *var);
 JL_DLLEXPORT int jl_defines_or_exports_p(jl_module_t *m, jl_sym_t *var);
 JL_DLLEXPORT int jl_binding_resolved_p(jl_module_t *m, jl_sym_t *var);
+// lock-free lookup of m's own binding table (no `using` search); NULL if absent
+JL_DLLEXPORT jl_binding_t *jl_get_module_binding(jl_module_t *m, jl_sym_t *var);
 JL_DLLEXPORT int jl_is_const(jl_module_t *m, jl_sym_t *var);
 JL_DLLEXPORT jl_value_t *jl_get_global(jl_module_t *m, jl_sym_t *var);
 JL_DLLEXPORT void jl_set_global(jl_module_t *m, jl_sym_t *var, jl_value_t *val);
@@ -1254,6 +1294,7 @@ JL_DLLEXPORT jl_value_t *jl_eqtable_get(jl_array_t *h, void *key,
 JL_DLLEXPORT int jl_errno(void);
 JL_DLLEXPORT void jl_set_errno(int e);
 JL_DLLEXPORT int32_t jl_stat(const char *path, char *statbuf);
+JL_DLLEXPORT void jl_prefetch_file(const char *path);
 JL_DLLEXPORT int jl_cpu_cores(void);
 JL_DLLEXPORT long jl_getpagesize(void);
 JL_DLLEXPORT long jl_getallocationgranularity(void);
@@ -1412,6 +1453,9 @@ STATIC_INLINE int jl_vinfo_usedundef(uint8_t vi)
 // calling into julia ---------------------------------------------------------
 
 JL_DLLEXPORT jl_value_t *jl_apply_generic(jl_value_t **args, uint32_t nargs);
+// per-call-site inline-cache variant; `pic` comes from jl_new_callsite_cache
+JL_DLLEXPORT jl_value_t *jl_new_callsite_cache(void);
+JL_DLLEXPORT jl_value_t *jl_apply_generic_pic(jl_value_t *pic, jl_value_t **args, uint32_t nargs);
 JL_DLLEXPORT jl_value_t *jl_invoke(jl_method_instance_t *meth, jl_value_t **args, uint32_t nargs);
 
 STATIC_INLINE
@@ -1433,6 +1477,9 @@ JL_DLLEXPORT void jl_yield(void);
 // async signal handling ------------------------------------------------------
 
 JL_DLLEXPORT void jl_install_sigint_handler(void);
+// install the signal handlers startup deferred (--minimal-init); no-op
+// once they are in place
+JL_DLLEXPORT void jl_ensure_signal_handlers(void);
 JL_DLLEXPORT void jl_sigatomic_begin(void);
 JL_DLLEXPORT void jl_sigatomic_end(void);
 
@@ -1487,7 +1534,7 @@ typedef struct _jl_task_t {
     int16_t tid;
 #ifdef JULIA_ENABLE_THREADING
     // This is statically initialized when the task is not holding any locks
-    arraylist_t locks;
+    small_arraylist_t locks;
 #endif
     jl_timing_block_t *timing_stack;
 } jl_task_t;
@@ -1506,10 +1553,10 @@ static inline void jl_lock_frame_push(jl_mutex_t *lock)
     // For early bootstrap
     if (__unlikely(!ptls->current_task))
         return;
-    arraylist_t *locks = &ptls->current_task->locks;
+    small_arraylist_t *locks = &ptls->current_task->locks;
     size_t len = locks->len;
     if (__unlikely(len >= locks->max)) {
-        arraylist_grow(locks, 1);
+        small_arraylist_grow(locks, 1);
     }
     else {
         locks->len = len + 1;
@@ -1545,7 +1592,7 @@ STATIC_INLINE void jl_eh_restore_state(jl_handler_t *eh)
     current_task->eh = eh->prev;
     ptls->pgcstack = eh->gcstack;
 #ifdef JULIA_ENABLE_THREADING
-    arraylist_t *locks = &current_task->locks;
+    small_arraylist_t *locks = &current_task->locks;
     if (locks->len > eh->locks_len) {
         for (size_t i = locks->len;i > eh->locks_len;i--)
             jl_mutex_unlock_nogc((jl_mutex_t*)locks->items[i - 1]);
@@ -1711,6 +1758,14 @@ typedef struct {
     const char *outputji;
     int8_t incremental;
     int8_t image_file_specified;
+    int8_t minimal_init;
+    // GC tuning; zero means "use the collector's default / environment"
+    int32_t gc_threads;
+    uint64_t gc_heap_init;
+    uint64_t gc_heap_max;
+    int32_t gc_pause_target;
+    int8_t gc_page_return;
+    uint64_t gc_heap_limit;
 } jl_options_t;
 
 extern JL_DLLEXPORT jl_options_t jl_options;
@@ -1770,6 +1825,11 @@ JL_DLLEXPORT int jl_generating_output(void);
 #define JL_OPTIONS_USE_COMPILECACHE_YES 1
 #define JL_OPTIONS_USE_COMPILECACHE_NO 0
 
+// values mirror NEPTUNE_PAGES_* in neptune.h
+#define JL_OPTIONS_GC_PAGE_RETURN_DEFAULT 0
+#define JL_OPTIONS_GC_PAGE_RETURN_KEEP 1
+#define JL_OPTIONS_GC_PAGE_RETURN_LAZY 2
+
 // Version information
 #include <julia_version.h>
 
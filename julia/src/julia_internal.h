@@ -129,15 +129,36 @@ JL_DLLEXPORT jl_value_t *jl_gc_pool_alloc(jl_ptls_t ptls, int pool_offset,
                                           int osize);
 JL_DLLEXPORT jl_value_t *jl_gc_big_alloc(jl_ptls_t ptls, size_t allocsz);
 int jl_gc_classify_pools(size_t sz, int *osize);
+// fused safepoint/allocation-limit rendezvous (threaded builds only):
+// the collector revokes the per-thread bump limits so the inline
+// allocation fast path stops threads, and restores them at restart
+void jl_gc_revoke_bump_limits(void);
+void jl_gc_restore_bump_limits(void);
+// USDT shims in gc.c, called from the Rust collector
+JL_DLLEXPORT void neptune_probe_gc_begin(int full);
+JL_DLLEXPORT void neptune_probe_mark_end(uint64_t ns);
+JL_DLLEXPORT void neptune_probe_sweep_begin(int full);
+JL_DLLEXPORT void neptune_probe_sweep_end(uint64_t ns);
+JL_DLLEXPORT void neptune_probe_gc_end(uint64_t pause_ns, int full);
+JL_DLLEXPORT void neptune_probe_page_alloc(void *page);
+JL_DLLEXPORT void neptune_probe_page_free(void *page);
+JL_DLLEXPORT void neptune_probe_promoted(uint64_t bytes);
+JL_DLLEXPORT void neptune_probe_big_alloc(size_t bytes);
 extern jl_mutex_t gc_perm_lock;
 void *jl_gc_perm_alloc_nolock(size_t sz);
 void *jl_gc_perm_alloc(size_t sz);
 
 // pools are 16376 bytes large (GC_POOL_SZ - GC_PAGE_OFFSET)
-static const int jl_gc_sizeclasses[JL_GC_N_POOLS] = {
 #ifdef _P64
-    8,
-#elif defined(_CPU_ARM_) || defined(_CPU_PPC_) || defined(_CPU_X86_)
+// pool object sizes: this is the Rust collector's table (see
+// neptune/src/gc2.rs, which also holds the classic default contents),
+// mutable there so a tuned layout loaded at init (NEPTUNE_SIZE_CLASSES)
+// is seen by both halves of the runtime
+extern int32_t neptune_size_classes[JL_GC_N_POOLS];
+#define jl_gc_sizeclasses neptune_size_classes
+#else
+static const int jl_gc_sizeclasses[JL_GC_N_POOLS] = {
+#if defined(_CPU_ARM_) || defined(_CPU_PPC_) || defined(_CPU_X86_)
     // ARM and PowerPC have max alignment of 8,
     // make sure allocation of size 8 has that alignment.
     // for x86 alignment is important for atomic ops and
@@ -170,6 +191,7 @@ static const int jl_gc_sizeclasses[JL_GC_N_POOLS] = {
 //    15,   14,   13,   12,   11,   10,    9,    8, /pool
 //    64,   32,  160,   64,   16,   64,  112,  128, bytes lost
 };
+#endif
 
 STATIC_INLINE int jl_gc_alignment(size_t sz)
 {
@@ -193,13 +215,23 @@ STATIC_INLINE int jl_gc_alignment(size_t sz)
 }
 JL_DLLEXPORT int jl_alignment(size_t sz);
 
+// O(1) size -> pool index mapping: entry i covers sizes in
+// (i*16, (i+1)*16], sizes <= 8 are handled before the lookup. Filled
+// by neptune_init_gc from the Rust side's copy of the size-class
+// array (see neptune/src/gc2.rs) so both halves agree by construction.
+#define JL_GC_SZCLASS_TABLE_LEN (2032 >> 4)
+extern uint8_t neptune_szclass_table[JL_GC_SZCLASS_TABLE_LEN];
+
 STATIC_INLINE int JL_CONST_FUNC jl_gc_szclass(size_t sz)
 {
 #ifdef _P64
     if (sz <=    8)
         return 0;
-    const int N = 0;
-#elif defined(_CPU_ARM_) || defined(_CPU_PPC_) || defined(_CPU_X86_)
+    return neptune_szclass_table[(sz - 1) >> 4];
+#else
+    // the table matches the 64-bit class layout; keep the computed
+    // mapping for the extra sub-16-byte classes on 32-bit targets
+#if defined(_CPU_ARM_) || defined(_CPU_PPC_) || defined(_CPU_X86_)
     if (sz <=    8)
         return (sz + 3) / 4 - 1;
     const int N = 1;
@@ -215,6 +247,7 @@ STATIC_INLINE int JL_CONST_FUNC jl_gc_szclass(size_t sz)
     if (sz <= 1008)
         return 16 - 16376 / 2 / LLT_ALIGN(sz, 16 * 2) + 24 + N;
     return     16 - 16376 / 1 / LLT_ALIGN(sz, 16 * 1) + 32 + N;
+#endif
 }
 
 #ifdef __GNUC__
@@ -240,6 +273,38 @@ JL_DLLEXPORT jl_value_t *jl_gc_alloc(jl_ptls_t ptls, size_t sz, void *ty);
 #  define jl_gc_alloc(ptls, sz, ty) jl_gc_alloc_(ptls, sz, ty)
 #endif
 
+// C-side mirror of codegen's inline allocation fast path (emit_allocobj
+// in cgutils.cpp): bump this thread's span published in
+// gc_pool_cur/gc_pool_end, indexed by the class jl_gc_classify_pools
+// returns -- the same class the slow path installs spans (and the
+// collector revokes limits) under -- and only call into the runtime
+// when the size doesn't fit a pool or the span is exhausted (a pending
+// rendezvous revokes the limits, so the bounds check doubles as the
+// safepoint check). Span cells are pre-charged to the allocation
+// counter and their tags are cleared, so the fast path is a compare
+// and two stores.
+STATIC_INLINE jl_value_t *jl_gc_alloc_inline(jl_ptls_t ptls, size_t sz, void *ty)
+{
+    int osize;
+    int klass = jl_gc_classify_pools(sz, &osize);
+    if (klass >= 0) {
+        size_t stride = LLT_ALIGN(osize + sizeof(jl_taggedvalue_t),
+                                  JL_SMALL_BYTE_ALIGNMENT);
+        char *cur = ptls->gc_pool_cur[klass];
+        jl_value_t *v;
+        if (cur != NULL && cur + stride <= ptls->gc_pool_end[klass]) {
+            ptls->gc_pool_cur[klass] = cur + stride;
+            v = jl_valueof((jl_taggedvalue_t*)cur);
+        }
+        else {
+            v = jl_gc_pool_alloc(ptls, klass, osize);
+        }
+        jl_set_typeof(v, ty);
+        return v;
+    }
+    return (jl_gc_alloc)(ptls, sz, ty);
+}
+
 #define jl_buff_tag ((uintptr_t)0x4eade800)
 STATIC_INLINE void *jl_gc_alloc_buf(jl_ptls_t ptls, size_t sz)
 {
@@ -336,7 +401,9 @@ void jl_gc_setmark(jl_ptls_t ptls, jl_value_t *v);
 void jl_gc_sync_total_bytes(void);
 void jl_gc_track_malloced_array(jl_ptls_t ptls, jl_array_t *a);
 void jl_gc_count_allocd(size_t sz);
+void jl_gc_count_array_grow(size_t bytes_copied);
 void jl_gc_run_all_finalizers(jl_ptls_t ptls);
+JL_DLLEXPORT void jl_gc_add_ptr_finalizer(jl_ptls_t ptls, jl_value_t *v, void *f);
 
 void gc_queue_binding(jl_binding_t *bnd);
 void gc_setmark_buf(jl_ptls_t ptls, void *buf, uint8_t, size_t);
@@ -384,6 +451,7 @@ JL_CALLABLE(jl_f_intrinsic_call);
 extern jl_function_t *jl_unprotect_stack_func;
 void jl_install_default_signal_handlers(void);
 void restore_signals(void);
+void init_stdio(void);
 void jl_install_thread_signal_handler(jl_ptls_t ptls);
 
 jl_fptr_t jl_get_builtin_fptr(jl_value_t *b);
@@ -409,6 +477,11 @@ jl_value_t *jl_type_match_morespecific(jl_value_t *a, jl_value_t *b);
 jl_datatype_t *jl_inst_concrete_tupletype_v(jl_value_t **p, size_t np);
 jl_datatype_t *jl_inst_concrete_tupletype(jl_svec_t *p);
 JL_DLLEXPORT void jl_method_table_insert(jl_methtable_t *mt, jl_method_t *method, jl_tupletype_t *simpletype);
+JL_DLLEXPORT void jl_method_table_insert_batch(jl_methtable_t *mt, jl_method_t **methods,
+                                               jl_tupletype_t **simpletypes, size_t n);
+JL_DLLEXPORT void jl_method_table_insert_cached(jl_methtable_t *mt, jl_tupletype_t *type,
+                                                jl_tupletype_t *simpletype, jl_svec_t *guardsigs,
+                                                jl_method_instance_t *linfo, size_t min_world);
 void jl_mk_builtin_func(jl_datatype_t *dt, const char *name, jl_fptr_t fptr);
 jl_value_t *jl_type_intersection_env_s(jl_value_t *a, jl_value_t *b, jl_svec_t **penv, int *issubty);
 jl_value_t *jl_type_intersection_env(jl_value_t *a, jl_value_t *b, jl_svec_t **penv);
@@ -456,6 +529,8 @@ jl_datatype_t *jl_argument_datatype(jl_value_t *argt);
 
 jl_value_t *jl_nth_slot_type(jl_value_t *sig, size_t i);
 void jl_compute_field_offsets(jl_datatype_t *st);
+jl_array_t *jl_map_array_for_deserialization(uint32_t ndims, size_t *dims,
+                                             int elsz, void *data);
 jl_array_t *jl_new_array_for_deserialization(jl_value_t *atype, uint32_t ndims, size_t *dims,
                                              int isunboxed, int elsz);
 void jl_module_run_initializer(jl_module_t *m);
@@ -470,6 +545,18 @@ extern char jl_using_oprofile_jitevents;
 #endif
 extern size_t jl_arr_xtralloc_limit;
 
+// number of entries in the small-integer box caches (datatype.c); must be
+// even and at most 65536 (the Int16 cache spans [-NBOX_C/2, NBOX_C/2)).
+// Overridable at build time (-DNBOX_C=...) for workloads that box a wider
+// range of small values. Codegen probes the Int32/Int64/Char caches inline
+// (`_boxed_special` in cgutils.cpp), so those arrays are exported here.
+#ifndef NBOX_C
+#define NBOX_C 1024
+#endif
+extern JL_DLLEXPORT jl_value_t *jl_boxed_int32_cache[NBOX_C];
+extern JL_DLLEXPORT jl_value_t *jl_boxed_int64_cache[NBOX_C];
+extern JL_DLLEXPORT jl_value_t *jl_boxed_char_cache[NBOX_C];
+
 void jl_init_types(void);
 void jl_init_box_caches(void);
 void jl_init_frontend(void);
@@ -481,6 +568,7 @@ void jl_init_tasks(void);
 void jl_init_stack_limits(int ismaster);
 void jl_init_root_task(void *stack, size_t ssize);
 void jl_init_serializer(void);
+JL_DLLEXPORT void jl_dump_symtab_profile(void);
 void jl_gc_init(void);
 void jl_init_signal_async(void);
 void jl_init_debuginfo(void);
@@ -644,6 +732,12 @@ STATIC_INLINE char *jl_copy_str(char **to, const char *from)
 // timers
 // Returns time in nanosec
 JL_DLLEXPORT uint64_t jl_hrtime(void);
+// calibrated-TSC and cached coarse variants (sys.c); same timebase as
+// jl_hrtime but cheap enough for hot paths and signal handlers
+void jl_init_hrtime(void);
+JL_DLLEXPORT uint64_t jl_hrtime_fast(void);
+JL_DLLEXPORT uint64_t jl_hrtime_coarse(void);
+void jl_hrtime_coarse_refresh(void);
 
 // libuv stuff:
 JL_DLLEXPORT extern void *jl_dl_handle;
@@ -664,6 +758,7 @@ void *jl_dlopen_soname(const char *pfx, size_t n, unsigned flags);
 
 // libuv wrappers:
 JL_DLLEXPORT int jl_fs_rename(const char *src_path, const char *dst_path);
+JL_DLLEXPORT int jl_fs_unlink(char *path);
 
 #if defined(_CPU_X86_) || defined(_CPU_X86_64_)
 #define HAVE_CPUID
@@ -882,6 +977,8 @@ unsigned jl_special_vector_alignment(size_t nfields, jl_value_t *field_type);
 
 void register_eh_frames(uint8_t *Addr, size_t Size);
 void deregister_eh_frames(uint8_t *Addr, size_t Size);
+// drop cached backtrace symbolications when object code goes away
+void jl_flush_frame_cache(void);
 
 STATIC_INLINE void *jl_get_frame_addr(void)
 {
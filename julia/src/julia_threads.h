@@ -86,9 +86,26 @@ typedef struct {
     void *big_obj[1024];
 } jl_gc_mark_cache_t;
 
+// Cache line size assumed by the hot/cold layout of the TLS block below.
+#define JL_CACHE_LINE_SIZE 64
+#ifdef _COMPILER_MICROSOFT_
+#  define JL_ATTRIBUTE_ALIGN_CACHE(x) __declspec(align(64)) x
+#else
+#  define JL_ATTRIBUTE_ALIGN_CACHE(x) x __attribute__ ((aligned (JL_CACHE_LINE_SIZE)))
+#endif
+
 // This includes all the thread local states we care about for a thread.
+// The layout is split in two: the leading cache lines hold the fields
+// the fast paths emitted by codegen touch on every safepoint, GC frame
+// push, write barrier and inline allocation, and the cold bookkeeping
+// starts on a fresh line, so the two halves never share a line. The
+// alignment of the first cold field also cache-line-aligns the TLS
+// block itself. Field offsets are always taken with offsetof (see
+// codegen.cpp and llvm-ptls.cpp), so the order here is the only place
+// the split lives.
 #define JL_MAX_BT_SIZE 80000
 typedef struct _jl_tls_states_t {
+    // --- hot: touched by generated code ---
     struct _jl_gcframe_t *pgcstack;
     size_t world_age;
     struct _jl_value_t *exception_in_transit;
@@ -103,9 +120,28 @@ typedef struct _jl_tls_states_t {
     volatile int8_t gc_state;
     volatile int8_t in_finalizer;
     int8_t disable_gc;
+    int16_t tid;
     volatile sig_atomic_t defer_signal;
-    struct _jl_module_t *current_module;
     struct _jl_task_t *volatile current_task;
+    // Per-size-class bump cursors for the inline allocation fast path
+    // emitted by codegen (see emit_allocobj in cgutils.cpp). Each
+    // (cur, end) pair delimits a span of contiguous free cells handed
+    // out by neptune's page allocator; the cells are pre-charged to the
+    // allocation counter when the span is installed, so the inline path
+    // only has to bump the cursor. Refill goes through the usual
+    // jl_gc_pool_alloc slow path.
+    char *gc_pool_cur[JL_GC_N_POOLS];
+    char *gc_pool_end[JL_GC_N_POOLS];
+    // SATB-style write-barrier log (jl_gc_wb in julia.h). The barrier
+    // appends old objects here inline and hands the whole buffer to the
+    // GC in one call when it fills, instead of crossing into the GC for
+    // every pointer store.
+#define JL_GC_WB_LOG_SZ 256
+    size_t gc_wb_log_len;
+    struct _jl_value_t *gc_wb_log[JL_GC_WB_LOG_SZ];
+
+    // --- cold: bookkeeping off the fast paths ---
+    JL_ATTRIBUTE_ALIGN_CACHE(struct _jl_module_t *current_module);
     struct _jl_task_t *root_task;
     struct _jl_value_t *volatile task_arg_in_transit;
     void *stackbase;
@@ -114,7 +150,6 @@ typedef struct _jl_tls_states_t {
     jl_jmp_buf *volatile jmp_target;
     jl_jmp_buf base_ctx; // base context of stack
     jl_jmp_buf *safe_restore;
-    int16_t tid;
     size_t bt_size;
     // JL_MAX_BT_SIZE + 1 elements long
     uintptr_t *bt_data;
@@ -140,6 +175,12 @@ typedef struct _jl_tls_states_t {
     arraylist_t finalizers;
 
     tl_gcs_t *tl_gcs;
+    // Per-thread perm-gen bump arena (jl_gc_perm_alloc in gc.c). The
+    // arena is thread-private so the fast path takes no lock.
+    char *gc_perm_pool;
+    size_t gc_perm_size;
+    // perm bytes allocated since the last batched report to the GC
+    size_t gc_perm_allocd;
 } jl_tls_states_t;
 typedef jl_tls_states_t *jl_ptls_t;
 
@@ -438,6 +479,11 @@ JL_DLLEXPORT void jl_threading_profile(void);
 JL_DLLEXPORT void (jl_cpu_pause)(void);
 JL_DLLEXPORT void (jl_cpu_wake)(void);
 
+// Time-to-safepoint instrumentation (safepoint.c). The flag is only
+// set while a collection is waiting for the world to stop.
+JL_DLLEXPORT extern volatile uint8_t jl_safepoint_tts_armed;
+JL_DLLEXPORT void jl_safepoint_note_tts(int16_t tid);
+
 // Accessing the tls variables, gc safepoint and gc states
 JL_DLLEXPORT JL_CONST_FUNC jl_ptls_t (jl_get_ptls_states)(void);
 // This triggers a SegFault when we are in GC
@@ -476,7 +522,17 @@ JL_DLLEXPORT void jl_set_ptls_states_getter(jl_get_ptls_states_func f);
 STATIC_INLINE int8_t jl_gc_state_set(jl_ptls_t ptls, int8_t state,
                                      int8_t old_state)
 {
-    ptls->gc_state = state;
+    // Wait-free for the mutator: a release store to our own state byte
+    // (a plain store on x86) plus at most one load below. All of the
+    // rendezvous work lives with the collector, which acquire-loads
+    // this byte in jl_gc_wait_for_the_world and owns the safepoint
+    // page protections; the release makes our preceding heap stores
+    // visible to it on weakly-ordered targets.
+    jl_atomic_store_release(&ptls->gc_state, state);
+    // Going GC-safe while a collection is waiting for us: record how
+    // long the collector has been waiting for this thread.
+    if (state && !old_state && jl_safepoint_tts_armed)
+        jl_safepoint_note_tts(ptls->tid);
     // A safe point is required if we transition from GC-safe region to
     // non GC-safe region.
     if (old_state && !state)
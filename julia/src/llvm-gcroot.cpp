@@ -5,6 +5,7 @@
 
 #include "llvm-version.h"
 #include <llvm/ADT/SmallBitVector.h>
+#include <llvm/ADT/SmallPtrSet.h>
 #include <llvm/IR/Value.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/Module.h>
@@ -16,8 +17,15 @@
 #else
 #include <llvm/PassManager.h>
 #endif
+#if JL_LLVM_VERSION >= 30500
+#include <llvm/IR/Dominators.h>
+#endif
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/InlineAsm.h>
+#include <llvm/IR/Operator.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Transforms/Utils/BasicBlockUtils.h>
+#include <llvm/Transforms/Utils/Local.h>
 #if JL_LLVM_VERSION >= 30600
 #include <llvm/IR/DIBuilder.h>
 #include <llvm/IR/DebugInfoMetadata.h>
@@ -144,7 +152,8 @@ public:
         gcroot_flush_func(M.getFunction("julia.gcroot_flush")),
         except_enter_func(M.getFunction("julia.except_enter")),
         jlleave_func(M.getFunction("jl_pop_handler")),
-        tbaa_gcframe(tbaa)
+        tbaa_gcframe(tbaa),
+        has_handlers(false)
     {
 /* Algorithm sketch:
  *  Compute liveness for each basic block
@@ -177,10 +186,17 @@ private:
     Function *const except_enter_func;
     Function *const jlleave_func;
     MDNode *const tbaa_gcframe;
+    // whether lowerHandlers found exception frames; the CFG then hides
+    // longjmp edges, which rules out reusing root slots
+    bool has_handlers;
 
     Instruction *get_pgcstack(Instruction *ptlsStates);
     frame_register get_gcroot(Value *ptr);
     void collapseRedundantRoots();
+    void forwardRootLoads();
+    void coalesceLocalRoots(
+        std::map<BasicBlock*, std::map<frame_register, liveness::id> > &bb_uses,
+        std::priority_queue< std::pair<unsigned, CallInst*> > &frames);
     bool record_usage(CallInst *callInst,
         std::map<BasicBlock*, std::map<frame_register, liveness::id> > &bb_uses,
         std::map<BasicBlock*, SmallBitVector> &regs_used,
@@ -246,6 +262,7 @@ void JuliaGCAllocator::lowerHandlers()
 
     if (handlers.empty())
         return;
+    has_handlers = true;
 
     typedef std::map<CallInst*,HandlerData>::iterator hdlr_iter_t;
     // For each exception enter, compute the life time of the enter, find
@@ -646,7 +663,10 @@ bool JuliaGCAllocator::record_usage(CallInst *callInst,
  *                 return false
  *     return true
  */
-    unsigned arg_n = cast<ConstantInt>(callInst->getArgOperand(0))->getZExtValue();
+    // a gc_root_decl handed over by coalesceLocalRoots occupies a single
+    // slot; jlcall frames carry their width as the first argument
+    unsigned arg_n = callInst->getCalledValue() == gcroot_func ? 1 :
+        cast<ConstantInt>(callInst->getArgOperand(0))->getZExtValue();
 #if 0 // suboptimal allocator that ignores computed liveness data
     {
         SmallBitVector &regs = regs_used[&callInst->getParent()->getParent()->getEntryBlock()];
@@ -745,6 +765,201 @@ void JuliaGCAllocator::rearrangeRoots()
     }
 }
 
+void JuliaGCAllocator::forwardRootLoads()
+{
+/* Replace loads from a gc_root_decl slot with the stored SSA value when
+ * a single store reaches them. The collector only reads frame slots, it
+ * never rewrites them, so the slot cannot change behind the mutator's
+ * back even across calls -- a fact the later alias analyses cannot
+ * recover once the frame has become plain memory. The store stays
+ * behind to keep the value rooted; only the reload traffic disappears.
+ */
+#if JL_LLVM_VERSION >= 30500 // needs the standalone DominatorTree
+    DominatorTree DT;
+    DT.recalculate(F);
+    for (BasicBlock::iterator I = gcframe->getParent()->begin(), E(gcframe); I != E; ) {
+        CallInst* callInst = dyn_cast<CallInst>(&*I);
+        ++I;
+        if (!(callInst && callInst->getCalledValue() == gcroot_func))
+            continue;
+        StoreInst *theStore = NULL;
+        unsigned n_stores = 0;
+        bool only_mem = true;
+        SmallVector<LoadInst*, 8> loads;
+        for (User::use_iterator use = callInst->use_begin(), usee = callInst->use_end(); use != usee; ++use) {
+#if JL_LLVM_VERSION >= 30500
+            User *user = use->getUser();
+#else
+            User *user = use.getUse().getUser();
+#endif
+            if (StoreInst *storeInst = dyn_cast<StoreInst>(user)) {
+                if (storeInst->getPointerOperand() != callInst || !storeInst->isSimple()) {
+                    only_mem = false;
+                    break;
+                }
+                theStore = storeInst;
+                n_stores++;
+            }
+            else if (LoadInst *loadInst = dyn_cast<LoadInst>(user)) {
+                if (!loadInst->isSimple()) {
+                    only_mem = false;
+                    break;
+                }
+                loads.push_back(loadInst);
+            }
+            else {
+                only_mem = false;
+                break;
+            }
+        }
+        if (!only_mem || n_stores != 1)
+            continue;
+        Value *theValue = theStore->getValueOperand();
+        for (size_t i = 0; i < loads.size(); i++) {
+            LoadInst *loadInst = loads[i];
+            // loads the store does not dominate read the NULL the frame
+            // setup wrote, not theValue; leave those alone
+            if (!DT.dominates(theStore, loadInst))
+                continue;
+            loadInst->replaceAllUsesWith(theValue);
+            loadInst->eraseFromParent();
+        }
+    }
+#endif
+}
+
+/* Record every instruction that may still depend on a rooted value: the
+ * direct users, and transitively the users of pointer-typed values
+ * derived from it (casts, geps, loads of fields). Such instructions pin
+ * the value's root to their basic-block even though the slot itself is
+ * not accessed there, since a collection at any of them must still find
+ * the value (or its parent) rooted.
+ */
+static void pin_value_users(Value *v, SmallPtrSetImpl<Instruction*> &pinned)
+{
+    SmallVector<Value*, 16> worklist;
+    worklist.push_back(v);
+    while (!worklist.empty()) {
+        Value *cur = worklist.pop_back_val();
+#if JL_LLVM_VERSION >= 30500
+        for (User *user : cur->users()) {
+#else
+        for (Value::use_iterator UI = cur->use_begin(), UE = cur->use_end(); UI != UE; ++UI) {
+            User *user = *UI;
+#endif
+            Instruction *inst = dyn_cast<Instruction>(user);
+            if (!inst)
+                continue;
+            if (!pinned.insert(inst).second)
+                continue;
+            if (inst->getType()->isPointerTy())
+                worklist.push_back(inst);
+        }
+    }
+}
+
+void JuliaGCAllocator::coalesceLocalRoots(
+        std::map<BasicBlock*, std::map<frame_register, liveness::id> > &bb_uses,
+        std::priority_queue< std::pair<unsigned, CallInst*> > &frames)
+{
+/* # allocate space in locals for the variables
+ * For each gc_root_decl whose uses are plain loads and stores, compute
+ * the set of basic-blocks in which its slot may hold a live value and
+ * hand it to the same allocator that packs the jlcall frames, so roots
+ * with disjoint live ranges share a slot. Roots with stranger uses keep
+ * the old one-slot-per-root path, as does every root when exception
+ * handlers are present (a longjmp edge the CFG does not show could
+ * enter the middle of another root's live range).
+ */
+    if (has_handlers)
+        return;
+    for (BasicBlock::iterator I = gcframe->getParent()->begin(), E(gcframe); I != E; ) {
+        CallInst* callInst = dyn_cast<CallInst>(&*I);
+        ++I;
+        if (!(callInst && callInst->getCalledValue() == gcroot_func))
+            continue;
+        SmallPtrSet<Instruction*, 32> pinned;
+        SmallVector<LoadInst*, 8> loads;
+        SmallVector<StoreInst*, 8> stores;
+        bool coalescable = true;
+        for (User::use_iterator use = callInst->use_begin(), usee = callInst->use_end(); use != usee; ++use) {
+#if JL_LLVM_VERSION >= 30500
+            User *user = use->getUser();
+#else
+            User *user = use.getUse().getUser();
+#endif
+            if (StoreInst *storeInst = dyn_cast<StoreInst>(user)) {
+                if (storeInst->getPointerOperand() == callInst && storeInst->isSimple()) {
+                    stores.push_back(storeInst);
+                    pinned.insert(storeInst);
+                    continue;
+                }
+            }
+            else if (LoadInst *loadInst = dyn_cast<LoadInst>(user)) {
+                if (loadInst->isSimple()) {
+                    loads.push_back(loadInst);
+                    pinned.insert(loadInst);
+                    continue;
+                }
+            }
+            coalescable = false;
+            break;
+        }
+        if (!coalescable || pinned.empty())
+            continue;
+        for (size_t i = 0; i < loads.size(); i++)
+            pin_value_users(loads[i], pinned);
+        for (size_t i = 0; i < stores.size(); i++) {
+            Value *val = stores[i]->getValueOperand();
+            if (!isa<Constant>(val))
+                pin_value_users(val, pinned);
+        }
+        // block-level liveness over the pinning instructions
+        std::set<BasicBlock*> access_bbs, def_bbs, demand_bbs;
+        for (SmallPtrSet<Instruction*, 32>::iterator pi = pinned.begin(), pe = pinned.end(); pi != pe; ++pi)
+            access_bbs.insert((*pi)->getParent());
+        for (size_t i = 0; i < stores.size(); i++)
+            def_bbs.insert(stores[i]->getParent());
+        for (std::set<BasicBlock*>::iterator bi = access_bbs.begin(), be = access_bbs.end(); bi != be; ++bi) {
+            BasicBlock *bb = *bi;
+            for (BasicBlock::iterator i = bb->begin(), ie = bb->end(); i != ie; ++i) {
+                Instruction *inst = &*i;
+                if (pinned.count(inst)) {
+                    // a store writes the slot before anything needs it;
+                    // any other first access requires the entry value
+                    StoreInst *storeInst = dyn_cast<StoreInst>(inst);
+                    if (!(storeInst && storeInst->getPointerOperand() == callInst))
+                        demand_bbs.insert(bb);
+                    break;
+                }
+            }
+        }
+        // propagate the demand backwards; a store kills it
+        std::set<BasicBlock*> live_in(demand_bbs), live_out;
+        std::vector<BasicBlock*> worklist(demand_bbs.begin(), demand_bbs.end());
+        while (!worklist.empty()) {
+            BasicBlock *bb = worklist.back();
+            worklist.pop_back();
+            for (pred_iterator PI = pred_begin(bb), PE = pred_end(bb); PI != PE; ++PI) {
+                BasicBlock *pred = *PI;
+                if (!live_out.insert(pred).second)
+                    continue;
+                if (def_bbs.count(pred) || !live_in.insert(pred).second)
+                    continue;
+                worklist.push_back(pred);
+            }
+        }
+        frame_register def(callInst, 0);
+        for (std::set<BasicBlock*>::iterator bi = access_bbs.begin(), be = access_bbs.end(); bi != be; ++bi)
+            bb_uses[*bi][def] = liveness::live;
+        for (std::set<BasicBlock*>::iterator bi = live_in.begin(), be = live_in.end(); bi != be; ++bi)
+            bb_uses[*bi][def] = liveness::live;
+        for (std::set<BasicBlock*>::iterator bi = live_out.begin(), be = live_out.end(); bi != be; ++bi)
+            bb_uses[*bi][def] = liveness::live;
+        frames.push(std::make_pair(1u, callInst));
+    }
+}
+
 void JuliaGCAllocator::allocate_frame()
 {
     lowerHandlers();
@@ -753,6 +968,7 @@ void JuliaGCAllocator::allocate_frame()
     Instruction *last_gcframe_inst = gcframe;
     collapseRedundantRoots();
     rearrangeRoots();
+    forwardRootLoads();
 
 /* # initialize the kill BasicBlock of all jlcall-frames
  * bb-uses : map<BB, map< pair<inst, arg-offset>, assign|live|kill > >
@@ -917,8 +1133,12 @@ void JuliaGCAllocator::allocate_frame()
     }
 
 /* # allocate space in locals for the variables
- * TBD
+ * coalescable gc_root_decl slots enter the same allocation below as
+ * one-wide frames, carrying the block-level liveness computed in
+ * coalesceLocalRoots; the rest fall through to the dedicated-slot
+ * loop further down
  */
+    coalesceLocalRoots(bb_uses, frames);
 
 /* # allocate space in temp-args for each jlcall frame
  * regs-used = zip(get-basic-blocks(), falses)
@@ -1139,6 +1359,366 @@ void JuliaGCAllocator::allocate_frame()
 #endif
 }
 
+// --- write-barrier elision for freshly allocated objects ---
+//
+// emit_write_barrier (cgutils.cpp) guards every jl_gc_queue_root call
+// with an inline generation filter, but when the store's parent was
+// allocated since the last possible safepoint the whole diamond is
+// statically dead: a new object cannot carry the GC_OLD_MARKED bits
+// until a collection has run, and collections only happen at
+// safepoints.  Constructors that initialize reference fields right
+// after allocating otherwise pay the header load and branch on every
+// store.  This runs as part of the first pass in the pipeline, so the
+// IR still has the exact shape codegen emitted and the allocation and
+// barrier patterns matched below are reliable.
+
+typedef SmallPtrSet<Value*, 8> fresh_set_t;
+
+// calls that can never run a collection
+static bool safepoint_free_call(CallInst *call, CallInst *ptlsStates)
+{
+    if (call == ptlsStates)
+        return true;
+    Function *callee = call->getCalledFunction();
+    if (!callee)
+        return false; // indirect call, assume the worst
+    if (callee->isIntrinsic())
+        return true;
+    // the barrier slow path itself only appends to a thread-local log
+    return callee->getName() == "jl_gc_queue_root";
+}
+
+// calls whose result is a brand-new (hence young) object
+static bool fresh_alloc_call(CallInst *call)
+{
+    Function *callee = call->getCalledFunction();
+    if (!callee)
+        return false;
+    StringRef name = callee->getName();
+    return name == "jl_gc_pool_alloc" || name == "jl_gc_big_alloc";
+}
+
+// loads of the inline bump-allocation cursor: emit_allocobj indexes
+// the i8* view of the TLS block with a constant offset into
+// gc_pool_cur and derives the fast-path object pointer from the
+// loaded cursor, so anything based on such a load is fresh too
+static bool fresh_cursor_load(LoadInst *load, CallInst *ptlsStates)
+{
+    if (!ptlsStates)
+        return false;
+    GEPOperator *gep =
+        dyn_cast<GEPOperator>(load->getPointerOperand()->stripPointerCasts());
+    if (!gep || gep->getNumIndices() != 1 ||
+        gep->getPointerOperand()->stripPointerCasts() != ptlsStates)
+        return false;
+    if (!cast<PointerType>(gep->getPointerOperand()->getType())
+             ->getElementType()->isIntegerTy(8))
+        return false;
+    ConstantInt *idx = dyn_cast<ConstantInt>(gep->getOperand(1));
+    if (!idx)
+        return false;
+    size_t off = (size_t)idx->getZExtValue();
+    return off >= offsetof(jl_tls_states_t, gc_pool_cur) &&
+           off < offsetof(jl_tls_states_t, gc_pool_cur) +
+                 sizeof(char*) * JL_GC_N_POOLS;
+}
+
+// apply one block's effects to `fresh`; when `barriers` is given,
+// also record the jl_gc_queue_root calls whose parent is provably
+// fresh at the call
+static void scan_block_freshness(BasicBlock *BB, fresh_set_t &fresh,
+                                 std::map<BasicBlock*, fresh_set_t> &bb_fresh_out,
+                                 CallInst *ptlsStates,
+                                 std::vector<CallInst*> *barriers)
+{
+    for (BasicBlock::iterator i = BB->begin(), e = BB->end(); i != e; ++i) {
+        Instruction *inst = &*i;
+        if (PHINode *phi = dyn_cast<PHINode>(inst)) {
+            // a merge of fresh values is fresh (the alloc fast/slow
+            // paths join in a phi); predecessors not computed yet are
+            // treated optimistically, the fixpoint loop revisits them
+            bool all_fresh = phi->getNumIncomingValues() > 0;
+            for (unsigned n = 0; all_fresh && n < phi->getNumIncomingValues(); n++) {
+                std::map<BasicBlock*, fresh_set_t>::iterator out =
+                    bb_fresh_out.find(phi->getIncomingBlock(n));
+                if (out == bb_fresh_out.end())
+                    continue;
+                all_fresh = out->second.count(
+                    phi->getIncomingValue(n)->stripPointerCasts()) != 0;
+            }
+            if (all_fresh)
+                fresh.insert(phi);
+            else
+                fresh.erase(phi);
+        }
+        else if (CallInst *call = dyn_cast<CallInst>(inst)) {
+            if (barriers) {
+                Function *callee = call->getCalledFunction();
+                if (callee && callee->getName() == "jl_gc_queue_root" &&
+                    call->getNumArgOperands() == 1 &&
+                    fresh.count(call->getArgOperand(0)->stripPointerCasts()))
+                    barriers->push_back(call);
+            }
+            if (!safepoint_free_call(call, ptlsStates))
+                fresh.clear();
+            if (fresh_alloc_call(call))
+                fresh.insert(call);
+        }
+        else if (LoadInst *load = dyn_cast<LoadInst>(inst)) {
+            if (fresh_cursor_load(load, ptlsStates))
+                fresh.insert(load);
+        }
+        else if (isa<BitCastInst>(inst) || isa<GetElementPtrInst>(inst)) {
+            if (fresh.count(inst->getOperand(0)->stripPointerCasts()))
+                fresh.insert(inst);
+        }
+        else if (isa<InvokeInst>(inst)) {
+            fresh.clear();
+        }
+    }
+}
+
+// meet over the already-computed predecessors (intersection)
+static void block_fresh_in(BasicBlock *BB,
+                           std::map<BasicBlock*, fresh_set_t> &bb_fresh_out,
+                           fresh_set_t &fresh)
+{
+    bool have_pred = false;
+    for (pred_iterator pi = pred_begin(BB), pe = pred_end(BB); pi != pe; ++pi) {
+        std::map<BasicBlock*, fresh_set_t>::iterator out = bb_fresh_out.find(*pi);
+        if (out == bb_fresh_out.end())
+            continue;
+        if (!have_pred) {
+            fresh = out->second;
+            have_pred = true;
+        }
+        else {
+            fresh_set_t meet;
+            for (fresh_set_t::iterator v = fresh.begin(), ve = fresh.end();
+                 v != ve; ++v) {
+                if (out->second.count(*v))
+                    meet.insert(*v);
+            }
+            fresh = meet;
+        }
+    }
+}
+
+static bool same_fresh_set(const fresh_set_t &a, const fresh_set_t &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (fresh_set_t::const_iterator v = a.begin(), e = a.end(); v != e; ++v)
+        if (!b.count(*v))
+            return false;
+    return true;
+}
+
+// delete a provably dead barrier call and, when the surrounding IR
+// still has the two-test diamond emit_write_barrier laid out, fold the
+// filter branches and header loads away as well; if inlining has
+// reshuffled the pattern the dead filter is left for the optimizer
+static void erase_barrier(CallInst *call)
+{
+    BasicBlock *bb = call->getParent();
+    call->eraseFromParent();
+    // walk outward over wb_trigger, then wb_may_trigger
+    for (int depth = 0; depth < 2; depth++) {
+        BranchInst *br = dyn_cast<BranchInst>(bb->getTerminator());
+        if (!br || br->isConditional() || &bb->front() != br)
+            break;
+        BasicBlock *cont = br->getSuccessor(0);
+        BasicBlock *pred = bb->getSinglePredecessor();
+        if (!pred || isa<PHINode>(cont->front()))
+            break;
+        BranchInst *pred_br = dyn_cast<BranchInst>(pred->getTerminator());
+        if (!pred_br || !pred_br->isConditional() ||
+            pred_br->getSuccessor(0) != bb || pred_br->getSuccessor(1) != cont)
+            break;
+        Value *cond = pred_br->getCondition();
+        pred_br->eraseFromParent();
+        BranchInst::Create(cont, pred);
+        bb->eraseFromParent();
+        RecursivelyDeleteTriviallyDeadInstructions(cond);
+        bb = pred;
+    }
+}
+
+static void elide_fresh_write_barriers(Function &F, CallInst *ptlsStates)
+{
+    // forward must-dataflow of "allocated, no safepoint since" values,
+    // iterated to a fixpoint over the reachable blocks
+    std::map<BasicBlock*, fresh_set_t> bb_fresh_out;
+    std::vector<BasicBlock*> worklist;
+    worklist.push_back(&F.getEntryBlock());
+    while (!worklist.empty()) {
+        BasicBlock *BB = worklist.back();
+        worklist.pop_back();
+        fresh_set_t fresh;
+        block_fresh_in(BB, bb_fresh_out, fresh);
+        scan_block_freshness(BB, fresh, bb_fresh_out, ptlsStates, nullptr);
+        std::map<BasicBlock*, fresh_set_t>::iterator out = bb_fresh_out.find(BB);
+        if (out != bb_fresh_out.end() && same_fresh_set(out->second, fresh))
+            continue;
+        bb_fresh_out[BB] = fresh;
+        for (succ_iterator si = succ_begin(BB), se = succ_end(BB); si != se; ++si)
+            worklist.push_back(*si);
+    }
+
+    // replay the stable solution and drop the barriers it kills
+    std::vector<CallInst*> barriers;
+    for (Function::iterator bb = F.begin(), e = F.end(); bb != e; ++bb) {
+        if (!bb_fresh_out.count(&*bb))
+            continue; // unreachable
+        fresh_set_t fresh;
+        block_fresh_in(&*bb, bb_fresh_out, fresh);
+        scan_block_freshness(&*bb, fresh, bb_fresh_out, ptlsStates, &barriers);
+    }
+    for (size_t n = 0; n < barriers.size(); n++)
+        erase_barrier(barriers[n]);
+}
+
+// --- safepoint elision in leaf functions ---
+//
+// The only safepoint poll compiled code carries is the explicit
+// jl_gc_safepoint ccall lowering: a volatile load of the per-thread
+// signal page between two signal fences.  For a tiny leaf that cannot
+// loop or call back into the runtime the poll is redundant - the
+// caller reaches its own next safepoint as soon as the leaf returns,
+// so dropping the poll delays a stop-the-world by at most the leaf's
+// straight-line length.  Dispatch-dense numeric code calls millions of
+// such leaves per second and pays the fenced load on every one.
+
+// upper bound on the size of a function whose poll we drop; anything
+// larger can do enough work per call to matter for time-to-safepoint
+static const unsigned safepoint_leaf_max_insts = 64;
+
+// calls that keep a function a leaf: the ptls getter, LLVM
+// intrinsics, the julia.* codegen markers this pass erases anyway,
+// and the empty inline-asm compiler barrier emit_signal_fence uses on
+// ARM
+static bool leaf_benign_call(CallInst *call, CallInst *ptlsStates)
+{
+    if (call == ptlsStates)
+        return true;
+    if (InlineAsm *ia = dyn_cast<InlineAsm>(call->getCalledValue()))
+        return ia->getAsmString().empty();
+    Function *callee = call->getCalledFunction();
+    if (!callee)
+        return false;
+    return callee->isIntrinsic() || callee->getName().startswith("julia.");
+}
+
+// a volatile load of the signal page, i.e. of the value
+// allocate_gc_frame loaded from the ptls safepoint slot
+static bool is_safepoint_poll(LoadInst *load, CallInst *ptlsStates)
+{
+    if (!load->isVolatile() || !ptlsStates)
+        return false;
+    LoadInst *page =
+        dyn_cast<LoadInst>(load->getPointerOperand()->stripPointerCasts());
+    if (!page)
+        return false;
+    GEPOperator *gep =
+        dyn_cast<GEPOperator>(page->getPointerOperand()->stripPointerCasts());
+    if (!gep || gep->getNumIndices() != 1 ||
+        gep->getPointerOperand()->stripPointerCasts() != ptlsStates)
+        return false;
+    // emit_nthptr_addr indexes in pointer-sized units
+    if (!cast<PointerType>(gep->getPointerOperand()->getType())
+             ->getElementType()->isPointerTy())
+        return false;
+    ConstantInt *idx = dyn_cast<ConstantInt>(gep->getOperand(1));
+    return idx && idx->getZExtValue() * sizeof(void*) ==
+                      offsetof(jl_tls_states_t, safepoint);
+}
+
+// the compiler-only barriers emit_signal_fence places around a poll
+static bool is_signal_fence(Instruction *inst)
+{
+    if (FenceInst *fence = dyn_cast<FenceInst>(inst))
+        return fence->getSynchScope() == SingleThread;
+    if (CallInst *call = dyn_cast<CallInst>(inst)) {
+        if (InlineAsm *ia = dyn_cast<InlineAsm>(call->getCalledValue()))
+            return ia->getAsmString().empty();
+    }
+    return false;
+}
+
+// any cycle in the CFG means the function can run unboundedly long
+static bool has_backedge(Function &F)
+{
+    SmallPtrSet<BasicBlock*, 16> visited, on_stack;
+    std::vector<std::pair<BasicBlock*, succ_iterator> > stack;
+    BasicBlock *entry = &F.getEntryBlock();
+    visited.insert(entry);
+    on_stack.insert(entry);
+    stack.push_back(std::make_pair(entry, succ_begin(entry)));
+    while (!stack.empty()) {
+        BasicBlock *bb = stack.back().first;
+        if (stack.back().second == succ_end(bb)) {
+            on_stack.erase(bb);
+            stack.pop_back();
+            continue;
+        }
+        BasicBlock *succ = *stack.back().second++;
+        if (on_stack.count(succ))
+            return true;
+        if (visited.insert(succ).second) {
+            on_stack.insert(succ);
+            stack.push_back(std::make_pair(succ, succ_begin(succ)));
+        }
+    }
+    return false;
+}
+
+// drop one poll: the volatile load plus the signal fences around it;
+// the page-address chain goes away once nothing else uses it
+static void erase_safepoint_poll(LoadInst *poll)
+{
+    Instruction *page = dyn_cast<Instruction>(poll->getPointerOperand());
+    Instruction *before = poll->getPrevNode();
+    Instruction *after = poll->getNextNode();
+    poll->eraseFromParent();
+    if (before && is_signal_fence(before))
+        before->eraseFromParent();
+    if (after && is_signal_fence(after))
+        after->eraseFromParent();
+    if (page)
+        RecursivelyDeleteTriviallyDeadInstructions(page);
+}
+
+static void elide_leaf_safepoints(Function &F, CallInst *ptlsStates)
+{
+    // vet the leaf conditions and collect the polls in one walk
+    SmallVector<LoadInst*, 4> polls;
+    unsigned ninsts = 0;
+    for (Function::iterator bb = F.begin(), be = F.end(); bb != be; ++bb) {
+        for (BasicBlock::iterator i = bb->begin(), e = bb->end(); i != e; ++i) {
+            Instruction *inst = &*i;
+            if (++ninsts > safepoint_leaf_max_insts)
+                return;
+            if (CallInst *call = dyn_cast<CallInst>(inst)) {
+                if (!leaf_benign_call(call, ptlsStates))
+                    return;
+            }
+            else if (isa<InvokeInst>(inst)) {
+                return;
+            }
+            else if (LoadInst *load = dyn_cast<LoadInst>(inst)) {
+                if (is_safepoint_poll(load, ptlsStates))
+                    polls.push_back(load);
+            }
+        }
+    }
+    if (polls.empty() || has_backedge(F))
+        return;
+    for (unsigned n = 0; n < polls.size(); n++) {
+        if (polls[n]->use_empty())
+            erase_safepoint_poll(polls[n]);
+    }
+}
+
 struct LowerGCFrame: public ModulePass {
     static char ID;
     LowerGCFrame() : ModulePass(ID)
@@ -1223,6 +1803,8 @@ void LowerGCFrame::runOnFunction(Module *M, Function &F, Function *ptls_getter,
             }
         }
     }
+    elide_fresh_write_barriers(F, ptlsStates);
+    elide_leaf_safepoints(F, ptlsStates);
     JuliaGCAllocator allocator(F, ptlsStates, T_pjlvalue, tbaa_gcframe);
     allocator.allocate_frame();
 }
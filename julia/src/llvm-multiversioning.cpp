@@ -0,0 +1,113 @@
+// This file is a part of Julia. License is MIT: http://julialang.org/license
+
+#define DEBUG_TYPE "multiversioning"
+#undef DEBUG
+
+// LLVM pass to clone vectorization candidates for a wider ISA than the
+// baseline target. LowerSIMDLoop has already marked the memory accesses
+// of @simd loops with "llvm.mem.parallel_loop_access", so any function
+// carrying that marker stands to gain vector width from a bigger
+// register file. Each candidate F gets a copy F.avx2 whose
+// "target-features" attribute enables AVX2; the JIT binds F's symbol to
+// whichever version the executing host supports when the object is
+// linked (see jitlayers.cpp), so the dispatch is resolved once and
+// costs nothing per call.
+
+#include "llvm-version.h"
+#include "support/dtypes.h"
+
+#include <llvm/Pass.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/Support/Debug.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include "fix_llvm_assert.h"
+
+using namespace llvm;
+
+// The suffix and feature set the JIT's load-time dispatch looks for;
+// keep in sync with jl_host_has_avx2 in jitlayers.cpp.
+#define JL_MV_SUFFIX ".avx2"
+static const char *mv_features = "+avx2,+fma,+bmi2";
+
+namespace {
+
+struct MultiVersioning: public ModulePass {
+    static char ID;
+    MultiVersioning() : ModulePass(ID) {}
+
+private:
+    bool runOnModule(Module &M) override;
+};
+
+// Whether F contains a loop that LowerSIMDLoop annotated as parallel.
+static bool hasSIMDLoop(Function &F)
+{
+    unsigned mdkind = F.getContext().getMDKindID("llvm.mem.parallel_loop_access");
+    for (Function::iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB)
+        for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I)
+            if (I->getMetadata(mdkind))
+                return true;
+    return false;
+}
+
+bool MultiVersioning::runOnModule(Module &M)
+{
+    // collect the candidates first; cloning appends to the module
+    SmallVector<Function*, 8> candidates;
+    for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I) {
+        Function *F = &*I;
+        if (F->isDeclaration())
+            continue;
+        // local functions have no symbol for the dispatch to rebind
+        if (F->hasLocalLinkage())
+            continue;
+        if (F->getName().endswith(JL_MV_SUFFIX))
+            continue;
+        if (M.getNamedValue((F->getName() + JL_MV_SUFFIX).str()))
+            continue;
+        if (hasSIMDLoop(*F))
+            candidates.push_back(F);
+    }
+    for (size_t i = 0; i < candidates.size(); i++) {
+        Function *F = candidates[i];
+        ValueToValueMapTy VMap;
+#if JL_LLVM_VERSION >= 30900
+        Function *NewF = CloneFunction(F, VMap);
+#else
+        Function *NewF = CloneFunction(F, VMap, false);
+        M.getFunctionList().push_back(NewF);
+#endif
+        NewF->setName(F->getName() + JL_MV_SUFFIX);
+        std::string feats = mv_features;
+        if (NewF->hasFnAttribute("target-features")) {
+            feats = (NewF->getFnAttribute("target-features").getValueAsString() +
+                     "," + mv_features).str();
+#if JL_LLVM_VERSION >= 50000
+            NewF->setAttributes(NewF->getAttributes().removeAttribute(
+                M.getContext(), AttributeList::FunctionIndex, "target-features"));
+#else
+            NewF->setAttributes(NewF->getAttributes().removeAttribute(
+                M.getContext(), AttributeSet::FunctionIndex, "target-features"));
+#endif
+        }
+        NewF->addFnAttr("target-features", feats);
+        DEBUG(dbgs() << "MV: versioned " << F->getName() << "\n");
+    }
+    return !candidates.empty();
+}
+
+char MultiVersioning::ID = 0;
+
+static RegisterPass<MultiVersioning> X("JuliaMultiVersioning", "Julia function multiversioning",
+                                       false /* Only looks at CFG */,
+                                       false /* Analysis Pass */);
+
+} // anonymous namespace
+
+Pass *createMultiVersioningPass()
+{
+    return new MultiVersioning();
+}
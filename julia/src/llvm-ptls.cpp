@@ -34,6 +34,29 @@ using namespace llvm;
 
 extern std::pair<MDNode*,MDNode*> tbaa_make_child(const char *name, MDNode *parent=nullptr, bool isConstant=false);
 
+// Whether sysimg (imaging mode) code may address the thread-local state
+// directly instead of calling through the `jl_get_ptls_states.ptr`
+// indirection (JULIA_SYSIMG_STATIC_TLS). The static TLS offset of the
+// main executable's PT_TLS segment is fixed by its program headers, so a
+// sysimg generated by that executable can bake the offset into its code;
+// the generating process records the offset it used in the
+// `jl_sysimg_tls_offset` metadata global and the loader refuses an image
+// whose offset no longer matches (see dump.c).
+bool jl_sysimg_static_tls(void)
+{
+#if JL_LLVM_VERSION >= 30700 && defined(JULIA_ENABLE_THREADING) && \
+    (defined(_CPU_X86_64_) || defined(_CPU_X86_) || defined(_CPU_AARCH64_))
+    static int enabled = -1;
+    if (enabled == -1) {
+        const char *env = getenv("JULIA_SYSIMG_STATIC_TLS");
+        enabled = env && *env && jl_tls_offset != -1;
+    }
+    return enabled != 0;
+#else
+    return false;
+#endif
+}
+
 namespace {
 
 struct LowerPTLS: public ModulePass {
@@ -96,7 +119,9 @@ void LowerPTLS::runOnFunction(LLVMContext &ctx, Module &M, Function *F,
     }
 
 #ifdef JULIA_ENABLE_THREADING
-    if (imaging_mode) {
+    // with JULIA_SYSIMG_STATIC_TLS, imaging code takes the fs-relative
+    // path below like JIT code does, skipping one call per function
+    if (imaging_mode && !jl_sysimg_static_tls()) {
         GlobalVariable *GV = cast<GlobalVariable>(
             M.getNamedValue("jl_get_ptls_states.ptr"));
         LoadInst *getter = new LoadInst(GV, "", ptlsStates);
@@ -197,7 +222,7 @@ bool LowerPTLS::runOnModule(Module &M)
     auto T_ppjlvalue =
         cast<PointerType>(functype->getReturnType())->getElementType();
 #ifdef JULIA_ENABLE_THREADING
-    if (imaging_mode)
+    if (imaging_mode && !jl_sysimg_static_tls())
         ensure_global("jl_get_ptls_states.ptr", functype->getPointerTo(), M);
 #else
     ensure_global("jl_tls_states", T_ppjlvalue, M, imaging_mode);
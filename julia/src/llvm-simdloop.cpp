@@ -10,32 +10,55 @@
 #include "llvm-version.h"
 #include "support/dtypes.h"
 #include <llvm/Analysis/LoopPass.h>
+#include <llvm/IR/Constants.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/IR/Metadata.h>
 #include <llvm/Support/Debug.h>
 #include "fix_llvm_assert.h"
 
 #include <cstdio>
+#include <cstdlib>
 
 namespace llvm {
 
 // simd loop
 static unsigned simd_loop_mdkind = 0;
 static MDNode *simd_loop_md = NULL;
+// additional marker for `@simd ivdep`: the user asserts that no two memory
+// references in the loop body overlap
+static unsigned simd_ivdep_mdkind = 0;
+static MDNode *simd_ivdep_md = NULL;
+
+// Optional overrides for the vectorizer's cost model (0 = let it decide),
+// for experiments on kernels where the chosen width or interleave factor
+// is wrong. Read once; the hints end up in loop metadata, so they only
+// affect code compiled in this process.
+static unsigned simd_env_hint(const char *name)
+{
+    const char *env = getenv(name);
+    if (!env || !*env)
+        return 0;
+    int n = atoi(env);
+    return n > 0 ? (unsigned)n : 0;
+}
 
 /// Mark loop as a SIMD loop.  Return false if loop cannot be marked.
 /// incr should be the basic block that increments the loop counter.
-bool annotateSimdLoop(BasicBlock *incr)
+bool annotateSimdLoop(BasicBlock *incr, bool ivdep)
 {
     DEBUG(dbgs() << "LSL: annotating simd_loop\n");
     // Lazy initialization
     if (!simd_loop_mdkind) {
         simd_loop_mdkind = incr->getContext().getMDKindID("simd_loop");
+        simd_ivdep_mdkind = incr->getContext().getMDKindID("simd_ivdep");
 #if JL_LLVM_VERSION >= 30600
         simd_loop_md = MDNode::get(incr->getContext(), ArrayRef<Metadata*>());
+        simd_ivdep_md = MDNode::get(incr->getContext(), ArrayRef<Metadata*>());
 #else
         simd_loop_md = MDNode::get(incr->getContext(), ArrayRef<Value*>());
+        simd_ivdep_md = MDNode::get(incr->getContext(), ArrayRef<Value*>());
 #endif
     }
     // Ideally, the decoration would go on the block itself, but LLVM 3.3 does not
@@ -48,6 +71,8 @@ bool annotateSimdLoop(BasicBlock *incr)
             if (i.getType()->isIntegerTy()) {
                 DEBUG(dbgs() << "LSL: setting simd_loop metadata\n");
                 i.setMetadata(simd_loop_mdkind, simd_loop_md);
+                if (ivdep)
+                    i.setMetadata(simd_ivdep_mdkind, simd_ivdep_md);
                 return true;
             }
             else {
@@ -71,22 +96,36 @@ private:
 
     /// Check if loop has "simd_loop" annotation.
     /// If present, the annotation is an MDNode attached to an instruction in the loop's latch.
-    bool hasSIMDLoopMetadata( Loop *L) const;
+    /// Sets *ivdep if the "simd_ivdep" marker is present as well.
+    bool hasSIMDLoopMetadata(Loop *L, bool *ivdep) const;
 
-    /// If Phi is part of a reduction cycle of FAdd or FMul, mark the ops as permitting reassociation/commuting.
+    /// If Phi is part of a reduction cycle of FAdd/FSub or FMul, mark the ops as permitting reassociation/commuting.
     void enableUnsafeAlgebraIfReduction(PHINode *Phi, Loop *L) const;
 };
 
-bool LowerSIMDLoop::hasSIMDLoopMetadata(Loop *L) const
+bool LowerSIMDLoop::hasSIMDLoopMetadata(Loop *L, bool *ivdep) const
 {
     // Note: If a loop has 0 or multiple latch blocks, it's probably not a simd_loop anyway.
-    if (BasicBlock *latch = L->getLoopLatch())
-        for (BasicBlock::iterator II = latch->begin(), EE = latch->end(); II!=EE; ++II)
-            if (II->getMetadata(simd_loop_mdkind))
+    if (BasicBlock *latch = L->getLoopLatch()) {
+        for (BasicBlock::iterator II = latch->begin(), EE = latch->end(); II!=EE; ++II) {
+            if (II->getMetadata(simd_loop_mdkind)) {
+                *ivdep = II->getMetadata(simd_ivdep_mdkind) != NULL;
                 return true;
+            }
+        }
+    }
     return false;
 }
 
+// Reduction chains of fsub reassociate the same way as fadd once fast-math
+// lets x - a become x + (-a), so treat the two opcodes as one reduction kind.
+static unsigned reductionKind(unsigned opcode)
+{
+    if (opcode == Instruction::FSub)
+        return Instruction::FAdd;
+    return opcode;
+}
+
 void LowerSIMDLoop::enableUnsafeAlgebraIfReduction(PHINode *Phi, Loop *L) const
 {
     typedef SmallVector<Instruction*, 8> chainVector;
@@ -121,14 +160,14 @@ void LowerSIMDLoop::enableUnsafeAlgebraIfReduction(PHINode *Phi, Loop *L) const
         }
         if (opcode) {
             // Check that arithmetic op matches prior arithmetic ops in the chain.
-            if (J->getOpcode()!=opcode) {
+            if (reductionKind(J->getOpcode())!=opcode) {
                 DEBUG(dbgs() << "LSL: chain broke at " << *J << " because of wrong opcode\n");
                 return;
             }
         }
         else {
             // First arithmetic op in the chain.
-            opcode = J->getOpcode();
+            opcode = reductionKind(J->getOpcode());
             if (opcode!=Instruction::FAdd && opcode!=Instruction::FMul) {
                 DEBUG(dbgs() << "LSL: first arithmetic op in chain is uninteresting" << *J << "\n");
                 return;
@@ -147,7 +186,8 @@ bool LowerSIMDLoop::runOnLoop(Loop *L, LPPassManager &LPM)
     if (!simd_loop_mdkind)
         return false;           // Fast rejection test.
 
-    if (!hasSIMDLoopMetadata(L))
+    bool ivdep = false;
+    if (!hasSIMDLoopMetadata(L, &ivdep))
         return false;
 
     DEBUG(dbgs() << "LSL: simd_loop found\n");
@@ -170,6 +210,41 @@ bool LowerSIMDLoop::runOnLoop(Loop *L, LPPassManager &LPM)
     L->getLoopLatch()->getTerminator()->setMetadata("llvm.loop.parallel", n);
 #endif
 #if JL_LLVM_VERSION >= 30600
+    {
+        // Rebuild the loop ID with vectorizer hints. `vectorize.enable`
+        // records that vectorization was explicitly requested, so the
+        // vectorizer reports when it bails instead of silently leaving the
+        // loop scalar; the optional width and interleave hints override
+        // its cost model.
+        LLVMContext &ctx = Lh->getContext();
+        Type *T_int32 = Type::getInt32Ty(ctx);
+        SmallVector<Metadata*, 4> ops;
+        ops.push_back(NULL); // self-reference, patched below
+        for (unsigned i = 1; i < n->getNumOperands(); i++)
+            ops.push_back(n->getOperand(i));
+        Metadata *enable[] = {
+            MDString::get(ctx, "llvm.loop.vectorize.enable"),
+            ConstantAsMetadata::get(ConstantInt::getTrue(ctx))};
+        ops.push_back(MDNode::get(ctx, enable));
+        static unsigned width = simd_env_hint("JULIA_SIMD_WIDTH");
+        if (width) {
+            Metadata *md[] = {
+                MDString::get(ctx, "llvm.loop.vectorize.width"),
+                ConstantAsMetadata::get(ConstantInt::get(T_int32, width))};
+            ops.push_back(MDNode::get(ctx, md));
+        }
+        static unsigned interleave = simd_env_hint("JULIA_SIMD_INTERLEAVE");
+        if (interleave) {
+            Metadata *md[] = {
+                MDString::get(ctx, "llvm.loop.interleave.count"),
+                ConstantAsMetadata::get(ConstantInt::get(T_int32, interleave))};
+            ops.push_back(MDNode::get(ctx, md));
+        }
+        MDNode *loopID = MDNode::getDistinct(ctx, ops);
+        loopID->replaceOperandWith(0, loopID);
+        L->setLoopID(loopID);
+        n = loopID;
+    }
     MDNode *m = MDNode::get(Lh->getContext(), ArrayRef<Metadata*>(n));
 #else
     MDNode *m = MDNode::get(Lh->getContext(), ArrayRef<Value*>(n));
@@ -182,6 +257,29 @@ bool LowerSIMDLoop::runOnLoop(Loop *L, LPPassManager &LPM)
                 I->setMetadata("llvm.mem.parallel_loop_access", m);
     assert(L->isAnnotatedParallel());
 
+#if JL_LLVM_VERSION >= 30600
+    if (ivdep) {
+        // `@simd ivdep` promises that no two memory references in the body
+        // overlap. Encode that as one anonymous alias scope that every
+        // access both belongs to and is declared independent of, so
+        // AA-based passes (and the vectorizer's runtime-check generation)
+        // treat the accesses as disjoint instead of bailing or emitting
+        // memchecks.
+        MDBuilder MDB(Lh->getContext());
+        MDNode *domain = MDB.createAnonymousAliasScopeDomain("julia.simdloop");
+        MDNode *scope = MDB.createAnonymousAliasScope(domain, "julia.simdloop.ivdep");
+        MDNode *scopeList = MDNode::get(Lh->getContext(), ArrayRef<Metadata*>(scope));
+        for (Loop::block_iterator BBI = L->block_begin(), E = L->block_end(); BBI != E; ++BBI) {
+            for (BasicBlock::iterator I = (*BBI)->begin(), EE = (*BBI)->end(); I != EE; ++I) {
+                if (I->mayReadOrWriteMemory()) {
+                    I->setMetadata(LLVMContext::MD_alias_scope, scopeList);
+                    I->setMetadata(LLVMContext::MD_noalias, scopeList);
+                }
+            }
+        }
+    }
+#endif
+
     // Mark floating-point reductions as okay to reassociate/commute.
     for (BasicBlock::iterator I = Lh->begin(), E = Lh->end(); I!=E; ++I)
         if (PHINode *Phi = dyn_cast<PHINode>(I))
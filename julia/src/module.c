@@ -31,8 +31,10 @@ JL_DLLEXPORT jl_module_t *jl_new_module(jl_sym_t *name)
     m->uuid = jl_hrtime() + (++mcounter);
     if (!m->uuid) m->uuid++; // uuid 0 is invalid
     m->counter = 0;
+    JL_MUTEX_INIT(&m->lock);
+    m->rehash_gen = 0;
     htable_new(&m->bindings, 0);
-    arraylist_new(&m->usings, 0);
+    small_arraylist_new(&m->usings, 0);
     if (jl_core_module) {
         jl_module_using(m, jl_core_module);
     }
@@ -90,32 +92,186 @@ static jl_binding_t *new_binding(jl_sym_t *name)
     return b;
 }
 
+// --- concurrent access to the binding table ---
+
+// Binding lookup is hot enough (every global read from non-inlined code
+// goes through jl_get_binding) that serializing it on a module lock shows
+// up in profiles. Bindings are append-mostly: entries are added and their
+// fields updated, but never removed, so lookups can run lock-free while
+// all mutation of `bindings` and `usings` serializes on m->lock.
+//
+// The one thing a lock-free probe cannot tolerate is the table growing
+// out from under it, so growth is done seqlock-style: `rehash_gen` is
+// made odd, the replacement table is built off to the side and published
+// with release stores (table before size, so a reader loading size before
+// table can never index out of bounds), and the generation is made even
+// again. A reader that observes an odd or changed generation retries; a
+// reader racing only with appends can at worst miss a binding whose
+// insertion is concurrent with the lookup, which is indistinguishable
+// from the lookup having run just before the insert. The old buffer is
+// never freed since a reader loaded before the switch may still be
+// probing it; growth is geometric so the waste is bounded by the size of
+// the live table.
+
+// keep in sync with the probing parameters in support/htable.inc
+#define bindings_hash_size(h) ((h)->size/2)
+#define bindings_max_probe(size) ((size)<=(HT_N_INLINE*2) ? (HT_N_INLINE/2) : (size)>>3)
+
+// lock-free equivalent of ptrhash_get on m->bindings
+static jl_binding_t *bindings_get(jl_module_t *m, jl_sym_t *var)
+{
+    htable_t *h = &m->bindings;
+    uint_t hv = inthash((uintptr_t)var);
+    while (1) {
+        uint32_t gen = jl_atomic_load_acquire(&m->rehash_gen);
+        if (gen & 1) { // table switch in progress
+            jl_cpu_pause();
+            continue;
+        }
+        size_t hsz = jl_atomic_load_acquire(&h->size) / 2;
+        void **tab = jl_atomic_load_acquire(&h->table);
+        size_t maxprobe = bindings_max_probe(hsz);
+        size_t sz = hsz * 2;
+        size_t index = (size_t)(hv & (hsz - 1)) * 2;
+        size_t orig = index;
+        size_t iter = 0;
+        void *val = HT_NOTFOUND;
+        do {
+            if (tab[index] == HT_NOTFOUND)
+                break;
+            if (tab[index] == (void*)var) {
+                val = jl_atomic_load_acquire(&tab[index + 1]);
+                break;
+            }
+            index = (index + 2) & (sz - 1);
+            iter++;
+            if (iter > maxprobe)
+                break;
+        } while (index != orig);
+        if (jl_atomic_load_acquire(&m->rehash_gen) == gen)
+            return (jl_binding_t*)val;
+    }
+}
+
+// writer-side equivalent of ptrhash_bp on m->bindings; m->lock must be
+// held. same probing and growth policy as support/htable.inc, except
+// that a full table is replaced by a freshly built copy as described
+// above instead of being reused in place.
+static void **bindings_bp(jl_module_t *m, jl_sym_t *var)
+{
+    htable_t *h = &m->bindings;
+    uint_t hv = inthash((uintptr_t)var);
+    size_t i, orig, index, iter;
+    size_t newsz, sz = bindings_hash_size(h);
+    size_t maxprobe = bindings_max_probe(sz);
+    void **tab = h->table;
+    void **ol;
+
+ retry_bp:
+    iter = 0;
+    index = (size_t)(hv & (sz-1)) * 2;
+    sz *= 2;
+    orig = index;
+
+    do {
+        if (tab[index+1] == HT_NOTFOUND) {
+            tab[index] = (void*)var;
+            return &tab[index+1];
+        }
+        if (tab[index] == (void*)var)
+            return &tab[index+1];
+
+        index = (index+2) & (sz-1);
+        iter++;
+        if (iter > maxprobe)
+            break;
+    } while (index != orig);
+
+    // table full; grow as fast as htable.inc does
+    sz = h->size;
+    ol = h->table;
+    if (sz >= (1<<19) || (sz <= (1<<8)))
+        newsz = sz<<1;
+    else if (sz <= HT_N_INLINE)
+        newsz = HT_N_INLINE;
+    else
+        newsz = sz<<2;
+    while (1) {
+        tab = (void**)LLT_ALLOC(newsz*sizeof(void*));
+        if (tab == NULL)
+            jl_throw(jl_memory_exception);
+        for(i=0; i < newsz; i++)
+            tab[i] = HT_NOTFOUND;
+        size_t newmaxprobe = bindings_max_probe(newsz/2);
+        int toofull = 0;
+        for(i=0; i < sz && !toofull; i+=2) {
+            if (ol[i+1] == HT_NOTFOUND)
+                continue;
+            size_t idx = (size_t)(inthash((uintptr_t)ol[i]) & (newsz/2-1)) * 2;
+            size_t it = 0;
+            while (tab[idx+1] != HT_NOTFOUND) {
+                idx = (idx+2) & (newsz-1);
+                if (++it > newmaxprobe) {
+                    toofull = 1;
+                    break;
+                }
+            }
+            if (!toofull) {
+                tab[idx] = ol[i];
+                tab[idx+1] = ol[i+1];
+            }
+        }
+        if (!toofull)
+            break;
+        LLT_FREE(tab); // not yet published, safe to free
+        newsz <<= 1;
+    }
+    // make the generation odd so lock-free probes wait out the switch,
+    // publish the new table before the new size, then go even again
+    jl_atomic_store_release(&m->rehash_gen, m->rehash_gen + 1);
+    jl_atomic_store_release(&h->table, tab);
+    jl_atomic_store_release(&h->size, newsz);
+    jl_atomic_store_release(&m->rehash_gen, m->rehash_gen + 1);
+    // `ol` is retired, not freed: a concurrent reader that loaded it
+    // before the switch may still be probing it
+
+    sz = bindings_hash_size(h);
+    maxprobe = bindings_max_probe(sz);
+
+    goto retry_bp;
+}
+
 // get binding for assignment
 JL_DLLEXPORT jl_binding_t *jl_get_binding_wr(jl_module_t *m, jl_sym_t *var)
 {
-    jl_binding_t **bp = (jl_binding_t**)ptrhash_bp(&m->bindings, var);
-    jl_binding_t *b;
+    JL_LOCK(&m->lock);
+    jl_binding_t **bp = (jl_binding_t**)bindings_bp(m, var);
+    jl_binding_t *b = *bp;
 
-    if (*bp != HT_NOTFOUND) {
-        if ((*bp)->owner == NULL) {
-            (*bp)->owner = m;
-            return *bp;
+    if (b != HT_NOTFOUND) {
+        if (b->owner == NULL) {
+            b->owner = m;
+            JL_UNLOCK(&m->lock);
+            return b;
         }
-        else if ((*bp)->owner != m) {
+        else if (b->owner != m) {
             // TODO: change this to an error soon
             jl_printf(JL_STDERR,
                       "WARNING: imported binding for %s overwritten in module %s\n", jl_symbol_name(var), jl_symbol_name(m->name));
         }
         else {
-            return *bp;
+            JL_UNLOCK(&m->lock);
+            return b;
         }
     }
 
     b = new_binding(var);
     b->owner = m;
-    *bp = b;
+    // the binding is fully initialized before lock-free readers see it
+    jl_atomic_store_release(bp, b);
     jl_gc_wb_buf(m, b, sizeof(jl_binding_t));
-    return *bp;
+    JL_UNLOCK(&m->lock);
+    return b;
 }
 
 // return module of binding
@@ -132,10 +288,12 @@ JL_DLLEXPORT jl_module_t *jl_get_module_of_binding(jl_module_t *m, jl_sym_t *var
 // and overwriting.
 JL_DLLEXPORT jl_binding_t *jl_get_binding_for_method_def(jl_module_t *m, jl_sym_t *var)
 {
-    jl_binding_t **bp = (jl_binding_t**)ptrhash_bp(&m->bindings, var);
+    JL_LOCK(&m->lock);
+    jl_binding_t **bp = (jl_binding_t**)bindings_bp(m, var);
     jl_binding_t *b = *bp;
 
     if (b != HT_NOTFOUND) {
+        JL_UNLOCK(&m->lock);
         if (b->owner != m && b->owner != NULL) {
             jl_binding_t *b2 = jl_get_binding(b->owner, var);
             if (b2 == NULL)
@@ -153,9 +311,11 @@ JL_DLLEXPORT jl_binding_t *jl_get_binding_for_method_def(jl_module_t *m, jl_sym_
 
     b = new_binding(var);
     b->owner = m;
-    *bp = b;
+    // the binding is fully initialized before lock-free readers see it
+    jl_atomic_store_release(bp, b);
     jl_gc_wb_buf(m, b, sizeof(jl_binding_t));
-    return *bp;
+    JL_UNLOCK(&m->lock);
+    return b;
 }
 
 static void module_import_(jl_module_t *to, jl_module_t *from, jl_sym_t *s,
@@ -178,12 +338,12 @@ static jl_binding_t *jl_get_binding_(jl_module_t *m, jl_sym_t *var, modstack_t *
         }
         tmp = tmp->prev;
     }
-    jl_binding_t *b = (jl_binding_t*)ptrhash_get(&m->bindings, var);
+    jl_binding_t *b = bindings_get(m, var);
     if (b == HT_NOTFOUND || b->owner == NULL) {
         jl_module_t *owner = NULL;
         for(int i=(int)m->usings.len-1; i >= 0; --i) {
             jl_module_t *imp = (jl_module_t*)m->usings.items[i];
-            jl_binding_t *tempb = (jl_binding_t*)ptrhash_get(&imp->bindings, var);
+            jl_binding_t *tempb = bindings_get(imp, var);
             if (tempb != HT_NOTFOUND && tempb->exportp) {
                 tempb = jl_get_binding_(imp, var, &top);
                 if (tempb == NULL || tempb->owner == NULL)
@@ -239,7 +399,7 @@ JL_DLLEXPORT jl_binding_t *jl_get_binding_or_error(jl_module_t *m, jl_sym_t *var
 
 JL_DLLEXPORT jl_value_t *jl_module_globalref(jl_module_t *m, jl_sym_t *var)
 {
-    jl_binding_t *b = (jl_binding_t*)ptrhash_get(&m->bindings, var);
+    jl_binding_t *b = bindings_get(m, var);
     if (b == HT_NOTFOUND) {
         return jl_new_struct(jl_globalref_type, m, var);
     }
@@ -261,7 +421,7 @@ static int eq_bindings(jl_binding_t *a, jl_binding_t *b)
 // does module m explicitly import s?
 JL_DLLEXPORT int jl_is_imported(jl_module_t *m, jl_sym_t *s)
 {
-    jl_binding_t *b = (jl_binding_t*)ptrhash_get(&m->bindings, s);
+    jl_binding_t *b = bindings_get(m, s);
     return (b != HT_NOTFOUND && b->imported);
 }
 
@@ -279,9 +439,11 @@ static void module_import_(jl_module_t *to, jl_module_t *from, jl_sym_t *s,
                   jl_symbol_name(to->name));
     }
     else {
-        jl_binding_t **bp = (jl_binding_t**)ptrhash_bp(&to->bindings, s);
+        JL_LOCK(&to->lock);
+        jl_binding_t **bp = (jl_binding_t**)bindings_bp(to, s);
         jl_binding_t *bto = *bp;
         if (bto != HT_NOTFOUND) {
+            JL_UNLOCK(&to->lock);
             if (bto == b) {
                 // importing a binding on top of itself. harmless.
             }
@@ -324,8 +486,10 @@ static void module_import_(jl_module_t *to, jl_module_t *from, jl_sym_t *s,
             nb->owner = b->owner;
             nb->imported = (explici!=0);
             nb->deprecated = b->deprecated;
-            *bp = nb;
+            // the binding is fully initialized before lock-free readers see it
+            jl_atomic_store_release(bp, nb);
             jl_gc_wb_buf(to, nb, sizeof(jl_binding_t));
+            JL_UNLOCK(&to->lock);
         }
     }
 }
@@ -370,8 +534,8 @@ JL_DLLEXPORT void jl_module_using(jl_module_t *to, jl_module_t *from)
             jl_binding_t *b = (jl_binding_t*)table[i];
             if (b->exportp && (b->owner==from || b->imported)) {
                 jl_sym_t *var = (jl_sym_t*)table[i-1];
-                jl_binding_t **tobp = (jl_binding_t**)ptrhash_bp(&to->bindings, var);
-                if (*tobp != HT_NOTFOUND && (*tobp)->owner != NULL &&
+                jl_binding_t *tob = bindings_get(to, var);
+                if (tob != HT_NOTFOUND && tob->owner != NULL &&
                     // don't warn for conflicts with the module name itself.
                     // see issue #4715
                     var != to->name &&
@@ -385,21 +549,26 @@ JL_DLLEXPORT void jl_module_using(jl_module_t *to, jl_module_t *from)
         }
     }
 
-    arraylist_push(&to->usings, from);
+    JL_LOCK(&to->lock);
+    small_arraylist_push(&to->usings, from);
+    JL_UNLOCK(&to->lock);
 }
 
 JL_DLLEXPORT void jl_module_export(jl_module_t *from, jl_sym_t *s)
 {
-    jl_binding_t **bp = (jl_binding_t**)ptrhash_bp(&from->bindings, s);
+    JL_LOCK(&from->lock);
+    jl_binding_t **bp = (jl_binding_t**)bindings_bp(from, s);
     if (*bp == HT_NOTFOUND) {
         jl_binding_t *b = new_binding(s);
         // don't yet know who the owner is
         b->owner = NULL;
-        *bp = b;
+        // the binding is fully initialized before lock-free readers see it
+        jl_atomic_store_release(bp, b);
         jl_gc_wb_buf(from, b, sizeof(jl_binding_t));
     }
     assert(*bp != HT_NOTFOUND);
     (*bp)->exportp = 1;
+    JL_UNLOCK(&from->lock);
 }
 
 JL_DLLEXPORT int jl_boundp(jl_module_t *m, jl_sym_t *var)
@@ -410,22 +579,28 @@ JL_DLLEXPORT int jl_boundp(jl_module_t *m, jl_sym_t *var)
 
 JL_DLLEXPORT int jl_defines_or_exports_p(jl_module_t *m, jl_sym_t *var)
 {
-    jl_binding_t *b = (jl_binding_t*)ptrhash_get(&m->bindings, var);
+    jl_binding_t *b = bindings_get(m, var);
     return b != HT_NOTFOUND && (b->exportp || b->owner==m);
 }
 
 JL_DLLEXPORT int jl_module_exports_p(jl_module_t *m, jl_sym_t *var)
 {
-    jl_binding_t *b = (jl_binding_t*)ptrhash_get(&m->bindings, var);
+    jl_binding_t *b = bindings_get(m, var);
     return b != HT_NOTFOUND && b->exportp;
 }
 
 JL_DLLEXPORT int jl_binding_resolved_p(jl_module_t *m, jl_sym_t *var)
 {
-    jl_binding_t *b = (jl_binding_t*)ptrhash_get(&m->bindings, var);
+    jl_binding_t *b = bindings_get(m, var);
     return b != HT_NOTFOUND && b->owner != NULL;
 }
 
+JL_DLLEXPORT jl_binding_t *jl_get_module_binding(jl_module_t *m, jl_sym_t *var)
+{
+    jl_binding_t *b = bindings_get(m, var);
+    return b == HT_NOTFOUND ? NULL : b;
+}
+
 JL_DLLEXPORT jl_value_t *jl_get_global(jl_module_t *m, jl_sym_t *var)
 {
     jl_binding_t *b = jl_get_binding(m, var);
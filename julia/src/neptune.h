@@ -8,36 +8,134 @@
 #include "gc.h"
 
 // page manager
+int neptune_page_lg2(void); // build-time page size of the Rust half
 void neptune_init_page_mgr(void);
 void * neptune_alloc_page(void);
 void neptune_free_page(void * page);
 
-// write barrier 
+// write barrier
 void neptune_queue_root(tl_gcs_t *gc, jl_value_t * root);
+void neptune_queue_roots(tl_gcs_t *gc, jl_value_t ** roots, size_t n);
 void neptune_queue_binding(tl_gcs_t *gc, jl_binding_t * binding);
+void neptune_shade(tl_gcs_t *gc, jl_value_t * v);
+
+// concurrent marking (NEPTUNE_CONCURRENT_MARK); a concurrent cycle
+// runs initial pause -> background marking -> final pause
+int neptune_concurrent_mark_enabled(void);
+int neptune_gc_concurrent_state(void); // 0 idle, 1 marking, 2 done
+void neptune_gc_mark_initial(tl_gcs_t *gc);
+int neptune_gc_collect_final(tl_gcs_t *gc);
 
 // to push object to heap
 void neptune_push_weakref(tl_gcs_t *gc, jl_weakref_t *wr);
+// invalidate the stack scan cache entry of a task about to run
+void neptune_task_dirty(jl_task_t *t);
 void neptune_push_big_object(tl_gcs_t *gc, bigval_t *b);
 
 // external marking stuff
 void neptune_visit_mark_stack(tl_gcs_t *gc);
-void neptune_mark_roots(tl_gcs_t *gc);
-void neptune_mark_thread_local(tl_gcs_t *gc, tl_gcs_t *gc2);
+// mark every thread's locals and the global roots in one call; the
+// per-thread iteration happens on the Rust side
+void neptune_mark_all_roots(tl_gcs_t *gc);
 
 // get stats about the heap
-size_t neptune_remset_len_(tl_gcs_t *gc, uint8_t last_remset);
-size_t neptune_remset_nptr(tl_gcs_t *gc);
+size_t neptune_gen_occupancy(int old); // bytes live per generation
+
+// per-type census of the last full collection (NEPTUNE_CENSUS);
+// entries are ordered heaviest first and stable until the next full
+// sweep publishes a new snapshot
+size_t neptune_census_len(void);
+int neptune_census_entry(size_t i, jl_value_t **typ, size_t *count,
+                         size_t *bytes);
+
+// longest stop-the-world pause observed so far, ns
+uint64_t neptune_pause_max_ns(void);
+
+// bytes allocated since the last collection that still sit in the
+// per-thread pacing counters (the pool/big allocation fast paths count
+// thread-locally and the collector folds the counters into gc_num at
+// pause time); stats reads add this so totals stay exact between
+// pauses. The _take_ variant also re-arms the counters, for the paths
+// that park pending allocation in gc_num.deferred_alloc instead.
+int64_t neptune_pending_allocd(void);
+int64_t neptune_take_pending_allocd(void);
+
+// Shared GC statistics block. Owned and kept current by the Rust side
+// (refreshed inside the pause after marking and after the sweep); C
+// receives a pointer once at neptune_init_gc and aggregates the
+// per-thread sub-blocks on read instead of calling back over FFI.
+// (keep in sync with NeptuneStats in neptune/src/gc2.rs)
+#define NEPTUNE_STATS_MAX_THREADS 256
+typedef struct {
+    size_t remset_len;      // entries in the thread's remset
+    size_t last_remset_len; // entries in the previous cycle's remset
+    size_t remset_nptr;     // pointers behind those entries
+    // monotonic counts of C-to-Rust boundary crossings into this
+    // thread's collector, by entry-point family, so boundary-batching
+    // work can be prioritized by data
+    uint64_t ffi_queue_root;  // write-barrier crossings
+    uint64_t ffi_alloc_slow;  // allocation slow-path crossings
+    uint64_t ffi_remset_sync; // mark/remset bookkeeping crossings
+} neptune_tl_stats_t;
+// pool allocation counts by request size in 16-byte buckets (entry i
+// counts requests of (16i, 16(i+1)] bytes), summed over threads; the
+// raw input for tuning the size-class table (NEPTUNE_SIZE_CLASSES)
+#define NEPTUNE_ALLOC_HIST_LEN (2032 >> 4)
+typedef struct {
+    size_t nthreads; // occupied sub-blocks
+    neptune_tl_stats_t tl[NEPTUNE_STATS_MAX_THREADS];
+    uint64_t ffi_page_ops; // page-manager crossings (no thread context)
+    uint64_t alloc_hist[NEPTUNE_ALLOC_HIST_LEN];
+} neptune_stats_t;
+
+// set by jl_gc_init from the pointer neptune_init_gc hands over
+JL_DLLEXPORT extern const neptune_stats_t *jl_gc_stats;
 
-#define neptune_remset_len(ptls) neptune_remset_len_(ptls->tl_gcs, 0)
-#define neptune_last_remset_len(ptls) neptune_remset_len_(ptls->tl_gcs, 1)
+// pool pages currently allocated, for the seqlock-published stats block
+size_t neptune_current_pg_count(void);
 
-// initializetion of GC-side globals
-void neptune_init_gc(void);
+// make the next full collection's sweep MADV_FREE parked pages, as the
+// cgroup pressure path does; used by the hard heap limit's escalation
+void neptune_request_page_return(void);
+
+// NUMA placement policy for the GC's region memory
+// (keep in sync with neptune/src/pages.rs)
+#define NEPTUNE_NUMA_DEFAULT 0
+#define NEPTUNE_NUMA_LOCAL 1
+#define NEPTUNE_NUMA_INTERLEAVE 2
+
+// return policy for pages parked on the freelist
+// (keep in sync with neptune/src/pages.rs)
+#define NEPTUNE_PAGES_DEFAULT 0 // NEPTUNE_LAZY_DECOMMIT environment variable decides
+#define NEPTUNE_PAGES_KEEP 1    // keep parked pages committed for warm reuse
+#define NEPTUNE_PAGES_LAZY 2    // MADV_FREE parked pages so the kernel can reclaim them
+
+// GC tuning delivered from the command line (jloptions.c). Zero fields
+// fall back to the corresponding NEPTUNE_* environment variables, so
+// existing env-based setups keep working. heap_init/heap_max pace the
+// collection trigger, which lives in the C half of the collector and is
+// applied in jl_gc_init; the rest is consumed by the Rust half.
+typedef struct {
+    int numa_policy;     // NEPTUNE_NUMA_*
+    int nthreads;        // GC worker threads; 0 = NEPTUNE_THREADS (default 1)
+    uint64_t heap_init;  // initial collect interval in bytes; 0 = built-in default
+    uint64_t heap_max;   // cap on the collect interval in bytes; 0 = auto from total memory
+    int pause_target_ms; // adaptive pacing target; 0 = NEPTUNE_PAUSE_TARGET_MS
+    int page_return;     // NEPTUNE_PAGES_*
+} neptune_gc_opts_t;
+
+// initializetion of GC-side globals; must run before
+// neptune_init_page_mgr so the page-return policy is in effect when the
+// page manager is built
+void neptune_init_gc(const neptune_gc_opts_t *opts,
+                     const neptune_stats_t **stats);
 
 // exit hook
 void neptune_exit_hook(void);
 
+// allocator hot-path microbenchmarks (main thread only)
+void neptune_microbench(void);
+
 // logs perm. scanned bytes to corresponding GC cache
 void neptune_log_perm_scanned_bytes(tl_gcs_t *gc, size_t perm_scanned_bytes);
 
@@ -16,6 +16,11 @@
 // original object
 #define ARRAY_INLINE_NBYTES (2048*sizeof(void*))
 
+// amortized growth schedule for resizeable arrays: percentage of the
+// current capacity added on each enlargement (100 == classic doubling)
+#define ARRAY_GROWTH_NAME               "JULIA_ARRAY_GROWTH"
+#define DEFAULT_ARRAY_GROWTH            100
+
 // codegen options ------------------------------------------------------------
 
 // (Experimental) Use MCJIT ELF, even where it's not the native format
@@ -99,6 +104,12 @@
 //#define JL_GF_PROFILE
 
 
+// system image options -------------------------------------------------------
+
+// write .ji system images LZ4-compressed; restore auto-detects the format
+#define SYSIMG_COMPRESS_NAME            "JULIA_SYSIMG_COMPRESS"
+#define DEFAULT_SYSIMG_COMPRESS         0
+
 // task options ---------------------------------------------------------------
 
 // select an implementation of stack switching.
@@ -124,6 +135,13 @@
 #define MACHINE_EXCLUSIVE_NAME          "JULIA_EXCLUSIVE"
 #define DEFAULT_MACHINE_EXCLUSIVE       0
 
+// dynamic (work-stealing) scheduling of `@threads` iteration ranges
+#define THREADS_DYNAMIC_NAME            "JULIA_THREADS_DYNAMIC"
+#define DEFAULT_THREADS_DYNAMIC         0
+
+// topology-aware thread placement: compact, scatter or node:N
+#define THREAD_POLICY_NAME              "JULIA_THREAD_POLICY"
+
 
 // sanitizer defaults ---------------------------------------------------------
 
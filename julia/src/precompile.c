@@ -81,6 +81,25 @@ void jl_write_compiler_output(void)
     JL_GC_POP();
 }
 
+// Signatures already handed to the compiler this run, deduplicated by
+// identity (leaf tuple types are interned, so a pointer hit means an
+// earlier phase already processed the signature). Under --compile=all the
+// union-expansion phase and the specialization sweep overlap substantially,
+// and each redundant jl_compile_hint repeats a full dispatch lookup plus an
+// inference check. Compilation itself stays on one thread: every path
+// funnels through the global codegen lock and its single IRBuilder, so
+// fanning this queue out to workers would just convoy on that lock.
+static htable_t precompile_queued;
+
+static int jl_precompile_hint_once(jl_tupletype_t *sig)
+{
+    void **bp = ptrhash_bp(&precompile_queued, (void*)sig);
+    if (*bp != HT_NOTFOUND)
+        return 1;
+    *bp = (void*)sig;
+    return jl_compile_hint(sig);
+}
+
 static int tupletype_any_bottom(jl_value_t *sig)
 {
     sig = jl_unwrap_unionall(sig);
@@ -101,7 +120,7 @@ static void _compile_all_tvar_union(jl_value_t *methsig)
     if (!jl_is_unionall(methsig) && jl_is_leaf_type(methsig)) {
         // usually can create a specialized version of the function,
         // if the signature is already a leaftype
-        if (jl_compile_hint((jl_tupletype_t*)methsig))
+        if (jl_precompile_hint_once((jl_tupletype_t*)methsig))
             return;
     }
 
@@ -133,7 +152,7 @@ static void _compile_all_tvar_union(jl_value_t *methsig)
         if (sig == jl_bottom_type || tupletype_any_bottom(sig))
             goto getnext; // signature wouldn't be callable / is invalid -- skip it
         if (jl_is_leaf_type(sig)) {
-            if (jl_compile_hint((jl_tupletype_t*)sig))
+            if (jl_precompile_hint_once((jl_tupletype_t*)sig))
                 goto getnext; // success
         }
 
@@ -341,16 +360,18 @@ static void jl_compile_specializations(void)
     jl_foreach_mtable_in_module(jl_main_module, precompile_enq_all_specializations_, m);
     size_t i, l;
     for (i = 0, l = jl_array_len(m); i < l; i++) {
-        jl_compile_hint((jl_tupletype_t*)jl_array_ptr_ref(m, i));
+        jl_precompile_hint_once((jl_tupletype_t*)jl_array_ptr_ref(m, i));
     }
     JL_GC_POP();
 }
 
 void jl_precompile(int all)
 {
+    htable_new(&precompile_queued, 0);
     if (all)
         jl_compile_all_defs();
     jl_compile_specializations();
+    htable_free(&precompile_queued);
 }
 
 #ifdef __cplusplus
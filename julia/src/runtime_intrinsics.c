@@ -142,15 +142,13 @@ static inline char usignbitbyte(void *a, unsigned bytes)
 
 static inline unsigned select_by_size(unsigned sz)
 {
-    /* choose the right sized function specialization */
-    switch (sz) {
-    default: return 0;
-    case  1: return 1;
-    case  2: return 2;
-    case  4: return 3;
-    case  8: return 4;
-    case 16: return 5;
-    }
+    /* choose the right sized function specialization; primitive sizes
+       are 1, 2, 4, 8 or 16 bytes and anything else takes the generic
+       slot, so a table lookup replaces the branch ladder */
+    static const uint8_t index_by_size[17] = {
+        0, 1, 2, 0, 3, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0, 0, 5
+    };
+    return sz > 16 ? 0 : index_by_size[sz];
 }
 
 #define SELECTOR_FUNC(intrinsic) \
@@ -162,6 +160,18 @@ static inline unsigned select_by_size(unsigned sz)
         return thunk; \
     }
 
+// float counterpart of SELECTOR_FUNC: only the 32- and 64-bit slots are
+// ever populated, and an empty slot is a user error rather than a
+// fallback to a generic implementation
+#define FP_SELECTOR_FUNC(intrinsic) \
+    static inline intrinsic##_t select_fp_##intrinsic(unsigned sz, const select_##intrinsic##_t list, const char *name) \
+    { \
+        intrinsic##_t thunk = list[select_by_size(sz)]; \
+        if (!thunk) \
+            jl_errorf("%s: runtime floating point intrinsics are not implemented for bit sizes other than 32 and 64", name); \
+        return thunk; \
+    }
+
 #define fp_select(a, func) \
     sizeof(a) == sizeof(float) ? func##f((float)a) : func(a)
 #define fp_select2(a, b, func) \
@@ -266,6 +276,7 @@ static void jl_##name##nbits(unsigned runtime_nbits, void *pa, void *pb, void *p
 
 typedef void (*intrinsic_1_t)(unsigned, void*, void*);
 SELECTOR_FUNC(intrinsic_1)
+FP_SELECTOR_FUNC(intrinsic_1)
 #define un_iintrinsic(name, u) \
 JL_DLLEXPORT jl_value_t *jl_##name(jl_value_t *a) \
 { \
@@ -412,9 +423,12 @@ static inline jl_value_t *jl_intrinsic_cvt(jl_value_t *ty, jl_value_t *a, const
 #define un_fintrinsic_withtype(OP, name) \
 un_fintrinsic_ctype(OP, jl_##name##32, float) \
 un_fintrinsic_ctype(OP, jl_##name##64, double) \
+static const select_intrinsic_1_t name##_flist = { \
+    NULL, NULL, NULL, jl_##name##32, jl_##name##64, \
+}; \
 JL_DLLEXPORT jl_value_t *jl_##name(jl_value_t *ty, jl_value_t *a) \
 { \
-    return jl_fintrinsic_1(ty, a, #name, jl_##name##32, jl_##name##64); \
+    return jl_fintrinsic_1(ty, a, #name, name##_flist); \
 }
 
 #define un_fintrinsic(OP, name) \
@@ -424,30 +438,18 @@ JL_DLLEXPORT jl_value_t *jl_##name(jl_value_t *a) \
     return jl_##name##_withtype(jl_typeof(a), a); \
 }
 
-typedef void (fintrinsic_op1)(unsigned, void*, void*);
-
-static inline jl_value_t *jl_fintrinsic_1(jl_value_t *ty, jl_value_t *a, const char *name, fintrinsic_op1 *floatop, fintrinsic_op1 *doubleop)
+static inline jl_value_t *jl_fintrinsic_1(jl_value_t *ty, jl_value_t *a, const char *name, const select_intrinsic_1_t list)
 {
     jl_ptls_t ptls = jl_get_ptls_states();
     if (!jl_is_primitivetype(jl_typeof(a)))
         jl_errorf("%s: value is not a primitive type", name);
     if (!jl_is_primitivetype(ty))
         jl_errorf("%s: type is not a primitive type", name);
+    /* select the c-type operation by the size of the input */
+    intrinsic_1_t op = select_fp_intrinsic_1(jl_datatype_size(jl_typeof(a)), list, name);
     unsigned sz2 = jl_datatype_size(ty);
     jl_value_t *newv = jl_gc_alloc(ptls, sz2, ty);
-    void *pa = jl_data_ptr(a), *pr = jl_data_ptr(newv);
-    unsigned sz = jl_datatype_size(jl_typeof(a));
-    switch (sz) {
-    /* choose the right size c-type operation based on the input */
-    case 4:
-        floatop(sz2 * host_char_bit, pa, pr);
-        break;
-    case 8:
-        doubleop(sz2 * host_char_bit, pa, pr);
-        break;
-    default:
-        jl_errorf("%s: runtime floating point intrinsics are not implemented for bit sizes other than 32 and 64", name);
-    }
+    op(sz2 * host_char_bit, jl_data_ptr(a), jl_data_ptr(newv));
     return newv;
 }
 
@@ -457,6 +459,7 @@ static inline jl_value_t *jl_fintrinsic_1(jl_value_t *ty, jl_value_t *a, const c
 
 typedef void (*intrinsic_2_t)(unsigned, void*, void*, void*);
 SELECTOR_FUNC(intrinsic_2)
+FP_SELECTOR_FUNC(intrinsic_2)
 #define bi_iintrinsic(name, u, cvtb) \
 JL_DLLEXPORT jl_value_t *jl_##name(jl_value_t *a, jl_value_t *b) \
 { \
@@ -480,6 +483,7 @@ bi_iintrinsic(name, u, cvtb)
 
 typedef int (*intrinsic_cmp_t)(unsigned, void*, void*);
 SELECTOR_FUNC(intrinsic_cmp)
+FP_SELECTOR_FUNC(intrinsic_cmp)
 #define cmp_iintrinsic(name, u) \
 JL_DLLEXPORT jl_value_t *jl_##name(jl_value_t *a, jl_value_t *b) \
 { \
@@ -621,6 +625,9 @@ static inline jl_value_t *jl_intrinsiclambda_checkeddiv(jl_value_t *ty, void *pa
 #define bi_fintrinsic(OP, name) \
     bi_intrinsic_ctype(OP, name, 32, float) \
     bi_intrinsic_ctype(OP, name, 64, double) \
+static const select_intrinsic_2_t name##_flist = { \
+    NULL, NULL, NULL, jl_##name##32, jl_##name##64, \
+}; \
 JL_DLLEXPORT jl_value_t *jl_##name(jl_value_t *a, jl_value_t *b) \
 { \
     jl_ptls_t ptls = jl_get_ptls_states();\
@@ -630,25 +637,19 @@ JL_DLLEXPORT jl_value_t *jl_##name(jl_value_t *a, jl_value_t *b) \
     if (!jl_is_primitivetype(ty)) \
         jl_error(#name ": values are not primitive types"); \
     int sz = jl_datatype_size(ty); \
+    /* select the right size c-type operation */ \
+    intrinsic_2_t op = select_fp_intrinsic_2(sz, name##_flist, #name); \
     jl_value_t *newv = jl_gc_alloc(ptls, sz, ty);          \
-    void *pa = jl_data_ptr(a), *pb = jl_data_ptr(b), *pr = jl_data_ptr(newv); \
-    switch (sz) { \
-    /* choose the right size c-type operation */ \
-    case 4: \
-        jl_##name##32(32, pa, pb, pr); \
-        break; \
-    case 8: \
-        jl_##name##64(64, pa, pb, pr); \
-        break; \
-    default: \
-        jl_error(#name ": runtime floating point intrinsics are not implemented for bit sizes other than 32 and 64"); \
-    } \
+    op(sz * host_char_bit, jl_data_ptr(a), jl_data_ptr(b), jl_data_ptr(newv)); \
     return newv; \
 }
 
 #define bool_fintrinsic(OP, name) \
     bool_intrinsic_ctype(OP, name, 32, float) \
     bool_intrinsic_ctype(OP, name, 64, double) \
+static const select_intrinsic_cmp_t name##_flist = { \
+    NULL, NULL, NULL, jl_##name##32, jl_##name##64, \
+}; \
 JL_DLLEXPORT jl_value_t *jl_##name(jl_value_t *a, jl_value_t *b) \
 { \
     jl_value_t *ty = jl_typeof(a); \
@@ -656,26 +657,23 @@ JL_DLLEXPORT jl_value_t *jl_##name(jl_value_t *a, jl_value_t *b) \
         jl_error(#name ": types of a and b must match"); \
     if (!jl_is_primitivetype(ty)) \
         jl_error(#name ": values are not primitive types"); \
-    void *pa = jl_data_ptr(a), *pb = jl_data_ptr(b); \
     int sz = jl_datatype_size(ty); \
-    int cmp; \
-    switch (sz) { \
-    /* choose the right size c-type operation */ \
-    case 4: \
-        cmp = jl_##name##32(32, pa, pb); \
-        break; \
-    case 8: \
-        cmp = jl_##name##64(64, pa, pb); \
-        break; \
-    default: \
-        jl_error(#name ": runtime floating point intrinsics are not implemented for bit sizes other than 32 and 64"); \
-    } \
+    /* select the right size c-type operation */ \
+    intrinsic_cmp_t op = select_fp_intrinsic_cmp(sz, name##_flist, #name); \
+    int cmp = op(sz * host_char_bit, jl_data_ptr(a), jl_data_ptr(b)); \
     return cmp ? jl_true : jl_false; \
 }
 
+typedef void (*intrinsic_3_t)(unsigned, void*, void*, void*, void*);
+typedef intrinsic_3_t select_intrinsic_3_t[6];
+FP_SELECTOR_FUNC(intrinsic_3)
+
 #define ter_fintrinsic(OP, name) \
     ter_intrinsic_ctype(OP, name, 32, float) \
     ter_intrinsic_ctype(OP, name, 64, double) \
+static const select_intrinsic_3_t name##_flist = { \
+    NULL, NULL, NULL, jl_##name##32, jl_##name##64, \
+}; \
 JL_DLLEXPORT jl_value_t *jl_##name(jl_value_t *a, jl_value_t *b, jl_value_t *c) \
 { \
     jl_ptls_t ptls = jl_get_ptls_states();\
@@ -685,19 +683,10 @@ JL_DLLEXPORT jl_value_t *jl_##name(jl_value_t *a, jl_value_t *b, jl_value_t *c)
     if (!jl_is_primitivetype(ty)) \
         jl_error(#name ": values are not primitive types"); \
     int sz = jl_datatype_size(ty);                                      \
+    /* select the right size c-type operation */ \
+    intrinsic_3_t op = select_fp_intrinsic_3(sz, name##_flist, #name); \
     jl_value_t *newv = jl_gc_alloc(ptls, sz, ty);                       \
-    void *pa = jl_data_ptr(a), *pb = jl_data_ptr(b), *pc = jl_data_ptr(c), *pr = jl_data_ptr(newv); \
-    switch (sz) { \
-    /* choose the right size c-type operation */ \
-    case 4: \
-        jl_##name##32(32, pa, pb, pc, pr); \
-        break; \
-    case 8: \
-        jl_##name##64(64, pa, pb, pc, pr); \
-        break; \
-    default: \
-        jl_error(#name ": runtime floating point intrinsics are not implemented for bit sizes other than 32 and 64"); \
-    } \
+    op(sz * host_char_bit, jl_data_ptr(a), jl_data_ptr(b), jl_data_ptr(c), jl_data_ptr(newv)); \
     return newv; \
 }
 
@@ -3,12 +3,20 @@
 #include "julia.h"
 #include "julia_internal.h"
 #include "threading.h"
+#include <inttypes.h>
 #ifndef _OS_WINDOWS_
 #include <sys/mman.h>
+#include <sched.h>
 #if defined(_OS_DARWIN_) && !defined(MAP_ANONYMOUS)
 #define MAP_ANONYMOUS MAP_ANON
 #endif
 #endif
+#ifdef _OS_LINUX_
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,6 +53,107 @@ uint8_t jl_safepoint_enable_cnt[3] = {0, 0, 0};
 // Acquiring and releasing this lock should use the `jl_mutex_*_nogc` functions
 jl_mutex_t safepoint_lock;
 
+// Waiting for the GC by spinning steals cycles from the threads we
+// are waiting for once there are more Julia threads than cores. Spin
+// briefly for the common fast rendezvous, then sleep in the kernel:
+// on Linux a futex on `jl_gc_running` that `jl_safepoint_end_gc`
+// wakes explicitly, elsewhere a plain yield. The spin bound adapts --
+// it shrinks every time a waiter ends up sleeping and grows back when
+// spinning was enough -- so oversubscribed machines converge on
+// sleeping quickly. The raw futex syscall is fine here even though
+// waiters can be inside the segfault handler.
+#define SAFEPOINT_SPIN_MIN 32
+#define SAFEPOINT_SPIN_MAX 8192
+static uint32_t safepoint_spin_limit = 256;
+
+#ifdef _OS_LINUX_
+static void jl_safepoint_futex_wait(volatile uint32_t *addr, uint32_t val)
+{
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+static void jl_safepoint_futex_wake(volatile uint32_t *addr)
+{
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+#endif
+
+static void jl_safepoint_yield(void)
+{
+#ifdef _OS_WINDOWS_
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+// Time-to-safepoint instrumentation. Pause outliers are often a
+// single thread being slow to park rather than the GC itself being
+// slow, but nothing used to measure that. `jl_safepoint_start_gc`
+// stamps the moment the safepoint pages are armed and each thread
+// records the delta once per rendezvous when it parks, either through
+// `jl_gc_state_set` or by faulting into `jl_safepoint_wait_gc`.
+// Samples land in per-thread log2 histograms that the exit hook dumps
+// via `jl_safepoint_print_tts`.
+#define TTS_BUCKETS 22 // bucket 0 is < ~1us, doubling up to >= ~1s
+JL_DLLEXPORT volatile uint8_t jl_safepoint_tts_armed = 0;
+static volatile uint64_t safepoint_tts_t0 = 0;
+static volatile uint64_t safepoint_tts_epoch = 0;
+static uint64_t *tts_seen_epoch = NULL;
+static uint64_t *tts_hist = NULL; // jl_n_threads rows of TTS_BUCKETS
+static uint64_t *tts_max = NULL;
+
+JL_DLLEXPORT void jl_safepoint_note_tts(int16_t tid)
+{
+    // only reads and writes of statics, so this is safe to call from
+    // the segfault handler
+    uint64_t t0 = safepoint_tts_t0;
+    if (!t0 || !tts_hist || tid < 0 || tid >= jl_n_threads)
+        return;
+    uint64_t epoch = safepoint_tts_epoch;
+    if (tts_seen_epoch[tid] == epoch)
+        return; // already recorded for this rendezvous
+    tts_seen_epoch[tid] = epoch;
+    // jl_hrtime_fast, not jl_hrtime: this runs in the segfault handler
+    // where a clock_gettime syscall is unwelcome
+    uint64_t dt = jl_hrtime_fast() - t0;
+    int b = 0;
+    while (b < TTS_BUCKETS - 1 && dt >= ((uint64_t)1024 << b))
+        b++;
+    tts_hist[tid * TTS_BUCKETS + b]++;
+    if (dt > tts_max[tid])
+        tts_max[tid] = dt;
+}
+
+JL_DLLEXPORT void jl_safepoint_print_tts(void)
+{
+    if (!tts_hist)
+        return;
+    for (int tid = 0; tid < jl_n_threads; tid++) {
+        uint64_t *hist = &tts_hist[tid * TTS_BUCKETS];
+        uint64_t n = 0;
+        for (int b = 0; b < TTS_BUCKETS; b++)
+            n += hist[b];
+        if (n == 0)
+            continue;
+        jl_safe_printf("time-to-safepoint, thread %d: %" PRIu64
+                       " samples, max %" PRIu64 " us\n",
+                       tid, n, tts_max[tid] / 1000);
+        for (int b = 0; b < TTS_BUCKETS; b++) {
+            if (hist[b] == 0)
+                continue;
+            // bucket b covers [2^(b-1), 2^b) us, roughly
+            if (b == 0)
+                jl_safe_printf("    < 1 us: %" PRIu64 "\n", hist[b]);
+            else if (b == TTS_BUCKETS - 1)
+                jl_safe_printf("    >= %u us: %" PRIu64 "\n",
+                               1u << (b - 1), hist[b]);
+            else
+                jl_safe_printf("    %u - %u us: %" PRIu64 "\n",
+                               1u << (b - 1), 1u << b, hist[b]);
+        }
+    }
+}
+
 static void jl_safepoint_enable(int idx)
 {
     // safepoint_lock should be held
@@ -124,6 +233,16 @@ int jl_safepoint_start_gc(void)
     }
     jl_safepoint_enable(1);
     jl_safepoint_enable(2);
+    // stamp the rendezvous for time-to-safepoint accounting
+    if (!tts_hist) {
+        tts_seen_epoch = (uint64_t*)calloc(jl_n_threads, sizeof(uint64_t));
+        tts_hist = (uint64_t*)calloc(jl_n_threads * TTS_BUCKETS,
+                                     sizeof(uint64_t));
+        tts_max = (uint64_t*)calloc(jl_n_threads, sizeof(uint64_t));
+    }
+    safepoint_tts_epoch++;
+    safepoint_tts_t0 = jl_hrtime_fast();
+    jl_safepoint_tts_armed = 1;
     jl_mutex_unlock_nogc(&safepoint_lock);
     return 1;
 #else
@@ -145,7 +264,16 @@ void jl_safepoint_end_gc(void)
     // the signal handler.
     jl_safepoint_disable(2);
     jl_safepoint_disable(1);
+    // reinstate bump spans the rendezvous revoked and that no sweep
+    // has since replaced
+    jl_gc_restore_bump_limits();
+    jl_safepoint_tts_armed = 0;
+    safepoint_tts_t0 = 0;
     jl_atomic_store_release(&jl_gc_running, 0);
+#  ifdef _OS_LINUX_
+    // wake every thread that gave up spinning in jl_safepoint_wait_gc
+    jl_safepoint_futex_wake(&jl_gc_running);
+#  endif
 #  ifdef __APPLE__
     // This wakes up other threads on mac.
     jl_mach_gc_end();
@@ -161,11 +289,33 @@ void jl_safepoint_wait_gc(void)
 #ifdef JULIA_ENABLE_THREADING
     // The thread should have set this is already
     assert(jl_get_ptls_states()->gc_state != 0);
+    // covers threads parked by the safepoint fault, whose gc_state is
+    // set directly in the signal handler
+    jl_safepoint_note_tts(jl_get_ptls_states()->tid);
+    uint32_t spins = 0;
+    uint32_t limit = safepoint_spin_limit;
+    int slept = 0;
     // Use normal volatile load in the loop.
     // Use a acquire load to make sure the GC result is visible on this thread.
     while (jl_gc_running || jl_atomic_load_acquire(&jl_gc_running)) {
-        jl_cpu_pause(); // yield?
+        if (spins++ < limit) {
+            jl_cpu_pause();
+            continue;
+        }
+        if (!slept) {
+            slept = 1;
+            // racy updates are fine, this is only a hint
+            if (safepoint_spin_limit > SAFEPOINT_SPIN_MIN)
+                safepoint_spin_limit /= 2;
+        }
+#ifdef _OS_LINUX_
+        jl_safepoint_futex_wait(&jl_gc_running, 1);
+#else
+        jl_safepoint_yield();
+#endif
     }
+    if (!slept && safepoint_spin_limit < SAFEPOINT_SPIN_MAX)
+        safepoint_spin_limit *= 2;
 #else
     assert(0 && "No one should wait for the GC on another thread");
 #endif
@@ -13,9 +13,20 @@ extern "C" {
 #include <threading.h>
 
 // Profiler control variables //
-static volatile intptr_t *bt_data_prof = NULL;
-static volatile size_t bt_size_max = 0;
-static volatile size_t bt_size_cur = 0;
+// Samples land in per-thread buffers: the sampling thread is the only
+// writer of each buffer and publishes the cursor with a release store, so
+// the merging reader (jl_profile_merge, called from Julia when the data is
+// fetched) never observes a partially written block and needs no lock.
+typedef struct {
+    intptr_t *data;
+    size_t len; // published write cursor, in words
+    size_t max;
+} jl_prof_buf_t;
+static jl_prof_buf_t *prof_bufs = NULL; // one per thread
+static int prof_nbufs = 0;
+static volatile intptr_t *bt_data_prof = NULL; // merged view handed to callers
+static volatile size_t bt_size_max = 0;        // total capacity across threads
+static volatile size_t bt_size_cur = 0;        // merged length
 static volatile uint64_t nsecprof = 0;
 static volatile int running = 0;
 static const    uint64_t GIGA = 1000000000ULL;
@@ -23,6 +34,26 @@ static const    uint64_t GIGA = 1000000000ULL;
 JL_DLLEXPORT void jl_profile_stop_timer(void);
 JL_DLLEXPORT int jl_profile_start_timer(void);
 
+// record one sample for thread `tid` from `ctx`; returns 0 once every
+// thread's buffer is full, at which point the caller should stop the timer
+static int jl_profile_record_ctx(int tid, bt_context_t *ctx)
+{
+    jl_prof_buf_t *pb = &prof_bufs[tid];
+    size_t len = pb->len;
+    if (len < pb->max - 1) {
+        size_t n = rec_backtrace_ctx((uintptr_t*)pb->data + len,
+                                     pb->max - len - 1, ctx);
+        // mark the end of this block with 0, then publish
+        pb->data[len + n] = 0;
+        jl_atomic_store_release(&pb->len, len + n + 1);
+    }
+    for (int i = 0; i < prof_nbufs; i++) {
+        if (prof_bufs[i].len < prof_bufs[i].max - 1)
+            return 1;
+    }
+    return 0;
+}
+
 static uint64_t jl_last_sigint_trigger = 0;
 static uint64_t jl_disable_sigint_time = 0;
 static void jl_clear_force_sigint(void)
@@ -82,9 +113,24 @@ static int jl_ignore_sigint(void)
     return jl_disable_sigint_time && jl_disable_sigint_time > uv_hrtime();
 }
 
+// Under --minimal-init startup leaves the signal handlers uninstalled;
+// the subsystems that depend on them (the profiler, sigint control)
+// call this on first use. A no-op everywhere else.
+static int jl_sighandlers_installed = 0;
+JL_DLLEXPORT void jl_ensure_signal_handlers(void)
+{
+    if (jl_sighandlers_installed || !jl_options.minimal_init ||
+        jl_options.handle_signals != JL_OPTIONS_HANDLE_SIGNALS_ON)
+        return;
+    jl_sighandlers_installed = 1;
+    jl_install_default_signal_handlers();
+    jl_install_sigint_handler();
+}
+
 static int exit_on_sigint = 0;
 JL_DLLEXPORT void jl_exit_on_sigint(int on)
 {
+    jl_ensure_signal_handlers();
     exit_on_sigint = on;
 }
 
@@ -117,24 +163,63 @@ void jl_critical_error(int sig, bt_context_t *context, uintptr_t *bt_data, size_
 ///////////////////////
 JL_DLLEXPORT int jl_profile_init(size_t maxsize, uint64_t delay_nsec)
 {
-    bt_size_max = maxsize;
+    int nthreads = jl_n_threads > 0 ? jl_n_threads : 1;
     nsecprof = delay_nsec;
+    if (prof_bufs != NULL) {
+        for (int i = 0; i < prof_nbufs; i++)
+            free(prof_bufs[i].data);
+        free(prof_bufs);
+        prof_bufs = NULL;
+    }
     if (bt_data_prof != NULL)
         free((void*)bt_data_prof);
+    bt_size_max = maxsize;
+    bt_size_cur = 0;
+    prof_nbufs = 0;
     bt_data_prof = (intptr_t*) calloc(maxsize, sizeof(intptr_t));
     if (bt_data_prof == NULL && maxsize > 0)
         return -1;
-    bt_size_cur = 0;
+    // split the capacity evenly between the threads' sample buffers; the
+    // flat buffer above holds the merged view
+    prof_bufs = (jl_prof_buf_t*) calloc(nthreads, sizeof(jl_prof_buf_t));
+    if (prof_bufs == NULL)
+        return -1;
+    for (int i = 0; i < nthreads; i++) {
+        prof_bufs[i].max = maxsize / nthreads;
+        prof_bufs[i].data = (intptr_t*) calloc(prof_bufs[i].max, sizeof(intptr_t));
+        if (prof_bufs[i].data == NULL && prof_bufs[i].max > 0)
+            return -1;
+    }
+    prof_nbufs = nthreads;
     return 0;
 }
 
+// rebuild the flat merged view from the per-thread buffers. Only a
+// consistent prefix of each buffer is copied thanks to the acquire load of
+// the cursor, so this is safe while the profiler is running.
+static void jl_profile_merge(void)
+{
+    size_t tot = 0;
+    for (int i = 0; i < prof_nbufs; i++) {
+        size_t len = jl_atomic_load_acquire(&prof_bufs[i].len);
+        memcpy((intptr_t*)bt_data_prof + tot, prof_bufs[i].data,
+               len * sizeof(intptr_t));
+        tot += len;
+    }
+    bt_size_cur = tot;
+}
+
 JL_DLLEXPORT uint8_t *jl_profile_get_data(void)
 {
+    if (prof_bufs != NULL)
+        jl_profile_merge();
     return (uint8_t*) bt_data_prof;
 }
 
 JL_DLLEXPORT size_t jl_profile_len_data(void)
 {
+    if (prof_bufs != NULL)
+        jl_profile_merge();
     return bt_size_cur;
 }
 
@@ -143,6 +228,22 @@ JL_DLLEXPORT size_t jl_profile_maxlen_data(void)
     return bt_size_max;
 }
 
+// per-thread access to the raw samples, for tools that want to keep the
+// thread attribution the merged view flattens away
+JL_DLLEXPORT uint8_t *jl_profile_get_data_thread(int tid)
+{
+    if (tid < 0 || tid >= prof_nbufs)
+        return NULL;
+    return (uint8_t*) prof_bufs[tid].data;
+}
+
+JL_DLLEXPORT size_t jl_profile_len_data_thread(int tid)
+{
+    if (tid < 0 || tid >= prof_nbufs)
+        return 0;
+    return jl_atomic_load_acquire(&prof_bufs[tid].len);
+}
+
 JL_DLLEXPORT uint64_t jl_profile_delay_nsec(void)
 {
     return nsecprof;
@@ -150,6 +251,8 @@ JL_DLLEXPORT uint64_t jl_profile_delay_nsec(void)
 
 JL_DLLEXPORT void jl_profile_clear_data(void)
 {
+    for (int i = 0; i < prof_nbufs; i++)
+        jl_atomic_store_release(&prof_bufs[i].len, 0);
     bt_size_cur = 0;
 }
 
@@ -424,9 +424,11 @@ void *mach_profile_listener(void *arg)
         // sample each thread, round-robin style in reverse order
         // (so that thread zero gets notified last)
         for (i = jl_n_threads; i-- > 0; ) {
-            // if there is no space left, break early
-            if (bt_size_cur >= bt_size_max - 1)
-                break;
+            // if there is no space left in this thread's buffer, skip it
+            jl_prof_buf_t *pb = &prof_bufs[i];
+            size_t len = pb->len;
+            if (len >= pb->max - 1)
+                continue;
 
             unw_context_t *uc;
             jl_thread_suspend_and_get_state(i, &uc);
@@ -451,10 +453,10 @@ void *mach_profile_listener(void *arg)
 
             if (forceDwarf == 0) {
                 // Save the backtrace
-                bt_size_cur += rec_backtrace_ctx((uintptr_t*)bt_data_prof + bt_size_cur, bt_size_max - bt_size_cur - 1, uc);
+                len += rec_backtrace_ctx((uintptr_t*)pb->data + len, pb->max - len - 1, uc);
             }
             else if (forceDwarf == 1) {
-                bt_size_cur += rec_backtrace_ctx_dwarf((uintptr_t*)bt_data_prof + bt_size_cur, bt_size_max - bt_size_cur - 1, uc);
+                len += rec_backtrace_ctx_dwarf((uintptr_t*)pb->data + len, pb->max - len - 1, uc);
             }
             else if (forceDwarf == -1) {
                 jl_safe_printf("WARNING: profiler attempt to access an invalid memory location\n");
@@ -462,11 +464,12 @@ void *mach_profile_listener(void *arg)
 
             forceDwarf = -2;
 #else
-            bt_size_cur += rec_backtrace_ctx((uintptr_t*)bt_data_prof + bt_size_cur, bt_size_max - bt_size_cur - 1, uc);
+            len += rec_backtrace_ctx((uintptr_t*)pb->data + len, pb->max - len - 1, uc);
 #endif
 
-            // Mark the end of this block with 0
-            bt_data_prof[bt_size_cur++] = 0;
+            // Mark the end of this block with 0, then publish the cursor
+            pb->data[len] = 0;
+            jl_atomic_store_release(&pb->len, len + 1);
 
             // We're done! Resume the thread.
             jl_thread_resume(i, 0);
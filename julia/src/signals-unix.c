@@ -400,6 +400,10 @@ JL_DLLEXPORT int jl_profile_start_timer(void)
 {
     struct sigevent sigprof;
 
+    // samples are delivered over signals, so the handlers must be in
+    // place even when --minimal-init deferred them
+    jl_ensure_signal_handlers();
+
     // Establish the signal event
     memset(&sigprof, 0, sizeof(struct sigevent));
     sigprof.sigev_notify = SIGEV_SIGNAL;
@@ -435,6 +439,8 @@ struct itimerval timerprof;
 
 JL_DLLEXPORT int jl_profile_start_timer(void)
 {
+    // as above: the sampler needs the signal handlers installed
+    jl_ensure_signal_handlers();
     timerprof.it_interval.tv_sec = nsecprof/GIGA;
     timerprof.it_interval.tv_usec = (nsecprof%GIGA)/1000;
     timerprof.it_value.tv_sec = nsecprof/GIGA;
@@ -604,17 +610,10 @@ static void *signal_listener(void *arg)
                 bt_data[bt_size++] = 0;
             }
 
-            // do backtrace for profiler
+            // do backtrace for profiler, into this thread's own buffer
             if (profile && running) {
-                if (bt_size_cur < bt_size_max - 1) {
-                    // Get backtrace data
-                    bt_size_cur += rec_backtrace_ctx((uintptr_t*)bt_data_prof + bt_size_cur,
-                            bt_size_max - bt_size_cur - 1, signal_context);
-                    // Mark the end of this block with 0
-                    bt_data_prof[bt_size_cur++] = 0;
-                }
-                if (bt_size_cur >= bt_size_max - 1) {
-                    // Buffer full: Delete the timer
+                if (!jl_profile_record_ctx(i, signal_context)) {
+                    // All buffers full: Delete the timer
                     jl_profile_stop_timer();
                 }
             }
@@ -334,7 +334,8 @@ static DWORD WINAPI profile_bt( LPVOID lparam )
         return 0;
     }
     while (1) {
-        if (running && bt_size_cur < bt_size_max) {
+        if (running && prof_nbufs > 0 &&
+            prof_bufs[0].len < prof_bufs[0].max - 1) {
             DWORD timeout = nsecprof/GIGA;
             timeout = min(max(timeout,tc.wPeriodMin*2),tc.wPeriodMax/2);
             Sleep(timeout);
@@ -349,12 +350,8 @@ static DWORD WINAPI profile_bt( LPVOID lparam )
                 fputs("failed to get context from main thread. aborting profiling.",stderr);
                 break;
             }
-            // Get backtrace data
-            bt_size_cur += rec_backtrace_ctx((uintptr_t*)bt_data_prof + bt_size_cur,
-                bt_size_max - bt_size_cur - 1, &ctxThread);
-            // Mark the end of this block with 0
-            bt_data_prof[bt_size_cur] = 0;
-            bt_size_cur++;
+            // Get backtrace data (only the main thread is sampled here)
+            jl_profile_record_ctx(0, &ctxThread);
             if ((DWORD)-1 == ResumeThread(hMainThread)) {
                 fputs("failed to resume main thread! aborting.",stderr);
                 gc_debug_critical_error();
@@ -941,6 +941,35 @@ JL_DLLEXPORT int jl_subtype_env_size(jl_value_t *t)
     return sz;
 }
 
+// quick supertype-chain walk for datatype <: datatype queries with no
+// typevars on either side, the common shape of type-assert and dispatch
+// guard checks. tuples are covariant and Type/Vararg have special rules,
+// so those are left to the full algorithm. a name match with different
+// objects is inconclusive (only interned instances compare by pointer)
+// and also falls back. returns -1 if inconclusive.
+static int fast_datatype_subtype(jl_value_t *x, jl_value_t *y)
+{
+    if (!jl_is_datatype(x) || !jl_is_datatype(y))
+        return -1;
+    jl_datatype_t *xd = (jl_datatype_t*)x, *yd = (jl_datatype_t*)y;
+    if (xd->hasfreetypevars || yd->hasfreetypevars)
+        return -1;
+    if (xd->name == jl_tuple_typename || yd->name == jl_tuple_typename ||
+        xd->name == jl_type_typename || yd->name == jl_type_typename ||
+        xd->name == jl_vararg_typename || yd->name == jl_vararg_typename)
+        return -1;
+    while ((jl_value_t*)xd != (jl_value_t*)jl_any_type) {
+        if (xd == yd)
+            return 1;
+        if (xd->name == yd->name)
+            return -1;
+        if (xd->super == NULL) // partially initialized (bootstrap)
+            return -1;
+        xd = xd->super;
+    }
+    return 0;
+}
+
 // `env` is NULL if no typevar information is requested, or otherwise
 // points to a rooted array of length `jl_subtype_env_size(y)`.
 // This will be populated with the values of variables from unionall
@@ -948,8 +977,13 @@ JL_DLLEXPORT int jl_subtype_env_size(jl_value_t *t)
 JL_DLLEXPORT int jl_subtype_env(jl_value_t *x, jl_value_t *y, jl_value_t **env, int envsz)
 {
     jl_stenv_t e;
-    if (envsz == 0 && (y == (jl_value_t*)jl_any_type || x == jl_bottom_type || x == y))
-        return 1;
+    if (envsz == 0) {
+        if (y == (jl_value_t*)jl_any_type || x == jl_bottom_type || x == y)
+            return 1;
+        int fast = fast_datatype_subtype(x, y);
+        if (fast >= 0)
+            return fast;
+    }
     init_stenv(&e, env, envsz);
     return forall_exists_subtype(x, y, &e);
 }
@@ -2066,9 +2100,60 @@ jl_value_t *jl_type_intersection_env(jl_value_t *a, jl_value_t *b, jl_svec_t **p
     return jl_type_intersection_env_s(a, b, penv, NULL);
 }
 
+// --- memoized type intersection ---
+
+// method insertion and ambiguity checking ask for the same intersections
+// over and over, so remember recent answers in a direct-mapped table keyed
+// on the identity of the pair. the table is GC-rooted and flushed whenever
+// the world counter moves, which also bounds how stale it can get.
+#define INTERSECT_CACHE_SIZE 1024 // must be a power-of-two; 3 slots per entry
+jl_array_t *jl_intersect_cache = NULL;
+static size_t intersect_cache_world = 0;
+static jl_mutex_t intersect_cache_lock;
+
+STATIC_INLINE size_t intersect_cache_idx(jl_value_t *a, jl_value_t *b)
+{
+    uintptr_t h = ((uintptr_t)a >> 4) * 2654435761u;
+    h ^= ((uintptr_t)b >> 4) * 40503u;
+    return (h & (INTERSECT_CACHE_SIZE - 1)) * 3;
+}
+
 JL_DLLEXPORT jl_value_t *jl_type_intersection(jl_value_t *a, jl_value_t *b)
 {
-    return jl_type_intersection_env(a, b, NULL);
+    size_t i = intersect_cache_idx(a, b);
+    JL_LOCK_NOGC(&intersect_cache_lock);
+    if (jl_intersect_cache != NULL && intersect_cache_world == jl_world_counter) {
+        jl_value_t **slot = (jl_value_t**)jl_array_data(jl_intersect_cache) + i;
+        if (slot[0] == a && slot[1] == b) {
+            jl_value_t *ti = slot[2];
+            JL_UNLOCK_NOGC(&intersect_cache_lock);
+            return ti;
+        }
+    }
+    JL_UNLOCK_NOGC(&intersect_cache_lock);
+
+    jl_value_t *ti = jl_type_intersection_env(a, b, NULL);
+
+    JL_GC_PUSH1(&ti);
+    if (jl_intersect_cache == NULL) {
+        jl_array_t *c = jl_alloc_vec_any(3 * INTERSECT_CACHE_SIZE);
+        JL_LOCK_NOGC(&intersect_cache_lock);
+        if (jl_intersect_cache == NULL)
+            jl_intersect_cache = c;
+        JL_UNLOCK_NOGC(&intersect_cache_lock);
+    }
+    JL_GC_POP();
+    JL_LOCK_NOGC(&intersect_cache_lock);
+    if (intersect_cache_world != jl_world_counter) {
+        memset(jl_array_data(jl_intersect_cache), 0,
+               3 * INTERSECT_CACHE_SIZE * sizeof(void*));
+        intersect_cache_world = jl_world_counter;
+    }
+    jl_array_ptr_set(jl_intersect_cache, i, a);
+    jl_array_ptr_set(jl_intersect_cache, i + 1, b);
+    jl_array_ptr_set(jl_intersect_cache, i + 2, ti);
+    JL_UNLOCK_NOGC(&intersect_cache_lock);
+    return ti;
 }
 
 JL_DLLEXPORT jl_svec_t *jl_env_from_type_intersection(jl_value_t *a, jl_value_t *b)
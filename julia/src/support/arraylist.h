@@ -5,6 +5,8 @@
 
 #define AL_N_INLINE 29
 
+#define SMALL_AL_N_INLINE 6
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -23,6 +25,22 @@ void arraylist_push(arraylist_t *a, void *elt);
 void *arraylist_pop(arraylist_t *a);
 void arraylist_grow(arraylist_t *a, size_t n);
 
+// compact variant for lists embedded in other objects, where the 29-word
+// inline buffer of arraylist_t would dominate the containing struct
+typedef struct {
+    size_t len;
+    size_t max;
+    void **items;
+    void *_space[SMALL_AL_N_INLINE];
+} small_arraylist_t;
+
+small_arraylist_t *small_arraylist_new(small_arraylist_t *a, size_t size);
+void small_arraylist_free(small_arraylist_t *a);
+
+void small_arraylist_push(small_arraylist_t *a, void *elt);
+void *small_arraylist_pop(small_arraylist_t *a);
+void small_arraylist_grow(small_arraylist_t *a, size_t n);
+
 #ifdef __cplusplus
 }
 #endif
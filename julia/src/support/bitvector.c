@@ -56,6 +56,92 @@ uint32_t bitvector_get(uint32_t *b, uint64_t n)
     return b[n>>5] & (1<<(n&31));
 }
 
+static uint32_t bv_popcount32(uint32_t x)
+{
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    x = (x + (x >> 4)) & 0x0f0f0f0fu;
+    return (x * 0x01010101u) >> 24;
+#endif
+}
+
+static uint32_t bv_ctz32(uint32_t x)
+{
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_ctz(x);
+#else
+    uint32_t n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// number of set bits among bits [offs, offs+nbits)
+uint64_t bitvector_count(uint32_t *b, uint64_t offs, uint64_t nbits)
+{
+    if (nbits == 0)
+        return 0;
+    uint64_t first = offs >> 5;
+    uint64_t last = (offs + nbits - 1) >> 5;
+    uint32_t headmask = ~(uint32_t)0 << (offs & 31);
+    uint32_t tailmask = ~(uint32_t)0 >> (31 - ((offs + nbits - 1) & 31));
+    if (first == last)
+        return bv_popcount32(b[first] & headmask & tailmask);
+    uint64_t i, n = bv_popcount32(b[first] & headmask);
+    for (i = first + 1; i < last; i++)
+        n += bv_popcount32(b[i]);
+    return n + bv_popcount32(b[last] & tailmask);
+}
+
+// index of the first set bit at or after `n0`, or -1 if there is none
+// before `nbits`
+int64_t bitvector_next(uint32_t *b, uint64_t n0, uint64_t nbits)
+{
+    if (n0 >= nbits)
+        return -1;
+    uint64_t i = n0 >> 5;
+    uint64_t nw = (nbits + 31) >> 5;
+    uint32_t w = b[i] & (~(uint32_t)0 << (n0 & 31));
+    while (1) {
+        if (w) {
+            uint64_t n = (i << 5) + bv_ctz32(w);
+            return n < nbits ? (int64_t)n : -1;
+        }
+        if (++i >= nw)
+            return -1;
+        w = b[i];
+    }
+}
+
+// the word loops below are trivially vectorizable; keeping them plain
+// lets the compiler pick the widest ALU available
+void bitvector_and(uint32_t *dest, uint32_t *a, uint32_t *b, uint64_t nbits)
+{
+    size_t i, nw = bitvector_nwords(nbits);
+    for (i = 0; i < nw; i++)
+        dest[i] = a[i] & b[i];
+}
+
+void bitvector_or(uint32_t *dest, uint32_t *a, uint32_t *b, uint64_t nbits)
+{
+    size_t i, nw = bitvector_nwords(nbits);
+    for (i = 0; i < nw; i++)
+        dest[i] = a[i] | b[i];
+}
+
+void bitvector_andnot(uint32_t *dest, uint32_t *a, uint32_t *b, uint64_t nbits)
+{
+    size_t i, nw = bitvector_nwords(nbits);
+    for (i = 0; i < nw; i++)
+        dest[i] = a[i] & ~b[i];
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,6 +15,18 @@ size_t bitvector_nwords(uint64_t nbits);
 JL_DLLEXPORT void bitvector_set(uint32_t *b, uint64_t n, uint32_t c);
 JL_DLLEXPORT uint32_t bitvector_get(uint32_t *b, uint64_t n);
 
+// bulk operations
+JL_DLLEXPORT uint64_t bitvector_count(uint32_t *b, uint64_t offs, uint64_t nbits);
+JL_DLLEXPORT int64_t bitvector_next(uint32_t *b, uint64_t n0, uint64_t nbits);
+// the binary operations process whole words, so bits past `nbits` in the
+// last word are computed as well (the maps are sized in whole words)
+JL_DLLEXPORT void bitvector_and(uint32_t *dest, uint32_t *a, uint32_t *b,
+                                uint64_t nbits);
+JL_DLLEXPORT void bitvector_or(uint32_t *dest, uint32_t *a, uint32_t *b,
+                               uint64_t nbits);
+JL_DLLEXPORT void bitvector_andnot(uint32_t *dest, uint32_t *a, uint32_t *b,
+                                   uint64_t nbits);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,220 @@
+// This file is a part of Julia. License is MIT: http://julialang.org/license
+
+/*
+  concurrent-read pointer hash (see cptrhash.h for the contract).
+  Probing, growth policy and storage conventions match htable_t.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+
+#include "dtypes.h"
+#include "hashing.h"
+#include "htable.h" // for HT_NOTFOUND and HT_N_INLINE
+#include "cptrhash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define cph_load_acquire(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define cph_load_relaxed(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define cph_store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define cph_store_relaxed(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#else
+// MSVC targets x86, where aligned pointer accesses are atomic and
+// volatile accesses are compiled with acquire/release ordering
+#define cph_load_acquire(p) (*(void *volatile *)(p))
+#define cph_load_relaxed(p) (*(void *volatile *)(p))
+#define cph_store_release(p, v) (*(void *volatile *)(p) = (v))
+#define cph_store_relaxed(p, v) (*(void *volatile *)(p) = (v))
+#endif
+
+#define cph_max_probe(size) \
+    ((size) <= (HT_N_INLINE * 2) ? (HT_N_INLINE / 2) : (size) >> 3)
+
+static cptrhash_table_t *cph_alloc(size_t nwords)
+{
+    size_t i;
+    cptrhash_table_t *t = (cptrhash_table_t*)
+        LLT_ALLOC(sizeof(cptrhash_table_t) + (nwords - 1) * sizeof(void*));
+    if (t == NULL)
+        return NULL;
+    t->size = nwords;
+    t->next = NULL;
+    for (i = 0; i < nwords; i++)
+        t->tab[i] = HT_NOTFOUND;
+    return t;
+}
+
+// probe for `key`; returns the index of its value word, claiming an
+// empty slot if absent, or -1 when the probe limit is hit
+static ssize_t cph_insert_slot(cptrhash_table_t *t, void *key)
+{
+    size_t sz = t->size / 2;
+    size_t maxprobe = cph_max_probe(sz);
+    size_t index = (size_t)(inthash((uint_t)(uintptr_t)key) & (sz - 1)) * 2;
+    size_t orig = index, iter = 0;
+    sz *= 2;
+    do {
+        void *k = t->tab[index];
+        if (k == HT_NOTFOUND) {
+            // the key must be visible to readers no later than the
+            // value; the release store on the value orders both
+            cph_store_relaxed(&t->tab[index], key);
+            return (ssize_t)(index + 1);
+        }
+        if (k == key)
+            return (ssize_t)(index + 1);
+        index = (index + 2) & (sz - 1);
+        iter++;
+        if (iter > maxprobe)
+            break;
+    } while (index != orig);
+    return -1;
+}
+
+// grow-and-republish; returns the value-word index for `key` in the
+// new current table
+static ssize_t cph_rehash_insert(cptrhash_t *h, void *key)
+{
+    cptrhash_table_t *t = h->table;
+    size_t newsz, i;
+    // same growth policy as htable: quadruple mid-sized tables so we
+    // don't spend load time rehashing the same keys over and over
+    if (t->size >= (1 << 19) || (t->size <= (1 << 8)))
+        newsz = t->size << 1;
+    else
+        newsz = t->size << 2;
+    while (1) {
+        cptrhash_table_t *nt = cph_alloc(newsz);
+        ssize_t vi;
+        if (nt == NULL)
+            return -1;
+        for (i = 0; i < t->size; i += 2) {
+            if (t->tab[i + 1] == HT_NOTFOUND)
+                continue;
+            vi = cph_insert_slot(nt, t->tab[i]);
+            if (vi < 0)
+                break;
+            nt->tab[vi] = t->tab[i + 1];
+        }
+        if (i < t->size) {
+            // unlucky layout; try the next size up
+            LLT_FREE(nt);
+            newsz <<= 1;
+            continue;
+        }
+        vi = cph_insert_slot(nt, key);
+        if (vi < 0) {
+            LLT_FREE(nt);
+            newsz <<= 1;
+            continue;
+        }
+        nt->next = t;
+        cph_store_release(&h->table, nt);
+        return vi;
+    }
+}
+
+cptrhash_t *cptrhash_new(cptrhash_t *h, size_t size)
+{
+    size_t nwords = HT_N_INLINE;
+    while (nwords / 2 < size)
+        nwords *= 2;
+    h->table = cph_alloc(nwords);
+    if (h->table == NULL)
+        return NULL;
+    return h;
+}
+
+void cptrhash_free(cptrhash_t *h)
+{
+    cptrhash_table_t *t = h->table;
+    while (t != NULL) {
+        cptrhash_table_t *next = t->next;
+        LLT_FREE(t);
+        t = next;
+    }
+    h->table = NULL;
+}
+
+void *cptrhash_get(cptrhash_t *h, void *key)
+{
+    cptrhash_table_t *t = (cptrhash_table_t*)cph_load_acquire(&h->table);
+    size_t sz = t->size / 2;
+    size_t maxprobe = cph_max_probe(sz);
+    size_t index = (size_t)(inthash((uint_t)(uintptr_t)key) & (sz - 1)) * 2;
+    size_t orig = index, iter = 0;
+    sz *= 2;
+    do {
+        void *k = cph_load_relaxed(&t->tab[index]);
+        if (k == HT_NOTFOUND)
+            return HT_NOTFOUND;
+        if (k == key)
+            return cph_load_acquire(&t->tab[index + 1]);
+        index = (index + 2) & (sz - 1);
+        iter++;
+        if (iter > maxprobe)
+            break;
+    } while (index != orig);
+    return HT_NOTFOUND;
+}
+
+int cptrhash_has(cptrhash_t *h, void *key)
+{
+    return cptrhash_get(h, key) != HT_NOTFOUND;
+}
+
+void cptrhash_put(cptrhash_t *h, void *key, void *val)
+{
+    ssize_t vi = cph_insert_slot(h->table, key);
+    if (vi < 0)
+        vi = cph_rehash_insert(h, key);
+    if (vi >= 0)
+        cph_store_release(&h->table->tab[vi], val);
+}
+
+void cptrhash_adjoin(cptrhash_t *h, void *key, void *val)
+{
+    ssize_t vi = cph_insert_slot(h->table, key);
+    if (vi < 0)
+        vi = cph_rehash_insert(h, key);
+    if (vi >= 0 && h->table->tab[vi] == HT_NOTFOUND)
+        cph_store_release(&h->table->tab[vi], val);
+}
+
+int cptrhash_remove(cptrhash_t *h, void *key)
+{
+    // tombstone: the key stays so concurrent probes stay sound
+    cptrhash_table_t *t = h->table;
+    size_t sz = t->size / 2;
+    size_t maxprobe = cph_max_probe(sz);
+    size_t index = (size_t)(inthash((uint_t)(uintptr_t)key) & (sz - 1)) * 2;
+    size_t orig = index, iter = 0;
+    sz *= 2;
+    do {
+        void *k = t->tab[index];
+        if (k == HT_NOTFOUND)
+            return 0;
+        if (k == key) {
+            if (t->tab[index + 1] == HT_NOTFOUND)
+                return 0;
+            cph_store_release(&t->tab[index + 1], HT_NOTFOUND);
+            return 1;
+        }
+        index = (index + 2) & (sz - 1);
+        iter++;
+        if (iter > maxprobe)
+            break;
+    } while (index != orig);
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
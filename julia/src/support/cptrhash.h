@@ -0,0 +1,56 @@
+// This file is a part of Julia. License is MIT: http://julialang.org/license
+
+#ifndef CPTRHASH_H
+#define CPTRHASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+  Concurrent-read pointer hash for read-mostly caches.
+
+  Readers (cptrhash_get/has) take no lock: they acquire-load the
+  current table and probe it with atomic slot reads. Writers must be
+  serialized externally (typically by the lock that already guards the
+  cache they back). A rehash builds the bigger table in private,
+  publishes it with a release store, and chains the superseded table
+  behind it instead of freeing it, so readers that loaded the old
+  pointer can finish probing safely (RCU-style republication; growth
+  is geometric, so retired tables cost less than one extra copy).
+
+  Slots only ever go from empty to occupied - removal clears the value
+  word but leaves the key as a tombstone, like htable_t - which is
+  what makes a reader's early stop at an empty slot sound against
+  concurrent insertion.
+*/
+
+typedef struct _cptrhash_table_t {
+    size_t size;                    // length of tab[] in words, 2 per slot
+    struct _cptrhash_table_t *next; // retired predecessor, kept for readers
+    void *tab[1];
+} cptrhash_table_t;
+
+typedef struct {
+    cptrhash_table_t *table;        // current table, atomically published
+} cptrhash_t;
+
+// initialize and free; size is the expected number of keys.
+// free must not run concurrently with any reader.
+cptrhash_t *cptrhash_new(cptrhash_t *h, size_t size);
+void cptrhash_free(cptrhash_t *h);
+
+// lock-free readers
+void *cptrhash_get(cptrhash_t *h, void *key);
+int cptrhash_has(cptrhash_t *h, void *key);
+
+// writers; the caller must hold its write lock
+void cptrhash_put(cptrhash_t *h, void *key, void *val);
+void cptrhash_adjoin(cptrhash_t *h, void *key, void *val);
+int cptrhash_remove(cptrhash_t *h, void *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
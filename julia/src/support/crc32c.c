@@ -109,6 +109,29 @@ static inline uint32_t crc32c_shift(const uint32_t zeros[][256], uint32_t crc)
         zeros[2][(crc >> 16) & 0xff] ^ zeros[3][crc >> 24];
 }
 
+static int pclmul = 0;
+
+/* Apply the zeros operator to crc with a single carry-less multiply by the
+   precomputed x^(8*len) operator, folded back into the crc domain by one
+   crc32q.  Replaces the four 1KB-table loads of crc32c_shift on processors
+   with PCLMULQDQ.  Written as inline asm (like the crc32 instructions
+   above) so the file does not need -mpclmul. */
+static inline uint32_t crc32c_shift_clmul(uint64_t k, uint32_t crc)
+{
+    uint64_t t, c0 = 0, c64 = crc;
+    __asm__("movq\t%1, %%xmm0\n\t"
+            "movq\t%2, %%xmm1\n\t"
+            "pclmulqdq\t$0, %%xmm1, %%xmm0\n\t"
+            "movq\t%%xmm0, %0"
+            : "=r"(t)
+            : "r"(c64), "r"(k)
+            : "%xmm0", "%xmm1");
+    __asm__("crc32q\t%1, %0"
+            : "+r"(c0)
+            : "r"(t));
+    return (uint32_t)c0;
+}
+
 /* Compute CRC-32C using the Intel hardware instruction. */
 static uint32_t crc32c_hw(uint32_t crc, const void *buf, size_t len)
 {
@@ -148,8 +171,14 @@ static uint32_t crc32c_hw(uint32_t crc, const void *buf, size_t len)
                     : "r"(next), "0"(crc0), "1"(crc1), "2"(crc2));
             next += 8;
         } while (next < end);
-        crc0 = crc32c_shift(crc32c_long, crc0) ^ crc1;
-        crc0 = crc32c_shift(crc32c_long, crc0) ^ crc2;
+        if (pclmul) {
+            crc0 = crc32c_shift_clmul(crc32c_long_clmul, crc0) ^ crc1;
+            crc0 = crc32c_shift_clmul(crc32c_long_clmul, crc0) ^ crc2;
+        }
+        else {
+            crc0 = crc32c_shift(crc32c_long, crc0) ^ crc1;
+            crc0 = crc32c_shift(crc32c_long, crc0) ^ crc2;
+        }
         next += LONG*2;
         len -= LONG*3;
     }
@@ -168,8 +197,14 @@ static uint32_t crc32c_hw(uint32_t crc, const void *buf, size_t len)
                     : "r"(next), "0"(crc0), "1"(crc1), "2"(crc2));
             next += 8;
         } while (next < end);
-        crc0 = crc32c_shift(crc32c_short, crc0) ^ crc1;
-        crc0 = crc32c_shift(crc32c_short, crc0) ^ crc2;
+        if (pclmul) {
+            crc0 = crc32c_shift_clmul(crc32c_short_clmul, crc0) ^ crc1;
+            crc0 = crc32c_shift_clmul(crc32c_short_clmul, crc0) ^ crc2;
+        }
+        else {
+            crc0 = crc32c_shift(crc32c_short, crc0) ^ crc1;
+            crc0 = crc32c_shift(crc32c_short, crc0) ^ crc2;
+        }
         next += SHORT*2;
         len -= SHORT*3;
     }
@@ -203,7 +238,7 @@ static uint32_t crc32c_hw(uint32_t crc, const void *buf, size_t len)
    cpuid instruction itself, which was introduced on the 486SL in 1992, so this
    will fail on earlier x86 processors.  cpuid works on all Pentium and later
    processors. */
-#define SSE42(have) \
+#define SSE42(have, have_clmul) \
     do { \
         uint32_t eax, ecx; \
         eax = 1; \
@@ -212,6 +247,7 @@ static uint32_t crc32c_hw(uint32_t crc, const void *buf, size_t len)
                 : "a"(eax) \
                 : "%ebx", "%edx"); \
         (have) = (ecx >> 20) & 1; \
+        (have_clmul) = (ecx >> 1) & 1; \
     } while (0)
 
 static int sse42 = 0;
@@ -225,9 +261,9 @@ JL_DLLEXPORT void jl_crc32c_init(int force_sw)
 {
 #ifdef HW_CRC
     if (force_sw)
-        sse42 = 0; /* useful for testing purposes */
+        sse42 = pclmul = 0; /* useful for testing purposes */
     else
-        SSE42(sse42);
+        SSE42(sse42, pclmul);
 #endif
 }
 
@@ -251,6 +287,9 @@ JL_DLLEXPORT uint32_t jl_crc32c(uint32_t crc, const void *buf, size_t len)
 
 #else /* ifdef GEN_CRC32C_TABLES */
 
+#include <stdio.h>
+#include <stdlib.h>
+
 /* Table for a quadword-at-a-time software crc. */
 static uint32_t crc32c_table[8][256];
 
@@ -377,7 +416,84 @@ static void crc32c_init_hw(void)
     crc32c_zeros(crc32c_short, SHORT);
 }
 
-#include <stdio.h>
+/* One raw crc32q step in software (no pre/post-processing), used below to
+   model the hardware instruction when solving for the carry-less-multiply
+   shift operators. */
+static uint32_t crc32c_raw8(uint64_t d)
+{
+    uint64_t crc = d;
+    crc = crc32c_table[7][crc & 0xff] ^
+          crc32c_table[6][(crc >> 8) & 0xff] ^
+          crc32c_table[5][(crc >> 16) & 0xff] ^
+          crc32c_table[4][(crc >> 24) & 0xff] ^
+          crc32c_table[3][(crc >> 32) & 0xff] ^
+          crc32c_table[2][(crc >> 40) & 0xff] ^
+          crc32c_table[1][(crc >> 48) & 0xff] ^
+          crc32c_table[0][crc >> 56];
+    return (uint32_t)crc;
+}
+
+/* Solve for the constant K such that, for every 32-bit crc c,
+       crc32q(0, clmul(c, K)) == (c * x^(8*len)) mod POLY,
+   i.e. a single carry-less multiply plus one crc32 instruction applies the
+   len-byte zeros operator.  All the maps involved are linear over GF(2), so
+   this is Gaussian elimination on the bits of K. */
+static uint64_t crc32c_clmul_op(size_t len)
+{
+    enum { NUNK = 33 }; /* K may need the 33rd bit */
+    static uint64_t rows[32 * 32]; /* coefficients in bits 0..32, rhs in bit 63 */
+    uint32_t op[32];
+    int nrows = 0, i, j, t, r;
+    int piv_of_col[NUNK];
+    uint64_t K = 0;
+
+    crc32c_zeros_op(op, len);
+    for (i = 0; i < 32; i++) {
+        uint32_t rhs = gf2_matrix_times(op, 1u << i);
+        for (t = 0; t < 32; t++) {
+            uint64_t row = 0;
+            for (j = 0; j < NUNK; j++) {
+                if ((crc32c_raw8(1ull << (i + j)) >> t) & 1)
+                    row |= 1ull << j;
+            }
+            if ((rhs >> t) & 1)
+                row |= 1ull << 63;
+            rows[nrows++] = row;
+        }
+    }
+    for (j = 0; j < NUNK; j++)
+        piv_of_col[j] = -1;
+    r = 0;
+    for (j = 0; j < NUNK && r < nrows; j++) {
+        int p = -1;
+        for (i = r; i < nrows; i++) {
+            if ((rows[i] >> j) & 1) {
+                p = i;
+                break;
+            }
+        }
+        if (p < 0)
+            continue;
+        uint64_t tmp = rows[p]; rows[p] = rows[r]; rows[r] = tmp;
+        for (i = 0; i < nrows; i++) {
+            if (i != r && ((rows[i] >> j) & 1))
+                rows[i] ^= rows[r];
+        }
+        piv_of_col[j] = r;
+        r++;
+    }
+    for (i = r; i < nrows; i++) {
+        if (rows[i] >> 63) {
+            fprintf(stderr, "no clmul operator for len=%u\n", (unsigned)len);
+            exit(1);
+        }
+    }
+    for (j = 0; j < NUNK; j++) {
+        if (piv_of_col[j] >= 0 && (rows[piv_of_col[j]] >> 63))
+            K |= 1ull << j;
+    }
+    return K;
+}
 
 static void print_array(const char *name, int m, int n, const uint32_t *a)
 {
@@ -401,6 +517,12 @@ int main(void)
     printf("\n#ifdef HW_CRC\n");
     print_array("crc32c_long", 4, 256, &crc32c_long[0][0]);
     print_array("crc32c_short", 4, 256, &crc32c_short[0][0]);
+    printf("\n/* zeros operators as carry-less multipliers, for the PCLMULQDQ\n"
+           "   combine (see crc32c_shift_clmul) */\n");
+    printf("static const uint64_t crc32c_long_clmul = 0x%llx;\n",
+           (unsigned long long)crc32c_clmul_op(LONG));
+    printf("static const uint64_t crc32c_short_clmul = 0x%llx;\n",
+           (unsigned long long)crc32c_clmul_op(SHORT));
     printf("#endif /* HW_CRC */\n");
     return 0;
 }
@@ -4,6 +4,7 @@
   Hashing
 */
 #include <stdlib.h>
+#include <string.h>
 #include "dtypes.h"
 #include "utils.h"
 #include "hashing.h"
@@ -52,11 +53,30 @@ uint32_t int64to32hash(uint64_t key)
 
 #define _MHASH_SEED_ 0xcafe8881
 
+// Hash values computed here are baked into system image and package cache
+// dictionaries, so every process sharing an image must use the same hash
+// function.  The AES-NI kernel is therefore opt-in (JULIA_HW_HASH set and
+// not "0"), not selected by cpuid alone: the variable has to be set both
+// when building an image and when running against it.
+static int hw_hash_enabled(void)
+{
+    static int enabled = -1;
+    if (enabled == -1) {
+        const char *v = getenv("JULIA_HW_HASH");
+        enabled = v && strcmp(v, "0") && jl_memhash_aes_supported();
+    }
+    return enabled;
+}
+
 uint64_t memhash(const char *buf, size_t n)
 {
     uint64_t out[2];
 
     // TODO: expose 128-bit hash
+    if (hw_hash_enabled()) {
+        jl_memhash_aes_128(buf, n, _MHASH_SEED_, out);
+        return out[1];
+    }
 #ifdef _P64
     MurmurHash3_x64_128(buf, n, _MHASH_SEED_, out);
 #else
@@ -70,6 +90,10 @@ uint64_t memhash_seed(const char *buf, size_t n, uint32_t seed)
     uint64_t out[2];
 
     // TODO: expose 128-bit hash
+    if (hw_hash_enabled()) {
+        jl_memhash_aes_128(buf, n, seed, out);
+        return out[1];
+    }
 #ifdef _P64
     MurmurHash3_x64_128(buf, n, seed, out);
 #else
@@ -82,6 +106,11 @@ uint32_t memhash32(const char *buf, size_t n)
 {
     uint32_t out;
 
+    if (hw_hash_enabled()) {
+        uint64_t out128[2];
+        jl_memhash_aes_128(buf, n, _MHASH_SEED_, out128);
+        return (uint32_t)out128[1];
+    }
     MurmurHash3_x86_32(buf, n, _MHASH_SEED_, &out);
     return out;
 }
@@ -90,6 +119,11 @@ uint32_t memhash32_seed(const char *buf, size_t n, uint32_t seed)
 {
     uint32_t out;
 
+    if (hw_hash_enabled()) {
+        uint64_t out128[2];
+        jl_memhash_aes_128(buf, n, seed, out128);
+        return (uint32_t)out128[1];
+    }
     MurmurHash3_x86_32(buf, n, seed, &out);
     return out;
 }
@@ -24,6 +24,11 @@ JL_DLLEXPORT uint64_t memhash_seed(const char *buf, size_t n, uint32_t seed);
 JL_DLLEXPORT uint32_t memhash32(const char *buf, size_t n);
 JL_DLLEXPORT uint32_t memhash32_seed(const char *buf, size_t n, uint32_t seed);
 
+// AES-NI kernel behind the JULIA_HW_HASH opt-in (see hashing_aes.c)
+int jl_memhash_aes_supported(void);
+void jl_memhash_aes_128(const char *buf, size_t n, uint32_t seed,
+                        uint64_t out[2]);
+
 #ifdef _P64
 STATIC_INLINE uint64_t bitmix(uint64_t a, uint64_t b)
 {
@@ -0,0 +1,99 @@
+// This file is a part of Julia. License is MIT: http://julialang.org/license
+
+/*
+  AES-NI based memhash kernel.  Kept in its own translation unit so only
+  this file is compiled with -maes (see the Makefile); everything else in
+  libsupport stays baseline.  The hash is NOT MurmurHash-compatible: the
+  dispatch in hashing.c only selects it when explicitly requested, because
+  hash values are baked into system image and package cache dictionaries
+  and must match between the image build and every process using it.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "dtypes.h"
+#include "utils.h"
+#include "hashing.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_CPU_X86_64_) && !defined(_COMPILER_MICROSOFT_) && defined(__AES__)
+
+#include <wmmintrin.h>
+
+int jl_memhash_aes_supported(void)
+{
+    uint32_t eax, ecx;
+    eax = 1;
+    __asm__("cpuid"
+            : "=c"(ecx)
+            : "a"(eax)
+            : "%ebx", "%edx");
+    return (ecx >> 25) & 1;
+}
+
+void jl_memhash_aes_128(const char *buf, size_t n, uint32_t seed,
+                        uint64_t out[2])
+{
+    // arbitrary odd constants; the seed and the length are folded into the
+    // initial state so equal data with different seeds (or a zero-padded
+    // tail) cannot collide trivially
+    const __m128i key1 = _mm_set_epi64x(0x9e3779b97f4a7c15LL ^ seed,
+                                        (long long)0xbf58476d1ce4e5b9LL);
+    const __m128i key2 = _mm_set_epi64x((long long)0x94d049bb133111ebLL,
+                                        0x2545f4914f6cdd1dLL ^ seed);
+    __m128i s1 = _mm_set_epi64x((long long)n, seed);
+    __m128i s2 = key2;
+    __m128i h;
+
+    while (n >= 32) {
+        __m128i b1 = _mm_loadu_si128((const __m128i *)buf);
+        __m128i b2 = _mm_loadu_si128((const __m128i *)(buf + 16));
+        s1 = _mm_aesenc_si128(_mm_xor_si128(s1, b1), key1);
+        s2 = _mm_aesenc_si128(_mm_xor_si128(s2, b2), key2);
+        buf += 32;
+        n -= 32;
+    }
+    if (n >= 16) {
+        __m128i b = _mm_loadu_si128((const __m128i *)buf);
+        s1 = _mm_aesenc_si128(_mm_xor_si128(s1, b), key1);
+        buf += 16;
+        n -= 16;
+    }
+    if (n) {
+        unsigned char tail[16];
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, buf, n);
+        s2 = _mm_aesenc_si128(
+            _mm_xor_si128(s2, _mm_loadu_si128((const __m128i *)tail)), key2);
+    }
+    // three extra rounds for full diffusion of the last blocks
+    h = _mm_aesenc_si128(s1, s2);
+    h = _mm_aesenc_si128(h, key1);
+    h = _mm_aesenc_si128(h, key2);
+    h = _mm_aesenc_si128(h, key1);
+    _mm_storeu_si128((__m128i *)out, h);
+}
+
+#else
+
+// unsupported target (or built without -maes): never selected
+int jl_memhash_aes_supported(void)
+{
+    return 0;
+}
+
+void jl_memhash_aes_128(const char *buf, size_t n, uint32_t seed,
+                        uint64_t out[2])
+{
+    (void)buf; (void)n; (void)seed;
+    out[0] = out[1] = 0;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -22,6 +22,7 @@
 #include <sys/time.h>
 #include <sys/select.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #endif
 
@@ -178,6 +179,102 @@ int _os_write_all(long fd, const void *buf, size_t n, size_t *nwritten)
 }
 
 
+/* write-behind: a bounded ring buffer drained by a background thread,
+   so flushing a log stream does not stall the caller on a slow fd */
+
+#define WBEHIND_DEFAULT_SIZE (4*IOS_BUFSIZE)
+
+typedef struct ios_wbehind_s {
+    uv_mutex_t lock;
+    uv_cond_t nonempty;   // signaled when data (or shutdown) is queued
+    uv_cond_t drained;    // signaled when the flusher makes progress
+    uv_thread_t thread;
+    char *ring;
+    size_t ringsize;
+    long fd;
+    size_t head;          // next byte the flusher will write
+    size_t count;         // bytes queued
+    int err;              // first write(2) error, reported on next flush
+    int shutdown;
+} ios_wbehind_t;
+
+static void _wbehind_thread(void *arg)
+{
+    ios_wbehind_t *wb = (ios_wbehind_t*)arg;
+    uv_mutex_lock(&wb->lock);
+    while (1) {
+        while (wb->count == 0 && !wb->shutdown)
+            uv_cond_wait(&wb->nonempty, &wb->lock);
+        if (wb->count == 0 && wb->shutdown)
+            break;
+        // the producer never touches [head, head+count), so the chunk can
+        // be written with the lock dropped
+        size_t n = wb->count;
+        if (n > wb->ringsize - wb->head)
+            n = wb->ringsize - wb->head;
+        char *p = wb->ring + wb->head;
+        uv_mutex_unlock(&wb->lock);
+        size_t nw;
+        int err = _os_write_all(wb->fd, p, n, &nw);
+        uv_mutex_lock(&wb->lock);
+        if (err && !wb->err)
+            wb->err = err;
+        wb->head = (wb->head + n) % wb->ringsize;
+        wb->count -= n;
+        uv_cond_broadcast(&wb->drained);
+    }
+    uv_mutex_unlock(&wb->lock);
+}
+
+// queue n bytes for the flusher, blocking while the ring is full
+static void _wbehind_enqueue(ios_wbehind_t *wb, const char *data, size_t n)
+{
+    uv_mutex_lock(&wb->lock);
+    while (n > 0) {
+        while (wb->count == wb->ringsize)
+            uv_cond_wait(&wb->drained, &wb->lock);
+        size_t tail = (wb->head + wb->count) % wb->ringsize;
+        size_t space = wb->ringsize - wb->count;
+        if (space > wb->ringsize - tail)
+            space = wb->ringsize - tail;
+        if (space > n)
+            space = n;
+        memcpy(wb->ring + tail, data, space);
+        wb->count += space;
+        data += space;
+        n -= space;
+        uv_cond_signal(&wb->nonempty);
+    }
+    uv_mutex_unlock(&wb->lock);
+}
+
+// wait until everything queued so far has reached the descriptor
+static void _wbehind_drain(ios_wbehind_t *wb)
+{
+    uv_mutex_lock(&wb->lock);
+    while (wb->count > 0)
+        uv_cond_wait(&wb->drained, &wb->lock);
+    uv_mutex_unlock(&wb->lock);
+}
+
+// flush remaining queued output, join the flusher and free its state
+static void _wbehind_stop(ios_t *s)
+{
+    ios_wbehind_t *wb = s->wbehind;
+    uv_mutex_lock(&wb->lock);
+    wb->shutdown = 1;
+    uv_cond_signal(&wb->nonempty);
+    uv_mutex_unlock(&wb->lock);
+    uv_thread_join(&wb->thread);
+    uv_cond_destroy(&wb->drained);
+    uv_cond_destroy(&wb->nonempty);
+    uv_mutex_destroy(&wb->lock);
+    LLT_FREE(wb->ring);
+    LLT_FREE(wb);
+    s->wbehind = NULL;
+}
+
+
 /* internal utility functions */
 
 static char *_buf_realloc(ios_t *s, size_t sz)
@@ -403,7 +500,13 @@ size_t ios_write(ios_t *s, const char *data, size_t n)
     }
     else if (s->bm == bm_none) {
         s->fpos = -1;
-        _os_write_all(s->fd, data, n, &wrote);
+        if (s->wbehind) {
+            _wbehind_enqueue(s->wbehind, data, n);
+            wrote = n;
+        }
+        else {
+            _os_write_all(s->fd, data, n, &wrote);
+        }
         return wrote;
     }
     else if (n <= space) {
@@ -426,6 +529,10 @@ size_t ios_write(ios_t *s, const char *data, size_t n)
     else {
         ios_flush(s);
         if (n > MOST_OF(s->maxsize)) {
+            if (s->wbehind) {
+                _wbehind_enqueue(s->wbehind, data, n);
+                return n;
+            }
             _os_write_all(s->fd, data, n, &wrote);
             return wrote;
         }
@@ -448,6 +555,8 @@ int64_t ios_seek(ios_t *s, int64_t pos)
     }
     else {
         ios_flush(s);
+        if (s->wbehind)
+            _wbehind_drain(s->wbehind);
         int64_t fdpos = lseek(s->fd, (off_t)pos, SEEK_SET);
         if (fdpos == (int64_t)-1)
             return fdpos;
@@ -465,6 +574,8 @@ int64_t ios_seek_end(ios_t *s)
     }
     else {
         ios_flush(s);
+        if (s->wbehind)
+            _wbehind_drain(s->wbehind);
         int64_t fdpos = lseek(s->fd, 0, SEEK_END);
         if (fdpos == (int64_t)-1)
             return fdpos;
@@ -501,6 +612,8 @@ int64_t ios_skip(ios_t *s, int64_t offs)
             }
         }
         ios_flush(s);
+        if (s->wbehind)
+            _wbehind_drain(s->wbehind);
         if (s->state == bst_wr)
             offs += s->bpos;
         else if (s->state == bst_rd)
@@ -619,7 +732,17 @@ int ios_flush(ios_t *s)
 
     size_t nw, ntowrite=s->ndirty;
     s->fpos = -1;
-    int err = _os_write_all(s->fd, s->buf, ntowrite, &nw);
+    int err;
+    if (s->wbehind && s->state != bst_rd) {
+        // hand the dirty bytes to the flusher thread; a write error from a
+        // previous chunk is surfaced here, one flush late
+        _wbehind_enqueue(s->wbehind, s->buf, ntowrite);
+        nw = ntowrite;
+        err = s->wbehind->err;
+    }
+    else {
+        err = _os_write_all(s->fd, s->buf, ntowrite, &nw);
+    }
     // todo: try recovering from some kinds of errors (e.g. retry)
 
     if (s->state == bst_rd) {
@@ -627,7 +750,10 @@ int ios_flush(ios_t *s)
         }
     }
     else if (s->state == bst_wr) {
-        if (s->bpos != nw &&
+        // with write-behind the descriptor offset belongs to the flusher
+        // thread, so never reposition it here (bpos == ndirty for the
+        // append-only streams the mode is restricted to)
+        if (s->wbehind == NULL && s->bpos != nw &&
             lseek(s->fd, (off_t)(s->bpos - nw), SEEK_CUR) == (off_t)-1) {
         }
         // now preserve the invariant that data to write
@@ -650,13 +776,28 @@ int ios_flush(ios_t *s)
     return 0;
 }
 
+// release the file mapping backing an ios_file_mmap stream
+static void _ios_unmap(ios_t *s)
+{
+#if !defined(_OS_WINDOWS_)
+    munmap(s->buf, (size_t)s->maxsize);
+#endif
+    s->buf = NULL;
+    s->mmapped = 0;
+}
+
 void ios_close(ios_t *s)
 {
     ios_flush(s);
+    if (s->wbehind)
+        _wbehind_stop(s);
     if (s->fd != -1 && s->ownfd)
         close(s->fd);
     s->fd = -1;
-    if (s->buf!=NULL && s->ownbuf && s->buf!=&s->local[0]) {
+    if (s->buf!=NULL && s->mmapped) {
+        _ios_unmap(s);
+    }
+    else if (s->buf!=NULL && s->ownbuf && s->buf!=&s->local[0]) {
         LLT_FREE(s->buf);
     }
     s->buf = NULL;
@@ -689,12 +830,15 @@ char *ios_take_buffer(ios_t *s, size_t *psize)
 
     ios_flush(s);
 
-    if (s->buf == &s->local[0]) {
+    if (s->buf == &s->local[0] || s->mmapped) {
+        // a mapping is read-only and must stay intact, so hand out a copy
         buf = (char*)LLT_ALLOC((size_t)s->size + 1);
         if (buf == NULL)
             return NULL;
         if (s->size)
             memcpy(buf, s->buf, (size_t)s->size);
+        if (s->mmapped)
+            _ios_unmap(s);
     }
     else {
         if (s->buf == NULL)
@@ -726,7 +870,10 @@ int ios_setbuf(ios_t *s, char *buf, size_t size, int own)
     }
     s->size = nvalid;
 
-    if (s->buf!=NULL && s->ownbuf && s->buf!=&s->local[0]) {
+    if (s->buf!=NULL && s->mmapped) {
+        _ios_unmap(s);
+    }
+    else if (s->buf!=NULL && s->ownbuf && s->buf!=&s->local[0]) {
         LLT_FREE(s->buf);
     }
     s->buf = buf;
@@ -744,6 +891,42 @@ int ios_bufmode(ios_t *s, bufmode_t mode)
     return 0;
 }
 
+int ios_writebehind(ios_t *s, size_t bufsize)
+{
+    if (s->wbehind)
+        return 0;
+    if (s->fd == -1 || !s->writable || s->bm == bm_mem)
+        return -1;
+    if (bufsize == 0)
+        bufsize = WBEHIND_DEFAULT_SIZE;
+    ios_wbehind_t *wb = (ios_wbehind_t*)LLT_ALLOC(sizeof(ios_wbehind_t));
+    if (wb == NULL)
+        return -1;
+    wb->ring = (char*)LLT_ALLOC(bufsize);
+    if (wb->ring == NULL) {
+        LLT_FREE(wb);
+        return -1;
+    }
+    wb->ringsize = bufsize;
+    wb->fd = s->fd;
+    wb->head = wb->count = 0;
+    wb->err = 0;
+    wb->shutdown = 0;
+    uv_mutex_init(&wb->lock);
+    uv_cond_init(&wb->nonempty);
+    uv_cond_init(&wb->drained);
+    if (uv_thread_create(&wb->thread, _wbehind_thread, wb) != 0) {
+        uv_cond_destroy(&wb->drained);
+        uv_cond_destroy(&wb->nonempty);
+        uv_mutex_destroy(&wb->lock);
+        LLT_FREE(wb->ring);
+        LLT_FREE(wb);
+        return -1;
+    }
+    s->wbehind = wb;
+    return 0;
+}
+
 int ios_get_readable(ios_t *s)
 {
     return s->readable;
@@ -868,6 +1051,8 @@ static void _ios_init(ios_t *s)
     s->readable = 1;
     s->writable = 1;
     s->rereadable = 0;
+    s->mmapped = 0;
+    s->wbehind = NULL;
 }
 
 /* stream object initializers. we do no allocation. */
@@ -933,6 +1118,48 @@ ios_t *ios_file(ios_t *s, const char *fname, int rd, int wr, int create, int tru
     return NULL;
 }
 
+static ios_t *_ios_file_mmap(ios_t *s, const char *fname, int cow)
+{
+#if !defined(_OS_WINDOWS_)
+    int fd = open_cloexec(fname, O_RDONLY, 0);
+    if (fd == -1) {
+        s->fd = -1;
+        return NULL;
+    }
+    struct stat st;
+    // mapping only pays off for plain files; mmap of length 0 is invalid
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+        (uint64_t)st.st_size <= (uint64_t)(size_t)-1) {
+        int prot = cow ? PROT_READ | PROT_WRITE : PROT_READ;
+        char *m = (char*)mmap(NULL, (size_t)st.st_size, prot,
+                              MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED) {
+            close(fd);
+#ifdef POSIX_MADV_WILLNEED
+            // start kernel readahead for the whole mapping; callers stream
+            // through it front to back
+            posix_madvise(m, (size_t)st.st_size, POSIX_MADV_WILLNEED);
+#endif
+            ios_static_buffer(s, m, (size_t)st.st_size);
+            s->mmapped = 1;
+            return s;
+        }
+    }
+    close(fd);
+#endif
+    return ios_file(s, fname, 1, 0, 0, 0);
+}
+
+ios_t *ios_file_mmap(ios_t *s, const char *fname)
+{
+    return _ios_file_mmap(s, fname, 0);
+}
+
+ios_t *ios_file_mmap_cow(ios_t *s, const char *fname)
+{
+    return _ios_file_mmap(s, fname, 1);
+}
+
 // Portable ios analogue of mkstemp: modifies fname to replace
 // trailing XXXX's with unique ID and returns the file handle s
 // for writing and reading.
@@ -57,6 +57,10 @@ typedef struct {
     // again any number of times. usually only true for files and strings.
     unsigned char rereadable:1;
 
+    // buf is a read-only file mapping (see ios_file_mmap); it must be
+    // unmapped, not freed, and can never be handed out by ios_take_buffer
+    unsigned char mmapped:1;
+
     // this enables "stenciled writes". you can alternately write and
     // seek without flushing in between. this performs read-before-write
     // to populate the buffer, so "rereadable" capability is required.
@@ -66,6 +70,10 @@ typedef struct {
     // request durable writes (fsync)
     // unsigned char durable:1;
 
+    // non-NULL when write-behind is enabled (see ios_writebehind). flushes
+    // are queued to a background thread instead of blocking on write(2).
+    struct ios_wbehind_s *wbehind;
+
     int64_t userdata;
     char local[IOS_INLSIZE];
 } ios_t;
@@ -89,6 +97,11 @@ JL_DLLEXPORT char *ios_take_buffer(ios_t *s, size_t *psize);  // release buffer
 // set buffer space to use
 JL_DLLEXPORT int ios_setbuf(ios_t *s, char *buf, size_t size, int own);
 JL_DLLEXPORT int ios_bufmode(ios_t *s, bufmode_t mode);
+// enable write-behind: descriptor writes are handed to a background
+// flusher thread, buffered up to `bufsize` bytes (0 picks a default);
+// writers block only when that bound is hit. only meaningful for
+// writable, non-mem streams. ios_close drains and joins the thread.
+JL_DLLEXPORT int ios_writebehind(ios_t *s, size_t bufsize);
 JL_DLLEXPORT int ios_get_readable(ios_t *s);
 JL_DLLEXPORT int ios_get_writable(ios_t *s);
 JL_DLLEXPORT void ios_set_readonly(ios_t *s);
@@ -102,6 +115,14 @@ JL_DLLEXPORT size_t ios_readprep(ios_t *from, size_t n);
 /* stream creation */
 JL_DLLEXPORT
 ios_t *ios_file(ios_t *s, const char *fname, int rd, int wr, int create, int trunc);
+// read-only stream over a private file mapping; the whole file is
+// "buffered" at no copy cost. falls back to ios_file on platforms or
+// files (empty, non-regular) where mapping is not possible.
+JL_DLLEXPORT ios_t *ios_file_mmap(ios_t *s, const char *fname);
+// like ios_file_mmap but the private mapping is writable (copy-on-write):
+// stores dirty only the touched pages and never reach the file. lets
+// long-lived consumers alias data in the buffer directly.
+JL_DLLEXPORT ios_t *ios_file_mmap_cow(ios_t *s, const char *fname);
 JL_DLLEXPORT ios_t *ios_mkstemp(ios_t *f, char *fname);
 JL_DLLEXPORT ios_t *ios_mem(ios_t *s, size_t initsize);
 ios_t *ios_str(ios_t *s, char *str);
@@ -15,10 +15,13 @@
 #include "timefuncs.h"
 #include "hashing.h"
 #include "ptrhash.h"
+#include "swtable.h"
+#include "cptrhash.h"
 #include "bitvector.h"
 #include "dirpath.h"
 #include "strtod.h"
 #include "crc32c.h"
+#include "lz4.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -0,0 +1,192 @@
+// This file is a part of Julia. License is MIT: http://julialang.org/license
+
+/*
+  minimal LZ4 block codec
+
+  Implements the stock LZ4 block format: each sequence is a token whose
+  high nibble is the literal run length and low nibble the match length
+  minus 4 (the value 15 meaning "read further length bytes"), followed
+  by the literals, a 2-byte little-endian match offset and any extra
+  match length bytes; the final sequence is literals only. The output is
+  bit-compatible with the reference implementation, so images written
+  here can be inspected with standard lz4 tooling. Compression is a
+  single-pass greedy search over a 4-byte hash table -- the same scheme
+  as the reference "fast" compressor -- which is plenty for the one
+  producer and consumer we have (the system image, see dump.c).
+*/
+
+#include <string.h>
+#include "dtypes.h"
+#include "lz4.h"
+
+#define LZ4_MINMATCH     4
+#define LZ4_LASTLITERALS 5   // spec: the last 5 bytes are always literals
+#define LZ4_MFLIMIT      12  // spec: no match may start within 12 bytes of the end
+#define LZ4_MAXOFFSET    65535
+#define LZ4_HASHLOG      12
+
+static uint32_t lz4_read32(const unsigned char *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t lz4_hash(uint32_t v)
+{
+    // Knuth multiplicative hash of the 4 bytes at the candidate position
+    return (v * 2654435761u) >> (32 - LZ4_HASHLOG);
+}
+
+JL_DLLEXPORT size_t lz4_compress(const char *src, size_t srclen,
+                                 char *dst, size_t dstcap)
+{
+    const unsigned char *base = (const unsigned char*)src;
+    const unsigned char *iend = base + srclen;
+    const unsigned char *mflimit = srclen > LZ4_MFLIMIT ? iend - LZ4_MFLIMIT : base;
+    const unsigned char *matchlimit = srclen > LZ4_LASTLITERALS ? iend - LZ4_LASTLITERALS : base;
+    const unsigned char *ip = base;
+    const unsigned char *anchor = base;
+    unsigned char *op = (unsigned char*)dst;
+    unsigned char *oend = op + dstcap;
+    uint32_t htab[1 << LZ4_HASHLOG]; // positions + 1, so 0 means empty
+
+    if (srclen >= 0x7e000000) // block sizes the format does not support
+        return 0;
+    memset(htab, 0, sizeof(htab));
+
+    while (ip < mflimit) {
+        uint32_t seq = lz4_read32(ip);
+        uint32_t h = lz4_hash(seq);
+        uint32_t cand = htab[h];
+        const unsigned char *ref = base + cand - 1;
+        htab[h] = (uint32_t)(ip - base) + 1;
+        if (cand == 0 || ip - ref > LZ4_MAXOFFSET || lz4_read32(ref) != seq) {
+            ip++;
+            continue;
+        }
+        // extend the match; it may run up to (but not into) the trailing
+        // literals the format reserves
+        {
+            const unsigned char *p = ip + LZ4_MINMATCH;
+            const unsigned char *mp = ref + LZ4_MINMATCH;
+            while (p < matchlimit && *p == *mp) {
+                p++;
+                mp++;
+            }
+            size_t mlen = (size_t)(p - ip) - LZ4_MINMATCH;
+            size_t litlen = (size_t)(ip - anchor);
+            size_t off = (size_t)(ip - ref);
+            // worst case: token, length escapes, literals, offset
+            if ((size_t)(oend - op) < 1 + litlen / 255 + 1 + litlen + 2 + mlen / 255 + 1)
+                return 0;
+            unsigned char *token = op++;
+            if (litlen >= 15) {
+                size_t l = litlen - 15;
+                *token = 15 << 4;
+                for (; l >= 255; l -= 255)
+                    *op++ = 255;
+                *op++ = (unsigned char)l;
+            }
+            else {
+                *token = (unsigned char)(litlen << 4);
+            }
+            memcpy(op, anchor, litlen);
+            op += litlen;
+            *op++ = (unsigned char)(off & 0xff);
+            *op++ = (unsigned char)(off >> 8);
+            if (mlen >= 15) {
+                size_t l = mlen - 15;
+                *token |= 15;
+                for (; l >= 255; l -= 255)
+                    *op++ = 255;
+                *op++ = (unsigned char)l;
+            }
+            else {
+                *token |= (unsigned char)mlen;
+            }
+            ip = p;
+            anchor = ip;
+            if (ip < mflimit) // seed the table across the match we skipped
+                htab[lz4_hash(lz4_read32(ip - 2))] = (uint32_t)(ip - 2 - base) + 1;
+        }
+    }
+
+    // trailing literals (always present, possibly empty)
+    {
+        size_t litlen = (size_t)(iend - anchor);
+        if ((size_t)(oend - op) < 1 + litlen / 255 + 1 + litlen)
+            return 0;
+        unsigned char *token = op++;
+        if (litlen >= 15) {
+            size_t l = litlen - 15;
+            *token = 15 << 4;
+            for (; l >= 255; l -= 255)
+                *op++ = 255;
+            *op++ = (unsigned char)l;
+        }
+        else {
+            *token = (unsigned char)(litlen << 4);
+        }
+        memcpy(op, anchor, litlen);
+        op += litlen;
+    }
+    return (size_t)(op - (unsigned char*)dst);
+}
+
+JL_DLLEXPORT size_t lz4_decompress(const char *src, size_t srclen,
+                                   char *dst, size_t dstcap)
+{
+    const unsigned char *ip = (const unsigned char*)src;
+    const unsigned char *iend = ip + srclen;
+    unsigned char *obase = (unsigned char*)dst;
+    unsigned char *op = obase;
+    unsigned char *oend = op + dstcap;
+
+    while (ip < iend) {
+        unsigned token = *ip++;
+        size_t litlen = token >> 4;
+        if (litlen == 15) {
+            unsigned char b;
+            do {
+                if (ip >= iend)
+                    return 0;
+                b = *ip++;
+                litlen += b;
+            } while (b == 255);
+        }
+        if (litlen > (size_t)(iend - ip) || litlen > (size_t)(oend - op))
+            return 0;
+        memcpy(op, ip, litlen);
+        ip += litlen;
+        op += litlen;
+        if (ip >= iend)
+            break; // the final sequence carries no match
+        if (iend - ip < 2)
+            return 0;
+        size_t off = ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (off == 0 || off > (size_t)(op - obase))
+            return 0;
+        size_t mlen = token & 15;
+        if (mlen == 15) {
+            unsigned char b;
+            do {
+                if (ip >= iend)
+                    return 0;
+                b = *ip++;
+                mlen += b;
+            } while (b == 255);
+        }
+        mlen += LZ4_MINMATCH;
+        if (mlen > (size_t)(oend - op))
+            return 0;
+        // matches may overlap their own output; copy forward bytewise
+        {
+            const unsigned char *mp = op - off;
+            while (mlen--)
+                *op++ = *mp++;
+        }
+    }
+    return (size_t)(op - obase);
+}
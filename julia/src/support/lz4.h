@@ -0,0 +1,27 @@
+// This file is a part of Julia. License is MIT: http://julialang.org/license
+
+#ifndef LZ4_H
+#define LZ4_H 1
+
+#include "dtypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Compress `srclen` bytes from `src` into `dst` using the LZ4 block
+// format. Returns the compressed size, or 0 if the result would not fit
+// in `dstcap` bytes (pass `srclen - 1` to only accept an actual win).
+JL_DLLEXPORT size_t lz4_compress(const char *src, size_t srclen,
+                                 char *dst, size_t dstcap);
+
+// Decompress an LZ4 block. Returns the number of bytes written to `dst`,
+// or 0 if the input is malformed or the output exceeds `dstcap`.
+JL_DLLEXPORT size_t lz4_decompress(const char *src, size_t srclen,
+                                   char *dst, size_t dstcap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LZ4_H */
@@ -0,0 +1,392 @@
+// This file is a part of Julia. License is MIT: http://julialang.org/license
+
+/*
+  Swiss-table style pointer hash (see swtable.h for the layout
+  contract). Each slot has a control byte: the top bit set marks an
+  empty (0x80) or tombstoned (0xfe) slot, otherwise the byte holds the
+  low 7 bits of the key's hash. Lookups compare a whole group of 16
+  control bytes against the sought hash fragment at once and only
+  touch the pair array on a control-byte hit, and a group containing
+  an empty byte ends the probe sequence.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+
+#include "dtypes.h"
+#include "hashing.h"
+#include "htable.h" // for HT_NOTFOUND
+#include "swtable.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SW_GROUP 16
+#define SW_EMPTY   ((uint8_t)0x80)
+#define SW_DELETED ((uint8_t)0xfe)
+
+// rehash incrementally once the outgoing table has this many slots;
+// below it a full rehash is cheaper than carrying two arrays around
+#define SW_INCREMENTAL_MIN ((size_t)1 << 17)
+// slots of the old table migrated per operation while a rehash is in
+// flight; generous relative to the insert headroom of the grown table,
+// so migration always finishes long before the next grow is due
+#define SW_MIGRATE_SLOTS 128
+
+// bitmask of the positions in the 16-byte group at `ctrl` equal to `b`
+static inline uint32_t sw_group_match(const uint8_t *ctrl, uint8_t b)
+{
+#if defined(__SSE2__)
+    __m128i g = _mm_loadu_si128((const __m128i*)ctrl);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)b)));
+#else
+    uint32_t m = 0;
+    int i;
+    for (i = 0; i < SW_GROUP; i++)
+        m |= (uint32_t)(ctrl[i] == b) << i;
+    return m;
+#endif
+}
+
+static inline int sw_ctz(uint32_t m)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(m);
+#else
+    int n = 0;
+    while (!(m & 1)) {
+        m >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static int sw_alloc(swtable_t *h, size_t nslots)
+{
+    size_t i;
+    h->ctrl = (uint8_t*)LLT_ALLOC(nslots);
+    h->table = (void**)LLT_ALLOC(nslots * 2 * sizeof(void*));
+    if (h->ctrl == NULL || h->table == NULL) {
+        LLT_FREE(h->ctrl);
+        LLT_FREE(h->table);
+        h->ctrl = NULL;
+        h->table = NULL;
+        h->size = h->count = 0;
+        return 0;
+    }
+    memset(h->ctrl, SW_EMPTY, nslots);
+    for (i = 0; i < nslots * 2; i++)
+        h->table[i] = HT_NOTFOUND;
+    h->size = nslots * 2;
+    h->count = 0;
+    return 1;
+}
+
+// smallest valid slot count that keeps `nkeys` keys under 7/8 load
+static size_t sw_nslots_for(size_t nkeys)
+{
+    size_t nslots = SW_GROUP;
+    while (nslots - nslots / 8 < nkeys)
+        nslots *= 2;
+    return nslots;
+}
+
+swtable_t *swtable_new(swtable_t *h, size_t size)
+{
+    h->old_ctrl = NULL;
+    h->old_table = NULL;
+    h->old_size = h->old_pos = 0;
+    if (!sw_alloc(h, sw_nslots_for(size)))
+        return NULL;
+    return h;
+}
+
+void swtable_free(swtable_t *h)
+{
+    LLT_FREE(h->ctrl);
+    LLT_FREE(h->table);
+    h->ctrl = NULL;
+    h->table = NULL;
+    h->size = h->count = 0;
+    LLT_FREE(h->old_ctrl);
+    LLT_FREE(h->old_table);
+    h->old_ctrl = NULL;
+    h->old_table = NULL;
+    h->old_size = h->old_pos = 0;
+}
+
+void swtable_reset(swtable_t *h, size_t size)
+{
+    swtable_free(h);
+    swtable_new(h, size);
+}
+
+// insert a key known to be absent; used only while rehashing
+static void sw_insert_fresh(swtable_t *h, void *key, void *val)
+{
+    uint_t hv = inthash((uint_t)(uintptr_t)key);
+    size_t ngroups = (h->size / 2) / SW_GROUP;
+    size_t g = (size_t)(hv >> 7) & (ngroups - 1);
+    while (1) {
+        uint32_t e = sw_group_match(h->ctrl + g * SW_GROUP, SW_EMPTY);
+        if (e) {
+            size_t slot = g * SW_GROUP + sw_ctz(e);
+            h->ctrl[slot] = (uint8_t)(hv & 0x7f);
+            h->table[slot * 2] = key;
+            h->table[slot * 2 + 1] = val;
+            h->count++;
+            return;
+        }
+        g = (g + 1) & (ngroups - 1);
+    }
+}
+
+// move a bounded batch of slots from the in-flight rehash source into
+// the current table, freeing the old arrays once they are drained
+static void sw_migrate_step(swtable_t *h, size_t budget)
+{
+    size_t nslots = h->old_size / 2;
+    while (budget-- > 0 && h->old_pos < nslots) {
+        size_t i = h->old_pos++;
+        if (!(h->old_ctrl[i] & 0x80))
+            sw_insert_fresh(h, h->old_table[i * 2], h->old_table[i * 2 + 1]);
+    }
+    if (h->old_pos >= nslots) {
+        LLT_FREE(h->old_ctrl);
+        LLT_FREE(h->old_table);
+        h->old_ctrl = NULL;
+        h->old_table = NULL;
+        h->old_size = h->old_pos = 0;
+    }
+}
+
+void swtable_rehash_finish(swtable_t *h)
+{
+    if (h->old_ctrl)
+        sw_migrate_step(h, h->old_size / 2);
+}
+
+// rehash into a table sized for twice the live keys; this both grows a
+// genuinely full table and sweeps out accumulated tombstones. Large
+// tables are not copied here: the outgoing arrays are parked and
+// drained a batch at a time by subsequent operations.
+static int sw_grow(swtable_t *h)
+{
+    swtable_t old = *h;
+    size_t i, live = 0;
+    for (i = 0; i < old.size / 2; i++)
+        if (!(old.ctrl[i] & 0x80))
+            live++;
+    if (old.old_ctrl) {
+        // a previous incremental rehash is still in flight; size for its
+        // remainder too and drain it below so only one source is pending
+        for (i = old.old_pos; i < old.old_size / 2; i++)
+            if (!(old.old_ctrl[i] & 0x80))
+                live++;
+    }
+    if (!sw_alloc(h, sw_nslots_for(live * 2 + 1))) {
+        *h = old;
+        return 0;
+    }
+    if (old.old_ctrl) {
+        for (i = old.old_pos; i < old.old_size / 2; i++) {
+            if (!(old.old_ctrl[i] & 0x80))
+                sw_insert_fresh(h, old.old_table[i * 2], old.old_table[i * 2 + 1]);
+        }
+        LLT_FREE(old.old_ctrl);
+        LLT_FREE(old.old_table);
+    }
+    if (old.size / 2 >= SW_INCREMENTAL_MIN) {
+        h->old_ctrl = old.ctrl;
+        h->old_table = old.table;
+        h->old_size = old.size;
+        h->old_pos = 0;
+        return 1;
+    }
+    h->old_ctrl = NULL;
+    h->old_table = NULL;
+    h->old_size = h->old_pos = 0;
+    for (i = 0; i < old.size / 2; i++) {
+        if (!(old.ctrl[i] & 0x80))
+            sw_insert_fresh(h, old.table[i * 2], old.table[i * 2 + 1]);
+    }
+    LLT_FREE(old.ctrl);
+    LLT_FREE(old.table);
+    return 1;
+}
+
+// find `key` in the arrays of a parked rehash source; returns its value
+// slot or NULL. The source never takes inserts, so only an empty byte
+// (not a tombstone left by a migrated entry) ends the probe sequence.
+static void **sw_probe_old(swtable_t *h, void *key, uint_t hv, uint8_t h2)
+{
+    size_t ngroups = (h->old_size / 2) / SW_GROUP;
+    size_t g = (size_t)(hv >> 7) & (ngroups - 1);
+    size_t iter;
+    for (iter = 0; iter < ngroups; iter++) {
+        const uint8_t *ctrl = h->old_ctrl + g * SW_GROUP;
+        uint32_t m = sw_group_match(ctrl, h2);
+        while (m) {
+            size_t slot = g * SW_GROUP + sw_ctz(m);
+            if (h->old_table[slot * 2] == key)
+                return &h->old_table[slot * 2 + 1];
+            m &= m - 1;
+        }
+        if (sw_group_match(ctrl, SW_EMPTY))
+            return NULL;
+        g = (g + 1) & (ngroups - 1);
+    }
+    return NULL;
+}
+
+// find `key` in the current arrays, or (when `insert`) claim a slot for
+// it with the value left as HT_NOTFOUND; any parked rehash source is
+// the caller's problem
+static void **sw_lookup_cur(swtable_t *h, void *key, uint_t hv, uint8_t h2,
+                            int insert)
+{
+    size_t nslots, ngroups, g, iter, free_slot;
+
+ retry:
+    nslots = h->size / 2;
+    ngroups = nslots / SW_GROUP;
+    g = (size_t)(hv >> 7) & (ngroups - 1);
+    free_slot = (size_t)-1;
+    for (iter = 0; iter < ngroups; iter++) {
+        const uint8_t *ctrl = h->ctrl + g * SW_GROUP;
+        uint32_t m = sw_group_match(ctrl, h2);
+        while (m) {
+            size_t slot = g * SW_GROUP + sw_ctz(m);
+            if (h->table[slot * 2] == key)
+                return &h->table[slot * 2 + 1];
+            m &= m - 1;
+        }
+        uint32_t e = sw_group_match(ctrl, SW_EMPTY);
+        if (free_slot == (size_t)-1) {
+            uint32_t d = sw_group_match(ctrl, SW_DELETED);
+            if (e | d)
+                free_slot = g * SW_GROUP + sw_ctz(e | d);
+        }
+        if (e) {
+            // an empty slot ends the probe sequence: the key is absent
+            if (!insert)
+                return NULL;
+            if (h->ctrl[free_slot] == SW_EMPTY) {
+                if (h->count + 1 > nslots - nslots / 8) {
+                    if (!sw_grow(h))
+                        return NULL;
+                    goto retry;
+                }
+                h->count++;
+            }
+            h->ctrl[free_slot] = h2;
+            h->table[free_slot * 2] = key;
+            return &h->table[free_slot * 2 + 1];
+        }
+        g = (g + 1) & (ngroups - 1);
+    }
+    // every group is full of keys and tombstones
+    if (!insert)
+        return NULL;
+    if (!sw_grow(h))
+        return NULL;
+    goto retry;
+}
+
+// find `key`, or (when `insert`) claim a slot for it with the value
+// left as HT_NOTFOUND, matching htable's lookup_bp behavior. While a
+// rehash is in flight this also migrates a batch of parked slots and
+// moves any parked entry it touches, so callers always get a slot in
+// the current arrays back.
+static void **sw_lookup_bp(swtable_t *h, void *key, int insert)
+{
+    uint_t hv = inthash((uint_t)(uintptr_t)key);
+    uint8_t h2 = (uint8_t)(hv & 0x7f);
+    void **bp;
+
+    if (h->old_ctrl)
+        sw_migrate_step(h, SW_MIGRATE_SLOTS);
+    bp = sw_lookup_cur(h, key, hv, h2, 0);
+    if (bp)
+        return bp;
+    if (h->old_ctrl) {
+        void **obp = sw_probe_old(h, key, hv, h2);
+        if (obp) {
+            void *val = *obp;
+            bp = sw_lookup_cur(h, key, hv, h2, 1);
+            if (bp == NULL)
+                return NULL; // OOM growing; the entry stays parked
+            if (h->old_ctrl) {
+                // the claim didn't trigger a grow (which would have
+                // drained the parked source into `bp` already), so
+                // move the entry over and tombstone its old slot
+                size_t oslot = (size_t)(obp - h->old_table) / 2;
+                h->old_ctrl[oslot] = SW_DELETED;
+                h->old_table[oslot * 2] = HT_NOTFOUND;
+                *obp = HT_NOTFOUND;
+                *bp = val;
+            }
+            return bp;
+        }
+    }
+    if (!insert)
+        return NULL;
+    return sw_lookup_cur(h, key, hv, h2, 1);
+}
+
+void *swptrhash_get(swtable_t *h, void *key)
+{
+    void **bp = sw_lookup_bp(h, key, 0);
+    if (bp == NULL)
+        return HT_NOTFOUND;
+    return *bp;
+}
+
+void swptrhash_put(swtable_t *h, void *key, void *val)
+{
+    void **bp = sw_lookup_bp(h, key, 1);
+    *bp = val;
+}
+
+void swptrhash_adjoin(swtable_t *h, void *key, void *val)
+{
+    void **bp = sw_lookup_bp(h, key, 1);
+    if (*bp == HT_NOTFOUND)
+        *bp = val;
+}
+
+int swptrhash_has(swtable_t *h, void *key)
+{
+    return swptrhash_get(h, key) != HT_NOTFOUND;
+}
+
+int swptrhash_remove(swtable_t *h, void *key)
+{
+    void **bp = sw_lookup_bp(h, key, 0);
+    if (bp != NULL) {
+        size_t slot = (bp - h->table) / 2;
+        h->ctrl[slot] = SW_DELETED;
+        h->table[slot * 2] = HT_NOTFOUND;
+        *bp = HT_NOTFOUND;
+        return 1;
+    }
+    return 0;
+}
+
+void **swptrhash_bp(swtable_t *h, void *key)
+{
+    return sw_lookup_bp(h, key, 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,65 @@
+// This file is a part of Julia. License is MIT: http://julialang.org/license
+
+#ifndef SWTABLE_H
+#define SWTABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+  Swiss-table style open-addressing hash for pointer keys: a separate
+  control-byte array holds 7 bits of hash per slot and is scanned 16
+  slots at a time (SSE2 when available), so probe chains touch far
+  fewer cache lines than htable_t's pair-at-a-time walk.
+
+  The API and storage conventions mirror htable_t so the hottest users
+  can migrate without other changes: `size` counts words of `table`
+  (two per slot), `table` holds interleaved key/value pairs, and
+  unoccupied slots keep HT_NOTFOUND in the value word, so existing
+  "every other word, skip HT_NOTFOUND" iteration loops work unchanged.
+
+  Tables past a size threshold rehash incrementally: the grown table
+  keeps the outgoing arrays and every operation moves a bounded batch
+  of slots, so doubling a multi-million-entry table never shows up as
+  one long stall. While a rehash is in flight some entries still live
+  in the old arrays, so code that iterates `table` directly on a table
+  big enough to hit the threshold must call swtable_rehash_finish
+  first (small tables always rehash eagerly and are unaffected).
+*/
+typedef struct {
+    size_t size;    // length of table[] in words, i.e. 2 * nslots
+    size_t count;   // occupied + tombstoned slots; drives resizing
+    uint8_t *ctrl;  // one control byte per slot
+    void **table;   // interleaved key/value pairs
+    // in-flight incremental rehash source, or NULL when none pending
+    uint8_t *old_ctrl;
+    void **old_table;
+    size_t old_size; // length of old_table[] in words
+    size_t old_pos;  // next slot of old_ctrl to migrate
+} swtable_t;
+
+// initialize and free; size is the expected number of keys
+swtable_t *swtable_new(swtable_t *h, size_t size);
+void swtable_free(swtable_t *h);
+
+// clear and (possibly) change size
+void swtable_reset(swtable_t *h, size_t size);
+
+// drain any in-flight incremental rehash; required before iterating
+// `table` directly on tables that can grow past the incremental
+// threshold
+void swtable_rehash_finish(swtable_t *h);
+
+void *swptrhash_get(swtable_t *h, void *key);
+void swptrhash_put(swtable_t *h, void *key, void *val);
+void swptrhash_adjoin(swtable_t *h, void *key, void *val);
+int swptrhash_has(swtable_t *h, void *key);
+int swptrhash_remove(swtable_t *h, void *key);
+void **swptrhash_bp(swtable_t *h, void *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -35,6 +35,10 @@
 #endif
 #include <assert.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "utf8.h"
 
 #ifdef __cplusplus
@@ -220,17 +224,53 @@ size_t u8_offset(const char *s, size_t charnum)
     return i;
 }
 
+#if defined(__GNUC__)
+#define u8_popcount32(x) ((unsigned)__builtin_popcount(x))
+#define u8_ctz32(x) ((unsigned)__builtin_ctz(x))
+#else
+static unsigned u8_popcount32(uint32_t x)
+{
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    x = (x + (x >> 4)) & 0x0f0f0f0fu;
+    return (x * 0x01010101u) >> 24;
+}
+static unsigned u8_ctz32(uint32_t x)
+{
+    unsigned n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+}
+#endif
+
 /* byte offset => charnum */
 size_t u8_charnum(const char *s, size_t offset)
 {
     size_t charnum = 0;
-    if (offset) {
-       do {
-          // Simply not count continuation bytes
-          // Since we are not doing validation anyway, we can just
-          // assume this is a valid UTF-8 string
-          charnum += ((*(unsigned char *)s++ & 0xc0) != 0x80);
-       } while (--offset);
+    const unsigned char *p = (const unsigned char *)s;
+#if defined(__SSE2__)
+    // Count 16 bytes at a time: a character starts at every byte that is
+    // not a continuation byte
+    const __m128i topmask = _mm_set1_epi8((char)0xc0);
+    const __m128i contbyte = _mm_set1_epi8((char)0x80);
+    while (offset >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        uint32_t cont = (uint32_t)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_and_si128(chunk, topmask), contbyte));
+        charnum += 16 - u8_popcount32(cont);
+        p += 16;
+        offset -= 16;
+    }
+#endif
+    while (offset) {
+        // Simply not count continuation bytes
+        // Since we are not doing validation anyway, we can just
+        // assume this is a valid UTF-8 string
+        charnum += ((*p++ & 0xc0) != 0x80);
+        offset--;
     }
     return charnum;
 }
@@ -534,6 +574,24 @@ size_t u8_printf(const char *fmt, ...)
     return cnt;
 }
 
+/* advance to the first byte with the high bit set, or to `pend` */
+static const unsigned char *u8_scan_ascii(const unsigned char *pnt,
+                                          const unsigned char *pend)
+{
+#if defined(__SSE2__)
+    while (pnt + 16 <= pend) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)pnt);
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(chunk);
+        if (mask)
+            return pnt + u8_ctz32(mask);
+        pnt += 16;
+    }
+#endif
+    while (pnt < pend && !(*pnt & 0x80))
+        pnt++;
+    return pnt;
+}
+
 /* Rewritten completely, original code not based on anything else
 
    length is in bytes, since without knowing whether the string is valid
@@ -549,10 +607,9 @@ int u8_isvalid(const char *str, size_t len)
     pnt = (unsigned char *)str;
     pend = (unsigned char *)str + len;
     // First scan for non-ASCII characters as fast as possible
-    do {
-        if (*pnt++ & 0x80) goto chkutf8;
-    } while (pnt < pend);
-    return 1;
+    pnt = u8_scan_ascii(pnt, pend);
+    if (pnt == pend) return 1;
+    pnt++;
 
     // Check validity of UTF-8 sequences
 chkutf8:
@@ -587,8 +644,10 @@ chkutf8:
         pnt += 3;
     }
     // Find next non-ASCII characters as fast as possible
-    while (pnt < pend) {
-        if (*pnt++ & 0x80) goto chkutf8;
+    pnt = u8_scan_ascii(pnt, pend);
+    if (pnt < pend) {
+        pnt++;
+        goto chkutf8;
     }
     return 2;   // Valid UTF-8
 }
@@ -32,7 +32,8 @@ static jl_sym_t *mk_symbol(const char *str, size_t len)
     jl_sym_t *sym;
     size_t nb = symbol_nbytes(len);
 
-    jl_taggedvalue_t *tag = (jl_taggedvalue_t*)jl_gc_perm_alloc_nolock(nb);
+    // per-thread perm arena, so symbol creation takes no lock
+    jl_taggedvalue_t *tag = (jl_taggedvalue_t*)jl_gc_perm_alloc(nb);
     sym = (jl_sym_t*)jl_valueof(tag);
     // set to old marked since we don't need write barrier on it.
     tag->header = ((uintptr_t)jl_sym_type) | GC_OLD_MARKED;
@@ -76,15 +77,19 @@ static jl_sym_t *_jl_symbol(const char *str, size_t len)
     jl_sym_t *volatile *slot;
     jl_sym_t *node = symtab_lookup(&symtab, str, len, &slot);
     if (node == NULL) {
-        JL_LOCK_NOGC(&gc_perm_lock);
-        // Someone might have updated it, check and look up again
-        if (*slot != NULL && (node = symtab_lookup(slot, str, len, &slot))) {
-            JL_UNLOCK_NOGC(&gc_perm_lock);
-            return node;
+        // Insert-only CAS on the tree slot instead of a global lock:
+        // lookups already walk the tree with acquire loads, and the
+        // full barrier in the CAS publishes the node's contents, so
+        // concurrent interning never serializes. Losing a race leaves
+        // the pre-built node to the perm arena (a few dozen bytes,
+        // never freed anyway) and retries from the contended slot.
+        jl_sym_t *sym = mk_symbol(str, len);
+        while (jl_atomic_compare_exchange(slot, NULL, sym) != NULL) {
+            node = symtab_lookup(slot, str, len, &slot);
+            if (node != NULL)
+                return node;
         }
-        node = mk_symbol(str, len);
-        jl_atomic_store_release(slot, node);
-        JL_UNLOCK_NOGC(&gc_perm_lock);
+        node = sym;
     }
     return node;
 }
@@ -133,6 +133,22 @@ JL_DLLEXPORT int32_t jl_stat(const char *path, char *statbuf)
     return ret;
 }
 
+// advisory read-ahead: ask the kernel to start pulling `path` into the
+// page cache and return without waiting. Failures are ignored — callers
+// only lose I/O overlap, never correctness.
+JL_DLLEXPORT void jl_prefetch_file(const char *path)
+{
+#if !defined(_OS_WINDOWS_) && defined(POSIX_FADV_WILLNEED)
+    int fd = open(path, O_RDONLY);
+    if (fd != -1) {
+        (void)posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
 JL_DLLEXPORT int32_t jl_lstat(const char *path, char *statbuf)
 {
     uv_fs_t req;
@@ -438,9 +454,12 @@ JL_STREAM *JL_STDIN  = (JL_STREAM*)STDIN_FILENO;
 JL_STREAM *JL_STDOUT = (JL_STREAM*)STDOUT_FILENO;
 JL_STREAM *JL_STDERR = (JL_STREAM*)STDERR_FILENO;
 
-JL_DLLEXPORT JL_STREAM *jl_stdin_stream(void)  { return JL_STDIN; }
-JL_DLLEXPORT JL_STREAM *jl_stdout_stream(void) { return JL_STDOUT; }
-JL_DLLEXPORT JL_STREAM *jl_stderr_stream(void) { return JL_STDERR; }
+// asking for a stream builds the libuv stdio handles on first use (see
+// init_stdio in init.c); plain jl_printf output gets by on the raw file
+// descriptor fallbacks until then
+JL_DLLEXPORT JL_STREAM *jl_stdin_stream(void)  { init_stdio(); return JL_STDIN; }
+JL_DLLEXPORT JL_STREAM *jl_stdout_stream(void) { init_stdio(); return JL_STDOUT; }
+JL_DLLEXPORT JL_STREAM *jl_stderr_stream(void) { init_stdio(); return JL_STDERR; }
 
 // CPUID
 
@@ -492,6 +511,78 @@ JL_DLLEXPORT int jl_uses_cpuid_tag(void)
 #endif
 }
 
+// -- cheap timestamps --
+//
+// jl_hrtime goes through clock_gettime, which is not always vDSO-fast
+// under a hypervisor. jl_hrtime_fast reads the TSC, calibrated against
+// uv_hrtime once at startup, so it shares jl_hrtime's timebase but is
+// a couple of instructions (and safe in signal handlers). On machines
+// without an invariant TSC it falls back to uv_hrtime. On top of that
+// jl_hrtime_coarse is a plain load of a timestamp that collection
+// boundaries refresh, for pacing-style consumers that only need to
+// know roughly how late it is.
+
+#if defined(_CPU_X86_64_) && defined(HAVE_CPUID)
+static uint64_t hrtime_tsc0 = 0;
+static uint64_t hrtime_ns0 = 0;
+static double hrtime_ns_per_tick = 0; // 0 while uncalibrated or TSC unusable
+
+static inline uint64_t hrtime_rdtsc(void)
+{
+    uint64_t rax, rdx;
+    __asm__ __volatile__ ( "rdtsc" : "=a" (rax), "=d" (rdx) );
+    return (rdx << 32) | rax;
+}
+#endif
+
+void jl_init_hrtime(void)
+{
+#if defined(_CPU_X86_64_) && defined(HAVE_CPUID)
+    int32_t info[4];
+    jl_cpuid(info, (int32_t)0x80000000);
+    if ((uint32_t)info[0] < 0x80000007u)
+        return;
+    jl_cpuid(info, (int32_t)0x80000007);
+    if (!(info[3] & (1 << 8)))
+        return; // TSC not invariant: stay on uv_hrtime
+    uint64_t ns0 = uv_hrtime();
+    uint64_t tsc0 = hrtime_rdtsc();
+    // spin for ~2ms so the frequency estimate has a usable baseline
+    uint64_t ns1, tsc1;
+    do {
+        ns1 = uv_hrtime();
+        tsc1 = hrtime_rdtsc();
+    } while (ns1 - ns0 < 2000000);
+    hrtime_tsc0 = tsc0;
+    hrtime_ns0 = ns0;
+    hrtime_ns_per_tick = (double)(ns1 - ns0) / (double)(tsc1 - tsc0);
+#endif
+}
+
+JL_DLLEXPORT uint64_t jl_hrtime_fast(void)
+{
+#if defined(_CPU_X86_64_) && defined(HAVE_CPUID)
+    double k = hrtime_ns_per_tick;
+    if (k != 0)
+        return hrtime_ns0 + (uint64_t)((double)(hrtime_rdtsc() - hrtime_tsc0) * k);
+#endif
+    return uv_hrtime();
+}
+
+static volatile uint64_t hrtime_coarse_ns = 0;
+
+void jl_hrtime_coarse_refresh(void)
+{
+    hrtime_coarse_ns = jl_hrtime_fast();
+}
+
+JL_DLLEXPORT uint64_t jl_hrtime_coarse(void)
+{
+    uint64_t t = hrtime_coarse_ns;
+    // nothing has refreshed the clock yet (very early startup)
+    return t ? t : jl_hrtime_fast();
+}
+
 // -- set/clear the FZ/DAZ flags on x86 & x86-64 --
 #ifdef __SSE__
 
@@ -15,6 +15,7 @@
 #include "julia.h"
 #include "julia_internal.h"
 #include "threading.h"
+#include "neptune.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -278,7 +279,10 @@ void NOINLINE jl_set_base_ctx(char *__stk)
     jl_ptls_t ptls = jl_get_ptls_states();
     ptls->stackbase = (char*)(((uintptr_t)__stk + sizeof(*__stk))&-16); // also ensures stackbase is 16-byte aligned
 #ifndef ASM_COPY_STACKS
-    if (jl_setjmp(ptls->base_ctx, 1)) {
+    // don't save the sigmask: it is invariant across task switches, and
+    // with it every fresh task launch would pay a sigprocmask pair on the
+    // jl_longjmp to base_ctx
+    if (jl_setjmp(ptls->base_ctx, 0)) {
         start_task();
     }
 #endif
@@ -318,13 +322,15 @@ static void ctx_switch(jl_ptls_t ptls, jl_task_t *t, jl_jmp_buf *where)
         lastt->world_age = ptls->world_age;
         ptls->pgcstack = t->gcstack;
         ptls->world_age = t->world_age;
+        // t's stack is about to mutate; drop any recorded scan of it
+        neptune_task_dirty(t);
 #ifdef JULIA_ENABLE_THREADING
         // If the current task is not holding any locks, free the locks list
         // so that it can be GC'd without leaking memory
-        arraylist_t *locks = &ptls->current_task->locks;
+        small_arraylist_t *locks = &ptls->current_task->locks;
         if (locks->len == 0 && locks->items != locks->_space) {
-            arraylist_free(locks);
-            arraylist_new(locks, 0);
+            small_arraylist_free(locks);
+            small_arraylist_new(locks, 0);
         }
 #endif
 
@@ -517,6 +523,66 @@ static void init_task(jl_task_t *t, char *stack)
     rebase_state(&t->ctx, local_sp, new_sp);
 }
 
+// Pool of dead task stacks, guard page still armed. Workloads that spawn
+// many short-lived tasks pay mmap+mprotect once per stack size instead of
+// once per task; spawning from the pool is a list pop. Stacks come back
+// via a pointer finalizer on the task, with their pages scrubbed by
+// madvise so idle pooled stacks hold no physical memory.
+#define TASK_STACK_POOL_MAX 16 // stacks kept mapped; beyond this we munmap
+static arraylist_t task_stack_pool; // (stack base, ssize) pairs
+static jl_mutex_t task_stack_pool_lock = {0, 0};
+
+static char *alloc_task_stack(size_t ssize)
+{
+    size_t pagesz = jl_page_size;
+    size_t i;
+    JL_LOCK_NOGC(&task_stack_pool_lock);
+    for (i = 0; i < task_stack_pool.len; i += 2) {
+        if ((size_t)task_stack_pool.items[i + 1] == ssize) {
+            char *stk = (char*)task_stack_pool.items[i];
+            task_stack_pool.items[i] = task_stack_pool.items[task_stack_pool.len - 2];
+            task_stack_pool.items[i + 1] = task_stack_pool.items[task_stack_pool.len - 1];
+            task_stack_pool.len -= 2;
+            JL_UNLOCK_NOGC(&task_stack_pool_lock);
+            return stk;
+        }
+    }
+    JL_UNLOCK_NOGC(&task_stack_pool_lock);
+    char *stk = (char*)mmap(NULL, ssize + pagesz, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (stk == MAP_FAILED)
+        jl_errorf("mmap: %s", strerror(errno));
+    // add a guard page to detect stack overflow
+    if (mprotect(stk, pagesz, PROT_NONE) == -1)
+        jl_errorf("mprotect: %s", strerror(errno));
+    return stk;
+}
+
+// pointer finalizer on the task; may run on the native finalizer thread
+static void free_task_stack(void *_t)
+{
+    jl_task_t *t = (jl_task_t*)_t;
+    char *stk = (char*)t->stkbuf;
+    if (stk == NULL)
+        return;
+    size_t pagesz = jl_page_size;
+    size_t ssize = t->ssize;
+    t->stkbuf = NULL;
+#ifdef MADV_DONTNEED
+    // scrub the dead stack but keep the mapping (and its guard page)
+    madvise(stk + pagesz, ssize, MADV_DONTNEED);
+#endif
+    JL_LOCK_NOGC(&task_stack_pool_lock);
+    if (task_stack_pool.len < 2 * TASK_STACK_POOL_MAX) {
+        arraylist_push(&task_stack_pool, stk);
+        arraylist_push(&task_stack_pool, (void*)ssize);
+        stk = NULL;
+    }
+    JL_UNLOCK_NOGC(&task_stack_pool_lock);
+    if (stk)
+        munmap(stk, ssize + pagesz);
+}
+
 #endif /* !COPY_STACKS */
 
 jl_timing_block_t *jl_pop_timing_block(jl_timing_block_t *cur_block);
@@ -614,23 +680,18 @@ JL_DLLEXPORT jl_task_t *jl_new_task(jl_function_t *start, size_t ssize)
 #else
     JL_GC_PUSH1(&t);
 
-    size_t stkbuf_sz = ssize + pagesz + (pagesz - 1);
-    char *stk = (char*)jl_gc_alloc_buf(ptls, stkbuf_sz);
+    // pooled stacks are runtime-owned, not GC buffers; the guard page of a
+    // reused stack is already armed
+    char *stk = alloc_task_stack(ssize);
     t->stkbuf = stk;
-    jl_gc_wb_buf(t, t->stkbuf, stkbuf_sz);
-    stk = (char*)LLT_ALIGN((uintptr_t)stk, pagesz);
-    // add a guard page to detect stack overflow
-    if (mprotect(stk, pagesz-1, PROT_NONE) == -1)
-        jl_errorf("mprotect: %s", strerror(errno));
-    stk += pagesz;
-
-    init_task(t, stk);
-    //jl_gc_add_finalizer((jl_value_t*)t, jl_unprotect_stack_func);
+    init_task(t, stk + pagesz);
+    // returns the stack to the pool once the task is collected
+    jl_gc_add_ptr_finalizer(ptls, (jl_value_t*)t, (void*)&free_task_stack);
     JL_GC_POP();
 #endif
 
 #ifdef JULIA_ENABLE_THREADING
-    arraylist_new(&t->locks, 0);
+    small_arraylist_new(&t->locks, 0);
 #endif
     return t;
 }
@@ -659,6 +720,9 @@ jl_function_t *jl_unprotect_stack_func;
 void jl_init_tasks(void)
 {
     _probe_arch();
+#ifndef COPY_STACKS
+    arraylist_new(&task_stack_pool, 0);
+#endif
     jl_task_type = (jl_datatype_t*)
         jl_new_datatype(jl_symbol("Task"),
                         jl_any_type,
@@ -722,7 +786,7 @@ void jl_init_root_task(void *stack, size_t ssize)
     ptls->current_task->gcstack = NULL;
     ptls->current_task->tid = ptls->tid;
 #ifdef JULIA_ENABLE_THREADING
-    arraylist_new(&ptls->current_task->locks, 0);
+    small_arraylist_new(&ptls->current_task->locks, 0);
 #endif
 
     ptls->root_task = ptls->current_task;
@@ -45,6 +45,12 @@ int ti_threadgroup_create(uint8_t num_sockets, uint8_t num_cores,
 
     uv_mutex_init(&tg->alarm_lock);
     uv_cond_init(&tg->alarm);
+    tg->forkee_sleeping = 0;
+
+    tg->arrived = 0;
+    tg->master_sleeping = 0;
+    uv_mutex_init(&tg->join_lock);
+    uv_cond_init(&tg->join_alarm);
 
     tg->sleep_threshold = DEFAULT_THREAD_SLEEP_THRESHOLD;
     cp = getenv(THREAD_SLEEP_THRESHOLD_NAME);
@@ -123,11 +129,13 @@ int ti_threadgroup_fork(ti_threadgroup_t *tg, int16_t ext_tid, void **bcast_val)
     int thread_sense = tg->thread_sense[tid]->sense;
     if (tid == 0) {
         tg->envelope = bcast_val ? *bcast_val : NULL;
-        // synchronize `tg->envelope` and `tg->group_sense`
-        jl_atomic_store_release(group_sense, thread_sense);
+        // synchronize `tg->envelope` and `tg->group_sense`; seq_cst so
+        // the store can't reorder with the forkee_sleeping load below
+        jl_atomic_store(group_sense, thread_sense);
 
-        // if it's possible that threads are sleeping, signal them
-        if (tg->sleep_threshold) {
+        // only take the lock and broadcast when somebody is actually
+        // asleep; fine-grained loops stay entirely in the spin path
+        if (tg->sleep_threshold && jl_atomic_load(&tg->forkee_sleeping)) {
             uv_mutex_lock(&tg->alarm_lock);
             uv_cond_broadcast(&tg->alarm);
             uv_mutex_unlock(&tg->alarm_lock);
@@ -149,9 +157,13 @@ int ti_threadgroup_fork(ti_threadgroup_t *tg, int16_t ext_tid, void **bcast_val)
                 // In case uv_hrtime is not monotonic, we'll sleep earlier
                 if (spin_ns >= tg->sleep_threshold) {
                     uv_mutex_lock(&tg->alarm_lock);
+                    // seq_cst increment: either the master's fork sees
+                    // us sleeping, or we see its group_sense store here
+                    jl_atomic_fetch_add(&tg->forkee_sleeping, 1);
                     if (jl_atomic_load_acquire(group_sense) != thread_sense) {
                         uv_cond_wait(&tg->alarm, &tg->alarm_lock);
                     }
+                    jl_atomic_fetch_add(&tg->forkee_sleeping, -1);
                     uv_mutex_unlock(&tg->alarm_lock);
                     spin_start = 0;
                     continue;
@@ -172,12 +184,51 @@ int ti_threadgroup_join(ti_threadgroup_t *tg, int16_t ext_tid)
     jl_atomic_store_release(p_thread_sense, !*p_thread_sense);
     if (tg->tid_map[ext_tid] == 0) {
         jl_ptls_t ptls = jl_get_ptls_states();
-        int8_t group_sense = tg->group_sense;
-        for (int i = 1; i < tg->num_threads; ++i) {
-            while (jl_atomic_load_acquire(&tg->thread_sense[i]->sense) == group_sense) {
-                jl_gc_safepoint_(ptls);
-                jl_cpu_pause();
+        int16_t nworkers = tg->num_threads - 1;
+        uint64_t spin_ns;
+        uint64_t spin_start = 0;
+        // wait on the single arrival counter instead of polling every
+        // thread's sense word; spin up to threshold ns, then sleep
+        while (jl_atomic_load_acquire(&tg->arrived) != nworkers) {
+            if (tg->sleep_threshold) {
+                if (!spin_start) {
+                    // Lazily initialize spin_start since uv_hrtime is expensive
+                    spin_start = uv_hrtime();
+                    continue;
+                }
+                spin_ns = uv_hrtime() - spin_start;
+                if (spin_ns >= tg->sleep_threshold) {
+                    uv_mutex_lock(&tg->join_lock);
+                    tg->master_sleeping = 1;
+                    if (jl_atomic_load_acquire(&tg->arrived) != nworkers) {
+                        // sleep GC-safe so a worker that triggers a
+                        // collection on its way here needn't wait for
+                        // us to reach a safepoint
+                        int8_t gc_state = jl_gc_safe_enter(ptls);
+                        uv_cond_wait(&tg->join_alarm, &tg->join_lock);
+                        jl_gc_safe_leave(ptls, gc_state);
+                    }
+                    tg->master_sleeping = 0;
+                    uv_mutex_unlock(&tg->join_lock);
+                    spin_start = 0;
+                    continue;
+                }
             }
+            jl_gc_safepoint_(ptls);
+            jl_cpu_pause();
+        }
+        jl_atomic_store_release(&tg->arrived, 0);
+    }
+    else {
+        if (jl_atomic_fetch_add(&tg->arrived, 1) == tg->num_threads - 2 &&
+            tg->sleep_threshold) {
+            // we are the last to arrive; wake the master if it gave up
+            // spinning (master_sleeping is only read under join_lock,
+            // and the master rechecks `arrived` before sleeping)
+            uv_mutex_lock(&tg->join_lock);
+            if (tg->master_sleeping)
+                uv_cond_signal(&tg->join_alarm);
+            uv_mutex_unlock(&tg->join_lock);
         }
     }
 
@@ -190,6 +241,8 @@ int ti_threadgroup_destroy(ti_threadgroup_t *tg)
 
     uv_mutex_destroy(&tg->alarm_lock);
     uv_cond_destroy(&tg->alarm);
+    uv_mutex_destroy(&tg->join_lock);
+    uv_cond_destroy(&tg->join_alarm);
 
     for (i = 0;  i < tg->num_threads;  i++)
         jl_free_aligned(tg->thread_sense[i]);
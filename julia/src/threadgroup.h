@@ -21,10 +21,19 @@ typedef struct {
     ti_thread_sense_t **thread_sense;
     void              *envelope;
 
-    // to let threads sleep
+    // to let forked threads sleep
     uv_mutex_t alarm_lock;
     uv_cond_t  alarm;
     uint64_t   sleep_threshold;
+    int16_t    forkee_sleeping; // # of threads asleep on `alarm`
+
+    // join barrier: workers bump one arrival counter instead of the
+    // master polling every thread's sense word; the master spins for
+    // up to sleep_threshold ns and then sleeps on `join_alarm`
+    int16_t    arrived;
+    uint8_t    master_sleeping; // protected by join_lock
+    uv_mutex_t join_lock;
+    uv_cond_t  join_alarm;
 } ti_threadgroup_t;
 
 int ti_threadgroup_create(uint8_t num_sockets, uint8_t num_cores,
@@ -44,6 +44,142 @@ extern "C" {
 #include "threadgroup.h"
 #include "threading.h"
 
+// CPU topology and thread affinity. Linux exposes the NUMA layout in
+// sysfs; elsewhere everything lands on one node and the policy code
+// degenerates to the old compact pinning. The enumeration is also
+// exported (jl_topo_*) so runtime configuration code can place work --
+// e.g. co-locate GC mark workers with the node holding the heap --
+// without reparsing sysfs itself.
+static int topo_ncpus = 0;
+static int topo_nnodes = 1;
+static int *topo_node_of = NULL; // NUMA node of each cpu
+
+static void jl_topo_init(void)
+{
+    if (topo_ncpus)
+        return;
+    topo_ncpus = jl_cpu_cores();
+    topo_node_of = (int*)calloc(topo_ncpus, sizeof(int));
+#ifdef _OS_LINUX_
+    for (int node = 0; ; node++) {
+        char path[128], buf[1024];
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/node/node%d/cpulist", node);
+        FILE *f = fopen(path, "r");
+        if (!f)
+            break;
+        if (fgets(buf, sizeof(buf), f)) {
+            // ranges like "0-7,16-23"
+            char *p = buf;
+            while (*p && *p != '\n') {
+                int lo = (int)strtol(p, &p, 10), hi = lo;
+                if (*p == '-')
+                    hi = (int)strtol(p + 1, &p, 10);
+                for (int c = lo; c <= hi && c < topo_ncpus; c++)
+                    topo_node_of[c] = node;
+                if (*p != ',')
+                    break;
+                p++;
+            }
+        }
+        fclose(f);
+        topo_nnodes = node + 1;
+    }
+#endif
+}
+
+JL_DLLEXPORT int jl_topo_ncpus(void)
+{
+    jl_topo_init();
+    return topo_ncpus;
+}
+
+JL_DLLEXPORT int jl_topo_nnodes(void)
+{
+    jl_topo_init();
+    return topo_nnodes;
+}
+
+JL_DLLEXPORT int jl_topo_node_of_cpu(int cpu)
+{
+    jl_topo_init();
+    return (cpu >= 0 && cpu < topo_ncpus) ? topo_node_of[cpu] : -1;
+}
+
+// pin the calling thread to one cpu; nonzero means failure
+JL_DLLEXPORT int jl_topo_pin_self(int cpu)
+{
+    jl_topo_init();
+    if (cpu < 0 || cpu >= topo_ncpus || topo_ncpus > UV_CPU_SETSIZE)
+        return -1;
+    char mask[UV_CPU_SETSIZE];
+    memset(mask, 0, UV_CPU_SETSIZE);
+    mask[cpu] = 1;
+    uv_thread_t self = (uv_thread_t)uv_thread_self();
+    return uv_thread_setaffinity(&self, mask, NULL, UV_CPU_SETSIZE);
+}
+
+// Fill cpu_of_tid[0..jl_n_threads) according to JULIA_THREAD_POLICY:
+// "compact" packs tids onto consecutive cpus (the old exclusive-mode
+// layout), "scatter" deals them round-robin across NUMA nodes, and
+// "node:N" keeps every thread on node N. Returns 0 when no policy is
+// set and the caller should fall back to the JULIA_EXCLUSIVE behavior.
+static int jl_topo_policy(int *cpu_of_tid)
+{
+    char *cp = getenv(THREAD_POLICY_NAME);
+    if (!cp || !*cp)
+        return 0;
+    jl_topo_init();
+    if (!strncmp(cp, "node:", 5)) {
+        int node = (int)strtol(cp + 5, NULL, 10);
+        int n = 0;
+        for (int c = 0; c < topo_ncpus; c++)
+            if (topo_node_of[c] == node)
+                n++;
+        if (n == 0) {
+            jl_printf(JL_STDERR, "WARNING: %s: no cpus on node %d, not pinning\n",
+                      THREAD_POLICY_NAME, node);
+            return 0;
+        }
+        int k = 0;
+        for (int i = 0; i < jl_n_threads; i++) {
+            while (topo_node_of[k % topo_ncpus] != node)
+                k++;
+            cpu_of_tid[i] = k % topo_ncpus;
+            k++;
+        }
+    }
+    else if (!strcmp(cp, "scatter")) {
+        // deal cpus node by node: tid i goes to the i-th cpu of node
+        // (i mod nnodes), wrapping within the node as needed
+        for (int i = 0; i < jl_n_threads; i++) {
+            int node = i % topo_nnodes;
+            int n = 0;
+            for (int c = 0; c < topo_ncpus; c++)
+                if (topo_node_of[c] == node)
+                    n++;
+            int idx = (i / topo_nnodes) % (n ? n : 1);
+            int seen = 0, cpu = 0;
+            for (int c = 0; c < topo_ncpus; c++) {
+                if (topo_node_of[c] != node)
+                    continue;
+                cpu = c;
+                if (seen++ == idx)
+                    break;
+            }
+            cpu_of_tid[i] = cpu;
+        }
+    }
+    else {
+        if (strcmp(cp, "compact"))
+            jl_printf(JL_STDERR, "WARNING: %s: unknown policy \"%s\", using compact\n",
+                      THREAD_POLICY_NAME, cp);
+        for (int i = 0; i < jl_n_threads; i++)
+            cpu_of_tid[i] = i % topo_ncpus;
+    }
+    return 1;
+}
+
 // The tls_states buffer:
 //
 // On platforms that do not use ELF (i.e. where `__thread` is emulated with
@@ -285,6 +421,11 @@ static void ti_initthread(int16_t tid)
     }
     ptls->bt_data = (uintptr_t*)bt_data;
     jl_mk_thread_heap(ptls);
+    // per-thread perm-gen bump arena starts empty
+    ptls->gc_perm_pool = NULL;
+    ptls->gc_perm_size = 0;
+    ptls->gc_perm_allocd = 0;
+    ptls->gc_wb_log_len = 0;
     jl_install_thread_signal_handler(ptls);
     // initialize thread-local GC structures
     ptls->tl_gcs = neptune_init_thread_local_gc(ptls);
@@ -551,6 +692,13 @@ void jl_init_threading(void)
 
     jl_all_tls_states = (jl_ptls_t*)malloc(jl_n_threads * sizeof(void*));
 
+    // per-thread cursors for the work-stealing `@threads` schedule
+    ws_ranges = (ti_wsrange_t*)jl_malloc_aligned(jl_n_threads * sizeof(ti_wsrange_t), 64);
+    memset(ws_ranges, 0, jl_n_threads * sizeof(ti_wsrange_t));
+    cp = getenv(THREADS_DYNAMIC_NAME);
+    if (cp)
+        ti_threads_dynamic = strtol(cp, NULL, 10);
+
 #if PROFILE_JL_THREADING
     // set up space for profiling information
     fork_ns = (uint64_t*)jl_malloc_aligned(jl_n_threads * sizeof(uint64_t), 64);
@@ -577,12 +725,23 @@ void jl_start_threads(void)
     if (cp)
         exclusive = strtol(cp, NULL, 10);
 
+    // topology-aware placement (JULIA_THREAD_POLICY) overrides the
+    // plain compact layout of exclusive mode and implies pinning
+    int *cpu_of_tid = (int*)malloc(jl_n_threads * sizeof(int));
+    if (jl_topo_policy(cpu_of_tid)) {
+        exclusive = 1;
+    }
+    else {
+        for (i = 0; i < jl_n_threads; i++)
+            cpu_of_tid[i] = i;
+    }
+
     // exclusive use: affinitize threads, master thread on proc 0, rest
     // according to a 'compact' policy
     // non-exclusive: no affinity settings; let the kernel move threads about
     if (exclusive) {
         memset(mask, 0, UV_CPU_SETSIZE);
-        mask[0] = 1;
+        mask[cpu_of_tid[0]] = 1;
         uvtid = (uv_thread_t)uv_thread_self();
         uv_thread_setaffinity(&uvtid, mask, NULL, UV_CPU_SETSIZE);
     }
@@ -599,7 +758,7 @@ void jl_start_threads(void)
         uv_thread_create(&uvtid, ti_threadfun, targs[i]);
         if (exclusive) {
             memset(mask, 0, UV_CPU_SETSIZE);
-            mask[i+1] = 1;
+            mask[cpu_of_tid[i+1]] = 1;
             uv_thread_setaffinity(&uvtid, mask, NULL, UV_CPU_SETSIZE);
         }
         uv_thread_detach(&uvtid);
@@ -621,6 +780,7 @@ void jl_start_threads(void)
 
     // free the argument array; the threads will free their arguments
     free(targs);
+    free(cpu_of_tid);
 }
 
 // TODO: is this needed? where/when/how to call it?
@@ -649,6 +809,65 @@ void jl_shutdown_threading(void)
 // return thread's thread group
 JL_DLLEXPORT void *jl_threadgroup(void) { return (void *)tgworld; }
 
+// Work-stealing range scheduler for `@threads` (JULIA_THREADS_DYNAMIC).
+// Each thread owns a cache-line-sized cursor over its static slice of
+// the iteration space; threads claim fixed-size chunks from their own
+// slice with a fetch-add and, once it is drained, sweep the other
+// threads' slices and claim chunks there the same way. The fetch-add
+// hands out every index exactly once, so stealing needs no deque or
+// CAS retry loop; at worst a visit to a drained slice wastes one
+// increment of a cursor nobody reads for indexing anymore.
+typedef struct {
+    volatile int64_t next; // claim cursor, grows past hi when drained
+    int64_t hi;            // exclusive upper bound, fixed per loop
+    char pad[64 - 2 * sizeof(int64_t)];
+} ti_wsrange_t;
+
+static ti_wsrange_t *ws_ranges = NULL;
+static int64_t ws_chunk = 1;
+static int ti_threads_dynamic = DEFAULT_THREADS_DYNAMIC;
+
+JL_DLLEXPORT int jl_threading_dynamic(void)
+{
+    return ti_threads_dynamic;
+}
+
+// master only, before the region is forked: carve `len` iterations
+// (0-based here, the Julia side adds 1) into per-thread slices and
+// pick a chunk size that gives each thread several chunks to rebalance
+JL_DLLEXPORT void jl_threading_start_ranges(int64_t len)
+{
+    int64_t each = len / jl_n_threads, rem = len % jl_n_threads;
+    int64_t lo = 0;
+    for (int i = 0; i < jl_n_threads; i++) {
+        int64_t n = each + (i < rem);
+        ws_ranges[i].next = lo;
+        ws_ranges[i].hi = lo + n;
+        lo += n;
+    }
+    ws_chunk = len / (jl_n_threads * 16);
+    if (ws_chunk < 1)
+        ws_chunk = 1;
+}
+
+// claim the next chunk [*lo, *hi) for `tid`, stealing from the other
+// threads once its own slice is drained; 0 means the space is empty
+JL_DLLEXPORT int jl_threading_next_chunk(int16_t tid, int64_t *lo, int64_t *hi)
+{
+    for (int k = 0; k < jl_n_threads; k++) {
+        ti_wsrange_t *w = &ws_ranges[(tid + k) % jl_n_threads];
+        if (jl_atomic_load_acquire(&w->next) >= w->hi)
+            continue;
+        int64_t i = jl_atomic_fetch_add(&w->next, ws_chunk);
+        if (i >= w->hi)
+            continue;
+        *lo = i;
+        *hi = i + ws_chunk < w->hi ? i + ws_chunk : w->hi;
+        return 1;
+    }
+    return 0;
+}
+
 // interface to user code: specialize and compile the user thread function
 // and run it in all threads
 JL_DLLEXPORT jl_value_t *jl_threading_run(jl_value_t *_args)
@@ -805,6 +1024,22 @@ void jl_init_threading(void)
 
 void jl_start_threads(void) { }
 
+JL_DLLEXPORT int jl_threading_dynamic(void)
+{
+    return 0;
+}
+
+JL_DLLEXPORT void jl_threading_start_ranges(int64_t len)
+{
+    (void)len;
+}
+
+JL_DLLEXPORT int jl_threading_next_chunk(int16_t tid, int64_t *lo, int64_t *hi)
+{
+    (void)tid; (void)lo; (void)hi;
+    return 0;
+}
+
 #endif // !JULIA_ENABLE_THREADING
 
 // Make gc alignment available for threading
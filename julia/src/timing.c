@@ -20,10 +20,100 @@ const char *jl_timing_names[(int)JL_TIMING_LAST] =
 #undef X
     };
 
+// GC phase attribution. The Rust collector brackets its mark, sweep,
+// remset, finalizer and cache-synchronization work with
+// jl_timing_gc_phase_start/stop; counts accumulate in thread-local
+// buffers (marking and sweeping run on worker threads too) that are
+// folded into jl_timing_data when jl_print_timings runs. The phase
+// argument is an offset from JL_TIMING_GC_MARK; keep the order in
+// sync with neptune/src/c_interface.rs.
+#define JL_TIMING_GC_PHASES (JL_TIMING_GC_SYNC - JL_TIMING_GC_MARK + 1)
+#define JL_TIMING_MAX_THREAD_BUFS 128
+static uint64_t *jl_timing_thread_bufs[JL_TIMING_MAX_THREAD_BUFS];
+static int jl_timing_thread_buf_cnt = 0;
+static __thread uint64_t jl_timing_phase_total[JL_TIMING_GC_PHASES];
+static __thread uint64_t jl_timing_phase_t0[JL_TIMING_GC_PHASES];
+static __thread int jl_timing_phase_registered = 0;
+
+// per-thread owner and parent/child buffers written by the inline
+// timing blocks (timing.h); same registration scheme as the GC phase
+// buffers above, merged by jl_print_timings
+__thread uint64_t *jl_timing_tls_self = NULL;
+__thread uint64_t *jl_timing_tls_tree = NULL;
+static uint64_t *jl_timing_self_bufs[JL_TIMING_MAX_THREAD_BUFS];
+static uint64_t *jl_timing_tree_bufs[JL_TIMING_MAX_THREAD_BUFS];
+static int jl_timing_tls_buf_cnt = 0;
+static uint64_t jl_timing_tree[JL_TIMING_LAST][JL_TIMING_LAST];
+
+void jl_timing_thread_init(void)
+{
+    if (jl_timing_tls_self)
+        return;
+    uint64_t *self = (uint64_t*)calloc(JL_TIMING_LAST, sizeof(uint64_t));
+    uint64_t *tree = (uint64_t*)calloc(JL_TIMING_LAST * JL_TIMING_LAST,
+                                       sizeof(uint64_t));
+    int slot = __sync_fetch_and_add(&jl_timing_tls_buf_cnt, 1);
+    if (slot < JL_TIMING_MAX_THREAD_BUFS) {
+        jl_timing_self_bufs[slot] = self;
+        jl_timing_tree_bufs[slot] = tree;
+    }
+    // publish the tree pointer first; the inline blocks only test
+    // jl_timing_tls_self
+    jl_timing_tls_tree = tree;
+    jl_timing_tls_self = self;
+}
+
+JL_DLLEXPORT void jl_timing_gc_phase_start(int phase)
+{
+    if (phase < 0 || phase >= JL_TIMING_GC_PHASES)
+        return;
+    if (!jl_timing_phase_registered) {
+        int slot = __sync_fetch_and_add(&jl_timing_thread_buf_cnt, 1);
+        if (slot < JL_TIMING_MAX_THREAD_BUFS)
+            jl_timing_thread_bufs[slot] = jl_timing_phase_total;
+        jl_timing_phase_registered = 1;
+    }
+    jl_timing_phase_t0[phase] = rdtscp();
+}
+
+JL_DLLEXPORT void jl_timing_gc_phase_stop(int phase)
+{
+    if (phase < 0 || phase >= JL_TIMING_GC_PHASES)
+        return;
+    jl_timing_phase_total[phase] += rdtscp() - jl_timing_phase_t0[phase];
+}
+
 void jl_print_timings(void)
 {
+    // merge the per-thread GC phase buffers, zeroing them so a second
+    // report doesn't count them twice
+    int nbufs = jl_timing_thread_buf_cnt;
+    if (nbufs > JL_TIMING_MAX_THREAD_BUFS)
+        nbufs = JL_TIMING_MAX_THREAD_BUFS;
+    for (int i = 0; i < nbufs; i++) {
+        for (int p = 0; p < JL_TIMING_GC_PHASES; p++) {
+            jl_timing_data[JL_TIMING_GC_MARK + p] += jl_timing_thread_bufs[i][p];
+            jl_timing_thread_bufs[i][p] = 0;
+        }
+    }
+    int ntls = jl_timing_tls_buf_cnt;
+    if (ntls > JL_TIMING_MAX_THREAD_BUFS)
+        ntls = JL_TIMING_MAX_THREAD_BUFS;
+    for (int i = 0; i < ntls; i++) {
+        for (int o = 0; o < JL_TIMING_LAST; o++) {
+            jl_timing_data[o] += jl_timing_self_bufs[i][o];
+            jl_timing_self_bufs[i][o] = 0;
+        }
+        for (int o = 0; o < JL_TIMING_LAST * JL_TIMING_LAST; o++) {
+            jl_timing_tree[0][o] += jl_timing_tree_bufs[i][o];
+            jl_timing_tree_bufs[i][o] = 0;
+        }
+    }
     uint64_t total_time = 0;
     for (int i = 0; i < JL_TIMING_LAST; i++) {
+        // the GC phases overlap the GC owner; don't count them twice
+        if (i >= JL_TIMING_GC_MARK && i <= JL_TIMING_GC_SYNC)
+            continue;
         total_time += jl_timing_data[i];
     }
     for (int i = 0; i < JL_TIMING_LAST; i++) {
@@ -31,6 +121,22 @@ void jl_print_timings(void)
             printf("%-25s : %.2f %%   %" PRIu64 "\n", jl_timing_names[i],
                     100 * (((double)jl_timing_data[i]) / total_time), jl_timing_data[i]);
     }
+    // parent/child breakdown: child time as a share of everything that
+    // ran under the parent (the parent's self time plus its children)
+    printf("\nhierarchical breakdown:\n");
+    for (int p = 0; p < JL_TIMING_LAST; p++) {
+        uint64_t under = jl_timing_data[p];
+        for (int c = 0; c < JL_TIMING_LAST; c++)
+            under += jl_timing_tree[p][c];
+        for (int c = 0; c < JL_TIMING_LAST; c++) {
+            if (jl_timing_tree[p][c] == 0)
+                continue;
+            printf("%-25s > %-25s : %.2f %%   %" PRIu64 "\n",
+                    jl_timing_names[p], jl_timing_names[c],
+                    100 * (((double)jl_timing_tree[p][c]) / under),
+                    jl_timing_tree[p][c]);
+        }
+    }
 }
 
 void jl_init_timing(void)
@@ -66,6 +172,9 @@ void jl_timing_block_stop(jl_timing_block_t *cur_block)
 
 void jl_init_timing(void) { }
 void jl_destroy_timing(void) { }
+// the Rust collector calls these unconditionally
+JL_DLLEXPORT void jl_timing_gc_phase_start(int phase) { (void)phase; }
+JL_DLLEXPORT void jl_timing_gc_phase_stop(int phase) { (void)phase; }
 
 #endif
 
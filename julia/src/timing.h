@@ -9,6 +9,7 @@ extern "C" {
 #endif
 void jl_print_timings(void);
 void jl_init_timing(void);
+void jl_timing_thread_init(void);
 jl_timing_block_t *jl_pop_timing_block(jl_timing_block_t *cur_block);
 void jl_destroy_timing(void);
 extern jl_timing_block_t *jl_root_timing;
@@ -37,9 +38,18 @@ static inline uint64_t rdtscp(void)
     return (rdx << 32) + rax;
 }
 
+// The GC_* phase owners below GC are filled in by the Rust collector
+// through jl_timing_gc_phase_start/stop (timing.c); they break the GC
+// owner down and overlap it, so jl_print_timings leaves them out of
+// the total.
 #define JL_TIMING_OWNERS          \
         X(ROOT),                  \
         X(GC),                    \
+        X(GC_MARK),               \
+        X(GC_SWEEP),              \
+        X(GC_REMSET),             \
+        X(GC_FINALIZERS),         \
+        X(GC_SYNC),               \
         X(LOWERING),              \
         X(PARSING),               \
         X(INFERENCE),             \
@@ -70,6 +80,15 @@ enum jl_timing_owners {
 extern uint64_t jl_timing_data[(int)JL_TIMING_LAST];
 extern const char *jl_timing_names[(int)JL_TIMING_LAST];
 
+// per-thread accumulation buffers, allocated and registered on first
+// use by jl_timing_thread_init and merged by jl_print_timings.
+// jl_timing_tls_self is self-time per owner; jl_timing_tls_tree is a
+// JL_TIMING_LAST x JL_TIMING_LAST matrix of child time per parent
+// owner, so time spent in GC under CODEGEN is distinguishable from GC
+// under INFERENCE.
+extern __thread uint64_t *jl_timing_tls_self;
+extern __thread uint64_t *jl_timing_tls_tree;
+
 struct _jl_timing_block_t { // typedef in julia.h
     jl_timing_block_t *prev;
     uint64_t total;
@@ -119,7 +138,12 @@ STATIC_INLINE void _jl_timing_block_ctor(jl_timing_block_t *block, int owner) {
 STATIC_INLINE void _jl_timing_block_destroy(jl_timing_block_t *block) {
     uint64_t t = rdtscp();
     _jl_timing_block_stop(block, t);
-    jl_timing_data[block->owner] += block->total;
+    if (__unlikely(!jl_timing_tls_self))
+        jl_timing_thread_init();
+    jl_timing_tls_self[block->owner] += block->total;
+    if (block->prev)
+        jl_timing_tls_tree[block->prev->owner * JL_TIMING_LAST + block->owner]
+            += block->total;
     jl_timing_block_t **pcur = jl_current_task ? &jl_current_task->timing_stack : &jl_root_timing;
     assert(*pcur == block);
     *pcur = block->prev;
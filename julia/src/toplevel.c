@@ -613,6 +613,24 @@ JL_DLLEXPORT jl_value_t *jl_load(const char *fname)
     if (jl_stat(fname, (char*)&stbuf) != 0 || (stbuf.st_mode & S_IFMT) != S_IFREG) {
         jl_errorf("could not open file %s", fname);
     }
+    // map the file and parse straight out of the page cache instead of
+    // copying the source through flisp's buffered file reader
+    ios_t f;
+    ios_t *fp = ios_file_mmap(&f, fname);
+    if (fp != NULL && f.mmapped) {
+        jl_value_t *result = NULL;
+        JL_TRY {
+            result = jl_parse_eval_all(fname, f.buf, (size_t)f.size);
+        }
+        JL_CATCH {
+            ios_close(&f);
+            jl_rethrow();
+        }
+        ios_close(&f);
+        return result;
+    }
+    if (fp != NULL)
+        ios_close(&f);
     return jl_parse_eval_all(fname, NULL, 0);
 }
 
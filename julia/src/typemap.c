@@ -241,9 +241,20 @@ union jl_typemap_t mtcache_hash_lookup(const struct jl_ordereddict_t *a, jl_valu
     ml.unknown = jl_nothing;
     if (!uid)
         return ml;
-    size_t idx = jl_intref(a->indexes, uid & (a->indexes->nrows-1));
+    // this runs lock-free against concurrent insertion: the writer
+    // republishes grown copies of these arrays with release stores
+    // (RCU-style), so acquire loads plus the bounds and NULL checks below
+    // turn any stale view into a miss, which the caller retries under the
+    // method-table lock
+    jl_array_t *indexes = jl_atomic_load_acquire(&a->indexes);
+    size_t idx = jl_intref(indexes, uid & (indexes->nrows-1));
     if (idx > 0) {
-        ml.unknown = jl_array_ptr_ref(a->values, idx - 1);
+        jl_array_t *values = jl_atomic_load_acquire(&a->values);
+        if (idx > jl_array_len(values))
+            return ml; // racing insert into a republished copy
+        ml.unknown = jl_array_ptr_ref(values, idx - 1);
+        if (ml.unknown == NULL) // slot allocated but not yet filled
+            ml.unknown = jl_nothing;
         if (ml.unknown == jl_nothing)
             return ml;
         jl_value_t *t;
@@ -262,6 +273,21 @@ union jl_typemap_t mtcache_hash_lookup(const struct jl_ordereddict_t *a, jl_valu
     return ml;
 }
 
+// Arrays replaced by an RCU republication are retired here instead of
+// becoming garbage: a concurrently-dispatching thread may still be reading
+// one, and nothing roots it across the lookup. Growth is geometric, so the
+// retained waste stays on the order of the live tables.
+jl_array_t *jl_typemap_retired = NULL;
+
+static void mtcache_retire(jl_array_t *a)
+{
+    if ((jl_value_t*)a == jl_nothing)
+        return;
+    if (jl_typemap_retired == NULL)
+        jl_typemap_retired = jl_alloc_vec_any(0);
+    jl_array_ptr_1d_push(jl_typemap_retired, (jl_value_t*)a);
+}
+
 static void mtcache_rehash(struct jl_ordereddict_t *pa, size_t newlen, jl_value_t *parent, int8_t tparam, int8_t offs)
 {
     size_t i, nval = jl_array_len(pa->values);
@@ -269,7 +295,7 @@ static void mtcache_rehash(struct jl_ordereddict_t *pa, size_t newlen, jl_value_
     for (i = 1; i <= nval; i++) {
         union jl_typemap_t ml;
         ml.unknown = jl_array_ptr_ref(pa->values, i - 1);
-        if (ml.unknown == jl_nothing)
+        if (ml.unknown == NULL || ml.unknown == jl_nothing)
             continue;
         jl_value_t *t;
         if (jl_typeof(ml.unknown) == (jl_value_t*)jl_typemap_level_type) {
@@ -293,7 +319,11 @@ static void mtcache_rehash(struct jl_ordereddict_t *pa, size_t newlen, jl_value_
             n = jl_alloc_int_1d(nval + 1, newlen);
         }
     }
-    pa->indexes = n;
+    // republish the fully-built table; the old one stays valid for any
+    // reader that already loaded it (the idx values it holds still point
+    // into the same values array)
+    mtcache_retire(pa->indexes);
+    jl_atomic_store_release(&pa->indexes, n);
     jl_gc_wb(parent, n);
 }
 
@@ -305,7 +335,8 @@ void jl_typemap_rehash_array(struct jl_ordereddict_t *pa, jl_value_t *parent, in
     for (i = 0; i < len; i++) {
         union jl_typemap_t ml;
         ml.unknown = jl_array_ptr_ref(pa->values, i);
-        assert(ml.unknown != NULL);
+        if (ml.unknown == NULL) // spare capacity
+            continue;
         jl_typemap_rehash(ml, offs+1);
     }
     mtcache_rehash(pa, 4 * next_power_of_two(len), parent, tparam, offs);
@@ -320,6 +351,38 @@ void jl_typemap_rehash(union jl_typemap_t ml, int8_t offs) {
     }
 }
 
+// number of values slots handed out so far; spare capacity from the
+// last republication is NULL-filled and sits past the end
+static size_t mtcache_num_used(const jl_array_t *values)
+{
+    size_t n = jl_array_len(values);
+    union jl_typemap_t *data = (union jl_typemap_t*)jl_array_data(values);
+    while (n > 0 && data[n - 1].unknown == NULL)
+        n--;
+    return n;
+}
+
+// allocate the next values slot. when the array is full, a doubled copy is
+// built off to the side and republished with a release store so lock-free
+// readers never see the backing buffer reallocated under them; the old
+// copy is retired, not freed.
+static size_t mtcache_values_push(struct jl_ordereddict_t *pa, jl_value_t *parent)
+{
+    size_t used = mtcache_num_used(pa->values);
+    if (used == jl_array_len(pa->values)) {
+        size_t newlen = used ? used * 2 : INIT_CACHE_SIZE;
+        jl_array_t *nv = jl_alloc_vec_any(newlen);
+        if (used)
+            jl_array_ptr_copy(nv, (void**)jl_array_data(nv),
+                              pa->values, (void**)jl_array_data(pa->values), used);
+        mtcache_retire(pa->values);
+        jl_atomic_store_release(&pa->values, nv);
+        jl_gc_wb(parent, nv);
+    }
+    jl_array_ptr_set(pa->values, used, jl_nothing);
+    return used + 1;
+}
+
 static union jl_typemap_t *mtcache_hash_bp(struct jl_ordereddict_t *pa, jl_value_t *ty,
                                            int8_t tparam, int8_t offs, jl_value_t *parent)
 {
@@ -330,17 +393,17 @@ static union jl_typemap_t *mtcache_hash_bp(struct jl_ordereddict_t *pa, jl_value
             // since they should have a lower priority and need to go into the sorted list
             return NULL;
         if (pa->values == (void*)jl_nothing) {
-            pa->indexes = jl_alloc_int_1d(0, INIT_CACHE_SIZE);
-            jl_gc_wb(parent, pa->indexes);
-            pa->values = jl_alloc_vec_any(0);
+            // values must be visible before any index referencing it
+            jl_atomic_store_release(&pa->values, jl_alloc_vec_any(0));
             jl_gc_wb(parent, pa->values);
+            jl_atomic_store_release(&pa->indexes, jl_alloc_int_1d(0, INIT_CACHE_SIZE));
+            jl_gc_wb(parent, pa->indexes);
         }
         while (1) {
             size_t slot = uid & (pa->indexes->nrows - 1);
             size_t idx = jl_intref(pa->indexes, slot);
             if (idx == 0) {
-                jl_array_ptr_1d_push(pa->values, jl_nothing);
-                idx = jl_array_len(pa->values);
+                idx = mtcache_values_push(pa, parent);
                 if (idx > jl_max_int(pa->indexes))
                     mtcache_rehash(pa, jl_array_len(pa->indexes), parent, tparam, offs);
                 jl_intset(pa->indexes, slot, idx);
@@ -374,6 +437,8 @@ static int jl_typemap_array_visitor(struct jl_ordereddict_t *a, jl_typemap_visit
     size_t i, l = jl_array_len(a->values);
     union jl_typemap_t *data = (union jl_typemap_t*)jl_array_data(a->values);
     for(i=0; i < l; i++) {
+        if (data[i].unknown == NULL) // spare capacity
+            continue;
         if (!jl_typemap_visitor(data[i], fptr, closure))
             return 0;
     }
@@ -423,7 +488,7 @@ static int jl_typemap_intersection_array_visitor(struct jl_ordereddict_t *a, jl_
     union jl_typemap_t *data = (union jl_typemap_t*)jl_array_data(a->values);
     for (i = 0; i < l; i++) {
         union jl_typemap_t ml = data[i];
-        if (ml.unknown == jl_nothing)
+        if (ml.unknown == NULL || ml.unknown == jl_nothing)
             continue;
         jl_value_t *t;
         if (jl_typeof(ml.unknown) == (jl_value_t*)jl_typemap_level_type) {
@@ -824,12 +889,18 @@ jl_typemap_entry_t *jl_typemap_level_assoc_exact(jl_typemap_level_t *cache, jl_v
             if (ml) return ml;
         }
     }
-    if (cache->linear != (jl_typemap_entry_t*)jl_nothing) {
-        jl_typemap_entry_t *ml = jl_typemap_entry_assoc_exact(cache->linear, args, n, world);
+    // acquire pairs with the release-publication on insertion; the `next`
+    // chains inside the list are ordered by the data dependency on the
+    // published pointer
+    jl_typemap_entry_t *linear = jl_atomic_load_acquire(&cache->linear);
+    if (linear != (jl_typemap_entry_t*)jl_nothing) {
+        jl_typemap_entry_t *ml = jl_typemap_entry_assoc_exact(linear, args, n, world);
         if (ml) return ml;
     }
-    if (cache->any.unknown != jl_nothing)
-        return jl_typemap_assoc_exact(cache->any, args, n, offs+1, world);
+    union jl_typemap_t any;
+    any.unknown = jl_atomic_load_acquire(&cache->any.unknown);
+    if (any.unknown != jl_nothing)
+        return jl_typemap_assoc_exact(any, args, n, offs+1, world);
     return NULL;
 }
 
@@ -889,7 +960,9 @@ static void jl_typemap_list_insert_(jl_typemap_entry_t **pml, jl_value_t *parent
     if (*pml == (void*)jl_nothing || newrec->isleafsig || (tparams && tparams->unsorted)) {
         newrec->next = *pml;
         jl_gc_wb(newrec, newrec->next);
-        *pml = newrec;
+        // publish only once newrec is fully initialized, so a lock-free
+        // reader walking this list never sees a half-built entry
+        jl_atomic_store_release(pml, newrec);
         jl_gc_wb(parent, newrec);
     }
     else {
@@ -908,7 +981,12 @@ static void jl_typemap_insert_generic(union jl_typemap_t *pml, jl_value_t *paren
 
     unsigned count = jl_typemap_list_count(pml->leaf);
     if (count > MAX_METHLIST_COUNT) {
-        pml->node = jl_method_convert_list_to_cache(pml->leaf, key, offs, tparams);
+        // the conversion relinks the existing entries into the new level's
+        // sublists; a reader mid-walk on the old list can be truncated by
+        // that, which again only causes a spurious miss. the level itself
+        // is fully built before being published here.
+        jl_typemap_level_t *node = jl_method_convert_list_to_cache(pml->leaf, key, offs, tparams);
+        jl_atomic_store_release(&pml->node, node);
         jl_gc_wb(parent, pml->node);
         jl_typemap_level_insert_(pml->node, newrec, offs, tparams);
         return;
@@ -1073,7 +1151,8 @@ static void jl_typemap_list_insert_sorted(jl_typemap_entry_t **pml, jl_value_t *
     JL_SIGATOMIC_BEGIN();
     newrec->next = l;
     jl_gc_wb(newrec, l);
-    *pl = newrec;
+    // release-publish, as in jl_typemap_list_insert_
+    jl_atomic_store_release(pl, newrec);
     jl_gc_wb(pa, newrec);
     // if this contains Union types, methods after it might actually be
     // more specific than it. we need to re-sort them.
@@ -1092,11 +1171,14 @@ static void jl_typemap_list_insert_sorted(jl_typemap_entry_t **pml, jl_value_t *
             while (l != newrec->next) {
                 if (jl_type_morespecific((jl_value_t*)item->sig, (jl_value_t*)l->sig)) {
                     // reinsert item earlier in the list
+                    // unlink, then relink earlier; a concurrent reader past
+                    // the new position may miss `item` this pass, which is
+                    // at worst a spurious cache miss retried under the lock
                     *pitem = next;
                     jl_gc_wb(item_parent, next);
                     item->next = l;
                     jl_gc_wb(item, item->next);
-                    *pl = item;
+                    jl_atomic_store_release(pl, item);
                     jl_gc_wb(pa, item);
                     pnext = pitem;
                     next_parent = item_parent;
@@ -0,0 +1,137 @@
+//! In-runtime microbenchmarks for the allocator hot paths, entered
+//! through `neptune_microbench` (see benchmarks/microbench.jl). A
+//! standalone `cargo bench` harness cannot link this crate — nearly
+//! every path references symbols the Julia runtime provides (gc_num,
+//! the USDT shims, the jl_* statics) — so the suite runs inside a
+//! live runtime against the real collector state instead, which is
+//! also what makes the per-op costs representative: freelists, page
+//! metadata and remsets are in their steady-state shape.
+//!
+//! Everything allocated here is left unreachable and untyped (header
+//! zeroed), so the next sweep reclaims it without the mark phase ever
+//! looking at it.
+
+use gc2::*;
+use pages::*;
+use c_interface::*;
+use concurrency::*;
+use scoped_threadpool::Pool;
+use libc;
+
+const ITERS: usize = 1_000_000;
+const BIG_ITERS: usize = 10_000;
+const PAGE_ITERS: usize = 10_000;
+const QUEUE_ITERS: usize = 100_000;
+const CONTENDED_THREADS: usize = 4;
+
+// GC_OLD | GC_MARKED; the tag consts in gc2.rs are module-private
+const GC_OLD_MARKED_TAG: usize = 3;
+
+fn report(name: &str, iters: usize, ns: u64) {
+    println!("Neptune microbench: {:<24} {:>8.1} ns/op ({} ops)",
+             name, ns as f64 / iters as f64, iters);
+}
+
+fn bench_pool_alloc(gc: &mut Gc2) {
+    let t0 = neptune_hrtime();
+    for _ in 0..ITERS {
+        let v = gc.pool_alloc(64);
+        unsafe {
+            as_managed_jltaggedvalue(v).yolo_set_header(0);
+        }
+    }
+    report("pool_alloc(64)", ITERS, neptune_hrtime() - t0);
+}
+
+fn bench_big_alloc(gc: &mut Gc2) {
+    let t0 = neptune_hrtime();
+    for _ in 0..BIG_ITERS {
+        let v = gc.big_alloc(4096);
+        unsafe {
+            as_managed_jltaggedvalue(v).yolo_set_header(0);
+        }
+    }
+    report("big_alloc(4096)", BIG_ITERS, neptune_hrtime() - t0);
+}
+
+fn bench_pages() {
+    // ping-pong one page so after the first iteration both directions
+    // hit the freelist fast path, like a steady-state mutator
+    let t0 = neptune_hrtime();
+    for _ in 0..PAGE_ITERS {
+        let addr = unsafe {
+            pg_mgr().alloc_page(&mut REGIONS.as_mut().unwrap()).data.as_ptr()
+        };
+        unsafe {
+            pg_mgr().free_page(REGIONS.as_mut().unwrap().as_mut_slice(), addr);
+        }
+    }
+    report("alloc_page/free_page", PAGE_ITERS, neptune_hrtime() - t0);
+}
+
+fn bench_queue_root(gc: &mut Gc2) {
+    let v_ptr = gc.pool_alloc(64) as * mut JlValue;
+    let remset_len = gc.heap.remset.len();
+    let remset_nptr = gc.heap.remset_nptr;
+    let t0 = neptune_hrtime();
+    for _ in 0..QUEUE_ITERS {
+        unsafe {
+            // queue_root downgrades the tag, restore it each round
+            (*as_mut_jltaggedvalue(v_ptr)).yolo_set_header(GC_OLD_MARKED_TAG);
+            gc.queue_root(&mut *v_ptr);
+        }
+    }
+    report("queue_root", QUEUE_ITERS, neptune_hrtime() - t0);
+    // undo the bookkeeping so the benchmark object dies quietly
+    gc.heap.remset.truncate(remset_len);
+    gc.heap.remset_nptr = remset_nptr;
+    unsafe {
+        (*as_mut_jltaggedvalue(v_ptr)).yolo_set_header(0);
+    }
+}
+
+fn bench_stack() {
+    let stack: ConcurrentStack<* mut libc::c_void> = ConcurrentStack::new();
+    let t0 = neptune_hrtime();
+    for i in 0..ITERS {
+        stack.push(i as * mut libc::c_void);
+    }
+    report("stack push", ITERS, neptune_hrtime() - t0);
+    let t0 = neptune_hrtime();
+    for _ in 0..ITERS {
+        stack.pop();
+    }
+    report("stack pop", ITERS, neptune_hrtime() - t0);
+}
+
+fn bench_stack_contended() {
+    let stack: ConcurrentStack<* mut libc::c_void> = ConcurrentStack::new();
+    let mut pool = Pool::new(CONTENDED_THREADS as u32);
+    let per_thread = ITERS / CONTENDED_THREADS;
+    let t0 = neptune_hrtime();
+    pool.scoped(|scope| {
+        for _ in 0..CONTENDED_THREADS {
+            let s = &stack;
+            scope.execute(move || {
+                for i in 0..per_thread {
+                    s.push(i as * mut libc::c_void);
+                    s.pop();
+                }
+            });
+        }
+    });
+    report("stack push+pop, 4 thr", 2 * per_thread * CONTENDED_THREADS,
+           neptune_hrtime() - t0);
+}
+
+/// Run every hot-path benchmark against the given collector. Must run
+/// on the thread that owns `gc` (the entry point uses thread 0).
+pub fn run_microbench(gc: &mut Gc2) {
+    println!("Neptune microbench:");
+    bench_pool_alloc(gc);
+    bench_big_alloc(gc);
+    bench_pages();
+    bench_queue_root(gc);
+    bench_stack();
+    bench_stack_contended();
+}
@@ -24,6 +24,7 @@ use std::sync::{Arc, Mutex};
 use std::collections::HashMap;
 use util::*;
 use concurrency::*;
+use trace::*;
 use std::sync::*;
 use std::env;
 use scoped_threadpool::Pool;
@@ -71,15 +72,25 @@ impl JlSym {
 impl JlValueMarker for JlSym {
 }
 
+// mirrors jl_mutex_t; kept as a struct (not flattened) so trailing
+// padding matches the C layout
+#[repr(C)]
+pub struct JlMutex {
+    pub owner: libc::c_ulong,
+    pub count: u32,
+}
+
 #[repr(C)]
 pub struct JlModule {
     pub name: * mut JlSym,
     pub parent: * mut JlModule,
     pub bindings: HTable,
-    pub usings: JlArrayList, // modules with all bindings potentially imported
+    pub usings: JlSmallArrayList, // modules with all bindings potentially imported
     pub istopmod: u8,
     pub uuid: u64,
     pub counter: u32,
+    pub lock: JlMutex,
+    pub rehash_gen: u32,
 }
 
 #[repr(C)]
@@ -114,7 +125,7 @@ pub struct JlTask {
     // does not need to be defined until the task runs
     pub tid: i16,
     // This is statically initialized when the task is not holding any locks
-    pub locks: JlArrayList,
+    pub locks: JlSmallArrayList,
     pub timing_stack: * mut JlTimingBlock,
 }
 
@@ -477,6 +488,14 @@ pub const N_CALL_CACHE: usize = 4096; // from options.h
 
 pub const PROMOTE_AGE: usize = 1;
 
+// GC phases for Julia's JL_TIMING report, offsets from
+// JL_TIMING_GC_MARK. ACHTUNG: keep in sync with julia/src/timing.h!
+pub const TIMING_GC_MARK: c_int = 0;
+pub const TIMING_GC_SWEEP: c_int = 1;
+pub const TIMING_GC_REMSET: c_int = 2;
+pub const TIMING_GC_FINALIZERS: c_int = 3;
+pub const TIMING_GC_SYNC: c_int = 4;
+
 pub const JL_CACHE_BYTE_ALIGNMENT: usize = 64;
 
 extern {
@@ -490,6 +509,19 @@ extern {
     // access to julia's timing functions for profiling
     pub fn jl_hrtime() -> u64;
 
+    // per-thread time-to-safepoint histograms (safepoint.c)
+    pub fn jl_safepoint_print_tts();
+
+    // native unwinder and symbolizer (stackwalk.c), for the sampling
+    // allocation profiler
+    pub fn rec_backtrace(data: * mut usize, maxsize: usize) -> usize;
+    pub fn jl_gdblookup(ip: usize);
+
+    // GC phase attribution for ENABLE_TIMINGS builds (timing.c);
+    // no-ops otherwise
+    pub fn jl_timing_gc_phase_start(phase: c_int);
+    pub fn jl_timing_gc_phase_stop(phase: c_int);
+
     pub fn gc_settime_premark_end();
     pub fn gc_time_mark_pause(t0: u64, scanned_bytes: usize, perm_scanned_bytes: usize);
     pub fn gc_settime_postmark_end();
@@ -529,6 +561,8 @@ extern {
     pub fn np_corruption_fail(vt: * mut JlDatatype) -> !;
     pub fn np_verify_parent(ty: * const c_char, o: * const JlValue, slot: * const * mut JlValue, msg: * const c_char);
     pub fn np_call_finalizer(fin: * mut c_void, p: * mut c_void);
+    // hand a dead array buffer back to the C-side buffer pool
+    pub fn np_cache_array_buffer(d: * mut c_void, sz: usize);
 
     // list of global threads, declared in julia/src/threading.c
     pub static jl_n_threads: u32;
@@ -561,6 +595,9 @@ extern {
     pub static jl_typetype_type: * mut JlUnionAll;
     pub static jl_anytuple_type_type: * mut JlUnionAll;
     pub static jl_all_methods: * mut JlArray;
+    pub static jl_typemap_retired: * mut JlArray;
+    pub static jl_callsite_caches: * mut JlArray;
+    pub static jl_intersect_cache: * mut JlArray;
     pub static jl_module_init_order: * mut JlArray;
 
     pub static jl_cfunction_list: JlTypeMap;
@@ -796,6 +833,31 @@ impl JlArrayList {
     }
 }
 
+const SMALL_AL_N_INLINE: usize = 6;
+
+// compact variant used for lists embedded in other objects (see
+// support/arraylist.h)
+pub struct JlSmallArrayList {
+    pub len: usize,
+    pub max: usize,
+    pub items: *mut *mut c_void,
+    pub _space: [*mut c_void; SMALL_AL_N_INLINE],
+}
+
+impl JlSmallArrayList {
+    pub fn as_slice(&self) -> &[* mut c_void] {
+        unsafe {
+            slice::from_raw_parts(self.items, self.len)
+        }
+    }
+
+    pub fn as_slice_mut(&mut self) -> &mut [* mut c_void] {
+        unsafe {
+            slice::from_raw_parts_mut(self.items, self.len)
+        }
+    }
+}
+
 // Thread-local heap
 pub struct JlThreadHeap {
     pub weak_refs: JlArrayList,
@@ -816,9 +878,13 @@ pub struct GcPool {
     osize: u16,
 }
 
-// Julia's Thread-local states
+// Julia's Thread-local states. The C struct is split into a hot block
+// (fields codegen's fast paths touch) and a cache-line-aligned cold
+// block; ACHTUNG: keep the field order and the padding in sync with
+// jl_tls_states_t in julia/src/julia_threads.h!
 #[repr(C)]
 pub struct JlTLS {
+    // --- hot block ---
     pub pgcstack: Box<GcFrame>,
     pub world_age: usize,
     // using Option instead of Box for values that can be null
@@ -828,9 +894,25 @@ pub struct JlTLS {
     pub gc_state: GcState, // volatile
     pub in_finalizer: u8, // volatile
     pub disable_gc: u8,
+    pub tid: i16,
     pub defer_signal: sig_atomic_t, // ???
-    pub current_module: * mut JlModule,
     pub current_task: * mut JlTask, // volatile
+    // per-size-class bump cursors for the inline allocation fast path
+    // emitted by codegen (see emit_allocobj in julia/src/cgutils.cpp).
+    // each (cur, end) pair delimits a span of contiguous free cells in
+    // the page we are currently allocating from.
+    pub gc_pool_cur: [* mut u8; GC_N_POOLS],
+    pub gc_pool_end: [* mut u8; GC_N_POOLS],
+    // SATB-style write-barrier log the C barrier appends to inline; the
+    // GC drains it into the owning thread's remset (see
+    // Gc2::flush_wb_logs)
+    pub gc_wb_log_len: usize,
+    pub gc_wb_log: [* mut JlValue; GC_WB_LOG_SZ],
+    // the C side cache-line-aligns current_module, the first cold
+    // field; mirror the padding that attribute inserts (x86-64 layout)
+    _hot_pad: [u8; 48],
+    // --- cold block ---
+    pub current_module: * mut JlModule,
     pub root_task: * mut JlTask,
     pub task_arg_in_transit: * mut JlValue, // volatile
     pub stackbase: *const c_void,
@@ -839,7 +921,6 @@ pub struct JlTLS {
     pub jmp_target: Option<&'static JlJmpBuf>, // volatile
     pub base_ctx: JlJmpBuf, // base context of stack
     pub safe_restore: Option<&'static JlJmpBuf>,
-    pub tid: i16,
     pub bt_size: usize,
     pub bt_data: *const uintptr_t, // this is an array that is JL_MAX_BT_SIZE + 1 long
     // set by the sender, reset by the handler. Julia will handle signals for us.
@@ -853,8 +934,16 @@ pub struct JlTLS {
     pub finalizers: JlArrayList,
     // pointer to thread-local GC-related stuff, lifetime is meaningless!
     pub tl_gcs: * mut Gc2<'static>,
+    // per-thread perm-gen bump arena, managed entirely on the C side
+    pub gc_perm_pool: * mut u8,
+    pub gc_perm_size: usize,
+    pub gc_perm_allocd: usize,
 }
 
+/// size of the write-barrier log; keep in sync with JL_GC_WB_LOG_SZ in
+/// julia/src/julia_threads.h
+pub const GC_WB_LOG_SZ: usize = 256;
+
 type JlPTLS<'a> = Option<&'a JlTLS>; // this is just a pointer to thread-local state
 
 // Note: We represent sig_atomic_t as c_int since C99 standard says so.
@@ -883,17 +972,19 @@ pub fn pg_mgr<'a>() -> MutexGuard<'a, PageMgr> {
 
 // julia's GC's regions are slightly different, using naked pointers etc.
 #[repr(C)]
-pub struct JlRegion<'a> {
+pub struct JlRegion {
     pub pages: * mut Page,
     pub allocmap: * mut u32,
-    pub meta: * mut PageMeta<'a>,
+    pub meta: * mut PageMeta,
+    pub meta_cold: * mut PageMetaCold,
+    pub summary: * mut u32,
     pub pg_cnt: c_uint,
     pub lb: c_uint,
     pub ub: c_uint
 }
 
-impl<'a> JlRegion<'a> {
-    pub fn to_region(&mut self) -> Region<'a> {
+impl JlRegion {
+    pub fn to_region<'a>(&mut self) -> Region<'a> {
         let pages: &mut [Page] = if self.pages as * const u8 == core::ptr::null() {
             assert!(self.pg_cnt == 0, "page array cannot be null if region is not empty!");
             &mut []
@@ -912,46 +1003,67 @@ impl<'a> JlRegion<'a> {
         } else {
             unsafe { slice::from_raw_parts_mut(self.meta, self.pg_cnt as usize) }
         };
+        let meta_cold: &mut [PageMetaCold] = if self.meta_cold as * const PageMetaCold == core::ptr::null() {
+            assert!(self.pg_cnt == 0, "pagemeta cold array cannot be null if region is not empty!");
+            &mut []
+        } else {
+            unsafe { slice::from_raw_parts_mut(self.meta_cold, self.pg_cnt as usize) }
+        };
+        let summary: &mut [u32] = if self.summary as * const u32 == core::ptr::null() {
+            assert!(self.pg_cnt == 0, "summary array cannot be null if region is not empty!");
+            &mut []
+        } else {
+            unsafe { slice::from_raw_parts_mut(self.summary, (self.pg_cnt as usize / 32 + 31) / 32) }
+        };
         Region {
             pages: pages,
             allocmap: allocmap,
             meta: meta,
+            meta_cold: meta_cold,
+            summary: summary,
             pg_cnt: self.pg_cnt,
             lb: self.lb,
             ub: self.ub,
+            cards: Vec::new(),
+            // C-side views are transient; the real region keeps the
+            // mappings and the shrink policy's idle counter
+            mappings: Vec::new(),
+            idle_gens: 0,
         }
     }
     // update self using information from region
-    pub fn update(&mut self, region: Region<'a>) {
+    pub fn update(&mut self, region: Region) {
         self.pages = region.pages.as_mut_ptr();
         self.allocmap = region.allocmap.as_mut_ptr();
         self.meta = region.meta.as_mut_ptr();
+        self.meta_cold = region.meta_cold.as_mut_ptr();
+        self.summary = region.summary.as_mut_ptr();
         self.pg_cnt = region.pg_cnt;
         self.lb = region.lb;
         self.ub = region.ub;
     }
 }
 
-pub struct JlRegionArray<'a> {
-    regions: * mut JlRegion<'a>
+pub struct JlRegionArray {
+    regions: * mut JlRegion
 }
 
-impl<'a> JlRegionArray<'a> {
-    pub fn new(regions: * mut JlRegion<'a>) -> Self {
+impl JlRegionArray {
+    pub fn new(regions: * mut JlRegion) -> Self {
         JlRegionArray { regions: regions }
     }
 }
 
-impl<'a> Deref for JlRegionArray<'a> {
-    type Target = [JlRegion<'a>];
+impl Deref for JlRegionArray {
+    type Target = [JlRegion];
 
-    fn deref(&self) -> &[JlRegion<'a>] {
+    fn deref(&self) -> &[JlRegion] {
         unsafe { slice::from_raw_parts(self.regions, REGION_COUNT) }
     }
 }
 
-impl<'a> DerefMut for JlRegionArray<'a> {
-    fn deref_mut(&mut self) -> &mut [JlRegion<'a>] {
+impl DerefMut for JlRegionArray {
+    fn deref_mut(&mut self) -> &mut [JlRegion] {
         unsafe { slice::from_raw_parts_mut(self.regions, REGION_COUNT) }
     }
 }
@@ -968,6 +1080,9 @@ pub unsafe extern fn neptune_init_page_mgr() {
     println!("page offset: {}", GC_PAGE_OFFSET);
 
     PAGE_MGR = Some(Mutex::new(PageMgr::new()));
+    PAGE_FREELIST = Some(ConcurrentStack::new());
+    ZEROED_PAGE_FREELIST = Some(ConcurrentStack::new());
+    PAGE_ZEROER_LOCK = Some(Mutex::new(()));
     REGIONS = Some(Vec::with_capacity(REGION_COUNT));
     let regions = REGIONS.as_mut().unwrap();
     for i in 0..REGION_COUNT {
@@ -977,12 +1092,14 @@ pub unsafe extern fn neptune_init_page_mgr() {
 
 #[no_mangle]
 pub unsafe extern fn neptune_alloc_page<'a>() -> * mut u8 {
+    FFI_PAGE_OPS.fetch_add(1, Ordering::Relaxed);
     // if PAGE_MGR is uninitialized, we're better off crashing anyways
     pg_mgr().alloc_page(&mut REGIONS.as_mut().unwrap()).data.as_mut_ptr()
 }
 
 #[no_mangle]
 pub unsafe extern fn neptune_free_page<'a>(data: * const u8) {
+    FFI_PAGE_OPS.fetch_add(1, Ordering::Relaxed);
     pg_mgr().free_page(REGIONS.as_mut().unwrap().as_mut_slice(), data);
 }
 
@@ -1027,10 +1144,15 @@ pub unsafe extern fn neptune_get_allocmap<'a>(region: &'a mut Region<'a>) -> * m
 }
 
 #[no_mangle]
-pub unsafe extern fn neptune_get_pagemeta<'a>(region: &'a mut Region<'a>) -> * mut PageMeta<'a> {
+pub unsafe extern fn neptune_get_pagemeta<'a>(region: &'a mut Region<'a>) -> * mut PageMeta {
     region.meta.as_mut_ptr()
 }
 
+#[no_mangle]
+pub unsafe extern fn neptune_get_pagemeta_cold<'a>(region: &'a mut Region<'a>) -> * mut PageMetaCold {
+    region.meta_cold.as_mut_ptr()
+}
+
 #[no_mangle]
 pub extern fn neptune_get_lb<'a>(region: &mut Region<'a>) -> u32 {
     region.lb
@@ -1059,39 +1181,315 @@ pub extern fn neptune_get_pgcnt<'a>(region: &mut Region<'a>) -> u32 {
 //------------------------------------------------------------------------------
 // GC entry points
 
+// mirror of neptune_gc_opts_t in julia/src/neptune.h; zero fields fall
+// back to the corresponding NEPTUNE_* environment variables.
+// heap_init/heap_max pace the collection trigger on the C side and are
+// applied in jl_gc_init, they are only carried here.
+#[repr(C)]
+pub struct NeptuneGcOpts {
+    pub numa_policy: c_int,
+    pub nthreads: c_int,
+    pub heap_init: u64,
+    pub heap_max: u64,
+    pub pause_target_ms: c_int,
+    pub page_return: c_int,
+}
+
+// build-time page size of the Rust half; jl_gc_init compares this
+// against GC_PAGE_LG2 so a mismatched pair of builds fails fast
+#[no_mangle]
+pub extern fn neptune_page_lg2() -> c_int {
+    PAGE_LG2 as c_int
+}
+
 #[no_mangle]
-pub extern fn neptune_init_gc() {
+pub extern fn neptune_init_gc(opts: &NeptuneGcOpts, stats: *mut *const NeptuneStats) {
+    // hand the shared stats block to the C side; it aggregates the
+    // per-thread sub-blocks on read (see neptune_stats_t in neptune.h)
+    if !stats.is_null() {
+        unsafe {
+            *stats = &NEPTUNE_STATS;
+        }
+    }
+    // optionally replace the pool size classes with a layout tuned to a
+    // measured allocation histogram (see the exit stats), before
+    // anything derives from the table: the size-to-pool lookup below,
+    // the per-thread pools, codegen's inline allocation paths.
+    // Generated code bakes class indices and strides in, so the same
+    // table must also have been in force for the system image build.
+    match ::std::env::var("NEPTUNE_SIZE_CLASSES") {
+        Ok(ref v) if !v.is_empty() => {
+            match parse_size_classes(v) {
+                Ok(classes) => {
+                    unsafe {
+                        neptune_size_classes = classes;
+                    }
+                    println!("Neptune: loaded tuned size-class table; \
+                              the system image must be built with the same table");
+                }
+                Err(msg) => {
+                    println!("Neptune: ignoring NEPTUNE_SIZE_CLASSES ({})", msg);
+                }
+            }
+        }
+        _ => ()
+    }
+    // size-to-pool table must be ready before the first pool allocation,
+    // on the C side as well (jl_gc_szclass reads it)
+    unsafe {
+        init_szclass_table();
+    }
+    NUMA_POLICY.store(opts.numa_policy, Ordering::Relaxed);
+    // must be stored before the page manager is built, see PageMgr::new
+    PAGE_RETURN_OPT.store(opts.page_return, Ordering::Relaxed);
     unsafe {
         big_objects_marked = Some(Box::new(Mutex::new(Vec::new())));
-        mark_caches = Some(HashMap::new());
+        mark_caches = Some(Mutex::new(Vec::new()));
     }
 
     assert_eq!(mem::size_of::<BigVal>(), 56, "BigVal+TaggedValue should align to 64 bytes!");
-    // create thread pool for parallelizing marking and sweeping
-    let num_threads = match ::std::env::var("NEPTUNE_THREADS").map_err(GcInitError::Env).and_then(|nthreads| {
-        nthreads.parse::<u32>().map_err(GcInitError::Parse)
-    }) {
-        Ok(0) => panic!("Garbage collector cannot work with 0 worker threads! Set NEPTUNE_THREADS to a positive number."),
-        Ok(n) => n,
-        Err(GcInitError::Env(env::VarError::NotPresent)) => 1, // if no environment variable given, assume single_threaded (1)
-        Err(_) => panic!("Expected environment variable NEPTUNE_THREADS to be defined as a positive number.")
+    // create thread pool for parallelizing marking and sweeping;
+    // --gc-threads takes precedence over the environment
+    let num_threads = if opts.nthreads > 0 {
+        opts.nthreads as u32
+    } else {
+        match ::std::env::var("NEPTUNE_THREADS").map_err(GcInitError::Env).and_then(|nthreads| {
+            nthreads.parse::<u32>().map_err(GcInitError::Parse)
+        }) {
+            Ok(0) => panic!("Garbage collector cannot work with 0 worker threads! Set NEPTUNE_THREADS to a positive number."),
+            Ok(n) => n,
+            Err(GcInitError::Env(env::VarError::NotPresent)) => 1, // if no environment variable given, assume single_threaded (1)
+            Err(_) => panic!("Expected environment variable NEPTUNE_THREADS to be defined as a positive number.")
+        }
     };
     println!("Starting neptune with {} threads", num_threads);
     unsafe { np_threads = Some(Pool::new(num_threads)) };
+
+    // allocation-driven lazy sweeping, opt-in
+    match ::std::env::var("NEPTUNE_LAZY_SWEEP") {
+        Ok(ref v) if v != "0" => {
+            LAZY_SWEEP.store(true, Ordering::SeqCst);
+            println!("Neptune: lazy sweeping enabled");
+        }
+        _ => ()
+    }
+
+    // card-table remembered sets, opt-in
+    match ::std::env::var("NEPTUNE_CARD_TABLE") {
+        Ok(ref v) if v != "0" => {
+            CARD_TABLE.store(true, Ordering::SeqCst);
+            println!("Neptune: card-table remembered sets enabled");
+        }
+        _ => ()
+    }
+
+    // per-thread minor collections, opt-in
+    match ::std::env::var("NEPTUNE_LOCAL_MINOR") {
+        Ok(ref v) if v != "0" => {
+            LOCAL_MINOR.store(true, Ordering::SeqCst);
+            println!("Neptune: per-thread minor collections enabled");
+        }
+        _ => ()
+    }
+
+    // generational policy knobs, opt-in
+    match ::std::env::var("NEPTUNE_PROMOTE_AGE").map_err(GcInitError::Env).and_then(|age| {
+        age.parse::<usize>().map_err(GcInitError::Parse)
+    }) {
+        Ok(age) if age <= 3 => {
+            PROMOTE_AGE_CFG.store(age, Ordering::SeqCst);
+            println!("Neptune: promotion age threshold set to {}", age);
+        }
+        Ok(_) => panic!("NEPTUNE_PROMOTE_AGE must be between 0 and 3, the age field is 2 bits."),
+        Err(GcInitError::Env(env::VarError::NotPresent)) => (),
+        Err(_) => panic!("Expected environment variable NEPTUNE_PROMOTE_AGE to be a small number.")
+    }
+
+    match ::std::env::var("NEPTUNE_STICKY_MARKS") {
+        Ok(ref v) if v != "0" => {
+            STICKY_MARKS.store(true, Ordering::SeqCst);
+            println!("Neptune: sticky mark bits enabled, survivors promote immediately");
+        }
+        _ => ()
+    }
+
+    // dormant-task stack scan cache, opt-in
+    match ::std::env::var("NEPTUNE_STACK_CACHE") {
+        Ok(ref v) if v != "0" => {
+            unsafe {
+                TASK_SCAN_CACHE = Some(Mutex::new(HashMap::new()));
+            }
+            STACK_CACHE.store(true, Ordering::SeqCst);
+            println!("Neptune: dormant-task stack scan cache enabled");
+        }
+        _ => ()
+    }
+
+    // transparent hugepages for big objects, opt-in; the value is the
+    // chunk-size threshold in bytes ("1" picks one hugepage), rounded
+    // up to a hugepage multiple so capacity identifies huge chunks
+    match ::std::env::var("NEPTUNE_HUGEPAGES_BIG").map_err(GcInitError::Env).and_then(|sz| {
+        sz.parse::<usize>().map_err(GcInitError::Parse)
+    }) {
+        Ok(sz) if sz > 0 => {
+            let min = ((sz + HUGE_PAGE_SZ - 1) / HUGE_PAGE_SZ) * HUGE_PAGE_SZ;
+            BIG_THP_MIN.store(min, Ordering::SeqCst);
+            println!("Neptune: hugepage-backing big objects of {} bytes and up", min);
+        }
+        Ok(_) | Err(GcInitError::Env(env::VarError::NotPresent)) => (),
+        Err(_) => panic!("Expected environment variable NEPTUNE_HUGEPAGES_BIG to be a size threshold in bytes.")
+    }
+
+    // evacuation-by-attrition for sparse pool pages, opt-in
+    match ::std::env::var("NEPTUNE_EVAC").map_err(GcInitError::Env).and_then(|pct| {
+        pct.parse::<usize>().map_err(GcInitError::Parse)
+    }) {
+        Ok(pct) if pct <= 100 => {
+            EVAC_THRESHOLD.store(pct, Ordering::SeqCst);
+            if pct > 0 {
+                println!("Neptune: condemning pool pages at or below {}% occupancy on full sweeps", pct);
+            }
+        }
+        Ok(_) => panic!("NEPTUNE_EVAC is a page occupancy percentage, it must be between 0 and 100."),
+        Err(GcInitError::Env(env::VarError::NotPresent)) => (),
+        Err(_) => panic!("Expected environment variable NEPTUNE_EVAC to be a percentage.")
+    }
+
+    // adaptive pacing toward a pause-time target, opt-in;
+    // --gc-pause-target takes precedence over the environment
+    if opts.pause_target_ms > 0 {
+        PACE_TARGET_NS.store(opts.pause_target_ms as usize * 1_000_000, Ordering::SeqCst);
+        println!("Neptune: adaptive pacing toward {} ms pauses", opts.pause_target_ms);
+    }
+    else {
+        match ::std::env::var("NEPTUNE_PAUSE_TARGET_MS").map_err(GcInitError::Env).and_then(|ms| {
+            ms.parse::<usize>().map_err(GcInitError::Parse)
+        }) {
+            Ok(ms) if ms > 0 => {
+                PACE_TARGET_NS.store(ms * 1_000_000, Ordering::SeqCst);
+                println!("Neptune: adaptive pacing toward {} ms pauses", ms);
+            }
+            Ok(_) | Err(GcInitError::Env(env::VarError::NotPresent)) => (),
+            Err(_) => panic!("Expected environment variable NEPTUNE_PAUSE_TARGET_MS to be a number of milliseconds.")
+        }
+    }
+
+    // sampling allocation profiler, opt-in
+    match ::std::env::var("NEPTUNE_ALLOC_PROFILE").map_err(GcInitError::Env).and_then(|n| {
+        n.parse::<usize>().map_err(GcInitError::Parse)
+    }) {
+        Ok(n) if n > 0 => {
+            unsafe {
+                ALLOC_PROFILE = Some(Mutex::new(Vec::new()));
+            }
+            ALLOC_PROFILE_EVERY.store(n, Ordering::SeqCst);
+            println!("Neptune: sampling 1 in {} allocations", n);
+        }
+        Ok(_) | Err(GcInitError::Env(env::VarError::NotPresent)) => (),
+        Err(_) => panic!("Expected environment variable NEPTUNE_ALLOC_PROFILE to be a sampling period.")
+    }
+
+    // sampling heap verifier, opt-in
+    match ::std::env::var("NEPTUNE_VERIFY_SAMPLE").map_err(GcInitError::Env).and_then(|n| {
+        n.parse::<usize>().map_err(GcInitError::Parse)
+    }) {
+        Ok(n) if n > 0 => {
+            VERIFY_SAMPLE.store(n, Ordering::SeqCst);
+            unsafe {
+                VERIFY_RNG ^= neptune_hrtime();
+            }
+            println!("Neptune: verifying {} sampled pages and remset entries per collection", n);
+        }
+        Ok(_) | Err(GcInitError::Env(env::VarError::NotPresent)) => (),
+        Err(_) => panic!("Expected environment variable NEPTUNE_VERIFY_SAMPLE to be a sample count.")
+    }
+
+    // per-type heap census on full collections, opt-in
+    match ::std::env::var("NEPTUNE_CENSUS") {
+        Ok(ref v) if v != "0" => {
+            unsafe {
+                CENSUS_ACC = Some(Mutex::new(HashMap::new()));
+                CENSUS_SNAPSHOT = Some(Mutex::new(Vec::new()));
+            }
+            CENSUS.store(true, Ordering::SeqCst);
+            println!("Neptune: per-type census on full collections enabled");
+        }
+        _ => ()
+    }
+
+    // concurrent marking, opt-in
+    match ::std::env::var("NEPTUNE_CONCURRENT_MARK") {
+        Ok(ref v) if v != "0" => {
+            CONCURRENT_MARK.store(true, Ordering::SeqCst);
+            spawn_concurrent_marker();
+            println!("Neptune: concurrent marking enabled");
+        }
+        _ => ()
+    }
+
+    // concurrent big-object/buffer reclamation, opt-in
+    match ::std::env::var("NEPTUNE_CONC_SWEEP") {
+        Ok(ref v) if v != "0" => {
+            CONCURRENT_SWEEP.store(true, Ordering::SeqCst);
+            spawn_background_reclaimer();
+            println!("Neptune: concurrent big-object and buffer reclamation enabled");
+        }
+        _ => ()
+    }
+
+    // background page zeroing, opt-in
+    match ::std::env::var("NEPTUNE_ZERO_PAGES") {
+        Ok(ref v) if v != "0" => {
+            let ret = PAGE_RETURN_OPT.load(Ordering::Relaxed);
+            let lazy = ret == PAGES_LAZY ||
+                (ret == PAGES_DEFAULT &&
+                 ::std::env::var("NEPTUNE_LAZY_DECOMMIT").map(|v| v != "0").unwrap_or(false));
+            if lazy {
+                // zeroing a MADV_FREE'd page recommits it, defeating lazy decommit
+                println!("Neptune: NEPTUNE_ZERO_PAGES ignored under lazy decommit");
+            } else {
+                spawn_background_zeroer();
+                println!("Neptune: background page zeroing enabled");
+            }
+        }
+        _ => ()
+    }
+
+    // binary ring-buffer event tracing, opt-in
+    match ::std::env::var("NEPTUNE_TRACE") {
+        Ok(ref path) if !path.is_empty() => {
+            init_trace(path);
+            println!("Neptune: tracing GC events to {}", path);
+        }
+        _ => ()
+    }
+
+    // cgroup memory-pressure listener; on by default and inert when
+    // no cgroup memory controller is visible
+    match ::std::env::var("NEPTUNE_PRESSURE") {
+        Ok(ref v) if v == "0" => (),
+        _ => spawn_pressure_listener(),
+    }
+
+    // background thread for native (C-pointer) finalizers
+    spawn_native_finalizer_thread();
 }
 
 #[no_mangle]
 pub extern fn neptune_alloc<'gc, 'a>(gc: &'gc mut Gc2<'a>, size: usize, typ: * const libc::c_void) -> &'gc mut JlValue {
+    gc.ffi_alloc_slow += 1;
     gc.alloc(size, typ)
 }
 
 #[no_mangle]
 pub extern fn neptune_pool_alloc<'gc, 'a>(gc: &'gc mut Gc2<'a>, size: usize) -> &'gc mut JlValue {
+    gc.ffi_alloc_slow += 1;
     gc.pool_alloc(size)
 }
 
 #[no_mangle]
 pub extern fn neptune_big_alloc<'gc, 'a>(gc: &'gc mut Gc2<'a>, size: usize) -> &'gc mut JlValue {
+    gc.ffi_alloc_slow += 1;
     gc.big_alloc(size)
 }
 
@@ -1107,9 +1505,46 @@ pub extern fn neptune_gc_collect<'gc, 'a>(gc: &'gc mut Gc2<'a>, full: c_int) ->
     gc.collect(full != 0) as c_int
 }
 
+//------------------------------------------------------------------------------
+// Concurrent marking (NEPTUNE_CONCURRENT_MARK)
+
+// Nonzero while the concurrent marker may be running; read by the
+// write barrier in julia.h to decide whether stores need shading.
+#[no_mangle]
+pub static mut neptune_mark_active: u8 = 0;
+
+#[no_mangle]
+pub extern fn neptune_concurrent_mark_enabled() -> c_int {
+    CONCURRENT_MARK.load(Ordering::Relaxed) as c_int
+}
+
+// Where the in-flight concurrent cycle is: 0 idle, 1 marking, 2 done
+// marking and waiting for the final pause.
+#[no_mangle]
+pub extern fn neptune_gc_concurrent_state() -> c_int {
+    CONC_STATE.load(Ordering::SeqCst) as c_int
+}
+
+#[no_mangle]
+pub extern fn neptune_gc_mark_initial<'gc, 'a>(gc: &'gc mut Gc2<'a>) {
+    gc.concurrent_mark_initial();
+}
+
+#[no_mangle]
+pub extern fn neptune_gc_collect_final<'gc, 'a>(gc: &'gc mut Gc2<'a>) -> c_int {
+    gc.concurrent_mark_final() as c_int
+}
+
+#[no_mangle]
+pub extern fn neptune_shade<'gc, 'a>(gc: &'gc mut Gc2<'a>, v: * mut JlValue) {
+    gc.ffi_queue_root += 1;
+    gc.shade(v);
+}
+
 // Tracking malloc'd data
 #[no_mangle]
 pub unsafe extern fn jl_gc_track_malloced_array(tls: &'static mut JlTLS, a: * mut JlArray) {
+    (*tls.tl_gcs).ffi_remset_sync += 1;
     (*tls.tl_gcs).track_malloced_array(a);
 }
 
@@ -1118,40 +1553,70 @@ pub extern fn neptune_visit_mark_stack(gc: &mut Gc2) {
     gc.marking.visit_mark_stack();
 }
 
+/// Mark every thread's locals and then the global roots in one FFI
+/// crossing; the per-thread loop used to live on the C side and cost a
+/// call per thread.
 #[no_mangle]
-pub extern fn neptune_mark_roots(gc: &mut Gc2) {
+pub extern fn neptune_mark_all_roots(gc: &mut Gc2) {
+    for t in unsafe { get_all_tls() } {
+        let tl_gc = unsafe { &mut * t.tl_gcs };
+        gc.marking.mark_thread_local(tl_gc);
+    }
     gc.marking.mark_roots();
 }
 
 #[no_mangle]
-pub extern fn neptune_mark_thread_local(gc: &mut Gc2, gc2: &mut Gc2) {
-    gc.marking.mark_thread_local(gc2);
+pub extern fn neptune_setmark_buf(gc: &mut Gc2, o: * mut JlValue, mark_mode: u8, minsz: usize) {
+    gc.ffi_remset_sync += 1;
+    gc.cache.setmark_buf(o, mark_mode, minsz);
 }
 
+/// Run the allocator hot-path microbenchmarks (neptune/src/bench.rs)
+/// against thread 0's collector; call from the main thread only.
 #[no_mangle]
-pub extern fn neptune_setmark_buf(gc: &mut Gc2, o: * mut JlValue, mark_mode: u8, minsz: usize) {
-    gc.cache.setmark_buf(o, mark_mode, minsz);
+pub extern fn neptune_microbench() {
+    let gc = unsafe { &mut *get_all_tls()[0].tl_gcs };
+    ::bench::run_microbench(gc);
 }
 
 #[no_mangle]
 pub extern fn neptune_exit_hook() {
+    // pause-time distributions and pool occupancy; silent if no
+    // collection ever ran
+    print_exit_stats();
+    // heaviest allocation sites, when NEPTUNE_ALLOC_PROFILE sampled any
+    print_alloc_profile();
+    // dump per-thread time-to-safepoint histograms; silent if no
+    // collection ever stopped the world
+    unsafe {
+        jl_safepoint_print_tts();
+    }
 }
 
 //----------------------------------------------------------------------------------
 // Write barrier entry points
 #[no_mangle]
 pub extern fn neptune_queue_root(gc: &mut Gc2, root: &mut JlValue) {
+    gc.ffi_queue_root += 1;
     gc.queue_root(root);
 }
 
+#[no_mangle]
+pub unsafe extern fn neptune_queue_roots(gc: &mut Gc2, roots: * const * mut JlValue, n: usize) {
+    gc.ffi_queue_root += 1;
+    gc.queue_logged_roots(::std::slice::from_raw_parts(roots, n));
+}
+
 #[no_mangle]
 pub extern fn neptune_queue_binding<'a>(gc: &mut Gc2<'a>, binding: &'a mut JlBinding<'a>) {
+    gc.ffi_queue_root += 1;
     gc.queue_binding(binding);
 }
 
 #[no_mangle]
 pub unsafe extern fn jl_gc_setmark(tls: &mut JlTLS, v: * mut JlValue) {
     let gc = &mut *tls.tl_gcs;
+    gc.ffi_queue_root += 1;
     gc.mark_concurrently(v);
 }
 
@@ -1160,28 +1625,132 @@ pub unsafe extern fn jl_gc_setmark(tls: &mut JlTLS, v: * mut JlValue) {
 
 #[no_mangle]
 pub extern fn neptune_push_weakref(gc: &mut Gc2, wr: &mut WeakRef) {
+    gc.ffi_remset_sync += 1;
     gc.push_weakref(wr);
 }
 
 #[no_mangle]
 pub unsafe extern fn neptune_push_big_object<'a>(gc: &mut Gc2<'a>, b: &'a mut BigVal) {
+    gc.ffi_remset_sync += 1;
     gc.heap.big_objects.push(b);
 }
 
+// called by ctx_switch (task.c) for the task about to run, so the
+// stack scan cache never replays a stack that has since mutated
+#[no_mangle]
+pub extern fn neptune_task_dirty(ta: * mut JlTask) {
+    task_stack_dirty(ta as usize);
+}
+
 //----------------------------------------------------------------------------------
 // Access to stats for gc_time
+// (remset numbers now live in the shared stats block handed over at
+// neptune_init_gc; no per-thread FFI getters remain)
+
+/// Number of distinct types in the per-type census of the last full
+/// collection (NEPTUNE_CENSUS); 0 when the census is disabled or no
+/// full sweep has completed yet.
 #[no_mangle]
-pub unsafe extern fn neptune_remset_len_(gc: &mut Gc2, last_remset: u8) -> usize {
-    if last_remset != 0 {
-        gc.heap.last_remset.len()
-    } else {
-        gc.heap.remset.len()
+pub extern fn neptune_census_len() -> usize {
+    match unsafe { CENSUS_SNAPSHOT.as_ref() } {
+        Some(snap) => snap.lock().unwrap().len(),
+        None => 0,
+    }
+}
+
+/// Copy out the i-th census entry; entries are ordered heaviest
+/// first. Returns 1 on success, 0 when i is out of range.
+#[no_mangle]
+pub extern fn neptune_census_entry(i: usize,
+                                   typ: * mut * const JlValue,
+                                   count: * mut usize,
+                                   bytes: * mut usize) -> c_int {
+    let snap = match unsafe { CENSUS_SNAPSHOT.as_ref() } {
+        Some(snap) => snap.lock().unwrap(),
+        None => return 0,
+    };
+    match snap.get(i) {
+        Some(&(t, c, b)) => {
+            unsafe {
+                *typ = t as * const JlValue;
+                *count = c;
+                *bytes = b;
+            }
+            1
+        }
+        None => 0,
+    }
+}
+
+/// Bytes allocated since the last collection that still sit in the
+/// per-thread pacing counters and have not been folded into
+/// gc_num.allocd yet; the C side adds this on stats reads
+/// (jl_gc_total_bytes and friends) so totals stay exact between
+/// pauses. Each counter idles one collect interval in the red, hence
+/// the correction.
+#[no_mangle]
+pub extern fn neptune_pending_allocd() -> i64 {
+    let mut pending: i64 = 0;
+    unsafe {
+        for t in get_all_tls() {
+            if ! t.tl_gcs.is_null() {
+                pending += (&*t.tl_gcs).num_allocd + gc_num.interval as i64;
+            }
+        }
+    }
+    pending
+}
+
+/// Like neptune_pending_allocd, but also re-arms the per-thread
+/// counters so the bytes are not folded a second time at the next
+/// pause. Used where the C side parks pending allocation into
+/// gc_num.deferred_alloc (GC disabled, concurrent-marking pauses) or
+/// absorbs it into the live estimate (jl_gc_reset_alloc_count).
+#[no_mangle]
+pub extern fn neptune_take_pending_allocd() -> i64 {
+    let mut pending: i64 = 0;
+    unsafe {
+        for t in get_all_tls() {
+            if ! t.tl_gcs.is_null() {
+                let g = &mut * t.tl_gcs;
+                pending += g.num_allocd + gc_num.interval as i64;
+                g.num_allocd = - (gc_num.interval as i64);
+            }
+        }
     }
+    pending
 }
 
+/// Longest stop-the-world pause observed so far, in nanoseconds.
 #[no_mangle]
-pub unsafe extern fn neptune_remset_nptr(gc: &mut Gc2) -> usize {
-    gc.heap.remset_nptr
+pub extern fn neptune_pause_max_ns() -> u64 {
+    total_pause_max_ns()
+}
+
+/// Make the next full collection's sweep MADV_FREE parked pages, as
+/// the cgroup pressure path does; called by the C side when the hard
+/// heap limit (--gc-heap-limit) escalates to its last resort.
+#[no_mangle]
+pub extern fn neptune_request_page_return() {
+    PRESSURE_RETURN.store(true, Ordering::SeqCst);
+}
+
+/// Pool pages currently allocated, for the seqlock-published stats
+/// block on the C side (jl_gc_stats_pub in julia/src/gc.h).
+#[no_mangle]
+pub extern fn neptune_current_pg_count() -> usize {
+    pg_mgr().current_pg_count.load(Ordering::Relaxed)
+}
+
+// Bytes the last sweep found live in each generation (old != 0 for
+// the old generation).
+#[no_mangle]
+pub extern fn neptune_gen_occupancy(old: c_int) -> usize {
+    if old != 0 {
+        OLD_OCCUPANCY.load(Ordering::Relaxed)
+    } else {
+        YOUNG_OCCUPANCY.load(Ordering::Relaxed)
+    }
 }
 
 //------------------------------------------------------------------------------
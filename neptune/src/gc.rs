@@ -18,8 +18,28 @@ pub enum GcInitError {
 // max. # of regions
 pub const REGION_COUNT: usize = 32768; // 2^48 / 8G
 
-pub const PAGE_LG2: usize = 14; // log_2(PAGE_SZ)
-pub const PAGE_SZ: usize = 1 << PAGE_LG2; // 16k
+// log_2(PAGE_SZ); build-time selectable for large-page experiments
+// (keep in sync with GC_PAGE_LG2 in julia/src/gc.h: the page_64k and
+// page_256k features correspond to -DGC_PAGE_LG2=16 and 18, and
+// jl_gc_init cross-checks the two halves at startup)
+#[cfg(feature = "page_256k")]
+pub const PAGE_LG2: usize = 18;
+#[cfg(all(feature = "page_64k", not(feature = "page_256k")))]
+pub const PAGE_LG2: usize = 16;
+#[cfg(not(any(feature = "page_64k", feature = "page_256k")))]
+pub const PAGE_LG2: usize = 14;
+pub const PAGE_SZ: usize = 1 << PAGE_LG2;
+
+// in-page offsets stored in page metadata; 16 bits cover pages up to
+// 64k (keep in sync with jl_gc_pgoff_t in julia/src/gc.h)
+#[cfg(feature = "page_256k")]
+pub type PgOff = u32;
+#[cfg(not(feature = "page_256k"))]
+pub type PgOff = u16;
+
+// card granularity for the card-table remembered-set mode
+pub const CARD_LG2: usize = 9; // log_2(CARD_SZ)
+pub const CARD_SZ: usize = 1 << CARD_LG2; // 512 bytes
 
 // can we just use Rust threading instead of mutexes for these?
 // static jl_mutex_t finalizers_lock;
@@ -41,7 +61,19 @@ pub struct GcNum {
     pub since_sweep:    u64,
     pub interval:       usize,
     pub pause:          c_int,
-    pub full_sweep:     c_int
+    pub full_sweep:     c_int,
+    // extensions over stock Julia, mirrored in julia/src/gc.h and
+    // base/util.jl; appended so the stock field offsets stay put
+    pub mark_rate:      u64, // bytes marked per second, last cycle
+    pub pages_swept:    u64, // pool pages visited by the sweep
+    pub promoted:       u64, // bytes promoted to the old generation
+    pub barriers:       u64, // write barrier (queue_root) activations
+    pub pause_p50:      u64, // pause-time percentile estimates, ns
+    pub pause_p90:      u64,
+    pub pause_p99:      u64,
+    pub arr_grows:      u64, // array buffer enlargements (jl_array_grow_*)
+    pub arr_copied:     u64, // bytes moved servicing those enlargements
+    pub big_hugepage_bytes: u64, // big-object bytes on hugepage-advised chunks
 }
 
 impl GcNum {
@@ -61,6 +93,16 @@ impl GcNum {
             interval:       0,
             pause:          0,
             full_sweep:     0,
+            mark_rate:      0,
+            pages_swept:    0,
+            promoted:       0,
+            barriers:       0,
+            pause_p50:      0,
+            pause_p90:      0,
+            pause_p99:      0,
+            arr_grows:      0,
+            arr_copied:     0,
+            big_hugepage_bytes: 0,
         }
     }
 }
@@ -70,24 +112,56 @@ impl GcNum {
 pub struct Region<'a> {
     pub pages: &'a mut [Page],
     pub allocmap: &'a mut [u32],
-    pub meta: &'a mut [PageMeta<'a>],
+    pub meta: &'a mut [PageMeta],
+    // cold half of the page metadata, parallel to `meta`
+    pub meta_cold: &'a mut [PageMetaCold],
+    // second level of the free-page index: one bit per allocmap word,
+    // set by the page manager once the word is completely allocated
+    pub summary: &'a mut [u32],
     pub pg_cnt: c_uint,
     pub lb: c_uint,
-    pub ub: c_uint
+    pub ub: c_uint,
+    // one byte per CARD_SZ bytes of page data, dirtied by the write
+    // barrier in card-table mode (NEPTUNE_CARD_TABLE). Empty otherwise.
+    // The C side treats region_t as opaque, so this is Rust-only.
+    pub cards: Vec<AtomicU8>,
+    // raw mmap ranges backing the region's arrays, recorded so
+    // PageMgr::release_region can hand them back to the OS
+    pub mappings: Vec<(* mut u8, usize)>,
+    // consecutive full collections this region has spent with every
+    // allocated page parked on the freelist (see shrink_idle_regions)
+    pub idle_gens: u32,
 }
 
+// the raw mapping pointers keep Region from being Send; they are only
+// read by release_region inside the pause, so sweep workers may carry
+// regions across threads as before
+unsafe impl<'a> Send for Region<'a> {}
+
 impl<'a> Region<'a> {
     pub fn new() -> Region<'a> {
         Region {
             pages: &mut [],
             allocmap: &mut [],
             meta: &mut [],
+            meta_cold: &mut [],
+            summary: &mut [],
             pg_cnt: 0,
             lb: 0,
             ub: 0,
+            cards: Vec::new(),
+            mappings: Vec::new(),
+            idle_gens: 0,
         }
     }
 
+    /// Dirty the card covering the given address. The address must be
+    /// inside this region.
+    pub fn dirty_card(&self, data: * const u8) {
+        let offset = data as usize - self.pages.as_ptr() as usize;
+        self.cards[offset >> CARD_LG2].store(1, Ordering::Relaxed);
+    }
+
     pub fn index_of(&self, page: &Page) -> Option<usize> {
         self.index_of_raw(page.data.as_ptr())
     }
@@ -189,6 +263,24 @@ impl BigVal {
         unsafe { mem::transmute(ptr.offset(1)) }
     }
 
+    /// Allocated capacity of this chunk in bytes (including headers).
+    /// We repurpose the otherwise-unused `prev` field for this, so
+    /// chunks recycled through the big-object cache remember how much
+    /// memory actually backs them.
+    #[inline(always)]
+    pub fn capacity(&self) -> usize {
+        if self.prev == 0 {
+            self.allocd_size()
+        } else {
+            self.prev
+        }
+    }
+
+    #[inline(always)]
+    pub fn set_capacity(&mut self, cap: usize) {
+        self.prev = cap;
+    }
+
     #[inline(always)]
     pub fn size(&self) -> usize {
         self.sz_or_age.get_bits(2..64) << 2
@@ -211,11 +303,13 @@ impl BigVal {
         self.sz_or_age.set_bits(0..2, age);
     }
 
-    /// Increment age while saturating it when it reaches the promotion age
+    /// Increment age, saturating at what the 2-bit field can hold so
+    /// configurable promotion thresholds (PROMOTE_AGE_CFG) up to 3
+    /// stay reachable
     #[inline(always)]
     pub fn inc_age(&mut self) {
         let age = self.sz_or_age.get_bits(0..2);
-        if age < PROMOTE_AGE {
+        if age < 3 {
             self.sz_or_age.set_bits(0..2, age + 1);
         }
     }
@@ -229,18 +323,11 @@ impl BigVal {
     }
 }
 
-// list of malloc'd arrays
+// mirror of the C-side mallocarray_t chain node (julia/src/gc.h); the
+// Rust collector tracks malloc'd arrays in a dense vector instead, so
+// this only types the legacy pointers left in JlThreadHeap
 #[repr(C)]
 pub struct MallocArray {
     pub a:* mut JlArray,
-    pub next: Option<Box<MallocArray>>
-}
-
-impl MallocArray {
-    pub fn new(a:* mut JlArray) -> Self {
-        MallocArray {
-            a: a,
-            next: None,
-        }
-    }
+    pub next:* mut MallocArray
 }
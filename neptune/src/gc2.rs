@@ -14,20 +14,862 @@ use util::*;
 use std::env;
 use std::cmp;
 use concurrency::*;
+use trace::*;
 use scoped_threadpool::Pool;
 use crossbeam::sync::*;
 use std::thread;
+use std::time::Duration;
+use std::fs::File;
+use std::io::Read;
+use std::cell::Cell;
 use std::collections::HashMap;
+use std::collections::VecDeque;
 
 type BitVec = Vec<AtomicBool>;
 
-const PARALLEL_SWEEP: bool = false;
+const PARALLEL_SWEEP: bool = true;
+
+// Allocation-driven lazy sweeping, enabled with NEPTUNE_LAZY_SWEEP.
+// When on, the pause only queues pages as needing a sweep and
+// `pool_alloc` sweeps them on demand, so pause time is bounded by mark
+// work instead of heap size.
+pub static LAZY_SWEEP: AtomicBool = AtomicBool::new(false);
+// whether the sweep pending on the queued pages is a full sweep
+static LAZY_SWEEP_FULL: AtomicBool = AtomicBool::new(false);
+
+// Card-table remembered sets, enabled with NEPTUNE_CARD_TABLE. When
+// on, the write barrier dirties one byte per card in the object's
+// region instead of growing the per-thread remset vectors; the pause
+// expands the dirty cards back into the remsets before premark.
+// Memory spent on remembering mutations is then bounded by heap size
+// rather than by mutation count.
+pub static CARD_TABLE: AtomicBool = AtomicBool::new(false);
+
+// Background execution of native (C-pointer) finalizers, which never
+// touch the Julia runtime. Discovery stays inside the pause; the
+// calls themselves run on a dedicated thread fed by a bounded queue.
+const NATIVE_FINALIZER_QUEUE_SZ: usize = 4096;
+// sender half of the queue; only the collecting thread touches it
+static mut NATIVE_FINALIZER_TX: Option<mpsc::SyncSender<(usize, usize)>> = None;
+// (object, finalizer) pairs discovered this cycle, waiting to be
+// handed to the background thread at the end of the mark phase
+static mut NATIVE_TO_FINALIZE: Option<Vec<(usize, usize)>> = None;
+// finalizers handed to the background thread but not yet run
+static NATIVE_FINALIZERS_PENDING: AtomicUsize = AtomicUsize::new(0);
+
+// Per-thread minor collections, enabled with NEPTUNE_LOCAL_MINOR.
+// Quicksweeps then only sweep the collecting thread's own pages
+// inside the pause; every other thread's young pages are queued on
+// their owner's lazy lists (the NEPTUNE_LAZY_SWEEP machinery) and get
+// swept by that thread on its own allocation path once the world
+// restarts. Marking stays global -- a running thread's stack can hold
+// the only reference to another thread's young object and there is no
+// stack barrier to catch that -- so the rendezvous remains, but the
+// pause stops scaling with the other threads' heaps.
+pub static LOCAL_MINOR: AtomicBool = AtomicBool::new(false);
+
+// Generational policy knobs. NEPTUNE_PROMOTE_AGE picks how many
+// sweeps an object must survive before promotion (bigvals honor the
+// full 2-bit range; pool objects carry a 1-bit age, so thresholds
+// above 1 behave like 1 there). NEPTUNE_STICKY_MARKS promotes every
+// marked survivor of a quicksweep instead of aging it through
+// GC_CLEAN, trading promotion precision for cheaper minors.
+pub static PROMOTE_AGE_CFG: AtomicUsize = AtomicUsize::new(PROMOTE_AGE);
+pub static STICKY_MARKS: AtomicBool = AtomicBool::new(false);
+
+// Dormant-task stack scan cache, enabled with NEPTUNE_STACK_CACHE.
+// A suspended task's stack cannot change until the task is switched
+// in again, so the roots its gcframe walk found last time are still
+// exactly its roots now. Quick collections replay that recorded root
+// set instead of re-walking the frames, which matters for services
+// parking tasks with very deep stacks. The cache maps task address ->
+// recorded roots; ctx_switch (task.c) calls neptune_task_dirty for
+// the incoming task, dropping its entry before its stack can mutate,
+// and full collections drop the whole table since they rescan and
+// re-record everything anyway. The running task of each thread always
+// takes the real stack walk.
+pub static STACK_CACHE: AtomicBool = AtomicBool::new(false);
+pub static mut TASK_SCAN_CACHE: Option<Mutex<HashMap<usize, Vec<usize>>>> = None;
+
+/// Drop a task's recorded stack roots; it is about to run and its
+/// stack is no longer what the recording saw.
+pub fn task_stack_dirty(ta: usize) {
+    if ! STACK_CACHE.load(Ordering::Relaxed) {
+        return;
+    }
+    unsafe {
+        if let Some(ref m) = TASK_SCAN_CACHE {
+            m.lock().unwrap().remove(&ta);
+        }
+    }
+}
+
+/// Full collections rescan every stack, so recordings restart from
+/// scratch; this also purges entries of tasks that died since.
+fn task_stack_cache_clear() {
+    unsafe {
+        if let Some(ref m) = TASK_SCAN_CACHE {
+            m.lock().unwrap().clear();
+        }
+    }
+}
+
+// Evacuation-by-attrition for sparse pool pages, set from NEPTUNE_EVAC
+// (a page occupancy percentage; 0 disables). The runtime cannot move
+// pool objects - object identity hashes their address and C code holds
+// raw pointers across safepoints - so full sweeps instead condemn any
+// page whose live fraction is at or below the threshold: its free
+// cells are withheld from the freelists, nothing new can land on it,
+// and once the stragglers die the whole page goes back to the page
+// manager instead of pinning RSS half empty. Condemnation is sticky
+// until the next full sweep for free: the full sweep promotes the
+// survivors, so quick sweeps skip the page and never repopulate its
+// freelist entries.
+pub static EVAC_THRESHOLD: AtomicUsize = AtomicUsize::new(0);
+// pages condemned / cells withheld by the last full sweep, for the
+// page stats
+pub static EVAC_CONDEMNED: AtomicUsize = AtomicUsize::new(0);
+pub static EVAC_WITHHELD: AtomicUsize = AtomicUsize::new(0);
+// bytes the last sweep found live in each generation, for
+// neptune_gen_occupancy; written with fetch_add since pool sweeping
+// is sharded across workers
+pub static YOUNG_OCCUPANCY: AtomicUsize = AtomicUsize::new(0);
+pub static OLD_OCCUPANCY: AtomicUsize = AtomicUsize::new(0);
+
+// Adaptive collection pacing, enabled by setting NEPTUNE_PAUSE_TARGET_MS
+// to a pause-time target. The pacer keeps moving averages of pause
+// duration, allocation rate and young-object survival and steers the
+// allocation interval (gc_num.interval, which maybe_collect triggers
+// on) toward the target instead of relying on the hand-tuned static
+// value. 0 means pacing is off.
+pub static PACE_TARGET_NS: AtomicUsize = AtomicUsize::new(0);
+static PAUSE_EWMA_NS: AtomicUsize = AtomicUsize::new(0);
+static SURVIVAL_EWMA_PCT: AtomicUsize = AtomicUsize::new(0);
+static ALLOC_RATE_EWMA: AtomicUsize = AtomicUsize::new(0); // bytes/sec
+// set when the survival average says quick sweeps stopped paying off;
+// consumed by the next sweep decision
+static PACE_WANTS_FULL: AtomicBool = AtomicBool::new(false);
+// when the previous cycle's final pause ended, for the allocation rate
+static mut LAST_GC_END: u64 = 0;
+// how long the current cycle's mark phase took, for the mark
+// throughput reported in gc_num
+static mut LAST_MARK_NS: u64 = 0;
+
+// Sampling allocation profiler, enabled with NEPTUNE_ALLOC_PROFILE=N:
+// every Nth allocation through pool_alloc/big_alloc is recorded with
+// its size, the type the caller tags it with and a native backtrace
+// (the same unwinder the signal-based profiler uses), and the exit
+// hook prints call sites aggregated by backtrace, heaviest first.
+const ALLOC_PROFILE_MAX_FRAMES: usize = 32;
+pub static ALLOC_PROFILE_EVERY: AtomicUsize = AtomicUsize::new(0);
+static ALLOC_PROFILE_TICK: AtomicUsize = AtomicUsize::new(0);
+// the most recent sample's object, so `alloc` can fill in the type it
+// writes into the header right after the allocator returns
+static LAST_SAMPLE_ADDR: AtomicUsize = AtomicUsize::new(0);
+
+pub struct AllocSample {
+    pub size: usize,
+    pub typ: usize, // jl_datatype_t*, 0 if the caller never told us
+    pub addr: usize,
+    pub frames: Vec<usize>,
+}
+
+pub static mut ALLOC_PROFILE: Option<Mutex<Vec<AllocSample>>> = None;
+
+/// Aggregate the allocation samples by backtrace and print the
+/// heaviest call sites, symbolized frame by frame.
+pub fn print_alloc_profile() {
+    let samples = match unsafe { ALLOC_PROFILE.as_ref() } {
+        Some(profile) => profile.lock().unwrap(),
+        None => return,
+    };
+    if samples.is_empty() {
+        return;
+    }
+    let every = ALLOC_PROFILE_EVERY.load(Ordering::Relaxed);
+    // (count, bytes, example type) per distinct backtrace
+    let mut sites: HashMap<&[usize], (usize, usize, usize)> = HashMap::new();
+    for s in samples.iter() {
+        let site = sites.entry(&s.frames[..]).or_insert((0, 0, s.typ));
+        site.0 += 1;
+        site.1 += s.size;
+        if site.2 == 0 {
+            site.2 = s.typ;
+        }
+    }
+    let mut sorted: Vec<(&[usize], (usize, usize, usize))> =
+        sites.into_iter().collect();
+    sorted.sort_by(|a, b| (b.1).1.cmp(&(a.1).1));
+    println!("allocation profile ({} samples, 1 in {} allocations):",
+             samples.len(), every);
+    for &(frames, (count, bytes, typ)) in sorted.iter().take(20) {
+        println!("  {} samples, {} kB sampled, type {:#x}:",
+                 count, bytes / 1024, typ);
+        for &ip in frames.iter().take(10) {
+            unsafe {
+                // prints "fun at file:line" for the frame
+                jl_gdblookup(ip - 1);
+            }
+        }
+    }
+}
+
+// Pause-time histograms. Every collection records its mark phase, its
+// sweep phase and the whole pause; neptune_exit_hook prints the
+// distributions (p50/p99/p99.9/max) and the per-pool page occupancy
+// when the process exits, as JSON when NEPTUNE_STATS_JSON is set.
+// Buckets are powers of two of nanoseconds split into four linear
+// sub-buckets (HDR-style), which keeps the value error under ~25%.
+const HIST_SUB_BITS: usize = 2;
+const HIST_BUCKETS: usize = ((64 - HIST_SUB_BITS) << HIST_SUB_BITS) + (1 << HIST_SUB_BITS);
+
+pub struct PauseHist {
+    counts: [usize; HIST_BUCKETS],
+    total: usize,
+    max_ns: u64,
+}
+
+impl PauseHist {
+    fn bucket(ns: u64) -> usize {
+        let sub = 1 << HIST_SUB_BITS;
+        if ns < sub as u64 {
+            return ns as usize;
+        }
+        let exp = 63 - ns.leading_zeros() as usize;
+        let low = ((ns >> (exp - HIST_SUB_BITS)) as usize) & (sub - 1);
+        cmp::min(((exp - HIST_SUB_BITS + 1) << HIST_SUB_BITS) | low, HIST_BUCKETS - 1)
+    }
+
+    /// lower bound of the values a bucket covers
+    fn bucket_value(idx: usize) -> u64 {
+        if idx < (1 << HIST_SUB_BITS) {
+            return idx as u64;
+        }
+        let exp = (idx >> HIST_SUB_BITS) + HIST_SUB_BITS - 1;
+        let sub = (idx & ((1 << HIST_SUB_BITS) - 1)) as u64;
+        (1 << exp) + (sub << (exp - HIST_SUB_BITS))
+    }
+
+    fn record(&mut self, ns: u64) {
+        self.counts[PauseHist::bucket(ns)] += 1;
+        self.total += 1;
+        if ns > self.max_ns {
+            self.max_ns = ns;
+        }
+    }
+
+    /// value below which num/den of the recorded samples fall
+    fn percentile(&self, num: usize, den: usize) -> u64 {
+        let rank = (self.total * num + den - 1) / den;
+        let mut seen = 0;
+        for (i, &c) in self.counts.iter().enumerate() {
+            seen += c;
+            if c > 0 && seen >= rank {
+                return PauseHist::bucket_value(i);
+            }
+        }
+        self.max_ns
+    }
+}
+
+// only the collecting thread records, with the world stopped, so
+// plain statics are fine here
+static mut MARK_PAUSE_HIST: PauseHist =
+    PauseHist { counts: [0; HIST_BUCKETS], total: 0, max_ns: 0 };
+static mut SWEEP_PAUSE_HIST: PauseHist =
+    PauseHist { counts: [0; HIST_BUCKETS], total: 0, max_ns: 0 };
+static mut TOTAL_PAUSE_HIST: PauseHist =
+    PauseHist { counts: [0; HIST_BUCKETS], total: 0, max_ns: 0 };
+
+// Per-type heap census, enabled with NEPTUNE_CENSUS. The sweep of a
+// full collection already reads every surviving object's header, so
+// it additionally charges each survivor to its datatype tag; the
+// result of the last completed full sweep is queryable through
+// neptune_census_len/neptune_census_entry (julia/src/neptune.h).
+// Under NEPTUNE_LAZY_SWEEP pages swept on demand are charged to the
+// next snapshot instead, so the census is approximate there.
+pub static CENSUS: AtomicBool = AtomicBool::new(false);
+// working accumulator the sweep workers merge into, page at a time
+pub static mut CENSUS_ACC: Option<Mutex<HashMap<usize, (usize, usize)>>> = None;
+// (type tag, objects, bytes) of the last full sweep, heaviest first
+pub static mut CENSUS_SNAPSHOT: Option<Mutex<Vec<(usize, usize, usize)>>> = None;
+
+// Shared GC statistics block. This is the single home for the numbers
+// that used to be double-booked between C and Rust: C receives a
+// pointer to it once at neptune_init_gc and aggregates the per-thread
+// sub-blocks on read, instead of calling back over FFI per thread.
+// (keep in sync with neptune_stats_t in julia/src/neptune.h)
+pub const STATS_MAX_THREADS: usize = 256;
+
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct GcTlStats {
+    pub remset_len: usize,      // entries in the thread's remset
+    pub last_remset_len: usize, // entries in the previous cycle's remset
+    pub remset_nptr: usize,     // pointers behind those entries
+    // FFI-crossing counters (see the ffi_* fields on Gc2), snapshotted
+    // at the same pause points as the remset numbers
+    pub ffi_queue_root: u64,    // write-barrier crossings
+    pub ffi_alloc_slow: u64,    // allocation slow-path crossings
+    pub ffi_remset_sync: u64,   // mark/remset bookkeeping crossings
+}
+
+#[repr(C)]
+pub struct NeptuneStats {
+    pub nthreads: usize, // occupied sub-blocks
+    pub tl: [GcTlStats; STATS_MAX_THREADS],
+    pub ffi_page_ops: u64, // page-manager crossings (no thread context)
+    // pool allocation counts by request size in 16-byte buckets,
+    // summed over threads; the raw input for tuning the size-class
+    // table (NEPTUNE_SIZE_CLASSES)
+    pub alloc_hist: [u64; SZCLASS_TABLE_LEN],
+}
+
+pub static mut NEPTUNE_STATS: NeptuneStats = NeptuneStats {
+    nthreads: 0,
+    tl: [GcTlStats { remset_len: 0, last_remset_len: 0, remset_nptr: 0,
+                     ffi_queue_root: 0, ffi_alloc_slow: 0, ffi_remset_sync: 0 };
+         STATS_MAX_THREADS],
+    ffi_page_ops: 0,
+    alloc_hist: [0; SZCLASS_TABLE_LEN],
+};
+
+// page-manager crossings from the gc-pages.c shims, which carry no
+// thread context; relaxed because only the magnitude matters
+pub static FFI_PAGE_OPS: AtomicUsize = AtomicUsize::new(0);
+
+// Sampling heap verifier, enabled with NEPTUNE_VERIFY_SAMPLE=N: after
+// every collection N random live pages and N random remset entries per
+// thread are checked against cheap invariants (the side mark bitmap
+// only has bits for header-marked cells, marked headers carry a
+// plausible datatype pointer, remset entries stay marked). Unlike the
+// GC_VERIFY machinery in julia/src/gc-debug.c it doesn't recompute
+// reachability, so it is cheap enough to leave on in canary
+// deployments; violations are printed and counted, never fatal.
+pub static VERIFY_SAMPLE: AtomicUsize = AtomicUsize::new(0);
+pub static VERIFY_SAMPLE_FAILURES: AtomicUsize = AtomicUsize::new(0);
+// xorshift64 state; only stepped inside the pause
+pub static mut VERIFY_RNG: u64 = 0x9e3779b97f4a7c15;
+
+fn verify_rand() -> usize {
+    unsafe {
+        VERIFY_RNG ^= VERIFY_RNG << 13;
+        VERIFY_RNG ^= VERIFY_RNG >> 7;
+        VERIFY_RNG ^= VERIFY_RNG << 17;
+        VERIFY_RNG as usize
+    }
+}
+
+/// Longest total pause recorded so far, for the runtime stats surface
+/// (the percentile fields in gc_num cap out at p99).
+pub fn total_pause_max_ns() -> u64 {
+    unsafe { TOTAL_PAUSE_HIST.max_ns }
+}
+
+fn fmt_ms(ns: u64) -> String {
+    format!("{}.{:03}ms", ns / 1_000_000, (ns / 1_000) % 1_000)
+}
+
+fn hist_report(h: &PauseHist, json: bool) -> String {
+    let (p50, p99, p999) = (h.percentile(50, 100),
+                            h.percentile(99, 100),
+                            h.percentile(999, 1000));
+    if json {
+        format!("{{\"n\":{},\"p50_ns\":{},\"p99_ns\":{},\"p999_ns\":{},\"max_ns\":{}}}",
+                h.total, p50, p99, p999, h.max_ns)
+    } else {
+        format!("p50 {} p99 {} p99.9 {} max {}",
+                fmt_ms(p50), fmt_ms(p99), fmt_ms(p999), fmt_ms(h.max_ns))
+    }
+}
+
+/// End-of-run report for neptune_exit_hook: pause-time distributions
+/// and which pools the heap's pages ended up in. Prints nothing if no
+/// collection ever ran.
+pub fn print_exit_stats() {
+    let json = env::var("NEPTUNE_STATS_JSON").map(|v| v != "0").unwrap_or(false);
+    let (mark, sweep, total) = unsafe {
+        (&MARK_PAUSE_HIST, &SWEEP_PAUSE_HIST, &TOTAL_PAUSE_HIST)
+    };
+    if total.total == 0 {
+        return;
+    }
+
+    // pages currently assigned to each pool, skipping parked ones, and
+    // how much of those pages is sitting free (fragmentation): free
+    // cells the last sweep counted, against the pages' capacity
+    let mut pool_pages = [0usize; GC_N_POOLS];
+    let mut frag_free = 0usize;
+    let mut frag_cap = 0usize;
+    unsafe {
+        if let Some(regions) = REGIONS.as_ref() {
+            for region in regions.iter().take(REGIONS_HWM.load(Ordering::Relaxed)) {
+                if region.pg_cnt == 0 {
+                    continue; // released slot
+                }
+                for i in 0..region.pg_cnt as usize {
+                    if region.allocmap[i / 32].get_bit((i % 32) as u8) &&
+                        !region.meta[i].in_freelist {
+                        let p = region.meta_cold[i].pool_n as usize;
+                        if p < GC_N_POOLS {
+                            pool_pages[p] += 1;
+                            frag_free += region.meta[i].nfree as usize *
+                                region.meta[i].osize as usize;
+                            frag_cap += PAGE_SZ - GC_PAGE_OFFSET;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    let frag_pct = if frag_cap > 0 { frag_free * 100 / frag_cap } else { 0 };
+
+    // fold the per-thread allocation histograms once more so the
+    // profile covers allocations made since the last pause too
+    Gc2::publish_stats();
+    // charge each 16-byte request bucket to the pool class serving it:
+    // (allocations, estimated internal waste in bytes, using bucket
+    // midpoints for the request sizes)
+    let mut pool_allocs = [0u64; GC_N_POOLS];
+    let mut pool_waste = [0u64; GC_N_POOLS];
+    let mut allocs_total = 0u64;
+    let mut waste_total = 0u64;
+    let mut alloc_vol = 0u64;
+    unsafe {
+        for b in 0..SZCLASS_TABLE_LEN {
+            let n = NEPTUNE_STATS.alloc_hist[b];
+            if n == 0 {
+                continue;
+            }
+            let k = neptune_szclass_table[b] as usize;
+            let mid = (b as u64) * 16 + 8;
+            let waste = n * (gc_size_class(k) as u64 - mid);
+            pool_allocs[k] += n;
+            pool_waste[k] += waste;
+            allocs_total += n;
+            waste_total += waste;
+            alloc_vol += n * gc_size_class(k) as u64;
+        }
+    }
+
+    if json {
+        let mut pools = String::new();
+        for (i, &n) in pool_pages.iter().enumerate() {
+            if n == 0 {
+                continue;
+            }
+            if !pools.is_empty() {
+                pools.push(',');
+            }
+            pools.push_str(&format!("{{\"osize\":{},\"pages\":{}}}",
+                                    gc_size_class(i), n));
+        }
+        // raw 16-byte-bucket histogram, for fitting a size-class table
+        // offline (NEPTUNE_SIZE_CLASSES)
+        let mut hist = String::new();
+        unsafe {
+            for b in 0..SZCLASS_TABLE_LEN {
+                if NEPTUNE_STATS.alloc_hist[b] == 0 {
+                    continue;
+                }
+                if !hist.is_empty() {
+                    hist.push(',');
+                }
+                hist.push_str(&format!("{{\"size_max\":{},\"count\":{}}}",
+                                       (b + 1) * 16, NEPTUNE_STATS.alloc_hist[b]));
+            }
+        }
+        println!("{{\"page_bytes\":{},\"gc_pauses\":{{\"mark\":{},\"sweep\":{},\"total\":{}}},\"pools\":[{}],\"fragmentation\":{{\"free_bytes\":{},\"capacity_bytes\":{},\"pct\":{}}},\"alloc_hist\":[{}]}}",
+                 PAGE_SZ, hist_report(mark, true), hist_report(sweep, true),
+                 hist_report(total, true), pools, frag_free, frag_cap, frag_pct,
+                 hist);
+    } else {
+        println!("GC pause profile ({} collections, {} kB pages):",
+                 total.total, PAGE_SZ / 1024);
+        println!("  mark : {}", hist_report(mark, false));
+        println!("  sweep: {}", hist_report(sweep, false));
+        println!("  total: {}", hist_report(total, false));
+        println!("pool occupancy at exit:");
+        for (i, &n) in pool_pages.iter().enumerate() {
+            if n > 0 {
+                println!("  osize {:5}: {:6} pages ({} kB)",
+                         gc_size_class(i), n, n * PAGE_SZ / 1024);
+            }
+        }
+        println!("pool fragmentation at exit: {} kB free of {} kB ({}%)",
+                 frag_free / 1024, frag_cap / 1024, frag_pct);
+        if allocs_total > 0 {
+            println!("pool allocation profile:");
+            for k in 0..GC_N_POOLS {
+                if pool_allocs[k] == 0 {
+                    continue;
+                }
+                println!("  osize {:5}: {:10} allocs ({:2}%), est. waste {:2}%",
+                         gc_size_class(k), pool_allocs[k],
+                         pool_allocs[k] * 100 / allocs_total,
+                         pool_waste[k] * 100 /
+                             (pool_allocs[k] * gc_size_class(k) as u64));
+            }
+            println!("  overall est. waste: {} kB of {} kB allocated ({}%)",
+                     waste_total / 1024, alloc_vol / 1024,
+                     if alloc_vol > 0 { waste_total * 100 / alloc_vol } else { 0 });
+        }
+        let vfail = VERIFY_SAMPLE_FAILURES.load(Ordering::Relaxed);
+        if vfail > 0 {
+            println!("gc sample verifier: {} violations over the whole run", vfail);
+        }
+    }
+}
+
+// Concurrent marking, enabled with NEPTUNE_CONCURRENT_MARK. The
+// cycle is split in three: an initial pause that snapshots the
+// remsets and queues the roots, a concurrent phase where a background
+// thread drains the mark queue while the mutators run (the write
+// barrier shades unmarked objects stored into marked ones so the
+// markers can't miss them), and a final pause that rescans the roots
+// and remsets, drains to termination and sweeps.
+pub static CONCURRENT_MARK: AtomicBool = AtomicBool::new(false);
+pub const CONC_IDLE: usize = 0;
+pub const CONC_MARKING: usize = 1;
+pub const CONC_DONE: usize = 2;
+pub static CONC_STATE: AtomicUsize = AtomicUsize::new(CONC_IDLE);
+// Marking of the collecting Gc2, as a pointer, so the write barrier
+// knows where to queue shaded objects; 0 outside the marking phase
+static CONC_TARGET: AtomicUsize = AtomicUsize::new(0);
+// pause start of the cycle in flight, for the usual timing stats
+static mut CONC_T0: u64 = 0;
+
+// the marker parks on this pair between cycles (condvars are
+// futex-backed on Linux, so an idle marker costs nothing and starts
+// without the latency of a sleep poll); notified by start_concurrent_mark
+static mut CONC_PARK: Option<(Mutex<()>, Condvar)> = None;
+
+/// Start the background thread that drains the mark queue while the
+/// mutators run.
+pub fn spawn_concurrent_marker() {
+    unsafe {
+        CONC_PARK = Some((Mutex::new(()), Condvar::new()));
+    }
+    thread::spawn(move || {
+        loop {
+            {
+                let &(ref lock, ref cv) = unsafe { CONC_PARK.as_ref().unwrap() };
+                let mut guard = lock.lock().unwrap();
+                while CONC_STATE.load(Ordering::SeqCst) != CONC_MARKING {
+                    guard = cv.wait(guard).unwrap();
+                }
+            }
+            let marking = unsafe {
+                &*(CONC_TARGET.load(Ordering::SeqCst) as * const Marking)
+            };
+            loop {
+                marking.visit_mark_stack();
+                if MARK_PENDING.load(Ordering::SeqCst) == 0 {
+                    break;
+                }
+                // a mutator is mid-shade, give it time to finish the push
+                thread::yield_now();
+            }
+            // marking is monotone, so termination of everything queued
+            // so far is enough; late shades are drained in the final
+            // pause
+            CONC_STATE.store(CONC_DONE, Ordering::SeqCst);
+        }
+    });
+}
+
+/// Start the thread that runs native (C-pointer) finalizers handed
+/// over by the collector. These only call a C function on the dead
+/// object, so they don't need the Julia runtime and are safe to run
+/// off-thread.
+pub fn spawn_native_finalizer_thread() {
+    let (tx, rx) = mpsc::sync_channel(NATIVE_FINALIZER_QUEUE_SZ);
+    unsafe {
+        NATIVE_FINALIZER_TX = Some(tx);
+        NATIVE_TO_FINALIZE = Some(Vec::new());
+    }
+    thread::spawn(move || {
+        for (v, fin) in rx.iter() {
+            unsafe {
+                np_call_finalizer(fin as * mut libc::c_void, v as * mut libc::c_void);
+            }
+            NATIVE_FINALIZERS_PENDING.fetch_sub(1, Ordering::SeqCst);
+        }
+    });
+}
+
+// Concurrent reclamation of dead big objects and malloc'd array
+// buffers, enabled with NEPTUNE_CONC_SWEEP. The sweep loops still walk
+// their lists during the pause (the header checks are cheap and the
+// list bookkeeping is not safe against mutators), but instead of
+// calling free(3) per dead object they stage a record of each one and
+// a background worker returns the memory to the allocator after the
+// world restarts. New big objects allocate against the live lists as
+// usual; the staged records are a dead epoch nothing can reach.
+pub static CONCURRENT_SWEEP: AtomicBool = AtomicBool::new(false);
+// records handed to the worker that it has not reclaimed yet
+static BG_FREE_PENDING: AtomicUsize = AtomicUsize::new(0);
+static mut BG_FREE_PARK: Option<(Mutex<()>, Condvar)> = None;
+static mut BG_FREE_QUEUE: Option<Mutex<Vec<DeferredFree>>> = None;
+// staged during the pause by the sweep loops (world stopped, so no
+// lock) and flushed to the queue at the end of Gc2::sweep
+static mut BG_FREE_STAGE: Option<Vec<DeferredFree>> = None;
+
+// One reclamation a sweep loop postponed. Everything the worker needs
+// is captured at sweep time so it never dereferences the dead object
+// later (array headers in particular live in pools that may be reused
+// before the worker runs).
+enum DeferredFree {
+    Big(usize, usize),          // chunk address, capacity
+    Buffer(usize, usize, bool), // buffer address, nbytes, isaligned
+}
+
+/// Stage a dead object's memory for the background reclaimer. Returns
+/// false when concurrent sweeping is off and the caller should free
+/// inline as before.
+fn defer_free(f: DeferredFree) -> bool {
+    if ! CONCURRENT_SWEEP.load(Ordering::Relaxed) {
+        return false;
+    }
+    unsafe {
+        BG_FREE_STAGE.as_mut().unwrap().push(f);
+    }
+    true
+}
+
+/// Hand the staged dead epoch to the background reclaimer and wake it.
+/// Runs once at the end of the sweep, still inside the pause; the
+/// frees themselves happen after the world restarts.
+fn flush_deferred_frees() {
+    let mut staged = unsafe {
+        match BG_FREE_STAGE.as_mut() {
+            Some(s) => {
+                if s.is_empty() {
+                    return;
+                }
+                mem::replace(s, Vec::new())
+            }
+            None => return,
+        }
+    };
+    BG_FREE_PENDING.fetch_add(staged.len(), Ordering::SeqCst);
+    unsafe {
+        let mut q = BG_FREE_QUEUE.as_ref().unwrap().lock().unwrap();
+        q.append(&mut staged);
+    }
+    if let Some(&(ref lock, ref cv)) = unsafe { BG_FREE_PARK.as_ref() } {
+        let _guard = lock.lock().unwrap();
+        cv.notify_one();
+    }
+}
+
+/// Start the thread that returns dead big-object chunks and malloc'd
+/// array buffers to the allocator. rust_free and the C-side buffer
+/// pool (np_cache_array_buffer) are both safe to call off-thread, so
+/// the free storm of a full collection runs concurrently with the
+/// mutators instead of inside the pause.
+pub fn spawn_background_reclaimer() {
+    unsafe {
+        BG_FREE_PARK = Some((Mutex::new(()), Condvar::new()));
+        BG_FREE_QUEUE = Some(Mutex::new(Vec::new()));
+        BG_FREE_STAGE = Some(Vec::new());
+    }
+    thread::spawn(move || {
+        loop {
+            {
+                let &(ref lock, ref cv) = unsafe { BG_FREE_PARK.as_ref().unwrap() };
+                let mut guard = lock.lock().unwrap();
+                while BG_FREE_PENDING.load(Ordering::SeqCst) == 0 {
+                    guard = cv.wait(guard).unwrap();
+                }
+            }
+            let batch = {
+                let mut q = unsafe { BG_FREE_QUEUE.as_ref().unwrap().lock().unwrap() };
+                mem::replace(&mut *q, Vec::new())
+            };
+            let n = batch.len();
+            for f in batch {
+                match f {
+                    DeferredFree::Big(ptr, cap) => unsafe {
+                        Gc2::rust_free_big(ptr as * mut BigVal, cap);
+                    },
+                    DeferredFree::Buffer(d, nbytes, aligned) => unsafe {
+                        if aligned {
+                            np_cache_array_buffer(d as * mut libc::c_void, nbytes);
+                        } else {
+                            libc::free(d as * mut libc::c_void);
+                        }
+                    },
+                }
+            }
+            // decrement after the frees so prepare_mark's wait really
+            // means the previous epoch has been reclaimed
+            BG_FREE_PENDING.fetch_sub(n, Ordering::SeqCst);
+        }
+    });
+}
+
+// background page zeroing (NEPTUNE_ZERO_PAGES): parking for the wiper
+// thread, which moves pages from the plain page freelist to the
+// pre-zeroed one so pools can skip the tag-clearing walk on refill
+static mut PAGE_ZERO_PARK: Option<(Mutex<()>, Condvar)> = None;
+
+/// Nudge the page zeroer; called at the end of a sweep, after the dead
+/// pages are parked. No-op unless NEPTUNE_ZERO_PAGES started the thread.
+pub fn wake_background_zeroer() {
+    if let Some(&(ref lock, ref cv)) = unsafe { PAGE_ZERO_PARK.as_ref() } {
+        let _guard = lock.lock().unwrap();
+        cv.notify_one();
+    }
+}
+
+/// Start the thread that wipes parked pages while the mutators run, so
+/// a pool refilling after a sweep gets a page whose tags are already
+/// zero instead of walking the page clearing them. Pages move between
+/// the two freelists one exclusive pop at a time, and the zeroer holds
+/// the page zeroer lock in small batches so a pause that wants to unmap
+/// a region (shrink_regions) waits a bounded time for the pages in its
+/// hands.
+pub fn spawn_background_zeroer() {
+    unsafe {
+        PAGE_ZERO_PARK = Some((Mutex::new(()), Condvar::new()));
+    }
+    thread::spawn(move || {
+        loop {
+            {
+                let &(ref lock, ref cv) = unsafe { PAGE_ZERO_PARK.as_ref().unwrap() };
+                let mut guard = lock.lock().unwrap();
+                while page_freelist().is_empty() {
+                    guard = cv.wait(guard).unwrap();
+                }
+            }
+            loop {
+                let _guard = page_zeroer_lock().lock().unwrap();
+                let mut n = 0;
+                while n < 32 {
+                    match page_freelist().pop() {
+                        Some(p) => {
+                            unsafe {
+                                libc::memset(p, 0, PAGE_SZ);
+                            }
+                            zeroed_page_freelist().push(p);
+                            n += 1;
+                        }
+                        None => break,
+                    }
+                }
+                if n < 32 {
+                    break;
+                }
+            }
+        }
+    });
+}
+
+// Set by the cgroup pressure listener; the next maybe_collect consumes
+// it and runs a full collection instead of waiting for the allocation
+// interval.
+pub static MEM_PRESSURE: AtomicBool = AtomicBool::new(false);
+// One-shot companion flag: the sweep of a pressure-triggered full
+// collection also MADV_FREEs every parked page, regardless of the
+// configured page-return policy.
+pub static PRESSURE_RETURN: AtomicBool = AtomicBool::new(false);
+
+/// Start the thread that watches the container's cgroup memory
+/// controller and flags memory pressure (NEPTUNE_PRESSURE=0 disables).
+/// On cgroup v2 with PSI (4.20+ kernels) it registers a trigger on
+/// memory.pressure and sleeps in poll(2) until memory stalls exceed
+/// 100ms within a 1s window; without PSI it falls back to comparing
+/// usage against the limit (v2 memory.current/memory.max or the v1
+/// usage/limit pair) four times a second and fires at 90%. Either way
+/// the listener only sets MEM_PRESSURE - the collection itself runs on
+/// a mutator at its next safepoint, so this thread never touches GC
+/// state and costs nothing outside containers.
+pub fn spawn_pressure_listener() {
+    thread::spawn(move || {
+        let psi = open_psi_trigger();
+        loop {
+            if psi >= 0 {
+                let mut pfd = libc::pollfd {
+                    fd: psi,
+                    events: libc::POLLPRI,
+                    revents: 0,
+                };
+                let n = unsafe { libc::poll(&mut pfd, 1, 1000) };
+                if n > 0 && pfd.revents & libc::POLLPRI != 0 {
+                    flag_pressure();
+                }
+            } else {
+                if let Some((usage, limit)) = cgroup_usage_limit() {
+                    if limit > 0 && usage > limit / 10 * 9 {
+                        flag_pressure();
+                    }
+                }
+                thread::sleep(Duration::from_millis(250));
+            }
+        }
+    });
+}
+
+// register a PSI trigger on the cgroup v2 memory.pressure file;
+// returns the fd to poll, or -1 when PSI is unavailable
+fn open_psi_trigger() -> libc::c_int {
+    let path = b"/sys/fs/cgroup/memory.pressure\0";
+    let trig = b"some 100000 1000000";
+    unsafe {
+        let fd = libc::open(path.as_ptr() as * const libc::c_char,
+                            libc::O_RDWR | libc::O_NONBLOCK);
+        if fd < 0 {
+            return -1;
+        }
+        if libc::write(fd, trig.as_ptr() as * const libc::c_void, trig.len()) < 0 {
+            libc::close(fd);
+            return -1;
+        }
+        fd
+    }
+}
+
+// one-shot until the collector consumes the flag, so a saturated PSI
+// window doesn't queue up a train of full collections
+fn flag_pressure() {
+    if !MEM_PRESSURE.swap(true, Ordering::SeqCst) {
+        PRESSURE_RETURN.store(true, Ordering::SeqCst);
+        println!("neptune: cgroup memory pressure, scheduling full collection");
+    }
+}
+
+fn read_cgroup_num(path: &str) -> Option<u64> {
+    let mut s = String::new();
+    match File::open(path).and_then(|mut f| f.read_to_string(&mut s)) {
+        // a v2 limit of "max" fails to parse, which correctly reads
+        // as "no limit to compare against"
+        Ok(_) => s.trim().parse::<u64>().ok(),
+        Err(_) => None,
+    }
+}
+
+// (usage, limit) of the memory controller this process runs under
+fn cgroup_usage_limit() -> Option<(u64, u64)> {
+    // cgroup v2 unified hierarchy
+    if let (Some(u), Some(l)) = (read_cgroup_num("/sys/fs/cgroup/memory.current"),
+                                 read_cgroup_num("/sys/fs/cgroup/memory.max")) {
+        return Some((u, l));
+    }
+    // cgroup v1 memory controller
+    if let (Some(u), Some(l)) =
+        (read_cgroup_num("/sys/fs/cgroup/memory/memory.usage_in_bytes"),
+         read_cgroup_num("/sys/fs/cgroup/memory/memory.limit_in_bytes")) {
+        return Some((u, l));
+    }
+    None
+}
 
 const PURGE_FREED_MEMORY: bool = false;
 
 const TAG_BITS: u8 = 2; // number of tag bits
 const TAG_RANGE: Range<u8> = 0..TAG_BITS;
-const GC_N_POOLS: usize = 41;
+pub const GC_N_POOLS: usize = 41;
 const JL_SMALL_BYTE_ALIGNMENT: usize = 16;
 
 const GC_CLEAN: u8 = 0;
@@ -37,6 +879,10 @@ const GC_OLD_MARKED: u8 = (GC_OLD | GC_MARKED);
 
 const MAX_MARK_DEPTH: i32 = 40;
 
+// weakref lists shorter than this are cleared inline; fanning tiny
+// lists out to the worker pool costs more than the walk itself
+const WEAKREF_PAR_MIN: usize = 4096;
+
 const DEFAULT_COLLECT_INTERVAL: isize = 5600 * 1024 * 8;
 const MAX_COLLECT_INTERVAL: usize = 1250000000;
 
@@ -45,7 +891,15 @@ pub const GC_PAGE_OFFSET: usize = (JL_SMALL_BYTE_ALIGNMENT - (SIZE_OF_JLTAGGEDVA
 
 pub static mut np_threads: Option<Pool> = None;
 
-static GC_SIZE_CLASSES: [usize; GC_N_POOLS] = [
+// Pool object sizes. Mutable — and exported, jl_gc_sizeclasses in
+// julia_internal.h is this same storage — so neptune_init_gc can load
+// a tuned layout fitted to a measured allocation histogram (see
+// NEPTUNE_SIZE_CLASSES and the allocation profile in the exit stats).
+// Everything derives from the table after init, but generated code
+// bakes class indices and strides in, so a tuned table must also have
+// been in force when the system image was built.
+#[no_mangle]
+pub static mut neptune_size_classes: [libc::c_int; GC_N_POOLS] = [
     // minimum platform alignment
     8,
     // increments of 16 till 256 bytes
@@ -70,6 +924,66 @@ static GC_SIZE_CLASSES: [usize; GC_N_POOLS] = [
 ];
 const GC_MAX_SZCLASS: usize = 2032 - 8; // 8 is mem::size_of::<libc::uintptr_t>(), size_of isn't a const fn yet :(
 
+// current size-class table entry, as a Rust size
+pub fn gc_size_class(i: usize) -> usize {
+    unsafe { neptune_size_classes[i] as usize }
+}
+
+// Parse a comma-separated tuned size-class table: exactly GC_N_POOLS
+// ascending entries, each 8 or a multiple of 16 (the size-to-pool
+// lookup works in 16-byte buckets), the last one 2032 so the pool
+// range stays the same. Returns the table or a reason to reject it.
+pub fn parse_size_classes(spec: &str) -> Result<[libc::c_int; GC_N_POOLS], String> {
+    let mut classes = [0 as libc::c_int; GC_N_POOLS];
+    let mut n = 0;
+    for part in spec.split(',') {
+        let sz: usize = match part.trim().parse() {
+            Ok(s) => s,
+            Err(_) => return Err(format!("bad entry {:?}", part)),
+        };
+        if n >= GC_N_POOLS {
+            return Err(format!("more than {} entries", GC_N_POOLS));
+        }
+        if sz != 8 && (sz == 0 || sz % 16 != 0) {
+            return Err(format!("{} is neither 8 nor a multiple of 16", sz));
+        }
+        if n > 0 && sz as libc::c_int <= classes[n - 1] {
+            return Err(format!("entries stop ascending at {}", sz));
+        }
+        classes[n] = sz as libc::c_int;
+        n += 1;
+    }
+    if n != GC_N_POOLS {
+        return Err(format!("expected {} entries, got {}", GC_N_POOLS, n));
+    }
+    if classes[GC_N_POOLS - 1] != 2032 {
+        return Err("the last entry must be 2032".to_string());
+    }
+    Ok(classes)
+}
+
+// O(1) size -> pool index mapping: entry i covers sizes in
+// (i*16, (i+1)*16], sizes <= 8 are special-cased to pool 0. Filled
+// from neptune_size_classes at init and exported so the C side
+// (jl_gc_szclass in julia_internal.h) indexes the same table and both
+// halves agree by construction.
+const SZCLASS_TABLE_LEN: usize = 2032 >> 4;
+#[no_mangle]
+pub static mut neptune_szclass_table: [u8; SZCLASS_TABLE_LEN] = [0; SZCLASS_TABLE_LEN];
+
+// fill the size-to-pool table; called once from neptune_init_gc
+pub unsafe fn init_szclass_table() {
+    let mut k = 0;
+    for i in 0..SZCLASS_TABLE_LEN {
+        // largest size mapping to entry i
+        let sz = (i + 1) << 4;
+        while (neptune_size_classes[k] as usize) < sz {
+            k += 1;
+        }
+        neptune_szclass_table[i] = k as u8;
+    }
+}
+
 static GC_ALREADY_RUN: AtomicBool = AtomicBool::new(false);
 
 /*
@@ -368,10 +1282,15 @@ mod jltagged_value_tests {
     }
 }
 
+// # of cells moved from the freelist to the magazine in one refill
+const MAGAZINE_SIZE: usize = 64;
+
 // A GC Pool used for pooled allocation
 pub struct GcPool<'a> {
     freelist: Vec<&'a mut JlTaggedValue>, // list of free objects, a vec is more packed
+    magazine: Vec<&'a mut JlTaggedValue>, // magazine of cells taken from the freelist in batches
     newpages: Vec<JlTaggedValue>, // list of chunks of free objects (an optimization...)
+    lazy_pages: Vec<(usize, usize)>, // (region idx, page idx) of pages queued for a lazy sweep
     osize: usize                  // size of each object in this pool, could've been u16
 }
 
@@ -379,14 +1298,19 @@ impl<'a> GcPool<'a> {
     pub fn new(size: usize) -> Self {
         GcPool {
             freelist: Vec::new(),
+            magazine: Vec::with_capacity(MAGAZINE_SIZE),
             newpages: Vec::new(), // optimization, currently unused
+            lazy_pages: Vec::new(),
             osize: size,
         }
     }
 
     #[inline(always)]
     pub fn clear_freelist(&mut self) {
-        self.freelist.clear()
+        self.freelist.clear();
+        // magazine cells are free and unmarked, the sweep will push
+        // them back onto the freelist
+        self.magazine.clear();
     }
 }
 
@@ -439,47 +1363,95 @@ impl<'a> JlBinding<'a> {
 impl<'a> JlValueMarker for JlBinding<'a> {
 }
 
-// Pool page metadata
+// Pool page metadata, hot half: the fields the sweep reads or writes
+// for every live page. Kept to 32 bytes so a region's metadata array
+// packs two entries per cache line and streams during region walks;
+// the rarely-read fields live in the PageMetaCold side table
+// (Region::meta_cold, parallel to Region::meta).
 #[repr(C)]
-pub struct PageMeta<'a> {
-    pub pool_n:     u8,   // idx of pool that owns this page
+pub struct PageMeta {
     // TODO: make following bools after transitioning to Rust
     pub has_marked: AtomicBool,   // whether any cell is marked in this page
     pub has_young:  AtomicBool,   // whether any live and young cells are in this page, before sweeping
+    pub in_freelist: bool, // page is parked on the lock-free page freelist
+    pub needs_sweep: bool, // page is queued for a lazy sweep
+    pub zeroed: bool, // page data reads as zeros (fresh mmap or background zeroer)
     pub nold:       AtomicU16,  // #old objects
     pub prev_nold:  u16,  // #old object during previous sweep
     pub nfree:      u16,  // #free objects, invalid if pool that owns this page is allocating from it
     pub osize:      u16,  // size of each object in this page
-    pub fl_begin_offset: u16, // offset of the first free object
-    pub fl_end_offset:   u16, // offset of the last free object
-    pub thread_n: u16, // thread id of the heap that owns this page
-    pub data: Option<&'a mut [u8]>, // we are currently not using this, try removing it and see what breaks!
+    pub fl_begin_offset: PgOff, // offset of the first free object
+    pub fl_end_offset:   PgOff, // offset of the last free object
     pub ages: Option<Box<BitVec>>,
+    // side mark bitmap, one bit per cell, mirroring the header mark
+    // bits. The sweep reads liveness from here word-at-a-time instead
+    // of pulling every (mostly dead) object into cache.
+    pub marks: Option<Box<Vec<AtomicUsize>>>,
+}
+
+// Pool page metadata, cold half: written when a page is handed to a
+// pool and read only when a page's owner or data pointer is actually
+// needed (sweep routing, debug code), so region walks don't drag these
+// bytes through cache with the hot array.
+#[repr(C)]
+pub struct PageMetaCold {
+    pub data: * mut u8, // start of the page's data
+    pub thread_n: u16,  // thread id of the heap that owns this page
+    pub pool_n:   u8,   // idx of pool that owns this page
 }
 
-impl<'a> PageMeta<'a> {
+// the raw data pointer keeps PageMetaCold from being Send; the side
+// table is only written while a page is being handed to a pool, so
+// sweep workers may carry regions across threads as before
+unsafe impl Send for PageMetaCold {}
+
+// bits in one word of a page's side mark bitmap
+const BITMAP_WORD_BITS: usize = 64;
+
+// words needed to snapshot a whole page's bitmap on the sweep stack:
+// the smallest cell stride is JL_SMALL_BYTE_ALIGNMENT bytes, so this
+// covers every size class at the build-selected page size
+const BITMAP_SNAPSHOT_WORDS: usize =
+    (PAGE_SZ / JL_SMALL_BYTE_ALIGNMENT + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+
+impl PageMeta {
     pub fn new() -> Self {
         PageMeta {
-            pool_n:     0,
             has_marked: AtomicBool::new(false),
             has_young:  AtomicBool::new(false),
+            in_freelist: false,
+            needs_sweep: false,
+            zeroed: false,
             nold:       AtomicU16::new(0),
             prev_nold:  0,
             nfree:      0,
             osize:      0,
             fl_begin_offset: 0,
             fl_end_offset:   0,
-            thread_n: 0,
-            data: None,
             ages: None,
+            marks: None,
+        }
+    }
+
+    /// Set the side mark bit for the pool cell `o`, which must lie in
+    /// this page.
+    #[inline(always)]
+    pub fn mark_cell(&mut self, o: * const JlTaggedValue) {
+        let size = mem::size_of::<JlTaggedValue>() + self.osize as usize;
+        let padding = (size - JL_SMALL_BYTE_ALIGNMENT) % JL_SMALL_BYTE_ALIGNMENT;
+        let i = unsafe {
+            let page_begin = Page::of_raw(o).offset(GC_PAGE_OFFSET as isize);
+            page_begin.offset_to(o as * const u8).unwrap() as usize / (size + padding)
+        };
+        if let Some(ref marks) = self.marks {
+            marks[i / BITMAP_WORD_BITS].fetch_or(1 << (i % BITMAP_WORD_BITS), Ordering::Relaxed);
         }
     }
 
     // similar to `reset_page` in Julia but doesn't add a pointer to page data
     // and doesn't do the newpages optimization
     #[inline(always)]
-    pub fn reset(&mut self, poolIndex: u8) -> (usize, usize) {
-        self.pool_n = poolIndex;
+    pub fn reset(&mut self) -> (usize, usize) {
         // make sure that we have enough offset to fit a pointer, this can be
         // used for newpages optimization
         debug_assert!(GC_PAGE_OFFSET >= mem::size_of::<* mut libc::c_void>());
@@ -520,10 +1492,125 @@ impl<'a> PageMeta<'a> {
         let padding = (size - JL_SMALL_BYTE_ALIGNMENT) % JL_SMALL_BYTE_ALIGNMENT;
         self.nfree = (aligned_pg_size / (size + padding) as usize) as u16;
 
+        // (re)allocate and clear the side mark bitmap, one bit per cell
+        let n_words = (self.nfree as usize + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+        let mut marks = match self.marks.take() {
+            None => Box::new(Vec::with_capacity(n_words)),
+            Some(mut m) => {
+                m.clear();
+                m
+            }
+        };
+        for _ in 0..n_words {
+            marks.push(AtomicUsize::new(0));
+        }
+        self.marks = Some(marks);
+
         (size, padding)
     }
 }
 
+// 2MB transparent hugepages for big objects (NEPTUNE_HUGEPAGES_BIG):
+// chunks at or above the threshold are aligned to a hugepage boundary
+// and advised MADV_HUGEPAGE, so multi-megabyte arrays stop faulting
+// and TLB-walking through 4KB pages. The threshold is rounded up to a
+// hugepage multiple at init; since sub-threshold chunks stay strictly
+// below it, a chunk's capacity alone tells the free paths which
+// alignment the allocation used. Hugepage chunks are also larger than
+// BIGVAL_CACHE_MAX_SZ, so they never mix into the bigval cache.
+pub const HUGE_PAGE_SZ: usize = 2 * 1024 * 1024;
+pub static BIG_THP_MIN: AtomicUsize = AtomicUsize::new(0);
+// bytes currently backed by hugepage-advised chunks; mirrored into
+// gc_num.big_hugepage_bytes by writeback_stats
+pub static BIG_HUGEPAGE_BYTES: AtomicUsize = AtomicUsize::new(0);
+
+#[inline(always)]
+fn bigval_is_huge(capacity: usize) -> bool {
+    let min = BIG_THP_MIN.load(Ordering::Relaxed);
+    min != 0 && capacity >= min
+}
+
+// largest chunk the big-object cache will hold on to
+const BIGVAL_CACHE_MAX_SZ: usize = 256 * 1024;
+// lg2(BIGVAL_CACHE_MAX_SZ) - lg2(4K), one bucket per power of two
+const BIGVAL_CACHE_BUCKETS: usize = 7;
+// per-bucket cap, beyond this freed chunks go back to the system
+const BIGVAL_CACHE_BUCKET_CAP: usize = 32;
+
+/// Size-segregated cache of freed bigval chunks. Our workloads
+/// allocate and drop lots of 4-64KB arrays, and returning each one to
+/// the system allocator just to ask for it back shows up as mmap and
+/// page-fault churn. Entries are (capacity, chunk) pairs.
+pub struct BigvalCache {
+    buckets: Vec<Vec<(usize, * mut BigVal)>>,
+}
+
+impl BigvalCache {
+    pub fn new() -> Self {
+        let mut buckets = Vec::with_capacity(BIGVAL_CACHE_BUCKETS);
+        for _ in 0..BIGVAL_CACHE_BUCKETS {
+            buckets.push(Vec::new());
+        }
+        BigvalCache {
+            buckets: buckets,
+        }
+    }
+
+    // bucket i holds chunks with capacity up to 2^(12+i) bytes
+    #[inline(always)]
+    fn bucket_of(capacity: usize) -> Option<usize> {
+        if capacity > BIGVAL_CACHE_MAX_SZ {
+            return None;
+        }
+        let lg2 = capacity.next_power_of_two().trailing_zeros() as usize;
+        Some(lg2.saturating_sub(12))
+    }
+
+    /// Take a cached chunk that can hold `allocsz` bytes, if any.
+    pub fn take(&mut self, allocsz: usize) -> Option<(usize, * mut BigVal)> {
+        let b = match BigvalCache::bucket_of(allocsz) {
+            Some(b) => b,
+            None => return None,
+        };
+        // first fit; buckets are capped so a linear scan is fine
+        for i in b..BIGVAL_CACHE_BUCKETS {
+            let ref mut bucket = self.buckets[i];
+            for j in 0..bucket.len() {
+                if bucket[j].0 >= allocsz {
+                    return Some(bucket.swap_remove(j));
+                }
+            }
+        }
+        None
+    }
+
+    /// Cache a freed chunk. Returns false if the chunk is too big for
+    /// the cache or its bucket is full, in which case the caller must
+    /// free it.
+    pub fn put(&mut self, capacity: usize, chunk: * mut BigVal) -> bool {
+        match BigvalCache::bucket_of(capacity) {
+            Some(b) if self.buckets[b].len() < BIGVAL_CACHE_BUCKET_CAP => {
+                self.buckets[b].push((capacity, chunk));
+                true
+            }
+            _ => false,
+        }
+    }
+
+    /// Trim policy: drop half of each bucket, run after full sweeps so
+    /// a burst of big allocations doesn't pin memory forever.
+    pub fn trim(&mut self) {
+        for bucket in self.buckets.iter_mut() {
+            let keep = bucket.len() / 2;
+            for (cap, chunk) in bucket.drain(keep..) {
+                unsafe {
+                    Gc2::rust_free(chunk, cap);
+                }
+            }
+        }
+    }
+}
+
 // Thread-local heap
 // lifetimes don't mean anything yet
 pub struct ThreadHeap<'a> {
@@ -531,11 +1618,12 @@ pub struct ThreadHeap<'a> {
     pools: Vec<GcPool<'a>>, // This has size GC_N_POOLS!, could have been an array, but copy only implemented for simpler things, so use a vec
     // weak refs
     weak_refs: Vec<* mut WeakRef>,
-    // malloc'd arrays
-    mallocarrays: Vec<MallocArray>,
-    mafreelist: Vec<MallocArray>,
+    // malloc'd arrays, swept linearly
+    mallocarrays: Vec<* mut JlArray>,
     // big objects
     pub big_objects: Vec<&'a mut BigVal>,
+    // cache of freed big-object chunks for reuse by big_alloc
+    pub bigval_cache: BigvalCache,
     // remset
     rem_bindings: Vec<&'a mut JlBinding<'a>>,
     pub remset: Vec<* mut JlValue>,
@@ -546,16 +1634,16 @@ pub struct ThreadHeap<'a> {
 impl<'a> ThreadHeap<'a> {
     pub fn new() -> Self {
         let mut pools = Vec::with_capacity(GC_N_POOLS);
-        for size in GC_SIZE_CLASSES.iter() {
-            pools.push(GcPool::new(*size));
+        for i in 0..GC_N_POOLS {
+            pools.push(GcPool::new(gc_size_class(i)));
         }
 
         ThreadHeap {
             pools: pools,
             weak_refs: Vec::new(),
             mallocarrays: Vec::new(),
-            mafreelist: Vec::new(),
             big_objects: Vec::new(),
+            bigval_cache: BigvalCache::new(),
             rem_bindings: Vec::new(),
             remset: Vec::new(),
             last_remset: Vec::new(),
@@ -566,6 +1654,11 @@ impl<'a> ThreadHeap<'a> {
 
 const BIG_OBJ_CACHE_SIZE: usize = 1024;
 
+// Each worker's cache is its own cache-line-aligned allocation: the
+// counters it bumps on every mark (scanned_bytes and friends) must
+// never share a line with another worker's, or the mark loop pays
+// coherence traffic for purely thread-local state.
+#[repr(align(64))]
 pub struct MarkCache {
     // thread-local statistics, will be merged into global during stop-the-world
     pub perm_scanned_bytes: usize,
@@ -580,17 +1673,37 @@ pub struct MarkCache {
 }
 
 
-/// to-be thread-local mark cache for GC threads. TODO: make this thread-local
-pub static mut mark_caches: Option<HashMap<thread::ThreadId, MarkCache>> = None;
+/// Registry of the GC threads' mark caches, one boxed cache per
+/// worker. Only the coordinating thread walks it, between phases when
+/// the workers are quiescent (sync_caches, debug dumps); during
+/// marking each worker reaches its own cache through the thread-local
+/// pointer below.
+pub static mut mark_caches: Option<Mutex<Vec<Box<MarkCache>>>> = None;
+
+thread_local! {
+    // this worker's entry in mark_caches; set on first use. The boxed
+    // cache has a stable address, so the raw pointer stays valid for
+    // the life of the process.
+    static MARK_CACHE_PTR: Cell<* mut MarkCache> = Cell::new(::std::ptr::null_mut());
+}
 
 /// Get _GC thread-local_ mark cache used for marking. This function
 /// does not provide access to Julia threads' mark caches. To access
 /// those mark caches, use the coressponding JlTLS object or Gc2
 /// object.
 pub fn gc_cache<'a>() -> &'a mut MarkCache {
-    let mc = unsafe { mark_caches.as_mut().unwrap() };
-    let tid = thread::current().id();
-    mc.entry(tid).or_insert_with(|| MarkCache::new())
+    MARK_CACHE_PTR.with(|c| {
+        let mut p = c.get();
+        if p.is_null() {
+            let mut boxed = Box::new(MarkCache::new());
+            p = &mut *boxed as * mut MarkCache;
+            unsafe {
+                mark_caches.as_ref().unwrap().lock().unwrap().push(boxed);
+            }
+            c.set(p);
+        }
+        unsafe { &mut *p }
+    })
 }
 
 impl MarkCache {
@@ -816,10 +1929,19 @@ impl MarkCache {
     pub fn sync_big_objects(&mut self, gc: &mut Gc2) {
         // simulate linking to that list
         let start = gc.heap.big_objects.len();
-        gc.heap.big_objects.append(unsafe {
-            mem::transmute::<&mut Vec<*mut BigVal>, &mut Vec<&mut BigVal>>(&mut self.big_obj_list)
-        });
-        for i in start..gc.heap.big_objects.len() {
+        let end;
+        {
+            gc.heap.big_objects.append(unsafe {
+                mem::transmute::<&mut Vec<*mut BigVal>, &mut Vec<&mut BigVal>>(&mut self.big_obj_list)
+            });
+            end = gc.heap.big_objects.len();
+        }
+        for i in start..end {
+            // the vector is dense but the headers are cold; stream them
+            if i + BIG_SWEEP_PREFETCH < end {
+                let p = (&*gc.heap.big_objects[i + BIG_SWEEP_PREFETCH]) as *const BigVal as usize;
+                Marking::prefetch(p);
+            }
             let ref mut hdr = gc.heap.big_objects[i];
             assert!(hdr.in_list);
             hdr.slot = i;
@@ -828,12 +1950,36 @@ impl MarkCache {
     }
 
     pub fn sync_remset(&mut self, gc: &mut Gc2) {
+        // one cache can remember the same object several times (e.g.
+        // stripes of one large pointer array each push the parent),
+        // drop the duplicates before handing the batch over
+        self.remset.sort();
+        self.remset.dedup();
         gc.heap.remset.append(&mut self.remset);
         gc.heap.remset_nptr += self.remset_nptr;
         self.remset_nptr = 0;
     }
 }
 
+// What one finalizer-table scan wants appended to the shared lists,
+// kept as (value, finalizer) address pairs so scans can run on the
+// worker pool and the appends can happen sequentially afterwards.
+struct FinalizerSweepOut {
+    to_finalize: Vec<(usize, usize)>,
+    marked: Vec<(usize, usize)>,
+    native: Vec<(usize, usize)>,
+}
+
+impl FinalizerSweepOut {
+    fn new() -> Self {
+        FinalizerSweepOut {
+            to_finalize: Vec::new(),
+            marked: Vec::new(),
+            native: Vec::new(),
+        }
+    }
+}
+
 #[repr(C)]
 pub struct GcFrame {
     nroots: usize,
@@ -841,9 +1987,53 @@ pub struct GcFrame {
     // actual roots appear here
 }
 
+// # of objects queued for marking but not yet processed, across the
+// shared stack and all workers' deques. Workers terminate when it
+// drops to zero.
+static MARK_PENDING: AtomicUsize = AtomicUsize::new(0);
+
+thread_local! {
+    // the mark worker's own work-stealing deque, set for the duration
+    // of visit_mark_stack so scan_obj can push overflow work onto it
+    // without synchronization. Null outside the mark phase.
+    static LOCAL_MARK_QUEUE: Cell<* mut chase_lev::Worker<usize>> = Cell::new(::std::ptr::null_mut());
+}
+
+// # of elements in one stripe of a large pointer array on the mark queue
+const MARK_CHUNK_SIZE: usize = 4096;
+
+// depth of the prefetch FIFO in the mark loop: an entry is processed
+// this many pops after its cache line was prefetched
+const PREFETCH_DEPTH: usize = 8;
+
+// lookahead for the linear side-vector walks (big-object sweep and
+// cache sync, malloc'd-array sweep): the vectors are dense, but every
+// entry's header is a cold line, so the walks prefetch this many
+// entries ahead of use
+const BIG_SWEEP_PREFETCH: usize = 8;
+
+// lookahead, in cells, for the page-cell walks in the pool sweep;
+// each visited cell is a cold line, so the walk prefetches the header
+// it will touch this many cells ahead of use
+const SWEEP_CELL_PREFETCH: usize = 8;
+
+// A stripe of a large pointer array -- or of a large module's binding
+// table -- queued for marking. Stripes are boxed and pushed onto the
+// mark queue with the pointer's low bit tagged (objects are at least
+// 16-byte aligned so the bit is free), letting parallel mark workers
+// process one array or table concurrently.
+struct MarkChunk {
+    parent: * mut JlValue, // the (already marked) array or module object
+    bits: u8,              // mark bits the parent was marked with
+    start: usize,          // first element (array) or table slot (bindings)
+    len: usize,            // # of elements / slots in the stripe
+    bindings: bool,        // stripe of a module's binding table
+}
+
 /// Marking part of the garbage collector. Separation of this and the rest makes thread-safety easier to achieve.
 pub struct Marking {
-    // mark stack for marking on this thread
+    // shared mark stack; used for roots and for pushes from outside
+    // the mark phase. During the phase workers use their own deques.
     mark_stack: ConcurrentStack<* mut JlValue>,
 }
 
@@ -854,6 +2044,21 @@ impl Marking {
         }
     }
 
+    /// Queue an object for marking: onto this worker's deque if we are
+    /// inside the mark phase, onto the shared stack otherwise.
+    #[inline(always)]
+    fn queue(&self, v: * mut JlValue) {
+        MARK_PENDING.fetch_add(1, Ordering::SeqCst);
+        let q = LOCAL_MARK_QUEUE.with(|q| q.get());
+        if q.is_null() {
+            self.mark_stack.push(v);
+        } else {
+            unsafe {
+                (*q).push(v as usize);
+            }
+        }
+    }
+
     pub fn mark_roots(&self) {
         // modules
         self.push_root(unsafe { (*jl_main_module).as_mut_jlvalue() }, MAX_MARK_DEPTH);
@@ -871,33 +2076,92 @@ impl Marking {
         self.push_root(unsafe { (*jl_anytuple_type_type).as_mut_jlvalue() }, MAX_MARK_DEPTH);
         self.push_root(jl_ANY_flag, MAX_MARK_DEPTH);
 
-        for i in 0..N_CALL_CACHE {
-            if ! call_cache[i].is_null() {
-                self.push_root(call_cache[i], MAX_MARK_DEPTH);
-            }
-        }
-
         if ! jl_all_methods.is_null() {
             self.push_root(unsafe { (*jl_all_methods).as_mut_jlvalue() }, MAX_MARK_DEPTH);
         }
 
+        // typemap arrays replaced by an RCU republication; lock-free
+        // dispatch may still be reading them
+        if ! jl_typemap_retired.is_null() {
+            self.push_root(unsafe { (*jl_typemap_retired).as_mut_jlvalue() }, MAX_MARK_DEPTH);
+        }
+
+        // per-call-site dispatch caches handed out by codegen
+        if ! jl_callsite_caches.is_null() {
+            self.push_root(unsafe { (*jl_callsite_caches).as_mut_jlvalue() }, MAX_MARK_DEPTH);
+        }
+
+        // memoized type-intersection table
+        if ! jl_intersect_cache.is_null() {
+            self.push_root(unsafe { (*jl_intersect_cache).as_mut_jlvalue() }, MAX_MARK_DEPTH);
+        }
+
         // constants
         self.push_root(unsafe { (*jl_typetype_type).as_mut_jlvalue() }, MAX_MARK_DEPTH);
         self.push_root(unsafe { (*jl_emptytuple_type).as_mut_jlvalue() }, MAX_MARK_DEPTH);
     }
 
+    /// One shard of the per-call-site dispatch cache; the table is big
+    /// enough (N_CALL_CACHE entries) to be worth splitting.
+    fn mark_call_cache_shard(&self, lo: usize, hi: usize) {
+        for i in lo..hi {
+            if ! call_cache[i].is_null() {
+                self.push_root(call_cache[i], MAX_MARK_DEPTH);
+            }
+        }
+    }
+
+    /// Queue the global roots, remsets and thread-local roots without
+    /// draining the mark stack. push_root with MAX_MARK_DEPTH marks
+    /// the root itself and queues its children, so this pushes work
+    /// but does almost no tracing -- except for the stack walks, which
+    /// with deep mutator stacks can dominate the pause on their own.
+    /// Scanning is therefore partitioned across the worker pool: one
+    /// task per mutator thread (its remset plus thread-local roots),
+    /// one for the global roots, and the call cache in shards. Workers
+    /// have no local deques outside the mark phase, so every push lands
+    /// on the shared mark stack for visit_mark_stack to drain.
+    pub fn queue_roots(&self) {
+        const CALL_CACHE_SHARDS: usize = 4;
+        let nthreads = unsafe { get_all_tls() }.len();
+        let ntasks = nthreads + 1 + CALL_CACHE_SHARDS;
+        let next = AtomicUsize::new(0);
+        let pool = unsafe { np_threads.as_mut().unwrap() };
+        let n_workers = pool.thread_count() as usize;
+        pool.scoped(|scope| {
+            for _ in 0..n_workers {
+                let next = &next;
+                scope.execute(move || {
+                    loop {
+                        let i = next.fetch_add(1, Ordering::SeqCst);
+                        if i >= ntasks {
+                            break;
+                        }
+                        if i < nthreads {
+                            // exclusive: each mutator thread's state is
+                            // claimed by exactly one task
+                            let tl_gc = unsafe {
+                                &mut * get_all_tls()[i].tl_gcs
+                            };
+                            self.mark_remset(tl_gc); // TODO: make this just tl_gc to separate marking even better
+                            self.mark_thread_local(tl_gc); // TODO: separate these from self
+                        } else if i == nthreads {
+                            self.mark_roots();
+                        } else {
+                            let shard = i - nthreads - 1;
+                            let per = N_CALL_CACHE / CALL_CACHE_SHARDS;
+                            self.mark_call_cache_shard(shard * per, (shard + 1) * per);
+                        }
+                    }
+                });
+            }
+        });
+    }
+
     pub fn walk_roots(&self) {
         debug_assert!(self.mark_stack.is_empty());
 
-        // finished premark, mark remsets and thread local roots
-        for t in unsafe { get_all_tls() } {
-            let tl_gc = unsafe { &mut * t.tl_gcs };
-            self.mark_remset(tl_gc); // TODO: make this just tl_gc to separate marking even better
-            self.mark_thread_local(tl_gc); // TODO: separate these from self
-        }
-
-        // walk the roots
-        self.mark_roots();
+        self.queue_roots();
         self.visit_mark_stack(); // this function processes all the pushed roots
     }
 
@@ -926,6 +2190,15 @@ impl Marking {
         self.mark_object_list(unsafe { &mut to_finalize }, 0);
         self.visit_mark_stack();
 
+        // likewise keep the objects whose native finalizers were
+        // deferred to the background thread alive through this sweep
+        if let Some(pending) = unsafe { NATIVE_TO_FINALIZE.as_ref() } {
+            for &(v, _) in pending.iter() {
+                self.push_root(v as * mut JlValue, 0);
+            }
+            self.visit_mark_stack();
+        }
+
         set_mark_reset_age(0);
     }
 
@@ -986,7 +2259,7 @@ impl Marking {
         let d = _d + 1;
         if d >= MAX_MARK_DEPTH {
             // queue the root
-            self.mark_stack.push(*v);
+            self.queue(*v);
             return;
         }
 
@@ -1027,11 +2300,12 @@ impl Marking {
             if flags.ptrarray() && ! a.data.is_null() {
                 let l = a.length as usize;
 
-                if l > 100000 && d > MAX_MARK_DEPTH - 10 {
-                    // don't mark long arrays at hight depth to avoid copying
-                    // the whole array into the mark queue, instead queue the
-                    // array pointer.
-                    self.mark_stack.push(*v);
+                if l > 2 * MARK_CHUNK_SIZE {
+                    // stripe long arrays over the mark queue so the
+                    // workers can process (and steal) parts of the
+                    // buffer concurrently instead of one thread
+                    // walking the whole thing
+                    self.queue_array_chunks(*v, bits, l);
                     return;
                 } else {
                     nptr += l;
@@ -1091,6 +2365,128 @@ impl Marking {
         }
     }
 
+    /// Hint the CPU to pull the cache line at `p` into L1. The mark
+    /// loop is dominated by dependent loads missing to L3/DRAM, so
+    /// headers are prefetched a fixed distance ahead of use.
+    #[cfg(any(target_arch = "x86", target_arch = "x86_64"))]
+    #[inline(always)]
+    fn prefetch(p: usize) {
+        unsafe {
+            asm!("prefetcht0 ($0)" : : "r"(p) : : "volatile");
+        }
+    }
+
+    #[cfg(not(any(target_arch = "x86", target_arch = "x86_64")))]
+    #[inline(always)]
+    fn prefetch(_p: usize) {}
+
+    /// Process one mark-queue entry: either a tagged stripe of a large
+    /// pointer array or a plain object pointer.
+    fn process_mark_item(&self, v: usize) {
+        if v & 1 != 0 {
+            // a boxed stripe of a large pointer array or binding table
+            let chunk = unsafe {
+                Box::from_raw((v & !1) as * mut MarkChunk)
+            };
+            if chunk.bindings {
+                self.mark_binding_chunk(chunk);
+            } else {
+                self.mark_array_chunk(chunk);
+            }
+        } else {
+            let header = unsafe { &*as_jltaggedvalue(v as * mut JlValue) }.read_header();
+            debug_assert_ne!(header, 0);
+            self.scan_obj3(&(v as * mut JlValue), 0, header);
+        }
+        MARK_PENDING.fetch_sub(1, Ordering::SeqCst);
+    }
+
+    /// Split a large pointer array into stripes and queue each one
+    /// separately, see `MarkChunk`.
+    fn queue_array_chunks(&self, v: * mut JlValue, bits: u8, len: usize) {
+        let mut start = 0;
+        while start < len {
+            let n = cmp::min(MARK_CHUNK_SIZE, len - start);
+            let chunk = Box::new(MarkChunk {
+                parent: v,
+                bits: bits,
+                start: start,
+                len: n,
+                bindings: false,
+            });
+            let p = Box::into_raw(chunk) as usize;
+            debug_assert_eq!(p & 1, 0);
+            self.queue((p | 1) as * mut JlValue);
+            start += n;
+        }
+    }
+
+    /// Mark one stripe of a large pointer array.
+    fn mark_array_chunk(&self, chunk: Box<MarkChunk>) {
+        let a = unsafe { &*(chunk.parent as * const JlArray) };
+        let mut refyoung = 0;
+        let data = unsafe {
+            slice::from_raw_parts((a.data as * const * mut JlValue).offset(chunk.start as isize), chunk.len)
+        };
+        for i in 0..chunk.len {
+            let elt = data[i];
+            if ! elt.is_null() {
+                refyoung |= self.push_root(elt, 0);
+            }
+        }
+        if chunk.bits == GC_OLD_MARKED && refyoung > 0 && ! get_gc_verifying() {
+            // conservative: several stripes of the same array may each
+            // push the parent, premarking tolerates the duplicates
+            gc_cache().remset_nptr += chunk.len;
+            gc_cache().remset.push(chunk.parent);
+        }
+    }
+
+    /// Split a big module's binding table into stripes and queue each
+    /// one, mirroring queue_array_chunks. MARK_CHUNK_SIZE is even, so
+    /// every stripe starts on a value slot (the table stores key/value
+    /// pairs and the walk visits the odd slots).
+    fn queue_binding_chunks(&self, m: &mut JlModule, bits: u8) {
+        let size = m.bindings.size;
+        let mut start = 1;
+        while start < size {
+            let n = cmp::min(MARK_CHUNK_SIZE, size - start);
+            let chunk = Box::new(MarkChunk {
+                parent: m.as_mut_jlvalue(),
+                bits: bits,
+                start: start,
+                len: n,
+                bindings: true,
+            });
+            let p = Box::into_raw(chunk) as usize;
+            debug_assert_eq!(p & 1, 0);
+            self.queue((p | 1) as * mut JlValue);
+            start += n;
+        }
+    }
+
+    /// Mark one stripe of a module's binding table.
+    fn mark_binding_chunk(&self, chunk: Box<MarkChunk>) {
+        let m = unsafe { &mut *(chunk.parent as * mut JlModule) };
+        let table = unsafe {
+            slice::from_raw_parts_mut(m.bindings.table, m.bindings.size)
+        };
+        let mut refyoung = 0;
+        let mut i = chunk.start;
+        let end = chunk.start + chunk.len;
+        while i < end {
+            if ! HTable::is_not_found(table[i]) {
+                refyoung |= self.mark_binding(m, table[i], 0, chunk.bits);
+            }
+            i += 2;
+        }
+        if chunk.bits == GC_OLD_MARKED && refyoung > 0 && ! get_gc_verifying() {
+            // as with array stripes, duplicates are tolerated
+            gc_cache().remset_nptr += chunk.len;
+            gc_cache().remset.push(chunk.parent);
+        }
+    }
+
     /// Update metadata of a marked object without scanning it
     fn mark_obj(&self, v: * mut JlValue, tag: usize, bits: u8) {
         debug_assert!(! v.is_null());
@@ -1190,10 +2586,33 @@ impl Marking {
 
         *bits = mark_mode;
         let old_tag = o.header.swap(tag, Ordering::Relaxed);
+        if ! old_tag.marked() {
+            // mirror the fresh mark into the page's side bitmap so the
+            // sweep can read liveness without touching headers
+            Marking::mark_bitmap(o);
+        }
         // TODO: verify_val(jl_valueof(o)) !!!
         ! old_tag.marked()
     }
 
+    /// Record a marked object in its page's side mark bitmap. Non-pool
+    /// objects (bigvals etc.) are skipped. This deliberately bypasses
+    /// the page manager mutex: taking it once per marked object would
+    /// serialize the mark workers.
+    #[inline(always)]
+    fn mark_bitmap(o: * const JlTaggedValue) {
+        let regions = unsafe { REGIONS.as_mut().unwrap() };
+        for region in regions.iter_mut().take(REGIONS_HWM.load(Ordering::Relaxed)) {
+            if region.pg_cnt == 0 {
+                continue; // released slot
+            }
+            if let Some(i) = region.index_of_raw(o as * const u8) {
+                region.meta[i].mark_cell(o);
+                return;
+            }
+        }
+    }
+
     fn mark_remset(&self, other: &mut Gc2) {
         for i in 0..other.heap.last_remset.len() {
             // cannot borrow array item because non-lexical borrowing hasn't landed to Rust yet
@@ -1221,32 +2640,113 @@ impl Marking {
         other.heap.rem_bindings.truncate(n_bnd_refyoung);
     }
 
-    /// Visit all objects queued to the mark stack
+    /// Rescan the remset entries the write barriers produced while
+    /// concurrent marking was running. Unlike `mark_remset` this reads
+    /// the live remset (premark already consumed last_remset in the
+    /// initial pause) and does not compact rem_bindings: both are left
+    /// for sweep_remset to re-arm as usual.
+    fn mark_concurrent_remset(&self, other: &mut Gc2) {
+        for i in 0..other.heap.remset.len() {
+            let item = other.heap.remset[i].clone();
+            let tag = unsafe { &*as_jltaggedvalue(item) };
+            self.scan_obj3(&item, MAX_MARK_DEPTH, tag.read_header());
+        }
+
+        for i in 0..other.heap.rem_bindings.len() {
+            if other.heap.rem_bindings[i].value.is_null() {
+                continue;
+            }
+            self.push_root(other.heap.rem_bindings[i].value, MAX_MARK_DEPTH);
+        }
+    }
+
+    /// Visit all objects queued to the mark stack.
+    ///
+    /// Marking runs on the worker pool with one Chase-Lev deque per
+    /// worker: a worker pushes and pops its own deque without any
+    /// synchronization, and when it runs dry it takes work from the
+    /// shared stack or steals from a sibling. Termination is detected
+    /// with the MARK_PENDING count of queued-but-unprocessed objects.
     pub fn visit_mark_stack(&self) {
+        if self.mark_stack.is_empty() {
+            return;
+        }
         let thread_pool = unsafe {
             np_threads.as_mut().unwrap()
         };
-
-        // the outer loop is for the cases where the stack becomes
-        // empty while we are synchronizing
-        while ! self.mark_stack.is_empty() && ! Gc2::should_timeout() {
-            // when the scope gets dropped, i.e. when this
-            // function returns, the threads will join
-            // automatically.
-            thread_pool.scoped(|scope| {
-                while ! self.mark_stack.is_empty() && ! Gc2::should_timeout() {
-                    // casting to let Rust send this pointer over threads
-                    let v = self.mark_stack.pop().unwrap() as usize;
-                    let header = unsafe { &*as_jltaggedvalue(v as * mut JlValue) }.read_header();
-                    debug_assert_ne!(header, 0);
-                    scope.execute(move || {
-                        self.scan_obj3(&(v as * mut JlValue), 0, header);
-                    });
-                }
-            });
+        let n_workers = thread_pool.thread_count() as usize;
+
+        let mut workers = Vec::with_capacity(n_workers);
+        let mut stealers = Vec::with_capacity(n_workers);
+        for _ in 0..n_workers {
+            let (w, s) = chase_lev::deque();
+            workers.push(w);
+            stealers.push(s);
         }
 
-        assert!(self.mark_stack.is_empty());
+        // when the scope gets dropped, i.e. when this function
+        // returns, the threads will join automatically.
+        thread_pool.scoped(|scope| {
+            for mut worker in workers.drain(..) {
+                let stealers = stealers.clone();
+                scope.execute(move || {
+                    LOCAL_MARK_QUEUE.with(|q| q.set(&mut worker as * mut chase_lev::Worker<usize>));
+                    // Cher-style prefetch FIFO: entries sit here for
+                    // PREFETCH_DEPTH pops after their cache line was
+                    // prefetched, so the miss is (mostly) paid off by
+                    // the time the object is actually scanned
+                    let mut fifo: VecDeque<usize> = VecDeque::with_capacity(PREFETCH_DEPTH);
+                    while ! Gc2::should_timeout() {
+                        // own deque first, then the shared stack, then
+                        // steal from a sibling
+                        let fetched = if let Some(v) = worker.try_pop() {
+                            Some(v)
+                        } else if let Some(v) = self.mark_stack.pop() {
+                            Some(v as usize)
+                        } else {
+                            let mut stolen = None;
+                            for s in stealers.iter() {
+                                if let chase_lev::Steal::Data(v) = s.steal() {
+                                    stolen = Some(v);
+                                    break;
+                                }
+                            }
+                            stolen
+                        };
+                        match fetched {
+                            Some(v) => {
+                                Marking::prefetch(v & !1);
+                                fifo.push_back(v);
+                                if fifo.len() >= PREFETCH_DEPTH {
+                                    let v = fifo.pop_front().unwrap();
+                                    self.process_mark_item(v);
+                                }
+                            }
+                            None => {
+                                if let Some(v) = fifo.pop_front() {
+                                    // no new work, drain the FIFO
+                                    self.process_mark_item(v);
+                                } else if MARK_PENDING.load(Ordering::SeqCst) == 0 {
+                                    break; // no work queued anywhere
+                                } else {
+                                    // somebody still has work we failed
+                                    // to steal, let them make progress
+                                    thread::yield_now();
+                                }
+                            }
+                        }
+                    }
+                    LOCAL_MARK_QUEUE.with(|q| q.set(::std::ptr::null_mut()));
+                });
+            }
+        });
+
+        // with concurrent marking on, a mutator may shade an object
+        // between worker termination and this check; the leftover is
+        // picked up by the next visit
+        if CONC_STATE.load(Ordering::SeqCst) != CONC_MARKING {
+            assert!(self.mark_stack.is_empty());
+        }
     }
 
 
@@ -1325,34 +2825,59 @@ impl Marking {
         self.push_root_if_not_null(ta, MAX_MARK_DEPTH);
     }
 
-    fn mark_module(&self, m: &mut JlModule, d: i32, bits: u8) -> i32 {
+    /// Mark one entry of a module's binding table; shared by the
+    /// inline walk below and the striped one (mark_binding_chunk).
+    #[inline(always)]
+    fn mark_binding(&self, m: &mut JlModule, entry: * mut JlValue, d: i32, bits: u8) -> i32 {
         let mut refyoung = 0;
-        let mut table = unsafe {
-            slice::from_raw_parts_mut(m.bindings.table, m.bindings.size)
+        let b = unsafe {
+            JlBinding::from_jlvalue_mut(&mut *entry)
         };
+        gc_cache().setmark_buf(b.as_mut_jlvalue(), bits, mem::size_of::<JlBinding>());
+        let vb = as_mut_jltaggedvalue(b.as_mut_jlvalue());
+        verify_parent!("module", m.as_jlvalue(), &unsafe { mem::transmute(vb) }, "binding_buff");
+
+        if ! b.value.is_null() {
+            // a const binding cannot be rebound, so once its value is
+            // old-marked there is nothing left to trace behind it;
+            // skip the push_root call wholesale
+            let settled = b.constp() && ! get_gc_verifying() &&
+                unsafe { &*as_jltaggedvalue(b.value) }.tag() == GC_OLD_MARKED;
+            if ! settled {
+                verify_parent!("module", m.as_jlvalue(), &b.value, format!("binding({})", CStr::from_ptr(np_jl_symbol_name(b.name)).to_str().unwrap()));
+                refyoung |= self.push_root(b.value, d);
+            }
+        }
 
-        let mut i = 1;
+        if ! b.globalref.is_null() {
+            refyoung |= self.push_root(b.globalref, d);
+        }
 
-        while i < m.bindings.size {
-            if ! HTable::is_not_found(table[i]) {
-                let b = unsafe {
-                    JlBinding::from_jlvalue_mut(&mut *table[i])
-                };
-                gc_cache().setmark_buf(b.as_mut_jlvalue(), bits, mem::size_of::<JlBinding>());
-                let vb = as_mut_jltaggedvalue(b.as_mut_jlvalue());
-                verify_parent!("module", m.as_jlvalue(), &unsafe { mem::transmute(vb) }, "binding_buff");
+        refyoung
+    }
 
-                if ! b.value.is_null() {
-                    verify_parent!("module", m.as_jlvalue(), &b.value, format!("binding({})", CStr::from_ptr(np_jl_symbol_name(b.name)).to_str().unwrap()));
-                    refyoung |= self.push_root(b.value, d);
-                }
+    fn mark_module(&self, m: &mut JlModule, d: i32, bits: u8) -> i32 {
+        let mut refyoung = 0;
+
+        if m.bindings.size > MARK_CHUNK_SIZE {
+            // big tables (thousands of bindings) are striped across
+            // the mark workers like large pointer arrays; the stripes
+            // do their own remset bookkeeping (mark_binding_chunk)
+            self.queue_binding_chunks(m, bits);
+        } else {
+            let mut table = unsafe {
+                slice::from_raw_parts_mut(m.bindings.table, m.bindings.size)
+            };
+
+            let mut i = 1;
 
-                if ! b.globalref.is_null() {
-                    refyoung |= self.push_root(b.globalref, d);
+            while i < m.bindings.size {
+                if ! HTable::is_not_found(table[i]) {
+                    refyoung |= self.mark_binding(m, table[i], d, bits);
                 }
-            }
 
-            i += 2;
+                i += 2;
+            }
         }
 
         for using in m.usings.as_slice_mut() {
@@ -1403,16 +2928,11 @@ impl Marking {
             &mut get_all_tls()[tid as usize]
         };
 
-        if stkbuf {
-            if cfg!(copy_stacks) {
-                gc_cache().setmark_buf(ta.stkbuf, bits, ta.bufsz);
-            } else {
-                if ta as * mut JlTask != ptls2.root_task {
-                    // TODO: give it to the corresponding thread?
-                    gc_cache().setmark_buf(ta.stkbuf, bits, ta.ssize);
-                }
-            }
+        if stkbuf && cfg!(copy_stacks) {
+            gc_cache().setmark_buf(ta.stkbuf, bits, ta.bufsz);
         }
+        // without copy_stacks the stack is not a gc buffer: task.c mmaps it
+        // and reclaims it through a pointer finalizer (see free_task_stack)
 
         if ta as * mut JlTask == ptls2.current_task {
             // TODO: give it to the corresponding thread?
@@ -1425,11 +2945,65 @@ impl Marking {
             } else {
                 (0, 0, usize::max_value())
             };
+            if STACK_CACHE.load(Ordering::Relaxed) {
+                self.mark_dormant_task_stack(ta, offset, lb, ub, d);
+                return;
+            }
             // TODO: give it to the corresponding thread?
             self.mark_rt_stack(ta.gcstack, offset, lb, ub, d);
         }
     }
 
+    /// Mark a suspended task's stack through the scan cache: replay
+    /// the roots recorded the last time this task was walked, or walk
+    /// the frames once and record what they hold. Sound because a
+    /// suspended stack is immutable and ctx_switch drops the entry
+    /// before the task runs again.
+    fn mark_dormant_task_stack(&self, ta: &mut JlTask, offset: usize, lb: usize, ub: usize, d: i32) {
+        let key = ta as * mut JlTask as usize;
+        {
+            let cache = unsafe { TASK_SCAN_CACHE.as_ref().unwrap() };
+            if let Some(roots) = cache.lock().unwrap().get(&key) {
+                for v in roots.iter() {
+                    self.push_root(*v as * mut libc::c_void, d);
+                }
+                return;
+            }
+        }
+        // same walk as mark_rt_stack, recording every root it pushes
+        let mut roots: Vec<usize> = Vec::new();
+        let mut s = ta.gcstack;
+        while ! s.is_null() {
+            let nroots = unsafe {
+                Marking::read_rt_stack(&mut (&mut *s).nroots, offset, lb, ub)
+            };
+            let nr = nroots >> 1;
+            let rts = unsafe {
+                slice::from_raw_parts_mut((s as * mut * mut libc::c_void).offset(2) as * mut * mut * mut JlValue, nr)
+            };
+            for i in 0..nr {
+                let obj: * mut libc::c_void = unsafe {
+                    if nroots & 1 != 0 {
+                        // stack is indirected
+                        let slot: * mut * mut libc::c_void = mem::transmute(Marking::read_rt_stack(&mut rts[i], offset, lb, ub));
+                        mem::transmute(Marking::read_rt_stack(slot, offset, lb, ub))
+                    } else {
+                        mem::transmute(Marking::read_rt_stack(&mut rts[i], offset, lb, ub))
+                    }
+                };
+                if ! obj.is_null() {
+                    roots.push(obj as usize);
+                    self.push_root(obj, d);
+                }
+            }
+            unsafe {
+                s = mem::transmute(Marking::read_rt_stack(&mut (*s).prev, offset, lb, ub));
+            }
+        }
+        let cache = unsafe { TASK_SCAN_CACHE.as_ref().unwrap() };
+        cache.lock().unwrap().insert(key, roots);
+    }
+
     fn mark_object_list(&self, list: * mut JlArrayList, start: usize) {
         let l = unsafe { &mut *list };
         let len = l.len;
@@ -1472,11 +3046,38 @@ pub struct Gc2<'a> {
     tls: &'static mut JlTLS, // we are lying to Rust right now, we will use this in an unsafe manner
     tid: i16, // ID of the owning thread
     // Data structure for marking part of the GC
-    pub marking: Marking
+    pub marking: Marking,
+    // Per-thread allocation accounting. The allocation fast paths bump
+    // these with plain stores; the collector folds them into the shared
+    // gc_num block at pause time (finish_collection) so the hot path
+    // never touches a cache line another thread writes. num_allocd is
+    // this thread's pacing debt and, like gc_num.allocd, starts one
+    // collect interval in the red.
+    pub num_allocd: i64,
+    pub num_poolalloc: u64,
+    pub num_bigalloc: u64,
+    // How often the runtime crosses the C/Rust boundary into this
+    // thread's collector, by entry-point family; bumped with plain
+    // stores by the c_interface shims and snapshotted into the shared
+    // stats block so boundary-batching work can be prioritized by
+    // data. Cheap enough to always leave on.
+    pub ffi_queue_root: u64,
+    pub ffi_alloc_slow: u64,
+    pub ffi_remset_sync: u64,
+    // per-size pool allocation histogram, 16-byte buckets (entry i
+    // counts requests of (16i, 16(i+1)] bytes); summed into the shared
+    // stats block at pause time and reported at exit, so size-class
+    // tables can be fitted to the measured workload
+    pub alloc_hist: [u64; SZCLASS_TABLE_LEN],
 }
 
 impl<'a> Gc2<'a> {
     pub fn new(tls: &'static mut JlTLS) -> Self {
+       // make sure no stale bump spans leak in from the C side
+       for i in 0..GC_N_POOLS {
+           tls.gc_pool_cur[i] = ::std::ptr::null_mut();
+           tls.gc_pool_end[i] = ::std::ptr::null_mut();
+       }
        Gc2 {
            heap: ThreadHeap::new(),
            cache: MarkCache::new(),
@@ -1484,6 +3085,13 @@ impl<'a> Gc2<'a> {
            tid: tls.tid,
            tls: tls,
            marking: Marking::new(),
+           num_allocd: unsafe { -(gc_num.interval as i64) },
+           num_poolalloc: 0,
+           num_bigalloc: 0,
+           ffi_queue_root: 0,
+           ffi_alloc_slow: 0,
+           ffi_remset_sync: 0,
+           alloc_hist: [0; SZCLASS_TABLE_LEN],
         }
     }
 
@@ -1513,9 +3121,56 @@ impl<'a> Gc2<'a> {
             // Set type of v. we are the only owner so this is OK here.
             (*as_mut_jltaggedvalue(v)).yolo_set_header(typ as usize);
         }
+        if ALLOC_PROFILE_EVERY.load(Ordering::Relaxed) != 0 {
+            Gc2::sample_fill_type(&*v, typ);
+        }
         v
     }
 
+    /// Record every Nth allocation when the sampling profiler is on.
+    /// Out of line so the allocation fast paths only pay the counter
+    /// load.
+    #[inline(never)]
+    fn sample_alloc(v: * const JlValue, size: usize) {
+        let every = ALLOC_PROFILE_EVERY.load(Ordering::Relaxed);
+        if every == 0 {
+            return;
+        }
+        if ALLOC_PROFILE_TICK.fetch_add(1, Ordering::Relaxed) % every != 0 {
+            return;
+        }
+        let mut frames = [0usize; ALLOC_PROFILE_MAX_FRAMES];
+        let n = unsafe {
+            rec_backtrace(frames.as_mut_ptr(), ALLOC_PROFILE_MAX_FRAMES)
+        };
+        LAST_SAMPLE_ADDR.store(v as usize, Ordering::Relaxed);
+        if let Some(profile) = unsafe { ALLOC_PROFILE.as_ref() } {
+            profile.lock().unwrap().push(AllocSample {
+                size: size,
+                typ: 0, // filled by `alloc` once it tags the header
+                addr: v as usize,
+                frames: frames[..n].to_vec(),
+            });
+        }
+    }
+
+    /// The allocator can't see the type -- callers tag the header
+    /// after it returns -- so `alloc` calls back here with the type it
+    /// just wrote, and we attach it if its object was the last sample.
+    fn sample_fill_type(v: * const JlValue, typ: * const libc::c_void) {
+        if LAST_SAMPLE_ADDR.swap(0, Ordering::Relaxed) != v as usize {
+            return;
+        }
+        if let Some(profile) = unsafe { ALLOC_PROFILE.as_ref() } {
+            let mut samples = profile.lock().unwrap();
+            if let Some(s) = samples.last_mut() {
+                if s.addr == v as usize {
+                    s.typ = typ as usize;
+                }
+            }
+        }
+    }
+
     // Semi-equivalent(?) to: julia/src/gc.c:jl_gc_pool_alloc
     pub fn pool_alloc(&mut self, size: usize) -> &mut JlValue {
         let osize = size - mem::size_of::<JlTaggedValue>();
@@ -1526,11 +3181,10 @@ impl<'a> Gc2<'a> {
             return self.big_alloc(size);
         }
 
-        unsafe {
-            // Julia's GC also doesn't use atomic increments for this. TODO: maybe switch to atomic increments
-            *gc_num.allocd.get_mut() += size as i64;
-        }
-        if unsafe { intrinsics::unlikely(unsafe { *gc_num.allocd.get_mut() } > 0) || debug_check_pool() } {
+        // plain store on a thread-local counter; folded into gc_num at
+        // pause time so threads never share the allocation cache line
+        self.num_allocd += size as i64;
+        if unsafe { intrinsics::unlikely(self.num_allocd > 0) || debug_check_pool() } {
             if ! (cfg!(feature="run_only_once") && GC_ALREADY_RUN.load(Ordering::SeqCst)) {
                 // println!("triggering periodic collection");
                 unsafe {
@@ -1543,9 +3197,11 @@ impl<'a> Gc2<'a> {
             }
         }
 
-        unsafe {
-            gc_num.poolalloc += 1;
-        }
+        self.num_poolalloc += 1;
+        // thread-local histogram bump, same plain-store discipline as
+        // the pacing counters above
+        self.alloc_hist[cmp::min(osize.saturating_sub(1) >> 4,
+                                 SZCLASS_TABLE_LEN - 1)] += 1;
 
         let v = match self.find_pool(&osize) {
             Some(pool_index) => {
@@ -1555,36 +3211,24 @@ impl<'a> Gc2<'a> {
                 // We are not using newpages and adding new pages to freelist for now.
                 // We can implement newpages as an optimization later on.
                 // TODO: do extra bookkeeping about marking pagemetas etc.
-                if let Some(v) = self.heap.pools[pool_index].freelist.pop() {
-                    let pool = &self.heap.pools[pool_index];
-                    let meta = unsafe {
-                        pg_mgr().find_pagemeta(v).unwrap()
-                    };
-                    // just a sanity check:
-                    debug_assert_eq!(meta.osize as usize, pool.osize);
-                    *meta.has_young.get_mut() = true;
-                    meta.nfree -= 1;
-                    /*
-                    if let Some(next) = pool.freelist.last() {
-                        unsafe { // this unsafe is here because `unlikely` is marked unsafe in Rust
-                            if intrinsics::unlikely(Page::of(v) != Page::of(next)) {
-                                meta.nfree = 0;
-                            }
-                        }
-                    }
-                    */
+                if let Some(v) = self.bump_alloc(pool_index) {
+                    // span cells were pre-charged to num_allocd when
+                    // the span was installed, undo the per-call charge
+                    // from above so they aren't counted twice
+                    self.num_allocd -= size as i64;
+                    v
+                } else if let Some(v) = self.magazine_alloc(pool_index) {
+                    // page metadata was already updated in batch when
+                    // the magazine was refilled
+                    v
+                } else if let Some(v) = self.lazy_sweep_alloc(pool_index) {
+                    // the cell came off a page we just swept on demand
                     v
                 } else {
                     self.add_page(pool_index);
-                    let ref mut pool = self.heap.pools[pool_index];
-                    let v = pool.freelist.pop().unwrap();
-                    let meta = unsafe {
-                        pg_mgr().find_pagemeta(v).unwrap()
-                    };
-                    // just a sanity check:
-                    debug_assert_eq!(meta.osize as usize, pool.osize);
-                    *meta.has_young.get_mut() = true;
-                    meta.nfree -= 1;
+                    let v = self.bump_alloc(pool_index)
+                        .expect("add_page must install a non-empty bump span");
+                    self.num_allocd -= size as i64; // see above
                     v
                 }
             },
@@ -1593,7 +3237,9 @@ impl<'a> Gc2<'a> {
                 panic!(format!("Allocation error: object size {} is too large for pool", size));
             }
         };
-        jl_value_of_mut(v)
+        let v = jl_value_of_mut(v);
+        Gc2::sample_alloc(&*v, size);
+        v
     }
 
     fn add_page(&mut self, poolIndex: usize) {
@@ -1612,39 +3258,147 @@ impl<'a> Gc2<'a> {
         // set up page meta
         let pool = &mut self.heap.pools[poolIndex];
         meta.osize = pool.osize as u16;
-        meta.thread_n = self.tid as u16;
-        /* TODO: enable later on!
-        meta.data = Some(&mut page.data);
-         */
-        let (size, padding) = meta.reset(poolIndex as u8);
-
-        // add objects to freelist
-        // pool.freelist.reserve(meta.nfree as usize);
+        region.meta_cold[i] = PageMetaCold {
+            data: page.data.as_mut_ptr(),
+            thread_n: self.tid as u16,
+            pool_n: poolIndex as u8,
+        };
+        let (size, padding) = meta.reset();
+
+        // hand the whole page to this thread's bump span rather than
+        // pushing cells to the freelist, so both codegen's inline fast
+        // path and pool_alloc can bump-allocate from it. we still clear
+        // the tags since recycled pages may carry stale headers -
+        // unless the page is known zeroed (fresh mapping, or wiped by
+        // the background zeroer), in which case the tags already read
+        // as zero and the walk over the page is pure cost.
         // println!("object size: {}, computed size: {}, # free objects: {}", meta.osize, size, meta.nfree);
-        for i in 0..(meta.nfree as usize) {
-            let v: &mut JlTaggedValue = unsafe {
-                mem::transmute(&mut page.data[i * (size + padding) + GC_PAGE_OFFSET])
+        if meta.zeroed {
+            meta.zeroed = false;
+        } else {
+            for i in 0..(meta.nfree as usize) {
+                let v: &mut JlTaggedValue = unsafe {
+                    mem::transmute(&mut page.data[i * (size + padding) + GC_PAGE_OFFSET])
+                };
+                v.set_tag(0);
+            }
+        }
+        *meta.has_young.get_mut() = true;
+        let begin = unsafe {
+            page.data.as_mut_ptr().offset(GC_PAGE_OFFSET as isize)
+        };
+        self.tls.gc_pool_cur[poolIndex] = begin;
+        self.tls.gc_pool_end[poolIndex] = unsafe {
+            begin.offset((meta.nfree as usize * (size + padding)) as isize)
+        };
+        // pre-charge the whole span so the inline fast path doesn't
+        // have to maintain the allocation counter per object
+        self.num_allocd += (meta.nfree as usize * meta.osize as usize) as i64;
+    }
+
+    /// Take one cell from the bump span that codegen's inline
+    /// allocation fast path also allocates from. Returns `None` if the
+    /// span for this size class is exhausted (or was never installed).
+    #[inline(always)]
+    fn bump_alloc(&mut self, pool_index: usize) -> Option<&'a mut JlTaggedValue> {
+        let cur = self.tls.gc_pool_cur[pool_index];
+        if cur.is_null() {
+            return None;
+        }
+        let size = mem::size_of::<JlTaggedValue>() + self.heap.pools[pool_index].osize;
+        let stride = llt_align(size, JL_SMALL_BYTE_ALIGNMENT);
+        let next = unsafe { cur.offset(stride as isize) };
+        if next > self.tls.gc_pool_end[pool_index] {
+            return None;
+        }
+        self.tls.gc_pool_cur[pool_index] = next;
+        Some(unsafe { mem::transmute(cur) })
+    }
+
+    /// Demand sweep for lazy-sweep mode: sweep pages queued on this
+    /// pool during the last pause until its freelist has cells again,
+    /// then allocate from the magazine. Returns `None` once there is
+    /// nothing left to sweep (always, when lazy sweeping is off).
+    fn lazy_sweep_alloc(&mut self, pool_index: usize) -> Option<&'a mut JlTaggedValue> {
+        let full = LAZY_SWEEP_FULL.load(Ordering::SeqCst);
+        loop {
+            let (ri, pg_idx) = match self.heap.pools[pool_index].lazy_pages.pop() {
+                Some(p) => p,
+                None => return None,
             };
-            v.set_tag(0);
-            pool.freelist.push(v);
+            let regions = unsafe { REGIONS.as_mut().unwrap() };
+            if ! regions[ri].meta[pg_idx].needs_sweep {
+                continue; // already swept by the pre-mark catch-up
+            }
+            let freed = Gc2::sweep_pool_page(&mut regions[ri], pg_idx, full);
+            unsafe {
+                // same non-atomic update as the eager sweep
+                gc_num.freed += freed as i64;
+            }
+            if ! self.heap.pools[pool_index].freelist.is_empty() {
+                return self.magazine_alloc(pool_index);
+            }
+            // the page was either fully live or fully dead (and got
+            // returned to the page manager), try the next one
+        }
+    }
+
+    /// Take one cell from the pool's magazine, refilling it from the
+    /// freelist in a batch if it is empty. Returns `None` only if the
+    /// freelist is exhausted as well.
+    #[inline(always)]
+    fn magazine_alloc(&mut self, pool_index: usize) -> Option<&'a mut JlTaggedValue> {
+        if let Some(v) = self.heap.pools[pool_index].magazine.pop() {
+            return Some(v);
+        }
+        self.refill_magazine(pool_index);
+        self.heap.pools[pool_index].magazine.pop()
+    }
+
+    /// Move up to `MAGAZINE_SIZE` cells from the freelist into the
+    /// magazine in one go, so page metadata is updated once per page
+    /// run rather than once per allocation.
+    fn refill_magazine(&mut self, pool_index: usize) {
+        let ref mut pool = self.heap.pools[pool_index];
+        let mut last_page: * const u8 = ::std::ptr::null();
+        let mut meta: * mut PageMeta = ::std::ptr::null_mut();
+        for _ in 0..MAGAZINE_SIZE {
+            if let Some(v) = pool.freelist.pop() {
+                let cur_page = Page::of(&*v);
+                if cur_page != last_page {
+                    // freelists are built page by page, so consecutive
+                    // cells usually share a page and this lookup is
+                    // amortized over the whole run
+                    meta = unsafe {
+                        pg_mgr().find_pagemeta::<JlTaggedValue>(&*v).unwrap() as * mut PageMeta
+                    };
+                    unsafe {
+                        // just a sanity check:
+                        debug_assert_eq!((*meta).osize as usize, pool.osize);
+                        *(*meta).has_young.get_mut() = true;
+                    }
+                    last_page = cur_page;
+                }
+                unsafe {
+                    (*meta).nfree -= 1;
+                }
+                pool.magazine.push(v);
+            } else {
+                break;
+            }
         }
     }
 
     pub fn find_pool(&self, size: &usize) -> Option<usize> {
-        if *size > GC_MAX_SZCLASS {
+        let sz = *size;
+        if sz > GC_MAX_SZCLASS {
             return None;
         }
-        GC_SIZE_CLASSES.binary_search(size)
-            .map(|i| {
-                Some(i)
-            })
-            .unwrap_or_else(|i| {
-                if i >= GC_SIZE_CLASSES.len() {
-                    None
-                } else {
-                    Some(i)
-                }
-            })
+        if sz <= 8 {
+            return Some(0);
+        }
+        // table lookup instead of a binary search; see init_szclass_table
+        Some(unsafe { neptune_szclass_table[(sz - 1) >> 4] as usize })
     }
 
     /// Allocate a big object with given size, including object tag (i.e. tagged type pointer).
@@ -1654,15 +3408,36 @@ impl<'a> Gc2<'a> {
         self.maybe_collect();
         let rawsz = mem::size_of::<BigVal>().checked_add(size)
             .expect(& format!("Cannot allocate a BigVal with size {} on this architecture", size));
-        // align size to cache byte alignment
-        let allocsz = llt_align(rawsz, JL_CACHE_BYTE_ALIGNMENT);
+        // align size to cache byte alignment; chunks past the hugepage
+        // threshold round up to whole hugepages instead
+        let mut allocsz = llt_align(rawsz, JL_CACHE_BYTE_ALIGNMENT);
+        if unsafe { intrinsics::unlikely(bigval_is_huge(allocsz)) } {
+            allocsz = llt_align(allocsz, HUGE_PAGE_SZ);
+        }
 
         if unsafe { intrinsics::unlikely(rawsz < size) } {
             panic!(format!("BigVal with size {} is too big to align to cache and use on this architecture", size));
         }
 
         let (bv, tv) = unsafe {
-            let ptr = self.rust_alloc::<BigVal>(allocsz);
+            // consult the free-chunk cache before going to the system
+            // allocator; hot loops allocate and drop the same handful
+            // of array sizes over and over
+            let ptr = match self.heap.bigval_cache.take(allocsz) {
+                Some((cap, chunk)) => {
+                    (*chunk).set_capacity(cap);
+                    chunk
+                }
+                None => {
+                    let ptr = if bigval_is_huge(allocsz) {
+                        Gc2::rust_alloc_huge::<BigVal>(allocsz)
+                    } else {
+                        self.rust_alloc::<BigVal>(allocsz)
+                    };
+                    (*ptr).set_capacity(allocsz);
+                    ptr
+                }
+            };
             (*ptr).tid = self.tid;
             (*ptr).in_list = true;
             (*ptr).slot = self.heap.big_objects.len();
@@ -1672,18 +3447,21 @@ impl<'a> Gc2<'a> {
             (&mut *ptr, taggedvalue)
         };
 
-        // update stats
-        unsafe {
-            gc_num.allocd.fetch_add(allocsz as i64, Ordering::SeqCst);
-            gc_num.bigalloc += 1;
-        }
+        // update stats (thread-local, folded into gc_num at pause time)
+        self.num_allocd += allocsz as i64;
+        self.num_bigalloc += 1;
 
         if cfg!(feature="memdebug") {
             // TODO: fill bigval with 0xEE
         }
 
         self.heap.big_objects.push(bv);
-        jl_value_of_mut(tv)
+        unsafe {
+            neptune_probe_big_alloc(allocsz);
+        }
+        let v = jl_value_of_mut(tv);
+        Gc2::sample_alloc(&*v, allocsz);
+        v
     }
 
     pub unsafe fn rust_alloc<T>(&mut self, size: usize) -> * mut T {
@@ -1701,16 +3479,53 @@ impl<'a> Gc2<'a> {
         alloc::heap::deallocate(mem::transmute::<* mut T, * mut u8>(ptr), size, 8);
     }
 
+    /// Hugepage-aligned allocation for big objects past the
+    /// NEPTUNE_HUGEPAGES_BIG threshold; the chunk is advised
+    /// MADV_HUGEPAGE so the kernel can back it with 2MB pages. This is
+    /// only advice, so we don't care whether it succeeds.
+    pub unsafe fn rust_alloc_huge<T>(size: usize) -> * mut T {
+        debug_assert_eq!(size % HUGE_PAGE_SZ, 0);
+        let ptr = alloc::heap::allocate(size, HUGE_PAGE_SZ);
+        if ptr.is_null() {
+            panic!("GC error: out of memory (OOM)!");
+        }
+        libc::madvise(ptr as * mut libc::c_void, size, libc::MADV_HUGEPAGE);
+        BIG_HUGEPAGE_BYTES.fetch_add(size, Ordering::Relaxed);
+        mem::transmute(ptr)
+    }
+
+    /// Release a big-object chunk with the alignment big_alloc used
+    /// for it; capacity alone identifies hugepage-backed chunks (see
+    /// BIG_THP_MIN).
+    pub unsafe fn rust_free_big(ptr: * mut BigVal, capacity: usize) {
+        if bigval_is_huge(capacity) {
+            BIG_HUGEPAGE_BYTES.fetch_sub(capacity, Ordering::Relaxed);
+            alloc::heap::deallocate(ptr as * mut u8, capacity, HUGE_PAGE_SZ);
+        } else {
+            Gc2::rust_free(ptr, capacity);
+        }
+    }
+
     // keep track of array with malloc'd storage
     pub fn track_malloced_array(&mut self, a: * mut JlArray) {
         // N.B. This is *NOT* a GC safepoint due to heap mutation!!!
         debug_assert_eq!(unsafe { (*a).flags.how() }, AllocStyle::MallocBuffer);
-        self.heap.mallocarrays.push(MallocArray::new(a));
+        self.heap.mallocarrays.push(a);
     }
 
     #[inline(always)]
     pub fn maybe_collect(&mut self) -> bool {
-        if unsafe { intrinsics::unlikely(unsafe { *gc_num.allocd.get_mut() } > 0) || debug_check_pool() } {
+        if unsafe { intrinsics::unlikely(MEM_PRESSURE.load(Ordering::Relaxed)) } {
+            // the container is near its memory limit: collect
+            // everything now and give pages back rather than waiting
+            // out the allocation interval
+            MEM_PRESSURE.store(false, Ordering::SeqCst);
+            unsafe {
+                jl_gc_collect(1);
+            }
+            return true;
+        }
+        if unsafe { intrinsics::unlikely(self.num_allocd > 0) || debug_check_pool() } {
             if ! (cfg!(feature="run_only_once") && GC_ALREADY_RUN.load(Ordering::SeqCst)) {
                 // println!("triggering periodic collection");
                 unsafe {
@@ -1727,7 +3542,7 @@ impl<'a> Gc2<'a> {
 
     pub fn collect(&mut self, full: bool) -> bool {
         let t0 = neptune_hrtime();
-        let last_perm_scanned_bytes = unsafe { perm_scanned_bytes } as i64;
+        trace_event(EV_GC_BEGIN, self.tid as u16, full as u64, 0);
 
         Gc2::verify_remsets();
 
@@ -1737,21 +3552,104 @@ impl<'a> Gc2<'a> {
             }
         }
 
-        // 1. fix GC bits of objects in the memset (a.k.a. premark)
-        for t in unsafe { get_all_tls() } {
-            let tl_gc = unsafe { &mut * t.tl_gcs };
-            tl_gc.premark();
+        self.prepare_mark();
+
+        // a full collection rescans and re-records every task stack
+        if full && STACK_CACHE.load(Ordering::Relaxed) {
+            task_stack_cache_clear();
         }
 
         // walk the roots
+        unsafe {
+            jl_timing_gc_phase_start(TIMING_GC_MARK);
+        }
         self.marking.walk_roots();
+        unsafe {
+            jl_timing_gc_phase_stop(TIMING_GC_MARK);
+        }
+
+        let mark_ns = neptune_hrtime() - t0;
+        unsafe {
+            MARK_PAUSE_HIST.record(mark_ns);
+            LAST_MARK_NS = mark_ns;
+        }
+        trace_event(EV_MARK_END, self.tid as u16, mark_ns, 0);
+
+        self.finish_collection(full, t0)
+    }
+
+    /// Everything that has to happen before any object is marked:
+    /// settle outstanding background/lazy work, fold the deferred
+    /// write-barrier records into the remsets and premark them. Runs
+    /// with the world stopped.
+    fn prepare_mark(&mut self) {
+        // wait out the background finalizer thread: objects handed to
+        // it were only kept alive through one sweep, so their memory
+        // must not be reclaimed while calls are still pending
+        while NATIVE_FINALIZERS_PENDING.load(Ordering::SeqCst) != 0 {
+            thread::yield_now();
+        }
+
+        // likewise the background reclaimer: its records are dead
+        // memory either way, but the pacer's freed accounting assumes
+        // the previous epoch has actually been returned by now
+        while BG_FREE_PENDING.load(Ordering::SeqCst) != 0 {
+            thread::yield_now();
+        }
+
+        // pay off leftover lazy-sweep debt before touching any mark bits
+        self.finish_lazy_sweep();
+
+        unsafe {
+            jl_timing_gc_phase_start(TIMING_GC_REMSET);
+        }
+
+        // the world is stopped, drain every thread's write-barrier log
+        // into the remset it shadows before the remsets are consumed
+        Gc2::flush_wb_logs();
+
+        // in card-table mode the remembered objects live in the card
+        // tables; expand them into the remsets premark is about to read
+        if CARD_TABLE.load(Ordering::SeqCst) {
+            Gc2::sweep_dirty_cards();
+        }
+
+        // 1. fix GC bits of objects in the memset (a.k.a. premark)
+        for t in unsafe { get_all_tls() } {
+            let tl_gc = unsafe { &mut * t.tl_gcs };
+            tl_gc.premark();
+        }
 
         unsafe {
+            jl_timing_gc_phase_stop(TIMING_GC_REMSET);
+        }
+    }
+
+    /// The post-mark half of a collection: finalizers, the sweep
+    /// decision, the sweep itself and stats. `t0` is when the cycle's
+    /// first pause began. Returns whether the caller should collect
+    /// again (full collections are restarted as quick ones).
+    fn finish_collection(&mut self, full: bool, t0: u64) -> bool {
+        unsafe {
+            // fold the per-thread counters into the shared block now
+            // that the world is stopped; each thread's num_allocd sits
+            // one interval in the red, so adding the interval back
+            // yields the bytes it actually allocated
+            for t in get_all_tls() {
+                let g = &mut * t.tl_gcs;
+                *gc_num.allocd.get_mut() += g.num_allocd + gc_num.interval as i64;
+                g.num_allocd = - (gc_num.interval as i64); // re-armed again in writeback_stats
+                gc_num.poolalloc += g.num_poolalloc;
+                g.num_poolalloc = 0;
+                gc_num.bigalloc += g.num_bigalloc;
+                g.num_bigalloc = 0;
+            }
             // this is deliberately not thread-safe
             gc_num.since_sweep += (*gc_num.allocd.get_mut() + gc_num.interval as i64) as u64;
         }
 
         neptune_gc_settime_premark_end();
+        Gc2::publish_stats(); // gc_time_mark_pause reads the shared block
         neptune_gc_time_mark_pause(t0, unsafe { scanned_bytes }, unsafe { perm_scanned_bytes }); // TODO
 
         let actual_allocd = unsafe { gc_num.since_sweep } as i64;
@@ -1762,11 +3660,13 @@ impl<'a> Gc2<'a> {
             finalizer_list_marked.len
         };
 
-        for t in unsafe { get_all_tls() } {
-            let tl_gc = unsafe { &mut * t.tl_gcs };
-            Gc2::sweep_finalizer_list(&mut t.finalizers); // these are confusingly called `sweep_finalizer_list`
+        unsafe {
+            jl_timing_gc_phase_start(TIMING_GC_FINALIZERS);
         }
 
+        // these are confusingly called `sweep_finalizer_list`
+        Gc2::sweep_finalizer_tables();
+
         if unsafe { prev_sweep_full } != 0 {
             unsafe {
                 Gc2::sweep_finalizer_list(&mut finalizer_list_marked);
@@ -1777,11 +3677,26 @@ impl<'a> Gc2<'a> {
         // mark finalizers
         self.marking.mark_finalizers(orig_marked_len);
 
+        // hand this cycle's native finalizers to the background
+        // thread; this only does queue pushes, the calls themselves
+        // happen after the world restarts
+        Gc2::dispatch_native_finalizers();
+
+        unsafe {
+            jl_timing_gc_phase_stop(TIMING_GC_FINALIZERS);
+        }
+
         neptune_gc_settime_postmark_end();
 
         Gc2::verify_to_finalize();
 
+        unsafe {
+            jl_timing_gc_phase_start(TIMING_GC_SYNC);
+        }
         self.sync_caches();
+        unsafe {
+            jl_timing_gc_phase_stop(TIMING_GC_SYNC);
+        }
 
         let live_sz_ub: i64 = unsafe {
             live_bytes + actual_allocd
@@ -1791,6 +3706,14 @@ impl<'a> Gc2<'a> {
         };
         let estimate_freed: i64 = live_sz_ub - live_sz_est;
 
+        // marked bytes over the mark pause, for Base's gc_num()
+        unsafe {
+            if LAST_MARK_NS > 0 {
+                gc_num.mark_rate = (live_sz_est as u64)
+                    .saturating_mul(1_000_000_000) / LAST_MARK_NS;
+            }
+        }
+
         self.verify();
 
         // TODO: call gc_stats.*
@@ -1810,11 +3733,13 @@ impl<'a> Gc2<'a> {
 
         // if there are many intergenerational pointers then quick (not full, only young gen) sweep is not so quick
         let large_frontier = nptr * mem::size_of::<* mut libc::c_void>() >= DEFAULT_COLLECT_INTERVAL as usize;
+        // the adaptive pacer may have asked for a major collection
+        let pace_full = PACE_WANTS_FULL.swap(false, Ordering::Relaxed);
         let mut sweep_full = false;
         let mut recollect = false;
 
         unsafe {
-            if (full || large_frontier ||
+            if (full || large_frontier || pace_full ||
                 ((not_freed_enough || promoted_bytes >= gc_num.interval as i64) &&
                  (promoted_bytes >= DEFAULT_COLLECT_INTERVAL as i64 || prev_sweep_full != 0)) ||
                 gc_check_heap_size(live_sz_ub, live_sz_est) != 0) &&
@@ -1855,8 +3780,30 @@ impl<'a> Gc2<'a> {
 
         // println!("collection decisions: sweep_full = {}, recollect = {}", sweep_full, recollect);
 
+        unsafe {
+            gc_num.promoted += cmp::max(promoted_bytes, 0) as u64;
+        }
+        trace_event(EV_PROMOTED, self.tid as u16,
+                    cmp::max(unsafe { promoted_bytes }, 0) as u64, 0);
+
         // sweep
+        let t_sweep = neptune_hrtime();
+        trace_event(EV_SWEEP_BEGIN, self.tid as u16, sweep_full as u64, 0);
+        unsafe {
+            jl_timing_gc_phase_start(TIMING_GC_SWEEP);
+        }
         self.sweep(sweep_full);
+        unsafe {
+            jl_timing_gc_phase_stop(TIMING_GC_SWEEP);
+        }
+        let sweep_ns = neptune_hrtime() - t_sweep;
+        unsafe {
+            SWEEP_PAUSE_HIST.record(sweep_ns);
+        }
+        trace_event(EV_SWEEP_END, self.tid as u16, sweep_ns, 0);
+
+        Gc2::sample_verify();
+        Gc2::publish_stats(); // post-sweep remset state for readers between pauses
 
         // writeback stats
         self.writeback_stats(t0, sweep_full, recollect, actual_allocd, estimate_freed);
@@ -1864,6 +3811,90 @@ impl<'a> Gc2<'a> {
         recollect
     }
 
+    /// Initial pause of a concurrent cycle: snapshot the remsets and
+    /// queue the roots, then publish the mark queue so the background
+    /// marker and the shading barrier can reach it. The world restarts
+    /// right after this returns.
+    pub fn concurrent_mark_initial(&mut self) {
+        unsafe {
+            CONC_T0 = neptune_hrtime();
+        }
+        trace_event(EV_GC_BEGIN, self.tid as u16, 0, 1); // b = concurrent cycle
+
+        Gc2::verify_remsets();
+
+        self.prepare_mark();
+        self.marking.queue_roots();
+
+        CONC_TARGET.store(&self.marking as * const Marking as usize, Ordering::SeqCst);
+        unsafe {
+            neptune_mark_active = 1;
+        }
+        CONC_STATE.store(CONC_MARKING, Ordering::SeqCst);
+        // wake the parked marker; taking the lock around the notify
+        // closes the race with its state recheck
+        if let Some(&(ref lock, ref cv)) = unsafe { CONC_PARK.as_ref() } {
+            let _guard = lock.lock().unwrap();
+            cv.notify_one();
+        }
+    }
+
+    /// Shade an object the write barrier caught being stored into an
+    /// already-marked one while the concurrent marker runs: mark it
+    /// and queue it so its children get traced. Incremental-update
+    /// flavor -- we intercept the new edge, not the overwritten one.
+    pub fn shade(&mut self, v: * mut JlValue) {
+        let target = CONC_TARGET.load(Ordering::SeqCst);
+        if target == 0 {
+            return; // cycle already past the marking phase
+        }
+
+        let o = unsafe {
+            &mut *as_mut_jltaggedvalue(v)
+        };
+        let tag = unsafe { o.yolo_header() };
+
+        if ! tag.marked() {
+            let mut bits: u8 = 0;
+            unsafe {
+                if intrinsics::likely(Marking::setmark_tag(o, GC_MARKED, tag, &mut bits) && ! get_gc_verifying()) {
+                    self.cache.setmark_pool(o, bits);
+                }
+                (&*(target as * const Marking)).queue(v);
+            }
+        }
+    }
+
+    /// Final pause of a concurrent cycle: cut off the shading barrier,
+    /// rescan the roots and whatever the barriers remembered since the
+    /// initial pause, drain to termination and run the collection tail
+    /// (finalizers, sweep, stats). Always a quick sweep; full
+    /// collections take the stop-the-world path instead.
+    pub fn concurrent_mark_final(&mut self) -> bool {
+        unsafe {
+            neptune_mark_active = 0;
+        }
+        CONC_TARGET.store(0, Ordering::SeqCst);
+
+        // pick up barrier records that accumulated during marking
+        Gc2::flush_wb_logs();
+        if CARD_TABLE.load(Ordering::SeqCst) {
+            Gc2::sweep_dirty_cards();
+        }
+
+        for t in unsafe { get_all_tls() } {
+            let tl_gc = unsafe { &mut * t.tl_gcs };
+            self.marking.mark_concurrent_remset(tl_gc);
+            self.marking.mark_thread_local(tl_gc);
+        }
+        self.marking.mark_roots();
+        self.marking.visit_mark_stack();
+
+        CONC_STATE.store(CONC_IDLE, Ordering::SeqCst);
+
+        self.finish_collection(false, unsafe { CONC_T0 })
+    }
+
     fn sync_cache(&mut self, cache: &mut MarkCache) {
         unsafe {
             cache.sync_cache_nolock(&mut self.heap.big_objects, self.tid);
@@ -1880,9 +3911,16 @@ impl<'a> Gc2<'a> {
             self.sync_cache(&mut tl_gc.cache);
         }
 
-        for cache in unsafe { mark_caches.as_mut().unwrap().values_mut() } {
+        let mut caches = unsafe { mark_caches.as_ref().unwrap().lock().unwrap() };
+        for cache in caches.iter_mut() {
             self.sync_cache(cache);
         }
+
+        // compact across caches too: different workers can deliver the
+        // same hot old object, and every duplicate left here gets
+        // re-marked on each following quicksweep
+        self.heap.remset.sort();
+        self.heap.remset.dedup();
     }
 
     fn unlink_big_object(b: &mut BigVal) {
@@ -1929,17 +3967,93 @@ impl<'a> Gc2<'a> {
         let pause = gc_end_t - t0;
         unsafe {
             gc_final_pause_end(t0, gc_end_t);
+            // for concurrent cycles this spans the whole cycle, like
+            // gc_num.total_time does
+            TOTAL_PAUSE_HIST.record(pause);
+            gc_num.pause_p50 = TOTAL_PAUSE_HIST.percentile(1, 2);
+            gc_num.pause_p90 = TOTAL_PAUSE_HIST.percentile(9, 10);
+            gc_num.pause_p99 = TOTAL_PAUSE_HIST.percentile(99, 100);
         }
+        trace_event(EV_GC_END, self.tid as u16, pause, full as u64);
         Gc2::time_sweep_pause(gc_end_t, actual_allocd, estimate_freed, full);
+        Gc2::pace_tick(gc_end_t, pause, actual_allocd, estimate_freed);
         unsafe {
             gc_num.full_sweep += full as libc::c_int;
             prev_sweep_full = full as libc::c_int;
             *gc_num.allocd.get_mut() = - (gc_num.interval as i64);
+            // re-arm the per-thread pacing counters with the interval
+            // the sweep decision (and pace_tick) just settled on
+            for t in get_all_tls() {
+                (&mut * t.tl_gcs).num_allocd = - (gc_num.interval as i64);
+            }
             live_bytes += gc_num.since_sweep as i64 - gc_num.freed;
             gc_num.pause += (! recollect) as libc::c_int;
             gc_num.total_time += pause;
             gc_num.since_sweep = 0;
             gc_num.freed = 0;
+            gc_num.big_hugepage_bytes = BIG_HUGEPAGE_BYTES.load(Ordering::Relaxed) as u64;
+        }
+    }
+
+    /// Fold a sample into one of the pacer's moving averages.
+    #[inline(always)]
+    fn ewma(cell: &AtomicUsize, sample: usize) -> usize {
+        let old = cell.load(Ordering::Relaxed);
+        let new = if old == 0 { sample } else { (old * 7 + sample) / 8 };
+        cell.store(new, Ordering::Relaxed);
+        new
+    }
+
+    /// One step of the adaptive pacer, run at the end of every cycle
+    /// after the static sweep decision already picked an interval.
+    /// Overrides gc_num.interval when NEPTUNE_PAUSE_TARGET_MS is set:
+    /// halve it while pauses overshoot the target, grow it while they
+    /// sit well under, and cap it at about a second's worth of
+    /// allocation so the averages keep tracking the load.
+    fn pace_tick(gc_end_t: u64, pause: u64, actual_allocd: i64, estimate_freed: i64) {
+        let target = PACE_TARGET_NS.load(Ordering::Relaxed) as u64;
+        if target == 0 {
+            return;
+        }
+
+        let pause_avg = Gc2::ewma(&PAUSE_EWMA_NS, pause as usize) as u64;
+
+        // allocation rate since the previous cycle ended, in bytes/sec
+        let last_end = unsafe { LAST_GC_END };
+        unsafe {
+            LAST_GC_END = gc_end_t;
+        }
+        let mut alloc_rate = 0;
+        if last_end != 0 && gc_end_t > last_end && actual_allocd > 0 {
+            let rate = (actual_allocd as u64).saturating_mul(1_000_000_000) / (gc_end_t - last_end);
+            alloc_rate = Gc2::ewma(&ALLOC_RATE_EWMA, rate as usize);
+        }
+
+        // survival of what was allocated since the last sweep; when
+        // most of it keeps surviving, quick sweeps only shovel the
+        // same bytes toward the old generation, so ask for a major
+        // collection to re-evaluate them
+        if actual_allocd > 0 {
+            let survived = cmp::max(actual_allocd - cmp::max(estimate_freed, 0), 0);
+            let pct = Gc2::ewma(&SURVIVAL_EWMA_PCT, (survived * 100 / actual_allocd) as usize);
+            if pct > 60 {
+                PACE_WANTS_FULL.store(true, Ordering::Relaxed);
+            }
+        }
+
+        let mut interval = unsafe { gc_num.interval };
+        if pause_avg > target {
+            interval /= 2;
+        } else if pause_avg < target / 2 {
+            interval += interval / 2;
+        }
+        if alloc_rate != 0 && interval > alloc_rate {
+            interval = alloc_rate;
+        }
+        interval = cmp::max(interval, DEFAULT_COLLECT_INTERVAL as usize / 8);
+        interval = cmp::min(interval, MAX_COLLECT_INTERVAL);
+        unsafe {
+            gc_num.interval = interval;
         }
     }
 
@@ -1957,17 +4071,93 @@ impl<'a> Gc2<'a> {
     }
 
 
+    // drain the C-side write-barrier logs into the per-thread remsets.
+    // Must run with the world stopped, before premark swaps the remsets.
+    fn flush_wb_logs() {
+        for t in unsafe { get_all_tls() } {
+            let n = t.gc_wb_log_len;
+            if n > 0 {
+                let tl_gc = unsafe { &mut * t.tl_gcs };
+                tl_gc.queue_logged_roots(&t.gc_wb_log[..n]);
+                t.gc_wb_log_len = 0;
+            }
+        }
+    }
+
+    // Expand the card tables into the per-thread remsets and clear
+    // them. Runs with the world stopped, before premark swaps the
+    // remsets; everything downstream (premark, remset marking, remset
+    // sweeping) is shared with the vector-remset mode. Cards only
+    // cover pool pages; bigvals never left the vectors.
+    fn sweep_dirty_cards() {
+        let regions = unsafe { REGIONS.as_mut().unwrap() };
+        let cards_per_page = PAGE_SZ / CARD_SZ;
+        for region in regions.iter_mut().take(REGIONS_HWM.load(Ordering::Relaxed)) {
+            if region.pg_cnt == 0 {
+                continue; // released slot
+            }
+            if region.cards.is_empty() {
+                continue; // region predates card mode being enabled
+            }
+            for pg_idx in 0..region.pg_cnt as usize {
+                if region.allocmap[pg_idx / 32] & (1 << (pg_idx % 32)) == 0 {
+                    continue;
+                }
+                if region.meta[pg_idx].in_freelist {
+                    continue;
+                }
+                let osize = region.meta[pg_idx].osize as usize;
+                let thread_n = region.meta_cold[pg_idx].thread_n as usize;
+                let size = mem::size_of::<JlTaggedValue>() + osize;
+                let padding = (size - JL_SMALL_BYTE_ALIGNMENT) % JL_SMALL_BYTE_ALIGNMENT;
+                let stride = size + padding;
+                let n_obj = (PAGE_SZ - GC_PAGE_OFFSET) / stride;
+                let tl_gc: &mut Gc2 = unsafe {
+                    &mut *(get_all_tls()[thread_n].tl_gcs)
+                };
+                for c in 0..cards_per_page {
+                    let card = &region.cards[pg_idx * cards_per_page + c];
+                    if card.load(Ordering::Relaxed) == 0 {
+                        continue;
+                    }
+                    card.store(0, Ordering::Relaxed);
+                    // range of object starts this card covers, relative
+                    // to the first cell of the page
+                    let lo = (c * CARD_SZ).saturating_sub(GC_PAGE_OFFSET);
+                    let hi = ((c + 1) * CARD_SZ).saturating_sub(GC_PAGE_OFFSET);
+                    let first = (lo + stride - 1) / stride;
+                    let last = cmp::min(n_obj, (hi + stride - 1) / stride);
+                    for o_idx in first..last {
+                        let o = unsafe {
+                            mem::transmute::<&mut u8, &mut JlTaggedValue>(&mut region.pages[pg_idx].data[o_idx * stride + GC_PAGE_OFFSET])
+                        };
+                        // the barrier dropped the object to GC_MARKED
+                        // when it dirtied the card; anything else on
+                        // the card is not remembered
+                        if o.tag() == GC_MARKED {
+                            tl_gc.heap.remset.push(o.mut_value());
+                        }
+                    }
+                }
+            }
+        }
+    }
+
     fn premark(&mut self) {
         for item in self.heap.remset.iter() {
           // TODO import and call objprofile_count(..)
             unsafe {
                 (*as_mut_jltaggedvalue(*item)).set_tag(GC_OLD_MARKED);
+                // these don't go through setmark_tag, keep the side
+                // mark bitmap in sync by hand
+                Marking::mark_bitmap(as_mut_jltaggedvalue(*item));
             }
         }
 
         for item in self.heap.rem_bindings.iter_mut() {
             unsafe {
                 (*as_mut_jltaggedvalue((*item).as_mut_jlvalue())).set_tag(GC_OLD_MARKED);
+                Marking::mark_bitmap(as_mut_jltaggedvalue((*item).as_mut_jlvalue()));
             }
         }
 
@@ -2006,6 +4196,78 @@ impl<'a> Gc2<'a> {
     }
 
     fn sweep_finalizer_list(finalizers: &mut JlArrayList) {
+        let mut out = FinalizerSweepOut::new();
+        Gc2::sweep_finalizer_list_into(finalizers, &mut out);
+        Gc2::merge_finalizer_sweep(out);
+    }
+
+    // Scan the per-thread finalizer tables on the worker pool. Each
+    // scan only touches its own table and collects what it wants on
+    // the shared lists into a private buffer; the appends themselves
+    // happen sequentially afterwards, so the C arraylists never see
+    // concurrent pushes.
+    fn sweep_finalizer_tables() {
+        let tls = unsafe { get_all_tls() };
+        let n_workers = unsafe { np_threads.as_ref().unwrap().thread_count() } as usize;
+        if n_workers < 2 || tls.len() < 2 {
+            for t in tls.iter_mut() {
+                Gc2::sweep_finalizer_list(&mut t.finalizers);
+            }
+            return;
+        }
+        let mut outs = Vec::with_capacity(tls.len());
+        for _ in 0..tls.len() {
+            outs.push(FinalizerSweepOut::new());
+        }
+        let pool = unsafe { np_threads.as_mut().unwrap() };
+        pool.scoped(|scope| {
+            for (t, out) in tls.iter_mut().zip(outs.iter_mut()) {
+                let finp = (&mut t.finalizers) as * mut JlArrayList as usize;
+                scope.execute(move || {
+                    Gc2::sweep_finalizer_list_into(unsafe { &mut *(finp as * mut JlArrayList) }, out);
+                });
+            }
+        });
+        for out in outs.drain(..) {
+            Gc2::merge_finalizer_sweep(out);
+        }
+    }
+
+    // Apply one table scan's findings to the shared lists. Must run on
+    // the collecting thread.
+    fn merge_finalizer_sweep(out: FinalizerSweepOut) {
+        for &(v, fin) in out.native.iter() {
+            if unsafe { NATIVE_TO_FINALIZE.is_some() } {
+                // defer to the background finalizer thread;
+                // mark_finalizers keeps the object alive through this
+                // sweep so the call can happen outside the pause
+                unsafe {
+                    NATIVE_TO_FINALIZE.as_mut().unwrap().push((v, fin));
+                }
+            } else {
+                // no background thread, run it right away
+                unsafe {
+                    np_call_finalizer(fin as * mut libc::c_void, v as * mut libc::c_void);
+                }
+            }
+        }
+        for &(v, fin) in out.to_finalize.iter() {
+            // this is schedule_finalization()
+            unsafe {
+                to_finalize.push(v as * mut libc::c_void);
+                to_finalize.push(fin as * mut libc::c_void);
+            }
+        }
+        for &(v0, fin) in out.marked.iter() {
+            // the caller relies on the new objects to be pushed to the end of the list
+            unsafe {
+                finalizer_list_marked.push(v0 as * mut libc::c_void);
+                finalizer_list_marked.push(fin as * mut libc::c_void);
+            }
+        }
+    }
+
+    fn sweep_finalizer_list_into(finalizers: &mut JlArrayList, out: &mut FinalizerSweepOut) {
         let listptr = finalizers as * mut JlArrayList;
         let mut len = finalizers.len;
         let mut i = 0;
@@ -2054,29 +4316,18 @@ impl<'a> Gc2<'a> {
 
                 if isfreed {
                     if is_cptr {
-                        // schedule finalizer to execute right away if it is native (non-Julia) code
-                        unsafe {
-                            np_call_finalizer(fin, v);
-                        }
+                        out.native.push((v as usize, fin as usize));
                         if unsafe { intrinsics::likely(! dontIncrement) } {
                             i += 2;
                         }
                         continue;
                     }
 
-                    // this is schedule_finalization()
-                    unsafe {
-                        to_finalize.push(v);
-                        to_finalize.push(fin);
-                    }
+                    out.to_finalize.push((v as usize, fin as usize));
                 }
 
                 if isold {
-                    // the caller relies on the new objects to be pushed to the end of the list
-                    unsafe {
-                        finalizer_list_marked.push(v0);
-                        finalizer_list_marked.push(fin);
-                    }
+                    out.marked.push((v0 as usize, fin as usize));
                 }
 
                 if unsafe { intrinsics::likely(! dontIncrement) } {
@@ -2088,6 +4339,30 @@ impl<'a> Gc2<'a> {
         finalizers.len = len; // truncate the finalizer list
     }
 
+    // Hand the native finalizers discovered this cycle to the
+    // background thread. Falls back to calling inline when the queue
+    // is full, which is what keeps the queue bounded.
+    fn dispatch_native_finalizers() {
+        let pending = match unsafe { NATIVE_TO_FINALIZE.as_mut() } {
+            Some(l) => l,
+            None => return,
+        };
+        for &(v, fin) in pending.iter() {
+            NATIVE_FINALIZERS_PENDING.fetch_add(1, Ordering::SeqCst);
+            let sent = match unsafe { NATIVE_FINALIZER_TX.as_ref() } {
+                Some(tx) => tx.try_send((v, fin)).is_ok(),
+                None => false,
+            };
+            if ! sent {
+                NATIVE_FINALIZERS_PENDING.fetch_sub(1, Ordering::SeqCst);
+                unsafe {
+                    np_call_finalizer(fin as * mut libc::c_void, v as * mut libc::c_void);
+                }
+            }
+        }
+        pending.clear();
+    }
+
     /// Verify that to_finalize doesn't contain any tagged pointers
     fn verify_to_finalize() {
         if cfg!(debug_assertions) {
@@ -2108,7 +4383,34 @@ impl<'a> Gc2<'a> {
     // N.B. in this code, a "chunk" refers to 32 contiguous pages that
     // correspond to an element of allocmap.
     fn sweep_pools(&mut self, full: bool) {
-        self.clear_freelists();
+        // clear every thread's freelists and invalidate their bump
+        // spans before the sweep rebuilds the freelists, otherwise the
+        // same cells could be handed out twice
+        for t in unsafe { get_all_tls() } {
+            let tl_gc = unsafe { &mut * t.tl_gcs };
+            tl_gc.clear_freelists();
+            for i in 0..GC_N_POOLS {
+                t.gc_pool_cur[i] = ::std::ptr::null_mut();
+                t.gc_pool_end[i] = ::std::ptr::null_mut();
+            }
+        }
+        // the condemned/withheld counters describe one full sweep
+        if full && EVAC_THRESHOLD.load(Ordering::Relaxed) != 0 {
+            EVAC_CONDEMNED.store(0, Ordering::Relaxed);
+            EVAC_WITHHELD.store(0, Ordering::Relaxed);
+        }
+        if LAZY_SWEEP.load(Ordering::SeqCst) {
+            // don't touch any objects during the pause, just queue the
+            // pages; pool_alloc sweeps them on demand
+            self.defer_sweep_pools(full);
+            return;
+        }
+        if LOCAL_MINOR.load(Ordering::SeqCst) && ! full {
+            // bound the in-pause sweep to the collecting thread's own
+            // pages; everyone else's go to their owners' lazy lists
+            self.sweep_pools_local();
+            return;
+        }
         // TODO: get this from page manager
         let regions = unsafe { REGIONS.as_mut().unwrap() };
         let remaining_pages = Arc::new(AtomicUsize::new(pg_mgr().current_pg_count.load(Ordering::SeqCst))); // Arc+AtomicUsize in preparation for sharing among threads
@@ -2123,27 +4425,90 @@ impl<'a> Gc2<'a> {
             let check_incomplete_chunk = (region.pg_cnt % 32 != 0) as usize;
 
             if PARALLEL_SWEEP {
-                /*let mut pool = unsafe { np_threads.as_mut().unwrap() };
+                // a page's dead cells go onto the freelist of the pool
+                // that owns the page, so each worker only sweeps pages
+                // whose owning thread falls in its shard; that keeps
+                // the freelist rebuild race-free without any locking.
+                // Workers race over the chunks of one region at a time,
+                // the metadata scan over foreign pages is cheap.
+                let pool = unsafe { np_threads.as_mut().unwrap() };
+                let n_shards = pool.thread_count() as usize;
+                let freed = Arc::new(AtomicUsize::new(0));
                 pool.scoped(|scope| {
-                    for i in 0..(region.pg_cnt as usize / 32 + check_incomplete_chunk) {
+                    for shard in 0..n_shards {
                         let rp = remaining_pages.clone();
+                        let freed = freed.clone();
                         let regions = unsafe { REGIONS.as_mut().unwrap() };
                         scope.execute(move || {
-                            //println!("Thread executing sweep_pool_chunk()");
-                            Gc2::sweep_pool_chunk(&mut regions[ri], i, &rp, full)
+                            let ref mut region = regions[ri];
+                            let mut bytes_freed = 0;
+                            for i in 0..(region.pg_cnt as usize / 32 + check_incomplete_chunk) {
+                                bytes_freed += Gc2::sweep_pool_chunk(region, i, &rp, full, shard, n_shards);
+                            }
+                            freed.fetch_add(bytes_freed, Ordering::SeqCst);
                         });
                     }
-                });*/
+                });
+                unsafe {
+                    gc_num.freed += freed.load(Ordering::SeqCst) as i64;
+                }
             } else {
+                let mut bytes_freed = 0;
                 for i in 0..(region.pg_cnt as usize / 32 + check_incomplete_chunk) {
-                    Gc2::sweep_pool_chunk(region, i, &remaining_pages, full);
+                    bytes_freed += Gc2::sweep_pool_chunk(region, i, &remaining_pages, full, 0, 1);
+                }
+                unsafe {
+                    gc_num.freed += bytes_freed as i64;
                 }
             }
 
         }
+        Gc2::order_freelists_by_occupancy();
+    }
+
+    // Allocation pops cells off the back of a pool's freelist, so after
+    // the sweep rebuilt the freelists in page order, reorder each one
+    // by descending page occupancy: cells from nearly-full pages end up
+    // at the back and are handed out first, while cells from mostly
+    // empty pages sit at the front. Filling the dense pages first keeps
+    // sparse pages untouched, so their last survivors dying lets the
+    // next sweep hit the all-dead case and hand the whole page back to
+    // the page manager instead of pinning it half empty. (The lazy and
+    // local-minor sweep modes rebuild freelists on demand and skip
+    // this.)
+    fn order_freelists_by_occupancy() {
+        for t in unsafe { get_all_tls() } {
+            let tl_gc = unsafe { &mut *t.tl_gcs };
+            for pool in tl_gc.heap.pools.iter_mut() {
+                if pool.freelist.len() < 2 {
+                    continue;
+                }
+                // look up each page's free-cell count once instead of
+                // doing a region scan per comparison
+                let mut page_nfree: HashMap<usize, u16> = HashMap::new();
+                {
+                    let mgr = pg_mgr();
+                    for c in pool.freelist.iter() {
+                        let page = (&**c as * const JlTaggedValue as usize) & ! (PAGE_SZ - 1);
+                        if ! page_nfree.contains_key(&page) {
+                            let nfree = unsafe { mgr.find_pagemeta(page as * const u8) }
+                                .map(|m| m.nfree).unwrap_or(0);
+                            page_nfree.insert(page, nfree);
+                        }
+                    }
+                }
+                pool.freelist.sort_by(|a, b| {
+                    let pa = (&**a as * const JlTaggedValue as usize) & ! (PAGE_SZ - 1);
+                    let pb = (&**b as * const JlTaggedValue as usize) & ! (PAGE_SZ - 1);
+                    page_nfree[&pb].cmp(&page_nfree[&pa])
+                });
+            }
+        }
     }
 
-    fn sweep_pool_chunk(region: &mut Region, i: usize, remaining_pages: &Arc<AtomicUsize>, full: bool) {
+    // sweep the pages of one allocmap chunk that are owned by threads
+    // in this worker's shard; returns the number of bytes freed
+    fn sweep_pool_chunk(region: &mut Region, i: usize, remaining_pages: &Arc<AtomicUsize>, full: bool, shard: usize, n_shards: usize) -> usize {
         let mut bytes_freed = 0;
         let mut m = region.allocmap[i];
         let mut j = 0;
@@ -2155,11 +4520,174 @@ impl<'a> Gc2<'a> {
                 j += 1;
                 continue;
             }
-            // whether current page should be freed completely
-            let mut should_free = false;
-            // if current page is to be swept
-            // a page is to be swept if it contains young objects or we are
-            // doing a full sweep
+            // pages parked on the page freelist keep their allocmap
+            // bit set, skip those too
+            if region.meta[pg_idx].in_freelist {
+                m >>= 1;
+                j += 1;
+                continue;
+            }
+            // pages outside this worker's shard belong to another worker
+            if region.meta_cold[pg_idx].thread_n as usize % n_shards != shard {
+                m >>= 1;
+                j += 1;
+                continue;
+            }
+            bytes_freed += Gc2::sweep_pool_page(region, pg_idx, full);
+
+            if remaining_pages.fetch_sub(1, Ordering::SeqCst) - 1 == 0 {
+                break;
+            }
+            m >>= 1;
+            j += 1;
+        }
+
+        bytes_freed
+    }
+
+    // local-minor quicksweep: eagerly sweep only the pages this thread
+    // owns and queue other threads' young pages for their owners to
+    // sweep on demand, so the pause is proportional to one thread's
+    // heap even when siblings allocated heavily
+    fn sweep_pools_local(&mut self) {
+        let tid = self.tid as usize;
+        let regions = unsafe { REGIONS.as_mut().unwrap() };
+        let mut bytes_freed = 0;
+        for ri in 0..regions.len() {
+            let ref mut region = regions[ri];
+            if region.pg_cnt == 0 {
+                continue; // released slot, or no more initialized regions
+            }
+            for pg_idx in 0..region.pg_cnt as usize {
+                if region.allocmap[pg_idx / 32] & (1 << (pg_idx % 32)) == 0 {
+                    continue;
+                }
+                if region.meta[pg_idx].in_freelist {
+                    continue;
+                }
+                let owner = region.meta_cold[pg_idx].thread_n as usize;
+                if owner == tid {
+                    bytes_freed += Gc2::sweep_pool_page(region, pg_idx, false);
+                } else {
+                    let pool_n = region.meta_cold[pg_idx].pool_n as usize;
+                    let meta = &mut region.meta[pg_idx];
+                    if meta.needs_sweep || ! *meta.has_young.get_mut() {
+                        continue;
+                    }
+                    meta.needs_sweep = true;
+                    let tl_gc: &mut Gc2 = unsafe {
+                        &mut *(get_all_tls()[owner].tl_gcs)
+                    };
+                    tl_gc.heap.pools[pool_n].lazy_pages.push((ri, pg_idx));
+                }
+            }
+        }
+        unsafe {
+            gc_num.freed += bytes_freed as i64;
+        }
+    }
+
+    // lazy-sweep pause pass: queue every page the eager sweep would
+    // have visited on its owner's pool, without looking at any objects.
+    // This walk only reads page metadata so it is cheap even on very
+    // large heaps.
+    fn defer_sweep_pools(&mut self, full: bool) {
+        if full {
+            LAZY_SWEEP_FULL.store(true, Ordering::SeqCst);
+        }
+        let pending_full = LAZY_SWEEP_FULL.load(Ordering::SeqCst);
+        let regions = unsafe { REGIONS.as_mut().unwrap() };
+        for ri in 0..regions.len() {
+            let ref mut region = regions[ri];
+            for pg_idx in 0..region.pg_cnt as usize {
+                if region.allocmap[pg_idx / 32] & (1 << (pg_idx % 32)) == 0 {
+                    continue;
+                }
+                let meta = &mut region.meta[pg_idx];
+                if meta.in_freelist || meta.needs_sweep {
+                    continue;
+                }
+                if ! (pending_full || *meta.has_young.get_mut()) {
+                    continue;
+                }
+                meta.needs_sweep = true;
+                let cold = &region.meta_cold[pg_idx];
+                let tl_gc: &mut Gc2 = unsafe {
+                    &mut *(get_all_tls()[cold.thread_n as usize].tl_gcs)
+                };
+                tl_gc.heap.pools[cold.pool_n as usize].lazy_pages.push((ri, pg_idx));
+            }
+        }
+    }
+
+    // pay off any sweep debt left over from the previous lazy cycle.
+    // Must run before marking starts: marking assumes dead cells from
+    // the last cycle had their stale mark bits reset by a sweep.
+    fn finish_lazy_sweep(&mut self) {
+        // local minors park foreign pages on the same lazy lists
+        if ! LAZY_SWEEP.load(Ordering::SeqCst) && ! LOCAL_MINOR.load(Ordering::SeqCst) {
+            return;
+        }
+        let full = LAZY_SWEEP_FULL.swap(false, Ordering::SeqCst);
+        for t in unsafe { get_all_tls() } {
+            let tl_gc = unsafe { &mut * t.tl_gcs };
+            for pool in tl_gc.heap.pools.iter_mut() {
+                while let Some((ri, pg_idx)) = pool.lazy_pages.pop() {
+                    let regions = unsafe { REGIONS.as_mut().unwrap() };
+                    if ! regions[ri].meta[pg_idx].needs_sweep {
+                        continue;
+                    }
+                    let freed = Gc2::sweep_pool_page(&mut regions[ri], pg_idx, full);
+                    unsafe {
+                        gc_num.freed += freed as i64;
+                    }
+                }
+            }
+        }
+    }
+
+    // fold one page's (or one bigval list's) worth of per-type counts
+    // into the census accumulator; batching keeps the lock off the
+    // per-object path
+    fn census_merge(counts: &HashMap<usize, (usize, usize)>) {
+        if counts.is_empty() {
+            return;
+        }
+        let mut acc = unsafe { CENSUS_ACC.as_ref().unwrap() }.lock().unwrap();
+        for (&typ, &(count, bytes)) in counts.iter() {
+            let e = acc.entry(typ).or_insert((0, 0));
+            e.0 += count;
+            e.1 += bytes;
+        }
+    }
+
+    // drain the accumulator into the queryable snapshot, heaviest
+    // first; runs once at the end of a full sweep
+    fn census_publish() {
+        let mut snap: Vec<(usize, usize, usize)> = {
+            let mut acc = unsafe { CENSUS_ACC.as_ref().unwrap() }.lock().unwrap();
+            acc.drain().map(|(typ, (count, bytes))| (typ, count, bytes)).collect()
+        };
+        snap.sort_by(|a, b| b.2.cmp(&a.2));
+        *unsafe { CENSUS_SNAPSHOT.as_ref().unwrap() }.lock().unwrap() = snap;
+    }
+
+    // sweep a single page: reset tags and ages of survivors, rebuild
+    // the owner pool's freelist from the dead cells, and return the
+    // page to the page manager if nothing in it survived. Returns the
+    // number of bytes freed. Used both by the eager chunk sweep above
+    // and by the lazy, allocation-driven sweep.
+    fn sweep_pool_page(region: &mut Region, pg_idx: usize, full: bool) -> usize {
+        unsafe {
+            gc_num.pages_swept += 1; // stats only, racy updates tolerated
+        }
+        let mut bytes_freed = 0;
+        // whether current page should be freed completely
+        let mut should_free = false;
+        // if current page is to be swept
+        // a page is to be swept if it contains young objects or we are
+        // doing a full sweep
+        {
             if full || *region.meta[pg_idx].has_young.get_mut() {
                 let meta = &mut region.meta[pg_idx];
                 let size = mem::size_of::<JlTaggedValue>() + meta.osize as usize;
@@ -2170,12 +4698,44 @@ impl<'a> Gc2<'a> {
                 let mut nfree = 0;
                 let mut has_young = false;
 
-                for o_idx in 0..n_obj {
-                    let o = unsafe {
-                        mem::transmute::<&mut u8, &mut JlTaggedValue>(&mut page.data[o_idx * (size + padding) + GC_PAGE_OFFSET])
-                    };
-                    if ! o.marked() {
-                        nfree += 1;
+                // snapshot the side mark bitmap; the snapshot is sized
+                // for the densest page, so it covers every size class
+                debug_assert!(n_obj <= BITMAP_SNAPSHOT_WORDS * BITMAP_WORD_BITS);
+                let mut words = [0usize; BITMAP_SNAPSHOT_WORDS];
+                let have_bitmap = match meta.marks {
+                    Some(ref marks) => {
+                        for (w, m) in words.iter_mut().zip(marks.iter()) {
+                            *w = m.load(Ordering::Relaxed);
+                        }
+                        true
+                    }
+                    None => false,
+                };
+                // new bitmap contents, mirroring the headers the sweep
+                // leaves behind
+                let mut new_words = [0usize; BITMAP_SNAPSHOT_WORDS];
+
+                if have_bitmap {
+                    // liveness comes from the bitmap, word at a time;
+                    // dead objects are never pulled into cache
+                    let mut live = 0;
+                    for w in words.iter() {
+                        live += w.count_ones() as usize;
+                    }
+                    nfree = n_obj - live;
+                } else {
+                    let page_base = page.data.as_ptr() as usize + GC_PAGE_OFFSET;
+                    for o_idx in 0..n_obj {
+                        if o_idx + SWEEP_CELL_PREFETCH < n_obj {
+                            Marking::prefetch(page_base +
+                                (o_idx + SWEEP_CELL_PREFETCH) * (size + padding));
+                        }
+                        let o = unsafe {
+                            mem::transmute::<&mut u8, &mut JlTaggedValue>(&mut page.data[o_idx * (size + padding) + GC_PAGE_OFFSET])
+                        };
+                        if ! o.marked() {
+                            nfree += 1;
+                        }
                     }
                 }
 
@@ -2185,42 +4745,100 @@ impl<'a> Gc2<'a> {
                 meta.nfree = nfree as u16;
                 *meta.nold.get_mut() = 0; // ???
 
+                // sparse page on a full sweep: condemn it (see
+                // EVAC_THRESHOLD) by withholding its free cells below
+                let evac = EVAC_THRESHOLD.load(Ordering::Relaxed);
+                let condemn = full && evac != 0 && nfree != n_obj &&
+                    (n_obj - nfree) * 100 <= n_obj * evac;
+                if condemn {
+                    EVAC_CONDEMNED.fetch_add(1, Ordering::Relaxed);
+                    EVAC_WITHHELD.fetch_add(nfree, Ordering::Relaxed);
+                }
+
                 if nfree != n_obj {
                     // there are live objects in the page, return free objects to the corresponding free list
                     let tl_gc: &mut Gc2 = unsafe {
-                        &mut *(get_all_tls()[meta.thread_n as usize].tl_gcs)
+                        &mut *(get_all_tls()[region.meta_cold[pg_idx].thread_n as usize].tl_gcs)
                     };
-                    let freelist = &mut tl_gc.heap.pools[meta.pool_n as usize].freelist;
+                    // promote on first survival when the threshold is 0
+                    // or sticky marks are on; the 1-bit pool age cannot
+                    // express thresholds above 1
+                    let promote_now = PROMOTE_AGE_CFG.load(Ordering::Relaxed) == 0 ||
+                        STICKY_MARKS.load(Ordering::Relaxed);
+                    let census = full && CENSUS.load(Ordering::Relaxed);
+                    let mut census_counts: HashMap<usize, (usize, usize)> = HashMap::new();
+                    let mut young_bytes = 0;
+                    let mut old_bytes = 0;
+                    let freelist = &mut tl_gc.heap.pools[region.meta_cold[pg_idx].pool_n as usize].freelist;
+                    let page_base = page.data.as_ptr() as usize + GC_PAGE_OFFSET;
                     for o_idx in 0..n_obj {
+                        // pay the header miss off early; with a bitmap
+                        // only live cells are touched (dead cells go to
+                        // the freelist by address), so skip the rest
+                        let pf = o_idx + SWEEP_CELL_PREFETCH;
+                        if pf < n_obj &&
+                            (!have_bitmap ||
+                             words[pf / BITMAP_WORD_BITS] & (1 << (pf % BITMAP_WORD_BITS)) != 0) {
+                            Marking::prefetch(page_base + pf * (size + padding));
+                        }
                         let o = unsafe {
                             mem::transmute::<&mut u8, &mut JlTaggedValue>(&mut page.data[o_idx * (size + padding) + GC_PAGE_OFFSET])
                         };
 
-                        let mut bits = o.tag();
-                        if bits.marked() {
-                            if *meta.ages.as_mut().unwrap()[o_idx].get_mut() || bits == GC_OLD_MARKED {
+                        let cell_marked = if have_bitmap {
+                            words[o_idx / BITMAP_WORD_BITS] & (1 << (o_idx % BITMAP_WORD_BITS)) != 0
+                        } else {
+                            o.marked()
+                        };
+                        if cell_marked {
+                            let mut bits = o.tag();
+                            if promote_now || *meta.ages.as_mut().unwrap()[o_idx].get_mut() || bits == GC_OLD_MARKED {
                                 // object is old enough
                                 if full || bits == GC_MARKED {
                                     bits = GC_OLD; // promote
                                 }
                                 meta.prev_nold += 1;
+                                old_bytes += meta.osize as usize;
                             } else {
                                 assert_eq!(bits, GC_MARKED, "meta.ages doesn't match the object's age");
                                 bits = GC_CLEAN;
                                 has_young = true;
+                                young_bytes += meta.osize as usize;
                             }
                             // increment age, saturating
                             *meta.ages.as_mut().unwrap()[o_idx].get_mut() = true;
 
+                            if census {
+                                let e = census_counts.entry(o.type_tag() as usize)
+                                    .or_insert((0, 0));
+                                e.0 += 1;
+                                e.1 += meta.osize as usize;
+                            }
+
                             o.set_tag(bits);
-                        } else {
+                            if bits.marked() {
+                                // old objects keep their mark bit across
+                                // quick sweeps; the bitmap has to agree
+                                new_words[o_idx / BITMAP_WORD_BITS] |= 1 << (o_idx % BITMAP_WORD_BITS);
+                            }
+                        } else if ! condemn {
                             freelist.push(o);
                         }
                     }
+                    // rewrite the bitmap to mirror the post-sweep headers
+                    if let Some(ref marks) = meta.marks {
+                        for (m, w) in marks.iter().zip(new_words.iter()) {
+                            m.store(*w, Ordering::Relaxed);
+                        }
+                    }
                     *meta.has_marked.get_mut() = true;
+                    YOUNG_OCCUPANCY.fetch_add(young_bytes, Ordering::Relaxed);
+                    OLD_OCCUPANCY.fetch_add(old_bytes, Ordering::Relaxed);
+                    if census {
+                        Gc2::census_merge(&census_counts);
+                    }
                 } else {
                     // page doesn't have anything alive in it, mark it for freeing
-                    // TODO: do lazy sweeping with resets etc.
                     should_free = true;
                     *meta.has_marked.get_mut() = false;
                 }
@@ -2228,25 +4846,18 @@ impl<'a> Gc2<'a> {
 
                 *meta.has_young.get_mut() = has_young;
             }
+        }
 
-            // we free the page here to make borrow checker happy
-            if should_free {
-                // page is unused, free it. we are being a little bit more aggressive here
-                // we need to tell Rust that moving regions here is safe somehow.
-                pg_mgr().free_page_in_region(region, pg_idx);
-            }
+        region.meta[pg_idx].needs_sweep = false;
 
-            if remaining_pages.fetch_sub(1, Ordering::SeqCst) - 1 == 0 {
-                break;
-            }
-            m >>= 1;
-            j += 1;
+        // we free the page here to make borrow checker happy
+        if should_free {
+            // page is unused, free it. we are being a little bit more aggressive here
+            // we need to tell Rust that moving regions here is safe somehow.
+            pg_mgr().free_page_in_region(region, pg_idx);
         }
 
-        unsafe {
-            // TODO: make this update atomic for thread-safety
-            gc_num.freed += bytes_freed as i64;
-        }
+        bytes_freed
     }
 
     // sweep bigvals in all threads
@@ -2270,37 +4881,67 @@ impl<'a> Gc2<'a> {
                 mem::transmute::<&mut Vec<* mut BigVal>, &mut Vec<& mut BigVal>>(&mut *bo)
             };
 
-            Gc2::sweep_big_list(&mut *big_objects, full);
+            Gc2::sweep_big_list(&mut *big_objects, &mut self.heap.bigval_cache, full);
 
             // move all survivors from big_objects_marked to this thread's big_objects
             self.heap.big_objects.append(&mut *big_objects);
+
+            // trim the chunk caches after full sweeps so a burst of
+            // big allocations doesn't pin memory forever
+            for ptls in unsafe { get_all_tls() } {
+                let tl_gc = unsafe {
+                    &mut * (*ptls).tl_gcs
+                };
+                tl_gc.heap.bigval_cache.trim();
+            }
         }
         neptune_gc_time_big_end();
     }
 
     // sweep bigvals local to this thread
     fn sweep_local_bigvals(&mut self, full: bool) {
-        Gc2::sweep_big_list(&mut self.heap.big_objects, full)
+        Gc2::sweep_big_list(&mut self.heap.big_objects, &mut self.heap.bigval_cache, full)
     }
 
-    fn sweep_big_list(list: &mut Vec<& mut BigVal>, full: bool) {
+    fn sweep_big_list(list: &mut Vec<& mut BigVal>, cache: &mut BigvalCache, full: bool) {
         let mut nbig_obj = list.len();
         let mut i = 0;
+        let promote_age = PROMOTE_AGE_CFG.load(Ordering::Relaxed);
+        let sticky = STICKY_MARKS.load(Ordering::Relaxed);
+        let census = full && CENSUS.load(Ordering::Relaxed);
+        let mut census_counts: HashMap<usize, (usize, usize)> = HashMap::new();
 
         while i < nbig_obj {
+            // dense side vector, cold headers: prefetch a fixed distance
+            // ahead so the sweep streams through the list instead of
+            // paying a dependent miss per object. The header line also
+            // holds age, size and capacity, so one prefetch covers every
+            // field this loop touches.
+            if i + BIG_SWEEP_PREFETCH < nbig_obj {
+                let p = (&*list[i + BIG_SWEEP_PREFETCH]) as *const BigVal as usize;
+                Marking::prefetch(p);
+            }
             let mut bits = list[i].taggedvalue().tag();
             let old_bits: u8 = bits;
 
             if unsafe { bits.marked() } {
-                if list[i].age() >= PROMOTE_AGE || bits == GC_OLD_MARKED {
+                if bits == GC_OLD_MARKED || sticky || list[i].age() >= promote_age {
                     if full || bits == GC_MARKED {
                         bits = GC_OLD;
                     }
+                    OLD_OCCUPANCY.fetch_add(list[i].allocd_size(), Ordering::Relaxed);
                 } else {
                     list[i].inc_age();
                     bits = GC_CLEAN;
+                    YOUNG_OCCUPANCY.fetch_add(list[i].allocd_size(), Ordering::Relaxed);
                 }
                 list[i].mut_taggedvalue().set_tag(bits);
+                if census {
+                    let e = census_counts.entry(list[i].taggedvalue().type_tag() as usize)
+                        .or_insert((0, 0));
+                    e.0 += 1;
+                    e.1 += list[i].allocd_size();
+                }
                 i += 1;
             } else {
                 let b = list.swap_remove(i);
@@ -2312,13 +4953,70 @@ impl<'a> Gc2<'a> {
                     gc_num.freed += b.allocd_size() as i64;
                 }
 
-                unsafe {
-                    Gc2::rust_free(b as * mut BigVal, b.allocd_size());
+                let cap = b.capacity();
+                if ! cache.put(cap, b as * mut BigVal) {
+                    // recycling into the chunk cache above is just a
+                    // pointer push; the actual free is what we move
+                    // off the pause
+                    if ! defer_free(DeferredFree::Big(b as * mut BigVal as usize, cap)) {
+                        unsafe {
+                            Gc2::rust_free_big(b as * mut BigVal, cap);
+                        }
+                    }
                 }
             }
 
             neptune_gc_time_count_big(old_bits as libc::c_int, bits as libc::c_int);
         }
+        if census {
+            Gc2::census_merge(&census_counts);
+        }
+    }
+
+    // Clear every thread's weakref list, striping long lists over the
+    // worker pool. Pass one runs in parallel and only writes dead
+    // slots (nulled) and dead referents (wr.value = nothing); pass two
+    // compacts sequentially. Entries are distinct weakref objects, so
+    // the workers never write the same memory.
+    fn sweep_weakrefs_parallel() {
+        let n_workers = unsafe { np_threads.as_ref().unwrap().thread_count() } as usize;
+        for t in unsafe { get_all_tls() } {
+            let tl_gc = unsafe { &mut * t.tl_gcs };
+            let n = tl_gc.heap.weak_refs.len();
+            if n_workers < 2 || n < WEAKREF_PAR_MIN {
+                tl_gc.sweep_weakrefs();
+                continue;
+            }
+            {
+                let chunk_sz = (n + n_workers - 1) / n_workers;
+                let pool = unsafe { np_threads.as_mut().unwrap() };
+                pool.scoped(|scope| {
+                    for chunk in tl_gc.heap.weak_refs.chunks_mut(chunk_sz) {
+                        // smuggle the chunk across the Send bound as
+                        // raw parts, like the sweep workers do with
+                        // REGIONS
+                        let addr = chunk.as_mut_ptr() as usize;
+                        let len = chunk.len();
+                        scope.execute(move || {
+                            let slots = unsafe {
+                                slice::from_raw_parts_mut(addr as * mut * mut WeakRef, len)
+                            };
+                            for slot in slots.iter_mut() {
+                                if unsafe { (* as_jltaggedvalue((&**slot).as_jlvalue())).marked() } {
+                                    let wr = unsafe { &mut **slot };
+                                    if ! unsafe { (* as_jltaggedvalue(wr.value)).marked() } {
+                                        wr.value = jl_nothing;
+                                    }
+                                } else {
+                                    *slot = ::std::ptr::null_mut();
+                                }
+                            }
+                        });
+                    }
+                });
+            }
+            tl_gc.heap.weak_refs.retain(|wr| ! wr.is_null());
+        }
     }
 
     fn sweep_weakrefs(&mut self) {
@@ -2377,15 +5075,22 @@ impl<'a> Gc2<'a> {
         let mut end = ma.len();
         let mut i = 0;
         while i < end {
+            // the vector is dense but the headers are cold; stream them
+            if i + BIG_SWEEP_PREFETCH < end {
+                let p = unsafe {
+                    as_jltaggedvalue((&*ma[i + BIG_SWEEP_PREFETCH]).as_jlvalue()) as usize
+                };
+                Marking::prefetch(p);
+            }
             let tag = unsafe {
-                &*as_jltaggedvalue((&*ma[i].a).as_jlvalue())
+                &*as_jltaggedvalue((&*ma[i]).as_jlvalue())
             };
 
             if tag.marked() {
                 i += 1;
             } else {
                 let a = unsafe {
-                    &mut *ma.swap_remove(i).a
+                    &mut *ma.swap_remove(i)
                 };
                 debug_assert_eq!(a.flags.how(), AllocStyle::MallocBuffer);
                 Gc2::free_array(a);
@@ -2417,7 +5122,17 @@ impl<'a> Gc2<'a> {
             // }
             unsafe {
                 gc_num.freed += a.nbytes() as i64;
-                libc::free(d); // on POSIX both cases compile down to free(3)
+                if defer_free(DeferredFree::Buffer(d as usize, a.nbytes(),
+                                                   a.flags.isaligned())) {
+                    return; // reclaimed off-thread after the world restarts
+                }
+                if a.flags.isaligned() {
+                    // aligned buffers came from the C-side buffer pool (or a
+                    // plain malloc), so offer them back for recycling
+                    np_cache_array_buffer(d, a.nbytes());
+                } else {
+                    libc::free(d); // on POSIX both cases compile down to free(3)
+                }
             }
         }
     }
@@ -2545,7 +5260,8 @@ impl<'a> Gc2<'a> {
             println!();
         }
 
-        for (t, c) in unsafe { mark_caches.as_ref().unwrap() } {
+        let caches = unsafe { mark_caches.as_ref().unwrap().lock().unwrap() };
+        for (t, c) in caches.iter().enumerate() {
 
             print!("big objects in GC thread {:?}'s cache:", t);
 
@@ -2591,7 +5307,8 @@ impl<'a> Gc2<'a> {
             println!();*/
         }
 
-        for (t, c) in unsafe { mark_caches.as_ref().unwrap() } {
+        let caches = unsafe { mark_caches.as_ref().unwrap().lock().unwrap() };
+        for c in caches.iter() {
             assert!(c.remset.is_empty());
             /*
             print!("big objects in GC thread {:?}'s cache's remset:", t);
@@ -2604,14 +5321,151 @@ impl<'a> Gc2<'a> {
         }
     }
 
+    /// Check one live page's cheap invariants; returns #violations.
+    fn sample_verify_page(region: &Region, pg_idx: usize) -> usize {
+        let meta = &region.meta[pg_idx];
+        let mut bad = 0;
+        if meta.osize == 0 {
+            println!("gc sample verifier: live page {} has osize 0", pg_idx);
+            return 1;
+        }
+        let size = mem::size_of::<JlTaggedValue>() + meta.osize as usize;
+        let padding = (size - JL_SMALL_BYTE_ALIGNMENT) % JL_SMALL_BYTE_ALIGNMENT;
+        let n_obj = (PAGE_SZ - GC_PAGE_OFFSET) / (size + padding);
+        if meta.nfree as usize > n_obj {
+            println!("gc sample verifier: page {} claims {} free cells of {}",
+                     pg_idx, meta.nfree, n_obj);
+            bad += 1;
+        }
+        let page = &region.pages[pg_idx];
+        for o_idx in 0..n_obj {
+            let o: &JlTaggedValue = unsafe {
+                mem::transmute(&page.data[o_idx * (size + padding) + GC_PAGE_OFFSET])
+            };
+            let header = o.read_header();
+            let in_bitmap = match meta.marks {
+                Some(ref marks) =>
+                    marks[o_idx / BITMAP_WORD_BITS].load(Ordering::Relaxed)
+                        & (1 << (o_idx % BITMAP_WORD_BITS)) != 0,
+                None => false,
+            };
+            if in_bitmap && ! header.marked() {
+                println!("gc sample verifier: cell {:p} has its side mark bit set but an unmarked header {:#x}",
+                         o, header);
+                bad += 1;
+                continue;
+            }
+            if header.marked() {
+                let ty = header.type_tag();
+                if ty == 0 || ty & (JL_SMALL_BYTE_ALIGNMENT - 1) != 0 {
+                    println!("gc sample verifier: marked cell {:p} has implausible type tag {:#x}",
+                             o, ty);
+                    bad += 1;
+                }
+            }
+        }
+        bad
+    }
+
+    /// Refresh the per-thread sub-blocks of the shared stats block (see
+    /// NEPTUNE_STATS) from the live collector state. Runs inside the
+    /// pause at the points where the C side historically sampled these
+    /// numbers over FFI: after marking and after the sweep.
+    fn publish_stats() {
+        let tls = unsafe { get_all_tls() };
+        let mut n = tls.len();
+        if n > STATS_MAX_THREADS {
+            n = STATS_MAX_THREADS;
+        }
+        unsafe {
+            NEPTUNE_STATS.alloc_hist = [0; SZCLASS_TABLE_LEN];
+        }
+        for i in 0..n {
+            let gc = unsafe { &*tls[i].tl_gcs };
+            unsafe {
+                NEPTUNE_STATS.tl[i] = GcTlStats {
+                    remset_len: gc.heap.remset.len(),
+                    last_remset_len: gc.heap.last_remset.len(),
+                    remset_nptr: gc.heap.remset_nptr,
+                    ffi_queue_root: gc.ffi_queue_root,
+                    ffi_alloc_slow: gc.ffi_alloc_slow,
+                    ffi_remset_sync: gc.ffi_remset_sync,
+                };
+                for b in 0..SZCLASS_TABLE_LEN {
+                    NEPTUNE_STATS.alloc_hist[b] += gc.alloc_hist[b];
+                }
+            }
+        }
+        unsafe {
+            NEPTUNE_STATS.nthreads = n;
+            NEPTUNE_STATS.ffi_page_ops = FFI_PAGE_OPS.load(Ordering::Relaxed) as u64;
+        }
+    }
+
+    /// Production-safe sampling verifier (NEPTUNE_VERIFY_SAMPLE): spot
+    /// check a handful of random pages and remset entries right after
+    /// the sweep, when both should be internally consistent.
+    fn sample_verify() {
+        let n = VERIFY_SAMPLE.load(Ordering::Relaxed);
+        if n == 0 {
+            return;
+        }
+        let mut bad = 0;
+        let regions = unsafe { REGIONS.as_ref().unwrap() };
+        // released slots leave holes, so sample over the slots that
+        // are actually initialized
+        let mut live_regions = Vec::new();
+        for ri in 0..REGIONS_HWM.load(Ordering::Relaxed) {
+            if regions[ri].pg_cnt != 0 {
+                live_regions.push(ri);
+            }
+        }
+        if !live_regions.is_empty() {
+            for _ in 0..n {
+                let region = &regions[live_regions[verify_rand() % live_regions.len()]];
+                let pg_idx = verify_rand() % region.pg_cnt as usize;
+                if ! region.allocmap[pg_idx / 32].get_bit((pg_idx % 32) as u8) ||
+                    region.meta[pg_idx].in_freelist {
+                    continue; // not a live page, count the sample as a miss
+                }
+                bad += Gc2::sample_verify_page(region, pg_idx);
+            }
+        }
+        for t in unsafe { get_all_tls() } {
+            let gc = unsafe { &*t.tl_gcs };
+            if gc.heap.remset.is_empty() {
+                continue;
+            }
+            for _ in 0..n {
+                let v = gc.heap.remset[verify_rand() % gc.heap.remset.len()];
+                let header = unsafe { &*as_jltaggedvalue(v) }.read_header();
+                // quick sweeps leave every remset entry marked (full
+                // sweeps clear the remset), so an unmarked or mangled
+                // header means someone scribbled over a live object
+                if ! header.marked() ||
+                    header.type_tag() & (JL_SMALL_BYTE_ALIGNMENT - 1) != 0 {
+                    println!("gc sample verifier: remset entry {:p} has bad header {:#x}",
+                             v, header);
+                    bad += 1;
+                }
+            }
+        }
+        if bad > 0 {
+            VERIFY_SAMPLE_FAILURES.fetch_add(bad, Ordering::Relaxed);
+            println!("gc sample verifier: {} violations this collection ({} total)",
+                     bad, VERIFY_SAMPLE_FAILURES.load(Ordering::Relaxed));
+        }
+    }
+
     fn sweep(&mut self, full: bool) {
         self.verify_module(unsafe { &mut *jl_core_module }); self.verify_module(unsafe { &mut *jl_main_module });
 
+        // the occupancy counters describe one sweep's findings
+        YOUNG_OCCUPANCY.store(0, Ordering::Relaxed);
+        OLD_OCCUPANCY.store(0, Ordering::Relaxed);
+
         // println!("sweeping weak refs");
-        for t in unsafe { get_all_tls() } {
-            let tl_gc = unsafe { &mut * (*t).tl_gcs };
-            tl_gc.sweep_weakrefs();
-        }
+        Gc2::sweep_weakrefs_parallel();
 
         // println!("sweeping malloc'd arrays");
         self.sweep_malloced_arrays();
@@ -2638,6 +5492,34 @@ impl<'a> Gc2<'a> {
         }
         // Gc2::verify_remsets();
 
+        if full && CENSUS.load(Ordering::Relaxed) {
+            Gc2::census_publish();
+        }
+
+        if full {
+            // give regions that sat fully idle across several full
+            // collections back to the OS (NEPTUNE_REGION_SHRINK)
+            unsafe {
+                pg_mgr().shrink_idle_regions(REGIONS.as_mut().unwrap());
+            }
+            if PRESSURE_RETURN.swap(false, Ordering::SeqCst) {
+                // pressure-triggered cycle: hand parked pages back too
+                unsafe {
+                    pg_mgr().return_parked_pages();
+                }
+            }
+        }
+
+        // hand this collection's dead epoch to the background
+        // reclaimer; the free storm runs once the world restarts
+        if CONCURRENT_SWEEP.load(Ordering::Relaxed) {
+            flush_deferred_frees();
+        }
+
+        // the sweep just parked this cycle's dead pages; have the
+        // zeroer wipe them while the mutators run
+        wake_background_zeroer();
+
         // println!("done sweeping")
     }
 
@@ -2650,8 +5532,50 @@ impl<'a> Gc2<'a> {
         // N.B. The modification of the tag is not atomic!
         // It should be ok since this is not a GC safepoint.
         tag.header.get_mut().set_tag(GC_MARKED);
-        self.heap.remset.push(tag.mut_value()); // we use get_value instead of directly root to make borrow checker happy
+        if ! (CARD_TABLE.load(Ordering::Relaxed) && Gc2::dirty_card_for(tag)) {
+            self.heap.remset.push(tag.mut_value()); // we use get_value instead of directly root to make borrow checker happy
+        }
         self.heap.remset_nptr += 1; // conservative, in case of root being a pointer
+        unsafe {
+            gc_num.barriers += 1; // stats only, racy updates tolerated
+        }
+    }
+
+    // Dirty the card covering an old object instead of growing the
+    // remset vector. Returns false when the object is not backed by a
+    // region (bigvals), in which case the caller falls back to the
+    // remset vector. Lock-free for the same reason as `mark_bitmap`.
+    fn dirty_card_for(o: * const JlTaggedValue) -> bool {
+        let regions = unsafe { REGIONS.as_ref().unwrap() };
+        for region in regions.iter().take(REGIONS_HWM.load(Ordering::Relaxed)) {
+            if region.pg_cnt == 0 {
+                continue; // released slot
+            }
+            if region.index_of_raw(o as * const u8).is_some() {
+                region.dirty_card(o as * const u8);
+                return true;
+            }
+        }
+        false
+    }
+
+    // Take over a batch of roots from the C-side write-barrier log
+    // (jl_gc_wb in julia/src/julia.h). The barrier already dropped
+    // these objects to GC_MARKED when it logged them, so only the
+    // remset bookkeeping is left to do here.
+    pub fn queue_logged_roots(&mut self, roots: &[* mut JlValue]) {
+        let card_mode = CARD_TABLE.load(Ordering::Relaxed);
+        for root in roots {
+            let tag = unsafe { &mut * as_mut_jltaggedvalue(*root) };
+            debug_assert!(tag.tag() == GC_MARKED);
+            if ! (card_mode && Gc2::dirty_card_for(tag)) {
+                self.heap.remset.push(tag.mut_value());
+            }
+            self.heap.remset_nptr += 1;
+        }
+        unsafe {
+            gc_num.barriers += roots.len() as u64;
+        }
     }
 
     #[inline(always)]
@@ -16,6 +16,10 @@
 #![feature(step_by)]
 // to access the thread-local stored values
 #![feature(thread_id)]
+// for the prefetch instructions in the mark loop
+#![feature(asm)]
+// to align the per-worker mark caches to cache lines
+#![feature(repr_align, attr_literals)]
 
 extern crate libc;
 extern crate core;
@@ -35,3 +39,7 @@ pub mod util;
 pub mod c_interface;
 
 pub mod gc2;
+
+pub mod trace;
+
+pub mod bench;
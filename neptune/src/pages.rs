@@ -7,10 +7,14 @@ use c_interface::*;
 use libc;
 use std::mem;
 use std::cmp;
+use std::env;
 use util::*;
 use core;
+use concurrency::*;
+use trace::*;
 use std::sync::Arc;
-use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::Mutex as StdMutex;
+use std::sync::atomic::{AtomicUsize, AtomicI32, AtomicU8, Ordering};
 
 // max. page count per region.
 // From: https://doc.rust-lang.org/reference.html#conditional-compilation
@@ -27,6 +31,16 @@ pub const DEFAULT_REGION_PG_COUNT: usize = 16 * 8 * 4096; // 8 GB
 
 const MIN_REGION_PG_COUNT: usize = 64; // 1 MB
 
+// release regions that stay fully idle for this many consecutive full
+// collections (NEPTUNE_REGION_SHRINK overrides; 0 disables shrinking)
+const DEFAULT_REGION_SHRINK: u32 = 4;
+
+// one past the highest region slot that has ever been initialized.
+// Region release can leave empty slots in the middle of the table, so
+// walkers bound their scans with this instead of stopping at the first
+// empty region.
+pub static REGIONS_HWM: AtomicUsize = AtomicUsize::new(0);
+
 // A GC page, eqv. of jl_gc_page_t
 #[repr(C)]
 #[derive(Copy)]
@@ -53,9 +67,80 @@ impl Clone for Page {
     }
 }
 
+// NUMA placement policy for region memory, set through
+// neptune_init_gc. ACHTUNG: keep the values in sync with
+// julia/src/neptune.h!
+pub const NUMA_DEFAULT: i32 = 0;    // whatever mmap gives us
+pub const NUMA_LOCAL: i32 = 1;      // first-touch: pages land on the faulting thread's node
+pub const NUMA_INTERLEAVE: i32 = 2; // interleave region memory across all nodes
+
+pub static NUMA_POLICY: AtomicI32 = AtomicI32::new(NUMA_DEFAULT);
+
+// Page-return policy from the command line, set through neptune_init_gc
+// (which runs before the page manager is built). ACHTUNG: keep the
+// values in sync with NEPTUNE_PAGES_* in julia/src/neptune.h!
+pub const PAGES_DEFAULT: i32 = 0; // NEPTUNE_LAZY_DECOMMIT environment variable decides
+pub const PAGES_KEEP: i32 = 1;    // keep parked pages committed for warm reuse
+pub const PAGES_LAZY: i32 = 2;    // MADV_FREE parked pages
+
+pub static PAGE_RETURN_OPT: AtomicI32 = AtomicI32::new(PAGES_DEFAULT);
+
+/// Lock-free freelist of parked pages. Pages on it keep their
+/// allocmap bit set (the sweep skips them via `PageMeta::in_freelist`),
+/// so reusing one doesn't have to touch the allocation maps or scan
+/// regions at all. This is what keeps page acquisition from serializing
+/// behind the page manager lock when many pools refill after a sweep.
+pub static mut PAGE_FREELIST: Option<ConcurrentStack<* mut libc::c_void>> = None;
+
+#[inline(always)]
+pub fn page_freelist<'a>() -> &'a ConcurrentStack<* mut libc::c_void> {
+    unsafe { PAGE_FREELIST.as_ref().unwrap() }
+}
+
+/// Parked pages the background zeroer has already wiped
+/// (NEPTUNE_ZERO_PAGES). Allocation prefers these: a pool taking one
+/// skips the tag-clearing walk over the page, which otherwise runs on
+/// the mutator right when it is out of cells. Membership is the
+/// guarantee - a page only moves here after the zeroer owned it
+/// exclusively (popped off the plain freelist) and wiped it.
+pub static mut ZEROED_PAGE_FREELIST: Option<ConcurrentStack<* mut libc::c_void>> = None;
+
+#[inline(always)]
+pub fn zeroed_page_freelist<'a>() -> &'a ConcurrentStack<* mut libc::c_void> {
+    unsafe { ZEROED_PAGE_FREELIST.as_ref().unwrap() }
+}
+
+/// Held by the background zeroer while it has pages in flight (popped
+/// but not yet pushed back). Region release unmaps parked pages by
+/// address, so it takes this lock to know no page is hiding in the
+/// zeroer's hands; the zeroer works in small batches to keep that wait
+/// bounded.
+pub static mut PAGE_ZEROER_LOCK: Option<StdMutex<()>> = None;
+
+#[inline(always)]
+pub fn page_zeroer_lock<'a>() -> &'a StdMutex<()> {
+    unsafe { PAGE_ZEROER_LOCK.as_ref().unwrap() }
+}
+
 pub struct PageMgr {
     region_pg_count: usize,
     pub current_pg_count: Arc<AtomicUsize>,
+    // back region memory with 2MB transparent hugepages (NEPTUNE_HUGEPAGES)
+    use_hugepages: bool,
+    // # of GC pages to pre-fault on region growth (NEPTUNE_PREFAULT_PAGES)
+    prefault_batch: usize,
+    // MADV_FREE parked pages so the kernel can reclaim them under
+    // pressure (NEPTUNE_LAZY_DECOMMIT)
+    lazy_decommit: bool,
+    // top level of the free-page index: one bit per region, set once
+    // every allocmap word of the region is full. The level below is
+    // Region::summary (one bit per full allocmap word). Freed pages are
+    // parked on the page freelist with their allocmap bit kept, so bits
+    // only clear when release_region recycles a slot.
+    full_regions: Vec<u32>,
+    // full collections a region must sit fully idle before it is
+    // released (NEPTUNE_REGION_SHRINK; 0 disables)
+    shrink_after: u32,
 }
 impl PageMgr {
     pub fn new() -> PageMgr {
@@ -82,9 +167,41 @@ impl PageMgr {
 
             println!("page count per region after consulting `rlimit`: {}", region_pg_count);
         }
+        // optionally back regions with transparent hugepages and
+        // pre-fault a batch of pages up front. both help big (10GB+)
+        // heaps, where dTLB misses during marking and one-at-a-time
+        // first-touch faults are measurable in profiles.
+        let use_hugepages = env::var("NEPTUNE_HUGEPAGES").map(|v| v != "0").unwrap_or(false);
+        let prefault_batch = env::var("NEPTUNE_PREFAULT_PAGES").ok()
+            .and_then(|v| v.parse::<usize>().ok())
+            .unwrap_or(0);
+        // lazy decommit tier for parked pages: freed pages are marked
+        // MADV_FREE so the kernel may take them back under memory
+        // pressure, but while memory is plentiful reuse through the
+        // freelist keeps the warm mapping and pays no fault-and-zero
+        // cost. helps heaps that oscillate by many GB.
+        // --gc-page-return takes precedence over the environment
+        let lazy_decommit = match PAGE_RETURN_OPT.load(Ordering::Relaxed) {
+            PAGES_KEEP => false,
+            PAGES_LAZY => true,
+            _ => env::var("NEPTUNE_LAZY_DECOMMIT").map(|v| v != "0").unwrap_or(false),
+        };
+
+        // how long a region must stay fully idle before its memory goes
+        // back to the OS; a nightly allocation spike otherwise leaves
+        // the grown region table mapped for the life of the process
+        let shrink_after = env::var("NEPTUNE_REGION_SHRINK").ok()
+            .and_then(|v| v.parse::<u32>().ok())
+            .unwrap_or(DEFAULT_REGION_SHRINK);
+
         PageMgr {
             region_pg_count: region_pg_count,
             current_pg_count: Arc::new(AtomicUsize::new(0)),
+            use_hugepages: use_hugepages,
+            prefault_batch: prefault_batch,
+            lazy_decommit: lazy_decommit,
+            full_regions: vec![0u32; REGION_COUNT / 32],
+            shrink_after: shrink_after,
         }
     }
 
@@ -105,6 +222,13 @@ impl PageMgr {
     }
 
     unsafe fn alloc_unmanaged_array<'a, T>(len: usize, alignment: Option<usize>) -> &'a mut [T] {
+        PageMgr::alloc_unmanaged_array_raw(len, alignment).0
+    }
+
+    // as alloc_unmanaged_array, but also return the raw mapping backing
+    // the slice (base pointer and mapped length) so release_region can
+    // munmap exactly what was mapped, including any alignment slack
+    unsafe fn alloc_unmanaged_array_raw<'a, T>(len: usize, alignment: Option<usize>) -> (&'a mut [T], * mut u8, usize) {
         match len.checked_mul(mem::size_of::<T>()) {
             Some(size) => {
                 // alignment guaranteed by the system
@@ -135,7 +259,7 @@ impl PageMgr {
                     m
                 };
                 // memory alchemy! make it a Rust slice
-                ::std::slice::from_raw_parts_mut(mem::transmute(begin), size)
+                (::std::slice::from_raw_parts_mut(mem::transmute(begin), size), m, allocsz)
             }
             None => {
                 panic!("Memory error: requested array's size is greater than 2^64!");
@@ -146,27 +270,102 @@ impl PageMgr {
     // Note: the libc::MAP_ANONYMOUS flag says that it initializes the contents to zero,
     //       so maybe this function is unneeded
     unsafe fn alloc_unmanaged_zeroed_array<'a, T>(len: usize, alignment: Option<usize>) -> &'a mut [T] {
-        let s = PageMgr::alloc_unmanaged_array(len, alignment);
+        PageMgr::alloc_unmanaged_zeroed_array_raw(len, alignment).0
+    }
+
+    unsafe fn alloc_unmanaged_zeroed_array_raw<'a, T>(len: usize, alignment: Option<usize>) -> (&'a mut [T], * mut u8, usize) {
+        let (s, base, sz) = PageMgr::alloc_unmanaged_array_raw(len, alignment);
         // zero the memory
         libc::memset(mem::transmute(s.as_mut_ptr()), 0, len * mem::size_of::<T>());
-        s
+        (s, base, sz)
     }
 
     pub fn alloc_region_mem<'a>(&self, pg_cnt: usize) -> Option<Region<'a>> {
         let mut region = Region::new();
         println!("allocated a new region with page count: {}", pg_cnt);
         // TODO: handle failure for this gracefully
-        region.pages = unsafe {
-            PageMgr::alloc_unmanaged_array(pg_cnt, Some(PAGE_SZ))
+        let (pages, base, sz) = unsafe {
+            PageMgr::alloc_unmanaged_array_raw(pg_cnt, Some(PAGE_SZ))
         };
-        region.allocmap = unsafe {
-            PageMgr::alloc_unmanaged_zeroed_array(pg_cnt / 32, None)
+        region.pages = pages;
+        region.mappings.push((base, sz));
+        if self.use_hugepages {
+            // ask the kernel to back the page array with 2MB
+            // transparent hugepages. this is only advice, so we don't
+            // care whether it succeeds.
+            unsafe {
+                libc::madvise(region.pages.as_mut_ptr() as * mut libc::c_void,
+                              pg_cnt * mem::size_of::<Page>(),
+                              libc::MADV_HUGEPAGE);
+            }
+        }
+        let numa = NUMA_POLICY.load(Ordering::Relaxed);
+        if numa == NUMA_INTERLEAVE {
+            // interleave the page array across all NUMA nodes so a
+            // single node's memory controller doesn't serve the whole
+            // heap. mbind(2) isn't exposed by the libc crate, so
+            // invoke the syscall directly (x86_64 only, which is all
+            // we support anyways).
+            const SYS_MBIND: libc::c_long = 237;
+            const MPOL_INTERLEAVE: libc::c_long = 3;
+            let all_nodes: libc::c_ulong = !0;
+            unsafe {
+                libc::syscall(SYS_MBIND,
+                              region.pages.as_mut_ptr() as usize,
+                              pg_cnt * mem::size_of::<Page>(),
+                              MPOL_INTERLEAVE,
+                              &all_nodes as * const libc::c_ulong,
+                              mem::size_of::<libc::c_ulong>() * 8,
+                              0);
+            }
+        }
+        // NUMA_LOCAL relies on the kernel's first-touch behavior: the
+        // thread that faults a page in while allocating from it gets
+        // the page on its own node. pre-faulting from this thread
+        // would defeat that, so skip it.
+        if self.prefault_batch > 0 && numa != NUMA_LOCAL {
+            // batch the first-touch faults on region growth instead of
+            // taking them one GC page at a time from the allocation
+            // slow path
+            let bytes = cmp::min(self.prefault_batch, pg_cnt) * mem::size_of::<Page>();
+            let sys_pg = unsafe { libc::sysconf(libc::_SC_PAGESIZE) } as usize;
+            let mut off = 0;
+            while off < bytes {
+                region.pages[off >> PAGE_LG2].data[off & (PAGE_SZ - 1)] = 0;
+                off += sys_pg;
+            }
+        }
+        let (allocmap, base, sz) = unsafe {
+            PageMgr::alloc_unmanaged_zeroed_array_raw(pg_cnt / 32, None)
         };
+        region.allocmap = allocmap;
+        region.mappings.push((base, sz));
         // mmap hack time
-        region.meta = unsafe {
-            PageMgr::alloc_unmanaged_zeroed_array(pg_cnt, None)
+        let (meta, base, sz) = unsafe {
+            PageMgr::alloc_unmanaged_zeroed_array_raw(pg_cnt, None)
+        };
+        region.meta = meta;
+        region.mappings.push((base, sz));
+        let (meta_cold, base, sz) = unsafe {
+            PageMgr::alloc_unmanaged_zeroed_array_raw(pg_cnt, None)
         };
+        region.meta_cold = meta_cold;
+        region.mappings.push((base, sz));
+        let (summary, base, sz) = unsafe {
+            PageMgr::alloc_unmanaged_zeroed_array_raw((pg_cnt / 32 + 31) / 32, None)
+        };
+        region.summary = summary;
+        region.mappings.push((base, sz));
         region.pg_cnt = pg_cnt as u32;
+        if CARD_TABLE.load(Ordering::SeqCst) {
+            // one card byte per CARD_SZ bytes of page data
+            let n_cards = pg_cnt * (PAGE_SZ / CARD_SZ);
+            let mut cards = Vec::with_capacity(n_cards);
+            for _ in 0..n_cards {
+                cards.push(AtomicU8::new(0));
+            }
+            region.cards = cards;
+        }
         // TODO: commit meta and allocmap
         Some(region)
     }
@@ -198,25 +397,83 @@ impl PageMgr {
 
     #[inline(never)]
     pub fn alloc_page<'a>(&mut self, regions: &'a mut [Region]) -> &'a mut Page {
+        // fastest path: a page the background zeroer already wiped;
+        // the consumer (add_page) sees meta.zeroed and skips the
+        // tag-clearing walk entirely
+        if let Some(p) = zeroed_page_freelist().pop() {
+            let page: &'a mut Page = unsafe { mem::transmute(p) };
+            let meta = unsafe {
+                self.find_pagemeta(p as * const u8).unwrap()
+            };
+            debug_assert!(meta.in_freelist);
+            meta.in_freelist = false;
+            meta.zeroed = true;
+            self.current_pg_count.fetch_add(1, Ordering::SeqCst);
+            unsafe {
+                gc_final_count_page(self.current_pg_count.load(Ordering::SeqCst));
+            }
+            trace_event(EV_PAGE_ALLOC, TRACE_NO_TID, p as u64, 0);
+            return page;
+        }
+        // fast path: reuse a parked page from the lock-free freelist
+        // without scanning the region allocation maps. with lazy
+        // decommit the page may have been reclaimed (reads as zeros)
+        // or not (warm, no fault); either way add_page reinitializes
+        // the tags, so reuse doesn't care which.
+        if let Some(p) = page_freelist().pop() {
+            let page: &'a mut Page = unsafe { mem::transmute(p) };
+            let meta = unsafe {
+                self.find_pagemeta(p as * const u8).unwrap()
+            };
+            debug_assert!(meta.in_freelist);
+            meta.in_freelist = false;
+            meta.zeroed = false;
+            self.current_pg_count.fetch_add(1, Ordering::SeqCst);
+            unsafe {
+                gc_final_count_page(self.current_pg_count.load(Ordering::SeqCst));
+            }
+            trace_event(EV_PAGE_ALLOC, TRACE_NO_TID, p as u64, 0);
+            return page;
+        }
         // println!("allocating page...");
+        // walk the two-level free-page index instead of scanning the
+        // allocmaps linearly: find-first-zero over full_regions picks
+        // the region, find-first-zero over its summary picks the
+        // allocmap word. Regions fill up in order, so the first region
+        // whose bit is clear is either non-full or still unallocated.
         let mut i: Option<u32> = None;
         let mut region_i = 0;
-        // println!("regions.len = {}", regions.len());
-        'outer: for region in regions.iter_mut() {
-            // println!("#pages in region {}: {}", region_i, region.pages.len());
-            if region.pages.len() == 0 {
-                // found an empty region, allocate it
-                self.alloc_region(region);
-            }
-            for j in region.lb..(region.pg_cnt / 32) {
-                // println!("j: {}", j);
-                if (!region.allocmap[j as usize]) != 0 {
-                    // there are free pages in the region
-                    i = Some(j);
-                    break 'outer;
+        'outer: for wi in 0..self.full_regions.len() {
+            let mut free = ! self.full_regions[wi];
+            while free != 0 {
+                let ri = wi * 32 + (free.ffs() - 1) as usize;
+                region_i = ri;
+                let region = &mut regions[ri];
+                if region.pages.len() == 0 {
+                    // found an empty region, allocate it
+                    self.alloc_region(region);
+                    if ri + 1 > REGIONS_HWM.load(Ordering::Relaxed) {
+                        REGIONS_HWM.store(ri + 1, Ordering::Relaxed);
+                    }
+                }
+                let nwords = (region.pg_cnt / 32) as usize;
+                for si in 0..region.summary.len() {
+                    let words = ! region.summary[si];
+                    if words != 0 {
+                        let j = si * 32 + (words.ffs() - 1) as usize;
+                        // bits past the last allocmap word of a small
+                        // region read as free, ignore those
+                        if j < nwords {
+                            i = Some(j as u32);
+                            break 'outer;
+                        }
+                    }
                 }
+                // every allocmap word is full: record it at the top
+                // level and retry with the next candidate
+                self.full_regions[wi] |= 1 << (ri % 32);
+                free &= free - 1;
             }
-            region_i += 1;
         }
         if let Some(i) = i {
             let region = &mut regions[region_i];
@@ -230,13 +487,22 @@ impl PageMgr {
             // find first empty page
             let j = ((! region.allocmap[i as usize]).ffs() - 1) as u32;
             region.allocmap[i as usize] |= 1 << j;
+            if region.allocmap[i as usize] == !0 {
+                // word went full, note it in the region's summary
+                region.summary[i as usize / 32] |= 1 << (i % 32);
+            }
+            // pages only leave the allocmap path through the freelists,
+            // so this one is fresh anonymous memory and reads as zeros
+            region.meta[(i * 32 + j) as usize].zeroed = true;
             // TODO: commit page (&region.pages[i * 32 + j])
             self.current_pg_count.fetch_add(1, Ordering::SeqCst);
             // notify Julia's GC debugger
             unsafe {
                 gc_final_count_page(self.current_pg_count.load(Ordering::SeqCst));
             }
-            &mut region.pages[(i * 32 + j) as usize]
+            let page = &mut region.pages[(i * 32 + j) as usize];
+            trace_event(EV_PAGE_ALLOC, TRACE_NO_TID, page.data.as_ptr() as u64, 0);
+            page
         } else {
             // No regions with free memory are available and all region slots are allocated
             panic!("GC: out of memory: no regions left!"); // TODO: change with jl_throw
@@ -264,62 +530,88 @@ impl PageMgr {
         self.free_page_in_region(&mut regions[i], pg_idx);
     }
 
+    /// MADV_FREE every page parked on the freelist, regardless of the
+    /// configured page-return policy. Used after a pressure-triggered
+    /// full collection so the kernel can reclaim the parked memory
+    /// while the container is close to its limit; reuse tolerates
+    /// reclaimed pages (add_page reinitializes the tags), so the only
+    /// cost is refaults on the next refill.
+    pub fn return_parked_pages(&mut self) {
+        const MADV_FREE: libc::c_int = 8;
+        let mut parked = Vec::new();
+        while let Some(p) = page_freelist().pop() {
+            parked.push(p);
+        }
+        for p in &parked {
+            unsafe {
+                libc::madvise(*p, PAGE_SZ, MADV_FREE);
+            }
+            page_freelist().push(*p);
+        }
+        // pre-zeroed pages stay on their own list: MADV_FREE either
+        // leaves the zeroed contents in place or replaces them with
+        // fresh zero pages, so they remain zero either way
+        let mut zparked = Vec::new();
+        while let Some(p) = zeroed_page_freelist().pop() {
+            zparked.push(p);
+        }
+        for p in &zparked {
+            unsafe {
+                libc::madvise(*p, PAGE_SZ, MADV_FREE);
+            }
+            zeroed_page_freelist().push(*p);
+        }
+        let total = parked.len() + zparked.len();
+        if total > 0 {
+            println!("neptune: pressure-returned {} parked pages ({} MB)",
+                     total, total * PAGE_SZ / 1024 / 1024);
+        }
+    }
+
     // free page with given index at given region
     pub fn free_page_in_region(&mut self, region: &mut Region, pg_idx: usize) {
-        // TODO make thread-safe so we can remove lock on pg_mgr()
         let bit_idx = (pg_idx % 32) as u8;
         assert!(region.allocmap[pg_idx / 32].get_bit(bit_idx), "GC: Memory corruption: allocation map and data mismatch!");
-        region.allocmap[pg_idx / 32].set_bit(bit_idx, false);
+        // keep the allocmap bit set and park the page on the lock-free
+        // freelist instead; allocation reuses it without taking the
+        // region scan path and the sweep skips it via in_freelist.
+        // this also means the page stays committed, which is the point:
+        // pools that refill right after a sweep get warm pages back.
+        region.meta[pg_idx].in_freelist = true;
+        // the page carries dead objects' bytes until the zeroer gets it
+        region.meta[pg_idx].zeroed = false;
         // free age data
         region.meta[pg_idx].ages = None;
-
-        // decommit code
-
-        // figure out #pages to decommit
-        // let mut decommit_size = PAGE_SZ;
-        // let mut page_ptr: Option<*const libc::c_void> = None;
-        let mut should_decommit = true;
-        if PAGE_SZ < jl_page_size {
-            let n_pages = (PAGE_SZ + jl_page_size - 1) / PAGE_SZ; // size of OS pages in terms of our pages
-            // decommit_size = jl_page_size;
-
-            // hacky pointer magic for figuring out OS page alignment
-            let page_ptr = unsafe {
-                Some(((&region.pages[pg_idx].data as *const u8 as usize) & !(jl_page_size - 1)) as *const u8)
-            };
-
-            let pg_idx = region.index_of_raw(page_ptr.unwrap()).unwrap();
-            if pg_idx + n_pages > region.pg_cnt as usize {
-                should_decommit = false;
-            } else {
-                for i in 0..n_pages {
-                    if region.allocmap[pg_idx / 32].get_bit(bit_idx) {
-                        should_decommit = false;
-                        break;
-                    }
-                }
+        if self.lazy_decommit {
+            // let the kernel reclaim the page lazily. this must happen
+            // before the page is published on the freelist: a write
+            // after MADV_FREE cancels the reclaim, but only if the
+            // advice was already in effect when the write landed.
+            // MADV_FREE isn't exposed by the libc crate we build
+            // against, so define it ourselves (Linux-only, like mbind
+            // above; on other kernels the call fails and is ignored).
+            const MADV_FREE: libc::c_int = 8;
+            unsafe {
+                libc::madvise(region.pages[pg_idx].data.as_mut_ptr() as * mut libc::c_void,
+                              PAGE_SZ,
+                              MADV_FREE);
             }
         }
-
-        if should_decommit {
-            // TODO: actually decommit, we need to use our own allocator for this
-        }
-
-        if region.lb as usize > pg_idx / 32 {
-            region.lb = (pg_idx / 32) as u32;
-        }
+        trace_event(EV_PAGE_FREE, TRACE_NO_TID,
+                    region.pages[pg_idx].data.as_ptr() as u64, 0);
+        page_freelist().push(region.pages[pg_idx].data.as_mut_ptr() as * mut libc::c_void);
 
         self.current_pg_count.fetch_sub(1, Ordering::SeqCst);
     }
 
     /// port of `page_metadata` in Julia
-    pub unsafe fn find_pagemeta<T>(&self, ptr: * const T) -> Option<&'static mut PageMeta<'static>> {
+    pub unsafe fn find_pagemeta<T>(&self, ptr: * const T) -> Option<&'static mut PageMeta> {
         let regions = REGIONS.as_mut().unwrap();
-        for region in regions.iter_mut() {
+        // released slots leave holes in the table, so skip empties up
+        // to the high-water mark instead of stopping at the first one
+        for region in regions.iter_mut().take(REGIONS_HWM.load(Ordering::Relaxed)) {
             if region.pg_cnt == 0 {
-                // we are done with all initialized regions
-                // N.B. if we change region allocation algorithm, we need to revisit this
-                return None;
+                continue;
             }
 
             if let Some(i) = region.index_of_raw(ptr as * const u8) {
@@ -328,6 +620,114 @@ impl PageMgr {
         }
         None
     }
+
+    /// Called at the end of a full collection, inside the pause.
+    /// Regions whose allocated pages have all been parked on the page
+    /// freelist for `shrink_after` consecutive full collections are
+    /// munmapped and their slots recycled, so a one-off allocation
+    /// spike doesn't leave the grown heap mapped forever. One idle
+    /// region is always kept as hysteresis: an allocation burst right
+    /// after a shrink reuses it instead of paying the region setup
+    /// cost again.
+    pub fn shrink_idle_regions(&mut self, regions: &mut [Region]) {
+        if self.shrink_after == 0 {
+            return;
+        }
+        let hwm = REGIONS_HWM.load(Ordering::Relaxed);
+        let mut spare_kept = false;
+        let mut victims: Vec<usize> = Vec::new();
+        for ri in 0..hwm {
+            if regions[ri].pg_cnt == 0 {
+                continue;
+            }
+            let mut idle = true;
+            'scan: for wi in 0..(regions[ri].pg_cnt as usize / 32) {
+                let mut word = regions[ri].allocmap[wi];
+                while word != 0 {
+                    let b = (word.ffs() - 1) as usize;
+                    if !regions[ri].meta[wi * 32 + b].in_freelist {
+                        idle = false;
+                        break 'scan;
+                    }
+                    word &= word - 1;
+                }
+            }
+            if !idle {
+                regions[ri].idle_gens = 0;
+                continue;
+            }
+            if regions[ri].idle_gens < u32::max_value() {
+                regions[ri].idle_gens += 1;
+            }
+            if regions[ri].idle_gens < self.shrink_after {
+                continue;
+            }
+            if !spare_kept {
+                spare_kept = true;
+                continue;
+            }
+            victims.push(ri);
+        }
+        if victims.is_empty() {
+            return;
+        }
+        // the victims' parked pages sit on the lock-free page freelists
+        // by address; drain them and drop the ones that are about to be
+        // unmapped. The world is stopped, so no mutator races the
+        // drain, and holding the zeroer lock means the background
+        // zeroer has no page of ours in its hands either.
+        let _zeroer = page_zeroer_lock().lock().unwrap();
+        let ranges: Vec<(usize, usize)> = victims.iter().map(|&ri| {
+            let begin = regions[ri].pages.as_ptr() as usize;
+            (begin, begin + regions[ri].pg_cnt as usize * PAGE_SZ)
+        }).collect();
+        let mut keep = Vec::new();
+        while let Some(p) = page_freelist().pop() {
+            let a = p as usize;
+            if !ranges.iter().any(|&(lo, hi)| a >= lo && a < hi) {
+                keep.push(p);
+            }
+        }
+        for p in keep {
+            page_freelist().push(p);
+        }
+        let mut zkeep = Vec::new();
+        while let Some(p) = zeroed_page_freelist().pop() {
+            let a = p as usize;
+            if !ranges.iter().any(|&(lo, hi)| a >= lo && a < hi) {
+                zkeep.push(p);
+            }
+        }
+        for p in zkeep {
+            zeroed_page_freelist().push(p);
+        }
+        for ri in victims {
+            println!("neptune: releasing idle region {} ({} MB)",
+                     ri, regions[ri].pg_cnt as usize * PAGE_SZ / 1024 / 1024);
+            self.release_region(regions, ri);
+        }
+    }
+
+    // unmap a fully idle region and recycle its slot; the caller has
+    // already removed the region's parked pages from the page freelist
+    fn release_region(&mut self, regions: &mut [Region], ri: usize) {
+        // the metadata array was mmapped behind the borrow checker's
+        // back, so the Boxes its entries hold must be dropped by hand
+        // before the array goes away
+        for m in regions[ri].meta.iter_mut() {
+            m.ages = None;
+            m.marks = None;
+        }
+        let mappings = mem::replace(&mut regions[ri].mappings, Vec::new());
+        regions[ri] = Region::new();
+        for (base, sz) in mappings {
+            unsafe {
+                libc::munmap(base as * mut libc::c_void, sz);
+            }
+        }
+        // reopen the slot for alloc_page's region scan
+        self.full_regions[ri / 32] &= !(1 << (ri % 32));
+    }
 }
 
 // Testing stubs for pages
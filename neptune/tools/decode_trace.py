@@ -0,0 +1,85 @@
+#!/usr/bin/env python
+"""Decode a neptune GC trace ring (NEPTUNE_TRACE=<file>) into text.
+
+Usage: decode_trace.py <trace-file>
+
+The file layout is defined in neptune/src/trace.rs: a 64-byte header
+(magic "NPTRACE1", record size, ring capacity, write cursor) followed
+by fixed 32-byte records. The ring may have wrapped; records are
+printed oldest first. Timestamps are neptune_hrtime nanoseconds,
+printed relative to the first decoded event.
+"""
+
+import struct
+import sys
+
+MAGIC = b"NPTRACE1"
+HEADER_FMT = "<8sIIQ40x"  # magic, record_sz, capacity, cursor, reserved
+RECORD_FMT = "<QHHIQQ"    # ts, kind, tid, pad, a, b
+
+KINDS = {
+    1: "gc_begin",
+    2: "mark_end",
+    3: "sweep_begin",
+    4: "sweep_end",
+    5: "gc_end",
+    6: "page_alloc",
+    7: "page_free",
+    8: "promoted",
+}
+
+NO_TID = 0xffff
+
+
+def describe(kind, a, b):
+    if kind == 1:
+        return "full=%d concurrent=%d" % (a, b)
+    if kind in (2, 4):
+        return "%.3f ms" % (a / 1e6)
+    if kind == 3:
+        return "full=%d" % a
+    if kind == 5:
+        return "pause=%.3f ms full=%d" % (a / 1e6, b)
+    if kind in (6, 7):
+        return "page=0x%x" % a
+    if kind == 8:
+        return "%d bytes" % a
+    return "a=%d b=%d" % (a, b)
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.stderr.write(__doc__)
+        return 1
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+    magic, record_sz, capacity, cursor = struct.unpack_from(HEADER_FMT, data)
+    if magic != MAGIC:
+        sys.stderr.write("not a neptune trace file (bad magic)\n")
+        return 1
+    if record_sz != struct.calcsize(RECORD_FMT):
+        sys.stderr.write("unknown record size %d\n" % record_sz)
+        return 1
+    base = struct.calcsize(HEADER_FMT)
+    n = min(cursor, capacity)
+    # oldest record is at the cursor once the ring has wrapped
+    first = cursor % capacity if cursor > capacity else 0
+    t0 = None
+    if cursor > capacity:
+        sys.stderr.write("ring wrapped, %d oldest events lost\n"
+                         % (cursor - capacity))
+    for i in range(n):
+        slot = (first + i) % capacity
+        ts, kind, tid, _, a, b = struct.unpack_from(
+            RECORD_FMT, data, base + slot * record_sz)
+        if t0 is None:
+            t0 = ts
+        who = "-" if tid == NO_TID else str(tid)
+        print("%14.6f ms  tid %-2s %-11s %s"
+              % ((ts - t0) / 1e6, who, KINDS.get(kind, "?%d" % kind),
+                 describe(kind, a, b)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,141 @@
+#!/usr/bin/env python
+"""Compute minimum mutator utilization (MMU) curves from a GC trace.
+
+Usage: mmu.py <trace-file> [window-ms ...]
+
+MMU(w) is the worst-case fraction of any time window of length w that
+the mutator got to run; it is the pause metric latency SLAs actually
+correspond to, unlike the wall-time totals tests/gc_bench/GCBench.jl
+reports. The input is the ring written with NEPTUNE_TRACE (layout in
+neptune/src/trace.rs), using the gc_begin/gc_end timestamps the
+collector takes around every pause, e.g.:
+
+    NEPTUNE_TRACE=/tmp/gc.trace julia tests/gc_bench/GCBench.jl
+    neptune/tools/mmu.py /tmp/gc.trace
+
+Without explicit window sizes a log-spaced sweep from 1 ms to 10 s is
+printed. Concurrent cycles (gc_begin with the concurrent flag) span
+mutator execution too and are counted whole, so MMU is conservative
+when NEPTUNE_CONCURRENT_MARK is on. Make sure the ring is large
+enough (NEPTUNE_TRACE_EVENTS) that no pauses were overwritten.
+"""
+
+import bisect
+import struct
+import sys
+
+MAGIC = b"NPTRACE1"
+HEADER_FMT = "<8sIIQ40x"  # magic, record_sz, capacity, cursor, reserved
+RECORD_FMT = "<QHHIQQ"    # ts, kind, tid, pad, a, b
+
+EV_GC_BEGIN = 1
+EV_GC_END = 5
+
+
+def read_pauses(path):
+    """Return (first_ts, last_ts, merged pause intervals) in ns."""
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, record_sz, capacity, cursor = struct.unpack_from(HEADER_FMT, data)
+    if magic != MAGIC:
+        sys.stderr.write("not a neptune trace file (bad magic)\n")
+        sys.exit(1)
+    if cursor > capacity:
+        sys.stderr.write("warning: ring wrapped, %d oldest events lost; "
+                         "grow NEPTUNE_TRACE_EVENTS for trustworthy MMU\n"
+                         % (cursor - capacity))
+    base = struct.calcsize(HEADER_FMT)
+    n = min(cursor, capacity)
+    first = cursor % capacity if cursor > capacity else 0
+    events = []
+    for i in range(n):
+        slot = (first + i) % capacity
+        ts, kind, tid, _, a, b = struct.unpack_from(
+            RECORD_FMT, data, base + slot * record_sz)
+        events.append((ts, kind))
+    if not events:
+        sys.stderr.write("empty trace\n")
+        sys.exit(1)
+    t_min = events[0][0]
+    t_max = events[-1][0]
+    # pair each gc_begin with the next gc_end; nested pairs do not
+    # occur, recollections emit their own begin/end
+    pauses = []
+    begin = None
+    for ts, kind in events:
+        if kind == EV_GC_BEGIN:
+            begin = ts
+        elif kind == EV_GC_END and begin is not None:
+            pauses.append((begin, ts))
+            begin = None
+    # merge any overlap so the prefix sums below stay monotonic
+    merged = []
+    for s, e in sorted(pauses):
+        if merged and s <= merged[-1][1]:
+            merged[-1] = (merged[-1][0], max(merged[-1][1], e))
+        else:
+            merged.append((s, e))
+    return t_min, t_max, merged
+
+
+def busy_in(starts, ends, prefix, s, e):
+    """Total pause time inside [s, e] given sorted intervals and the
+    prefix sums of their durations."""
+    # first interval ending after s, last interval starting before e
+    lo = bisect.bisect_right(ends, s)
+    hi = bisect.bisect_left(starts, e)
+    if lo >= hi:
+        return 0
+    busy = prefix[hi] - prefix[lo]
+    # clip the boundary intervals
+    busy -= max(0, s - starts[lo])
+    busy -= max(0, ends[hi - 1] - e)
+    return busy
+
+
+def mmu(t_min, t_max, pauses, w):
+    """Worst-case mutator utilization over any window of length w."""
+    span = t_max - t_min
+    starts = [s for s, _ in pauses]
+    ends = [e for _, e in pauses]
+    prefix = [0]
+    for s, e in pauses:
+        prefix.append(prefix[-1] + (e - s))
+    if w >= span:
+        return 1.0 - float(prefix[-1]) / span if span else 0.0
+    # the minimum is attained with a window edge on a pause edge
+    worst = 0
+    for s, e in pauses:
+        for left in (s, e - w):
+            left = min(max(left, t_min), t_max - w)
+            worst = max(worst, busy_in(starts, ends, prefix, left, left + w))
+    return 1.0 - float(worst) / w
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.stderr.write(__doc__)
+        return 1
+    t_min, t_max, pauses = read_pauses(sys.argv[1])
+    if not pauses:
+        sys.stderr.write("no complete collections in trace\n")
+        return 1
+    total_pause = sum(e - s for s, e in pauses)
+    span = t_max - t_min
+    print("%d pauses over %.3f s, %.3f s paused (%.2f%% overall utilization)"
+          % (len(pauses), span / 1e9, total_pause / 1e9,
+             100.0 * (1.0 - float(total_pause) / span)))
+    if len(sys.argv) > 2:
+        windows_ms = [float(a) for a in sys.argv[2:]]
+    else:
+        windows_ms = [1, 2, 5, 10, 20, 50, 100, 200, 500,
+                      1000, 2000, 5000, 10000]
+    print("%12s %10s" % ("window", "MMU"))
+    for ms in windows_ms:
+        w = int(ms * 1e6)
+        print("%10g ms %9.2f%%" % (ms, 100.0 * mmu(t_min, t_max, pauses, w)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,81 @@
+# Fragmentation benchmark: GCBench's uniform binary trees free whole
+# pages at a time, so they never show the pathology our mixed-lifetime
+# production heaps do, where short-lived objects die around long-lived
+# neighbours and leave pool pages mostly empty but pinned. This
+# workload interleaves allocations of several pool size classes with
+# three lifetimes - per-round garbage, a sliding window of a few
+# rounds, and permanent survivors - and after each round reports the
+# pages-used footprint against the collector's live-bytes estimate.
+# The gap between the two columns (and the overhead ratio) is the
+# fragmentation.
+#
+#   julia tests/gc_bench/FragBench.jl [rounds]     (default 40)
+
+# mirrors jl_gc_stats_pub_t (julia/src/gc.h); refreshed by the
+# collector at the end of every collection
+immutable GCStatsPub
+  seq::UInt64
+  timestamp::UInt64
+  num::Base.GC_Num
+  live_bytes::Int64
+  pg_count::UInt64
+end
+
+function gcstats()
+  buf = Ref{GCStatsPub}()
+  ccall(:jl_gc_stats_read, Void, (Ptr{GCStatsPub},), buf)
+  buf[]
+end
+
+# spread across several pool size classes so survivors pin pages in
+# more than one freelist
+const k_sizes = [8, 32, 96, 256, 1024]
+const k_allocs_per_round = 200000
+const k_window_rounds = 4       # medium-lived: survive this many rounds
+const k_keep_every = 17         # ~6% of a round becomes medium-lived
+const k_promote_every = 29      # ...and a slice of those becomes permanent
+
+function allocround(r::Int64)
+  kept = Vector{Vector{UInt8}}()
+  for i in 1:k_allocs_per_round
+    v = Vector{UInt8}(k_sizes[1 + (i + r) % length(k_sizes)])
+    v[1] = UInt8(i % 256)
+    # most allocations die right here; the kept minority ages in
+    # place and leaves holes behind when its round-mates are swept
+    if i % k_keep_every == 0
+      push!(kept, v)
+    end
+  end
+  kept
+end
+
+function run(rounds::Int64)
+  pagesz = 1 << ccall(:neptune_page_lg2, Cint, ())
+  window = Vector{Vector{Vector{UInt8}}}()
+  permanent = Vector{Vector{UInt8}}()
+
+  println("round |  live MB | pages MB | pages/live")
+  for r in 1:rounds
+    kept = allocround(r)
+    push!(window, kept)
+    if length(window) > k_window_rounds
+      old = shift!(window)
+      # promote a thin slice of the expiring batch so some pages stay
+      # pinned by a handful of objects forever
+      for i in 1:k_promote_every:length(old)
+        push!(permanent, old[i])
+      end
+    end
+    gc()  # stats publish at the end of every collection
+    st = gcstats()
+    live = st.live_bytes / (1024 * 1024)
+    pages = st.pg_count * pagesz / (1024 * 1024)
+    @printf("%5d | %8.1f | %8.1f | %10.2f\n",
+            r, live, pages, pages / max(live, 1.0))
+  end
+
+  println("permanent survivors: $(length(permanent))")
+end
+
+rounds = length(ARGS) >= 1 ? parse(Int64, ARGS[1]) : 40
+run(rounds)